@@ -80,6 +80,139 @@ static void vProcessARPPacketReply( ARPPacket_t * pxARPFrame,
 
 /*-----------------------------------------------------------*/
 
+/*
+ * Send an ARP request for a row that is waiting for a reply, unless
+ * ipconfigUSE_ARP_REQUEST_LIMIT holds it back.
+ */
+static void prvARPRequestRow( BaseType_t xRow );
+
+#if ( ipconfigUSE_ARP_REQUEST_LIMIT == 1 )
+    #if ( ipconfigMAX_ARP_RETRANSMISSIONS > 254 )
+        #error ipconfigMAX_ARP_RETRANSMISSIONS must be less than 255 when ipconfigUSE_ARP_REQUEST_LIMIT is used
+    #endif
+
+/** @brief The interval between ARP requests doubles with every retry, up to
+ * 2 to the power of this value times ipconfigARP_REQUEST_INTERVAL_MS. */
+    #define arpMAX_REQUEST_BACKOFF_SHIFT    ( 6U )
+
+/*
+ * Find the row that holds ulIPAddress, or -1.
+ */
+    static BaseType_t prvARPFindRow( uint32_t ulIPAddress );
+#endif /* ipconfigUSE_ARP_REQUEST_LIMIT */
+
+/*-----------------------------------------------------------*/
+
+#if ( ipconfigUSE_ARP_HASH == 1 )
+    #if ( ipconfigARP_HASH_SIZE <= ipconfigARP_CACHE_ENTRIES )
+        #error ipconfigARP_HASH_SIZE must be larger than ipconfigARP_CACHE_ENTRIES
+    #endif
+
+    #if ( ipconfigARP_CACHE_ENTRIES >= 0xFFFF )
+        #error ipconfigARP_CACHE_ENTRIES must be less than 65535 when ipconfigUSE_ARP_HASH is used
+    #endif
+
+/** @brief A slot in a hash index that does not refer to a row. */
+    #define arpHASH_EMPTY    ( ( uint16_t ) 0U )
+
+/** @brief The end of the LRU list. */
+    #define arpLRU_NONE      ( ( uint16_t ) 0xFFFFU )
+
+/*
+ * Put all rows in the LRU list, in case that has not been done yet.
+ */
+    static void prvARPHashInit( void );
+
+/*
+ * Find the row that holds ulIPAddress, or -1.
+ */
+    static BaseType_t prvARPFindIP( uint32_t ulIPAddress );
+
+/*
+ * Find a row with a valid mapping for pxMACAddress, or -1.  When ulIPAddress
+ * is non-zero, and the stack stores remote addresses, the row must be on the
+ * same side of the netmask as ulIPAddress.
+ */
+    static BaseType_t prvARPFindMAC( const MACAddress_t * pxMACAddress,
+                                     uint32_t ulIPAddress );
+
+/*
+ * Remove a row from the hash indexes before its contents change, and add it
+ * again afterwards.
+ */
+    static void prvARPRowUnlink( BaseType_t xRow );
+    static void prvARPRowLink( BaseType_t xRow );
+
+/*
+ * Move a row to the most recently used end of the LRU list, or, when it has
+ * been cleared, to the end from which rows are re-used.
+ */
+    static void prvARPTouch( BaseType_t xRow );
+    static void prvARPRelease( BaseType_t xRow );
+
+/** @brief Maintain the hash indexes and the LRU list around a change of a row. */
+    #define arpROW_UNLINK( xRow )     prvARPRowUnlink( xRow )
+    #define arpROW_LINK( xRow )       do { prvARPRowLink( xRow ); prvARPTouch( xRow ); } while( ipFALSE_BOOL )
+    #define arpHASH_REMOVE( xRow )    prvARPRelease( xRow )
+#else
+    #define arpROW_UNLINK( xRow )
+    #define arpROW_LINK( xRow )
+    #define arpHASH_REMOVE( xRow )
+#endif /* ipconfigUSE_ARP_HASH */
+
+#if ( ipconfigUSE_ARP_DEADLINE_AGING == 1 )
+    #if ( ipconfigARP_CACHE_ENTRIES >= 0xFFFF )
+        #error ipconfigARP_CACHE_ENTRIES must be less than 65535 when ipconfigUSE_ARP_DEADLINE_AGING is used
+    #endif
+
+/** @brief The ARP timer period expressed in clock ticks. */
+    #define arpAGING_PERIOD    ( ( uint32_t ) pdMS_TO_TICKS( ipARP_TIMER_PERIOD_MS ) )
+
+/** @brief Compare two times of the ARP clock, allowing for a wrap-around. */
+    #define arpTIME_BEFORE( ulA, ulB )    ( ( int32_t ) ( ( ulA ) - ( ulB ) ) < 0 )
+
+/*
+ * Return a clock that counts ticks in 32 bits, also when TickType_t is 16 bits.
+ */
+    static uint32_t prvARPNow( void );
+
+/*
+ * Return the time at which a row needs the attention of vARPAgeCache().
+ */
+    static uint32_t prvARPDue( BaseType_t xRow );
+
+/*
+ * A row has been refreshed or created: make sure that it is in the deadline
+ * heap, no later than it is due.
+ */
+    static void prvARPSchedule( BaseType_t xRow );
+
+/*
+ * Take a row out of the deadline heap.
+ */
+    static void prvARPUnschedule( BaseType_t xRow );
+
+/*
+ * Restore the heap order after the key of an element has changed.
+ */
+    static void prvARPHeapUp( BaseType_t xPosition );
+    static void prvARPHeapDown( BaseType_t xPosition );
+
+/*
+ * Handle the entries that are due, and return the number of ticks until the
+ * next one is due.
+ */
+    static uint32_t prvARPAgeDueEntries( void );
+
+    #define arpROW_SCHEDULE( xRow )    prvARPSchedule( xRow )
+    #define arpROW_REMOVE( xRow )      do { arpHASH_REMOVE( xRow ); prvARPUnschedule( xRow ); } while( ipFALSE_BOOL )
+#else
+    #define arpROW_SCHEDULE( xRow )
+    #define arpROW_REMOVE( xRow )      arpHASH_REMOVE( xRow )
+#endif /* ipconfigUSE_ARP_DEADLINE_AGING */
+
+/*-----------------------------------------------------------*/
+
 /** @brief The ARP cache. */
 _static ARPCacheRow_t xARPCache[ ipconfigARP_CACHE_ENTRIES ];
 
@@ -87,6 +220,74 @@ _static ARPCacheRow_t xARPCache[ ipconfigARP_CACHE_ENTRIES ];
  * to ensure ARP tables are up to date and to detect IP address conflicts. */
 static TickType_t xLastGratuitousARPTime = ( TickType_t ) 0;
 
+/** @brief Incremented each time a mapping in the ARP cache is replaced or
+ * removed, see ulARPGetGeneration(). */
+static volatile uint32_t ulARPGeneration = 0U;
+
+#if ( ipconfigUSE_ARP_HASH == 1 )
+
+/** @brief The index of the ARP cache keyed on the IP address, using open
+ * addressing with linear probing.  A slot holds a row number plus one, or
+ * arpHASH_EMPTY.  Every row with a non-zero IP address is indexed. */
+    static uint16_t usARPIPIndex[ ipconfigARP_HASH_SIZE ];
+
+    #if ( ipconfigARP_HASH_MAC_INDEX == 1 )
+
+/** @brief The index of the ARP cache keyed on the MAC address.  Only the
+ * rows that hold a valid mapping are indexed. */
+        static uint16_t usARPMACIndex[ ipconfigARP_HASH_SIZE ];
+    #endif
+
+/** @brief The rows in the order of their use, linked through these arrays.
+ * The head is the most recently used row, a new entry replaces the tail. */
+    static uint16_t usARPLRUNext[ ipconfigARP_CACHE_ENTRIES ];
+    static uint16_t usARPLRUPrev[ ipconfigARP_CACHE_ENTRIES ];
+    static uint16_t usARPLRUHead = arpLRU_NONE;
+    static uint16_t usARPLRUTail = arpLRU_NONE;
+#endif /* ipconfigUSE_ARP_HASH */
+
+#if ( ipconfigUSE_ARP_DEADLINE_AGING == 1 )
+
+/** @brief The rows that are in use, ordered as a binary min-heap on
+ * ulARPDeadline[].  Every row with a non-zero IP address is in the heap. */
+    static uint16_t usARPHeap[ ipconfigARP_CACHE_ENTRIES ];
+
+/** @brief The position of each row in usARPHeap[] plus one, or zero when the
+ * row is not in the heap. */
+    static uint16_t usARPHeapPosition[ ipconfigARP_CACHE_ENTRIES ];
+
+/** @brief The number of rows in usARPHeap[]. */
+    static BaseType_t xARPHeapCount = 0;
+
+/** @brief The key of the heap: the time at which vARPAgeCache() will look at a
+ * row.  A refresh does not move a row back in the heap, the key is corrected
+ * when it comes up, see prvARPDue(). */
+    static uint32_t ulARPDeadline[ ipconfigARP_CACHE_ENTRIES ];
+
+/** @brief The time at which a row was last refreshed, created, or probed. */
+    static uint32_t ulARPEventTime[ ipconfigARP_CACHE_ENTRIES ];
+
+/** @brief The 32-bit clock of prvARPNow(), and the tick count at which it was
+ * last updated. */
+    static uint32_t ulARPClock = 0U;
+    static TickType_t xARPClockTick = ( TickType_t ) 0;
+
+/** @brief The time at which the ARP timer will call vARPAgeCache(). */
+    static uint32_t ulARPNextWake = 0U;
+#endif /* ipconfigUSE_ARP_DEADLINE_AGING */
+
+#if ( ipconfigUSE_ARP_REQUEST_LIMIT == 1 )
+
+/** @brief For each row that waits for an ARP reply: the number of requests
+ * sent, and the time of the last one.  A count above
+ * ipconfigMAX_ARP_RETRANSMISSIONS marks an unreachable address. */
+    static uint8_t ucARPRequestCount[ ipconfigARP_CACHE_ENTRIES ];
+    static TickType_t xARPRequestTime[ ipconfigARP_CACHE_ENTRIES ];
+
+/** @brief The counters returned by vARPGetRequestStats(). */
+    static ARPRequestStats_t xARPRequestStats;
+#endif /* ipconfigUSE_ARP_REQUEST_LIMIT */
+
 /*
  * IP-clash detection is currently only used internally. When DHCP doesn't respond, the
  * driver can try out a random LinkLayer IP address (169.254.x.x).  It will send out a
@@ -298,25 +499,38 @@ BaseType_t xIsIPInARPCache( uint32_t ulAddressToLookup )
 {
     BaseType_t x, xReturn = pdFALSE;
 
-    /* Loop through each entry in the ARP cache. */
-    for( x = 0; x < ipconfigARP_CACHE_ENTRIES; x++ )
-    {
-        /* Does this row in the ARP cache table hold an entry for the IP address
-         * being queried? */
-        if( xARPCache[ x ].ulIPAddress == ulAddressToLookup )
+    #if ( ipconfigUSE_ARP_HASH == 1 )
         {
-            xReturn = pdTRUE;
+            x = prvARPFindIP( ulAddressToLookup );
 
-            /* A matching valid entry was found. */
-            if( xARPCache[ x ].ucValid == ( uint8_t ) pdFALSE )
+            if( ( x >= 0 ) && ( xARPCache[ x ].ucValid != ( uint8_t ) pdFALSE ) )
             {
-                /* This entry is waiting an ARP reply, so is not valid. */
-                xReturn = pdFALSE;
+                xReturn = pdTRUE;
             }
+        }
+    #else /* if ( ipconfigUSE_ARP_HASH == 1 ) */
+        {
+            /* Loop through each entry in the ARP cache. */
+            for( x = 0; x < ipconfigARP_CACHE_ENTRIES; x++ )
+            {
+                /* Does this row in the ARP cache table hold an entry for the IP address
+                 * being queried? */
+                if( xARPCache[ x ].ulIPAddress == ulAddressToLookup )
+                {
+                    xReturn = pdTRUE;
 
-            break;
+                    /* A matching valid entry was found. */
+                    if( xARPCache[ x ].ucValid == ( uint8_t ) pdFALSE )
+                    {
+                        /* This entry is waiting an ARP reply, so is not valid. */
+                        xReturn = pdFALSE;
+                    }
+
+                    break;
+                }
+            }
         }
-    }
+    #endif /* if ( ipconfigUSE_ARP_HASH == 1 ) */
 
     return xReturn;
 }
@@ -340,7 +554,15 @@ BaseType_t xCheckRequiresARPResolution( NetworkBufferDescriptor_t * pxNetworkBuf
          * then we should send out ARP for finding the MAC address. */
         if( xIsIPInARPCache( pxIPHeader->ulSourceIPAddress ) == pdFALSE )
         {
-            FreeRTOS_OutputARPRequest( pxIPHeader->ulSourceIPAddress );
+            #if ( ipconfigUSE_ARP_REQUEST_LIMIT == 1 )
+                {
+                    vARPResolveAddress( pxIPHeader->ulSourceIPAddress );
+                }
+            #else
+                {
+                    FreeRTOS_OutputARPRequest( pxIPHeader->ulSourceIPAddress );
+                }
+            #endif
 
             /* This packet needs resolution since this is on the same subnet
              * but not in the ARP cache. */
@@ -367,16 +589,36 @@ BaseType_t xCheckRequiresARPResolution( NetworkBufferDescriptor_t * pxNetworkBuf
 
         configASSERT( pxMACAddress != NULL );
 
-        /* For each entry in the ARP cache table. */
-        for( x = 0; x < ipconfigARP_CACHE_ENTRIES; x++ )
-        {
-            if( ( memcmp( xARPCache[ x ].xMACAddress.ucBytes, pxMACAddress->ucBytes, sizeof( pxMACAddress->ucBytes ) ) == 0 ) )
+        #if ( ( ipconfigUSE_ARP_HASH == 1 ) && ( ipconfigARP_HASH_MAC_INDEX == 1 ) )
             {
-                lResult = xARPCache[ x ].ulIPAddress;
-                ( void ) memset( &xARPCache[ x ], 0, sizeof( xARPCache[ x ] ) );
-                break;
+                x = prvARPFindMAC( pxMACAddress, 0UL );
+
+                if( x >= 0 )
+                {
+                    lResult = xARPCache[ x ].ulIPAddress;
+                    arpROW_UNLINK( x );
+                    ( void ) memset( &xARPCache[ x ], 0, sizeof( xARPCache[ x ] ) );
+                    arpROW_REMOVE( x );
+                    vARPIncrementGeneration();
+                }
             }
-        }
+        #else /* if ( ( ipconfigUSE_ARP_HASH == 1 ) && ( ipconfigARP_HASH_MAC_INDEX == 1 ) ) */
+            {
+                /* For each entry in the ARP cache table. */
+                for( x = 0; x < ipconfigARP_CACHE_ENTRIES; x++ )
+                {
+                    if( ( memcmp( xARPCache[ x ].xMACAddress.ucBytes, pxMACAddress->ucBytes, sizeof( pxMACAddress->ucBytes ) ) == 0 ) )
+                    {
+                        lResult = xARPCache[ x ].ulIPAddress;
+                        arpROW_UNLINK( x );
+                        ( void ) memset( &xARPCache[ x ], 0, sizeof( xARPCache[ x ] ) );
+                        arpROW_REMOVE( x );
+                        vARPIncrementGeneration();
+                        break;
+                    }
+                }
+            }
+        #endif /* if ( ( ipconfigUSE_ARP_HASH == 1 ) && ( ipconfigARP_HASH_MAC_INDEX == 1 ) ) */
 
         return lResult;
     }
@@ -395,12 +637,10 @@ BaseType_t xCheckRequiresARPResolution( NetworkBufferDescriptor_t * pxNetworkBuf
 void vARPRefreshCacheEntry( const MACAddress_t * pxMACAddress,
                             const uint32_t ulIPAddress )
 {
-    BaseType_t x = 0;
     BaseType_t xIpEntry = -1;
     BaseType_t xMacEntry = -1;
     BaseType_t xUseEntry = 0;
     BaseType_t xAllDone = pdFALSE;
-    uint8_t ucMinAgeFound = 0U;
 
     #if ( ipconfigARP_STORES_REMOTE_ADDRESSES == 0 )
         /* Only process the IP address if it is on the local network. */
@@ -417,103 +657,166 @@ void vARPRefreshCacheEntry( const MACAddress_t * pxMACAddress,
         if( pdTRUE )
     #endif
     {
-        /* Start with the maximum possible number. */
-        ucMinAgeFound--;
+        #if ( ipconfigUSE_ARP_HASH == 1 )
+            {
+                prvARPHashInit();
 
-        /* For each entry in the ARP cache table. */
-        for( x = 0; x < ipconfigARP_CACHE_ENTRIES; x++ )
-        {
-            BaseType_t xMatchingMAC;
+                xIpEntry = prvARPFindIP( ulIPAddress );
 
-            if( pxMACAddress != NULL )
-            {
-                if( memcmp( xARPCache[ x ].xMACAddress.ucBytes, pxMACAddress->ucBytes, sizeof( pxMACAddress->ucBytes ) ) == 0 )
+                if( ( xIpEntry >= 0 ) && ( pxMACAddress != NULL ) &&
+                    ( memcmp( xARPCache[ xIpEntry ].xMACAddress.ucBytes, pxMACAddress->ucBytes, sizeof( pxMACAddress->ucBytes ) ) == 0 ) )
+                {
+                    /* A perfect match is found, update the entry. */
+                    if( xARPCache[ xIpEntry ].ucValid == ( uint8_t ) pdFALSE )
+                    {
+                        /* The entry becomes valid, add it to the MAC index. */
+                        arpROW_UNLINK( xIpEntry );
+                        xARPCache[ xIpEntry ].ucValid = ( uint8_t ) pdTRUE;
+                        arpROW_LINK( xIpEntry );
+                    }
+                    else
+                    {
+                        prvARPTouch( xIpEntry );
+                    }
+
+                    xARPCache[ xIpEntry ].ucAge = ( uint8_t ) ipconfigMAX_ARP_AGE;
+                    arpROW_SCHEDULE( xIpEntry );
+                    xAllDone = pdTRUE;
+                }
+                else if( pxMACAddress != NULL )
                 {
-                    xMatchingMAC = pdTRUE;
+                    /* Either the IP-address is new, or its MAC-address has
+                     * changed.  See if the MAC-address is used by another entry. */
+                    xMacEntry = prvARPFindMAC( pxMACAddress, ulIPAddress );
                 }
                 else
                 {
-                    xMatchingMAC = pdFALSE;
+                    /* An outstanding ARP request, xIpEntry may or may not be found. */
                 }
+
+                /* When a new entry is needed, use the least recently used row. */
+                xUseEntry = ( BaseType_t ) usARPLRUTail;
             }
-            else
+        #else /* if ( ipconfigUSE_ARP_HASH == 1 ) */
             {
-                xMatchingMAC = pdFALSE;
-            }
+                BaseType_t x;
+                uint8_t ucMinAgeFound = 0U;
 
-            /* Does this line in the cache table hold an entry for the IP
-             * address being queried? */
-            if( xARPCache[ x ].ulIPAddress == ulIPAddress )
-            {
-                if( pxMACAddress == NULL )
-                {
-                    /* In case the parameter pxMACAddress is NULL, an entry will be reserved to
-                     * indicate that there is an outstanding ARP request, This entry will have
-                     * "ucValid == pdFALSE". */
-                    xIpEntry = x;
-                    break;
-                }
+                /* Start with the maximum possible number. */
+                ucMinAgeFound--;
 
-                /* See if the MAC-address also matches. */
-                if( xMatchingMAC != pdFALSE )
+                /* For each entry in the ARP cache table. */
+                for( x = 0; x < ipconfigARP_CACHE_ENTRIES; x++ )
                 {
-                    /* A perfect match is found, update the entry and leave this
-                     * function by setting 'xAllDone' to pdTRUE. */
-                    xARPCache[ x ].ucAge = ( uint8_t ) ipconfigMAX_ARP_AGE;
-                    xARPCache[ x ].ucValid = ( uint8_t ) pdTRUE;
-                    xAllDone = pdTRUE;
-                    break;
-                }
+                    BaseType_t xMatchingMAC;
 
-                /* Found an entry containing ulIPAddress, but the MAC address
-                 * doesn't match.  Might be an entry with ucValid=pdFALSE, waiting
-                 * for an ARP reply.  Still want to see if there is match with the
-                 * given MAC address.ucBytes.  If found, either of the two entries
-                 * must be cleared. */
-                xIpEntry = x;
-            }
-            else if( xMatchingMAC != pdFALSE )
-            {
-                /* Found an entry with the given MAC-address, but the IP-address
-                 * is different.  Continue looping to find a possible match with
-                 * ulIPAddress. */
-                #if ( ipconfigARP_STORES_REMOTE_ADDRESSES != 0 )
-
-                    /* If ARP stores the MAC address of IP addresses outside the
-                     * network, than the MAC address of the gateway should not be
-                     * overwritten. */
-                    BaseType_t bIsLocal[ 2 ];
-                    bIsLocal[ 0 ] = ( ( xARPCache[ x ].ulIPAddress & xNetworkAddressing.ulNetMask ) == ( ( *ipLOCAL_IP_ADDRESS_POINTER ) & xNetworkAddressing.ulNetMask ) );
-                    bIsLocal[ 1 ] = ( ( ulIPAddress & xNetworkAddressing.ulNetMask ) == ( ( *ipLOCAL_IP_ADDRESS_POINTER ) & xNetworkAddressing.ulNetMask ) );
-
-                    if( bIsLocal[ 0 ] == bIsLocal[ 1 ] )
+                    if( pxMACAddress != NULL )
                     {
-                        xMacEntry = x;
+                        if( memcmp( xARPCache[ x ].xMACAddress.ucBytes, pxMACAddress->ucBytes, sizeof( pxMACAddress->ucBytes ) ) == 0 )
+                        {
+                            xMatchingMAC = pdTRUE;
+                        }
+                        else
+                        {
+                            xMatchingMAC = pdFALSE;
+                        }
+                    }
+                    else
+                    {
+                        xMatchingMAC = pdFALSE;
                     }
-                #else /* if ( ipconfigARP_STORES_REMOTE_ADDRESSES != 0 ) */
-                    xMacEntry = x;
-                #endif /* if ( ipconfigARP_STORES_REMOTE_ADDRESSES != 0 ) */
-            }
 
-            /* _HT_
-             * Shouldn't we test for xARPCache[ x ].ucValid == pdFALSE here ? */
-            else if( xARPCache[ x ].ucAge < ucMinAgeFound )
-            {
-                /* As the table is traversed, remember the table row that
-                 * contains the oldest entry (the lowest age count, as ages are
-                 * decremented to zero) so the row can be re-used if this function
-                 * needs to add an entry that does not already exist. */
-                ucMinAgeFound = xARPCache[ x ].ucAge;
-                xUseEntry = x;
-            }
-            else
-            {
-                /* Nothing happens to this cache entry for now. */
+                    /* Does this line in the cache table hold an entry for the IP
+                     * address being queried? */
+                    if( xARPCache[ x ].ulIPAddress == ulIPAddress )
+                    {
+                        if( pxMACAddress == NULL )
+                        {
+                            /* In case the parameter pxMACAddress is NULL, an entry will be reserved to
+                             * indicate that there is an outstanding ARP request, This entry will have
+                             * "ucValid == pdFALSE". */
+                            xIpEntry = x;
+                            break;
+                        }
+
+                        /* See if the MAC-address also matches. */
+                        if( xMatchingMAC != pdFALSE )
+                        {
+                            /* A perfect match is found, update the entry and leave this
+                             * function by setting 'xAllDone' to pdTRUE. */
+                            xARPCache[ x ].ucAge = ( uint8_t ) ipconfigMAX_ARP_AGE;
+                            xARPCache[ x ].ucValid = ( uint8_t ) pdTRUE;
+                            arpROW_SCHEDULE( x );
+                            xAllDone = pdTRUE;
+                            break;
+                        }
+
+                        /* Found an entry containing ulIPAddress, but the MAC address
+                         * doesn't match.  Might be an entry with ucValid=pdFALSE, waiting
+                         * for an ARP reply.  Still want to see if there is match with the
+                         * given MAC address.ucBytes.  If found, either of the two entries
+                         * must be cleared. */
+                        xIpEntry = x;
+                    }
+                    else if( xMatchingMAC != pdFALSE )
+                    {
+                        /* Found an entry with the given MAC-address, but the IP-address
+                         * is different.  Continue looping to find a possible match with
+                         * ulIPAddress. */
+                        #if ( ipconfigARP_STORES_REMOTE_ADDRESSES != 0 )
+
+                            /* If ARP stores the MAC address of IP addresses outside the
+                             * network, than the MAC address of the gateway should not be
+                             * overwritten. */
+                            BaseType_t bIsLocal[ 2 ];
+                            bIsLocal[ 0 ] = ( ( xARPCache[ x ].ulIPAddress & xNetworkAddressing.ulNetMask ) == ( ( *ipLOCAL_IP_ADDRESS_POINTER ) & xNetworkAddressing.ulNetMask ) );
+                            bIsLocal[ 1 ] = ( ( ulIPAddress & xNetworkAddressing.ulNetMask ) == ( ( *ipLOCAL_IP_ADDRESS_POINTER ) & xNetworkAddressing.ulNetMask ) );
+
+                            if( bIsLocal[ 0 ] == bIsLocal[ 1 ] )
+                            {
+                                xMacEntry = x;
+                            }
+                        #else /* if ( ipconfigARP_STORES_REMOTE_ADDRESSES != 0 ) */
+                            xMacEntry = x;
+                        #endif /* if ( ipconfigARP_STORES_REMOTE_ADDRESSES != 0 ) */
+                    }
+
+                    /* _HT_
+                     * Shouldn't we test for xARPCache[ x ].ucValid == pdFALSE here ? */
+                    else if( xARPCache[ x ].ucAge < ucMinAgeFound )
+                    {
+                        /* As the table is traversed, remember the table row that
+                         * contains the oldest entry (the lowest age count, as ages are
+                         * decremented to zero) so the row can be re-used if this function
+                         * needs to add an entry that does not already exist. */
+                        ucMinAgeFound = xARPCache[ x ].ucAge;
+                        xUseEntry = x;
+                    }
+
+                    #if ( ipconfigUSE_ARP_DEADLINE_AGING == 1 )
+                        else if( ( xARPCache[ x ].ucAge == ucMinAgeFound ) &&
+                                 ( arpTIME_BEFORE( ulARPEventTime[ x ], ulARPEventTime[ xUseEntry ] ) ) )
+                        {
+                            /* The age of an entry only goes down when it is
+                             * about to expire.  Of the entries with an equal age,
+                             * re-use the one that was refreshed longest ago. */
+                            xUseEntry = x;
+                        }
+                    #endif
+                    else
+                    {
+                        /* Nothing happens to this cache entry for now. */
+                    }
+                }
             }
-        }
+        #endif /* if ( ipconfigUSE_ARP_HASH == 1 ) */
 
         if( xAllDone == pdFALSE )
         {
+            /* An entry will be replaced, MAC-addresses that were copied from
+             * the cache may no longer be valid. */
+            vARPIncrementGeneration();
+
             /* A perfect match was not found. See if either the MAC-address
              * or the IP-address has a match. */
             if( xMacEntry >= 0 )
@@ -525,7 +828,9 @@ void vARPRefreshCacheEntry( const MACAddress_t * pxMACAddress,
                     /* Both the MAC address as well as the IP address were found in
                      * different locations: clear the entry which matches the
                      * IP-address */
+                    arpROW_UNLINK( xIpEntry );
                     ( void ) memset( &( xARPCache[ xIpEntry ] ), 0, sizeof( ARPCacheRow_t ) );
+                    arpROW_REMOVE( xIpEntry );
                 }
             }
             else if( xIpEntry >= 0 )
@@ -539,6 +844,7 @@ void vARPRefreshCacheEntry( const MACAddress_t * pxMACAddress,
             }
 
             /* If the entry was not found, we use the oldest entry and set the IPaddress */
+            arpROW_UNLINK( xUseEntry );
             xARPCache[ xUseEntry ].ulIPAddress = ulIPAddress;
 
             if( pxMACAddress != NULL )
@@ -549,16 +855,29 @@ void vARPRefreshCacheEntry( const MACAddress_t * pxMACAddress,
                 /* And this entry does not need immediate attention */
                 xARPCache[ xUseEntry ].ucAge = ( uint8_t ) ipconfigMAX_ARP_AGE;
                 xARPCache[ xUseEntry ].ucValid = ( uint8_t ) pdTRUE;
+                arpROW_SCHEDULE( xUseEntry );
             }
             else if( xIpEntry < 0 )
             {
                 xARPCache[ xUseEntry ].ucAge = ( uint8_t ) ipconfigMAX_ARP_RETRANSMISSIONS;
                 xARPCache[ xUseEntry ].ucValid = ( uint8_t ) pdFALSE;
+                arpROW_SCHEDULE( xUseEntry );
+
+                #if ( ipconfigUSE_ARP_REQUEST_LIMIT == 1 )
+                    {
+                        /* The caller sends the first ARP request. */
+                        ucARPRequestCount[ xUseEntry ] = 1U;
+                        xARPRequestTime[ xUseEntry ] = xTaskGetTickCount();
+                        xARPRequestStats.ulRequestsSent++;
+                    }
+                #endif
             }
             else
             {
                 /* Nothing will be stored. */
             }
+
+            arpROW_LINK( xUseEntry );
         }
     }
 }
@@ -583,18 +902,32 @@ void vARPRefreshCacheEntry( const MACAddress_t * pxMACAddress,
         configASSERT( pxMACAddress != NULL );
         configASSERT( pulIPAddress != NULL );
 
-        /* Loop through each entry in the ARP cache. */
-        for( x = 0; x < ipconfigARP_CACHE_ENTRIES; x++ )
-        {
-            /* Does this row in the ARP cache table hold an entry for the MAC
-             * address being searched? */
-            if( memcmp( pxMACAddress->ucBytes, xARPCache[ x ].xMACAddress.ucBytes, sizeof( MACAddress_t ) ) == 0 )
+        #if ( ( ipconfigUSE_ARP_HASH == 1 ) && ( ipconfigARP_HASH_MAC_INDEX == 1 ) )
             {
-                *pulIPAddress = xARPCache[ x ].ulIPAddress;
-                eReturn = eARPCacheHit;
-                break;
+                x = prvARPFindMAC( pxMACAddress, 0UL );
+
+                if( x >= 0 )
+                {
+                    *pulIPAddress = xARPCache[ x ].ulIPAddress;
+                    eReturn = eARPCacheHit;
+                }
             }
-        }
+        #else /* if ( ( ipconfigUSE_ARP_HASH == 1 ) && ( ipconfigARP_HASH_MAC_INDEX == 1 ) ) */
+            {
+                /* Loop through each entry in the ARP cache. */
+                for( x = 0; x < ipconfigARP_CACHE_ENTRIES; x++ )
+                {
+                    /* Does this row in the ARP cache table hold an entry for the MAC
+                     * address being searched? */
+                    if( memcmp( pxMACAddress->ucBytes, xARPCache[ x ].xMACAddress.ucBytes, sizeof( MACAddress_t ) ) == 0 )
+                    {
+                        *pulIPAddress = xARPCache[ x ].ulIPAddress;
+                        eReturn = eARPCacheHit;
+                        break;
+                    }
+                }
+            }
+        #endif /* if ( ( ipconfigUSE_ARP_HASH == 1 ) && ( ipconfigARP_HASH_MAC_INDEX == 1 ) ) */
 
         return eReturn;
     }
@@ -736,114 +1069,1005 @@ static eARPLookupResult_t prvCacheLookup( uint32_t ulAddressToLookup,
     BaseType_t x;
     eARPLookupResult_t eReturn = eARPCacheMiss;
 
-    /* Loop through each entry in the ARP cache. */
-    for( x = 0; x < ipconfigARP_CACHE_ENTRIES; x++ )
-    {
-        /* Does this row in the ARP cache table hold an entry for the IP address
-         * being queried? */
-        if( xARPCache[ x ].ulIPAddress == ulAddressToLookup )
+    #if ( ipconfigUSE_ARP_HASH == 1 )
         {
-            /* A matching valid entry was found. */
-            if( xARPCache[ x ].ucValid == ( uint8_t ) pdFALSE )
+            x = prvARPFindIP( ulAddressToLookup );
+
+            if( x < 0 )
+            {
+                /* Not found. */
+            }
+            else if( xARPCache[ x ].ucValid == ( uint8_t ) pdFALSE )
             {
                 /* This entry is waiting an ARP reply, so is not valid. */
                 eReturn = eCantSendPacket;
             }
             else
             {
-                /* A valid entry was found. */
                 ( void ) memcpy( pxMACAddress->ucBytes, xARPCache[ x ].xMACAddress.ucBytes, sizeof( MACAddress_t ) );
                 eReturn = eARPCacheHit;
+
+                /* Only the IP-task changes the LRU list. */
+                if( xIsCallingFromIPTask() != pdFALSE )
+                {
+                    prvARPTouch( x );
+                }
             }
+        }
+    #else /* if ( ipconfigUSE_ARP_HASH == 1 ) */
+        {
+            /* Loop through each entry in the ARP cache. */
+            for( x = 0; x < ipconfigARP_CACHE_ENTRIES; x++ )
+            {
+                /* Does this row in the ARP cache table hold an entry for the IP address
+                 * being queried? */
+                if( xARPCache[ x ].ulIPAddress == ulAddressToLookup )
+                {
+                    /* A matching valid entry was found. */
+                    if( xARPCache[ x ].ucValid == ( uint8_t ) pdFALSE )
+                    {
+                        /* This entry is waiting an ARP reply, so is not valid. */
+                        eReturn = eCantSendPacket;
+                    }
+                    else
+                    {
+                        /* A valid entry was found. */
+                        ( void ) memcpy( pxMACAddress->ucBytes, xARPCache[ x ].xMACAddress.ucBytes, sizeof( MACAddress_t ) );
+                        eReturn = eARPCacheHit;
+                    }
 
-            break;
+                    break;
+                }
+            }
         }
-    }
+    #endif /* if ( ipconfigUSE_ARP_HASH == 1 ) */
 
     return eReturn;
 }
 /*-----------------------------------------------------------*/
 
+#if ( ipconfigUSE_ARP_HASH == 1 )
+
 /**
- * @brief A call to this function will update (or 'Age') the ARP cache entries.
- *        The function will also try to prevent a removal of entry by sending
- *        an ARP query. It will also check whether we are waiting on an ARP
- *        reply - if we are, then an ARP request will be re-sent.
- *        In case an ARP entry has 'Aged' to 0, it will be removed from the ARP
- *        cache.
+ * @brief Mix the bits of a key, so that all of them have an effect on the
+ *        slot in a hash index.
+ *
+ * @param[in] ulKey: The key, an IP address or the bytes of a MAC address.
+ *
+ * @return The home slot of the key.
  */
-void vARPAgeCache( void )
-{
-    BaseType_t x;
-    TickType_t xTimeNow;
-
-    /* Loop through each entry in the ARP cache. */
-    for( x = 0; x < ipconfigARP_CACHE_ENTRIES; x++ )
+    static size_t prvARPHashKey( uint32_t ulKey )
     {
-        /* If the entry is valid (its age is greater than zero). */
-        if( xARPCache[ x ].ucAge > 0U )
-        {
-            /* Decrement the age value of the entry in this ARP cache table row.
-             * When the age reaches zero it is no longer considered valid. */
-            ( xARPCache[ x ].ucAge )--;
-
-            /* If the entry is not yet valid, then it is waiting an ARP
-             * reply, and the ARP request should be retransmitted. */
-            if( xARPCache[ x ].ucValid == ( uint8_t ) pdFALSE )
-            {
-                FreeRTOS_OutputARPRequest( xARPCache[ x ].ulIPAddress );
-            }
-            else if( xARPCache[ x ].ucAge <= ( uint8_t ) arpMAX_ARP_AGE_BEFORE_NEW_ARP_REQUEST )
-            {
-                /* This entry will get removed soon.  See if the MAC address is
-                 * still valid to prevent this happening. */
-                iptraceARP_TABLE_ENTRY_WILL_EXPIRE( xARPCache[ x ].ulIPAddress );
-                FreeRTOS_OutputARPRequest( xARPCache[ x ].ulIPAddress );
-            }
-            else
-            {
-                /* The age has just ticked down, with nothing to do. */
-            }
-
-            if( xARPCache[ x ].ucAge == 0U )
-            {
-                /* The entry is no longer valid.  Wipe it out. */
-                iptraceARP_TABLE_ENTRY_EXPIRED( xARPCache[ x ].ulIPAddress );
-                xARPCache[ x ].ulIPAddress = 0UL;
-            }
-        }
-    }
+        uint32_t ulHash = ulKey;
 
-    xTimeNow = xTaskGetTickCount();
+        ulHash ^= ulHash >> 16;
+        ulHash *= 0x45D9F3BUL;
+        ulHash ^= ulHash >> 16;
 
-    if( ( xLastGratuitousARPTime == ( TickType_t ) 0 ) || ( ( xTimeNow - xLastGratuitousARPTime ) > ( TickType_t ) arpGRATUITOUS_ARP_PERIOD ) )
-    {
-        FreeRTOS_OutputARPRequest( *ipLOCAL_IP_ADDRESS_POINTER );
-        xLastGratuitousARPTime = xTimeNow;
+        return ( size_t ) ( ulHash % ( uint32_t ) ipconfigARP_HASH_SIZE );
     }
-}
-/*-----------------------------------------------------------*/
+    /*-----------------------------------------------------------*/
 
 /**
- * @brief Send a Gratuitous ARP packet to allow this node to announce the IP-MAC
- *        mapping to the entire network.
+ * @brief Get the home slot of a MAC address.
+ *
+ * @param[in] pxMACAddress: The MAC address.
+ *
+ * @return The home slot of the MAC address.
  */
-void vARPSendGratuitous( void )
-{
-    /* Setting xLastGratuitousARPTime to 0 will force a gratuitous ARP the next
-     * time vARPAgeCache() is called. */
-    xLastGratuitousARPTime = ( TickType_t ) 0;
+    static size_t prvARPHashMAC( const MACAddress_t * pxMACAddress )
+    {
+        uint32_t ulKey;
 
-    /* Let the IP-task call vARPAgeCache(). */
-    ( void ) xSendEventToIPTask( eARPTimerEvent );
-}
+        /* The last 4 bytes differ most between devices, fold in the first 2. */
+        ( void ) memcpy( &( ulKey ), &( pxMACAddress->ucBytes[ 2 ] ), sizeof( ulKey ) );
+        ulKey ^= ( ( uint32_t ) pxMACAddress->ucBytes[ 0 ] << 8 ) | ( uint32_t ) pxMACAddress->ucBytes[ 1 ];
 
-/*-----------------------------------------------------------*/
+        return prvARPHashKey( ulKey );
+    }
+    /*-----------------------------------------------------------*/
 
 /**
- * @brief Create and send an ARP request packet.
+ * @brief Get the home slot of a row in one of the hash indexes.
  *
- * @param[in] ulIPAddress: A 32-bit representation of the IP-address whose
+ * @param[in] xRow: The row in xARPCache[].
+ * @param[in] xByMAC: pdTRUE for the MAC index, pdFALSE for the IP index.
+ *
+ * @return The home slot of the row.
+ */
+    static size_t prvARPRowHome( BaseType_t xRow,
+                                 BaseType_t xByMAC )
+    {
+        size_t uxSlot;
+
+        if( xByMAC != pdFALSE )
+        {
+            uxSlot = prvARPHashMAC( &( xARPCache[ xRow ].xMACAddress ) );
+        }
+        else
+        {
+            uxSlot = prvARPHashKey( xARPCache[ xRow ].ulIPAddress );
+        }
+
+        return uxSlot;
+    }
+    /*-----------------------------------------------------------*/
+
+/**
+ * @brief Add a row to a hash index.  There is always an empty slot because
+ *        the index has more slots than there are rows.
+ *
+ * @param[in] pusIndex: The hash index.
+ * @param[in] xByMAC: pdTRUE when pusIndex is keyed on the MAC address.
+ * @param[in] xRow: The row to add.
+ */
+    static void prvARPIndexAdd( uint16_t * pusIndex,
+                                BaseType_t xByMAC,
+                                BaseType_t xRow )
+    {
+        size_t uxSlot = prvARPRowHome( xRow, xByMAC );
+
+        while( pusIndex[ uxSlot ] != arpHASH_EMPTY )
+        {
+            uxSlot = ( uxSlot + 1U ) % ( size_t ) ipconfigARP_HASH_SIZE;
+        }
+
+        pusIndex[ uxSlot ] = ( uint16_t ) ( xRow + 1 );
+    }
+    /*-----------------------------------------------------------*/
+
+/**
+ * @brief Remove a row from a hash index, if it is present.  The rows that
+ *        follow it in the same probe sequence are shifted back, so no
+ *        tombstones are needed.
+ *
+ * @param[in] pusIndex: The hash index.
+ * @param[in] xByMAC: pdTRUE when pusIndex is keyed on the MAC address.
+ * @param[in] xRow: The row to remove.  Its key must not have changed since
+ *                  it was added.
+ */
+    static void prvARPIndexDelete( uint16_t * pusIndex,
+                                   BaseType_t xByMAC,
+                                   BaseType_t xRow )
+    {
+        size_t uxHole = prvARPRowHome( xRow, xByMAC );
+        size_t uxNext, uxHome;
+
+        while( ( pusIndex[ uxHole ] != arpHASH_EMPTY ) && ( pusIndex[ uxHole ] != ( uint16_t ) ( xRow + 1 ) ) )
+        {
+            uxHole = ( uxHole + 1U ) % ( size_t ) ipconfigARP_HASH_SIZE;
+        }
+
+        if( pusIndex[ uxHole ] != arpHASH_EMPTY )
+        {
+            uxNext = uxHole;
+
+            for( ; ; )
+            {
+                uxNext = ( uxNext + 1U ) % ( size_t ) ipconfigARP_HASH_SIZE;
+
+                if( pusIndex[ uxNext ] == arpHASH_EMPTY )
+                {
+                    break;
+                }
+
+                uxHome = prvARPRowHome( ( BaseType_t ) pusIndex[ uxNext ] - 1, xByMAC );
+
+                /* The entry may only move back to the hole when its home slot
+                 * is not cyclically in ( uxHole, uxNext ]. */
+                if( ( uxHole <= uxNext ) ? ( ( uxHome <= uxHole ) || ( uxHome > uxNext ) ) :
+                    ( ( uxHome <= uxHole ) && ( uxHome > uxNext ) ) )
+                {
+                    pusIndex[ uxHole ] = pusIndex[ uxNext ];
+                    uxHole = uxNext;
+                }
+            }
+
+            pusIndex[ uxHole ] = arpHASH_EMPTY;
+        }
+    }
+    /*-----------------------------------------------------------*/
+
+/**
+ * @brief Put all rows in the LRU list, in case that has not been done yet.
+ *        The list is empty after start-up and after FreeRTOS_ClearARP().
+ */
+    static void prvARPHashInit( void )
+    {
+        BaseType_t x;
+
+        if( usARPLRUHead == arpLRU_NONE )
+        {
+            for( x = 0; x < ipconfigARP_CACHE_ENTRIES; x++ )
+            {
+                usARPLRUPrev[ x ] = ( x == 0 ) ? arpLRU_NONE : ( uint16_t ) ( x - 1 );
+                usARPLRUNext[ x ] = ( x == ( ipconfigARP_CACHE_ENTRIES - 1 ) ) ? arpLRU_NONE : ( uint16_t ) ( x + 1 );
+            }
+
+            usARPLRUHead = 0U;
+            usARPLRUTail = ( uint16_t ) ( ipconfigARP_CACHE_ENTRIES - 1 );
+        }
+    }
+    /*-----------------------------------------------------------*/
+
+/**
+ * @brief Find the row that holds an IP address.
+ *
+ * @param[in] ulIPAddress: The IP address to look for.
+ *
+ * @return The row, or -1 when the address is not in the cache.
+ */
+    static BaseType_t prvARPFindIP( uint32_t ulIPAddress )
+    {
+        size_t uxSlot = prvARPHashKey( ulIPAddress );
+        BaseType_t xRow, xResult = -1;
+
+        if( ulIPAddress != 0UL )
+        {
+            while( usARPIPIndex[ uxSlot ] != arpHASH_EMPTY )
+            {
+                xRow = ( BaseType_t ) usARPIPIndex[ uxSlot ] - 1;
+
+                if( xARPCache[ xRow ].ulIPAddress == ulIPAddress )
+                {
+                    xResult = xRow;
+                    break;
+                }
+
+                uxSlot = ( uxSlot + 1U ) % ( size_t ) ipconfigARP_HASH_SIZE;
+            }
+        }
+
+        return xResult;
+    }
+    /*-----------------------------------------------------------*/
+
+/**
+ * @brief Check if a row that holds the same MAC address may be re-used for
+ *        ulIPAddress.  When remote addresses are stored, the MAC address of
+ *        the gateway is shared by many remote IP addresses; such a row may
+ *        only be used by an address on the same side of the netmask.
+ *
+ * @param[in] xRow: The row with a matching MAC address.
+ * @param[in] ulIPAddress: The IP address that will be stored, or zero.
+ *
+ * @return pdTRUE when the row may be used.
+ */
+    static BaseType_t prvARPSameSide( BaseType_t xRow,
+                                      uint32_t ulIPAddress )
+    {
+        BaseType_t xResult = pdTRUE;
+
+        #if ( ipconfigARP_STORES_REMOTE_ADDRESSES != 0 )
+            {
+                uint32_t ulLocal = ( *ipLOCAL_IP_ADDRESS_POINTER ) & xNetworkAddressing.ulNetMask;
+
+                if( ( ulIPAddress != 0UL ) &&
+                    ( ( ( xARPCache[ xRow ].ulIPAddress & xNetworkAddressing.ulNetMask ) == ulLocal ) !=
+                      ( ( ulIPAddress & xNetworkAddressing.ulNetMask ) == ulLocal ) ) )
+                {
+                    xResult = pdFALSE;
+                }
+            }
+        #else
+            {
+                ( void ) xRow;
+                ( void ) ulIPAddress;
+            }
+        #endif
+
+        return xResult;
+    }
+    /*-----------------------------------------------------------*/
+
+/**
+ * @brief Find a row with a valid mapping for a MAC address.
+ *
+ * @param[in] pxMACAddress: The MAC address to look for.
+ * @param[in] ulIPAddress: When non-zero, the row must be usable for this
+ *                         IP address, see prvARPSameSide().
+ *
+ * @return The row, or -1 when not found.
+ */
+    static BaseType_t prvARPFindMAC( const MACAddress_t * pxMACAddress,
+                                     uint32_t ulIPAddress )
+    {
+        BaseType_t xRow, xResult = -1;
+
+        #if ( ipconfigARP_HASH_MAC_INDEX == 1 )
+            {
+                size_t uxSlot = prvARPHashMAC( pxMACAddress );
+
+                while( usARPMACIndex[ uxSlot ] != arpHASH_EMPTY )
+                {
+                    xRow = ( BaseType_t ) usARPMACIndex[ uxSlot ] - 1;
+
+                    if( ( memcmp( xARPCache[ xRow ].xMACAddress.ucBytes, pxMACAddress->ucBytes, sizeof( pxMACAddress->ucBytes ) ) == 0 ) &&
+                        ( prvARPSameSide( xRow, ulIPAddress ) != pdFALSE ) )
+                    {
+                        xResult = xRow;
+                        break;
+                    }
+
+                    uxSlot = ( uxSlot + 1U ) % ( size_t ) ipconfigARP_HASH_SIZE;
+                }
+            }
+        #else /* if ( ipconfigARP_HASH_MAC_INDEX == 1 ) */
+            {
+                for( xRow = 0; xRow < ipconfigARP_CACHE_ENTRIES; xRow++ )
+                {
+                    if( ( xARPCache[ xRow ].ulIPAddress != 0UL ) &&
+                        ( xARPCache[ xRow ].ucValid != ( uint8_t ) pdFALSE ) &&
+                        ( memcmp( xARPCache[ xRow ].xMACAddress.ucBytes, pxMACAddress->ucBytes, sizeof( pxMACAddress->ucBytes ) ) == 0 ) &&
+                        ( prvARPSameSide( xRow, ulIPAddress ) != pdFALSE ) )
+                    {
+                        xResult = xRow;
+                        break;
+                    }
+                }
+            }
+        #endif /* if ( ipconfigARP_HASH_MAC_INDEX == 1 ) */
+
+        return xResult;
+    }
+    /*-----------------------------------------------------------*/
+
+/**
+ * @brief Remove a row from the hash indexes, before its IP address, its MAC
+ *        address or its validity changes.
+ *
+ * @param[in] xRow: The row that will change.
+ */
+    static void prvARPRowUnlink( BaseType_t xRow )
+    {
+        if( xARPCache[ xRow ].ulIPAddress != 0UL )
+        {
+            prvARPIndexDelete( usARPIPIndex, pdFALSE, xRow );
+
+            #if ( ipconfigARP_HASH_MAC_INDEX == 1 )
+                {
+                    if( xARPCache[ xRow ].ucValid != ( uint8_t ) pdFALSE )
+                    {
+                        prvARPIndexDelete( usARPMACIndex, pdTRUE, xRow );
+                    }
+                }
+            #endif
+        }
+    }
+    /*-----------------------------------------------------------*/
+
+/**
+ * @brief Add a row to the hash indexes after it has changed.
+ *
+ * @param[in] xRow: The row that has changed.
+ */
+    static void prvARPRowLink( BaseType_t xRow )
+    {
+        if( xARPCache[ xRow ].ulIPAddress != 0UL )
+        {
+            prvARPIndexAdd( usARPIPIndex, pdFALSE, xRow );
+
+            #if ( ipconfigARP_HASH_MAC_INDEX == 1 )
+                {
+                    if( xARPCache[ xRow ].ucValid != ( uint8_t ) pdFALSE )
+                    {
+                        prvARPIndexAdd( usARPMACIndex, pdTRUE, xRow );
+                    }
+                }
+            #endif
+        }
+    }
+    /*-----------------------------------------------------------*/
+
+/**
+ * @brief Take a row out of the LRU list.
+ *
+ * @param[in] xRow: The row.
+ */
+    static void prvARPLRUDetach( BaseType_t xRow )
+    {
+        uint16_t usPrev = usARPLRUPrev[ xRow ];
+        uint16_t usNext = usARPLRUNext[ xRow ];
+
+        if( usPrev != arpLRU_NONE )
+        {
+            usARPLRUNext[ usPrev ] = usNext;
+        }
+        else
+        {
+            usARPLRUHead = usNext;
+        }
+
+        if( usNext != arpLRU_NONE )
+        {
+            usARPLRUPrev[ usNext ] = usPrev;
+        }
+        else
+        {
+            usARPLRUTail = usPrev;
+        }
+    }
+    /*-----------------------------------------------------------*/
+
+/**
+ * @brief Make a row the most recently used one.
+ *
+ * @param[in] xRow: The row that was used.
+ */
+    static void prvARPTouch( BaseType_t xRow )
+    {
+        if( usARPLRUHead != ( uint16_t ) xRow )
+        {
+            prvARPLRUDetach( xRow );
+            usARPLRUPrev[ xRow ] = arpLRU_NONE;
+            usARPLRUNext[ xRow ] = usARPLRUHead;
+            usARPLRUPrev[ usARPLRUHead ] = ( uint16_t ) xRow;
+            usARPLRUHead = ( uint16_t ) xRow;
+        }
+    }
+    /*-----------------------------------------------------------*/
+
+/**
+ * @brief Move a row that has been cleared to the tail of the LRU list, so
+ *        that it is the first one to be re-used.
+ *
+ * @param[in] xRow: The row that was cleared.
+ */
+    static void prvARPRelease( BaseType_t xRow )
+    {
+        if( usARPLRUTail != ( uint16_t ) xRow )
+        {
+            prvARPLRUDetach( xRow );
+            usARPLRUNext[ xRow ] = arpLRU_NONE;
+            usARPLRUPrev[ xRow ] = usARPLRUTail;
+            usARPLRUNext[ usARPLRUTail ] = ( uint16_t ) xRow;
+            usARPLRUTail = ( uint16_t ) xRow;
+        }
+    }
+    /*-----------------------------------------------------------*/
+
+#endif /* ipconfigUSE_ARP_HASH */
+
+#if ( ipconfigUSE_ARP_DEADLINE_AGING == 1 )
+
+/**
+ * @brief Read the clock of the ARP deadlines.  It counts clock ticks, like
+ *        xTaskGetTickCount(), but it has 32 bits also when TickType_t is
+ *        16 bits wide.  It must be called at least once every 65535 ticks,
+ *        which vARPAgeCache() does.
+ *
+ * @return The current time in clock ticks.
+ */
+    static uint32_t prvARPNow( void )
+    {
+        TickType_t xTick = xTaskGetTickCount();
+
+        ulARPClock += ( uint32_t ) ( ( TickType_t ) ( xTick - xARPClockTick ) );
+        xARPClockTick = xTick;
+
+        return ulARPClock;
+    }
+    /*-----------------------------------------------------------*/
+
+/**
+ * @brief Calculate when a row needs attention, based on its age and on the
+ *        time of the last event.
+ *
+ * @param[in] xRow: The row in the ARP cache.
+ *
+ * @return The time at which the next ARP request for this row is due.
+ */
+    static uint32_t prvARPDue( BaseType_t xRow )
+    {
+        uint32_t ulDue = ulARPEventTime[ xRow ] + arpAGING_PERIOD;
+        uint32_t ulJitter;
+
+        if( ( xARPCache[ xRow ].ucValid != ( uint8_t ) pdFALSE ) &&
+            ( xARPCache[ xRow ].ucAge > ( uint8_t ) arpMAX_ARP_AGE_BEFORE_NEW_ARP_REQUEST ) )
+        {
+            /* A fresh entry.  The first probe is sent when the periodic sweep
+             * would have sent it, minus a part of a period that depends on the
+             * IP address.  Entries that were learned at the same moment will
+             * not all be probed at once. */
+            ulJitter = ( ( xARPCache[ xRow ].ulIPAddress * 0x9E3779B1U ) >> 16 ) % arpAGING_PERIOD;
+            ulDue += ( ( ( uint32_t ) xARPCache[ xRow ].ucAge - ( uint32_t ) arpMAX_ARP_AGE_BEFORE_NEW_ARP_REQUEST - 1U ) * arpAGING_PERIOD ) - ulJitter;
+        }
+
+        return ulDue;
+    }
+    /*-----------------------------------------------------------*/
+
+/**
+ * @brief Move an element of the deadline heap towards the top, as long as its
+ *        deadline is earlier than the one of its parent.
+ *
+ * @param[in] xPosition: The position of the element in usARPHeap[].
+ */
+    static void prvARPHeapUp( BaseType_t xPosition )
+    {
+        BaseType_t xChild = xPosition;
+        BaseType_t xParent;
+        uint16_t usRow = usARPHeap[ xChild ];
+
+        while( xChild > 0 )
+        {
+            xParent = ( xChild - 1 ) / 2;
+
+            if( arpTIME_BEFORE( ulARPDeadline[ usRow ], ulARPDeadline[ usARPHeap[ xParent ] ] ) == pdFALSE )
+            {
+                break;
+            }
+
+            usARPHeap[ xChild ] = usARPHeap[ xParent ];
+            usARPHeapPosition[ usARPHeap[ xChild ] ] = ( uint16_t ) ( xChild + 1 );
+            xChild = xParent;
+        }
+
+        usARPHeap[ xChild ] = usRow;
+        usARPHeapPosition[ usRow ] = ( uint16_t ) ( xChild + 1 );
+    }
+    /*-----------------------------------------------------------*/
+
+/**
+ * @brief Move an element of the deadline heap towards the bottom, as long as
+ *        a child has an earlier deadline.
+ *
+ * @param[in] xPosition: The position of the element in usARPHeap[].
+ */
+    static void prvARPHeapDown( BaseType_t xPosition )
+    {
+        BaseType_t xParent = xPosition;
+        BaseType_t xChild;
+        uint16_t usRow = usARPHeap[ xParent ];
+
+        for( ; ; )
+        {
+            xChild = ( 2 * xParent ) + 1;
+
+            if( xChild >= xARPHeapCount )
+            {
+                break;
+            }
+
+            if( ( ( xChild + 1 ) < xARPHeapCount ) &&
+                ( arpTIME_BEFORE( ulARPDeadline[ usARPHeap[ xChild + 1 ] ], ulARPDeadline[ usARPHeap[ xChild ] ] ) ) )
+            {
+                xChild++;
+            }
+
+            if( arpTIME_BEFORE( ulARPDeadline[ usARPHeap[ xChild ] ], ulARPDeadline[ usRow ] ) == pdFALSE )
+            {
+                break;
+            }
+
+            usARPHeap[ xParent ] = usARPHeap[ xChild ];
+            usARPHeapPosition[ usARPHeap[ xParent ] ] = ( uint16_t ) ( xParent + 1 );
+            xParent = xChild;
+        }
+
+        usARPHeap[ xParent ] = usRow;
+        usARPHeapPosition[ usRow ] = ( uint16_t ) ( xParent + 1 );
+    }
+    /*-----------------------------------------------------------*/
+
+/**
+ * @brief A row has been created or refreshed.  Record the time, and make sure
+ *        that the row is in the deadline heap with a deadline that is not
+ *        later than the time it is due.  A refresh that only moves the time
+ *        further away does not touch the heap.
+ *
+ * @param[in] xRow: The row that was created or refreshed.
+ */
+    static void prvARPSchedule( BaseType_t xRow )
+    {
+        uint32_t ulNow = prvARPNow();
+        uint32_t ulDue;
+        BaseType_t xPosition;
+
+        ulARPEventTime[ xRow ] = ulNow;
+        ulDue = prvARPDue( xRow );
+
+        if( usARPHeapPosition[ xRow ] == 0U )
+        {
+            xPosition = xARPHeapCount;
+            xARPHeapCount++;
+            usARPHeap[ xPosition ] = ( uint16_t ) xRow;
+            ulARPDeadline[ xRow ] = ulDue;
+            prvARPHeapUp( xPosition );
+        }
+        else if( arpTIME_BEFORE( ulDue, ulARPDeadline[ xRow ] ) )
+        {
+            ulARPDeadline[ xRow ] = ulDue;
+            prvARPHeapUp( ( BaseType_t ) usARPHeapPosition[ xRow ] - 1 );
+        }
+        else
+        {
+            /* The row will be re-queued when its old deadline comes up. */
+        }
+
+        if( arpTIME_BEFORE( ulNow, ulARPNextWake ) && arpTIME_BEFORE( ulARPDeadline[ xRow ], ulARPNextWake ) )
+        {
+            /* The ARP timer would wake up too late for this row. */
+            ulARPNextWake = ulARPDeadline[ xRow ];
+            vIPReloadARPTimer( ( TickType_t ) ( ulARPNextWake - ulNow ) );
+        }
+    }
+    /*-----------------------------------------------------------*/
+
+/**
+ * @brief Take a row out of the deadline heap, after it has been cleared.
+ *
+ * @param[in] xRow: The row that was cleared.
+ */
+    static void prvARPUnschedule( BaseType_t xRow )
+    {
+        BaseType_t xPosition;
+        uint16_t usLast;
+
+        if( usARPHeapPosition[ xRow ] != 0U )
+        {
+            xPosition = ( BaseType_t ) usARPHeapPosition[ xRow ] - 1;
+            usARPHeapPosition[ xRow ] = 0U;
+            xARPHeapCount--;
+
+            if( xPosition < xARPHeapCount )
+            {
+                /* Fill the hole with the last element. */
+                usLast = usARPHeap[ xARPHeapCount ];
+                usARPHeap[ xPosition ] = usLast;
+                usARPHeapPosition[ usLast ] = ( uint16_t ) ( xPosition + 1 );
+                prvARPHeapUp( xPosition );
+                prvARPHeapDown( ( BaseType_t ) usARPHeapPosition[ usLast ] - 1 );
+            }
+        }
+    }
+    /*-----------------------------------------------------------*/
+
+/**
+ * @brief Handle the entries of the ARP cache that are due: send an ARP request
+ *        for entries that are about to expire, or that wait for a reply, and
+ *        remove the entries that have expired.  Entries that are not due are
+ *        not visited.
+ *
+ * @return The number of clock ticks until the next entry is due.
+ */
+    static uint32_t prvARPAgeDueEntries( void )
+    {
+        uint32_t ulNow = prvARPNow();
+        uint32_t ulDelay = 0xFFFFFFFFUL; /* Stays so when no entry is queued. */
+        uint32_t ulDue;
+        BaseType_t xRow;
+
+        while( xARPHeapCount > 0 )
+        {
+            xRow = ( BaseType_t ) usARPHeap[ 0 ];
+
+            if( arpTIME_BEFORE( ulNow, ulARPDeadline[ xRow ] ) )
+            {
+                /* The first entry in the heap is not due yet. */
+                ulDelay = ulARPDeadline[ xRow ] - ulNow;
+                break;
+            }
+
+            ulDue = prvARPDue( xRow );
+
+            if( arpTIME_BEFORE( ulNow, ulDue ) )
+            {
+                /* The entry was refreshed after it was queued. */
+                ulARPDeadline[ xRow ] = ulDue;
+            }
+            else
+            {
+                if( ( xARPCache[ xRow ].ucValid != ( uint8_t ) pdFALSE ) &&
+                    ( xARPCache[ xRow ].ucAge > ( uint8_t ) arpMAX_ARP_AGE_BEFORE_NEW_ARP_REQUEST ) )
+                {
+                    /* The entry has not been refreshed for the whole period,
+                     * start probing it. */
+                    xARPCache[ xRow ].ucAge = ( uint8_t ) arpMAX_ARP_AGE_BEFORE_NEW_ARP_REQUEST;
+                }
+                else
+                {
+                    ( xARPCache[ xRow ].ucAge )--;
+                }
+
+                if( xARPCache[ xRow ].ucValid == ( uint8_t ) pdFALSE )
+                {
+                    /* Still waiting for a reply, retransmit the ARP request. */
+                    prvARPRequestRow( xRow );
+                }
+                else
+                {
+                    /* This entry will get removed soon.  See if the MAC address
+                     * is still valid to prevent this happening. */
+                    iptraceARP_TABLE_ENTRY_WILL_EXPIRE( xARPCache[ xRow ].ulIPAddress );
+                    FreeRTOS_OutputARPRequest( xARPCache[ xRow ].ulIPAddress );
+                }
+
+                ulARPEventTime[ xRow ] = ulNow;
+                ulARPDeadline[ xRow ] = ulNow + arpAGING_PERIOD;
+            }
+
+            if( xARPCache[ xRow ].ucAge == 0U )
+            {
+                /* The entry is no longer valid.  Wipe it out. */
+                iptraceARP_TABLE_ENTRY_EXPIRED( xARPCache[ xRow ].ulIPAddress );
+                arpROW_UNLINK( xRow );
+                xARPCache[ xRow ].ulIPAddress = 0UL;
+                arpROW_REMOVE( xRow );
+                vARPIncrementGeneration();
+            }
+            else
+            {
+                prvARPHeapDown( 0 );
+            }
+        }
+
+        return ulDelay;
+    }
+    /*-----------------------------------------------------------*/
+#endif /* ipconfigUSE_ARP_DEADLINE_AGING */
+
+/**
+ * @brief A call to this function will update (or 'Age') the ARP cache entries.
+ *        The function will also try to prevent a removal of entry by sending
+ *        an ARP query. It will also check whether we are waiting on an ARP
+ *        reply - if we are, then an ARP request will be re-sent.
+ *        In case an ARP entry has 'Aged' to 0, it will be removed from the ARP
+ *        cache.
+ */
+void vARPAgeCache( void )
+{
+    TickType_t xTimeNow;
+
+    #if ( ipconfigUSE_ARP_DEADLINE_AGING == 1 )
+        uint32_t ulDelay;
+        TickType_t xGratuitousDelay;
+
+        /* Only visit the entries that are due. */
+        ulDelay = prvARPAgeDueEntries();
+    #else
+        {
+            BaseType_t x;
+
+            /* Loop through each entry in the ARP cache. */
+            for( x = 0; x < ipconfigARP_CACHE_ENTRIES; x++ )
+            {
+                /* If the entry is valid (its age is greater than zero). */
+                if( xARPCache[ x ].ucAge > 0U )
+                {
+                    /* Decrement the age value of the entry in this ARP cache table row.
+                     * When the age reaches zero it is no longer considered valid. */
+                    ( xARPCache[ x ].ucAge )--;
+
+                    /* If the entry is not yet valid, then it is waiting an ARP
+                     * reply, and the ARP request should be retransmitted. */
+                    if( xARPCache[ x ].ucValid == ( uint8_t ) pdFALSE )
+                    {
+                        prvARPRequestRow( x );
+                    }
+                    else if( xARPCache[ x ].ucAge <= ( uint8_t ) arpMAX_ARP_AGE_BEFORE_NEW_ARP_REQUEST )
+                    {
+                        /* This entry will get removed soon.  See if the MAC address is
+                         * still valid to prevent this happening. */
+                        iptraceARP_TABLE_ENTRY_WILL_EXPIRE( xARPCache[ x ].ulIPAddress );
+                        FreeRTOS_OutputARPRequest( xARPCache[ x ].ulIPAddress );
+                    }
+                    else
+                    {
+                        /* The age has just ticked down, with nothing to do. */
+                    }
+
+                    if( xARPCache[ x ].ucAge == 0U )
+                    {
+                        /* The entry is no longer valid.  Wipe it out. */
+                        iptraceARP_TABLE_ENTRY_EXPIRED( xARPCache[ x ].ulIPAddress );
+                        arpROW_UNLINK( x );
+                        xARPCache[ x ].ulIPAddress = 0UL;
+                        arpROW_REMOVE( x );
+                        vARPIncrementGeneration();
+                    }
+                }
+            }
+        }
+    #endif /* ipconfigUSE_ARP_DEADLINE_AGING */
+
+    xTimeNow = xTaskGetTickCount();
+
+    if( ( xLastGratuitousARPTime == ( TickType_t ) 0 ) || ( ( xTimeNow - xLastGratuitousARPTime ) > ( TickType_t ) arpGRATUITOUS_ARP_PERIOD ) )
+    {
+        FreeRTOS_OutputARPRequest( *ipLOCAL_IP_ADDRESS_POINTER );
+        xLastGratuitousARPTime = xTimeNow;
+    }
+
+    #if ( ipconfigUSE_ARP_DEADLINE_AGING == 1 )
+        {
+            /* Wake up when the next entry is due, or when the next gratuitous
+             * ARP must be sent, whichever comes first. */
+            xGratuitousDelay = ( ( TickType_t ) arpGRATUITOUS_ARP_PERIOD + 1U ) - ( xTimeNow - xLastGratuitousARPTime );
+
+            if( ulDelay > ( uint32_t ) xGratuitousDelay )
+            {
+                ulDelay = ( uint32_t ) xGratuitousDelay;
+            }
+
+            ulARPNextWake = ulARPClock + ulDelay;
+            vIPReloadARPTimer( ( TickType_t ) ulDelay );
+        }
+    #endif
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Send a Gratuitous ARP packet to allow this node to announce the IP-MAC
+ *        mapping to the entire network.
+ */
+void vARPSendGratuitous( void )
+{
+    /* Setting xLastGratuitousARPTime to 0 will force a gratuitous ARP the next
+     * time vARPAgeCache() is called. */
+    xLastGratuitousARPTime = ( TickType_t ) 0;
+
+    /* Let the IP-task call vARPAgeCache(). */
+    ( void ) xSendEventToIPTask( eARPTimerEvent );
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Send an ARP request for a row that is waiting for a reply.  With
+ *        ipconfigUSE_ARP_REQUEST_LIMIT, the request is only sent when the
+ *        back-off interval of the previous request has passed, and when the
+ *        address has not been found to be unreachable.
+ *
+ * @param[in] xRow: The row in the ARP cache.
+ */
+static void prvARPRequestRow( BaseType_t xRow )
+{
+    BaseType_t xSend = pdTRUE;
+
+    #if ( ipconfigUSE_ARP_REQUEST_LIMIT == 1 )
+        {
+            uint8_t ucCount = ucARPRequestCount[ xRow ];
+            TickType_t xInterval = ( TickType_t ) pdMS_TO_TICKS( ipconfigARP_REQUEST_INTERVAL_MS );
+
+            if( ucCount > ( uint8_t ) ipconfigMAX_ARP_RETRANSMISSIONS )
+            {
+                /* The address did not answer before, wait until the entry
+                 * has aged out. */
+                xARPRequestStats.ulNegativeHits++;
+                xSend = pdFALSE;
+            }
+            else
+            {
+                if( ucCount > 1U )
+                {
+                    xInterval <<= ( ( ucCount - 1U ) < arpMAX_REQUEST_BACKOFF_SHIFT ) ? ( ucCount - 1U ) : arpMAX_REQUEST_BACKOFF_SHIFT;
+                }
+
+                if( ( ucCount > 0U ) && ( ( TickType_t ) ( xTaskGetTickCount() - xARPRequestTime[ xRow ] ) < xInterval ) )
+                {
+                    /* A request for this address is still outstanding. */
+                    xARPRequestStats.ulRequestsCoalesced++;
+                    xSend = pdFALSE;
+                }
+                else if( ucCount == ( uint8_t ) ipconfigMAX_ARP_RETRANSMISSIONS )
+                {
+                    /* The last request has not been answered either. */
+                    ucARPRequestCount[ xRow ]++;
+                    xARPRequestStats.ulUnreachable++;
+                    iptraceARP_DESTINATION_UNREACHABLE( xARPCache[ xRow ].ulIPAddress );
+                    xSend = pdFALSE;
+                }
+                else
+                {
+                    ucARPRequestCount[ xRow ]++;
+                    xARPRequestTime[ xRow ] = xTaskGetTickCount();
+                    xARPRequestStats.ulRequestsSent++;
+                }
+            }
+
+            if( xSend == pdFALSE )
+            {
+                iptraceARP_REQUEST_SUPPRESSED( xARPCache[ xRow ].ulIPAddress );
+            }
+        }
+    #endif /* ipconfigUSE_ARP_REQUEST_LIMIT */
+
+    if( xSend != pdFALSE )
+    {
+        FreeRTOS_OutputARPRequest( xARPCache[ xRow ].ulIPAddress );
+    }
+}
+/*-----------------------------------------------------------*/
+
+#if ( ipconfigUSE_ARP_REQUEST_LIMIT == 1 )
+
+/**
+ * @brief Find the row in the ARP cache that holds an IP address.
+ *
+ * @param[in] ulIPAddress: The IP address to look for.
+ *
+ * @return The row, or -1 when the address is not in the cache.
+ */
+    static BaseType_t prvARPFindRow( uint32_t ulIPAddress )
+    {
+        BaseType_t xRow = -1;
+
+        #if ( ipconfigUSE_ARP_HASH == 1 )
+            {
+                xRow = prvARPFindIP( ulIPAddress );
+            }
+        #else
+            {
+                BaseType_t x;
+
+                for( x = 0; x < ipconfigARP_CACHE_ENTRIES; x++ )
+                {
+                    if( xARPCache[ x ].ulIPAddress == ulIPAddress )
+                    {
+                        xRow = x;
+                        break;
+                    }
+                }
+            }
+        #endif /* if ( ipconfigUSE_ARP_HASH == 1 ) */
+
+        return xRow;
+    }
+    /*-----------------------------------------------------------*/
+
+/**
+ * @brief Make sure that an ARP request for an address is outstanding.  When
+ *        the address is not in the ARP cache, a pending entry is created and
+ *        a request is sent.  When a request is outstanding already, a new one
+ *        is only sent when its back-off interval has passed.
+ *
+ * @param[in] ulIPAddress: The IP address to resolve.
+ */
+    void vARPResolveAddress( uint32_t ulIPAddress )
+    {
+        BaseType_t xRow;
+
+        if( ulIPAddress != 0UL )
+        {
+            xRow = prvARPFindRow( ulIPAddress );
+
+            if( xRow < 0 )
+            {
+                /* Reserve an entry that waits for the reply.  This counts as
+                 * the first request. */
+                vARPRefreshCacheEntry( NULL, ulIPAddress );
+                FreeRTOS_OutputARPRequest( ulIPAddress );
+            }
+            else if( xARPCache[ xRow ].ucValid == ( uint8_t ) pdFALSE )
+            {
+                prvARPRequestRow( xRow );
+            }
+            else
+            {
+                /* The address has been resolved in the mean time. */
+            }
+        }
+    }
+    /*-----------------------------------------------------------*/
+
+/**
+ * @brief Get the counters of the ARP requests for addresses that were not
+ *        resolved yet.
+ *
+ * @param[out] pxStats: The counters are copied to this structure.
+ */
+    void vARPGetRequestStats( ARPRequestStats_t * pxStats )
+    {
+        *pxStats = xARPRequestStats;
+    }
+    /*-----------------------------------------------------------*/
+#endif /* ipconfigUSE_ARP_REQUEST_LIMIT */
+
+/**
+ * @brief Create and send an ARP request packet.
+ *
+ * @param[in] ulIPAddress: A 32-bit representation of the IP-address whose
  *                         physical (MAC) address is required.
  */
 void FreeRTOS_OutputARPRequest( uint32_t ulIPAddress )
@@ -1045,6 +2269,52 @@ void vARPGenerateRequestPacket( NetworkBufferDescriptor_t * const pxNetworkBuffe
 void FreeRTOS_ClearARP( void )
 {
     ( void ) memset( xARPCache, 0, sizeof( xARPCache ) );
+
+    #if ( ipconfigUSE_ARP_HASH == 1 )
+        {
+            ( void ) memset( usARPIPIndex, 0, sizeof( usARPIPIndex ) );
+            #if ( ipconfigARP_HASH_MAC_INDEX == 1 )
+                {
+                    ( void ) memset( usARPMACIndex, 0, sizeof( usARPMACIndex ) );
+                }
+            #endif
+            /* prvARPHashInit() will rebuild the LRU list. */
+            usARPLRUHead = arpLRU_NONE;
+            usARPLRUTail = arpLRU_NONE;
+        }
+    #endif
+
+    #if ( ipconfigUSE_ARP_DEADLINE_AGING == 1 )
+        {
+            ( void ) memset( usARPHeapPosition, 0, sizeof( usARPHeapPosition ) );
+            xARPHeapCount = 0;
+        }
+    #endif
+
+    vARPIncrementGeneration();
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Get the current ARP generation.  The generation changes whenever an
+ *        entry in the ARP cache is replaced or removed, or when the addressing
+ *        of the interface changes.  A user that keeps a copy of a MAC address
+ *        may use it for as long as the generation is unchanged.
+ *
+ * @return The ARP generation.
+ */
+uint32_t ulARPGetGeneration( void )
+{
+    return ulARPGeneration;
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Start a new ARP generation, see ulARPGetGeneration().
+ */
+void vARPIncrementGeneration( void )
+{
+    ulARPGeneration++;
 }
 /*-----------------------------------------------------------*/
 
@@ -43,6 +43,7 @@
 #include "FreeRTOS_UDP_IP.h"
 #include "FreeRTOS_DHCP.h"
 #include "FreeRTOS_ARP.h"
+#include "FreeRTOS_DNS.h"
 
 
 /* Exclude the entire file if DHCP is not enabled. */
@@ -51,6 +52,10 @@
     #include "NetworkInterface.h"
     #include "NetworkBufferManagement.h"
 
+    #if ( ipconfigUSE_DHCP_LEASE_HOOK != 0 ) && ( ipconfigDHCP_FAST_RECONNECT != 1 )
+        #error ipconfigUSE_DHCP_LEASE_HOOK requires ipconfigDHCP_FAST_RECONNECT
+    #endif
+
 /**
  * @brief Function to cast pointers to DHCPMessage_IPv4_t.
  */
@@ -124,6 +129,18 @@
  */
     static void prvCloseDHCPSocket( void );
 
+/*
+ * Start using the address that was acknowledged by the DHCP server.
+ */
+    static void prvAcceptDHCPLease( void );
+
+/*
+ * Ask for the address of the last lease again, without a discover.
+ */
+    #if ( ipconfigDHCP_FAST_RECONNECT == 1 )
+        static BaseType_t prvSendDHCPInitReboot( void );
+    #endif
+
 /*
  * After DHCP has failed to answer, prepare everything to start searching
  * for (trying-out) LinkLayer IP-addresses, using the random method: Send
@@ -138,6 +155,16 @@
 /** @brief Hold information in between steps in the DHCP state machine. */
     _static DHCPData_t xDHCPData;
 
+    #if ( ipconfigUSE_DNS != 0 ) && ( ipconfigDNS_MAX_SERVERS > 1 )
+
+/** @brief The DNS servers of option 6 of the last reply, in network byte order.
+ *         They are only handed to the DNS client when the lease is accepted. */
+        static uint8_t ucDHCPDNSServers[ ipconfigDNS_MAX_SERVERS * sizeof( uint32_t ) ];
+
+/** @brief The number of addresses stored in ucDHCPDNSServers. */
+        static UBaseType_t uxDHCPDNSServerCount = 0U;
+    #endif
+
 /*-----------------------------------------------------------*/
 
 /**
@@ -230,6 +257,17 @@
                      * have not already been created. */
                     prvInitialiseDHCP();
                     EP_DHCPData.eDHCPState = eWaitingSendFirstDiscover;
+
+                    #if ( ipconfigDHCP_FAST_RECONNECT == 1 )
+                        {
+                            /* While the last lease is valid, ask for its address
+                             * right away. */
+                            if( prvSendDHCPInitReboot() == pdPASS )
+                            {
+                                EP_DHCPData.eDHCPState = eWaitingAcknowledge;
+                            }
+                        }
+                    #endif
                     break;
 
                 case eWaitingSendFirstDiscover:
@@ -311,6 +349,16 @@
                             if( eAnswer == eDHCPContinue )
                         #endif /* ipconfigUSE_DHCP_HOOK */
                         {
+                            #if ( ipconfigDHCP_USE_RAPID_COMMIT == 1 )
+                                if( EP_DHCPData.xRapidCommit != pdFALSE )
+                                {
+                                    /* The server has committed the lease already,
+                                     * there is no need for a request. */
+                                    prvAcceptDHCPLease();
+                                    break;
+                                }
+                            #endif
+
                             /* An offer has been made, the user wants to continue,
                              * generate the request. */
                             if( prvSendDHCPRequest() == pdPASS )
@@ -416,43 +464,7 @@
                     /* Look for acks coming in. */
                     if( prvProcessDHCPReplies( dhcpMESSAGE_TYPE_ACK ) == pdPASS )
                     {
-                        FreeRTOS_debug_printf( ( "vDHCPProcess: acked %lxip\n", FreeRTOS_ntohl( EP_DHCPData.ulOfferedIPAddress ) ) );
-
-                        /* DHCP completed.  The IP address can now be used, and the
-                         * timer set to the lease timeout time. */
-                        *ipLOCAL_IP_ADDRESS_POINTER = EP_DHCPData.ulOfferedIPAddress;
-
-                        /* Setting the 'local' broadcast address, something like
-                         * '192.168.1.255'. */
-                        EP_IPv4_SETTINGS.ulBroadcastAddress = ( EP_DHCPData.ulOfferedIPAddress & xNetworkAddressing.ulNetMask ) | ~xNetworkAddressing.ulNetMask;
-                        EP_DHCPData.eDHCPState = eLeasedAddress;
-
-                        iptraceDHCP_SUCCEDEED( EP_DHCPData.ulOfferedIPAddress );
-
-                        /* DHCP failed, the default configured IP-address will be used
-                         * Now call vIPNetworkUpCalls() to send the network-up event and
-                         * start the ARP timer. */
-                        vIPNetworkUpCalls();
-
-                        /* Close socket to ensure packets don't queue on it. */
-                        prvCloseDHCPSocket();
-
-                        if( EP_DHCPData.ulLeaseTime == 0UL )
-                        {
-                            EP_DHCPData.ulLeaseTime = ( uint32_t ) dhcpDEFAULT_LEASE_TIME;
-                        }
-                        else if( EP_DHCPData.ulLeaseTime < dhcpMINIMUM_LEASE_TIME )
-                        {
-                            EP_DHCPData.ulLeaseTime = dhcpMINIMUM_LEASE_TIME;
-                        }
-                        else
-                        {
-                            /* The lease time is already valid. */
-                        }
-
-                        /* Check for clashes. */
-                        vARPSendGratuitous();
-                        vIPReloadDHCPTimer( EP_DHCPData.ulLeaseTime );
+                        prvAcceptDHCPLease();
                     }
                     else
                     {
@@ -463,6 +475,20 @@
                              * point of giving up - send another request. */
                             EP_DHCPData.xDHCPTxPeriod <<= 1;
 
+                            #if ( ipconfigDHCP_FAST_RECONNECT == 1 )
+                                if( ( EP_DHCPData.xInitReboot != pdFALSE ) &&
+                                    ( EP_DHCPData.xDHCPTxPeriod > ( dhcpINIT_REBOOT_TX_PERIOD * 2U ) ) )
+                                {
+                                    /* The last lease was asked for twice without an
+                                     * answer, maybe the device is in another network.
+                                     * Start with a discover. */
+                                    FreeRTOS_debug_printf( ( "vDHCPProcess: no answer for %lxip, discover\n", FreeRTOS_ntohl( EP_DHCPData.ulOfferedIPAddress ) ) );
+                                    EP_DHCPData.xInitReboot = pdFALSE;
+                                    prvInitialiseDHCP();
+                                    EP_DHCPData.eDHCPState = eWaitingSendFirstDiscover;
+                                }
+                                else
+                            #endif /* ipconfigDHCP_FAST_RECONNECT == 1 */
                             if( EP_DHCPData.xDHCPTxPeriod <= ( TickType_t ) ipconfigMAXIMUM_DISCOVER_TX_PERIOD )
                             {
                                 EP_DHCPData.xDHCPTxTime = xTaskGetTickCount();
@@ -601,6 +627,164 @@
     }
     /*-----------------------------------------------------------*/
 
+/**
+ * @brief The DHCP server has acknowledged the offered address: start using it,
+ *        and set the timer to renew the lease.
+ */
+    static void prvAcceptDHCPLease( void )
+    {
+        FreeRTOS_debug_printf( ( "vDHCPProcess: acked %lxip\n", FreeRTOS_ntohl( EP_DHCPData.ulOfferedIPAddress ) ) );
+
+        /* DHCP completed.  The IP address can now be used, and the
+         * timer set to the lease timeout time. */
+        *ipLOCAL_IP_ADDRESS_POINTER = EP_DHCPData.ulOfferedIPAddress;
+
+        /* Setting the 'local' broadcast address, something like
+         * '192.168.1.255'. */
+        EP_IPv4_SETTINGS.ulBroadcastAddress = ( EP_DHCPData.ulOfferedIPAddress & xNetworkAddressing.ulNetMask ) | ~xNetworkAddressing.ulNetMask;
+        EP_DHCPData.eDHCPState = eLeasedAddress;
+
+        #if ( ipconfigUSE_DNS != 0 ) && ( ipconfigDNS_MAX_SERVERS > 1 )
+            {
+                if( uxDHCPDNSServerCount > 0U )
+                {
+                    vDNSSetDHCPServers( ucDHCPDNSServers, uxDHCPDNSServerCount );
+                }
+            }
+        #endif
+
+        iptraceDHCP_SUCCEDEED( EP_DHCPData.ulOfferedIPAddress );
+
+        /* DHCP failed, the default configured IP-address will be used
+         * Now call vIPNetworkUpCalls() to send the network-up event and
+         * start the ARP timer. */
+        vIPNetworkUpCalls();
+
+        /* Close socket to ensure packets don't queue on it. */
+        prvCloseDHCPSocket();
+
+        if( EP_DHCPData.ulLeaseTime == 0UL )
+        {
+            EP_DHCPData.ulLeaseTime = ( uint32_t ) dhcpDEFAULT_LEASE_TIME;
+        }
+        else if( EP_DHCPData.ulLeaseTime < dhcpMINIMUM_LEASE_TIME )
+        {
+            EP_DHCPData.ulLeaseTime = dhcpMINIMUM_LEASE_TIME;
+        }
+        else
+        {
+            /* The lease time is already valid. */
+        }
+
+        /* Check for clashes. */
+        vARPSendGratuitous();
+        vIPReloadDHCPTimer( EP_DHCPData.ulLeaseTime );
+
+        #if ( ipconfigDHCP_FAST_RECONNECT == 1 )
+            {
+                /* Remember the lease, so that its address can be asked for
+                 * again when the network comes back. */
+                EP_DHCPData.xInitReboot = pdFALSE;
+                EP_DHCPData.xLease.ulIPAddress = EP_DHCPData.ulOfferedIPAddress;
+                EP_DHCPData.xLease.ulNetMask = EP_IPv4_SETTINGS.ulNetMask;
+                EP_DHCPData.xLease.ulGatewayAddress = EP_IPv4_SETTINGS.ulGatewayAddress;
+                EP_DHCPData.xLease.ulDNSServerAddress = EP_IPv4_SETTINGS.ulDNSServerAddress;
+                EP_DHCPData.xLease.ulDHCPServerAddress = EP_DHCPData.ulDHCPServerAddress;
+
+                /* 'ulLeaseTime' holds half of the lease, in clock ticks. */
+                EP_DHCPData.xLease.ulLeaseSeconds = ( EP_DHCPData.ulLeaseTime / ( uint32_t ) configTICK_RATE_HZ ) * 2UL;
+                EP_DHCPData.xLeaseStart = xTaskGetTickCount();
+                EP_DHCPData.xLeaseValid = pdTRUE;
+
+                #if ( ipconfigUSE_DHCP_LEASE_HOOK != 0 )
+                    {
+                        vApplicationDHCPStoreLease( &( EP_DHCPData.xLease ) );
+                    }
+                #endif
+            }
+        #endif /* ipconfigDHCP_FAST_RECONNECT == 1 */
+    }
+    /*-----------------------------------------------------------*/
+
+    #if ( ipconfigDHCP_FAST_RECONNECT == 1 )
+
+/**
+ * @brief When the last lease has not expired yet, send a DHCP request for its
+ *        address, without a server identifier (the INIT-REBOOT state of
+ *        RFC 2131).  Any DHCP server in the network may acknowledge or refuse it.
+ *
+ * @return pdPASS when the request was sent.  pdFAIL when there is no valid
+ *         lease, when the application does not want to continue, or when the
+ *         request could not be sent.
+ */
+        static BaseType_t prvSendDHCPInitReboot( void )
+        {
+            BaseType_t xResult = pdFAIL;
+
+            #if ( ipconfigUSE_DHCP_LEASE_HOOK != 0 )
+                {
+                    /* After a reboot, the lease can only come from the application. */
+                    if( ( EP_DHCPData.xLeaseValid == pdFALSE ) &&
+                        ( xApplicationDHCPRestoreLease( &( EP_DHCPData.xLease ) ) != pdFALSE ) &&
+                        ( EP_DHCPData.xLease.ulIPAddress != 0UL ) )
+                    {
+                        EP_DHCPData.xLeaseStart = xTaskGetTickCount();
+                        EP_DHCPData.xLeaseValid = pdTRUE;
+                    }
+                }
+            #endif /* ipconfigUSE_DHCP_LEASE_HOOK */
+
+            if( ( EP_DHCPData.xLeaseValid != pdFALSE ) &&
+                ( ( ( xTaskGetTickCount() - EP_DHCPData.xLeaseStart ) / ( TickType_t ) configTICK_RATE_HZ ) >= EP_DHCPData.xLease.ulLeaseSeconds ) )
+            {
+                /* The lease has expired. */
+                EP_DHCPData.xLeaseValid = pdFALSE;
+            }
+
+            if( ( EP_DHCPData.xLeaseValid != pdFALSE ) && ( xDHCPSocket != NULL ) )
+            {
+                #if ( ipconfigUSE_DHCP_HOOK != 0 )
+                    /* Ask the user if a DHCP request is required.  If not, the
+                     * normal process will ask again before the discover. */
+                    if( xApplicationDHCPHook( eDHCPPhasePreRequest, EP_DHCPData.xLease.ulIPAddress ) == eDHCPContinue )
+                #endif /* ipconfigUSE_DHCP_HOOK */
+                {
+                    *ipLOCAL_IP_ADDRESS_POINTER = 0UL;
+
+                    /* The acknowledgement will normally repeat these settings. */
+                    EP_IPv4_SETTINGS.ulNetMask = EP_DHCPData.xLease.ulNetMask;
+                    EP_IPv4_SETTINGS.ulGatewayAddress = EP_DHCPData.xLease.ulGatewayAddress;
+                    EP_IPv4_SETTINGS.ulDNSServerAddress = EP_DHCPData.xLease.ulDNSServerAddress;
+
+                    /* With 'xInitReboot' set, prvSendDHCPRequest() leaves out
+                     * the server identifier, and prvProcessDHCPReplies() learns
+                     * it from the acknowledgement. */
+                    EP_DHCPData.ulOfferedIPAddress = EP_DHCPData.xLease.ulIPAddress;
+                    EP_DHCPData.ulDHCPServerAddress = 0UL;
+                    EP_DHCPData.xInitReboot = pdTRUE;
+
+                    FreeRTOS_debug_printf( ( "vDHCPProcess: INIT-REBOOT %lxip\n", FreeRTOS_ntohl( EP_DHCPData.ulOfferedIPAddress ) ) );
+
+                    if( prvSendDHCPRequest() == pdPASS )
+                    {
+                        EP_DHCPData.xDHCPTxTime = xTaskGetTickCount();
+                        EP_DHCPData.xDHCPTxPeriod = dhcpINIT_REBOOT_TX_PERIOD;
+                        xResult = pdPASS;
+                    }
+                    else
+                    {
+                        /* Try a discover in the next cycle. */
+                        EP_DHCPData.xInitReboot = pdFALSE;
+                    }
+                }
+            }
+
+            return xResult;
+        }
+        /*-----------------------------------------------------------*/
+
+    #endif /* ipconfigDHCP_FAST_RECONNECT == 1 */
+
 /**
  * @brief Close the DHCP socket.
  */
@@ -708,6 +892,11 @@
         const void * pvCopySource;
         void * pvCopyDest;
 
+        #if ( ipconfigDHCP_USE_RAPID_COMMIT == 1 )
+            BaseType_t xIsAcknowledgement = pdFALSE;
+            BaseType_t xHasRapidCommit = pdFALSE;
+        #endif
+
         /* Passing the address of a pointer (pucUDPPayload) because FREERTOS_ZERO_COPY is used. */
         lBytes = FreeRTOS_recvfrom( xDHCPSocket, &pucUDPPayload, 0UL, FREERTOS_ZERO_COPY, NULL, NULL );
 
@@ -745,6 +934,13 @@
                     /* None of the essential options have been processed yet. */
                     ulProcessed = 0UL;
 
+                    #if ( ipconfigUSE_DNS != 0 ) && ( ipconfigDNS_MAX_SERVERS > 1 )
+                        {
+                            /* Only keep the DNS servers of this reply. */
+                            uxDHCPDNSServerCount = 0U;
+                        }
+                    #endif
+
                     /* Walk through the options until the dhcpOPTION_END_BYTE byte
                      * is found, taking care not to walk off the end of the options. */
                     pucByte = &( pucUDPPayload[ sizeof( DHCPMessage_IPv4_t ) ] );
@@ -825,6 +1021,16 @@
                                      * state machine is expecting. */
                                     ulProcessed++;
                                 }
+
+                                #if ( ipconfigDHCP_USE_RAPID_COMMIT == 1 )
+                                    else if( ( xExpectedMessageType == ( BaseType_t ) dhcpMESSAGE_TYPE_OFFER ) &&
+                                             ( pucByte[ uxIndex ] == ( uint8_t ) dhcpMESSAGE_TYPE_ACK ) )
+                                    {
+                                        /* An answer to the Rapid Commit option.  It is
+                                         * only accepted when it has that option too. */
+                                        xIsAcknowledgement = pdTRUE;
+                                    }
+                                #endif /* ipconfigDHCP_USE_RAPID_COMMIT */
                                 else
                                 {
                                     if( pucByte[ uxIndex ] == ( uint8_t ) dhcpMESSAGE_TYPE_NACK )
@@ -833,6 +1039,20 @@
                                         {
                                             /* Start again. */
                                             EP_DHCPData.eDHCPState = eInitialWait;
+
+                                            #if ( ipconfigDHCP_FAST_RECONNECT == 1 )
+                                                {
+                                                    /* The lease may not be used any more. */
+                                                    EP_DHCPData.xLeaseValid = pdFALSE;
+                                                    EP_DHCPData.xInitReboot = pdFALSE;
+
+                                                    #if ( ipconfigUSE_DHCP_LEASE_HOOK != 0 )
+                                                        {
+                                                            vApplicationDHCPStoreLease( NULL );
+                                                        }
+                                                    #endif
+                                                }
+                                            #endif /* ipconfigDHCP_FAST_RECONNECT == 1 */
                                         }
                                     }
 
@@ -869,9 +1089,20 @@
                                 if( uxLength >= sizeof( uint32_t ) )
                                 {
                                     /* ulProcessed is not incremented in this case
-                                     * because the DNS server is not essential.  Only the
-                                     * first DNS server address is taken. */
+                                     * because the DNS server is not essential.  The
+                                     * first DNS server address is the primary one, the
+                                     * others are only used when there is room for
+                                     * them, see ipconfigDNS_MAX_SERVERS. */
                                     EP_IPv4_SETTINGS.ulDNSServerAddress = ulParameter;
+
+                                    #if ( ipconfigUSE_DNS != 0 ) && ( ipconfigDNS_MAX_SERVERS > 1 )
+                                        {
+                                            /* An offer may not be accepted, so the list is
+                                             * only passed on by prvAcceptDHCPLease(). */
+                                            uxDHCPDNSServerCount = FreeRTOS_min_uint32( uxLength / sizeof( uint32_t ), ipconfigDNS_MAX_SERVERS );
+                                            ( void ) memcpy( ucDHCPDNSServers, &( pucByte[ uxIndex ] ), uxDHCPDNSServerCount * sizeof( uint32_t ) );
+                                        }
+                                    #endif
                                 }
 
                                 break;
@@ -888,6 +1119,15 @@
                                     }
                                     else
                                     {
+                                        #if ( ipconfigDHCP_FAST_RECONNECT == 1 )
+                                            if( EP_DHCPData.xInitReboot != pdFALSE )
+                                            {
+                                                /* The request did not name a server,
+                                                 * any server may acknowledge it. */
+                                                EP_DHCPData.ulDHCPServerAddress = ulParameter;
+                                            }
+                                        #endif
+
                                         /* The ack must come from the expected server. */
                                         if( EP_DHCPData.ulDHCPServerAddress == ulParameter )
                                         {
@@ -919,6 +1159,16 @@
 
                                 break;
 
+                                #if ( ipconfigDHCP_USE_RAPID_COMMIT == 1 )
+                                    case dhcpIPv4_RAPID_COMMIT_OPTION_CODE:
+
+                                        /* This option has no data.  Continue with the
+                                         * next option, a length of zero would stop the
+                                         * walk below. */
+                                        xHasRapidCommit = pdTRUE;
+                                        continue;
+                                #endif /* ipconfigDHCP_USE_RAPID_COMMIT */
+
                             default:
 
                                 /* Not interested in this field. */
@@ -935,9 +1185,30 @@
                         uxIndex = uxIndex + uxLength;
                     }
 
+                    #if ( ipconfigDHCP_USE_RAPID_COMMIT == 1 )
+                        {
+                            /* An acknowledgement with the Rapid Commit option
+                             * counts as the expected offer. */
+                            if( ( xIsAcknowledgement != pdFALSE ) && ( xHasRapidCommit != pdFALSE ) )
+                            {
+                                ulProcessed++;
+                            }
+                            else
+                            {
+                                xIsAcknowledgement = pdFALSE;
+                            }
+                        }
+                    #endif /* ipconfigDHCP_USE_RAPID_COMMIT */
+
                     /* Were all the mandatory options received? */
                     if( ulProcessed >= ulMandatoryOptions )
                     {
+                        #if ( ipconfigDHCP_USE_RAPID_COMMIT == 1 )
+                            {
+                                EP_DHCPData.xRapidCommit = xIsAcknowledgement;
+                            }
+                        #endif
+
                         /* HT:endian: used to be network order */
                         EP_DHCPData.ulOfferedIPAddress = pxDHCPMessage->ulYourIPAddress_yiaddr;
                         FreeRTOS_printf( ( "vDHCPProcess: offer %lxip\n", FreeRTOS_ntohl( EP_DHCPData.ulOfferedIPAddress ) ) );
@@ -1100,10 +1371,24 @@
             pvCopyDest = &pucUDPPayloadBuffer[ dhcpFIRST_OPTION_BYTE_OFFSET + dhcpREQUESTED_IP_ADDRESS_OFFSET ];
             ( void ) memcpy( pvCopyDest, pvCopySource, sizeof( EP_DHCPData.ulOfferedIPAddress ) );
 
-            /* Copy in the address of the DHCP server being used. */
-            pvCopySource = &EP_DHCPData.ulDHCPServerAddress;
-            pvCopyDest = &pucUDPPayloadBuffer[ dhcpFIRST_OPTION_BYTE_OFFSET + dhcpDHCP_SERVER_IP_ADDRESS_OFFSET ];
-            ( void ) memcpy( pvCopyDest, pvCopySource, sizeof( EP_DHCPData.ulDHCPServerAddress ) );
+            #if ( ipconfigDHCP_FAST_RECONNECT == 1 )
+                if( EP_DHCPData.xInitReboot != pdFALSE )
+                {
+                    /* An INIT-REBOOT request must not have a server identifier.
+                     * Overwrite the option, its code and length included, with
+                     * pad bytes. */
+                    ( void ) memset( &( pucUDPPayloadBuffer[ dhcpFIRST_OPTION_BYTE_OFFSET + dhcpDHCP_SERVER_IP_ADDRESS_OFFSET - 2U ] ),
+                                     ( int ) dhcpIPv4_ZERO_PAD_OPTION_CODE,
+                                     2U + sizeof( EP_DHCPData.ulDHCPServerAddress ) );
+                }
+                else
+            #endif /* ipconfigDHCP_FAST_RECONNECT == 1 */
+            {
+                /* Copy in the address of the DHCP server being used. */
+                pvCopySource = &EP_DHCPData.ulDHCPServerAddress;
+                pvCopyDest = &pucUDPPayloadBuffer[ dhcpFIRST_OPTION_BYTE_OFFSET + dhcpDHCP_SERVER_IP_ADDRESS_OFFSET ];
+                ( void ) memcpy( pvCopyDest, pvCopySource, sizeof( EP_DHCPData.ulDHCPServerAddress ) );
+            }
 
             FreeRTOS_debug_printf( ( "vDHCPProcess: reply %lxip\n", FreeRTOS_ntohl( EP_DHCPData.ulOfferedIPAddress ) ) );
             iptraceSENDING_DHCP_REQUEST();
@@ -1140,6 +1425,9 @@
             dhcpIPv4_CLIENT_IDENTIFIER_OPTION_CODE,  7, 1,                                0,                            0, 0, 0, 0, 0,                    /* Client identifier. */
             dhcpIPv4_REQUEST_IP_ADDRESS_OPTION_CODE, 4, 0,                                0,                            0, 0,                             /* The IP address being requested. */
             dhcpIPv4_PARAMETER_REQUEST_OPTION_CODE,  3, dhcpIPv4_SUBNET_MASK_OPTION_CODE, dhcpIPv4_GATEWAY_OPTION_CODE, dhcpIPv4_DNS_SERVER_OPTIONS_CODE, /* Parameter request option. */
+            #if ( ipconfigDHCP_USE_RAPID_COMMIT == 1 )
+                dhcpIPv4_RAPID_COMMIT_OPTION_CODE,   0,                                                                                                   /* Rapid Commit option. */
+            #endif
             dhcpOPTION_END_BYTE
         };
         size_t uxOptionsLength = sizeof( ucDHCPDiscoverOptions );
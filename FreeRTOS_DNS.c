@@ -99,6 +99,46 @@
                                       TickType_t uxIdentifier,
                                       TickType_t uxReadTimeOut_ticks );
 
+/*
+ * Create a DNS question for pcHostName and send it from xDNSSocket, to the DNS
+ * server(s) or, for a name without a dot, to the LLMNR address.
+ */
+    static BaseType_t prvSendDNSRequest( Socket_t xDNSSocket,
+                                         const char * pcHostName,
+                                         TickType_t uxIdentifier,
+                                         BaseType_t xFlags );
+
+    #if ( ipconfigDNS_MAX_SERVERS > 1 )
+        #if ( ipconfigDNS_PARALLEL_QUERIES < 1 ) || ( ipconfigDNS_PARALLEL_QUERIES > ipconfigDNS_MAX_SERVERS )
+            #error ipconfigDNS_PARALLEL_QUERIES must be between 1 and ipconfigDNS_MAX_SERVERS
+        #endif
+
+/*
+ * Choose the servers to which a question is sent, and start timing it.
+ */
+        static BaseType_t prvDNSServerSelect( TickType_t uxIdentifier,
+                                              BaseType_t xSharedSocket,
+                                              uint32_t * pulTargets );
+
+/*
+ * Measure the round-trip time of a server that has answered.
+ */
+        static void prvDNSServerAnswered( uint32_t ulIPAddress,
+                                          uint16_t usIdentifier );
+
+/*
+ * Replace the servers that came from one source.
+ */
+        static void prvDNSServerSetSource( const uint32_t * pulAddresses,
+                                           UBaseType_t uxCount,
+                                           uint8_t ucSource );
+
+/*
+ * Sort the indexes of the servers by their rank, return their number.
+ */
+        static BaseType_t prvDNSServerRank( uint8_t * pucOrder );
+    #endif /* ipconfigDNS_MAX_SERVERS > 1 */
+
     #if ( ipconfigDNS_USE_CALLBACKS != 0 )
         static void vDNSSetCallBack( const char * pcHostName,
                                      void * pvSearchID,
@@ -113,6 +153,81 @@
                                           uint32_t ulIPAddress );
     #endif /* ipconfigDNS_USE_CALLBACKS */
 
+    #if ( ipconfigDNS_USE_RESOLVER == 1 )
+        #if ( ipconfigDNS_USE_CALLBACKS == 0 )
+            #error ipconfigDNS_USE_RESOLVER requires ipconfigDNS_USE_CALLBACKS
+        #endif
+
+/*
+ * Return the socket that is shared by all look-ups, create it if necessary.
+ */
+        static Socket_t prvDNSResolverSocket( void );
+
+/*
+ * Register a call-back for pcHostName.  If the name is being resolved already,
+ * the call-back will wait for the same answer, otherwise a question is sent.
+ * Returns pdFALSE when the resolver can not take the look-up.
+ */
+        static BaseType_t prvDNSResolverLookup( const char * pcHostName,
+                                                FOnDNSEvent pCallback,
+                                                void * pvSearchID,
+                                                TickType_t uxTimeout,
+                                                TickType_t uxIdentifier,
+                                                BaseType_t xFlags );
+
+/*
+ * Let the calling task wait for the answer to pcHostName.
+ */
+        static uint32_t prvDNSResolverWait( const char * pcHostName,
+                                            TickType_t uxIdentifier,
+                                            BaseType_t * pxHandled );
+
+/*
+ * The call-back that wakes up a task waiting in prvDNSResolverWait().
+ */
+        static void prvDNSResolverWake( const char * pcName,
+                                        void * pvSearchID,
+                                        uint32_t ulIPAddress );
+
+/*
+ * Return pdTRUE when a call-back is waiting for the answer to uxIdentifier.
+ */
+        static BaseType_t prvDNSHasCallBack( TickType_t uxIdentifier );
+
+/*
+ * Release the question that has been answered.
+ */
+        static void prvDNSResolverRelease( TickType_t uxIdentifier );
+
+/*
+ * Release the questions that nobody waits for anymore, and send the questions
+ * that were not answered in time once more.
+ */
+        static void prvDNSResolverCheck( void );
+    #endif /* ipconfigDNS_USE_RESOLVER */
+
+    #if ( ipconfigDNS_USE_PREFETCH == 1 )
+        #if ( ipconfigUSE_DNS_CACHE == 0 ) || ( ipconfigDNS_USE_RESOLVER == 0 )
+            #error ipconfigDNS_USE_PREFETCH requires ipconfigUSE_DNS_CACHE and ipconfigDNS_USE_RESOLVER
+        #endif
+
+/*
+ * Refresh the popular names in the DNS cache that are about to expire.
+ * Returns the number of seconds until the next one must be refreshed, or 0.
+ */
+        static uint32_t prvDNSPrefetchCheck( void );
+
+/*
+ * The call-back of a refresh sent by prvDNSPrefetchCheck().
+ */
+        static void prvDNSPrefetchDone( const char * pcName,
+                                        void * pvSearchID,
+                                        uint32_t ulIPAddress );
+
+/** @brief pdTRUE while the DNS timer runs to refresh the popular names. */
+        static BaseType_t xDNSPrefetchTimerSet = pdFALSE;
+    #endif /* ipconfigDNS_USE_PREFETCH */
+
 /*
  * The NBNS and the LLMNR protocol share this reply function.
  */
@@ -141,12 +256,154 @@
                                               uint32_t ulTTL,
                                               BaseType_t xLookUp );
 
+/*
+ * Find the row of the DNS cache that holds pcName, or -1.
+ */
+        static BaseType_t prvDNSCacheFind( const char * pcName );
+
+/*
+ * Choose the row of the DNS cache in which a new name will be stored.
+ */
+        static BaseType_t prvDNSCacheNewRow( uint32_t ulCurrentTimeSeconds );
+
+/*
+ * Remove a name from the DNS cache.
+ */
+        static void prvDNSCacheRemove( BaseType_t xRow );
+
         _static DNSCacheRow_t xDNSCache[ ipconfigDNS_CACHE_ENTRIES ];
 
+/** @brief The counters of the DNS cache, see vDNSGetCacheStats(). */
+        static DNSCacheStats_t xDNSCacheStats;
+    #endif /* ipconfigUSE_DNS_CACHE == 1 */
+
+    #if ( ipconfigUSE_DNS_CACHE == 1 ) && ( ipconfigDNS_CACHE_NEGATIVE_TTL_MAX > 0 )
+        /** @brief Negative answers are stored in the DNS cache. */
+        #define dnsUSE_NEGATIVE_CACHE    1
+
+/*
+ * Find the TTL of a negative answer in the authority section of a reply.
+ */
+        static uint32_t prvReadNegativeTTL( const uint8_t * pucByte,
+                                            size_t uxSourceBytesRemaining,
+                                            uint16_t usAuthorityRRs );
+    #else
+        #define dnsUSE_NEGATIVE_CACHE    0
+    #endif
+
+    #if ( ipconfigDNS_USE_FAST_PARSER == 1 )
+
+/*
+ * Follow the compression pointers of a name up to its next label.
+ */
+        static BaseType_t prvDNSNextLabel( const uint8_t * pucBuffer,
+                                           size_t uxLength,
+                                           size_t * puxPosition,
+                                           size_t * puxLowest );
+
+/*
+ * Check a name in a DNS message, and copy it to pcName when not NULL.
+ */
+        static size_t prvDNSReadName( const uint8_t * pucBuffer,
+                                      size_t uxLength,
+                                      size_t uxOffset,
+                                      char * pcName,
+                                      size_t uxNameSize );
+
+/*
+ * Compare two names in a DNS message, ignoring case.
+ */
+        static BaseType_t prvDNSReplyNamesEqual( const uint8_t * pucBuffer,
+                                                 size_t uxLength,
+                                                 size_t uxFirst,
+                                                 size_t uxSecond );
+    #endif /* ipconfigDNS_USE_FAST_PARSER == 1 */
+
+    #if ( ipconfigUSE_DNS_CACHE == 1 ) && ( ipconfigUSE_DNS_CACHE_HASH == 1 )
+        #if ( ipconfigDNS_CACHE_HASH_SIZE <= ipconfigDNS_CACHE_ENTRIES )
+            #error ipconfigDNS_CACHE_HASH_SIZE must be larger than ipconfigDNS_CACHE_ENTRIES
+        #endif
+
+        #if ( ipconfigDNS_CACHE_ENTRIES >= 0xFFFF )
+            #error ipconfigDNS_CACHE_ENTRIES must be less than 65535 when ipconfigUSE_DNS_CACHE_HASH is used
+        #endif
+
+/** @brief A slot in the hash index that does not refer to a row. */
+        #define dnsHASH_EMPTY          ( ( uint16_t ) 0U )
+
+/** @brief The end of the LRU list. */
+        #define dnsLRU_NONE            ( ( uint16_t ) 0xFFFFU )
+
+/** @brief The number of rows, counted from the least recently used one, that
+ * are considered when a new name must be stored. */
+        #define dnsEVICTION_CANDIDATES    4
+
+/*
+ * Return the hash of a name, regardless of the case of its characters.
+ */
+        static uint32_t prvDNSHashName( const char * pcName );
+
+/*
+ * Compare two names regardless of the case of their characters.
+ */
+        static BaseType_t prvDNSNameEqual( const char * pcName1,
+                                           const char * pcName2 );
+
+/*
+ * Add a row to the hash index, or remove it.
+ */
+        static void prvDNSIndexAdd( BaseType_t xRow );
+        static void prvDNSIndexDelete( BaseType_t xRow );
+
+/*
+ * Put all rows in the LRU list, in case that has not been done yet.
+ */
+        static void prvDNSCacheHashInit( void );
+
+/*
+ * Make a row the most recently used one, or the first one to be re-used.
+ */
+        static void prvDNSTouch( BaseType_t xRow );
+        static void prvDNSRelease( BaseType_t xRow );
+
+/*
+ * Take a row out of the LRU list.
+ */
+        static void prvDNSLRUDetach( BaseType_t xRow );
+
+/** @brief The index of the DNS cache keyed on the name, using open
+ * addressing with linear probing.  A slot holds a row number plus one, or
+ * dnsHASH_EMPTY.  Every row with a name is indexed. */
+        static uint16_t usDNSHashIndex[ ipconfigDNS_CACHE_HASH_SIZE ];
+
+/** @brief The hash of the name in each row, so that the names themselves are
+ * only compared when the hashes are equal. */
+        static uint32_t ulDNSNameHash[ ipconfigDNS_CACHE_ENTRIES ];
+
+/** @brief The rows in the order of their use, linked through these arrays.
+ * The head is the most recently used row. */
+        static uint16_t usDNSLRUNext[ ipconfigDNS_CACHE_ENTRIES ];
+        static uint16_t usDNSLRUPrev[ ipconfigDNS_CACHE_ENTRIES ];
+        static uint16_t usDNSLRUHead = dnsLRU_NONE;
+        static uint16_t usDNSLRUTail = dnsLRU_NONE;
+    #endif /* ipconfigUSE_DNS_CACHE == 1 && ipconfigUSE_DNS_CACHE_HASH == 1 */
+
+    #if ( ipconfigUSE_DNS_CACHE == 1 )
 /* Utility function: Clear DNS cache by calling this function. */
         void FreeRTOS_dnsclear( void )
         {
-            ( void ) memset( xDNSCache, 0x0, sizeof( xDNSCache ) );
+            vTaskSuspendAll();
+            {
+                ( void ) memset( xDNSCache, 0x0, sizeof( xDNSCache ) );
+                #if ( ipconfigUSE_DNS_CACHE_HASH == 1 )
+                    {
+                        ( void ) memset( usDNSHashIndex, 0x0, sizeof( usDNSHashIndex ) );
+                        usDNSLRUHead = dnsLRU_NONE;
+                        usDNSLRUTail = dnsLRU_NONE;
+                    }
+                #endif
+            }
+            ( void ) xTaskResumeAll();
         }
     #endif /* ipconfigUSE_DNS_CACHE == 1 */
 
@@ -250,6 +507,21 @@
             ( void ) prvProcessDNSCache( pcHostName, &ulIPAddress, 0, pdTRUE );
             return ulIPAddress;
         }
+        /*-----------------------------------------------------------*/
+
+/**
+ * @brief Get a copy of the counters of the DNS cache.
+ *
+ * @param[out] pxStats: Where the counters will be copied to.
+ */
+        void vDNSGetCacheStats( DNSCacheStats_t * pxStats )
+        {
+            vTaskSuspendAll();
+            {
+                *pxStats = xDNSCacheStats;
+            }
+            ( void ) xTaskResumeAll();
+        }
     #endif /* ipconfigUSE_DNS_CACHE == 1 */
     /*-----------------------------------------------------------*/
 
@@ -268,6 +540,53 @@
 /** @brief The list of all callback structures. */
         _static List_t xCallbackList;
 
+/** @brief The counters of the DNS client, see vDNSGetResolverStats(). */
+        static DNSResolverStats_t xDNSResolverStats;
+
+        #if ( ipconfigUSE_STATIC_POOLS == 1 )
+
+/** @brief The number of size_t words needed for a pooled call-back structure,
+ *         which can store a name of at most ipconfigDNS_CALLBACK_NAME_LENGTH
+ *         bytes, including the terminating zero. */
+            #define dnsCALLBACK_WORDS    ( ( sizeof( DNSCallback_t ) + ( size_t ) ipconfigDNS_CALLBACK_NAME_LENGTH + ( sizeof( size_t ) - 1U ) ) / sizeof( size_t ) )
+
+/** @brief The statically allocated call-back structures, stored as size_t
+ *         words to get the alignment of a DNSCallback_t. */
+            static size_t uxDNSCallbackPoolObjects[ ipconfigDNS_CALLBACK_POOL_SIZE ][ dnsCALLBACK_WORDS ];
+
+/** @brief The pool from which vDNSSetCallBack() takes its call-back structures. */
+            SocketPool_t xDNSCallbackPool =
+            {
+                ( uint8_t * ) uxDNSCallbackPoolObjects,
+                sizeof( uxDNSCallbackPoolObjects[ 0 ] ),
+                ( UBaseType_t ) ipconfigDNS_CALLBACK_POOL_SIZE,
+                0U,
+                NULL,
+                0U,
+                0U,
+                "DNS call-backs"
+            };
+        #endif /* ipconfigUSE_STATIC_POOLS == 1 */
+
+/**
+ * @brief Release a call-back structure that has been removed from the list.
+ *
+ * @param[in] pxCallback: The structure being released.
+ */
+        static void prvDNSCallbackFree( DNSCallback_t * pxCallback )
+        {
+            #if ( ipconfigUSE_STATIC_POOLS == 1 )
+                {
+                    vSocketPoolGive( &( xDNSCallbackPool ), ( void * ) pxCallback );
+                }
+            #else
+                {
+                    vPortFree( pxCallback );
+                }
+            #endif
+        }
+        /*-----------------------------------------------------------*/
+
 /**
  * @brief Define FreeRTOS_gethostbyname() as a normal blocking call.
  *
@@ -289,6 +608,21 @@
         }
         /*-----------------------------------------------------------*/
 
+/**
+ * @brief Get a copy of the counters of the DNS client.
+ *
+ * @param[out] pxStats: Where the counters will be copied to.
+ */
+        void vDNSGetResolverStats( DNSResolverStats_t * pxStats )
+        {
+            vTaskSuspendAll();
+            {
+                *pxStats = xDNSResolverStats;
+            }
+            ( void ) xTaskResumeAll();
+        }
+        /*-----------------------------------------------------------*/
+
 /**
  * @brief Iterate through the list of call-back structures and remove
  *        old entries which have reached a timeout.
@@ -304,6 +638,10 @@
             const ListItem_t * pxIterator;
             const ListItem_t * xEnd = listGET_END_MARKER( &xCallbackList );
 
+            #if ( ipconfigDNS_USE_PREFETCH == 1 )
+                uint32_t ulNextPrefetch;
+            #endif
+
             vTaskSuspendAll();
             {
                 for( pxIterator = ( const ListItem_t * ) listGET_NEXT( xEnd );
@@ -317,13 +655,13 @@
                     if( ( pvSearchID != NULL ) && ( pvSearchID == pxCallback->pvSearchID ) )
                     {
                         ( void ) uxListRemove( &( pxCallback->xListItem ) );
-                        vPortFree( pxCallback );
+                        prvDNSCallbackFree( pxCallback );
                     }
                     else if( xTaskCheckForTimeOut( &pxCallback->uxTimeoutState, &pxCallback->uxRemaningTime ) != pdFALSE )
                     {
                         pxCallback->pCallbackFunction( pxCallback->pcName, pxCallback->pvSearchID, 0 );
                         ( void ) uxListRemove( &( pxCallback->xListItem ) );
-                        vPortFree( pxCallback );
+                        prvDNSCallbackFree( pxCallback );
                     }
                     else
                     {
@@ -333,9 +671,35 @@
             }
             ( void ) xTaskResumeAll();
 
+            #if ( ipconfigDNS_USE_RESOLVER == 1 )
+                {
+                    prvDNSResolverCheck();
+                }
+            #endif
+
+            #if ( ipconfigDNS_USE_PREFETCH == 1 )
+                {
+                    ulNextPrefetch = prvDNSPrefetchCheck();
+                }
+            #endif
+
             if( listLIST_IS_EMPTY( &xCallbackList ) != pdFALSE )
             {
-                vIPSetDnsTimerEnableState( pdFALSE );
+                #if ( ipconfigDNS_USE_PREFETCH == 1 )
+                    /* When the timer stops, the next look-up of a popular name
+                     * will start it again. */
+                    xDNSPrefetchTimerSet = ( ulNextPrefetch != 0UL ) ? pdTRUE : pdFALSE;
+
+                    if( ulNextPrefetch != 0UL )
+                    {
+                        /* Wake up when the next popular name must be refreshed. */
+                        vIPReloadDNSTimer( pdMS_TO_TICKS( ulNextPrefetch * 1000UL ) );
+                    }
+                    else
+                #endif
+                {
+                    vIPSetDnsTimerEnableState( pdFALSE );
+                }
             }
         }
         /*-----------------------------------------------------------*/
@@ -371,7 +735,26 @@
                                      TickType_t uxIdentifier )
         {
             size_t lLength = strlen( pcHostName );
-            DNSCallback_t * pxCallback = ipCAST_PTR_TO_TYPE_PTR( DNSCallback_t, pvPortMalloc( sizeof( *pxCallback ) + lLength ) );
+            DNSCallback_t * pxCallback;
+
+            #if ( ipconfigUSE_STATIC_POOLS == 1 )
+                {
+                    /* A name that does not fit in a pooled structure is
+                     * treated like a failed allocation. */
+                    if( lLength < ( size_t ) ipconfigDNS_CALLBACK_NAME_LENGTH )
+                    {
+                        pxCallback = ipCAST_PTR_TO_TYPE_PTR( DNSCallback_t, pvSocketPoolTake( &( xDNSCallbackPool ) ) );
+                    }
+                    else
+                    {
+                        pxCallback = NULL;
+                    }
+                }
+            #else
+                {
+                    pxCallback = ipCAST_PTR_TO_TYPE_PTR( DNSCallback_t, pvPortMalloc( sizeof( *pxCallback ) + lLength ) );
+                }
+            #endif
 
             /* Translate from ms to number of clock ticks. */
             uxTimeout /= portTICK_PERIOD_MS;
@@ -402,7 +785,8 @@
 
 /**
  * @brief A DNS reply was received, see if there is any matching entry and
- *        call the handler.
+ *        call the handler.  With ipconfigDNS_USE_RESOLVER, all the call-backs
+ *        that wait for the same question are called.
  *
  * @param[in] uxIdentifier: Identifier associated with the callback function.
  * @param[in] pcName: The name associated with the callback function.
@@ -422,25 +806,42 @@
             {
                 for( pxIterator = ( const ListItem_t * ) listGET_NEXT( xEnd );
                      pxIterator != ( const ListItem_t * ) xEnd;
-                     pxIterator = ( const ListItem_t * ) listGET_NEXT( pxIterator ) )
+                     )
                 {
-                    if( listGET_LIST_ITEM_VALUE( pxIterator ) == uxIdentifier )
-                    {
-                        DNSCallback_t * pxCallback = ipCAST_PTR_TO_TYPE_PTR( DNSCallback_t, listGET_LIST_ITEM_OWNER( pxIterator ) );
+                    DNSCallback_t * pxCallback = ipCAST_PTR_TO_TYPE_PTR( DNSCallback_t, listGET_LIST_ITEM_OWNER( pxIterator ) );
+                    TickType_t uxValue = listGET_LIST_ITEM_VALUE( pxIterator );
+
+                    /* Move to the next item because we might remove this item */
+                    pxIterator = ( const ListItem_t * ) listGET_NEXT( pxIterator );
 
+                    if( uxValue == uxIdentifier )
+                    {
                         pxCallback->pCallbackFunction( pcName, pxCallback->pvSearchID, ulIPAddress );
                         ( void ) uxListRemove( &pxCallback->xListItem );
-                        vPortFree( pxCallback );
+                        prvDNSCallbackFree( pxCallback );
+                        xResult = pdTRUE;
+
+                        #if ( ipconfigDNS_USE_RESOLVER == 0 )
+                            /* Only one call-back uses this identifier. */
+                            break;
+                        #endif
+                    }
+                }
 
-                        if( listLIST_IS_EMPTY( &xCallbackList ) != pdFALSE )
+                #if ( ipconfigDNS_USE_RESOLVER == 1 )
+                    {
+                        if( xResult != pdFALSE )
                         {
-                            /* The list of outstanding requests is empty. No need for periodic polling. */
-                            vIPSetDnsTimerEnableState( pdFALSE );
+                            /* All look-ups of this name have their answer. */
+                            prvDNSResolverRelease( uxIdentifier );
                         }
-
-                        xResult = pdTRUE;
-                        break;
                     }
+                #endif
+
+                if( ( xResult != pdFALSE ) && ( listLIST_IS_EMPTY( &xCallbackList ) != pdFALSE ) )
+                {
+                    /* The list of outstanding requests is empty. No need for periodic polling. */
+                    vIPSetDnsTimerEnableState( pdFALSE );
                 }
             }
             ( void ) xTaskResumeAll();
@@ -450,929 +851,2620 @@
     #endif /* ipconfigDNS_USE_CALLBACKS == 1 */
     /*-----------------------------------------------------------*/
 
-    #if ( ipconfigDNS_USE_CALLBACKS == 0 )
+    #if ( ipconfigDNS_USE_RESOLVER == 1 )
+
+/** @brief The longest name, including the terminating zero, that the resolver
+ *         can store.  Longer names are looked up with a socket of their own. */
+        #define dnsRESOLVER_NAME_LENGTH    ( ipconfigDNS_CACHE_NAME_LENGTH )
+
+/** @brief A question that has been sent from the shared socket, and that
+ *         has not been answered yet. */
+        typedef struct xDNS_REQUEST
+        {
+            TickType_t uxIdentifier;                 /**< The identifier of the question, also used by all its call-backs. */
+            UBaseType_t uxAttempts;                  /**< The number of times it was sent since the last call-back joined, zero when the entry is free. */
+            TimeOut_t xTimeOutState;                 /**< The time at which it was sent last. */
+            TickType_t uxRemainingTime;              /**< The time to wait before sending it again. */
+            char pcName[ dnsRESOLVER_NAME_LENGTH ]; /**< The name being resolved. */
+        } DNSRequest_t;
+
+/** @brief The state of a task that waits in prvDNSResolverWait().  It waits on
+ *         a semaphore of its own, so that the task notifications remain free
+ *         for the application. */
+        typedef struct xDNS_WAITER
+        {
+            SemaphoreHandle_t xSemaphore; /**< Given when the answer or a time-out has been delivered. */
+            uint32_t ulIPAddress;         /**< The answer, zero when the look-up failed. */
+        } DNSWaiter_t;
+
+/** @brief The questions that are in flight. */
+        static DNSRequest_t xDNSRequests[ ipconfigDNS_RESOLVER_REQUESTS ];
+
+/** @brief The socket shared by all look-ups.  It is never closed. */
+        static Socket_t xDNSResolverSocket = NULL;
 
 /**
- * @brief Get the IP-address corresponding to the given hostname.
- *
- * @param[in] pcHostName: The hostname whose IP address is being queried.
+ * @brief Return the socket from which the resolver sends its questions. The
+ *        socket is created by the first look-up, and is never closed.
  *
- * @return The IP-address corresponding to the hostname.
+ * @return The socket, or NULL if it could not be created.
  */
-        uint32_t FreeRTOS_gethostbyname( const char * pcHostName )
+        static Socket_t prvDNSResolverSocket( void )
         {
-            return prvPrepareLookup( pcHostName );
+            Socket_t xSocket = xDNSResolverSocket;
+
+            if( xSocket == NULL )
+            {
+                /* The socket is created and bound outside the critical region,
+                 * in case two tasks do this at the same time, one of them
+                 * closes its socket again. */
+                xSocket = prvCreateDNSSocket();
+
+                if( xSocket != NULL )
+                {
+                    vTaskSuspendAll();
+                    {
+                        if( xDNSResolverSocket == NULL )
+                        {
+                            xDNSResolverSocket = xSocket;
+                            xSocket = NULL;
+                        }
+                    }
+                    ( void ) xTaskResumeAll();
+
+                    if( xSocket != NULL )
+                    {
+                        ( void ) FreeRTOS_closesocket( xSocket );
+                    }
+
+                    xSocket = xDNSResolverSocket;
+                }
+            }
+
+            return xSocket;
         }
-    #else
+        /*-----------------------------------------------------------*/
 
 /**
- * @brief Get the IP-address corresponding to the given hostname.
+ * @brief Check if a socket is the one shared by the DNS resolver.  The replies
+ *        to that socket are handled by the IP-task directly.
  *
- * @param[in] pcHostName: The hostname whose IP address is being queried.
- * @param[in] pCallback: The callback function which will be called upon DNS response.
- * @param[in] pvSearchID: Search ID for the callback function.
- * @param[in] uxTimeout: Timeout for the callback function.
+ * @param[in] xSocket: The socket to be checked.
  *
- * @return The IP-address corresponding to the hostname.
+ * @return pdTRUE if xSocket is the resolver's socket, otherwise pdFALSE.
  */
-        uint32_t FreeRTOS_gethostbyname_a( const char * pcHostName,
-                                           FOnDNSEvent pCallback,
-                                           void * pvSearchID,
-                                           TickType_t uxTimeout )
+        BaseType_t xIsDNSResolverSocket( Socket_t xSocket )
         {
-            return prvPrepareLookup( pcHostName, pCallback, pvSearchID, uxTimeout );
-        }
-    #endif /* if ( ipconfigDNS_USE_CALLBACKS == 0 ) */
+            BaseType_t xReturn = pdFALSE;
 
-    #if ( ipconfigDNS_USE_CALLBACKS == 1 )
+            if( ( xSocket != NULL ) && ( xSocket == xDNSResolverSocket ) )
+            {
+                xReturn = pdTRUE;
+            }
+
+            return xReturn;
+        }
+        /*-----------------------------------------------------------*/
 
 /**
- * @brief Check if hostname is already known. If not, call prvGetHostByName() to send a DNS request.
+ * @brief Check if a call-back is waiting for a given identifier.  Must be
+ *        called while the scheduler is suspended.
  *
- * @param[in] pcHostName: The hostname whose IP address is being queried.
- * @param[in] pCallback: The callback function which will be called upon DNS response.
- * @param[in] pvSearchID: Search ID for the callback function.
- * @param[in] uxTimeout: Timeout for the callback function.
+ * @param[in] uxIdentifier: The identifier of a question.
  *
- * @return The IP-address corresponding to the hostname.
+ * @return pdTRUE if a call-back was found, otherwise pdFALSE.
  */
-        static uint32_t prvPrepareLookup( const char * pcHostName,
-                                          FOnDNSEvent pCallback,
-                                          void * pvSearchID,
-                                          TickType_t uxTimeout )
-    #else
+        static BaseType_t prvDNSHasCallBack( TickType_t uxIdentifier )
+        {
+            BaseType_t xResult = pdFALSE;
+            const ListItem_t * pxIterator;
+            const ListItem_t * xEnd = listGET_END_MARKER( &xCallbackList );
+
+            for( pxIterator = ( const ListItem_t * ) listGET_NEXT( xEnd );
+                 pxIterator != ( const ListItem_t * ) xEnd;
+                 pxIterator = ( const ListItem_t * ) listGET_NEXT( pxIterator ) )
+            {
+                if( listGET_LIST_ITEM_VALUE( pxIterator ) == uxIdentifier )
+                {
+                    xResult = pdTRUE;
+                    break;
+                }
+            }
+
+            return xResult;
+        }
+        /*-----------------------------------------------------------*/
 
 /**
- * @brief Check if hostname is already known. If not, call prvGetHostByName() to send a DNS request.
+ * @brief Let a call-back wait for the answer to pcHostName.  When the name is
+ *        being resolved already, no new question is sent: the call-back gets
+ *        the identifier of the question in flight.  Otherwise a free entry is
+ *        claimed and the question is sent from the shared socket.
  *
- * @param[in] pcHostName: The hostname whose IP address is being queried.
+ * @param[in] pcHostName: The hostname whose IP address is being searched for.
+ * @param[in] pCallback: The function to call when the answer has come, or at a time-out.
+ * @param[in] pvSearchID: The search ID passed to the call-back.
+ * @param[in] uxTimeout: The time-out of the call-back in ms.
+ * @param[in] uxIdentifier: A random identifier, used when a new question is sent.
+ * @param[in] xFlags: The flags passed to FreeRTOS_sendto(), FREERTOS_MSG_DONTWAIT
+ *                    when called from the IP-task.
  *
- * @return The IP-address corresponding to the hostname.
+ * @return pdTRUE if the resolver handles the look-up.  pdFALSE if the name is too
+ *         long, all entries are in use, or the socket could not be created.
  */
-        static uint32_t prvPrepareLookup( const char * pcHostName )
-    #endif
-    {
-        uint32_t ulIPAddress = 0UL;
-        TickType_t uxReadTimeOut_ticks = ipconfigDNS_RECEIVE_BLOCK_TIME_TICKS;
-
-        /* Generate a unique identifier for this query. Keep it in a local variable
-         * as gethostbyname() may be called from different threads */
-        BaseType_t xHasRandom = pdFALSE;
-        TickType_t uxIdentifier = 0U;
-        BaseType_t xLengthOk = pdFALSE;
-
-        if( pcHostName != NULL )
+        static BaseType_t prvDNSResolverLookup( const char * pcHostName,
+                                                FOnDNSEvent pCallback,
+                                                void * pvSearchID,
+                                                TickType_t uxTimeout,
+                                                TickType_t uxIdentifier,
+                                                BaseType_t xFlags )
         {
-            size_t uxLength = strlen( pcHostName ) + 1U;
-
-            #if ( ipconfigUSE_DNS_CACHE != 0 )
-                if( uxLength <= ipconfigDNS_CACHE_NAME_LENGTH )
-            #else
-                if( uxLength <= dnsMAX_HOSTNAME_LENGTH )
-            #endif
-            {
-                /* The name is not too long. */
-                xLengthOk = pdTRUE;
-            }
-            else
+            DNSRequest_t * pxRequest = NULL;
+            DNSRequest_t * pxFree = NULL;
+            BaseType_t xIndex;
+            BaseType_t xSend = pdFALSE;
+            BaseType_t xReturn = pdFALSE;
+            Socket_t xSocket = NULL;
+
+            if( strlen( pcHostName ) < ( size_t ) dnsRESOLVER_NAME_LENGTH )
             {
-                FreeRTOS_printf( ( "prvPrepareLookup: name is too long ( %lu > %lu )\n",
-                                   ( uint32_t ) uxLength,
-                                   ( uint32_t ) ipconfigDNS_CACHE_NAME_LENGTH ) );
+                xSocket = prvDNSResolverSocket();
             }
-        }
 
-        if( ( pcHostName != NULL ) && ( xLengthOk != pdFALSE ) )
-        {
-            /* If the supplied hostname is IP address, convert it to uint32_t
-             * and return. */
-            #if ( ipconfigINCLUDE_FULL_INET_ADDR == 1 )
-                {
-                    ulIPAddress = FreeRTOS_inet_addr( pcHostName );
-                }
-            #endif /* ipconfigINCLUDE_FULL_INET_ADDR == 1 */
-
-            /* If a DNS cache is used then check the cache before issuing another DNS
-             * request. */
-            #if ( ipconfigUSE_DNS_CACHE == 1 )
+            if( xSocket != NULL )
+            {
+                vTaskSuspendAll();
                 {
-                    if( ulIPAddress == 0UL )
+                    for( xIndex = 0; xIndex < ( BaseType_t ) ipconfigDNS_RESOLVER_REQUESTS; xIndex++ )
                     {
-                        ulIPAddress = FreeRTOS_dnslookup( pcHostName );
+                        DNSRequest_t * pxEntry = &( xDNSRequests[ xIndex ] );
 
-                        if( ulIPAddress != 0UL )
+                        if( pxEntry->uxAttempts == 0U )
                         {
-                            FreeRTOS_debug_printf( ( "FreeRTOS_gethostbyname: found '%s' in cache: %lxip\n", pcHostName, ulIPAddress ) );
+                            if( pxFree == NULL )
+                            {
+                                pxFree = pxEntry;
+                            }
+                        }
+                        else if( strcmp( pxEntry->pcName, pcHostName ) == 0 )
+                        {
+                            pxRequest = pxEntry;
+                        }
+                        else if( pxEntry->uxIdentifier == uxIdentifier )
+                        {
+                            /* Two questions in flight must not have the same identifier. */
+                            uxIdentifier = ( uxIdentifier + 1U ) & 0xffffU;
+                            xIndex = -1;
+                            pxFree = NULL;
                         }
                         else
                         {
-                            /* prvGetHostByName will be called to start a DNS lookup. */
+                            /* This entry is used by another name. */
                         }
-                    }
-                }
-            #endif /* ipconfigUSE_DNS_CACHE == 1 */
-
-            /* Generate a unique identifier. */
-            if( ulIPAddress == 0UL )
-            {
-                uint32_t ulNumber;
 
-                xHasRandom = xApplicationGetRandomNumber( &( ulNumber ) );
-                /* DNS identifiers are 16-bit. */
-                uxIdentifier = ( TickType_t ) ( ulNumber & 0xffffU );
-            }
+                        if( pxRequest != NULL )
+                        {
+                            break;
+                        }
+                    }
 
-            #if ( ipconfigDNS_USE_CALLBACKS == 1 )
-                {
-                    if( pCallback != NULL )
+                    if( pxRequest != NULL )
                     {
-                        if( ulIPAddress == 0UL )
+                        /* The name is being resolved already: wait for the same answer. */
+                        vDNSSetCallBack( pcHostName, pvSearchID, pCallback, uxTimeout, pxRequest->uxIdentifier );
+                        xReturn = prvDNSHasCallBack( pxRequest->uxIdentifier );
+
+                        if( xReturn != pdFALSE )
                         {
-                            /* The user has provided a callback function, so do not block on recvfrom() */
-                            if( xHasRandom != pdFALSE )
+                            xDNSResolverStats.ulQueriesCollapsed++;
+
+                            /* The new call-back gets as many attempts as the
+                             * first one.  When the earlier attempts have all
+                             * been used, the question is sent again now. */
+                            if( pxRequest->uxAttempts >= ( UBaseType_t ) ipconfigDNS_REQUEST_ATTEMPTS )
                             {
-                                uxReadTimeOut_ticks = 0U;
-                                vDNSSetCallBack( pcHostName, pvSearchID, pCallback, uxTimeout, uxIdentifier );
+                                pxRequest->uxRemainingTime = ipconfigDNS_RECEIVE_BLOCK_TIME_TICKS;
+                                vTaskSetTimeOutState( &( pxRequest->xTimeOutState ) );
+                                uxIdentifier = pxRequest->uxIdentifier;
+                                xSend = pdTRUE;
                             }
+
+                            pxRequest->uxAttempts = 1U;
                         }
-                        else
+                    }
+                    else if( pxFree != NULL )
+                    {
+                        vDNSSetCallBack( pcHostName, pvSearchID, pCallback, uxTimeout, uxIdentifier );
+                        xReturn = prvDNSHasCallBack( uxIdentifier );
+
+                        if( xReturn != pdFALSE )
                         {
-                            /* The IP address is known, do the call-back now. */
-                            pCallback( pcHostName, pvSearchID, ulIPAddress );
+                            ( void ) strcpy( pxFree->pcName, pcHostName );
+                            pxFree->uxIdentifier = uxIdentifier;
+                            pxFree->uxAttempts = 1U;
+                            pxFree->uxRemainingTime = ipconfigDNS_RECEIVE_BLOCK_TIME_TICKS;
+                            vTaskSetTimeOutState( &( pxFree->xTimeOutState ) );
+                            xSend = pdTRUE;
                         }
                     }
+                    else
+                    {
+                        /* All entries are in use. */
+                    }
                 }
-            #endif /* if ( ipconfigDNS_USE_CALLBACKS == 1 ) */
+                ( void ) xTaskResumeAll();
+            }
 
-            if( ( ulIPAddress == 0UL ) && ( xHasRandom != pdFALSE ) )
+            if( xSend != pdFALSE )
             {
-                ulIPAddress = prvGetHostByName( pcHostName, uxIdentifier, uxReadTimeOut_ticks );
+                /* If sending fails, the question will be sent again after
+                 * ipconfigDNS_RECEIVE_BLOCK_TIME_TICKS. */
+                ( void ) prvSendDNSRequest( xSocket, pcHostName, uxIdentifier, xFlags );
             }
+
+            return xReturn;
         }
+        /*-----------------------------------------------------------*/
 
-        return ulIPAddress;
-    }
-    /*-----------------------------------------------------------*/
+/**
+ * @brief The call-back of a task waiting in prvDNSResolverWait(): store the
+ *        answer and wake up the task.
+ *
+ * @param[in] pcName: The name that was looked up.
+ * @param[in] pvSearchID: Points to the DNSWaiter_t of the waiting task.
+ * @param[in] ulIPAddress: The IP-address found, or zero at a time-out.
+ */
+        static void prvDNSResolverWake( const char * pcName,
+                                        void * pvSearchID,
+                                        uint32_t ulIPAddress )
+        {
+            DNSWaiter_t * pxWaiter = ( DNSWaiter_t * ) pvSearchID;
+
+            ( void ) pcName;
+
+            pxWaiter->ulIPAddress = ulIPAddress;
+            ( void ) xSemaphoreGive( pxWaiter->xSemaphore );
+        }
+        /*-----------------------------------------------------------*/
 
 /**
- * @brief Prepare and send a message to a DNS server.  'uxReadTimeOut_ticks' will be passed as
- * zero, in case the user has supplied a call-back function.
+ * @brief The blocking version of a look-up through the resolver: the calling
+ *        task waits until the answer has come, or until the question has been
+ *        sent ipconfigDNS_REQUEST_ATTEMPTS times without an answer.
  *
- * @param[in] pcHostName: The hostname for which an IP address is required.
- * @param[in] uxIdentifier: Identifier to send in the DNS message.
- * @param[in] uxReadTimeOut_ticks: The timeout in ticks for waiting. In case the user has supplied
- *                                 a call-back function, this value should be zero.
+ * @param[in] pcHostName: The hostname whose IP address is being searched for.
+ * @param[in] uxIdentifier: A random identifier, used when a new question is sent.
+ * @param[out] pxHandled: Set to pdTRUE if the resolver handled the look-up,
+ *                        pdFALSE when the caller must use a socket of its own.
  *
- * @return The IPv4 IP address for the hostname being queried. It will be zero if there is no reply.
+ * @return The IP-address of the hostname, or zero.
  */
-    static uint32_t prvGetHostByName( const char * pcHostName,
-                                      TickType_t uxIdentifier,
-                                      TickType_t uxReadTimeOut_ticks )
-    {
-        struct freertos_sockaddr xAddress;
-        Socket_t xDNSSocket;
-        uint32_t ulIPAddress = 0UL;
-        uint32_t ulAddressLength = sizeof( struct freertos_sockaddr );
-        BaseType_t xAttempt;
-        int32_t lBytes;
-        size_t uxPayloadLength, uxExpectedPayloadLength;
-        TickType_t uxWriteTimeOut_ticks = ipconfigDNS_SEND_BLOCK_TIME_TICKS;
+        static uint32_t prvDNSResolverWait( const char * pcHostName,
+                                            TickType_t uxIdentifier,
+                                            BaseType_t * pxHandled )
+        {
+            DNSWaiter_t xWaiter;
+            TickType_t uxWaitTicks = ipconfigDNS_RECEIVE_BLOCK_TIME_TICKS * ( TickType_t ) ipconfigDNS_REQUEST_ATTEMPTS;
 
-        #if ( ipconfigUSE_LLMNR == 1 )
-            BaseType_t bHasDot = pdFALSE;
-        #endif /* ipconfigUSE_LLMNR == 1 */
+            #if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+                StaticSemaphore_t xSemaphoreBuffer;
+            #endif
 
-        /* If LLMNR is being used then determine if the host name includes a '.' -
-         * if not then LLMNR can be used as the lookup method. */
-        #if ( ipconfigUSE_LLMNR == 1 )
-            {
-                const char * pucPtr;
+            xWaiter.ulIPAddress = 0UL;
 
-                for( pucPtr = pcHostName; *pucPtr != ( char ) 0; pucPtr++ )
+            #if ( configSUPPORT_STATIC_ALLOCATION == 1 )
                 {
-                    if( *pucPtr == '.' )
-                    {
-                        bHasDot = pdTRUE;
-                        break;
-                    }
+                    xWaiter.xSemaphore = xSemaphoreCreateBinaryStatic( &( xSemaphoreBuffer ) );
+                }
+            #else
+                {
+                    xWaiter.xSemaphore = xSemaphoreCreateBinary();
                 }
+            #endif /* configSUPPORT_STATIC_ALLOCATION */
+
+            if( xWaiter.xSemaphore == NULL )
+            {
+                *pxHandled = pdFALSE;
             }
-        #endif /* ipconfigUSE_LLMNR == 1 */
+            else
+            {
+                /* The time-out of a call-back is expressed in ms. */
+                *pxHandled = prvDNSResolverLookup( pcHostName, prvDNSResolverWake, &( xWaiter ), uxWaitTicks * portTICK_PERIOD_MS, uxIdentifier, 0 );
 
-        /* Two is added at the end for the count of characters in the first
-         * subdomain part and the string end byte. */
-        uxExpectedPayloadLength = sizeof( DNSMessage_t ) + strlen( pcHostName ) + sizeof( uint16_t ) + sizeof( uint16_t ) + 2U;
+                if( *pxHandled != pdFALSE )
+                {
+                    /* The DNS timer checks the time-out of the call-back once
+                     * per second, wait a little longer than the time-out. */
+                    ( void ) xSemaphoreTake( xWaiter.xSemaphore, uxWaitTicks + pdMS_TO_TICKS( 1000U ) );
+
+                    /* Remove the call-back, in case it has not been called.
+                     * Call-backs are called while the scheduler is suspended,
+                     * so after this the semaphore is not used any more. */
+                    FreeRTOS_gethostbyname_cancel( &( xWaiter ) );
+                }
 
-        xDNSSocket = prvCreateDNSSocket();
+                vSemaphoreDelete( xWaiter.xSemaphore );
+            }
 
-        if( xDNSSocket != NULL )
+            return xWaiter.ulIPAddress;
+        }
+        /*-----------------------------------------------------------*/
+
+/**
+ * @brief Free the entry of a question that has been answered.  Called while
+ *        the scheduler is suspended.
+ *
+ * @param[in] uxIdentifier: The identifier of the answered question.
+ */
+        static void prvDNSResolverRelease( TickType_t uxIdentifier )
         {
-            /* Ideally we should check for the return value. But since we are passing
-             * correct parameters, and xDNSSocket is != NULL, the return value is
-             * going to be '0' i.e. success. Thus, return value is discarded */
-            ( void ) FreeRTOS_setsockopt( xDNSSocket, 0, FREERTOS_SO_SNDTIMEO, &( uxWriteTimeOut_ticks ), sizeof( TickType_t ) );
-            ( void ) FreeRTOS_setsockopt( xDNSSocket, 0, FREERTOS_SO_RCVTIMEO, &( uxReadTimeOut_ticks ), sizeof( TickType_t ) );
+            BaseType_t xIndex;
 
-            for( xAttempt = 0; xAttempt < ipconfigDNS_REQUEST_ATTEMPTS; xAttempt++ )
+            for( xIndex = 0; xIndex < ( BaseType_t ) ipconfigDNS_RESOLVER_REQUESTS; xIndex++ )
             {
-                size_t uxHeaderBytes;
-                NetworkBufferDescriptor_t * pxNetworkBuffer;
-                uint8_t * pucUDPPayloadBuffer = NULL, * pucReceiveBuffer;
-
-                /* Get a buffer.  This uses a maximum delay, but the delay will be
-                 * capped to ipconfigUDP_MAX_SEND_BLOCK_TIME_TICKS so the return value
-                 * still needs to be tested. */
+                if( ( xDNSRequests[ xIndex ].uxAttempts != 0U ) && ( xDNSRequests[ xIndex ].uxIdentifier == uxIdentifier ) )
+                {
+                    xDNSRequests[ xIndex ].uxAttempts = 0U;
+                    break;
+                }
+            }
+        }
+        /*-----------------------------------------------------------*/
 
-                uxHeaderBytes = ipSIZE_OF_ETH_HEADER + ipSIZE_OF_IPv4_HEADER + ipSIZE_OF_UDP_HEADER;
+/**
+ * @brief Called along with vDNSCheckCallBack(): free the entries of questions
+ *        whose call-backs have all gone, because of a time-out or a cancel.
+ *        Send the questions that have not been answered in time once more, up
+ *        to ipconfigDNS_REQUEST_ATTEMPTS times.
+ */
+        static void prvDNSResolverCheck( void )
+        {
+            BaseType_t xIndex;
 
-                pxNetworkBuffer = pxGetNetworkBufferWithDescriptor( uxHeaderBytes + uxExpectedPayloadLength, 0UL );
+            for( xIndex = 0; xIndex < ( BaseType_t ) ipconfigDNS_RESOLVER_REQUESTS; xIndex++ )
+            {
+                DNSRequest_t * pxRequest = &( xDNSRequests[ xIndex ] );
+                TickType_t uxIdentifier = 0U;
+                BaseType_t xSend = pdFALSE;
+                char pcName[ dnsRESOLVER_NAME_LENGTH ];
 
-                if( pxNetworkBuffer != NULL )
+                vTaskSuspendAll();
                 {
-                    pucUDPPayloadBuffer = &( pxNetworkBuffer->pucEthernetBuffer[ uxHeaderBytes ] );
+                    if( pxRequest->uxAttempts == 0U )
+                    {
+                        /* This entry is free. */
+                    }
+                    else if( prvDNSHasCallBack( pxRequest->uxIdentifier ) == pdFALSE )
+                    {
+                        /* Nobody waits for this answer anymore. */
+                        pxRequest->uxAttempts = 0U;
+                    }
+                    else if( ( pxRequest->uxAttempts < ( UBaseType_t ) ipconfigDNS_REQUEST_ATTEMPTS ) &&
+                             ( xTaskCheckForTimeOut( &( pxRequest->xTimeOutState ), &( pxRequest->uxRemainingTime ) ) != pdFALSE ) )
+                    {
+                        pxRequest->uxAttempts++;
+                        pxRequest->uxRemainingTime = ipconfigDNS_RECEIVE_BLOCK_TIME_TICKS;
+                        vTaskSetTimeOutState( &( pxRequest->xTimeOutState ) );
+                        ( void ) strcpy( pcName, pxRequest->pcName );
+                        uxIdentifier = pxRequest->uxIdentifier;
+                        xDNSResolverStats.ulRetransmissions++;
+                        xSend = pdTRUE;
+                    }
+                    else
+                    {
+                        /* Still waiting for an answer, or for the call-backs to time out. */
+                    }
                 }
+                ( void ) xTaskResumeAll();
 
-                if( pucUDPPayloadBuffer != NULL )
+                if( xSend != pdFALSE )
                 {
-                    /* Create the message in the obtained buffer. */
-                    uxPayloadLength = prvCreateDNSMessage( pucUDPPayloadBuffer, pcHostName, uxIdentifier );
+                    /* This may run in the IP-task, which must not block. */
+                    ( void ) prvSendDNSRequest( xDNSResolverSocket, pcName, uxIdentifier, FREERTOS_MSG_DONTWAIT );
+                }
+            }
+        }
+        /*-----------------------------------------------------------*/
 
-                    iptraceSENDING_DNS_REQUEST();
+    #endif /* ipconfigDNS_USE_RESOLVER == 1 */
 
-                    /* Obtain the DNS server address. */
-                    FreeRTOS_GetAddressConfiguration( NULL, NULL, NULL, &ulIPAddress );
+    #if ( ipconfigDNS_USE_PREFETCH == 1 )
 
-                    /* Send the DNS message. */
-                    #if ( ipconfigUSE_LLMNR == 1 )
-                        if( bHasDot == pdFALSE )
-                        {
-                            /* Use LLMNR addressing. */
-                            ( ipCAST_PTR_TO_TYPE_PTR( DNSMessage_t, pucUDPPayloadBuffer ) )->usFlags = 0;
-                            xAddress.sin_addr = ipLLMNR_IP_ADDR; /* Is in network byte order. */
-                            xAddress.sin_port = ipLLMNR_PORT;
-                            xAddress.sin_port = FreeRTOS_ntohs( xAddress.sin_port );
-                        }
-                        else
-                    #endif
-                    {
-                        /* Use DNS server. */
-                        xAddress.sin_addr = ulIPAddress;
-                        xAddress.sin_port = dnsDNS_PORT;
-                    }
+/** @brief The longest time, in seconds, that the DNS timer sleeps while there
+ * are popular names in the cache. */
+        #define dnsPREFETCH_MAX_SLEEP_SECONDS    600UL
+
+/**
+ * @brief Called along with vDNSCheckCallBack(): send a question for every
+ *        name that has been looked up at least ipconfigDNS_PREFETCH_MIN_LOOKUPS
+ *        times, and of which less than ipconfigDNS_PREFETCH_PERCENT of the TTL
+ *        is left.  The answer will update the cache entry, which is used
+ *        until then.  Every answer is refreshed at most once.
+ *
+ * @return The number of seconds until the next popular name must be
+ *         refreshed, or zero when there is none.
+ */
+        static uint32_t prvDNSPrefetchCheck( void )
+        {
+            BaseType_t x;
+            uint32_t ulCurrentTimeSeconds = ( xTaskGetTickCount() / portTICK_PERIOD_MS ) / 1000UL;
+            uint32_t ulNext = 0UL;
+            uint32_t ulTTL, ulLead, ulExpiry;
+            uint32_t ulNumber;
+            char pcName[ ipconfigDNS_CACHE_NAME_LENGTH ];
+            BaseType_t xSend;
+
+            /* The questions are sent from the shared socket.  It can only be
+             * created by a user task. */
+            if( xDNSResolverSocket != NULL )
+            {
+                for( x = 0; x < ipconfigDNS_CACHE_ENTRIES; x++ )
+                {
+                    DNSCacheRow_t * pxRow = &( xDNSCache[ x ] );
 
-                    ulIPAddress = 0UL;
+                    xSend = pdFALSE;
 
-                    if( FreeRTOS_sendto( xDNSSocket, pucUDPPayloadBuffer, uxPayloadLength, FREERTOS_ZERO_COPY, &xAddress, sizeof( xAddress ) ) != 0 )
+                    vTaskSuspendAll();
                     {
-                        /* Wait for the reply. */
-                        lBytes = FreeRTOS_recvfrom( xDNSSocket, &pucReceiveBuffer, 0, FREERTOS_ZERO_COPY, &xAddress, &ulAddressLength );
-
-                        if( lBytes > 0 )
+                        if( ( pxRow->pcName[ 0 ] != ( char ) 0 ) &&
+                            ( pxRow->ulIPAddresses[ 0 ] != 0UL ) &&
+                            ( pxRow->ucLookUps >= ( uint8_t ) ipconfigDNS_PREFETCH_MIN_LOOKUPS ) &&
+                            ( pxRow->ucRefreshing == 0U ) )
                         {
-                            BaseType_t xExpected;
-                            const DNSMessage_t * pxDNSMessageHeader = ipCAST_CONST_PTR_TO_CONST_TYPE_PTR( DNSMessage_t, pucReceiveBuffer );
+                            ulTTL = FreeRTOS_ntohl( pxRow->ulTTL );
+                            ulExpiry = pxRow->ulTimeWhenAddedInSeconds + ulTTL;
 
-                            /* See if the identifiers match. */
-                            if( uxIdentifier == ( TickType_t ) pxDNSMessageHeader->usIdentifier )
+                            /* Avoid an overflow when the TTL is very long. */
+                            if( ulTTL > ( 0xFFFFFFFFUL / 100UL ) )
                             {
-                                xExpected = pdTRUE;
+                                ulLead = ( ulTTL / 100UL ) * ipconfigDNS_PREFETCH_PERCENT;
                             }
                             else
                             {
-                                /* The reply was not expected. */
-                                xExpected = pdFALSE;
+                                ulLead = ( ulTTL * ipconfigDNS_PREFETCH_PERCENT ) / 100UL;
                             }
 
-                            /* The reply was received.  Process it. */
-                            #if ( ipconfigDNS_USE_CALLBACKS == 0 )
-
-                                /* It is useless to analyse the unexpected reply
-                                 * unless asynchronous look-ups are enabled. */
-                                if( xExpected != pdFALSE )
-                            #endif /* ipconfigDNS_USE_CALLBACKS == 0 */
+                            if( ulLead == 0UL )
                             {
-                                ulIPAddress = prvParseDNSReply( pucReceiveBuffer, ( size_t ) lBytes, xExpected );
+                                ulLead = 1UL;
                             }
 
-                            /* Finished with the buffer.  The zero copy interface
-                             * is being used, so the buffer must be freed by the
-                             * task. */
-                            FreeRTOS_ReleaseUDPPayloadBuffer( pucReceiveBuffer );
-
-                            if( ulIPAddress != 0UL )
+                            if( ulCurrentTimeSeconds >= ulExpiry )
                             {
-                                /* All done. */
-                                /* coverity[break_stmt] : Break statement terminating the loop */
-                                break;
+                                /* Too late, the next look-up will ask for it. */
+                            }
+                            else if( ulCurrentTimeSeconds >= ( ulExpiry - ulLead ) )
+                            {
+                                pxRow->ucRefreshing = 1U;
+                                ( void ) strcpy( pcName, pxRow->pcName );
+                                xSend = pdTRUE;
+                            }
+                            else if( ( ulNext == 0UL ) || ( ( ulExpiry - ulLead - ulCurrentTimeSeconds ) < ulNext ) )
+                            {
+                                ulNext = ulExpiry - ulLead - ulCurrentTimeSeconds;
+                            }
+                            else
+                            {
+                                /* Another name must be refreshed earlier. */
                             }
                         }
                     }
-                    else
+                    ( void ) xTaskResumeAll();
+
+                    if( xSend != pdFALSE )
                     {
-                        /* The message was not sent so the stack will not be
-                         * releasing the zero copy - it must be released here. */
-                        vReleaseNetworkBufferAndDescriptor( pxNetworkBuffer );
+                        if( ( xApplicationGetRandomNumber( &( ulNumber ) ) != pdFALSE ) &&
+                            ( prvDNSResolverLookup( pcName,
+                                                    prvDNSPrefetchDone,
+                                                    NULL,
+                                                    ipconfigDNS_RECEIVE_BLOCK_TIME_TICKS * ( TickType_t ) ipconfigDNS_REQUEST_ATTEMPTS * portTICK_PERIOD_MS,
+                                                    ( TickType_t ) ( ulNumber & 0xffffU ),
+                                                    FREERTOS_MSG_DONTWAIT ) != pdFALSE ) )
+                        {
+                            FreeRTOS_debug_printf( ( "prvDNSPrefetchCheck: refresh '%s'\n", pcName ) );
+                            vTaskSuspendAll();
+                            {
+                                xDNSCacheStats.ulPrefetches++;
+                            }
+                            ( void ) xTaskResumeAll();
+                        }
+                        else
+                        {
+                            /* Try again at the next check. */
+                            vTaskSuspendAll();
+                            {
+                                if( strcmp( pxRow->pcName, pcName ) == 0 )
+                                {
+                                    pxRow->ucRefreshing = 0U;
+                                }
+                            }
+                            ( void ) xTaskResumeAll();
+                            ulNext = 1UL;
+                        }
                     }
                 }
+            }
 
-                if( uxReadTimeOut_ticks == 0U )
-                {
-                    /* This DNS lookup is asynchronous, using a call-back:
-                     * send the request only once. */
-                    break;
-                }
-            }
-
-            /* Finished with the socket. */
-            ( void ) FreeRTOS_closesocket( xDNSSocket );
+            return FreeRTOS_min_uint32( ulNext, dnsPREFETCH_MAX_SLEEP_SECONDS );
         }
-
-        return ulIPAddress;
-    }
-    /*-----------------------------------------------------------*/
+        /*-----------------------------------------------------------*/
 
 /**
- * @brief Create the DNS message in the zero copy buffer passed in the first parameter.
- *
- * @param[in,out] pucUDPPayloadBuffer: The zero copy buffer where the DNS message will be created.
- * @param[in] pcHostName: Hostname to be looked up.
- * @param[in] uxIdentifier: The identifier to be added to the DNS message.
+ * @brief The call-back of a refresh.  There is nothing to do: because a
+ *        call-back is waiting, prvParseDNSReply() stores the answer in the
+ *        cache.
  *
- * @return Total size of the generated message, which is the space from the last written byte
- *         to the beginning of the buffer.
+ * @param[in] pcName: The name that was refreshed.
+ * @param[in] pvSearchID: Not used.
+ * @param[in] ulIPAddress: The IP-address found, or zero at a time-out.
  */
-    _static size_t prvCreateDNSMessage( uint8_t * pucUDPPayloadBuffer,
-                                        const char * pcHostName,
-                                        TickType_t uxIdentifier )
-    {
-        DNSMessage_t * pxDNSMessageHeader;
-        size_t uxStart, uxIndex;
-        DNSTail_t const * pxTail;
-        static const DNSMessage_t xDefaultPartDNSHeader =
+        static void prvDNSPrefetchDone( const char * pcName,
+                                        void * pvSearchID,
+                                        uint32_t ulIPAddress )
         {
-            0,                 /* The identifier will be overwritten. */
-            dnsOUTGOING_FLAGS, /* Flags set for standard query. */
-            dnsONE_QUESTION,   /* One question is being asked. */
-            0,                 /* No replies are included. */
-            0,                 /* No authorities. */
-            0                  /* No additional authorities. */
-        };
+            ( void ) pcName;
+            ( void ) pvSearchID;
+            ( void ) ulIPAddress;
+        }
+        /*-----------------------------------------------------------*/
 
-        /* memcpy() helper variables for MISRA Rule 21.15 compliance*/
-        const void * pvCopySource;
-        void * pvCopyDest;
+    #endif /* ipconfigDNS_USE_PREFETCH == 1 */
 
-        /* Copy in the const part of the header. Intentionally using different
-         * pointers with memcpy() to put the information in to correct place. */
+    #if ( ipconfigDNS_MAX_SERVERS > 1 )
 
-        /*
-         * Use helper variables for memcpy() to remain
-         * compliant with MISRA Rule 21.15.  These should be
-         * optimized away.
-         */
-        pvCopySource = &xDefaultPartDNSHeader;
-        pvCopyDest = pucUDPPayloadBuffer;
-        ( void ) memcpy( pvCopyDest, pvCopySource, sizeof( xDefaultPartDNSHeader ) );
+/** @brief The sources from which a DNS server is known. */
+        #define dnsSERVER_PRIMARY          0x01U /**< The server of FreeRTOS_GetAddressConfiguration(). */
+        #define dnsSERVER_DHCP             0x02U /**< A server offered in DHCP option 6. */
+        #define dnsSERVER_STATIC           0x04U /**< A server set by FreeRTOS_SetDNSServers(). */
 
-        /* Write in a unique identifier. Cast the Payload Buffer to DNSMessage_t
-         * to easily access fields of the DNS Message. */
-        pxDNSMessageHeader = ipCAST_PTR_TO_TYPE_PTR( DNSMessage_t, pucUDPPayloadBuffer );
-        pxDNSMessageHeader->usIdentifier = ( uint16_t ) uxIdentifier;
+/** @brief The round-trip time, in ms, assumed for a server that has not been
+ * measured yet. */
+        #define dnsSERVER_INITIAL_RTT_MS    100UL
 
-        /* Create the resource record at the end of the header.  First
-         * find the end of the header. */
-        uxStart = sizeof( xDefaultPartDNSHeader );
+/** @brief The cost, in ms, of a question that was not answered in time. */
+        #define dnsSERVER_TIMEOUT_MS        ( ( uint32_t ) ipconfigDNS_RECEIVE_BLOCK_TIME_TICKS * portTICK_PERIOD_MS )
 
-        /* Leave a gap for the first length byte. */
-        uxIndex = uxStart + 1U;
+/** @brief The values of DNSServer_t::ucPending: the question is being timed,
+ * and a failure is counted when it is not answered in time. */
+        #define dnsSERVER_PENDING             1U
 
-        /* Copy in the host name. */
-        ( void ) strcpy( ( char * ) &( pucUDPPayloadBuffer[ uxIndex ] ), pcHostName );
+/** @brief The question is being timed, but another server has answered it
+ * already.  The asking task may have closed its socket, so a missing answer
+ * is not counted as a failure, but as a round-trip time of the time-out. */
+        #define dnsSERVER_PENDING_ANSWERED    2U
 
-        /* Walk through the string to replace the '.' characters with byte
-         * counts.  pucStart holds the address of the byte count.  Walking the
-         * string starts after the byte count position. */
-        uxIndex = uxStart;
+/** @brief The question was sent from the resolver's shared socket, which stays
+ * open: a late answer is still received, a missing one is a failure. */
+        #define dnsSERVER_PENDING_SHARED      3U
 
-        do
+/** @brief A DNS server and the measurements of its answers.  Only the latest
+ * question sent to a server is timed. */
+        typedef struct xDNS_SERVER
         {
-            size_t uxLength;
+            uint32_t ulIPAddress; /**< The address, in network byte order. */
+            uint32_t ulRTT;       /**< The smoothed round-trip time in ms, zero when not measured. */
+            uint32_t ulAnswers;   /**< The number of answers that were timed. */
+            TickType_t xSentTime; /**< The time at which the question being timed was sent. */
+            uint16_t usPendingID; /**< The identifier of the question being timed. */
+            uint8_t ucPending;    /**< Non-zero while a question is being timed. */
+            uint8_t ucFailures;   /**< Questions not answered in time since the last answer. */
+            uint8_t ucSources;    /**< A combination of the dnsSERVER_ source bits. */
+        } DNSServer_t;
+
+/** @brief The known DNS servers, the first uxDNSServerCount entries are used. */
+        static DNSServer_t xDNSServers[ ipconfigDNS_MAX_SERVERS ];
+        static UBaseType_t uxDNSServerCount = 0U;
+
+/** @brief The address of the primary server when it was last seen. */
+        static uint32_t ulDNSPrimaryServer = 0UL;
 
-            /* Skip the length byte. */
-            uxIndex++;
+/**
+ * @brief Replace the servers of one source by a new list, keeping the
+ *        measurements of the servers that remain.  Servers without any
+ *        source are removed.  Called while the scheduler is suspended.
+ *
+ * @param[in] pulAddresses: The addresses in network byte order.
+ * @param[in] uxCount: The number of addresses.
+ * @param[in] ucSource: One of the dnsSERVER_ source bits.
+ */
+        static void prvDNSServerSetSource( const uint32_t * pulAddresses,
+                                           UBaseType_t uxCount,
+                                           uint8_t ucSource )
+        {
+            UBaseType_t uxIndex, uxServer, uxTarget = 0U;
 
-            while( ( pucUDPPayloadBuffer[ uxIndex ] != ( uint8_t ) 0U ) &&
-                   ( pucUDPPayloadBuffer[ uxIndex ] != ( uint8_t ) ASCII_BASELINE_DOT ) )
+            for( uxServer = 0U; uxServer < uxDNSServerCount; uxServer++ )
             {
-                uxIndex++;
+                xDNSServers[ uxServer ].ucSources &= ( uint8_t ) ~ucSource;
+
+                /* Remove the servers that are not known from any source anymore. */
+                if( xDNSServers[ uxServer ].ucSources != 0U )
+                {
+                    if( uxTarget != uxServer )
+                    {
+                        xDNSServers[ uxTarget ] = xDNSServers[ uxServer ];
+                    }
+
+                    uxTarget++;
+                }
             }
 
-            /* Fill in the byte count, then move the pucStart pointer up to
-             * the found byte position. */
-            uxLength = uxIndex - ( uxStart + 1U );
-            pucUDPPayloadBuffer[ uxStart ] = ( uint8_t ) uxLength;
+            uxDNSServerCount = uxTarget;
 
-            uxStart = uxIndex;
-        } while( pucUDPPayloadBuffer[ uxIndex ] != ( uint8_t ) 0U );
+            for( uxIndex = 0U; uxIndex < uxCount; uxIndex++ )
+            {
+                if( pulAddresses[ uxIndex ] == 0UL )
+                {
+                    continue;
+                }
 
-        /* Finish off the record. Cast the record onto DNSTail_t structure to easily
-         * access the fields of the DNS Message. */
-        pxTail = ipCAST_PTR_TO_TYPE_PTR( DNSTail_t, &( pucUDPPayloadBuffer[ uxStart + 1U ] ) );
+                for( uxServer = 0U; uxServer < uxDNSServerCount; uxServer++ )
+                {
+                    if( xDNSServers[ uxServer ].ulIPAddress == pulAddresses[ uxIndex ] )
+                    {
+                        break;
+                    }
+                }
 
-        #if defined( _lint ) || defined( __COVERITY__ )
-            ( void ) pxTail;
-        #else
-            vSetField16( pxTail, DNSTail_t, usType, dnsTYPE_A_HOST );
-            vSetField16( pxTail, DNSTail_t, usClass, dnsCLASS_IN );
-        #endif
+                if( uxServer < uxDNSServerCount )
+                {
+                    xDNSServers[ uxServer ].ucSources |= ucSource;
+                }
+                else if( uxDNSServerCount < ( UBaseType_t ) ipconfigDNS_MAX_SERVERS )
+                {
+                    ( void ) memset( &( xDNSServers[ uxDNSServerCount ] ), 0, sizeof( xDNSServers[ uxDNSServerCount ] ) );
+                    xDNSServers[ uxDNSServerCount ].ulIPAddress = pulAddresses[ uxIndex ];
+                    xDNSServers[ uxDNSServerCount ].ucSources = ucSource;
+                    uxDNSServerCount++;
+                }
+                else
+                {
+                    /* The table is full. */
+                }
+            }
+        }
+        /*-----------------------------------------------------------*/
 
-        /* Return the total size of the generated message, which is the space from
-         * the last written byte to the beginning of the buffer. */
-        return uxIndex + sizeof( DNSTail_t ) + 1U;
-    }
-    /*-----------------------------------------------------------*/
+/**
+ * @brief Add the server of FreeRTOS_GetAddressConfiguration() to the list,
+ *        in case it has changed.  Called while the scheduler is suspended.
+ */
+        static void prvDNSServerSyncPrimary( void )
+        {
+            uint32_t ulPrimary = 0UL;
 
-    #if ( ipconfigUSE_DNS_CACHE == 1 ) || ( ipconfigDNS_USE_CALLBACKS == 1 )
+            FreeRTOS_GetAddressConfiguration( NULL, NULL, NULL, &( ulPrimary ) );
+
+            if( ulPrimary != ulDNSPrimaryServer )
+            {
+                ulDNSPrimaryServer = ulPrimary;
+                prvDNSServerSetSource( &( ulPrimary ), 1U, dnsSERVER_PRIMARY );
+            }
+        }
+        /*-----------------------------------------------------------*/
 
 /**
- * @brief Read the Name field out of a DNS response packet.
+ * @brief The cost of a server: its round-trip time, plus the receive time-out
+ *        for every question that it did not answer.
  *
- * @param[in] pucByte: Pointer to the DNS response.
- * @param[in] uxRemainingBytes: Length of the DNS response.
- * @param[out] pcName: The pointer in which the name in the DNS response will be returned.
- * @param[in] uxDestLen: Size of the pcName array.
+ * @param[in] pxServer: The server.
  *
- * @return If a fully formed name was found, then return the number of bytes processed in pucByte.
+ * @return The cost in ms.
  */
-        _static size_t prvReadNameField( const uint8_t * pucByte,
-                                         size_t uxRemainingBytes,
-                                         char * pcName,
-                                         size_t uxDestLen )
+        static uint32_t prvDNSServerCost( const DNSServer_t * pxServer )
         {
-            size_t uxNameLen = 0U;
-            size_t uxIndex = 0U;
-            size_t uxSourceLen = uxRemainingBytes;
+            uint32_t ulCost = ( pxServer->ulRTT != 0UL ) ? pxServer->ulRTT : dnsSERVER_INITIAL_RTT_MS;
 
-            /* uxCount gets the values from pucByte and counts down to 0.
-             * No need to have a different type than that of pucByte */
-            size_t uxCount;
+            return ulCost + ( ( uint32_t ) pxServer->ucFailures * dnsSERVER_TIMEOUT_MS );
+        }
+        /*-----------------------------------------------------------*/
 
-            if( uxSourceLen == ( size_t ) 0U )
-            {
-                /* Return 0 value in case of error. */
-                uxIndex = 0U;
-            }
+/**
+ * @brief Sort the indexes of the servers by their cost.  When the costs are
+ *        equal, the primary server goes first, then the oldest entry.
+ *        Called while the scheduler is suspended.
+ *
+ * @param[out] pucOrder: The indexes, the best ranked server first.
+ *
+ * @return The number of servers.
+ */
+        static BaseType_t prvDNSServerRank( uint8_t * pucOrder )
+        {
+            BaseType_t x, y;
+            uint8_t ucIndex;
+            uint32_t ulCost;
 
-            /* Determine if the name is the fully coded name, or an offset to the name
-             * elsewhere in the message. */
-            else if( ( pucByte[ uxIndex ] & dnsNAME_IS_OFFSET ) == dnsNAME_IS_OFFSET )
+            for( x = 0; x < ( BaseType_t ) uxDNSServerCount; x++ )
             {
-                /* Jump over the two byte offset. */
-                if( uxSourceLen > sizeof( uint16_t ) )
-                {
-                    uxIndex += sizeof( uint16_t );
-                }
-                else
+                ucIndex = ( uint8_t ) x;
+                ulCost = prvDNSServerCost( &( xDNSServers[ x ] ) );
+
+                for( y = x; y > 0; y-- )
                 {
-                    uxIndex = 0U;
+                    const DNSServer_t * pxOther = &( xDNSServers[ pucOrder[ y - 1 ] ] );
+                    uint32_t ulOtherCost = prvDNSServerCost( pxOther );
+
+                    if( ( ulOtherCost < ulCost ) ||
+                        ( ( ulOtherCost == ulCost ) &&
+                          ( ( ( pxOther->ucSources & dnsSERVER_PRIMARY ) != 0U ) || ( ( xDNSServers[ x ].ucSources & dnsSERVER_PRIMARY ) == 0U ) ) ) )
+                    {
+                        break;
+                    }
+
+                    pucOrder[ y ] = pucOrder[ y - 1 ];
                 }
+
+                pucOrder[ y ] = ucIndex;
+            }
+
+            return ( BaseType_t ) uxDNSServerCount;
+        }
+        /*-----------------------------------------------------------*/
+
+/**
+ * @brief Add a round-trip time sample to the smoothed round-trip time of a
+ *        server.  Called while the scheduler is suspended.
+ *
+ * @param[in] pxServer: The server.
+ * @param[in] ulSample: The round-trip time in ms.
+ */
+        static void prvDNSServerSample( DNSServer_t * pxServer,
+                                        uint32_t ulSample )
+        {
+            /* Smooth the round-trip time like TCP does, with a gain of 1/8. */
+            if( pxServer->ulRTT == 0UL )
+            {
+                pxServer->ulRTT = ulSample;
             }
             else
             {
-                /* 'uxIndex' points to the full name. Walk over the string. */
-                while( ( uxIndex < uxSourceLen ) && ( pucByte[ uxIndex ] != ( uint8_t ) 0x00U ) )
-                {
-                    /* If this is not the first time through the loop, then add a
-                     * separator in the output. */
-                    if( ( uxNameLen > 0U ) )
-                    {
-                        if( uxNameLen >= uxDestLen )
-                        {
-                            uxIndex = 0U;
-                            /* coverity[break_stmt] : Break statement terminating the loop */
-                            break;
-                        }
+                pxServer->ulRTT = ( ( 7UL * pxServer->ulRTT ) + ulSample ) / 8UL;
+            }
+        }
+        /*-----------------------------------------------------------*/
 
-                        pcName[ uxNameLen ] = '.';
-                        uxNameLen++;
-                    }
+/**
+ * @brief Choose the servers to which a question is sent: the
+ *        ipconfigDNS_PARALLEL_QUERIES best ranked ones.  A server that has not
+ *        answered its previous question in time gets a failure first, so a
+ *        question that is sent again goes to the servers that follow it.
+ *        A server that lost the race against another server gets a
+ *        round-trip time sample of the time-out instead, so that a server
+ *        that is down still drops in the ranking.
+ *
+ * @param[in] uxIdentifier: The identifier of the question.
+ * @param[in] xSharedSocket: pdTRUE when the question is sent from the
+ *                           resolver's socket, which stays open.
+ * @param[out] pulTargets: The addresses of the chosen servers.
+ *
+ * @return The number of addresses in pulTargets, at least one.
+ */
+        static BaseType_t prvDNSServerSelect( TickType_t uxIdentifier,
+                                              BaseType_t xSharedSocket,
+                                              uint32_t * pulTargets )
+        {
+            uint8_t ucOrder[ ipconfigDNS_MAX_SERVERS ];
+            BaseType_t x, xCount, xTargets = 0;
+            TickType_t xNow = xTaskGetTickCount();
 
-                    /* Process the first/next sub-string. */
-                    uxCount = ( size_t ) pucByte[ uxIndex ];
-                    uxIndex++;
+            vTaskSuspendAll();
+            {
+                prvDNSServerSyncPrimary();
 
-                    if( ( uxIndex + uxCount ) > uxSourceLen )
-                    {
-                        uxIndex = 0U;
-                        break;
-                    }
+                for( x = 0; x < ( BaseType_t ) uxDNSServerCount; x++ )
+                {
+                    DNSServer_t * pxServer = &( xDNSServers[ x ] );
 
-                    while( uxCount-- != 0U )
+                    if( ( pxServer->ucPending != 0U ) && ( ( xNow - pxServer->xSentTime ) >= ipconfigDNS_RECEIVE_BLOCK_TIME_TICKS ) )
                     {
-                        if( uxNameLen >= uxDestLen )
+                        if( pxServer->ucPending == dnsSERVER_PENDING_ANSWERED )
                         {
-                            uxIndex = 0U;
-                            break;
-
-                            /* break out of inner loop here
-                             * break out of outer loop at the test uxNameLen >= uxDestLen. */
+                            prvDNSServerSample( pxServer, dnsSERVER_TIMEOUT_MS );
+                        }
+                        else if( pxServer->ucFailures < 0xFFU )
+                        {
+                            pxServer->ucFailures++;
+                        }
+                        else
+                        {
+                            /* The number of failures is at its maximum. */
                         }
 
-                        pcName[ uxNameLen ] = ( char ) pucByte[ uxIndex ];
-                        uxNameLen++;
-                        uxIndex++;
+                        pxServer->ucPending = 0U;
                     }
                 }
 
-                /* Confirm that a fully formed name was found. */
-                if( uxIndex > 0U )
+                xCount = prvDNSServerRank( ucOrder );
+
+                if( xCount == 0 )
                 {
-                    /* Here, there is no need to check for pucByte[ uxindex ] == 0 because:
-                     * When we break out of the above while loop, uxIndex is made 0 thereby
-                     * failing above check. Whenever we exit the loop otherwise, either
-                     * pucByte[ uxIndex ] == 0 (which makes the check here unnecessary) or
-                     * uxIndex >= uxSourceLen (which makes sure that we do not go in the 'if'
-                     * case).
-                     */
-                    if( ( uxNameLen < uxDestLen ) && ( uxIndex < uxSourceLen ) )
-                    {
-                        pcName[ uxNameLen ] = '\0';
-                        uxIndex++;
-                    }
-                    else
+                    /* No server is known, the question goes to the primary
+                     * address, as it did without a list of servers. */
+                    pulTargets[ 0 ] = ulDNSPrimaryServer;
+                    xTargets = 1;
+                }
+                else
+                {
+                    for( x = 0; ( x < ipconfigDNS_PARALLEL_QUERIES ) && ( x < xCount ); x++ )
                     {
-                        uxIndex = 0U;
+                        DNSServer_t * pxServer = &( xDNSServers[ ucOrder[ x ] ] );
+
+                        pulTargets[ xTargets ] = pxServer->ulIPAddress;
+                        xTargets++;
+                        pxServer->usPendingID = ( uint16_t ) uxIdentifier;
+                        pxServer->xSentTime = xNow;
+                        pxServer->ucPending = ( xSharedSocket != pdFALSE ) ? dnsSERVER_PENDING_SHARED : dnsSERVER_PENDING;
                     }
                 }
             }
+            ( void ) xTaskResumeAll();
 
-            return uxIndex;
+            return xTargets;
         }
-    #endif /* ipconfigUSE_DNS_CACHE || ipconfigDNS_USE_CALLBACKS */
-    /*-----------------------------------------------------------*/
+        /*-----------------------------------------------------------*/
 
 /**
- * @brief Simple routine that jumps over the NAME field of a resource record.
- *
- * @param[in] pucByte: The pointer to the resource record.
- * @param[in] uxLength: Length of the resource record.
+ * @brief A DNS reply has been received: when it answers the question that is
+ *        being timed, update the round-trip time of the server.  The other
+ *        servers that were asked the same question from a socket of its own
+ *        will not get a failure when their answer does not come:
+ *        prvGetHostByName() closes its socket after the first answer.
  *
- * @return It returns the number of bytes read, or zero when an error has occurred.
+ * @param[in] ulIPAddress: The address of the sender, in network byte order.
+ * @param[in] usIdentifier: The identifier of the reply.
  */
-    _static size_t prvSkipNameField( const uint8_t * pucByte,
-                                     size_t uxLength )
-    {
-        size_t uxChunkLength;
-        size_t uxSourceLenCpy = uxLength;
-        size_t uxIndex = 0U;
-
-        if( uxSourceLenCpy == 0U )
+        static void prvDNSServerAnswered( uint32_t ulIPAddress,
+                                          uint16_t usIdentifier )
         {
-            uxIndex = 0U;
-        }
+            UBaseType_t uxServer;
+            uint32_t ulSample;
 
-        /* Determine if the name is the fully coded name, or an offset to the name
-         * elsewhere in the message. */
-        else if( ( pucByte[ uxIndex ] & dnsNAME_IS_OFFSET ) == dnsNAME_IS_OFFSET )
-        {
-            /* Jump over the two byte offset. */
-            if( uxSourceLenCpy > sizeof( uint16_t ) )
+            vTaskSuspendAll();
             {
-                uxIndex += sizeof( uint16_t );
+                for( uxServer = 0U; uxServer < uxDNSServerCount; uxServer++ )
+                {
+                    DNSServer_t * pxServer = &( xDNSServers[ uxServer ] );
+
+                    if( ( pxServer->ucPending != 0U ) && ( pxServer->usPendingID == usIdentifier ) )
+                    {
+                        if( pxServer->ulIPAddress == ulIPAddress )
+                        {
+                            ulSample = ( uint32_t ) ( xTaskGetTickCount() - pxServer->xSentTime ) * portTICK_PERIOD_MS;
+
+                            if( ulSample == 0UL )
+                            {
+                                ulSample = 1UL;
+                            }
+
+                            prvDNSServerSample( pxServer, ulSample );
+                            pxServer->ucPending = 0U;
+                            pxServer->ucFailures = 0U;
+                            pxServer->ulAnswers++;
+                        }
+                        else if( pxServer->ucPending == dnsSERVER_PENDING )
+                        {
+                            /* Still time the answer of this server, if it comes. */
+                            pxServer->ucPending = dnsSERVER_PENDING_ANSWERED;
+                        }
+                        else
+                        {
+                            /* The answer will be received, if it comes. */
+                        }
+                    }
+                }
             }
-            else
+            ( void ) xTaskResumeAll();
+        }
+        /*-----------------------------------------------------------*/
+
+/**
+ * @brief Set the list of statically configured DNS servers.
+ *
+ * @param[in] pulAddresses: The addresses in network byte order.
+ * @param[in] uxCount: The number of addresses, zero to remove them.
+ */
+        void FreeRTOS_SetDNSServers( const uint32_t * pulAddresses,
+                                     UBaseType_t uxCount )
+        {
+            vTaskSuspendAll();
             {
-                uxIndex = 0U;
+                prvDNSServerSetSource( pulAddresses, ( pulAddresses != NULL ) ? uxCount : 0U, dnsSERVER_STATIC );
             }
+            ( void ) xTaskResumeAll();
         }
-        else
+        /*-----------------------------------------------------------*/
+
+/**
+ * @brief Set the list of DNS servers offered by the DHCP server.
+ *
+ * @param[in] pucAddresses: The contents of DHCP option 6.
+ * @param[in] uxCount: The number of addresses in pucAddresses.
+ */
+        void vDNSSetDHCPServers( const uint8_t * pucAddresses,
+                                 UBaseType_t uxCount )
         {
-            /* pucByte points to the full name. Walk over the string. */
-            while( ( pucByte[ uxIndex ] != 0U ) && ( uxSourceLenCpy > 1U ) )
-            {
-                /* Conversion to size_t causes addition to be done
-                 * in size_t */
-                uxChunkLength = ( ( size_t ) pucByte[ uxIndex ] ) + 1U;
+            uint32_t ulAddresses[ ipconfigDNS_MAX_SERVERS ];
+            UBaseType_t uxIndex;
+            UBaseType_t uxUsed = FreeRTOS_min_uint32( uxCount, ipconfigDNS_MAX_SERVERS );
 
-                if( uxSourceLenCpy > uxChunkLength )
-                {
-                    uxSourceLenCpy -= uxChunkLength;
-                    uxIndex += uxChunkLength;
-                }
-                else
-                {
-                    uxIndex = 0U;
-                    break;
-                }
+            /* The option may not be aligned. */
+            for( uxIndex = 0U; uxIndex < uxUsed; uxIndex++ )
+            {
+                ( void ) memcpy( &( ulAddresses[ uxIndex ] ), &( pucAddresses[ uxIndex * sizeof( uint32_t ) ] ), sizeof( uint32_t ) );
             }
 
-            /* Confirm that a fully formed name was found. */
-            if( uxIndex > 0U )
+            vTaskSuspendAll();
             {
-                if( pucByte[ uxIndex ] == 0U )
-                {
-                    uxIndex++;
-                }
-                else
-                {
-                    uxIndex = 0U;
-                }
+                prvDNSServerSetSource( ulAddresses, uxUsed, dnsSERVER_DHCP );
             }
+            ( void ) xTaskResumeAll();
         }
-
-        return uxIndex;
-    }
-    /*-----------------------------------------------------------*/
-
-/* The function below will only be called :
- * when ipconfigDNS_USE_CALLBACKS == 1
- * when ipconfigUSE_LLMNR == 1
- * for testing purposes, by the module test_freertos_tcp.c
- */
+        /*-----------------------------------------------------------*/
 
 /**
- * @brief Perform some preliminary checks and then parse the DNS packet.
+ * @brief Get the state of the DNS servers, the best ranked one first.
  *
- * @param[in] pxNetworkBuffer: The network buffer to be parsed.
+ * @param[out] pxServers: Where the state will be copied to.
+ * @param[in] uxMaxCount: The number of entries in pxServers.
  *
- * @return Always pdFAIL to indicate that the packet was not consumed and must
- *         be released by the caller.
+ * @return The number of servers copied.
  */
-    uint32_t ulDNSHandlePacket( const NetworkBufferDescriptor_t * pxNetworkBuffer )
-    {
-        uint8_t * pucPayLoadBuffer;
-        size_t uxPayloadSize;
-
-        /* Only proceed if the payload length indicated in the header
-         * appears to be valid. */
-        if( pxNetworkBuffer->xDataLength >= sizeof( UDPPacket_t ) )
+        UBaseType_t FreeRTOS_GetDNSServers( DNSServerInfo_t * pxServers,
+                                            UBaseType_t uxMaxCount )
         {
-            uxPayloadSize = pxNetworkBuffer->xDataLength - sizeof( UDPPacket_t );
+            uint8_t ucOrder[ ipconfigDNS_MAX_SERVERS ];
+            BaseType_t x, xCount;
 
-            if( uxPayloadSize >= sizeof( DNSMessage_t ) )
+            vTaskSuspendAll();
             {
-                pucPayLoadBuffer = &( pxNetworkBuffer->pucEthernetBuffer[ sizeof( UDPPacket_t ) ] );
+                prvDNSServerSyncPrimary();
+                xCount = prvDNSServerRank( ucOrder );
 
-                /* The parameter pdFALSE indicates that the reply was not expected. */
-                ( void ) prvParseDNSReply( pucPayLoadBuffer,
-                                           uxPayloadSize,
-                                           pdFALSE );
+                for( x = 0; ( x < xCount ) && ( ( UBaseType_t ) x < uxMaxCount ); x++ )
+                {
+                    const DNSServer_t * pxServer = &( xDNSServers[ ucOrder[ x ] ] );
+
+                    pxServers[ x ].ulIPAddress = pxServer->ulIPAddress;
+                    pxServers[ x ].ulRTT = pxServer->ulRTT;
+                    pxServers[ x ].ulFailures = pxServer->ucFailures;
+                    pxServers[ x ].ulAnswers = pxServer->ulAnswers;
+                }
             }
-        }
+            ( void ) xTaskResumeAll();
 
-        /* The packet was not consumed. */
-        return pdFAIL;
-    }
-    /*-----------------------------------------------------------*/
+            return ( UBaseType_t ) x;
+        }
+        /*-----------------------------------------------------------*/
 
+    #endif /* ipconfigDNS_MAX_SERVERS > 1 */
 
-    #if ( ipconfigUSE_NBNS == 1 )
+    #if ( ipconfigDNS_USE_CALLBACKS == 0 )
 
 /**
- * @brief Handle an NBNS packet.
+ * @brief Get the IP-address corresponding to the given hostname.
  *
- * @param[in] pxNetworkBuffer: The network buffer holding the NBNS packet.
+ * @param[in] pcHostName: The hostname whose IP address is being queried.
  *
- * @return pdFAIL to show that the packet was not consumed.
+ * @return The IP-address corresponding to the hostname.
  */
-        uint32_t ulNBNSHandlePacket( NetworkBufferDescriptor_t * pxNetworkBuffer )
+        uint32_t FreeRTOS_gethostbyname( const char * pcHostName )
         {
-            UDPPacket_t * pxUDPPacket = ipCAST_PTR_TO_TYPE_PTR( UDPPacket_t, pxNetworkBuffer->pucEthernetBuffer );
-            uint8_t * pucUDPPayloadBuffer = &( pxNetworkBuffer->pucEthernetBuffer[ sizeof( *pxUDPPacket ) ] );
-
-            prvTreatNBNS( pucUDPPayloadBuffer,
-                          pxNetworkBuffer->xDataLength,
-                          pxUDPPacket->xIPHeader.ulSourceIPAddress );
+            return prvPrepareLookup( pcHostName );
+        }
+    #else
 
-            /* The packet was not consumed. */
-            return pdFAIL;
+/**
+ * @brief Get the IP-address corresponding to the given hostname.
+ *
+ * @param[in] pcHostName: The hostname whose IP address is being queried.
+ * @param[in] pCallback: The callback function which will be called upon DNS response.
+ * @param[in] pvSearchID: Search ID for the callback function.
+ * @param[in] uxTimeout: Timeout for the callback function.
+ *
+ * @return The IP-address corresponding to the hostname.
+ */
+        uint32_t FreeRTOS_gethostbyname_a( const char * pcHostName,
+                                           FOnDNSEvent pCallback,
+                                           void * pvSearchID,
+                                           TickType_t uxTimeout )
+        {
+            return prvPrepareLookup( pcHostName, pCallback, pvSearchID, uxTimeout );
         }
+    #endif /* if ( ipconfigDNS_USE_CALLBACKS == 0 ) */
 
-    #endif /* ipconfigUSE_NBNS */
-    /*-----------------------------------------------------------*/
+    #if ( ipconfigDNS_USE_CALLBACKS == 1 )
 
 /**
- * @brief Process a response packet from a DNS server, or an LLMNR reply.
+ * @brief Check if hostname is already known. If not, call prvGetHostByName() to send a DNS request.
  *
- * @param[in] pucUDPPayloadBuffer: The DNS response received as a UDP
- *                                 payload.
- * @param[in] uxBufferLength: Length of the UDP payload buffer.
- * @param[in] xExpected: indicates whether the identifier in the reply
- *                       was expected, and thus if the DNS cache may be
- *                       updated with the reply.
+ * @param[in] pcHostName: The hostname whose IP address is being queried.
+ * @param[in] pCallback: The callback function which will be called upon DNS response.
+ * @param[in] pvSearchID: Search ID for the callback function.
+ * @param[in] uxTimeout: Timeout for the callback function.
  *
- * @return The IP address in the DNS response if present and if xExpected is set to pdTRUE.
- *         An error code (dnsPARSE_ERROR) if there was an error in the DNS response.
- *         0 if xExpected set to pdFALSE.
+ * @return The IP-address corresponding to the hostname.
  */
-    _static uint32_t prvParseDNSReply( uint8_t * pucUDPPayloadBuffer,
-                                       size_t uxBufferLength,
-                                       BaseType_t xExpected )
+        static uint32_t prvPrepareLookup( const char * pcHostName,
+                                          FOnDNSEvent pCallback,
+                                          void * pvSearchID,
+                                          TickType_t uxTimeout )
+    #else
+
+/**
+ * @brief Check if hostname is already known. If not, call prvGetHostByName() to send a DNS request.
+ *
+ * @param[in] pcHostName: The hostname whose IP address is being queried.
+ *
+ * @return The IP-address corresponding to the hostname.
+ */
+        static uint32_t prvPrepareLookup( const char * pcHostName )
+    #endif
     {
-        DNSMessage_t * pxDNSMessageHeader;
-        /* This pointer is not used to modify anything */
-        const DNSAnswerRecord_t * pxDNSAnswerRecord;
         uint32_t ulIPAddress = 0UL;
+        TickType_t uxReadTimeOut_ticks = ipconfigDNS_RECEIVE_BLOCK_TIME_TICKS;
 
-        #if ( ipconfigUSE_LLMNR == 1 )
-            char * pcRequestedName = NULL;
-        #endif
-        uint8_t * pucByte;
-        size_t uxSourceBytesRemaining;
-        uint16_t x, usDataLength, usQuestions;
-        uint16_t usType = 0U;
-        BaseType_t xReturn = pdTRUE;
-        /* memcpy() helper variables for MISRA Rule 21.15 compliance*/
-        const void * pvCopySource;
-        void * pvCopyDest;
-
-        #if ( ipconfigUSE_LLMNR == 1 )
-            uint16_t usClass = 0U;
-        #endif
-        #if ( ipconfigUSE_DNS_CACHE == 1 ) || ( ipconfigDNS_USE_CALLBACKS == 1 )
-            BaseType_t xDoStore = xExpected;
-            char pcName[ ipconfigDNS_CACHE_NAME_LENGTH ] = "";
-        #endif
-        const size_t uxAddressLength = ipSIZE_OF_IPv4_ADDRESS;
+        /* Generate a unique identifier for this query. Keep it in a local variable
+         * as gethostbyname() may be called from different threads */
+        BaseType_t xHasRandom = pdFALSE;
+        TickType_t uxIdentifier = 0U;
+        BaseType_t xLengthOk = pdFALSE;
+        BaseType_t xHandled = pdFALSE;
 
-        /* Ensure that the buffer is of at least minimal DNS message length. */
-        if( uxBufferLength < sizeof( DNSMessage_t ) )
-        {
-            xReturn = pdFALSE;
-        }
-        else
+        if( pcHostName != NULL )
         {
-            uxSourceBytesRemaining = uxBufferLength;
-
-            /* Parse the DNS message header. Map the byte stream onto a structure
-             * for easier access. */
-            pxDNSMessageHeader = ipCAST_PTR_TO_TYPE_PTR( DNSMessage_t, pucUDPPayloadBuffer );
+            size_t uxLength = strlen( pcHostName ) + 1U;
 
-            /* Introduce a do {} while (0) to allow the use of breaks. */
-            do
+            #if ( ipconfigUSE_DNS_CACHE != 0 )
+                if( uxLength <= ipconfigDNS_CACHE_NAME_LENGTH )
+            #else
+                if( uxLength <= dnsMAX_HOSTNAME_LENGTH )
+            #endif
             {
-                size_t uxBytesRead = 0U;
-                size_t uxResult;
-
-                /* Start at the first byte after the header. */
-                pucByte = &( pucUDPPayloadBuffer[ sizeof( DNSMessage_t ) ] );
-                uxSourceBytesRemaining -= sizeof( DNSMessage_t );
+                /* The name is not too long. */
+                xLengthOk = pdTRUE;
+            }
+            else
+            {
+                FreeRTOS_printf( ( "prvPrepareLookup: name is too long ( %lu > %lu )\n",
+                                   ( uint32_t ) uxLength,
+                                   ( uint32_t ) ipconfigDNS_CACHE_NAME_LENGTH ) );
+            }
+        }
 
-                /* Skip any question records. */
-                usQuestions = FreeRTOS_ntohs( pxDNSMessageHeader->usQuestions );
+        if( ( pcHostName != NULL ) && ( xLengthOk != pdFALSE ) )
+        {
+            /* If the supplied hostname is IP address, convert it to uint32_t
+             * and return. */
+            #if ( ipconfigINCLUDE_FULL_INET_ADDR == 1 )
+                {
+                    ulIPAddress = FreeRTOS_inet_addr( pcHostName );
+                }
+            #endif /* ipconfigINCLUDE_FULL_INET_ADDR == 1 */
 
-                for( x = 0U; x < usQuestions; x++ )
+            /* If a DNS cache is used then check the cache before issuing another DNS
+             * request. */
+            #if ( ipconfigUSE_DNS_CACHE == 1 )
                 {
-                    #if ( ipconfigUSE_LLMNR == 1 )
+                    if( ulIPAddress == 0UL )
+                    {
+                        BaseType_t xFound = prvProcessDNSCache( pcHostName, &( ulIPAddress ), 0, pdTRUE );
+
+                        if( ulIPAddress != 0UL )
                         {
-                            if( x == 0U )
-                            {
-                                pcRequestedName = ( char * ) pucByte;
-                            }
+                            FreeRTOS_debug_printf( ( "FreeRTOS_gethostbyname: found '%s' in cache: %lxip\n", pcHostName, ulIPAddress ) );
                         }
-                    #endif
+                        else if( xFound != pdFALSE )
+                        {
+                            /* The name is known not to exist, do not ask again
+                             * before the negative answer expires. */
+                            FreeRTOS_debug_printf( ( "FreeRTOS_gethostbyname: '%s' does not exist\n", pcHostName ) );
+                            xHandled = pdTRUE;
 
-                    #if ( ipconfigUSE_DNS_CACHE == 1 ) || ( ipconfigDNS_USE_CALLBACKS == 1 )
-                        if( x == 0U )
+                            #if ( ipconfigDNS_USE_CALLBACKS == 1 )
+                                {
+                                    if( pCallback != NULL )
+                                    {
+                                        pCallback( pcHostName, pvSearchID, 0UL );
+                                    }
+                                }
+                            #endif
+                        }
+                        else
                         {
-                            uxResult = prvReadNameField( pucByte,
-                                                         uxSourceBytesRemaining,
-                                                         pcName,
-                                                         sizeof( pcName ) );
+                            /* prvGetHostByName will be called to start a DNS lookup. */
+                        }
+                    }
+                }
+            #endif /* ipconfigUSE_DNS_CACHE == 1 */
 
-                            /* Check for a malformed response. */
-                            if( uxResult == 0U )
-                            {
-                                xReturn = pdFALSE;
-                                break;
-                            }
+            /* Generate a unique identifier. */
+            if( ( ulIPAddress == 0UL ) && ( xHandled == pdFALSE ) )
+            {
+                uint32_t ulNumber;
 
-                            uxBytesRead += uxResult;
-                            pucByte = &( pucByte[ uxResult ] );
-                            uxSourceBytesRemaining -= uxResult;
+                xHasRandom = xApplicationGetRandomNumber( &( ulNumber ) );
+                /* DNS identifiers are 16-bit. */
+                uxIdentifier = ( TickType_t ) ( ulNumber & 0xffffU );
+            }
+
+            #if ( ipconfigDNS_USE_RESOLVER == 1 )
+                {
+                    /* Let the resolver send the question from its shared socket,
+                     * unless the same name is being resolved already. */
+                    if( ( ulIPAddress == 0UL ) && ( xHasRandom != pdFALSE ) )
+                    {
+                        if( pCallback != NULL )
+                        {
+                            xHandled = prvDNSResolverLookup( pcHostName, pCallback, pvSearchID, uxTimeout, uxIdentifier, 0 );
                         }
                         else
-                    #endif /* ipconfigUSE_DNS_CACHE || ipconfigDNS_USE_CALLBACKS */
-                    {
-                        /* Skip the variable length pcName field. */
-                        uxResult = prvSkipNameField( pucByte,
-                                                     uxSourceBytesRemaining );
-
-                        /* Check for a malformed response. */
-                        if( uxResult == 0U )
                         {
-                            xReturn = pdFALSE;
-                            break;
+                            ulIPAddress = prvDNSResolverWait( pcHostName, uxIdentifier, &( xHandled ) );
                         }
-
-                        uxBytesRead += uxResult;
-                        pucByte = &( pucByte[ uxResult ] );
-                        uxSourceBytesRemaining -= uxResult;
                     }
+                }
+            #endif /* ipconfigDNS_USE_RESOLVER == 1 */
 
-                    /* Check the remaining buffer size. */
-                    if( uxSourceBytesRemaining >= sizeof( uint32_t ) )
+            #if ( ipconfigDNS_USE_CALLBACKS == 1 )
+                {
+                    if( pCallback != NULL )
                     {
-                        #if ( ipconfigUSE_LLMNR == 1 )
+                        if( ulIPAddress == 0UL )
+                        {
+                            /* The user has provided a callback function, so do not block on recvfrom() */
+                            if( ( xHasRandom != pdFALSE ) && ( xHandled == pdFALSE ) )
                             {
-                                /* usChar2u16 returns value in host endianness. */
-                                usType = usChar2u16( pucByte );
-                                usClass = usChar2u16( &( pucByte[ 2 ] ) );
+                                uxReadTimeOut_ticks = 0U;
+                                vDNSSetCallBack( pcHostName, pvSearchID, pCallback, uxTimeout, uxIdentifier );
                             }
-                        #endif /* ipconfigUSE_LLMNR */
-
-                        /* Skip the type and class fields. */
-                        pucByte = &( pucByte[ sizeof( uint32_t ) ] );
-                        uxSourceBytesRemaining -= sizeof( uint32_t );
-                    }
-                    else
-                    {
-                        xReturn = pdFALSE;
-                        break;
+                        }
+                        else
+                        {
+                            /* The IP address is known, do the call-back now. */
+                            pCallback( pcHostName, pvSearchID, ulIPAddress );
+                        }
                     }
                 }
+            #endif /* if ( ipconfigDNS_USE_CALLBACKS == 1 ) */
 
-                if( xReturn == pdFALSE )
-                {
-                    /* No need to proceed. Break out of the do-while loop. */
-                    break;
-                }
+            if( ( ulIPAddress == 0UL ) && ( xHasRandom != pdFALSE ) && ( xHandled == pdFALSE ) )
+            {
+                ulIPAddress = prvGetHostByName( pcHostName, uxIdentifier, uxReadTimeOut_ticks );
+            }
+        }
 
-                /* Search through the answer records. */
-                pxDNSMessageHeader->usAnswers = FreeRTOS_ntohs( pxDNSMessageHeader->usAnswers );
+        return ulIPAddress;
+    }
+    /*-----------------------------------------------------------*/
 
-                if( ( pxDNSMessageHeader->usFlags & dnsRX_FLAGS_MASK ) == dnsEXPECTED_RX_FLAGS )
+/**
+ * @brief Prepare and send a message to a DNS server.  'uxReadTimeOut_ticks' will be passed as
+ * zero, in case the user has supplied a call-back function.
+ *
+ * @param[in] pcHostName: The hostname for which an IP address is required.
+ * @param[in] uxIdentifier: Identifier to send in the DNS message.
+ * @param[in] uxReadTimeOut_ticks: The timeout in ticks for waiting. In case the user has supplied
+ *                                 a call-back function, this value should be zero.
+ *
+ * @return The IPv4 IP address for the hostname being queried. It will be zero if there is no reply.
+ */
+    static uint32_t prvGetHostByName( const char * pcHostName,
+                                      TickType_t uxIdentifier,
+                                      TickType_t uxReadTimeOut_ticks )
+    {
+        struct freertos_sockaddr xAddress;
+        Socket_t xDNSSocket;
+        uint32_t ulIPAddress = 0UL;
+        uint32_t ulAddressLength = sizeof( struct freertos_sockaddr );
+        BaseType_t xAttempt;
+        int32_t lBytes;
+        TickType_t uxWriteTimeOut_ticks = ipconfigDNS_SEND_BLOCK_TIME_TICKS;
+
+        xDNSSocket = prvCreateDNSSocket();
+
+        if( xDNSSocket != NULL )
+        {
+            /* Ideally we should check for the return value. But since we are passing
+             * correct parameters, and xDNSSocket is != NULL, the return value is
+             * going to be '0' i.e. success. Thus, return value is discarded */
+            ( void ) FreeRTOS_setsockopt( xDNSSocket, 0, FREERTOS_SO_SNDTIMEO, &( uxWriteTimeOut_ticks ), sizeof( TickType_t ) );
+            ( void ) FreeRTOS_setsockopt( xDNSSocket, 0, FREERTOS_SO_RCVTIMEO, &( uxReadTimeOut_ticks ), sizeof( TickType_t ) );
+
+            for( xAttempt = 0; xAttempt < ipconfigDNS_REQUEST_ATTEMPTS; xAttempt++ )
+            {
+                uint8_t * pucReceiveBuffer;
+
+                if( prvSendDNSRequest( xDNSSocket, pcHostName, uxIdentifier, 0 ) != pdFALSE )
                 {
-                    const uint16_t usCount = ( uint16_t ) ipconfigDNS_CACHE_ADDRESSES_PER_ENTRY;
-                    uint16_t usNumARecordsStored = 0;
+                    /* Wait for the reply. */
+                    lBytes = FreeRTOS_recvfrom( xDNSSocket, &pucReceiveBuffer, 0, FREERTOS_ZERO_COPY, &xAddress, &ulAddressLength );
 
-                    for( x = 0U; x < pxDNSMessageHeader->usAnswers; x++ )
+                    if( lBytes > 0 )
                     {
-                        BaseType_t xDoAccept;
+                        BaseType_t xExpected;
+                        const DNSMessage_t * pxDNSMessageHeader = ipCAST_CONST_PTR_TO_CONST_TYPE_PTR( DNSMessage_t, pucReceiveBuffer );
 
-                        if( usNumARecordsStored >= usCount )
+                        #if ( ipconfigDNS_MAX_SERVERS > 1 )
+                            {
+                                prvDNSServerAnswered( xAddress.sin_addr, pxDNSMessageHeader->usIdentifier );
+                            }
+                        #endif
+
+                        /* See if the identifiers match. */
+                        if( uxIdentifier == ( TickType_t ) pxDNSMessageHeader->usIdentifier )
                         {
-                            /* Only count ipconfigDNS_CACHE_ADDRESSES_PER_ENTRY number of records. */
-                            break;
+                            xExpected = pdTRUE;
+                        }
+                        else
+                        {
+                            /* The reply was not expected. */
+                            xExpected = pdFALSE;
                         }
 
-                        uxResult = prvSkipNameField( pucByte,
-                                                     uxSourceBytesRemaining );
+                        /* The reply was received.  Process it. */
+                        #if ( ipconfigDNS_USE_CALLBACKS == 0 )
 
-                        /* Check for a malformed response. */
-                        if( uxResult == 0U )
+                            /* It is useless to analyse the unexpected reply
+                             * unless asynchronous look-ups are enabled. */
+                            if( xExpected != pdFALSE )
+                        #endif /* ipconfigDNS_USE_CALLBACKS == 0 */
                         {
-                            xReturn = pdFALSE;
-                            break;
+                            ulIPAddress = prvParseDNSReply( pucReceiveBuffer, ( size_t ) lBytes, xExpected );
                         }
 
-                        uxBytesRead += uxResult;
-                        pucByte = &( pucByte[ uxResult ] );
-                        uxSourceBytesRemaining -= uxResult;
+                        /* Finished with the buffer.  The zero copy interface
+                         * is being used, so the buffer must be freed by the
+                         * task. */
+                        FreeRTOS_ReleaseUDPPayloadBuffer( pucReceiveBuffer );
 
-                        /* Is there enough data for an IPv4 A record answer and, if so,
-                         * is this an A record? */
-                        if( uxSourceBytesRemaining < sizeof( uint16_t ) )
+                        if( ulIPAddress != 0UL )
                         {
-                            xReturn = pdFALSE;
+                            /* All done. */
+                            /* coverity[break_stmt] : Break statement terminating the loop */
                             break;
                         }
+                    }
+                }
 
-                        usType = usChar2u16( pucByte );
+                if( uxReadTimeOut_ticks == 0U )
+                {
+                    /* This DNS lookup is asynchronous, using a call-back:
+                     * send the request only once. */
+                    break;
+                }
+            }
 
-                        if( usType == ( uint16_t ) dnsTYPE_A_HOST )
-                        {
-                            if( uxSourceBytesRemaining >= ( sizeof( DNSAnswerRecord_t ) + uxAddressLength ) )
-                            {
-                                xDoAccept = pdTRUE;
-                            }
-                            else
-                            {
-                                xDoAccept = pdFALSE;
-                            }
-                        }
-                        else
-                        {
-                            /* Unknown host type. */
-                            xDoAccept = pdFALSE;
-                        }
+            /* Finished with the socket. */
+            ( void ) FreeRTOS_closesocket( xDNSSocket );
+        }
 
-                        if( xDoAccept != pdFALSE )
-                        {
-                            /* This is the required record type and is of sufficient size. */
+        return ulIPAddress;
+    }
+    /*-----------------------------------------------------------*/
 
-                            /* Mapping pucByte to a DNSAnswerRecord allows easy access of the
-                             * fields of the structure. */
-                            pxDNSAnswerRecord = ipCAST_PTR_TO_TYPE_PTR( DNSAnswerRecord_t, pucByte );
+/**
+ * @brief Create a DNS question and send it to the DNS server, or to the LLMNR
+ *        address when the name does not contain a dot.  When more DNS servers
+ *        are known, it is sent to the ipconfigDNS_PARALLEL_QUERIES servers
+ *        chosen by prvDNSServerSelect().
+ *
+ * @param[in] xDNSSocket: The socket from which the question is sent.
+ * @param[in] pcHostName: The hostname for which an IP address is required.
+ * @param[in] uxIdentifier: Identifier to send in the DNS message.
+ * @param[in] xFlags: Flags passed to FreeRTOS_sendto(), besides FREERTOS_ZERO_COPY.
+ *
+ * @return pdTRUE if the question was sent, otherwise pdFALSE.
+ */
+    static BaseType_t prvSendDNSRequest( Socket_t xDNSSocket,
+                                         const char * pcHostName,
+                                         TickType_t uxIdentifier,
+                                         BaseType_t xFlags )
+    {
+        struct freertos_sockaddr xAddress;
+        uint32_t ulTargets[ ipconfigDNS_PARALLEL_QUERIES ];
+        BaseType_t xTarget, xTargetCount = 1;
+        size_t uxHeaderBytes, uxPayloadLength, uxExpectedPayloadLength;
+        NetworkBufferDescriptor_t * pxNetworkBuffer;
+        uint8_t * pucUDPPayloadBuffer;
+        BaseType_t xReturn = pdFALSE;
 
-                            /* Sanity check the data length of an IPv4 answer. */
-                            if( FreeRTOS_ntohs( pxDNSAnswerRecord->usDataLength ) == ( uint16_t ) uxAddressLength )
-                            {
-                                /* Copy the IP address out of the record. Using different pointers
-                                 * to copy only the portion we want is intentional here. */
+        #if ( ipconfigUSE_LLMNR == 1 )
+            BaseType_t bHasDot = pdFALSE;
+        #endif /* ipconfigUSE_LLMNR == 1 */
 
-                                /*
-                                 * Use helper variables for memcpy() to remain
+        /* If LLMNR is being used then determine if the host name includes a '.' -
+         * if not then LLMNR can be used as the lookup method. */
+        #if ( ipconfigUSE_LLMNR == 1 )
+            {
+                const char * pucPtr;
+
+                for( pucPtr = pcHostName; *pucPtr != ( char ) 0; pucPtr++ )
+                {
+                    if( *pucPtr == '.' )
+                    {
+                        bHasDot = pdTRUE;
+                        break;
+                    }
+                }
+            }
+        #endif /* ipconfigUSE_LLMNR == 1 */
+
+        /* Obtain the DNS server address(es). */
+        #if ( ipconfigUSE_LLMNR == 1 )
+            if( bHasDot == pdFALSE )
+            {
+                ulTargets[ 0 ] = ipLLMNR_IP_ADDR; /* Is in network byte order. */
+            }
+            else
+        #endif
+        {
+            #if ( ipconfigDNS_MAX_SERVERS > 1 )
+                {
+                    BaseType_t xSharedSocket = pdFALSE;
+
+                    #if ( ipconfigDNS_USE_RESOLVER == 1 )
+                        {
+                            xSharedSocket = xIsDNSResolverSocket( xDNSSocket );
+                        }
+                    #endif
+
+                    xTargetCount = prvDNSServerSelect( uxIdentifier, xSharedSocket, ulTargets );
+                }
+            #else
+                {
+                    FreeRTOS_GetAddressConfiguration( NULL, NULL, NULL, &( ulTargets[ 0 ] ) );
+                }
+            #endif
+        }
+
+        /* Two is added at the end for the count of characters in the first
+         * subdomain part and the string end byte. */
+        uxExpectedPayloadLength = sizeof( DNSMessage_t ) + strlen( pcHostName ) + sizeof( uint16_t ) + sizeof( uint16_t ) + 2U;
+
+        uxHeaderBytes = ipSIZE_OF_ETH_HEADER + ipSIZE_OF_IPv4_HEADER + ipSIZE_OF_UDP_HEADER;
+
+        /* A zero-copy buffer is passed to the IP-task, so every server gets a
+         * message of its own. */
+        for( xTarget = 0; xTarget < xTargetCount; xTarget++ )
+        {
+            /* Get a buffer.  This uses a maximum delay, but the delay will be
+             * capped to ipconfigUDP_MAX_SEND_BLOCK_TIME_TICKS so the return value
+             * still needs to be tested. */
+            pxNetworkBuffer = pxGetNetworkBufferWithDescriptor( uxHeaderBytes + uxExpectedPayloadLength, 0UL );
+
+            if( pxNetworkBuffer == NULL )
+            {
+                break;
+            }
+
+            pucUDPPayloadBuffer = &( pxNetworkBuffer->pucEthernetBuffer[ uxHeaderBytes ] );
+
+            /* Create the message in the obtained buffer. */
+            uxPayloadLength = prvCreateDNSMessage( pucUDPPayloadBuffer, pcHostName, uxIdentifier );
+
+            iptraceSENDING_DNS_REQUEST();
+
+            /* Send the DNS message. */
+            #if ( ipconfigUSE_LLMNR == 1 )
+                if( bHasDot == pdFALSE )
+                {
+                    /* Use LLMNR addressing. */
+                    ( ipCAST_PTR_TO_TYPE_PTR( DNSMessage_t, pucUDPPayloadBuffer ) )->usFlags = 0;
+                    xAddress.sin_addr = ulTargets[ xTarget ];
+                    xAddress.sin_port = ipLLMNR_PORT;
+                    xAddress.sin_port = FreeRTOS_ntohs( xAddress.sin_port );
+                }
+                else
+            #endif
+            {
+                /* Use DNS server. */
+                xAddress.sin_addr = ulTargets[ xTarget ];
+                xAddress.sin_port = dnsDNS_PORT;
+            }
+
+            if( FreeRTOS_sendto( xDNSSocket, pucUDPPayloadBuffer, uxPayloadLength, FREERTOS_ZERO_COPY | xFlags, &xAddress, sizeof( xAddress ) ) != 0 )
+            {
+                #if ( ipconfigDNS_USE_CALLBACKS == 1 )
+                    {
+                        xDNSResolverStats.ulQueriesSent++;
+                    }
+                #endif
+                xReturn = pdTRUE;
+            }
+            else
+            {
+                /* The message was not sent so the stack will not be
+                 * releasing the zero copy - it must be released here. */
+                vReleaseNetworkBufferAndDescriptor( pxNetworkBuffer );
+            }
+        }
+
+        return xReturn;
+    }
+    /*-----------------------------------------------------------*/
+
+/**
+ * @brief Create the DNS message in the zero copy buffer passed in the first parameter.
+ *
+ * @param[in,out] pucUDPPayloadBuffer: The zero copy buffer where the DNS message will be created.
+ * @param[in] pcHostName: Hostname to be looked up.
+ * @param[in] uxIdentifier: The identifier to be added to the DNS message.
+ *
+ * @return Total size of the generated message, which is the space from the last written byte
+ *         to the beginning of the buffer.
+ */
+    _static size_t prvCreateDNSMessage( uint8_t * pucUDPPayloadBuffer,
+                                        const char * pcHostName,
+                                        TickType_t uxIdentifier )
+    {
+        DNSMessage_t * pxDNSMessageHeader;
+        size_t uxStart, uxIndex;
+        DNSTail_t const * pxTail;
+        static const DNSMessage_t xDefaultPartDNSHeader =
+        {
+            0,                 /* The identifier will be overwritten. */
+            dnsOUTGOING_FLAGS, /* Flags set for standard query. */
+            dnsONE_QUESTION,   /* One question is being asked. */
+            0,                 /* No replies are included. */
+            0,                 /* No authorities. */
+            0                  /* No additional authorities. */
+        };
+
+        /* memcpy() helper variables for MISRA Rule 21.15 compliance*/
+        const void * pvCopySource;
+        void * pvCopyDest;
+
+        /* Copy in the const part of the header. Intentionally using different
+         * pointers with memcpy() to put the information in to correct place. */
+
+        /*
+         * Use helper variables for memcpy() to remain
+         * compliant with MISRA Rule 21.15.  These should be
+         * optimized away.
+         */
+        pvCopySource = &xDefaultPartDNSHeader;
+        pvCopyDest = pucUDPPayloadBuffer;
+        ( void ) memcpy( pvCopyDest, pvCopySource, sizeof( xDefaultPartDNSHeader ) );
+
+        /* Write in a unique identifier. Cast the Payload Buffer to DNSMessage_t
+         * to easily access fields of the DNS Message. */
+        pxDNSMessageHeader = ipCAST_PTR_TO_TYPE_PTR( DNSMessage_t, pucUDPPayloadBuffer );
+        pxDNSMessageHeader->usIdentifier = ( uint16_t ) uxIdentifier;
+
+        /* Create the resource record at the end of the header.  First
+         * find the end of the header. */
+        uxStart = sizeof( xDefaultPartDNSHeader );
+
+        /* Leave a gap for the first length byte. */
+        uxIndex = uxStart + 1U;
+
+        /* Copy in the host name. */
+        ( void ) strcpy( ( char * ) &( pucUDPPayloadBuffer[ uxIndex ] ), pcHostName );
+
+        /* Walk through the string to replace the '.' characters with byte
+         * counts.  pucStart holds the address of the byte count.  Walking the
+         * string starts after the byte count position. */
+        uxIndex = uxStart;
+
+        do
+        {
+            size_t uxLength;
+
+            /* Skip the length byte. */
+            uxIndex++;
+
+            while( ( pucUDPPayloadBuffer[ uxIndex ] != ( uint8_t ) 0U ) &&
+                   ( pucUDPPayloadBuffer[ uxIndex ] != ( uint8_t ) ASCII_BASELINE_DOT ) )
+            {
+                uxIndex++;
+            }
+
+            /* Fill in the byte count, then move the pucStart pointer up to
+             * the found byte position. */
+            uxLength = uxIndex - ( uxStart + 1U );
+            pucUDPPayloadBuffer[ uxStart ] = ( uint8_t ) uxLength;
+
+            uxStart = uxIndex;
+        } while( pucUDPPayloadBuffer[ uxIndex ] != ( uint8_t ) 0U );
+
+        /* Finish off the record. Cast the record onto DNSTail_t structure to easily
+         * access the fields of the DNS Message. */
+        pxTail = ipCAST_PTR_TO_TYPE_PTR( DNSTail_t, &( pucUDPPayloadBuffer[ uxStart + 1U ] ) );
+
+        #if defined( _lint ) || defined( __COVERITY__ )
+            ( void ) pxTail;
+        #else
+            vSetField16( pxTail, DNSTail_t, usType, dnsTYPE_A_HOST );
+            vSetField16( pxTail, DNSTail_t, usClass, dnsCLASS_IN );
+        #endif
+
+        /* Return the total size of the generated message, which is the space from
+         * the last written byte to the beginning of the buffer. */
+        return uxIndex + sizeof( DNSTail_t ) + 1U;
+    }
+    /*-----------------------------------------------------------*/
+
+    #if ( ipconfigUSE_DNS_CACHE == 1 ) || ( ipconfigDNS_USE_CALLBACKS == 1 )
+
+/**
+ * @brief Read the Name field out of a DNS response packet.
+ *
+ * @param[in] pucByte: Pointer to the DNS response.
+ * @param[in] uxRemainingBytes: Length of the DNS response.
+ * @param[out] pcName: The pointer in which the name in the DNS response will be returned.
+ * @param[in] uxDestLen: Size of the pcName array.
+ *
+ * @return If a fully formed name was found, then return the number of bytes processed in pucByte.
+ */
+        _static size_t prvReadNameField( const uint8_t * pucByte,
+                                         size_t uxRemainingBytes,
+                                         char * pcName,
+                                         size_t uxDestLen )
+        {
+            size_t uxNameLen = 0U;
+            size_t uxIndex = 0U;
+            size_t uxSourceLen = uxRemainingBytes;
+
+            /* uxCount gets the values from pucByte and counts down to 0.
+             * No need to have a different type than that of pucByte */
+            size_t uxCount;
+
+            if( uxSourceLen == ( size_t ) 0U )
+            {
+                /* Return 0 value in case of error. */
+                uxIndex = 0U;
+            }
+
+            /* Determine if the name is the fully coded name, or an offset to the name
+             * elsewhere in the message. */
+            else if( ( pucByte[ uxIndex ] & dnsNAME_IS_OFFSET ) == dnsNAME_IS_OFFSET )
+            {
+                /* Jump over the two byte offset. */
+                if( uxSourceLen > sizeof( uint16_t ) )
+                {
+                    uxIndex += sizeof( uint16_t );
+                }
+                else
+                {
+                    uxIndex = 0U;
+                }
+            }
+            else
+            {
+                /* 'uxIndex' points to the full name. Walk over the string. */
+                while( ( uxIndex < uxSourceLen ) && ( pucByte[ uxIndex ] != ( uint8_t ) 0x00U ) )
+                {
+                    /* If this is not the first time through the loop, then add a
+                     * separator in the output. */
+                    if( ( uxNameLen > 0U ) )
+                    {
+                        if( uxNameLen >= uxDestLen )
+                        {
+                            uxIndex = 0U;
+                            /* coverity[break_stmt] : Break statement terminating the loop */
+                            break;
+                        }
+
+                        pcName[ uxNameLen ] = '.';
+                        uxNameLen++;
+                    }
+
+                    /* Process the first/next sub-string. */
+                    uxCount = ( size_t ) pucByte[ uxIndex ];
+                    uxIndex++;
+
+                    if( ( uxIndex + uxCount ) > uxSourceLen )
+                    {
+                        uxIndex = 0U;
+                        break;
+                    }
+
+                    while( uxCount-- != 0U )
+                    {
+                        if( uxNameLen >= uxDestLen )
+                        {
+                            uxIndex = 0U;
+                            break;
+
+                            /* break out of inner loop here
+                             * break out of outer loop at the test uxNameLen >= uxDestLen. */
+                        }
+
+                        pcName[ uxNameLen ] = ( char ) pucByte[ uxIndex ];
+                        uxNameLen++;
+                        uxIndex++;
+                    }
+                }
+
+                /* Confirm that a fully formed name was found. */
+                if( uxIndex > 0U )
+                {
+                    /* Here, there is no need to check for pucByte[ uxindex ] == 0 because:
+                     * When we break out of the above while loop, uxIndex is made 0 thereby
+                     * failing above check. Whenever we exit the loop otherwise, either
+                     * pucByte[ uxIndex ] == 0 (which makes the check here unnecessary) or
+                     * uxIndex >= uxSourceLen (which makes sure that we do not go in the 'if'
+                     * case).
+                     */
+                    if( ( uxNameLen < uxDestLen ) && ( uxIndex < uxSourceLen ) )
+                    {
+                        pcName[ uxNameLen ] = '\0';
+                        uxIndex++;
+                    }
+                    else
+                    {
+                        uxIndex = 0U;
+                    }
+                }
+            }
+
+            return uxIndex;
+        }
+    #endif /* ipconfigUSE_DNS_CACHE || ipconfigDNS_USE_CALLBACKS */
+    /*-----------------------------------------------------------*/
+
+/**
+ * @brief Simple routine that jumps over the NAME field of a resource record.
+ *
+ * @param[in] pucByte: The pointer to the resource record.
+ * @param[in] uxLength: Length of the resource record.
+ *
+ * @return It returns the number of bytes read, or zero when an error has occurred.
+ */
+    _static size_t prvSkipNameField( const uint8_t * pucByte,
+                                     size_t uxLength )
+    {
+        size_t uxChunkLength;
+        size_t uxSourceLenCpy = uxLength;
+        size_t uxIndex = 0U;
+
+        if( uxSourceLenCpy == 0U )
+        {
+            uxIndex = 0U;
+        }
+
+        /* Determine if the name is the fully coded name, or an offset to the name
+         * elsewhere in the message. */
+        else if( ( pucByte[ uxIndex ] & dnsNAME_IS_OFFSET ) == dnsNAME_IS_OFFSET )
+        {
+            /* Jump over the two byte offset. */
+            if( uxSourceLenCpy > sizeof( uint16_t ) )
+            {
+                uxIndex += sizeof( uint16_t );
+            }
+            else
+            {
+                uxIndex = 0U;
+            }
+        }
+        else
+        {
+            /* pucByte points to the full name. Walk over the string. */
+            while( ( pucByte[ uxIndex ] != 0U ) && ( uxSourceLenCpy > 1U ) )
+            {
+                /* Conversion to size_t causes addition to be done
+                 * in size_t */
+                uxChunkLength = ( ( size_t ) pucByte[ uxIndex ] ) + 1U;
+
+                if( uxSourceLenCpy > uxChunkLength )
+                {
+                    uxSourceLenCpy -= uxChunkLength;
+                    uxIndex += uxChunkLength;
+                }
+                else
+                {
+                    uxIndex = 0U;
+                    break;
+                }
+            }
+
+            /* Confirm that a fully formed name was found. */
+            if( uxIndex > 0U )
+            {
+                if( pucByte[ uxIndex ] == 0U )
+                {
+                    uxIndex++;
+                }
+                else
+                {
+                    uxIndex = 0U;
+                }
+            }
+        }
+
+        return uxIndex;
+    }
+    /*-----------------------------------------------------------*/
+
+/* The function below will only be called :
+ * when ipconfigDNS_USE_CALLBACKS == 1
+ * when ipconfigUSE_LLMNR == 1
+ * for testing purposes, by the module test_freertos_tcp.c
+ */
+
+/**
+ * @brief Perform some preliminary checks and then parse the DNS packet.
+ *
+ * @param[in] pxNetworkBuffer: The network buffer to be parsed.
+ *
+ * @return Always pdFAIL to indicate that the packet was not consumed and must
+ *         be released by the caller.
+ */
+    uint32_t ulDNSHandlePacket( const NetworkBufferDescriptor_t * pxNetworkBuffer )
+    {
+        uint8_t * pucPayLoadBuffer;
+        size_t uxPayloadSize;
+
+        /* Only proceed if the payload length indicated in the header
+         * appears to be valid. */
+        if( pxNetworkBuffer->xDataLength >= sizeof( UDPPacket_t ) )
+        {
+            uxPayloadSize = pxNetworkBuffer->xDataLength - sizeof( UDPPacket_t );
+
+            if( uxPayloadSize >= sizeof( DNSMessage_t ) )
+            {
+                pucPayLoadBuffer = &( pxNetworkBuffer->pucEthernetBuffer[ sizeof( UDPPacket_t ) ] );
+
+                #if ( ipconfigDNS_MAX_SERVERS > 1 )
+                    {
+                        const UDPPacket_t * pxUDPPacket = ipCAST_CONST_PTR_TO_CONST_TYPE_PTR( UDPPacket_t, pxNetworkBuffer->pucEthernetBuffer );
+
+                        prvDNSServerAnswered( pxUDPPacket->xIPHeader.ulSourceIPAddress,
+                                              ( ipCAST_CONST_PTR_TO_CONST_TYPE_PTR( DNSMessage_t, pucPayLoadBuffer ) )->usIdentifier );
+                    }
+                #endif
+
+                /* The parameter pdFALSE indicates that the reply was not expected. */
+                ( void ) prvParseDNSReply( pucPayLoadBuffer,
+                                           uxPayloadSize,
+                                           pdFALSE );
+            }
+        }
+
+        /* The packet was not consumed. */
+        return pdFAIL;
+    }
+    /*-----------------------------------------------------------*/
+
+
+    #if ( ipconfigUSE_NBNS == 1 )
+
+/**
+ * @brief Handle an NBNS packet.
+ *
+ * @param[in] pxNetworkBuffer: The network buffer holding the NBNS packet.
+ *
+ * @return pdFAIL to show that the packet was not consumed.
+ */
+        uint32_t ulNBNSHandlePacket( NetworkBufferDescriptor_t * pxNetworkBuffer )
+        {
+            UDPPacket_t * pxUDPPacket = ipCAST_PTR_TO_TYPE_PTR( UDPPacket_t, pxNetworkBuffer->pucEthernetBuffer );
+            uint8_t * pucUDPPayloadBuffer = &( pxNetworkBuffer->pucEthernetBuffer[ sizeof( *pxUDPPacket ) ] );
+
+            prvTreatNBNS( pucUDPPayloadBuffer,
+                          pxNetworkBuffer->xDataLength,
+                          pxUDPPacket->xIPHeader.ulSourceIPAddress );
+
+            /* The packet was not consumed. */
+            return pdFAIL;
+        }
+
+    #endif /* ipconfigUSE_NBNS */
+    /*-----------------------------------------------------------*/
+
+    #if ( dnsUSE_NEGATIVE_CACHE == 1 )
+
+/**
+ * @brief Find the SOA record in the authority section of a negative reply,
+ *        and return the time that the answer may be cached.  That is the
+ *        smaller of the TTL of the record and its MINIMUM field, and never
+ *        more than ipconfigDNS_CACHE_NEGATIVE_TTL_MAX.
+ *
+ * @param[in] pucByte: The first byte of the authority section.
+ * @param[in] uxSourceBytesRemaining: The number of bytes left in the reply.
+ * @param[in] usAuthorityRRs: The number of authority records, in host order.
+ *
+ * @return The TTL in seconds, or zero when there is no valid SOA record.
+ */
+        static uint32_t prvReadNegativeTTL( const uint8_t * pucByte,
+                                            size_t uxSourceBytesRemaining,
+                                            uint16_t usAuthorityRRs )
+        {
+            const uint8_t * pucSource = pucByte;
+            size_t uxRemaining = uxSourceBytesRemaining;
+            size_t uxResult;
+            uint16_t x, usType, usDataLength;
+            uint32_t ulTTL = 0UL;
+            uint32_t ulRecordTTL, ulMinimum;
+
+            for( x = 0U; x < usAuthorityRRs; x++ )
+            {
+                uxResult = prvSkipNameField( pucSource, uxRemaining );
+
+                if( ( uxResult == 0U ) || ( ( uxRemaining - uxResult ) < sizeof( DNSAnswerRecord_t ) ) )
+                {
+                    break;
+                }
+
+                pucSource = &( pucSource[ uxResult ] );
+                uxRemaining -= uxResult;
+
+                /* The type, class, TTL and data length fields. */
+                usType = usChar2u16( pucSource );
+                ulRecordTTL = ulChar2u32( &( pucSource[ 4 ] ) );
+                usDataLength = usChar2u16( &( pucSource[ 8 ] ) );
+                pucSource = &( pucSource[ sizeof( DNSAnswerRecord_t ) ] );
+                uxRemaining -= sizeof( DNSAnswerRecord_t );
+
+                if( usDataLength > uxRemaining )
+                {
+                    break;
+                }
+
+                if( usType == ( uint16_t ) dnsTYPE_SOA )
+                {
+                    /* Skip the MNAME and RNAME fields, five 32-bit fields follow. */
+                    const uint8_t * pucData = pucSource;
+                    size_t uxDataRemaining = usDataLength;
+
+                    uxResult = prvSkipNameField( pucData, uxDataRemaining );
+
+                    if( uxResult != 0U )
+                    {
+                        pucData = &( pucData[ uxResult ] );
+                        uxDataRemaining -= uxResult;
+                        uxResult = prvSkipNameField( pucData, uxDataRemaining );
+                    }
+
+                    if( ( uxResult != 0U ) && ( ( uxDataRemaining - uxResult ) >= ( 5U * sizeof( uint32_t ) ) ) )
+                    {
+                        pucData = &( pucData[ uxResult ] );
+                        ulMinimum = ulChar2u32( &( pucData[ 4U * sizeof( uint32_t ) ] ) );
+                        ulTTL = FreeRTOS_min_uint32( ulRecordTTL, ulMinimum );
+                        ulTTL = FreeRTOS_min_uint32( ulTTL, ( uint32_t ) ipconfigDNS_CACHE_NEGATIVE_TTL_MAX );
+                    }
+
+                    break;
+                }
+
+                pucSource = &( pucSource[ usDataLength ] );
+                uxRemaining -= usDataLength;
+            }
+
+            return ulTTL;
+        }
+        /*-----------------------------------------------------------*/
+
+    #endif /* dnsUSE_NEGATIVE_CACHE == 1 */
+
+    #if ( ipconfigDNS_USE_FAST_PARSER == 1 )
+
+/** @brief The number of names that are remembered to be equal to the name
+ * that the answers are about. */
+        #define dnsPARSER_KNOWN_NAMES    4U
+
+/** @brief The longest CNAME chain that is followed. */
+        #define dnsPARSER_MAX_ALIASES    8U
+
+/**
+ * @brief Follow the compression pointers of a name, until a label or the
+ *        terminating zero is found.  Every pointer must point before the
+ *        lowest position visited so far, so a name can not loop.
+ *
+ * @param[in] pucBuffer: The DNS message.
+ * @param[in] uxLength: The length of the message.
+ * @param[in,out] puxPosition: The position in the name.
+ * @param[in,out] puxLowest: The lowest position visited.
+ *
+ * @return pdTRUE when *puxPosition points to a label that fits in the message,
+ *         or to the terminating zero.
+ */
+        static BaseType_t prvDNSNextLabel( const uint8_t * pucBuffer,
+                                           size_t uxLength,
+                                           size_t * puxPosition,
+                                           size_t * puxLowest )
+        {
+            size_t uxPosition = *puxPosition;
+            size_t uxTarget;
+            BaseType_t xReturn = pdFALSE;
+
+            while( uxPosition < uxLength )
+            {
+                uint8_t ucByte = pucBuffer[ uxPosition ];
+
+                if( ( ucByte & dnsNAME_IS_OFFSET ) == dnsNAME_IS_OFFSET )
+                {
+                    if( ( uxPosition + 1U ) >= uxLength )
+                    {
+                        break;
+                    }
+
+                    uxTarget = ( ( ( size_t ) ucByte & 0x3FU ) << 8 ) | ( size_t ) pucBuffer[ uxPosition + 1U ];
+
+                    if( uxTarget >= *puxLowest )
+                    {
+                        /* A pointer forward, or a loop. */
+                        break;
+                    }
+
+                    *puxLowest = uxTarget;
+                    uxPosition = uxTarget;
+                }
+                else
+                {
+                    /* The label types 0x40 and 0x80 are not used.  The label
+                     * must be followed by at least one more byte. */
+                    if( ( ( ucByte & dnsNAME_IS_OFFSET ) == 0U ) && ( ( uxPosition + ( size_t ) ucByte ) < uxLength ) )
+                    {
+                        *puxPosition = uxPosition;
+                        xReturn = pdTRUE;
+                    }
+
+                    break;
+                }
+            }
+
+            return xReturn;
+        }
+        /*-----------------------------------------------------------*/
+
+/**
+ * @brief Check a name in a DNS message: its labels and pointers must fit in
+ *        the message, and its length may not exceed 255 bytes.  When pcName
+ *        is not NULL, the name is copied to it as a dotted string.
+ *
+ * @param[in] pucBuffer: The DNS message.
+ * @param[in] uxLength: The length of the message.
+ * @param[in] uxOffset: The offset of the name.
+ * @param[out] pcName: Where the name is copied to, or NULL.
+ * @param[in] uxNameSize: The size of pcName.
+ *
+ * @return The offset of the first byte after the name, or zero when the name
+ *         is malformed or does not fit in pcName.
+ */
+        static size_t prvDNSReadName( const uint8_t * pucBuffer,
+                                      size_t uxLength,
+                                      size_t uxOffset,
+                                      char * pcName,
+                                      size_t uxNameSize )
+        {
+            size_t uxPosition = uxOffset;
+            size_t uxLowest = uxOffset;
+            size_t uxEnd = 0U;
+            size_t uxWireLength = 1U;
+            size_t uxNameLength = 0U;
+            size_t uxLabel;
+
+            for( ; ; )
+            {
+                /* The name ends after the first pointer, if there is one. */
+                if( ( uxEnd == 0U ) && ( uxPosition < uxLength ) &&
+                    ( ( pucBuffer[ uxPosition ] & dnsNAME_IS_OFFSET ) == dnsNAME_IS_OFFSET ) )
+                {
+                    uxEnd = uxPosition + sizeof( uint16_t );
+                }
+
+                if( prvDNSNextLabel( pucBuffer, uxLength, &( uxPosition ), &( uxLowest ) ) == pdFALSE )
+                {
+                    uxEnd = 0U;
+                    break;
+                }
+
+                uxLabel = ( size_t ) pucBuffer[ uxPosition ];
+
+                if( uxLabel == 0U )
+                {
+                    if( uxEnd == 0U )
+                    {
+                        uxEnd = uxPosition + 1U;
+                    }
+
+                    if( pcName != NULL )
+                    {
+                        pcName[ uxNameLength ] = ( char ) 0;
+                    }
+
+                    break;
+                }
+
+                uxWireLength += uxLabel + 1U;
+
+                if( uxWireLength > dnsMAX_HOSTNAME_LENGTH )
+                {
+                    uxEnd = 0U;
+                    break;
+                }
+
+                if( pcName != NULL )
+                {
+                    /* Room is needed for a dot or the terminating zero. */
+                    if( ( uxNameLength + uxLabel + 1U ) >= uxNameSize )
+                    {
+                        uxEnd = 0U;
+                        break;
+                    }
+
+                    if( uxNameLength != 0U )
+                    {
+                        pcName[ uxNameLength ] = '.';
+                        uxNameLength++;
+                    }
+
+                    ( void ) memcpy( &( pcName[ uxNameLength ] ), &( pucBuffer[ uxPosition + 1U ] ), uxLabel );
+                    uxNameLength += uxLabel;
+                }
+
+                uxPosition += uxLabel + 1U;
+            }
+
+            return uxEnd;
+        }
+        /*-----------------------------------------------------------*/
+
+/**
+ * @brief Compare two names in a DNS message, label by label and ignoring
+ *        case, following their compression pointers.
+ *
+ * @param[in] pucBuffer: The DNS message.
+ * @param[in] uxLength: The length of the message.
+ * @param[in] uxFirst: The offset of the first name.
+ * @param[in] uxSecond: The offset of the second name.
+ *
+ * @return pdTRUE when the names are equal.
+ */
+        static BaseType_t prvDNSReplyNamesEqual( const uint8_t * pucBuffer,
+                                                 size_t uxLength,
+                                                 size_t uxFirst,
+                                                 size_t uxSecond )
+        {
+            size_t uxPosition1 = uxFirst, uxLowest1 = uxFirst;
+            size_t uxPosition2 = uxSecond, uxLowest2 = uxSecond;
+            size_t uxIndex, uxLabel;
+            uint8_t ucChar1, ucChar2;
+            BaseType_t xReturn = pdFALSE;
+
+            while( ( prvDNSNextLabel( pucBuffer, uxLength, &( uxPosition1 ), &( uxLowest1 ) ) != pdFALSE ) &&
+                   ( prvDNSNextLabel( pucBuffer, uxLength, &( uxPosition2 ), &( uxLowest2 ) ) != pdFALSE ) )
+            {
+                uxLabel = ( size_t ) pucBuffer[ uxPosition1 ];
+
+                if( uxLabel != ( size_t ) pucBuffer[ uxPosition2 ] )
+                {
+                    break;
+                }
+
+                if( ( uxLabel == 0U ) || ( uxPosition1 == uxPosition2 ) )
+                {
+                    /* The end of both names, or the same labels from here on. */
+                    xReturn = pdTRUE;
+                    break;
+                }
+
+                for( uxIndex = 1U; uxIndex <= uxLabel; uxIndex++ )
+                {
+                    ucChar1 = pucBuffer[ uxPosition1 + uxIndex ];
+                    ucChar2 = pucBuffer[ uxPosition2 + uxIndex ];
+
+                    if( ( ucChar1 >= ( uint8_t ) 'A' ) && ( ucChar1 <= ( uint8_t ) 'Z' ) )
+                    {
+                        ucChar1 += ( uint8_t ) ( 'a' - 'A' );
+                    }
+
+                    if( ( ucChar2 >= ( uint8_t ) 'A' ) && ( ucChar2 <= ( uint8_t ) 'Z' ) )
+                    {
+                        ucChar2 += ( uint8_t ) ( 'a' - 'A' );
+                    }
+
+                    if( ucChar1 != ucChar2 )
+                    {
+                        break;
+                    }
+                }
+
+                if( uxIndex <= uxLabel )
+                {
+                    break;
+                }
+
+                uxPosition1 += uxLabel + 1U;
+                uxPosition2 += uxLabel + 1U;
+            }
+
+            return xReturn;
+        }
+        /*-----------------------------------------------------------*/
+
+/**
+ * @brief Parse a DNS reply in a single pass, without changing it and without
+ *        copying names other than the first question.  The answers are
+ *        matched against the name in the first question, or against the
+ *        canonical name of the last CNAME record that matched.  A few
+ *        offsets of names known to be equal to that name are remembered, so
+ *        that an owner name which is a pointer to one of them matches at once.
+ *
+ * @param[in] pucBuffer: The DNS message.
+ * @param[in] uxLength: The length of the message.
+ * @param[out] pxInfo: The questions and the addresses found.
+ *
+ * @return pdPASS when the message is well formed, otherwise pdFAIL.
+ */
+        BaseType_t xDNSParseReply( const uint8_t * pucBuffer,
+                                   size_t uxLength,
+                                   DNSReplyInfo_t * pxInfo )
+        {
+            size_t uxKnown[ dnsPARSER_KNOWN_NAMES ];
+            UBaseType_t uxKnownCount = 0U, uxKnownNext = 1U;
+            size_t uxOffset = sizeof( DNSMessage_t );
+            size_t uxNext, uxTarget;
+            uint32_t ulChainTTL = 0xFFFFFFFFUL, ulTTL;
+            uint16_t x, usQuestions, usAnswers, usType, usClass, usDataLength;
+            BaseType_t xMatch, xReturn = pdPASS;
+
+            pxInfo->pcName[ 0 ] = ( char ) 0;
+            pxInfo->uxAddressCount = 0U;
+            pxInfo->uxAliasCount = 0U;
+            pxInfo->usQuestionType = 0U;
+            pxInfo->usQuestionClass = 0U;
+            pxInfo->uxQuestionsEnd = 0U;
+            pxInfo->uxAuthorityOffset = 0U;
+
+            if( uxLength < sizeof( DNSMessage_t ) )
+            {
+                xReturn = pdFAIL;
+                usQuestions = 0U;
+                usAnswers = 0U;
+            }
+            else
+            {
+                usQuestions = usChar2u16( &( pucBuffer[ offsetof( DNSMessage_t, usQuestions ) ] ) );
+                usAnswers = usChar2u16( &( pucBuffer[ offsetof( DNSMessage_t, usAnswers ) ] ) );
+            }
+
+            for( x = 0U; ( xReturn == pdPASS ) && ( x < usQuestions ); x++ )
+            {
+                if( x == 0U )
+                {
+                    uxNext = prvDNSReadName( pucBuffer, uxLength, uxOffset, pxInfo->pcName, sizeof( pxInfo->pcName ) );
+                }
+                else
+                {
+                    uxNext = prvDNSReadName( pucBuffer, uxLength, uxOffset, NULL, 0U );
+                }
+
+                if( ( uxNext == 0U ) || ( ( uxLength - uxNext ) < sizeof( uint32_t ) ) )
+                {
+                    xReturn = pdFAIL;
+                }
+                else
+                {
+                    pxInfo->usQuestionType = usChar2u16( &( pucBuffer[ uxNext ] ) );
+                    pxInfo->usQuestionClass = usChar2u16( &( pucBuffer[ uxNext + 2U ] ) );
+                    uxOffset = uxNext + sizeof( uint32_t );
+                }
+            }
+
+            if( usQuestions != 0U )
+            {
+                /* uxKnown[ 0 ] is the name that the answers are about. */
+                uxKnown[ 0 ] = sizeof( DNSMessage_t );
+                uxKnownCount = 1U;
+            }
+
+            pxInfo->uxQuestionsEnd = uxOffset;
+
+            for( x = 0U; ( xReturn == pdPASS ) && ( x < usAnswers ); x++ )
+            {
+                UBaseType_t uxIndex;
+
+                xMatch = pdFALSE;
+                uxNext = 0U;
+
+                /* Most owner names are a pointer to the question. */
+                if( ( ( uxOffset + 1U ) < uxLength ) &&
+                    ( ( pucBuffer[ uxOffset ] & dnsNAME_IS_OFFSET ) == dnsNAME_IS_OFFSET ) )
+                {
+                    uxTarget = ( ( ( size_t ) pucBuffer[ uxOffset ] & 0x3FU ) << 8 ) | ( size_t ) pucBuffer[ uxOffset + 1U ];
+
+                    for( uxIndex = 0U; uxIndex < uxKnownCount; uxIndex++ )
+                    {
+                        if( uxKnown[ uxIndex ] == uxTarget )
+                        {
+                            xMatch = pdTRUE;
+                            uxNext = uxOffset + sizeof( uint16_t );
+                            break;
+                        }
+                    }
+                }
+
+                if( xMatch == pdFALSE )
+                {
+                    uxNext = prvDNSReadName( pucBuffer, uxLength, uxOffset, NULL, 0U );
+
+                    if( ( uxNext != 0U ) && ( uxKnownCount != 0U ) &&
+                        ( prvDNSReplyNamesEqual( pucBuffer, uxLength, uxOffset, uxKnown[ 0 ] ) != pdFALSE ) )
+                    {
+                        xMatch = pdTRUE;
+
+                        /* Remember this name for the records that point to it. */
+                        uxKnown[ uxKnownNext ] = uxOffset;
+
+                        if( uxKnownCount <= uxKnownNext )
+                        {
+                            uxKnownCount = uxKnownNext + 1U;
+                        }
+
+                        uxKnownNext = ( uxKnownNext < ( dnsPARSER_KNOWN_NAMES - 1U ) ) ? ( uxKnownNext + 1U ) : 1U;
+                    }
+                }
+
+                if( ( uxNext == 0U ) || ( ( uxLength - uxNext ) < sizeof( DNSAnswerRecord_t ) ) )
+                {
+                    xReturn = pdFAIL;
+                    break;
+                }
+
+                usType = usChar2u16( &( pucBuffer[ uxNext + offsetof( DNSAnswerRecord_t, usType ) ] ) );
+                usClass = usChar2u16( &( pucBuffer[ uxNext + offsetof( DNSAnswerRecord_t, usClass ) ] ) );
+                ulTTL = ulChar2u32( &( pucBuffer[ uxNext + offsetof( DNSAnswerRecord_t, ulTTL ) ] ) );
+                usDataLength = usChar2u16( &( pucBuffer[ uxNext + offsetof( DNSAnswerRecord_t, usDataLength ) ] ) );
+                uxNext += sizeof( DNSAnswerRecord_t );
+
+                if( ( size_t ) usDataLength > ( uxLength - uxNext ) )
+                {
+                    xReturn = pdFAIL;
+                    break;
+                }
+
+                if( ( xMatch != pdFALSE ) && ( usClass == ( uint16_t ) dnsCLASS_IN ) )
+                {
+                    if( ( usType == ( uint16_t ) dnsTYPE_A_HOST ) && ( usDataLength == ( uint16_t ) ipSIZE_OF_IPv4_ADDRESS ) )
+                    {
+                        if( pxInfo->uxAddressCount < ( UBaseType_t ) ipconfigDNS_PARSER_MAX_ADDRESSES )
+                        {
+                            DNSReplyAddress_t * pxAddress = &( pxInfo->xAddresses[ pxInfo->uxAddressCount ] );
+
+                            ( void ) memcpy( &( pxAddress->ulIPAddress ), &( pucBuffer[ uxNext ] ), ipSIZE_OF_IPv4_ADDRESS );
+                            pxAddress->ulTTL = FreeRTOS_min_uint32( ulTTL, ulChainTTL );
+                            pxInfo->uxAddressCount++;
+                        }
+                    }
+                    else if( ( usType == ( uint16_t ) dnsTYPE_CNAME ) && ( pxInfo->uxAliasCount < dnsPARSER_MAX_ALIASES ) )
+                    {
+                        /* The name must end exactly at the end of the record. */
+                        if( prvDNSReadName( pucBuffer, uxNext + usDataLength, uxNext, NULL, 0U ) != ( uxNext + usDataLength ) )
+                        {
+                            xReturn = pdFAIL;
+                            break;
+                        }
+
+                        /* The next answers are about the canonical name. */
+                        uxKnown[ 0 ] = uxNext;
+                        uxKnownCount = 1U;
+                        uxKnownNext = 1U;
+                        ulChainTTL = FreeRTOS_min_uint32( ulTTL, ulChainTTL );
+                        pxInfo->uxAliasCount++;
+                    }
+                    else
+                    {
+                        /* Another type, or too many aliases. */
+                    }
+                }
+
+                uxOffset = uxNext + usDataLength;
+            }
+
+            pxInfo->uxAuthorityOffset = uxOffset;
+
+            return xReturn;
+        }
+        /*-----------------------------------------------------------*/
+
+    #endif /* ipconfigDNS_USE_FAST_PARSER == 1 */
+
+/**
+ * @brief Process a response packet from a DNS server, or an LLMNR reply.
+ *
+ * @param[in] pucUDPPayloadBuffer: The DNS response received as a UDP
+ *                                 payload.
+ * @param[in] uxBufferLength: Length of the UDP payload buffer.
+ * @param[in] xExpected: indicates whether the identifier in the reply
+ *                       was expected, and thus if the DNS cache may be
+ *                       updated with the reply.
+ *
+ * @return The IP address in the DNS response if present and if xExpected is set to pdTRUE.
+ *         An error code (dnsPARSE_ERROR) if there was an error in the DNS response.
+ *         0 if xExpected set to pdFALSE.
+ */
+    _static uint32_t prvParseDNSReply( uint8_t * pucUDPPayloadBuffer,
+                                       size_t uxBufferLength,
+                                       BaseType_t xExpected )
+    {
+        DNSMessage_t * pxDNSMessageHeader;
+        uint32_t ulIPAddress = 0UL;
+
+        #if ( ipconfigUSE_LLMNR == 1 )
+            char * pcRequestedName = NULL;
+        #endif
+        uint8_t * pucByte;
+        size_t uxSourceBytesRemaining;
+        uint16_t usQuestions;
+        uint16_t usType = 0U;
+        BaseType_t xReturn = pdTRUE;
+
+        #if ( ipconfigDNS_USE_FAST_PARSER == 1 )
+            DNSReplyInfo_t xReplyInfo;
+        #else
+            /* This pointer is not used to modify anything */
+            const DNSAnswerRecord_t * pxDNSAnswerRecord;
+            uint16_t x, usDataLength;
+            /* memcpy() helper variables for MISRA Rule 21.15 compliance*/
+            const void * pvCopySource;
+            void * pvCopyDest;
+            const size_t uxAddressLength = ipSIZE_OF_IPv4_ADDRESS;
+        #endif
+
+        #if ( ipconfigUSE_LLMNR == 1 )
+            uint16_t usClass = 0U;
+        #endif
+        #if ( ipconfigUSE_DNS_CACHE == 1 ) || ( ipconfigDNS_USE_CALLBACKS == 1 )
+            BaseType_t xDoStore = xExpected;
+            #if ( ipconfigDNS_USE_FAST_PARSER == 1 )
+                const char * pcName = xReplyInfo.pcName;
+            #else
+                char pcName[ ipconfigDNS_CACHE_NAME_LENGTH ] = "";
+            #endif
+        #endif
+
+        /* Ensure that the buffer is of at least minimal DNS message length. */
+        if( uxBufferLength < sizeof( DNSMessage_t ) )
+        {
+            xReturn = pdFALSE;
+        }
+        else
+        {
+            uxSourceBytesRemaining = uxBufferLength;
+
+            /* Parse the DNS message header. Map the byte stream onto a structure
+             * for easier access. */
+            pxDNSMessageHeader = ipCAST_PTR_TO_TYPE_PTR( DNSMessage_t, pucUDPPayloadBuffer );
+
+            /* Introduce a do {} while (0) to allow the use of breaks. */
+            do
+            {
+                size_t uxBytesRead = 0U;
+
+                #if ( ipconfigDNS_USE_FAST_PARSER == 0 )
+                    size_t uxResult;
+                #endif
+
+                /* Start at the first byte after the header. */
+                pucByte = &( pucUDPPayloadBuffer[ sizeof( DNSMessage_t ) ] );
+                uxSourceBytesRemaining -= sizeof( DNSMessage_t );
+                usQuestions = FreeRTOS_ntohs( pxDNSMessageHeader->usQuestions );
+
+                #if ( ipconfigDNS_USE_FAST_PARSER == 1 )
+                    /* Check the whole message, and collect the addresses of the
+                     * name in the first question. */
+                    if( xDNSParseReply( pucUDPPayloadBuffer, uxBufferLength, &( xReplyInfo ) ) == pdFAIL )
+                    {
+                        xReturn = pdFALSE;
+                        break;
+                    }
+
+                    #if ( ipconfigUSE_LLMNR == 1 )
+                        {
+                            pcRequestedName = ( char * ) pucByte;
+                            usType = xReplyInfo.usQuestionType;
+                            usClass = xReplyInfo.usQuestionClass;
+                        }
+                    #endif /* ipconfigUSE_LLMNR */
+
+                    /* An LLMNR answer is placed after the questions. */
+                    pucByte = &( pucUDPPayloadBuffer[ xReplyInfo.uxQuestionsEnd ] );
+                    uxSourceBytesRemaining = uxBufferLength - xReplyInfo.uxQuestionsEnd;
+
+                    if( ( pxDNSMessageHeader->usFlags & dnsRX_FLAGS_MASK ) == dnsEXPECTED_RX_FLAGS )
+                    {
+                        pucByte = &( pucUDPPayloadBuffer[ xReplyInfo.uxAuthorityOffset ] );
+                        uxSourceBytesRemaining = uxBufferLength - xReplyInfo.uxAuthorityOffset;
+
+                        if( xReplyInfo.uxAddressCount != 0U )
+                        {
+                            ulIPAddress = xReplyInfo.xAddresses[ 0 ].ulIPAddress;
+
+                            #if ( ipconfigDNS_USE_CALLBACKS == 1 )
+                                {
+                                    /* See if any asynchronous call was made to FreeRTOS_gethostbyname_a() */
+                                    if( xDNSDoCallback( ( TickType_t ) pxDNSMessageHeader->usIdentifier, pcName, ulIPAddress ) != pdFALSE )
+                                    {
+                                        /* This device has requested this DNS look-up.
+                                         * The result may be stored in the DNS cache. */
+                                        xDoStore = pdTRUE;
+                                    }
+                                }
+                            #endif /* ipconfigDNS_USE_CALLBACKS == 1 */
+                            #if ( ipconfigUSE_DNS_CACHE == 1 )
+                                {
+                                    UBaseType_t uxIndex;
+                                    char cBuffer[ 16 ];
+
+                                    /* The reply will only be stored in the DNS cache when the
+                                     * request was issued by this device. */
+                                    for( uxIndex = 0U; ( xDoStore != pdFALSE ) && ( uxIndex < xReplyInfo.uxAddressCount ) && ( uxIndex < ( UBaseType_t ) ipconfigDNS_CACHE_ADDRESSES_PER_ENTRY ); uxIndex++ )
+                                    {
+                                        ( void ) prvProcessDNSCache( pcName,
+                                                                     &( xReplyInfo.xAddresses[ uxIndex ].ulIPAddress ),
+                                                                     FreeRTOS_htonl( xReplyInfo.xAddresses[ uxIndex ].ulTTL ),
+                                                                     pdFALSE );
+                                    }
+
+                                    ( void ) FreeRTOS_inet_ntop( FREERTOS_AF_INET, ( const void * ) &( ulIPAddress ), cBuffer, sizeof( cBuffer ) );
+                                    /* Show what has happened. */
+                                    FreeRTOS_printf( ( "DNS[0x%04lX]: The %lu answer(s) to '%s' (%s) will%s be stored\n",
+                                                       ( UBaseType_t ) pxDNSMessageHeader->usIdentifier,
+                                                       ( UBaseType_t ) xReplyInfo.uxAddressCount,
+                                                       pcName,
+                                                       cBuffer,
+                                                       ( xDoStore != 0 ) ? "" : " NOT" ) );
+                                }
+                            #endif /* ipconfigUSE_DNS_CACHE */
+                        }
+                    }
+                #else /* ipconfigDNS_USE_FAST_PARSER */
+
+                /* Skip any question records. */
+                for( x = 0U; x < usQuestions; x++ )
+                {
+                    #if ( ipconfigUSE_LLMNR == 1 )
+                        {
+                            if( x == 0U )
+                            {
+                                pcRequestedName = ( char * ) pucByte;
+                            }
+                        }
+                    #endif
+
+                    #if ( ipconfigUSE_DNS_CACHE == 1 ) || ( ipconfigDNS_USE_CALLBACKS == 1 )
+                        if( x == 0U )
+                        {
+                            uxResult = prvReadNameField( pucByte,
+                                                         uxSourceBytesRemaining,
+                                                         pcName,
+                                                         sizeof( pcName ) );
+
+                            /* Check for a malformed response. */
+                            if( uxResult == 0U )
+                            {
+                                xReturn = pdFALSE;
+                                break;
+                            }
+
+                            uxBytesRead += uxResult;
+                            pucByte = &( pucByte[ uxResult ] );
+                            uxSourceBytesRemaining -= uxResult;
+                        }
+                        else
+                    #endif /* ipconfigUSE_DNS_CACHE || ipconfigDNS_USE_CALLBACKS */
+                    {
+                        /* Skip the variable length pcName field. */
+                        uxResult = prvSkipNameField( pucByte,
+                                                     uxSourceBytesRemaining );
+
+                        /* Check for a malformed response. */
+                        if( uxResult == 0U )
+                        {
+                            xReturn = pdFALSE;
+                            break;
+                        }
+
+                        uxBytesRead += uxResult;
+                        pucByte = &( pucByte[ uxResult ] );
+                        uxSourceBytesRemaining -= uxResult;
+                    }
+
+                    /* Check the remaining buffer size. */
+                    if( uxSourceBytesRemaining >= sizeof( uint32_t ) )
+                    {
+                        #if ( ipconfigUSE_LLMNR == 1 )
+                            {
+                                /* usChar2u16 returns value in host endianness. */
+                                usType = usChar2u16( pucByte );
+                                usClass = usChar2u16( &( pucByte[ 2 ] ) );
+                            }
+                        #endif /* ipconfigUSE_LLMNR */
+
+                        /* Skip the type and class fields. */
+                        pucByte = &( pucByte[ sizeof( uint32_t ) ] );
+                        uxSourceBytesRemaining -= sizeof( uint32_t );
+                    }
+                    else
+                    {
+                        xReturn = pdFALSE;
+                        break;
+                    }
+                }
+
+                if( xReturn == pdFALSE )
+                {
+                    /* No need to proceed. Break out of the do-while loop. */
+                    break;
+                }
+
+                /* Search through the answer records. */
+                pxDNSMessageHeader->usAnswers = FreeRTOS_ntohs( pxDNSMessageHeader->usAnswers );
+
+                if( ( pxDNSMessageHeader->usFlags & dnsRX_FLAGS_MASK ) == dnsEXPECTED_RX_FLAGS )
+                {
+                    const uint16_t usCount = ( uint16_t ) ipconfigDNS_CACHE_ADDRESSES_PER_ENTRY;
+                    uint16_t usNumARecordsStored = 0;
+
+                    for( x = 0U; x < pxDNSMessageHeader->usAnswers; x++ )
+                    {
+                        BaseType_t xDoAccept;
+
+                        if( usNumARecordsStored >= usCount )
+                        {
+                            /* Only count ipconfigDNS_CACHE_ADDRESSES_PER_ENTRY number of records. */
+                            break;
+                        }
+
+                        uxResult = prvSkipNameField( pucByte,
+                                                     uxSourceBytesRemaining );
+
+                        /* Check for a malformed response. */
+                        if( uxResult == 0U )
+                        {
+                            xReturn = pdFALSE;
+                            break;
+                        }
+
+                        uxBytesRead += uxResult;
+                        pucByte = &( pucByte[ uxResult ] );
+                        uxSourceBytesRemaining -= uxResult;
+
+                        /* Is there enough data for an IPv4 A record answer and, if so,
+                         * is this an A record? */
+                        if( uxSourceBytesRemaining < sizeof( uint16_t ) )
+                        {
+                            xReturn = pdFALSE;
+                            break;
+                        }
+
+                        usType = usChar2u16( pucByte );
+
+                        if( usType == ( uint16_t ) dnsTYPE_A_HOST )
+                        {
+                            if( uxSourceBytesRemaining >= ( sizeof( DNSAnswerRecord_t ) + uxAddressLength ) )
+                            {
+                                xDoAccept = pdTRUE;
+                            }
+                            else
+                            {
+                                xDoAccept = pdFALSE;
+                            }
+                        }
+                        else
+                        {
+                            /* Unknown host type. */
+                            xDoAccept = pdFALSE;
+                        }
+
+                        if( xDoAccept != pdFALSE )
+                        {
+                            /* This is the required record type and is of sufficient size. */
+
+                            /* Mapping pucByte to a DNSAnswerRecord allows easy access of the
+                             * fields of the structure. */
+                            pxDNSAnswerRecord = ipCAST_PTR_TO_TYPE_PTR( DNSAnswerRecord_t, pucByte );
+
+                            /* Sanity check the data length of an IPv4 answer. */
+                            if( FreeRTOS_ntohs( pxDNSAnswerRecord->usDataLength ) == ( uint16_t ) uxAddressLength )
+                            {
+                                /* Copy the IP address out of the record. Using different pointers
+                                 * to copy only the portion we want is intentional here. */
+
+                                /*
+                                 * Use helper variables for memcpy() to remain
                                  * compliant with MISRA Rule 21.15.  These should be
                                  * optimized away.
                                  */
@@ -1380,606 +3472,1170 @@
                                 pvCopyDest = &ulIPAddress;
                                 ( void ) memcpy( pvCopyDest, pvCopySource, uxAddressLength );
 
-                                #if ( ipconfigDNS_USE_CALLBACKS == 1 )
+                                #if ( ipconfigDNS_USE_CALLBACKS == 1 )
+                                    {
+                                        /* See if any asynchronous call was made to FreeRTOS_gethostbyname_a() */
+                                        if( xDNSDoCallback( ( TickType_t ) pxDNSMessageHeader->usIdentifier, pcName, ulIPAddress ) != pdFALSE )
+                                        {
+                                            /* This device has requested this DNS look-up.
+                                             * The result may be stored in the DNS cache. */
+                                            xDoStore = pdTRUE;
+                                        }
+                                    }
+                                #endif /* ipconfigDNS_USE_CALLBACKS == 1 */
+                                #if ( ipconfigUSE_DNS_CACHE == 1 )
+                                    {
+                                        char cBuffer[ 16 ];
+
+                                        /* The reply will only be stored in the DNS cache when the
+                                         * request was issued by this device. */
+                                        if( xDoStore != pdFALSE )
+                                        {
+                                            ( void ) prvProcessDNSCache( pcName, &ulIPAddress, pxDNSAnswerRecord->ulTTL, pdFALSE );
+                                            usNumARecordsStored++; /* Track # of A records stored */
+                                        }
+
+                                        ( void ) FreeRTOS_inet_ntop( FREERTOS_AF_INET, ( const void * ) &( ulIPAddress ), cBuffer, sizeof( cBuffer ) );
+                                        /* Show what has happened. */
+                                        FreeRTOS_printf( ( "DNS[0x%04lX]: The answer to '%s' (%s) will%s be stored\n",
+                                                           ( UBaseType_t ) pxDNSMessageHeader->usIdentifier,
+                                                           pcName,
+                                                           cBuffer,
+                                                           ( xDoStore != 0 ) ? "" : " NOT" ) );
+                                    }
+                                #endif /* ipconfigUSE_DNS_CACHE */
+                            }
+
+                            pucByte = &( pucByte[ sizeof( DNSAnswerRecord_t ) + uxAddressLength ] );
+                            uxSourceBytesRemaining -= ( sizeof( DNSAnswerRecord_t ) + uxAddressLength );
+                        }
+                        else if( uxSourceBytesRemaining >= sizeof( DNSAnswerRecord_t ) )
+                        {
+                            /* It's not an A record, so skip it. Get the header location
+                             * and then jump over the header. */
+                            /* Cast the response to DNSAnswerRecord for easy access to fields of the DNS response. */
+                            pxDNSAnswerRecord = ipCAST_PTR_TO_TYPE_PTR( DNSAnswerRecord_t, pucByte );
+
+                            pucByte = &( pucByte[ sizeof( DNSAnswerRecord_t ) ] );
+                            uxSourceBytesRemaining -= sizeof( DNSAnswerRecord_t );
+
+                            /* Determine the length of the answer data from the header. */
+                            usDataLength = FreeRTOS_ntohs( pxDNSAnswerRecord->usDataLength );
+
+                            /* Jump over the answer. */
+                            if( uxSourceBytesRemaining >= usDataLength )
+                            {
+                                pucByte = &( pucByte[ usDataLength ] );
+                                uxSourceBytesRemaining -= usDataLength;
+                            }
+                            else
+                            {
+                                /* Malformed response. */
+                                xReturn = pdFALSE;
+                                break;
+                            }
+                        }
+                        else
+                        {
+                            /* Do nothing */
+                        }
+                    }
+                }
+
+                #endif /* ipconfigDNS_USE_FAST_PARSER */
+
+                #if ( ipconfigUSE_LLMNR == 1 )
+
+                    /* No need to check that pcRequestedName != NULL since is usQuestions != 0, then
+                     * pcRequestedName is assigned with this statement
+                     * "pcRequestedName = ( char * ) pucByte;" */
+                    else if( ( usQuestions != ( uint16_t ) 0U ) && ( usType == dnsTYPE_A_HOST ) && ( usClass == dnsCLASS_IN ) )
+                    {
+                        /* If this is not a reply to our DNS request, it might an LLMNR
+                         * request. */
+                        if( xApplicationDNSQueryHook( &( pcRequestedName[ 1 ] ) ) != pdFALSE )
+                        {
+                            int16_t usLength;
+                            NetworkBufferDescriptor_t * pxNewBuffer = NULL;
+                            NetworkBufferDescriptor_t * pxNetworkBuffer = pxUDPPayloadBuffer_to_NetworkBuffer( pucUDPPayloadBuffer );
+                            LLMNRAnswer_t * pxAnswer;
+                            uint8_t * pucNewBuffer = NULL;
+
+                            if( pxNetworkBuffer != NULL )
+                            {
+                                if( xBufferAllocFixedSize == pdFALSE )
+                                {
+                                    size_t uxDataLength = uxBufferLength + sizeof( UDPHeader_t ) + sizeof( EthernetHeader_t ) + sizeof( IPHeader_t );
+
+                                    /* Set the size of the outgoing packet. */
+                                    pxNetworkBuffer->xDataLength = uxDataLength;
+                                    pxNewBuffer = pxDuplicateNetworkBufferWithDescriptor( pxNetworkBuffer, uxDataLength + sizeof( LLMNRAnswer_t ) );
+
+                                    if( pxNewBuffer != NULL )
                                     {
-                                        /* See if any asynchronous call was made to FreeRTOS_gethostbyname_a() */
-                                        if( xDNSDoCallback( ( TickType_t ) pxDNSMessageHeader->usIdentifier, pcName, ulIPAddress ) != pdFALSE )
-                                        {
-                                            /* This device has requested this DNS look-up.
-                                             * The result may be stored in the DNS cache. */
-                                            xDoStore = pdTRUE;
-                                        }
+                                        BaseType_t xOffset1, xOffset2;
+
+                                        xOffset1 = ( BaseType_t ) ( pucByte - pucUDPPayloadBuffer );
+                                        xOffset2 = ( BaseType_t ) ( ( ( uint8_t * ) pcRequestedName ) - pucUDPPayloadBuffer );
+
+                                        pxNetworkBuffer = pxNewBuffer;
+                                        pucNewBuffer = &( pxNetworkBuffer->pucEthernetBuffer[ ipUDP_PAYLOAD_OFFSET_IPv4 ] );
+
+                                        pucByte = &( pucNewBuffer[ xOffset1 ] );
+                                        pcRequestedName = ( char * ) &( pucNewBuffer[ xOffset2 ] );
+                                        pxDNSMessageHeader = ipCAST_PTR_TO_TYPE_PTR( DNSMessage_t, pucNewBuffer );
                                     }
-                                #endif /* ipconfigDNS_USE_CALLBACKS == 1 */
-                                #if ( ipconfigUSE_DNS_CACHE == 1 )
+                                    else
                                     {
-                                        char cBuffer[ 16 ];
+                                        /* Just to indicate that the message may not be answered. */
+                                        pxNetworkBuffer = NULL;
+                                    }
+                                }
+                                else
+                                {
+                                    pucNewBuffer = &( pxNetworkBuffer->pucEthernetBuffer[ ipUDP_PAYLOAD_OFFSET_IPv4 ] );
+                                }
+                            }
 
-                                        /* The reply will only be stored in the DNS cache when the
-                                         * request was issued by this device. */
-                                        if( xDoStore != pdFALSE )
-                                        {
-                                            ( void ) prvProcessDNSCache( pcName, &ulIPAddress, pxDNSAnswerRecord->ulTTL, pdFALSE );
-                                            usNumARecordsStored++; /* Track # of A records stored */
-                                        }
+                            /* The test on 'pucNewBuffer' is only to satisfy lint. */
+                            if( ( pxNetworkBuffer != NULL ) && ( pucNewBuffer != NULL ) )
+                            {
+                                pxAnswer = ipCAST_PTR_TO_TYPE_PTR( LLMNRAnswer_t, pucByte );
 
-                                        ( void ) FreeRTOS_inet_ntop( FREERTOS_AF_INET, ( const void * ) &( ulIPAddress ), cBuffer, sizeof( cBuffer ) );
-                                        /* Show what has happened. */
-                                        FreeRTOS_printf( ( "DNS[0x%04lX]: The answer to '%s' (%s) will%s be stored\n",
-                                                           ( UBaseType_t ) pxDNSMessageHeader->usIdentifier,
-                                                           pcName,
-                                                           cBuffer,
-                                                           ( xDoStore != 0 ) ? "" : " NOT" ) );
+                                /* We leave 'usIdentifier' and 'usQuestions' untouched */
+                                #ifndef _lint
+                                    vSetField16( pxDNSMessageHeader, DNSMessage_t, usFlags, dnsLLMNR_FLAGS_IS_REPONSE ); /* Set the response flag */
+                                    vSetField16( pxDNSMessageHeader, DNSMessage_t, usAnswers, 1 );                       /* Provide a single answer */
+                                    vSetField16( pxDNSMessageHeader, DNSMessage_t, usAuthorityRRs, 0 );                  /* No authority */
+                                    vSetField16( pxDNSMessageHeader, DNSMessage_t, usAdditionalRRs, 0 );                 /* No additional info */
+                                #endif /* lint */
+
+                                pxAnswer->ucNameCode = dnsNAME_IS_OFFSET;
+                                pxAnswer->ucNameOffset = ( uint8_t ) ( pcRequestedName - ( char * ) pucNewBuffer );
+
+                                #ifndef _lint
+                                    vSetField16( pxAnswer, LLMNRAnswer_t, usType, dnsTYPE_A_HOST ); /* Type A: host */
+                                    vSetField16( pxAnswer, LLMNRAnswer_t, usClass, dnsCLASS_IN );   /* 1: Class IN */
+                                    vSetField32( pxAnswer, LLMNRAnswer_t, ulTTL, dnsLLMNR_TTL_VALUE );
+                                    vSetField16( pxAnswer, LLMNRAnswer_t, usDataLength, 4 );
+                                    vSetField32( pxAnswer, LLMNRAnswer_t, ulIPAddress, FreeRTOS_ntohl( *ipLOCAL_IP_ADDRESS_POINTER ) );
+                                #endif /* lint */
+                                usLength = ( int16_t ) ( sizeof( *pxAnswer ) + ( size_t ) ( pucByte - pucNewBuffer ) );
+
+                                prvReplyDNSMessage( pxNetworkBuffer, usLength );
+
+                                if( pxNewBuffer != NULL )
+                                {
+                                    vReleaseNetworkBufferAndDescriptor( pxNewBuffer );
+                                }
+                            }
+                        }
+                    }
+                    else
+                    {
+                        /* Not an expected reply. */
+                    }
+                #endif /* ipconfigUSE_LLMNR == 1 */
+
+                #if ( dnsUSE_NEGATIVE_CACHE == 1 )
+                    {
+                        /* A reply without answers says that the name does not exist,
+                         * or that it has no IPv4 address.  As described in RFC 2308,
+                         * it may be cached when the authority section has an SOA record. */
+                        if( ( xReturn != pdFALSE ) &&
+                            ( usQuestions != 0U ) &&
+                            ( pcName[ 0 ] != ( char ) 0 ) &&
+                            ( pxDNSMessageHeader->usAnswers == 0U ) &&
+                            ( ( ( pxDNSMessageHeader->usFlags & dnsRX_FLAGS_MASK ) == dnsNXDOMAIN_RX_FLAGS ) ||
+                              ( ( pxDNSMessageHeader->usFlags & dnsRX_FLAGS_MASK ) == dnsEXPECTED_RX_FLAGS ) ) )
+                        {
+                            uint32_t ulTTL = prvReadNegativeTTL( pucByte, uxSourceBytesRemaining, FreeRTOS_ntohs( pxDNSMessageHeader->usAuthorityRRs ) );
+                            uint32_t ulNoAddress = 0UL;
+
+                            #if ( ipconfigDNS_USE_CALLBACKS == 1 )
+                                {
+                                    /* Let the waiting call-backs know at once. */
+                                    if( xDNSDoCallback( ( TickType_t ) pxDNSMessageHeader->usIdentifier, pcName, 0UL ) != pdFALSE )
+                                    {
+                                        xDoStore = pdTRUE;
                                     }
-                                #endif /* ipconfigUSE_DNS_CACHE */
+                                }
+                            #endif /* ipconfigDNS_USE_CALLBACKS == 1 */
+
+                            if( ( ulTTL != 0UL ) && ( xDoStore != pdFALSE ) )
+                            {
+                                FreeRTOS_printf( ( "DNS[0x%04lX]: '%s' has no address, stored for %lu seconds\n",
+                                                   ( UBaseType_t ) pxDNSMessageHeader->usIdentifier,
+                                                   pcName,
+                                                   ulTTL ) );
+                                ( void ) prvProcessDNSCache( pcName, &( ulNoAddress ), FreeRTOS_htonl( ulTTL ), pdFALSE );
                             }
+                        }
+                    }
+                #endif /* dnsUSE_NEGATIVE_CACHE == 1 */
+                #if ( ipconfigDNS_USE_FAST_PARSER == 1 )
+                    /* These are only used by LLMNR and the negative cache. */
+                    ( void ) usType;
+                    ( void ) usQuestions;
+                    ( void ) pucByte;
+                    ( void ) uxSourceBytesRemaining;
+                #endif
+                ( void ) uxBytesRead;
+            } while( ipFALSE_BOOL );
+        }
 
-                            pucByte = &( pucByte[ sizeof( DNSAnswerRecord_t ) + uxAddressLength ] );
-                            uxSourceBytesRemaining -= ( sizeof( DNSAnswerRecord_t ) + uxAddressLength );
+        if( xReturn == pdFALSE )
+        {
+            /* There was an error while parsing the DNS response. Return error code. */
+            ulIPAddress = dnsPARSE_ERROR;
+        }
+        else if( xExpected == pdFALSE )
+        {
+            /* Do not return a valid IP-address in case the reply was not expected. */
+            ulIPAddress = 0UL;
+        }
+        else
+        {
+            /* The IP-address found will be returned. */
+        }
+
+        #if ( ipconfigUSE_DNS_CACHE == 1 ) || ( ipconfigDNS_USE_CALLBACKS == 1 )
+            ( void ) xDoStore;
+        #endif
+
+        return ulIPAddress;
+    }
+    /*-----------------------------------------------------------*/
+
+    #if ( ipconfigUSE_NBNS == 1 )
+
+/**
+ * @brief Respond to an NBNS query or an NBNS reply.
+ *
+ * @param[in] pucPayload: the UDP payload of the NBNS message.
+ * @param[in] uxBufferLength: Length of the Buffer.
+ * @param[in] ulIPAddress: IP address of the sender.
+ */
+        static void prvTreatNBNS( uint8_t * pucPayload,
+                                  size_t uxBufferLength,
+                                  uint32_t ulIPAddress )
+        {
+            uint16_t usFlags, usType, usClass;
+            uint8_t * pucSource, * pucTarget;
+            uint8_t ucByte;
+            uint8_t ucNBNSName[ 17 ];
+            uint8_t * pucUDPPayloadBuffer = pucPayload;
+            NetworkBufferDescriptor_t * pxNetworkBuffer;
+            size_t uxBytesNeeded = sizeof( UDPPacket_t ) + sizeof( NBNSRequest_t );
+
+            /* Check for minimum buffer size. */
+            if( uxBufferLength < uxBytesNeeded )
+            {
+                return;
+            }
+
+            /* Read the request flags in host endianness. */
+            usFlags = usChar2u16( &( pucUDPPayloadBuffer[ offsetof( NBNSRequest_t, usFlags ) ] ) );
+
+            if( ( usFlags & dnsNBNS_FLAGS_OPCODE_MASK ) == dnsNBNS_FLAGS_OPCODE_QUERY )
+            {
+                usType = usChar2u16( &( pucUDPPayloadBuffer[ offsetof( NBNSRequest_t, usType ) ] ) );
+                usClass = usChar2u16( &( pucUDPPayloadBuffer[ offsetof( NBNSRequest_t, usClass ) ] ) );
+
+                /* Not used for now */
+                ( void ) usClass;
+
+                /* For NBNS a name is 16 bytes long, written with capitals only.
+                 * Make sure that the copy is terminated with a zero. */
+                pucTarget = &( ucNBNSName[ sizeof( ucNBNSName ) - 2U ] );
+                pucTarget[ 1 ] = ( uint8_t ) 0U;
+
+                /* Start with decoding the last 2 bytes. */
+                pucSource = &( pucUDPPayloadBuffer[ ( dnsNBNS_ENCODED_NAME_LENGTH - 2 ) + offsetof( NBNSRequest_t, ucName ) ] );
+
+                for( ; ; )
+                {
+                    const uint8_t ucCharA = ( uint8_t ) 0x41U;
+
+                    ucByte = ( ( uint8_t ) ( ( pucSource[ 0 ] - ucCharA ) << 4 ) ) | ( pucSource[ 1 ] - ucCharA );
+
+                    /* Make sure there are no trailing spaces in the name. */
+                    if( ( ucByte == ( uint8_t ) ' ' ) && ( pucTarget[ 1 ] == 0U ) )
+                    {
+                        ucByte = 0U;
+                    }
+
+                    *pucTarget = ucByte;
+
+                    if( pucTarget == ucNBNSName )
+                    {
+                        break;
+                    }
+
+                    pucTarget -= 1;
+                    pucSource -= 2;
+                }
+
+                #if ( ipconfigUSE_DNS_CACHE == 1 )
+                    {
+                        if( ( usFlags & dnsNBNS_FLAGS_RESPONSE ) != 0U )
+                        {
+                            /* If this is a response from another device,
+                             * add the name to the DNS cache */
+                            ( void ) prvProcessDNSCache( ( char * ) ucNBNSName, &( ulIPAddress ), 0, pdFALSE );
+                        }
+                    }
+                #else
+                    {
+                        /* Avoid compiler warnings. */
+                        ( void ) ulIPAddress;
+                    }
+                #endif /* ipconfigUSE_DNS_CACHE */
+
+                if( ( ( usFlags & dnsNBNS_FLAGS_RESPONSE ) == 0U ) &&
+                    ( usType == dnsNBNS_TYPE_NET_BIOS ) &&
+                    ( xApplicationDNSQueryHook( ( const char * ) ucNBNSName ) != pdFALSE ) )
+                {
+                    uint16_t usLength;
+                    DNSMessage_t * pxMessage;
+                    NBNSAnswer_t * pxAnswer;
+                    NetworkBufferDescriptor_t * pxNewBuffer = NULL;
+
+                    /* Someone is looking for a device with ucNBNSName,
+                     * prepare a positive reply. */
+                    pxNetworkBuffer = pxUDPPayloadBuffer_to_NetworkBuffer( pucUDPPayloadBuffer );
+
+                    if( ( xBufferAllocFixedSize == pdFALSE ) && ( pxNetworkBuffer != NULL ) )
+                    {
+                        /* The field xDataLength was set to the total length of the UDP packet,
+                         * i.e. the payload size plus sizeof( UDPPacket_t ). */
+                        pxNewBuffer = pxDuplicateNetworkBufferWithDescriptor( pxNetworkBuffer, pxNetworkBuffer->xDataLength + sizeof( NBNSAnswer_t ) );
+
+                        if( pxNewBuffer != NULL )
+                        {
+                            pucUDPPayloadBuffer = &( pxNewBuffer->pucEthernetBuffer[ sizeof( UDPPacket_t ) ] );
+                            pxNetworkBuffer = pxNewBuffer;
                         }
-                        else if( uxSourceBytesRemaining >= sizeof( DNSAnswerRecord_t ) )
+                        else
                         {
-                            /* It's not an A record, so skip it. Get the header location
-                             * and then jump over the header. */
-                            /* Cast the response to DNSAnswerRecord for easy access to fields of the DNS response. */
-                            pxDNSAnswerRecord = ipCAST_PTR_TO_TYPE_PTR( DNSAnswerRecord_t, pucByte );
+                            /* Just prevent that a reply will be sent */
+                            pxNetworkBuffer = NULL;
+                        }
+                    }
 
-                            pucByte = &( pucByte[ sizeof( DNSAnswerRecord_t ) ] );
-                            uxSourceBytesRemaining -= sizeof( DNSAnswerRecord_t );
+                    /* Should not occur: pucUDPPayloadBuffer is part of a xNetworkBufferDescriptor */
+                    if( pxNetworkBuffer != NULL )
+                    {
+                        pxMessage = ipCAST_PTR_TO_TYPE_PTR( DNSMessage_t, pucUDPPayloadBuffer );
 
-                            /* Determine the length of the answer data from the header. */
-                            usDataLength = FreeRTOS_ntohs( pxDNSAnswerRecord->usDataLength );
+                        /* As the fields in the structures are not word-aligned, we have to
+                         * copy the values byte-by-byte using macro's vSetField16() and vSetField32() */
+                        #ifndef _lint
+                            vSetField16( pxMessage, DNSMessage_t, usFlags, dnsNBNS_QUERY_RESPONSE_FLAGS ); /* 0x8500 */
+                            vSetField16( pxMessage, DNSMessage_t, usQuestions, 0 );
+                            vSetField16( pxMessage, DNSMessage_t, usAnswers, 1 );
+                            vSetField16( pxMessage, DNSMessage_t, usAuthorityRRs, 0 );
+                            vSetField16( pxMessage, DNSMessage_t, usAdditionalRRs, 0 );
+                        #else
+                            ( void ) pxMessage;
+                        #endif
 
-                            /* Jump over the answer. */
-                            if( uxSourceBytesRemaining >= usDataLength )
-                            {
-                                pucByte = &( pucByte[ usDataLength ] );
-                                uxSourceBytesRemaining -= usDataLength;
-                            }
-                            else
-                            {
-                                /* Malformed response. */
-                                xReturn = pdFALSE;
-                                break;
-                            }
-                        }
-                        else
+                        pxAnswer = ipCAST_PTR_TO_TYPE_PTR( NBNSAnswer_t, &( pucUDPPayloadBuffer[ offsetof( NBNSRequest_t, usType ) ] ) );
+
+                        #ifndef _lint
+                            vSetField16( pxAnswer, NBNSAnswer_t, usType, usType );            /* Type */
+                            vSetField16( pxAnswer, NBNSAnswer_t, usClass, dnsNBNS_CLASS_IN ); /* Class */
+                            vSetField32( pxAnswer, NBNSAnswer_t, ulTTL, dnsNBNS_TTL_VALUE );
+                            vSetField16( pxAnswer, NBNSAnswer_t, usDataLength, 6 );           /* 6 bytes including the length field */
+                            vSetField16( pxAnswer, NBNSAnswer_t, usNbFlags, dnsNBNS_NAME_FLAGS );
+                            vSetField32( pxAnswer, NBNSAnswer_t, ulIPAddress, FreeRTOS_ntohl( *ipLOCAL_IP_ADDRESS_POINTER ) );
+                        #else
+                            ( void ) pxAnswer;
+                        #endif
+
+                        usLength = ( uint16_t ) ( sizeof( NBNSAnswer_t ) + ( size_t ) offsetof( NBNSRequest_t, usType ) );
+
+                        prvReplyDNSMessage( pxNetworkBuffer, ( BaseType_t ) usLength );
+
+                        if( pxNewBuffer != NULL )
                         {
-                            /* Do nothing */
+                            vReleaseNetworkBufferAndDescriptor( pxNewBuffer );
                         }
                     }
                 }
+            }
+        }
 
-                #if ( ipconfigUSE_LLMNR == 1 )
+    #endif /* ipconfigUSE_NBNS */
+    /*-----------------------------------------------------------*/
 
-                    /* No need to check that pcRequestedName != NULL since is usQuestions != 0, then
-                     * pcRequestedName is assigned with this statement
-                     * "pcRequestedName = ( char * ) pucByte;" */
-                    else if( ( usQuestions != ( uint16_t ) 0U ) && ( usType == dnsTYPE_A_HOST ) && ( usClass == dnsCLASS_IN ) )
+/**
+ * @brief Create a socket and bind it to the standard DNS port number.
+ *
+ * @return The created socket - or NULL if the socket could not be created or could not be bound.
+ */
+    static Socket_t prvCreateDNSSocket( void )
+    {
+        Socket_t xSocket;
+        struct freertos_sockaddr xAddress;
+        BaseType_t xReturn;
+
+        /* This must be the first time this function has been called.  Create
+         * the socket. */
+        xSocket = FreeRTOS_socket( FREERTOS_AF_INET, FREERTOS_SOCK_DGRAM, FREERTOS_IPPROTO_UDP );
+
+        if( xSocketValid( xSocket ) == pdFALSE )
+        {
+            /* There was an error, return NULL. */
+            xSocket = NULL;
+        }
+        else
+        {
+            /* Auto bind the port. */
+            xAddress.sin_port = 0U;
+            xReturn = FreeRTOS_bind( xSocket, &xAddress, sizeof( xAddress ) );
+
+            /* Check the bind was successful, and clean up if not. */
+            if( xReturn != 0 )
+            {
+                ( void ) FreeRTOS_closesocket( xSocket );
+                xSocket = NULL;
+            }
+            else
+            {
+                /* The send and receive timeouts will be set later on. */
+                #if ( ipconfigDNS_USE_CALLBACKS == 1 )
                     {
-                        /* If this is not a reply to our DNS request, it might an LLMNR
-                         * request. */
-                        if( xApplicationDNSQueryHook( &( pcRequestedName[ 1 ] ) ) != pdFALSE )
+                        xDNSResolverStats.ulSocketsCreated++;
+                    }
+                #endif
+            }
+        }
+
+        return xSocket;
+    }
+/*-----------------------------------------------------------*/
+
+    #if ( ( ipconfigUSE_NBNS == 1 ) || ( ipconfigUSE_LLMNR == 1 ) )
+
+/**
+ * @brief Send a DNS message to be used in NBNS or LLMNR
+ *
+ * @param[in] pxNetworkBuffer: The network buffer descriptor with the DNS message.
+ * @param[in] lNetLength: The length of the DNS message.
+ */
+        static void prvReplyDNSMessage( NetworkBufferDescriptor_t * pxNetworkBuffer,
+                                        BaseType_t lNetLength )
+        {
+            UDPPacket_t * pxUDPPacket;
+            IPHeader_t * pxIPHeader;
+            UDPHeader_t * pxUDPHeader;
+            size_t uxDataLength;
+
+            #if ( ipconfigZERO_COPY_TX_DRIVER != 0 ) && ( ipconfigUSE_NETWORK_BUFFER_CLONES == 1 )
+                NetworkBufferDescriptor_t * pxClone;
+            #endif
+
+            pxUDPPacket = ipCAST_PTR_TO_TYPE_PTR( UDPPacket_t, pxNetworkBuffer->pucEthernetBuffer );
+            pxIPHeader = &pxUDPPacket->xIPHeader;
+            pxUDPHeader = &pxUDPPacket->xUDPHeader;
+            /* HT: started using defines like 'ipSIZE_OF_xxx' */
+            pxIPHeader->usLength = FreeRTOS_htons( ( uint16_t ) lNetLength + ipSIZE_OF_IPv4_HEADER + ipSIZE_OF_UDP_HEADER );
+            /* HT:endian: should not be translated, copying from packet to packet */
+            pxIPHeader->ulDestinationIPAddress = pxIPHeader->ulSourceIPAddress;
+            pxIPHeader->ulSourceIPAddress = *ipLOCAL_IP_ADDRESS_POINTER;
+            pxIPHeader->ucTimeToLive = ipconfigUDP_TIME_TO_LIVE;
+            pxIPHeader->usIdentification = FreeRTOS_htons( usGetNextPacketIdentifier() );
+
+            /* The stack doesn't support fragments, so the fragment offset field must always be zero.
+             * The header was never memset to zero, so set both the fragment offset and fragmentation flags in one go.
+             */
+            #if ( ipconfigFORCE_IP_DONT_FRAGMENT != 0 )
+                pxIPHeader->usFragmentOffset = ipFRAGMENT_FLAGS_DONT_FRAGMENT;
+            #else
+                pxIPHeader->usFragmentOffset = 0U;
+            #endif
+            pxUDPHeader->usLength = FreeRTOS_htons( ( uint32_t ) lNetLength + ipSIZE_OF_UDP_HEADER );
+            vFlip_16( pxUDPHeader->usSourcePort, pxUDPHeader->usDestinationPort );
+
+            /* Important: tell NIC driver how many bytes must be sent */
+            uxDataLength = ( ( size_t ) lNetLength ) + ipSIZE_OF_IPv4_HEADER + ipSIZE_OF_UDP_HEADER + ipSIZE_OF_ETH_HEADER;
+
+            #if ( ipconfigDRIVER_INCLUDED_TX_IP_CHECKSUM == 0 )
+                {
+                    /* Calculate the IP header checksum. */
+                    pxIPHeader->usHeaderChecksum = 0U;
+                    pxIPHeader->usHeaderChecksum = usGenerateChecksum( 0U, ( uint8_t * ) &( pxIPHeader->ucVersionHeaderLength ), ipSIZE_OF_IPv4_HEADER );
+                    pxIPHeader->usHeaderChecksum = ~FreeRTOS_htons( pxIPHeader->usHeaderChecksum );
+
+                    /* calculate the UDP checksum for outgoing package */
+                    ( void ) usGenerateProtocolChecksum( ( uint8_t * ) pxUDPPacket, uxDataLength, pdTRUE );
+                }
+            #endif
+
+            /* Important: tell NIC driver how many bytes must be sent */
+            pxNetworkBuffer->xDataLength = uxDataLength;
+
+            #if ( ipconfigZERO_COPY_TX_DRIVER != 0 ) && ( ipconfigUSE_NETWORK_BUFFER_CLONES == 1 )
+                {
+                    /* The caller releases the buffer after this call, so the
+                     * driver may share the frame in stead of getting a copy. */
+                    pxClone = pxCloneNetworkBufferWithDescriptor( pxNetworkBuffer );
+
+                    if( pxClone != NULL )
+                    {
+                        vReturnEthernetFrame( pxClone, pdTRUE );
+                    }
+                    else
+                    {
+                        vReturnEthernetFrame( pxNetworkBuffer, pdFALSE );
+                    }
+                }
+            #else /* if ( ipconfigZERO_COPY_TX_DRIVER != 0 ) && ( ipconfigUSE_NETWORK_BUFFER_CLONES == 1 ) */
+                {
+                    /* This function will fill in the eth addresses and send the packet */
+                    vReturnEthernetFrame( pxNetworkBuffer, pdFALSE );
+                }
+            #endif /* if ( ipconfigZERO_COPY_TX_DRIVER != 0 ) && ( ipconfigUSE_NETWORK_BUFFER_CLONES == 1 ) */
+        }
+
+    #endif /* ipconfigUSE_NBNS == 1 || ipconfigUSE_LLMNR == 1 */
+
+/*-----------------------------------------------------------*/
+
+    #if ( ipconfigUSE_DNS_CACHE == 1 )
+
+/**
+ * @brief Look up a name in the DNS cache, or add or update its address.
+ *
+ * @param[in] pcName: the name of the host
+ * @param[in,out] pulIP: when doing a lookup, will be set, when doing an update,
+ *                       will be read.  Zero stands for a negative answer: the
+ *                       name is known not to have an IPv4 address.
+ * @param[in] ulTTL: Time To Live, in seconds and in network byte order.
+ * @param[in] xLookUp: pdTRUE if a look-up is expected, pdFALSE, when the DNS cache must
+ *                     be updated.
+ *
+ * @return pdTRUE when the name was found in the cache and has not expired.  A
+ *         look-up that returns pdTRUE with *pulIP set to zero has found a
+ *         negative answer.
+ */
+        static BaseType_t prvProcessDNSCache( const char * pcName,
+                                              uint32_t * pulIP,
+                                              uint32_t ulTTL,
+                                              BaseType_t xLookUp )
+        {
+            BaseType_t x;
+            BaseType_t xFound = pdFALSE;
+            TickType_t xCurrentTickCount = xTaskGetTickCount();
+            uint32_t ulCurrentTimeSeconds;
+            uint32_t ulIPAddressIndex = 0;
+
+            configASSERT( ( pcName != NULL ) );
+
+            ulCurrentTimeSeconds = ( xCurrentTickCount / portTICK_PERIOD_MS ) / 1000UL;
+
+            /* The cache is read by the user tasks and updated by the IP-task. */
+            vTaskSuspendAll();
+            {
+                x = prvDNSCacheFind( pcName );
+
+                if( x >= 0 )
+                {
+                    /* Is this function called for a lookup or to add/update an IP address? */
+                    if( xLookUp != pdFALSE )
+                    {
+                        /* Confirm that the record is still fresh. */
+                        if( ulCurrentTimeSeconds < ( xDNSCache[ x ].ulTimeWhenAddedInSeconds + FreeRTOS_ntohl( xDNSCache[ x ].ulTTL ) ) )
                         {
-                            int16_t usLength;
-                            NetworkBufferDescriptor_t * pxNewBuffer = NULL;
-                            NetworkBufferDescriptor_t * pxNetworkBuffer = pxUDPPayloadBuffer_to_NetworkBuffer( pucUDPPayloadBuffer );
-                            LLMNRAnswer_t * pxAnswer;
-                            uint8_t * pucNewBuffer = NULL;
+                            #if ( ipconfigDNS_CACHE_ADDRESSES_PER_ENTRY > 1 )
+                                uint8_t ucIndex;
 
-                            if( pxNetworkBuffer != NULL )
-                            {
-                                if( xBufferAllocFixedSize == pdFALSE )
+                                /* The ucCurrentIPAddress value increments without bound and will rollover, */
+                                /*  modulo it by the number of IP addresses to keep it in range.     */
+                                /*  Also perform a final modulo by the max number of IP addresses    */
+                                /*  per DNS cache entry to prevent out-of-bounds access in the event */
+                                /*  that ucNumIPAddresses has been corrupted.                        */
+                                /* A negative answer has no addresses, its first address is zero. */
+                                if( xDNSCache[ x ].ucNumIPAddresses != 0U )
                                 {
-                                    size_t uxDataLength = uxBufferLength + sizeof( UDPHeader_t ) + sizeof( EthernetHeader_t ) + sizeof( IPHeader_t );
+                                    ucIndex = xDNSCache[ x ].ucCurrentIPAddress % xDNSCache[ x ].ucNumIPAddresses;
+                                    ucIndex = ucIndex % ( uint8_t ) ipconfigDNS_CACHE_ADDRESSES_PER_ENTRY;
+                                    ulIPAddressIndex = ucIndex;
 
-                                    /* Set the size of the outgoing packet. */
-                                    pxNetworkBuffer->xDataLength = uxDataLength;
-                                    pxNewBuffer = pxDuplicateNetworkBufferWithDescriptor( pxNetworkBuffer, uxDataLength + sizeof( LLMNRAnswer_t ) );
+                                    xDNSCache[ x ].ucCurrentIPAddress++;
+                                }
+                            #endif /* if ( ipconfigDNS_CACHE_ADDRESSES_PER_ENTRY > 1 ) */
 
-                                    if( pxNewBuffer != NULL )
-                                    {
-                                        BaseType_t xOffset1, xOffset2;
+                            *pulIP = xDNSCache[ x ].ulIPAddresses[ ulIPAddressIndex ];
+                            xFound = pdTRUE;
+
+                            if( *pulIP != 0UL )
+                            {
+                                xDNSCacheStats.ulHits++;
+                            }
+                            else
+                            {
+                                xDNSCacheStats.ulNegativeHits++;
+                            }
 
-                                        xOffset1 = ( BaseType_t ) ( pucByte - pucUDPPayloadBuffer );
-                                        xOffset2 = ( BaseType_t ) ( ( ( uint8_t * ) pcRequestedName ) - pucUDPPayloadBuffer );
+                            #if ( ipconfigUSE_DNS_CACHE_HASH == 1 )
+                                {
+                                    prvDNSTouch( x );
+                                }
+                            #endif
 
-                                        pxNetworkBuffer = pxNewBuffer;
-                                        pucNewBuffer = &( pxNetworkBuffer->pucEthernetBuffer[ ipUDP_PAYLOAD_OFFSET_IPv4 ] );
+                            #if ( ipconfigDNS_USE_PREFETCH == 1 )
+                                {
+                                    if( xDNSCache[ x ].ucLookUps < 0xFFU )
+                                    {
+                                        xDNSCache[ x ].ucLookUps++;
+                                    }
 
-                                        pucByte = &( pucNewBuffer[ xOffset1 ] );
-                                        pcRequestedName = ( char * ) &( pucNewBuffer[ xOffset2 ] );
-                                        pxDNSMessageHeader = ipCAST_PTR_TO_TYPE_PTR( DNSMessage_t, pucNewBuffer );
+                                    /* Not only at the moment that the name becomes
+                                     * popular: the timer may have been stopped since,
+                                     * e.g. because the resolver socket did not exist yet. */
+                                    if( ( xDNSCache[ x ].ucLookUps >= ( uint8_t ) ipconfigDNS_PREFETCH_MIN_LOOKUPS ) &&
+                                        ( xDNSCache[ x ].ucRefreshing == 0U ) &&
+                                        ( xDNSPrefetchTimerSet == pdFALSE ) &&
+                                        ( listLIST_IS_EMPTY( &xCallbackList ) != pdFALSE ) )
+                                    {
+                                        /* Let the DNS timer find out when the name
+                                         * must be refreshed. */
+                                        xDNSPrefetchTimerSet = pdTRUE;
+                                        vIPReloadDNSTimer( pdMS_TO_TICKS( 1000U ) );
                                     }
-                                    else
+                                }
+                            #endif
+                        }
+                        else
+                        {
+                            /* Age out the old cached record. */
+                            prvDNSCacheRemove( x );
+                        }
+                    }
+                    else
+                    {
+                        if( *pulIP == 0UL )
+                        {
+                            /* A negative answer replaces the addresses that were stored. */
+                            ( void ) memset( xDNSCache[ x ].ulIPAddresses, 0, sizeof( xDNSCache[ x ].ulIPAddresses ) );
+                            #if ( ipconfigDNS_CACHE_ADDRESSES_PER_ENTRY > 1 )
+                                xDNSCache[ x ].ucNumIPAddresses = 0U;
+                                xDNSCache[ x ].ucCurrentIPAddress = 0U;
+                            #endif
+                        }
+                        else
+                        {
+                            #if ( ipconfigDNS_CACHE_ADDRESSES_PER_ENTRY > 1 )
+                                uint8_t ucIndex;
+
+                                /* A refreshed answer may repeat the addresses that are stored. */
+                                for( ucIndex = 0U; ucIndex < xDNSCache[ x ].ucNumIPAddresses; ucIndex++ )
+                                {
+                                    if( xDNSCache[ x ].ulIPAddresses[ ucIndex ] == *pulIP )
                                     {
-                                        /* Just to indicate that the message may not be answered. */
-                                        pxNetworkBuffer = NULL;
+                                        break;
                                     }
                                 }
+
+                                if( ucIndex < xDNSCache[ x ].ucNumIPAddresses )
+                                {
+                                    ulIPAddressIndex = ucIndex;
+                                }
+                                else if( xDNSCache[ x ].ucNumIPAddresses < ( uint8_t ) ipconfigDNS_CACHE_ADDRESSES_PER_ENTRY )
+                                {
+                                    /* If more answers exist than there are IP address storage slots */
+                                    /* they will overwrite entry 0 */
+
+                                    ulIPAddressIndex = xDNSCache[ x ].ucNumIPAddresses;
+                                    xDNSCache[ x ].ucNumIPAddresses++;
+                                }
                                 else
                                 {
-                                    pucNewBuffer = &( pxNetworkBuffer->pucEthernetBuffer[ ipUDP_PAYLOAD_OFFSET_IPv4 ] );
+                                    /* Overwrite entry 0. */
                                 }
+                            #endif /* if ( ipconfigDNS_CACHE_ADDRESSES_PER_ENTRY > 1 ) */
+                            xDNSCache[ x ].ulIPAddresses[ ulIPAddressIndex ] = *pulIP;
+                        }
+
+                        #if ( ipconfigDNS_USE_PREFETCH == 1 )
+                            {
+                                /* The popularity is counted again for the new answer. */
+                                xDNSCache[ x ].ucLookUps = 0U;
+                                xDNSCache[ x ].ucRefreshing = 0U;
                             }
+                        #endif
 
-                            /* The test on 'pucNewBuffer' is only to satisfy lint. */
-                            if( ( pxNetworkBuffer != NULL ) && ( pucNewBuffer != NULL ) )
+                        xDNSCache[ x ].ulTTL = ulTTL;
+                        xDNSCache[ x ].ulTimeWhenAddedInSeconds = ulCurrentTimeSeconds;
+                        xFound = pdTRUE;
+
+                        #if ( ipconfigUSE_DNS_CACHE_HASH == 1 )
                             {
-                                pxAnswer = ipCAST_PTR_TO_TYPE_PTR( LLMNRAnswer_t, pucByte );
+                                prvDNSTouch( x );
+                            }
+                        #endif
+                    }
+                }
 
-                                /* We leave 'usIdentifier' and 'usQuestions' untouched */
-                                #ifndef _lint
-                                    vSetField16( pxDNSMessageHeader, DNSMessage_t, usFlags, dnsLLMNR_FLAGS_IS_REPONSE ); /* Set the response flag */
-                                    vSetField16( pxDNSMessageHeader, DNSMessage_t, usAnswers, 1 );                       /* Provide a single answer */
-                                    vSetField16( pxDNSMessageHeader, DNSMessage_t, usAuthorityRRs, 0 );                  /* No authority */
-                                    vSetField16( pxDNSMessageHeader, DNSMessage_t, usAdditionalRRs, 0 );                 /* No additional info */
-                                #endif /* lint */
+                if( xFound == pdFALSE )
+                {
+                    if( xLookUp != pdFALSE )
+                    {
+                        *pulIP = 0UL;
+                        xDNSCacheStats.ulMisses++;
+                    }
+                    else
+                    {
+                        /* Add or update the item. */
+                        if( strlen( pcName ) < ( size_t ) ipconfigDNS_CACHE_NAME_LENGTH )
+                        {
+                            x = prvDNSCacheNewRow( ulCurrentTimeSeconds );
 
-                                pxAnswer->ucNameCode = dnsNAME_IS_OFFSET;
-                                pxAnswer->ucNameOffset = ( uint8_t ) ( pcRequestedName - ( char * ) pucNewBuffer );
+                            ( void ) strcpy( xDNSCache[ x ].pcName, pcName );
 
-                                #ifndef _lint
-                                    vSetField16( pxAnswer, LLMNRAnswer_t, usType, dnsTYPE_A_HOST ); /* Type A: host */
-                                    vSetField16( pxAnswer, LLMNRAnswer_t, usClass, dnsCLASS_IN );   /* 1: Class IN */
-                                    vSetField32( pxAnswer, LLMNRAnswer_t, ulTTL, dnsLLMNR_TTL_VALUE );
-                                    vSetField16( pxAnswer, LLMNRAnswer_t, usDataLength, 4 );
-                                    vSetField32( pxAnswer, LLMNRAnswer_t, ulIPAddress, FreeRTOS_ntohl( *ipLOCAL_IP_ADDRESS_POINTER ) );
-                                #endif /* lint */
-                                usLength = ( int16_t ) ( sizeof( *pxAnswer ) + ( size_t ) ( pucByte - pucNewBuffer ) );
+                            xDNSCache[ x ].ulIPAddresses[ 0 ] = *pulIP;
+                            xDNSCache[ x ].ulTTL = ulTTL;
+                            xDNSCache[ x ].ulTimeWhenAddedInSeconds = ulCurrentTimeSeconds;
+                            #if ( ipconfigDNS_CACHE_ADDRESSES_PER_ENTRY > 1 )
+                                xDNSCache[ x ].ucNumIPAddresses = ( *pulIP != 0UL ) ? 1U : 0U;
+                                xDNSCache[ x ].ucCurrentIPAddress = 0;
 
-                                prvReplyDNSMessage( pxNetworkBuffer, usLength );
+                                /* Initialize all remaining IP addresses in this entry to 0 */
+                                ( void ) memset( &xDNSCache[ x ].ulIPAddresses[ 1 ],
+                                                 0,
+                                                 sizeof( xDNSCache[ x ].ulIPAddresses[ 1 ] ) *
+                                                 ( ( uint32_t ) ipconfigDNS_CACHE_ADDRESSES_PER_ENTRY - 1U ) );
+                            #endif
 
-                                if( pxNewBuffer != NULL )
+                            #if ( ipconfigDNS_USE_PREFETCH == 1 )
                                 {
-                                    vReleaseNetworkBufferAndDescriptor( pxNewBuffer );
+                                    xDNSCache[ x ].ucLookUps = 0U;
+                                    xDNSCache[ x ].ucRefreshing = 0U;
                                 }
-                            }
+                            #endif
+
+                            #if ( ipconfigUSE_DNS_CACHE_HASH == 1 )
+                                {
+                                    ulDNSNameHash[ x ] = prvDNSHashName( pcName );
+                                    prvDNSIndexAdd( x );
+                                    prvDNSTouch( x );
+                                }
+                            #endif
                         }
                     }
-                    else
-                    {
-                        /* Not an expected reply. */
-                    }
-                #endif /* ipconfigUSE_LLMNR == 1 */
-                ( void ) uxBytesRead;
-            } while( ipFALSE_BOOL );
-        }
-
-        if( xReturn == pdFALSE )
-        {
-            /* There was an error while parsing the DNS response. Return error code. */
-            ulIPAddress = dnsPARSE_ERROR;
-        }
-        else if( xExpected == pdFALSE )
-        {
-            /* Do not return a valid IP-address in case the reply was not expected. */
-            ulIPAddress = 0UL;
-        }
-        else
-        {
-            /* The IP-address found will be returned. */
-        }
-
-        #if ( ipconfigUSE_DNS_CACHE == 1 ) || ( ipconfigDNS_USE_CALLBACKS == 1 )
-            ( void ) xDoStore;
-        #endif
+                }
+            }
+            ( void ) xTaskResumeAll();
 
-        return ulIPAddress;
-    }
-    /*-----------------------------------------------------------*/
+            if( ( xLookUp == 0 ) || ( *pulIP != 0UL ) )
+            {
+                FreeRTOS_debug_printf( ( "prvProcessDNSCache: %s: '%s' @ %lxip\n", ( xLookUp != 0 ) ? "look-up" : "add", pcName, FreeRTOS_ntohl( *pulIP ) ) );
+            }
 
-    #if ( ipconfigUSE_NBNS == 1 )
+            return xFound;
+        }
+        /*-----------------------------------------------------------*/
 
 /**
- * @brief Respond to an NBNS query or an NBNS reply.
+ * @brief Find the row of the DNS cache that holds a name.  When the hash index
+ *        is used, names are compared regardless of case.
  *
- * @param[in] pucPayload: the UDP payload of the NBNS message.
- * @param[in] uxBufferLength: Length of the Buffer.
- * @param[in] ulIPAddress: IP address of the sender.
+ * @param[in] pcName: The name to look for.
+ *
+ * @return The row, or -1 when the name is not in the cache.
  */
-        static void prvTreatNBNS( uint8_t * pucPayload,
-                                  size_t uxBufferLength,
-                                  uint32_t ulIPAddress )
+        static BaseType_t prvDNSCacheFind( const char * pcName )
         {
-            uint16_t usFlags, usType, usClass;
-            uint8_t * pucSource, * pucTarget;
-            uint8_t ucByte;
-            uint8_t ucNBNSName[ 17 ];
-            uint8_t * pucUDPPayloadBuffer = pucPayload;
-            NetworkBufferDescriptor_t * pxNetworkBuffer;
-            size_t uxBytesNeeded = sizeof( UDPPacket_t ) + sizeof( NBNSRequest_t );
-
-            /* Check for minimum buffer size. */
-            if( uxBufferLength < uxBytesNeeded )
-            {
-                return;
-            }
-
-            /* Read the request flags in host endianness. */
-            usFlags = usChar2u16( &( pucUDPPayloadBuffer[ offsetof( NBNSRequest_t, usFlags ) ] ) );
-
-            if( ( usFlags & dnsNBNS_FLAGS_OPCODE_MASK ) == dnsNBNS_FLAGS_OPCODE_QUERY )
-            {
-                usType = usChar2u16( &( pucUDPPayloadBuffer[ offsetof( NBNSRequest_t, usType ) ] ) );
-                usClass = usChar2u16( &( pucUDPPayloadBuffer[ offsetof( NBNSRequest_t, usClass ) ] ) );
-
-                /* Not used for now */
-                ( void ) usClass;
-
-                /* For NBNS a name is 16 bytes long, written with capitals only.
-                 * Make sure that the copy is terminated with a zero. */
-                pucTarget = &( ucNBNSName[ sizeof( ucNBNSName ) - 2U ] );
-                pucTarget[ 1 ] = ( uint8_t ) 0U;
-
-                /* Start with decoding the last 2 bytes. */
-                pucSource = &( pucUDPPayloadBuffer[ ( dnsNBNS_ENCODED_NAME_LENGTH - 2 ) + offsetof( NBNSRequest_t, ucName ) ] );
+            BaseType_t xResult = -1;
 
-                for( ; ; )
+            #if ( ipconfigUSE_DNS_CACHE_HASH == 1 )
                 {
-                    const uint8_t ucCharA = ( uint8_t ) 0x41U;
-
-                    ucByte = ( ( uint8_t ) ( ( pucSource[ 0 ] - ucCharA ) << 4 ) ) | ( pucSource[ 1 ] - ucCharA );
+                    uint32_t ulHash = prvDNSHashName( pcName );
+                    size_t uxSlot = ( size_t ) ( ulHash % ( uint32_t ) ipconfigDNS_CACHE_HASH_SIZE );
+                    BaseType_t xRow;
 
-                    /* Make sure there are no trailing spaces in the name. */
-                    if( ( ucByte == ( uint8_t ) ' ' ) && ( pucTarget[ 1 ] == 0U ) )
-                    {
-                        ucByte = 0U;
-                    }
-
-                    *pucTarget = ucByte;
-
-                    if( pucTarget == ucNBNSName )
+                    while( usDNSHashIndex[ uxSlot ] != dnsHASH_EMPTY )
                     {
-                        break;
-                    }
-
-                    pucTarget -= 1;
-                    pucSource -= 2;
-                }
+                        xRow = ( BaseType_t ) usDNSHashIndex[ uxSlot ] - 1;
 
-                #if ( ipconfigUSE_DNS_CACHE == 1 )
-                    {
-                        if( ( usFlags & dnsNBNS_FLAGS_RESPONSE ) != 0U )
+                        if( ( ulDNSNameHash[ xRow ] == ulHash ) && ( prvDNSNameEqual( xDNSCache[ xRow ].pcName, pcName ) != pdFALSE ) )
                         {
-                            /* If this is a response from another device,
-                             * add the name to the DNS cache */
-                            ( void ) prvProcessDNSCache( ( char * ) ucNBNSName, &( ulIPAddress ), 0, pdFALSE );
+                            xResult = xRow;
+                            break;
                         }
-                    }
-                #else
-                    {
-                        /* Avoid compiler warnings. */
-                        ( void ) ulIPAddress;
-                    }
-                #endif /* ipconfigUSE_DNS_CACHE */
 
-                if( ( ( usFlags & dnsNBNS_FLAGS_RESPONSE ) == 0U ) &&
-                    ( usType == dnsNBNS_TYPE_NET_BIOS ) &&
-                    ( xApplicationDNSQueryHook( ( const char * ) ucNBNSName ) != pdFALSE ) )
+                        uxSlot = ( uxSlot + 1U ) % ( size_t ) ipconfigDNS_CACHE_HASH_SIZE;
+                    }
+                }
+            #else /* if ( ipconfigUSE_DNS_CACHE_HASH == 1 ) */
                 {
-                    uint16_t usLength;
-                    DNSMessage_t * pxMessage;
-                    NBNSAnswer_t * pxAnswer;
-                    NetworkBufferDescriptor_t * pxNewBuffer = NULL;
-
-                    /* Someone is looking for a device with ucNBNSName,
-                     * prepare a positive reply. */
-                    pxNetworkBuffer = pxUDPPayloadBuffer_to_NetworkBuffer( pucUDPPayloadBuffer );
+                    BaseType_t x;
 
-                    if( ( xBufferAllocFixedSize == pdFALSE ) && ( pxNetworkBuffer != NULL ) )
+                    /* For each entry in the DNS cache table. */
+                    for( x = 0; x < ipconfigDNS_CACHE_ENTRIES; x++ )
                     {
-                        /* The field xDataLength was set to the total length of the UDP packet,
-                         * i.e. the payload size plus sizeof( UDPPacket_t ). */
-                        pxNewBuffer = pxDuplicateNetworkBufferWithDescriptor( pxNetworkBuffer, pxNetworkBuffer->xDataLength + sizeof( NBNSAnswer_t ) );
-
-                        if( pxNewBuffer != NULL )
+                        if( xDNSCache[ x ].pcName[ 0 ] == ( char ) 0 )
                         {
-                            pucUDPPayloadBuffer = &( pxNewBuffer->pucEthernetBuffer[ sizeof( UDPPacket_t ) ] );
-                            pxNetworkBuffer = pxNewBuffer;
+                            continue;
                         }
-                        else
+
+                        if( strcmp( xDNSCache[ x ].pcName, pcName ) == 0 )
                         {
-                            /* Just prevent that a reply will be sent */
-                            pxNetworkBuffer = NULL;
+                            xResult = x;
+                            break;
                         }
                     }
+                }
+            #endif /* if ( ipconfigUSE_DNS_CACHE_HASH == 1 ) */
 
-                    /* Should not occur: pucUDPPayloadBuffer is part of a xNetworkBufferDescriptor */
-                    if( pxNetworkBuffer != NULL )
-                    {
-                        pxMessage = ipCAST_PTR_TO_TYPE_PTR( DNSMessage_t, pucUDPPayloadBuffer );
+            return xResult;
+        }
+        /*-----------------------------------------------------------*/
 
-                        /* As the fields in the structures are not word-aligned, we have to
-                         * copy the values byte-by-byte using macro's vSetField16() and vSetField32() */
-                        #ifndef _lint
-                            vSetField16( pxMessage, DNSMessage_t, usFlags, dnsNBNS_QUERY_RESPONSE_FLAGS ); /* 0x8500 */
-                            vSetField16( pxMessage, DNSMessage_t, usQuestions, 0 );
-                            vSetField16( pxMessage, DNSMessage_t, usAnswers, 1 );
-                            vSetField16( pxMessage, DNSMessage_t, usAuthorityRRs, 0 );
-                            vSetField16( pxMessage, DNSMessage_t, usAdditionalRRs, 0 );
-                        #else
-                            ( void ) pxMessage;
-                        #endif
+/**
+ * @brief Choose the row in which a new name will be stored, and remove the
+ *        name that it holds.  With the hash index, the least recently used
+ *        rows are considered: an empty or expired row is taken first,
+ *        otherwise the row whose TTL ends first.  Without it, the rows are
+ *        used in turn.
+ *
+ * @param[in] ulCurrentTimeSeconds: The current time in seconds.
+ *
+ * @return The row to use.
+ */
+        static BaseType_t prvDNSCacheNewRow( uint32_t ulCurrentTimeSeconds )
+        {
+            BaseType_t xRow;
+            uint32_t ulExpiry;
+
+            #if ( ipconfigUSE_DNS_CACHE_HASH == 1 )
+                {
+                    BaseType_t x;
+                    uint16_t usRow;
+                    uint32_t ulEarliest = 0U;
 
-                        pxAnswer = ipCAST_PTR_TO_TYPE_PTR( NBNSAnswer_t, &( pucUDPPayloadBuffer[ offsetof( NBNSRequest_t, usType ) ] ) );
+                    prvDNSCacheHashInit();
+                    xRow = ( BaseType_t ) usDNSLRUTail;
 
-                        #ifndef _lint
-                            vSetField16( pxAnswer, NBNSAnswer_t, usType, usType );            /* Type */
-                            vSetField16( pxAnswer, NBNSAnswer_t, usClass, dnsNBNS_CLASS_IN ); /* Class */
-                            vSetField32( pxAnswer, NBNSAnswer_t, ulTTL, dnsNBNS_TTL_VALUE );
-                            vSetField16( pxAnswer, NBNSAnswer_t, usDataLength, 6 );           /* 6 bytes including the length field */
-                            vSetField16( pxAnswer, NBNSAnswer_t, usNbFlags, dnsNBNS_NAME_FLAGS );
-                            vSetField32( pxAnswer, NBNSAnswer_t, ulIPAddress, FreeRTOS_ntohl( *ipLOCAL_IP_ADDRESS_POINTER ) );
-                        #else
-                            ( void ) pxAnswer;
-                        #endif
+                    usRow = usDNSLRUTail;
 
-                        usLength = ( uint16_t ) ( sizeof( NBNSAnswer_t ) + ( size_t ) offsetof( NBNSRequest_t, usType ) );
+                    for( x = 0; ( x < dnsEVICTION_CANDIDATES ) && ( usRow != dnsLRU_NONE ); x++ )
+                    {
+                        if( xDNSCache[ usRow ].pcName[ 0 ] == ( char ) 0 )
+                        {
+                            xRow = ( BaseType_t ) usRow;
+                            break;
+                        }
 
-                        prvReplyDNSMessage( pxNetworkBuffer, ( BaseType_t ) usLength );
+                        ulExpiry = xDNSCache[ usRow ].ulTimeWhenAddedInSeconds + FreeRTOS_ntohl( xDNSCache[ usRow ].ulTTL );
 
-                        if( pxNewBuffer != NULL )
+                        if( ( x == 0 ) || ( ulExpiry < ulEarliest ) )
                         {
-                            vReleaseNetworkBufferAndDescriptor( pxNewBuffer );
+                            xRow = ( BaseType_t ) usRow;
+                            ulEarliest = ulExpiry;
+                        }
+
+                        if( ulCurrentTimeSeconds >= ulExpiry )
+                        {
+                            /* This row has expired already. */
+                            break;
                         }
+
+                        usRow = usDNSLRUPrev[ usRow ];
+                    }
+                }
+            #else /* if ( ipconfigUSE_DNS_CACHE_HASH == 1 ) */
+                {
+                    static BaseType_t xFreeEntry = 0;
+
+                    xRow = xFreeEntry;
+                    xFreeEntry++;
+
+                    if( xFreeEntry == ipconfigDNS_CACHE_ENTRIES )
+                    {
+                        xFreeEntry = 0;
                     }
                 }
+            #endif /* if ( ipconfigUSE_DNS_CACHE_HASH == 1 ) */
+
+            if( xDNSCache[ xRow ].pcName[ 0 ] != ( char ) 0 )
+            {
+                ulExpiry = xDNSCache[ xRow ].ulTimeWhenAddedInSeconds + FreeRTOS_ntohl( xDNSCache[ xRow ].ulTTL );
+
+                if( ulCurrentTimeSeconds < ulExpiry )
+                {
+                    /* A name that is still valid will be forgotten. */
+                    xDNSCacheStats.ulEvictions++;
+                }
+
+                prvDNSCacheRemove( xRow );
             }
-        }
 
-    #endif /* ipconfigUSE_NBNS */
-    /*-----------------------------------------------------------*/
+            return xRow;
+        }
+        /*-----------------------------------------------------------*/
 
 /**
- * @brief Create a socket and bind it to the standard DNS port number.
+ * @brief Remove a name from the DNS cache.
  *
- * @return The created socket - or NULL if the socket could not be created or could not be bound.
+ * @param[in] xRow: The row that holds the name.
  */
-    static Socket_t prvCreateDNSSocket( void )
-    {
-        Socket_t xSocket;
-        struct freertos_sockaddr xAddress;
-        BaseType_t xReturn;
-
-        /* This must be the first time this function has been called.  Create
-         * the socket. */
-        xSocket = FreeRTOS_socket( FREERTOS_AF_INET, FREERTOS_SOCK_DGRAM, FREERTOS_IPPROTO_UDP );
-
-        if( xSocketValid( xSocket ) == pdFALSE )
-        {
-            /* There was an error, return NULL. */
-            xSocket = NULL;
-        }
-        else
+        static void prvDNSCacheRemove( BaseType_t xRow )
         {
-            /* Auto bind the port. */
-            xAddress.sin_port = 0U;
-            xReturn = FreeRTOS_bind( xSocket, &xAddress, sizeof( xAddress ) );
+            #if ( ipconfigUSE_DNS_CACHE_HASH == 1 )
+                {
+                    prvDNSIndexDelete( xRow );
+                    prvDNSRelease( xRow );
+                }
+            #endif
 
-            /* Check the bind was successful, and clean up if not. */
-            if( xReturn != 0 )
-            {
-                ( void ) FreeRTOS_closesocket( xSocket );
-                xSocket = NULL;
-            }
-            else
-            {
-                /* The send and receive timeouts will be set later on. */
-            }
+            xDNSCache[ xRow ].pcName[ 0 ] = ( char ) 0;
         }
+        /*-----------------------------------------------------------*/
 
-        return xSocket;
-    }
-/*-----------------------------------------------------------*/
-
-    #if ( ( ipconfigUSE_NBNS == 1 ) || ( ipconfigUSE_LLMNR == 1 ) )
+        #if ( ipconfigUSE_DNS_CACHE_HASH == 1 )
 
 /**
- * @brief Send a DNS message to be used in NBNS or LLMNR
+ * @brief Calculate the FNV-1a hash of a name, of which the upper-case
+ *        letters are taken as lower-case letters.
  *
- * @param[in] pxNetworkBuffer: The network buffer descriptor with the DNS message.
- * @param[in] lNetLength: The length of the DNS message.
+ * @param[in] pcName: The name.
+ *
+ * @return The hash.
  */
-        static void prvReplyDNSMessage( NetworkBufferDescriptor_t * pxNetworkBuffer,
-                                        BaseType_t lNetLength )
-        {
-            UDPPacket_t * pxUDPPacket;
-            IPHeader_t * pxIPHeader;
-            UDPHeader_t * pxUDPHeader;
-            size_t uxDataLength;
+            static uint32_t prvDNSHashName( const char * pcName )
+            {
+                uint32_t ulHash = 2166136261UL;
+                const char * pcChar = pcName;
+                uint8_t ucChar;
 
-            pxUDPPacket = ipCAST_PTR_TO_TYPE_PTR( UDPPacket_t, pxNetworkBuffer->pucEthernetBuffer );
-            pxIPHeader = &pxUDPPacket->xIPHeader;
-            pxUDPHeader = &pxUDPPacket->xUDPHeader;
-            /* HT: started using defines like 'ipSIZE_OF_xxx' */
-            pxIPHeader->usLength = FreeRTOS_htons( ( uint16_t ) lNetLength + ipSIZE_OF_IPv4_HEADER + ipSIZE_OF_UDP_HEADER );
-            /* HT:endian: should not be translated, copying from packet to packet */
-            pxIPHeader->ulDestinationIPAddress = pxIPHeader->ulSourceIPAddress;
-            pxIPHeader->ulSourceIPAddress = *ipLOCAL_IP_ADDRESS_POINTER;
-            pxIPHeader->ucTimeToLive = ipconfigUDP_TIME_TO_LIVE;
-            pxIPHeader->usIdentification = FreeRTOS_htons( usPacketIdentifier );
+                while( *pcChar != ( char ) 0 )
+                {
+                    ucChar = ( uint8_t ) *pcChar;
 
-            /* The stack doesn't support fragments, so the fragment offset field must always be zero.
-             * The header was never memset to zero, so set both the fragment offset and fragmentation flags in one go.
-             */
-            #if ( ipconfigFORCE_IP_DONT_FRAGMENT != 0 )
-                pxIPHeader->usFragmentOffset = ipFRAGMENT_FLAGS_DONT_FRAGMENT;
-            #else
-                pxIPHeader->usFragmentOffset = 0U;
-            #endif
-            usPacketIdentifier++;
-            pxUDPHeader->usLength = FreeRTOS_htons( ( uint32_t ) lNetLength + ipSIZE_OF_UDP_HEADER );
-            vFlip_16( pxUDPHeader->usSourcePort, pxUDPHeader->usDestinationPort );
+                    if( ( ucChar >= ( uint8_t ) 'A' ) && ( ucChar <= ( uint8_t ) 'Z' ) )
+                    {
+                        ucChar += ( uint8_t ) ( 'a' - 'A' );
+                    }
 
-            /* Important: tell NIC driver how many bytes must be sent */
-            uxDataLength = ( ( size_t ) lNetLength ) + ipSIZE_OF_IPv4_HEADER + ipSIZE_OF_UDP_HEADER + ipSIZE_OF_ETH_HEADER;
+                    ulHash ^= ucChar;
+                    ulHash *= 16777619UL;
+                    pcChar++;
+                }
 
-            #if ( ipconfigDRIVER_INCLUDED_TX_IP_CHECKSUM == 0 )
+                return ulHash;
+            }
+            /*-----------------------------------------------------------*/
+
+/**
+ * @brief Compare two names regardless of the case of their letters, as
+ *        DNS names are.
+ *
+ * @param[in] pcName1: The first name.
+ * @param[in] pcName2: The second name.
+ *
+ * @return pdTRUE when the names are equal.
+ */
+            static BaseType_t prvDNSNameEqual( const char * pcName1,
+                                               const char * pcName2 )
+            {
+                const char * pcChar1 = pcName1;
+                const char * pcChar2 = pcName2;
+                uint8_t ucChar1, ucChar2;
+                BaseType_t xResult = pdFALSE;
+
+                for( ; ; )
                 {
-                    /* Calculate the IP header checksum. */
-                    pxIPHeader->usHeaderChecksum = 0U;
-                    pxIPHeader->usHeaderChecksum = usGenerateChecksum( 0U, ( uint8_t * ) &( pxIPHeader->ucVersionHeaderLength ), ipSIZE_OF_IPv4_HEADER );
-                    pxIPHeader->usHeaderChecksum = ~FreeRTOS_htons( pxIPHeader->usHeaderChecksum );
+                    ucChar1 = ( uint8_t ) *pcChar1;
+                    ucChar2 = ( uint8_t ) *pcChar2;
 
-                    /* calculate the UDP checksum for outgoing package */
-                    ( void ) usGenerateProtocolChecksum( ( uint8_t * ) pxUDPPacket, uxDataLength, pdTRUE );
-                }
-            #endif
+                    if( ( ucChar1 >= ( uint8_t ) 'A' ) && ( ucChar1 <= ( uint8_t ) 'Z' ) )
+                    {
+                        ucChar1 += ( uint8_t ) ( 'a' - 'A' );
+                    }
 
-            /* Important: tell NIC driver how many bytes must be sent */
-            pxNetworkBuffer->xDataLength = uxDataLength;
+                    if( ( ucChar2 >= ( uint8_t ) 'A' ) && ( ucChar2 <= ( uint8_t ) 'Z' ) )
+                    {
+                        ucChar2 += ( uint8_t ) ( 'a' - 'A' );
+                    }
 
-            /* This function will fill in the eth addresses and send the packet */
-            vReturnEthernetFrame( pxNetworkBuffer, pdFALSE );
-        }
+                    if( ucChar1 != ucChar2 )
+                    {
+                        break;
+                    }
 
-    #endif /* ipconfigUSE_NBNS == 1 || ipconfigUSE_LLMNR == 1 */
+                    if( ucChar1 == 0U )
+                    {
+                        xResult = pdTRUE;
+                        break;
+                    }
 
-/*-----------------------------------------------------------*/
+                    pcChar1++;
+                    pcChar2++;
+                }
 
-    #if ( ipconfigUSE_DNS_CACHE == 1 )
+                return xResult;
+            }
+            /*-----------------------------------------------------------*/
 
 /**
- * @brief Send a DNS message to be used in NBNS or LLMNR
- *
- * @param[in] pcName: the name of the host
- * @param[in,out] pulIP: when doing a lookup, will be set, when doing an update,
- *                       will be read.
- * @param[in] ulTTL: Time To Live
- * @param[in] xLookUp: pdTRUE if a look-up is expected, pdFALSE, when the DNS cache must
- *                     be updated.
+ * @brief Add a row to the hash index.  There is always an empty slot because
+ *        the index has more slots than there are rows.
  *
- * @return
+ * @param[in] xRow: The row to add, ulDNSNameHash[] must have been set.
  */
-        static BaseType_t prvProcessDNSCache( const char * pcName,
-                                              uint32_t * pulIP,
-                                              uint32_t ulTTL,
-                                              BaseType_t xLookUp )
-        {
-            BaseType_t x;
-            BaseType_t xFound = pdFALSE;
-            TickType_t xCurrentTickCount = xTaskGetTickCount();
-            uint32_t ulCurrentTimeSeconds;
-            uint32_t ulIPAddressIndex = 0;
-            static BaseType_t xFreeEntry = 0;
+            static void prvDNSIndexAdd( BaseType_t xRow )
+            {
+                size_t uxSlot = ( size_t ) ( ulDNSNameHash[ xRow ] % ( uint32_t ) ipconfigDNS_CACHE_HASH_SIZE );
 
-            configASSERT( ( pcName != NULL ) );
+                while( usDNSHashIndex[ uxSlot ] != dnsHASH_EMPTY )
+                {
+                    uxSlot = ( uxSlot + 1U ) % ( size_t ) ipconfigDNS_CACHE_HASH_SIZE;
+                }
 
-            ulCurrentTimeSeconds = ( xCurrentTickCount / portTICK_PERIOD_MS ) / 1000UL;
+                usDNSHashIndex[ uxSlot ] = ( uint16_t ) ( xRow + 1 );
+            }
+            /*-----------------------------------------------------------*/
 
-            /* For each entry in the DNS cache table. */
-            for( x = 0; x < ipconfigDNS_CACHE_ENTRIES; x++ )
+/**
+ * @brief Remove a row from the hash index, if it is present.  The rows that
+ *        follow it in the same probe sequence are shifted back, so no
+ *        tombstones are needed.
+ *
+ * @param[in] xRow: The row to remove.
+ */
+            static void prvDNSIndexDelete( BaseType_t xRow )
             {
-                if( xDNSCache[ x ].pcName[ 0 ] == ( char ) 0 )
+                size_t uxHole = ( size_t ) ( ulDNSNameHash[ xRow ] % ( uint32_t ) ipconfigDNS_CACHE_HASH_SIZE );
+                size_t uxNext, uxHome;
+
+                while( ( usDNSHashIndex[ uxHole ] != dnsHASH_EMPTY ) && ( usDNSHashIndex[ uxHole ] != ( uint16_t ) ( xRow + 1 ) ) )
                 {
-                    continue;
+                    uxHole = ( uxHole + 1U ) % ( size_t ) ipconfigDNS_CACHE_HASH_SIZE;
                 }
 
-                if( strcmp( xDNSCache[ x ].pcName, pcName ) == 0 )
+                if( usDNSHashIndex[ uxHole ] != dnsHASH_EMPTY )
                 {
-                    /* Is this function called for a lookup or to add/update an IP address? */
-                    if( xLookUp != pdFALSE )
-                    {
-                        /* Confirm that the record is still fresh. */
-                        if( ulCurrentTimeSeconds < ( xDNSCache[ x ].ulTimeWhenAddedInSeconds + FreeRTOS_ntohl( xDNSCache[ x ].ulTTL ) ) )
-                        {
-                            #if ( ipconfigDNS_CACHE_ADDRESSES_PER_ENTRY > 1 )
-                                uint8_t ucIndex;
+                    uxNext = uxHole;
 
-                                /* The ucCurrentIPAddress value increments without bound and will rollover, */
-                                /*  modulo it by the number of IP addresses to keep it in range.     */
-                                /*  Also perform a final modulo by the max number of IP addresses    */
-                                /*  per DNS cache entry to prevent out-of-bounds access in the event */
-                                /*  that ucNumIPAddresses has been corrupted.                        */
-                                if( xDNSCache[ x ].ucNumIPAddresses == 0 )
-                                {
-                                    /* Trying lookup before cache is updated with the number of IP
-                                     * addressed? Maybe an accident. Break out of the loop. */
-                                    break;
-                                }
+                    for( ; ; )
+                    {
+                        uxNext = ( uxNext + 1U ) % ( size_t ) ipconfigDNS_CACHE_HASH_SIZE;
 
-                                ucIndex = xDNSCache[ x ].ucCurrentIPAddress % xDNSCache[ x ].ucNumIPAddresses;
-                                ucIndex = ucIndex % ( uint8_t ) ipconfigDNS_CACHE_ADDRESSES_PER_ENTRY;
-                                ulIPAddressIndex = ucIndex;
+                        if( usDNSHashIndex[ uxNext ] == dnsHASH_EMPTY )
+                        {
+                            break;
+                        }
 
-                                xDNSCache[ x ].ucCurrentIPAddress++;
-                            #endif /* if ( ipconfigDNS_CACHE_ADDRESSES_PER_ENTRY > 1 ) */
+                        uxHome = ( size_t ) ( ulDNSNameHash[ usDNSHashIndex[ uxNext ] - 1U ] % ( uint32_t ) ipconfigDNS_CACHE_HASH_SIZE );
 
-                            *pulIP = xDNSCache[ x ].ulIPAddresses[ ulIPAddressIndex ];
-                        }
-                        else
+                        /* The entry may only move back to the hole when its home slot
+                         * is not cyclically in ( uxHole, uxNext ]. */
+                        if( ( uxHole <= uxNext ) ? ( ( uxHome <= uxHole ) || ( uxHome > uxNext ) ) :
+                            ( ( uxHome <= uxHole ) && ( uxHome > uxNext ) ) )
                         {
-                            /* Age out the old cached record. */
-                            xDNSCache[ x ].pcName[ 0 ] = ( char ) 0;
+                            usDNSHashIndex[ uxHole ] = usDNSHashIndex[ uxNext ];
+                            uxHole = uxNext;
                         }
                     }
-                    else
-                    {
-                        #if ( ipconfigDNS_CACHE_ADDRESSES_PER_ENTRY > 1 )
-                            if( xDNSCache[ x ].ucNumIPAddresses < ( uint8_t ) ipconfigDNS_CACHE_ADDRESSES_PER_ENTRY )
-                            {
-                                /* If more answers exist than there are IP address storage slots */
-                                /* they will overwrite entry 0 */
 
-                                ulIPAddressIndex = xDNSCache[ x ].ucNumIPAddresses;
-                                xDNSCache[ x ].ucNumIPAddresses++;
-                            }
-                        #endif
-                        xDNSCache[ x ].ulIPAddresses[ ulIPAddressIndex ] = *pulIP;
-                        xDNSCache[ x ].ulTTL = ulTTL;
-                        xDNSCache[ x ].ulTimeWhenAddedInSeconds = ulCurrentTimeSeconds;
+                    usDNSHashIndex[ uxHole ] = dnsHASH_EMPTY;
+                }
+            }
+            /*-----------------------------------------------------------*/
+
+/**
+ * @brief Put all rows in the LRU list, in case that has not been done yet.
+ *        The list is empty after start-up and after FreeRTOS_dnsclear().
+ */
+            static void prvDNSCacheHashInit( void )
+            {
+                BaseType_t x;
+
+                if( usDNSLRUHead == dnsLRU_NONE )
+                {
+                    for( x = 0; x < ipconfigDNS_CACHE_ENTRIES; x++ )
+                    {
+                        usDNSLRUPrev[ x ] = ( x == 0 ) ? dnsLRU_NONE : ( uint16_t ) ( x - 1 );
+                        usDNSLRUNext[ x ] = ( x == ( ipconfigDNS_CACHE_ENTRIES - 1 ) ) ? dnsLRU_NONE : ( uint16_t ) ( x + 1 );
                     }
 
-                    xFound = pdTRUE;
-                    break;
+                    usDNSLRUHead = 0U;
+                    usDNSLRUTail = ( uint16_t ) ( ipconfigDNS_CACHE_ENTRIES - 1 );
                 }
             }
+            /*-----------------------------------------------------------*/
 
-            if( xFound == pdFALSE )
+/**
+ * @brief Take a row out of the LRU list.
+ *
+ * @param[in] xRow: The row.
+ */
+            static void prvDNSLRUDetach( BaseType_t xRow )
             {
-                if( xLookUp != pdFALSE )
+                uint16_t usPrev = usDNSLRUPrev[ xRow ];
+                uint16_t usNext = usDNSLRUNext[ xRow ];
+
+                if( usPrev != dnsLRU_NONE )
                 {
-                    *pulIP = 0UL;
+                    usDNSLRUNext[ usPrev ] = usNext;
                 }
                 else
                 {
-                    /* Add or update the item. */
-                    if( strlen( pcName ) < ( size_t ) ipconfigDNS_CACHE_NAME_LENGTH )
-                    {
-                        ( void ) strcpy( xDNSCache[ xFreeEntry ].pcName, pcName );
-
-                        xDNSCache[ xFreeEntry ].ulIPAddresses[ 0 ] = *pulIP;
-                        xDNSCache[ xFreeEntry ].ulTTL = ulTTL;
-                        xDNSCache[ xFreeEntry ].ulTimeWhenAddedInSeconds = ulCurrentTimeSeconds;
-                        #if ( ipconfigDNS_CACHE_ADDRESSES_PER_ENTRY > 1 )
-                            xDNSCache[ xFreeEntry ].ucNumIPAddresses = 1;
-                            xDNSCache[ xFreeEntry ].ucCurrentIPAddress = 0;
-
-                            /* Initialize all remaining IP addresses in this entry to 0 */
-                            ( void ) memset( &xDNSCache[ xFreeEntry ].ulIPAddresses[ 1 ],
-                                             0,
-                                             sizeof( xDNSCache[ xFreeEntry ].ulIPAddresses[ 1 ] ) *
-                                             ( ( uint32_t ) ipconfigDNS_CACHE_ADDRESSES_PER_ENTRY - 1U ) );
-                        #endif
+                    usDNSLRUHead = usNext;
+                }
 
-                        xFreeEntry++;
+                if( usNext != dnsLRU_NONE )
+                {
+                    usDNSLRUPrev[ usNext ] = usPrev;
+                }
+                else
+                {
+                    usDNSLRUTail = usPrev;
+                }
+            }
+            /*-----------------------------------------------------------*/
 
-                        if( xFreeEntry == ipconfigDNS_CACHE_ENTRIES )
-                        {
-                            xFreeEntry = 0;
-                        }
-                    }
+/**
+ * @brief Make a row the most recently used one.
+ *
+ * @param[in] xRow: The row that was used.
+ */
+            static void prvDNSTouch( BaseType_t xRow )
+            {
+                if( usDNSLRUHead != ( uint16_t ) xRow )
+                {
+                    prvDNSLRUDetach( xRow );
+                    usDNSLRUPrev[ xRow ] = dnsLRU_NONE;
+                    usDNSLRUNext[ xRow ] = usDNSLRUHead;
+                    usDNSLRUPrev[ usDNSLRUHead ] = ( uint16_t ) xRow;
+                    usDNSLRUHead = ( uint16_t ) xRow;
                 }
             }
+            /*-----------------------------------------------------------*/
 
-            if( ( xLookUp == 0 ) || ( *pulIP != 0UL ) )
+/**
+ * @brief Move a row that has been cleared to the tail of the LRU list, so
+ *        that it is the first one to be re-used.
+ *
+ * @param[in] xRow: The row that was cleared.
+ */
+            static void prvDNSRelease( BaseType_t xRow )
             {
-                FreeRTOS_debug_printf( ( "prvProcessDNSCache: %s: '%s' @ %lxip\n", ( xLookUp != 0 ) ? "look-up" : "add", pcName, FreeRTOS_ntohl( *pulIP ) ) );
+                if( usDNSLRUTail != ( uint16_t ) xRow )
+                {
+                    prvDNSLRUDetach( xRow );
+                    usDNSLRUNext[ xRow ] = dnsLRU_NONE;
+                    usDNSLRUPrev[ xRow ] = usDNSLRUTail;
+                    usDNSLRUNext[ usDNSLRUTail ] = ( uint16_t ) xRow;
+                    usDNSLRUTail = ( uint16_t ) xRow;
+                }
             }
+            /*-----------------------------------------------------------*/
 
-            return xFound;
-        }
+        #endif /* ipconfigUSE_DNS_CACHE_HASH */
 
     #endif /* ipconfigUSE_DNS_CACHE */
 
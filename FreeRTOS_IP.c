@@ -87,16 +87,6 @@
     #define ipARP_RESOLUTION_MAX_DELAY    ( pdMS_TO_TICKS( 2000U ) )
 #endif
 
-/** @brief Defines how often the ARP timer callback function is executed.  The time is
- * shorter in the Windows simulator as simulated time is not real time. */
-#ifndef ipARP_TIMER_PERIOD_MS
-    #ifdef _WINDOWS_
-        #define ipARP_TIMER_PERIOD_MS    ( 500U ) /* For windows simulator builds. */
-    #else
-        #define ipARP_TIMER_PERIOD_MS    ( 10000U )
-    #endif
-#endif
-
 #ifndef iptraceIP_TASK_STARTING
     #define iptraceIP_TASK_STARTING()    do {} while( ipFALSE_BOOL ) /**< Empty definition in case iptraceIP_TASK_STARTING is not defined. */
 #endif
@@ -126,6 +116,23 @@
     #define ipconfigMAX_IP_TASK_SLEEP_TIME    ( pdMS_TO_TICKS( 10000UL ) )
 #endif
 
+#if ( ipconfigBUFFER_PRESSURE_DRIVER_HOOK == 1 ) && ( ipconfigUSE_BUFFER_PRESSURE != 1 )
+    #error ipconfigBUFFER_PRESSURE_DRIVER_HOOK requires ipconfigUSE_BUFFER_PRESSURE
+#endif
+
+#if ( ipconfigUSE_BUFFER_PRESSURE == 1 )
+    #if ( ipconfigBUFFER_CRITICAL_WATERMARK >= ipconfigBUFFER_LOW_WATERMARK ) || ( ipconfigBUFFER_LOW_WATERMARK >= ipconfigBUFFER_HIGH_WATERMARK )
+        #error ipconfigBUFFER_CRITICAL_WATERMARK < ipconfigBUFFER_LOW_WATERMARK < ipconfigBUFFER_HIGH_WATERMARK is required
+    #endif
+#endif
+
+#if ( ipconfigBUFFER_PRESSURE_DRIVER_HOOK == 1 )
+
+/** @brief While under buffer pressure, the IP-task checks at least this often
+ * whether the pressure is over, so that the driver can resume reception. */
+    #define ipBUFFER_PRESSURE_CHECK_TIME    ( pdMS_TO_TICKS( 10U ) )
+#endif
+
 /** @brief Returned as the (invalid) checksum when the protocol being checked is not
  * handled.  The value is chosen simply to be easy to spot when debugging. */
 #define ipUNHANDLED_PROTOCOL    0x4321U
@@ -295,6 +302,23 @@ static eFrameProcessingResult_t prvAllowIPPacket( const IPPacket_t * const pxIPP
 static NetworkBufferDescriptor_t * prvPacketBuffer_to_NetworkBuffer( const void * pvBuffer,
                                                                      size_t uxOffset );
 
+#if ( ipconfigUSE_BUFFER_PRESSURE == 1 )
+
+/*
+ * Report a change of the pressure on the pool of network buffers.
+ */
+    static void prvCheckBufferPressure( void );
+#endif
+
+#if ( ipconfigUSE_NETWORK_BUFFER_CLONES == 1 )
+
+/*
+ * Drop one reference to a network buffer, must be called with interrupts masked.
+ */
+    static BaseType_t prvDropReference( NetworkBufferDescriptor_t * pxNetworkBuffer,
+                                        NetworkBufferDescriptor_t ** ppxOwner );
+#endif
+
 /*-----------------------------------------------------------*/
 
 /** @brief The queue used to pass events into the IP-task for processing. */
@@ -369,6 +393,22 @@ static BaseType_t xIPTaskInitialised = pdFALSE;
     static UBaseType_t uxQueueMinimumSpace = ipconfigEVENT_QUEUE_LENGTH;
 #endif
 
+#if ( ipconfigUSE_BUFFER_PRESSURE == 1 )
+    /** @brief The current pressure on the pool of network buffers. */
+    static volatile eBufferPressure_t eBufferPressure = eBufferPressureNone;
+
+    /** @brief The pressure as last reported to the network interface. */
+    static eBufferPressure_t eReportedPressure = eBufferPressureNone;
+#endif
+
+#if ( ipconfigUSE_NETWORK_BUFFER_CLONES == 1 )
+    /** @brief The descriptors used for clones.  A clone is free when its 'pxParent' is NULL. */
+    static NetworkBufferDescriptor_t xCloneDescriptors[ ipconfigNUM_NETWORK_BUFFER_CLONES ];
+
+    /** @brief The number of clone descriptors in use. */
+    static UBaseType_t uxClonesInUse = 0U;
+#endif
+
 /*-----------------------------------------------------------*/
 
 /* Coverity wants to make pvParameters const, which would make it incompatible. Leave the
@@ -395,6 +435,14 @@ static void prvIPTask( void * pvParameters )
     /* A possibility to set some additional task properties. */
     iptraceIP_TASK_STARTING();
 
+    #if ( ipconfigBUFFER_ALLOC_LOCK_FREE == 1 )
+        {
+            /* The IP-task obtains and releases most network buffers, let it
+             * use a private cache. */
+            ( void ) xNetworkBufferCacheRegister();
+        }
+    #endif
+
     /* Generate a dummy message to say that the network connection has gone
      *  down.  This will cause this task to initialise the network interface.  After
      *  this it is the responsibility of the network interface hardware driver to
@@ -425,6 +473,12 @@ static void prvIPTask( void * pvParameters )
          * or timeout processing to perform. */
         prvCheckNetworkTimers();
 
+        #if ( ipconfigUSE_BUFFER_PRESSURE == 1 )
+            {
+                prvCheckBufferPressure();
+            }
+        #endif
+
         /* Calculate the acceptable maximum sleep time. */
         xNextIPSleep = prvCalculateSleepTime();
 
@@ -612,7 +666,11 @@ static void prvIPTask( void * pvParameters )
 
                         iptraceMEM_STATS_DELETE( pxSocketSet );
                         vEventGroupDelete( pxSocketSet->xSelectGroup );
-                        vPortFree( ( void * ) pxSocketSet );
+                        #if ( ipconfigUSE_STATIC_POOLS == 1 )
+                            vSocketSetRelease( pxSocketSet );
+                        #else
+                            vPortFree( ( void * ) pxSocketSet );
+                        #endif
                     }
                 #endif /* ipconfigSUPPORT_SELECT_FUNCTION == 1 */
                 break;
@@ -677,6 +735,28 @@ TaskHandle_t FreeRTOS_GetIPTaskHandle( void )
 }
 /*-----------------------------------------------------------*/
 
+/**
+ * @brief Get the identification for the next outgoing IP packet.  Connected
+ *        UDP sockets fill in their packets in the calling task, so the
+ *        counter is shared with the IP-task and must be updated atomically.
+ *
+ * @return The identification in host-endian order.
+ */
+uint16_t usGetNextPacketIdentifier( void )
+{
+    uint16_t usIdentifier;
+
+    taskENTER_CRITICAL();
+    {
+        usIdentifier = usPacketIdentifier;
+        usPacketIdentifier++;
+    }
+    taskEXIT_CRITICAL();
+
+    return usIdentifier;
+}
+/*-----------------------------------------------------------*/
+
 /**
  * @brief Handle the incoming Ethernet packets.
  *
@@ -777,6 +857,19 @@ static TickType_t prvCalculateSleepTime( void )
         }
     #endif
 
+    #if ( ipconfigBUFFER_PRESSURE_DRIVER_HOOK == 1 )
+        {
+            /* The end of the pressure must be noticed, even when no events
+             * arrive because the driver has paused reception.  Without the
+             * driver hook, nothing waits for that, so there is no need to
+             * wake up. */
+            if( ( eReportedPressure != eBufferPressureNone ) && ( ipBUFFER_PRESSURE_CHECK_TIME < xMaximumSleepTime ) )
+            {
+                xMaximumSleepTime = ipBUFFER_PRESSURE_CHECK_TIME;
+            }
+        }
+    #endif
+
     return xMaximumSleepTime;
 }
 /*-----------------------------------------------------------*/
@@ -1093,6 +1186,527 @@ NetworkBufferDescriptor_t * pxDuplicateNetworkBufferWithDescriptor( const Networ
 }
 /*-----------------------------------------------------------*/
 
+#if ( ipconfigUSE_NETWORK_BUFFER_CLONES == 1 )
+
+/**
+ * @brief Create a second descriptor for the Ethernet frame of a network buffer,
+ *        without copying the frame.  The clone has its own length and addresses,
+ *        the frame is returned to the pool when both the clone and the original
+ *        have been released with vReleaseNetworkBufferAndDescriptor().  As long
+ *        as the frame is shared, it should be treated as read-only.
+ *
+ * @param[in] pxNetworkBuffer: The network buffer, or a clone of it.
+ *
+ * @return The clone, or NULL when all clone descriptors are in use.
+ */
+    NetworkBufferDescriptor_t * pxCloneNetworkBufferWithDescriptor( NetworkBufferDescriptor_t * const pxNetworkBuffer )
+    {
+        NetworkBufferDescriptor_t * pxOwner = pxNetworkBuffer;
+        NetworkBufferDescriptor_t * pxClone = NULL;
+        UBaseType_t uxIndex;
+
+        /* A clone of a clone shares the frame of the same owner. */
+        if( pxOwner->pxParent != NULL )
+        {
+            pxOwner = pxOwner->pxParent;
+        }
+
+        #if ( ipconfigTCP_IP_SANITY != 0 )
+            if( ( bIsValidNetworkDescriptor( pxOwner ) == pdFALSE_UNSIGNED ) || ( prvIsFreeBuffer( pxOwner ) != pdFALSE ) )
+            {
+                FreeRTOS_debug_printf( ( "pxCloneNetworkBufferWithDescriptor: %p is not owned by anyone\n", pxNetworkBuffer ) );
+            }
+            else
+        #endif
+        {
+            taskENTER_CRITICAL();
+            {
+                for( uxIndex = 0U; ( uxIndex < ( UBaseType_t ) ipconfigNUM_NETWORK_BUFFER_CLONES ) && ( pxClone == NULL ); uxIndex++ )
+                {
+                    if( xCloneDescriptors[ uxIndex ].pxParent == NULL )
+                    {
+                        pxClone = &( xCloneDescriptors[ uxIndex ] );
+                        pxClone->pxParent = pxOwner;
+                        pxOwner->uxReferenceCount++;
+                        uxClonesInUse++;
+                    }
+                }
+            }
+            taskEXIT_CRITICAL();
+        }
+
+        if( pxClone != NULL )
+        {
+            /* The clone may be queued just like a normal network buffer. */
+            vListInitialiseItem( &( pxClone->xBufferListItem ) );
+            listSET_LIST_ITEM_OWNER( &( pxClone->xBufferListItem ), ( void * ) pxClone );
+
+            pxClone->pucEthernetBuffer = pxNetworkBuffer->pucEthernetBuffer;
+            pxClone->xDataLength = pxNetworkBuffer->xDataLength;
+            pxClone->ulIPAddress = pxNetworkBuffer->ulIPAddress;
+            pxClone->usPort = pxNetworkBuffer->usPort;
+            pxClone->usBoundPort = pxNetworkBuffer->usBoundPort;
+            pxClone->uxReferenceCount = 0U;
+            #if ( ipconfigBUFFER_HEADROOM != 0 )
+                {
+                    pxClone->lFrameOffset = pxNetworkBuffer->lFrameOffset;
+                }
+            #endif
+            #if ( ipconfigUSE_LINKED_RX_MESSAGES != 0 )
+                {
+                    pxClone->pxNextBuffer = NULL;
+                }
+            #endif
+        }
+
+        return pxClone;
+    }
+    /*-----------------------------------------------------------*/
+
+/**
+ * @brief Check if the Ethernet frame of a network buffer has more than one owner.
+ *
+ * @param[in] pxNetworkBuffer: The network buffer or a clone of it.
+ *
+ * @return pdTRUE when the frame is shared, otherwise pdFALSE.
+ */
+    BaseType_t xIsNetworkBufferShared( const NetworkBufferDescriptor_t * pxNetworkBuffer )
+    {
+        const NetworkBufferDescriptor_t * pxOwner = pxNetworkBuffer;
+        BaseType_t xReturn = pdFALSE;
+
+        if( pxOwner->pxParent != NULL )
+        {
+            pxOwner = pxOwner->pxParent;
+        }
+
+        if( pxOwner->uxReferenceCount != 0U )
+        {
+            xReturn = pdTRUE;
+        }
+
+        return xReturn;
+    }
+    /*-----------------------------------------------------------*/
+
+/**
+ * @brief Get the number of clone descriptors that are not in use.
+ *
+ * @return The number of free clone descriptors.
+ */
+    UBaseType_t uxGetNumberOfFreeNetworkBufferClones( void )
+    {
+        return ( UBaseType_t ) ipconfigNUM_NETWORK_BUFFER_CLONES - uxClonesInUse;
+    }
+    /*-----------------------------------------------------------*/
+
+/**
+ * @brief Drop one reference to the frame of a network buffer.  Must be called
+ *        with interrupts masked.
+ *
+ * @param[in] pxNetworkBuffer: The network buffer or clone being released.
+ * @param[out] ppxOwner: Set to the owner of the frame when a clone held the
+ *                       last reference, otherwise NULL.
+ *
+ * @return pdTRUE when pxNetworkBuffer itself must be returned to the pool.
+ */
+    static BaseType_t prvDropReference( NetworkBufferDescriptor_t * pxNetworkBuffer,
+                                        NetworkBufferDescriptor_t ** ppxOwner )
+    {
+        NetworkBufferDescriptor_t * pxOwner;
+        UBaseType_t uxIndex;
+        BaseType_t xReturn = pdFALSE;
+
+        *ppxOwner = NULL;
+
+        if( ( pxNetworkBuffer < &( xCloneDescriptors[ 0 ] ) ) ||
+            ( pxNetworkBuffer >= &( xCloneDescriptors[ ipconfigNUM_NETWORK_BUFFER_CLONES ] ) ) )
+        {
+            if( pxNetworkBuffer->uxReferenceCount != 0U )
+            {
+                pxNetworkBuffer->uxReferenceCount--;
+            }
+            else
+            {
+                /* This was the last reference.  A driver that looked up the
+                 * descriptor of a cloned frame with pxPacketBuffer_to_NetworkBuffer()
+                 * has released the owner instead of the clone: free those
+                 * clones now. */
+                for( uxIndex = 0U; ( uxIndex < ( UBaseType_t ) ipconfigNUM_NETWORK_BUFFER_CLONES ) && ( uxClonesInUse != 0U ); uxIndex++ )
+                {
+                    if( xCloneDescriptors[ uxIndex ].pxParent == pxNetworkBuffer )
+                    {
+                        xCloneDescriptors[ uxIndex ].pxParent = NULL;
+                        uxClonesInUse--;
+                    }
+                }
+
+                xReturn = pdTRUE;
+            }
+        }
+        else if( pxNetworkBuffer->pxParent != NULL )
+        {
+            pxOwner = pxNetworkBuffer->pxParent;
+            pxNetworkBuffer->pxParent = NULL;
+            uxClonesInUse--;
+
+            if( pxOwner->uxReferenceCount != 0U )
+            {
+                pxOwner->uxReferenceCount--;
+            }
+            else
+            {
+                /* The owner was released already, and this clone held the
+                 * last reference. */
+                *ppxOwner = pxOwner;
+            }
+        }
+        else
+        {
+            /* The clone was released twice, see xNetworkBufferDropReference(). */
+        }
+
+        return xReturn;
+    }
+    /*-----------------------------------------------------------*/
+
+/**
+ * @brief Drop one reference to the frame of a network buffer.  This function
+ *        is called by vReleaseNetworkBufferAndDescriptor() of the buffer
+ *        allocators.
+ *
+ * @param[in] pxNetworkBuffer: The network buffer or clone being released.
+ *
+ * @return pdTRUE when pxNetworkBuffer must be returned to the pool.
+ */
+    BaseType_t xNetworkBufferDropReference( NetworkBufferDescriptor_t * const pxNetworkBuffer )
+    {
+        NetworkBufferDescriptor_t * pxOwner;
+        BaseType_t xReturn;
+
+        #if ( ipconfigTCP_IP_SANITY != 0 )
+            {
+                if( ( pxNetworkBuffer >= &( xCloneDescriptors[ 0 ] ) ) &&
+                    ( pxNetworkBuffer < &( xCloneDescriptors[ ipconfigNUM_NETWORK_BUFFER_CLONES ] ) ) &&
+                    ( pxNetworkBuffer->pxParent == NULL ) )
+                {
+                    FreeRTOS_debug_printf( ( "vReleaseNetworkBufferAndDescriptor: clone %p ALREADY RELEASED (%lu clones in use)\n",
+                                             pxNetworkBuffer, uxClonesInUse ) );
+                }
+            }
+        #endif /* ipconfigTCP_IP_SANITY */
+
+        taskENTER_CRITICAL();
+        {
+            xReturn = prvDropReference( pxNetworkBuffer, &pxOwner );
+        }
+        taskEXIT_CRITICAL();
+
+        if( pxOwner != NULL )
+        {
+            vReleaseNetworkBufferAndDescriptor( pxOwner );
+        }
+
+        return xReturn;
+    }
+    /*-----------------------------------------------------------*/
+
+/**
+ * @brief The same as xNetworkBufferDropReference(), but to be called from an ISR.
+ *
+ * @param[in] pxNetworkBuffer: The network buffer or clone being released.
+ * @param[in,out] pxHigherPriorityTaskWoken: Set to pdTRUE when releasing the
+ *                owner has woken up a task.
+ *
+ * @return pdTRUE when pxNetworkBuffer must be returned to the pool.
+ */
+    BaseType_t xNetworkBufferDropReferenceFromISR( NetworkBufferDescriptor_t * const pxNetworkBuffer,
+                                                   BaseType_t * pxHigherPriorityTaskWoken )
+    {
+        NetworkBufferDescriptor_t * pxOwner;
+        BaseType_t xReturn;
+        UBaseType_t uxSavedInterruptStatus;
+
+        uxSavedInterruptStatus = ( UBaseType_t ) portSET_INTERRUPT_MASK_FROM_ISR();
+        {
+            xReturn = prvDropReference( pxNetworkBuffer, &pxOwner );
+        }
+        portCLEAR_INTERRUPT_MASK_FROM_ISR( uxSavedInterruptStatus );
+
+        if( pxOwner != NULL )
+        {
+            if( vNetworkBufferReleaseFromISR( pxOwner ) != pdFALSE )
+            {
+                *pxHigherPriorityTaskWoken = pdTRUE;
+            }
+        }
+
+        return xReturn;
+    }
+    /*-----------------------------------------------------------*/
+
+#endif /* ipconfigUSE_NETWORK_BUFFER_CLONES */
+
+#if ( ipconfigUSE_BUFFER_PRESSURE == 1 )
+
+/**
+ * @brief Get the pressure on the pool of network buffers.  The pressure becomes
+ *        high or critical when the number of free buffers drops to the low or
+ *        the critical watermark, and it is over when the number has risen to
+ *        the high watermark again.  The buffers in the per-task caches of
+ *        ipconfigBUFFER_ALLOC_LOCK_FREE are counted as free, because
+ *        uxGetNumberOfFreeNetworkBuffers() includes them: their owners, the
+ *        IP-task and the drivers, can still use them.
+ *
+ * @return The current pressure.
+ */
+    eBufferPressure_t eGetNetworkBufferPressure( void )
+    {
+        UBaseType_t uxFree = uxGetNumberOfFreeNetworkBuffers();
+        eBufferPressure_t eState = eBufferPressure;
+
+        if( uxFree <= ( UBaseType_t ) ipconfigBUFFER_CRITICAL_WATERMARK )
+        {
+            eState = eBufferPressureCritical;
+        }
+        else if( uxFree <= ( UBaseType_t ) ipconfigBUFFER_LOW_WATERMARK )
+        {
+            eState = eBufferPressureHigh;
+        }
+        else if( uxFree >= ( UBaseType_t ) ipconfigBUFFER_HIGH_WATERMARK )
+        {
+            eState = eBufferPressureNone;
+        }
+        else if( eState == eBufferPressureCritical )
+        {
+            /* Between the low and the high watermark: keep the pressure, but
+             * it is not critical any more. */
+            eState = eBufferPressureHigh;
+        }
+        else
+        {
+            /* Keep the current state. */
+        }
+
+        eBufferPressure = eState;
+
+        return eState;
+    }
+    /*-----------------------------------------------------------*/
+
+/**
+ * @brief Called by the IP-task: when the pressure on the pool of network buffers
+ *        has changed, tell the network interface.
+ */
+    static void prvCheckBufferPressure( void )
+    {
+        eBufferPressure_t eState = eGetNetworkBufferPressure();
+
+        if( eState != eReportedPressure )
+        {
+            iptraceBUFFER_PRESSURE_CHANGED( eReportedPressure, eState );
+            FreeRTOS_debug_printf( ( "Buffer pressure %d -> %d (%lu free)\n",
+                                     ( int ) eReportedPressure,
+                                     ( int ) eState,
+                                     uxGetNumberOfFreeNetworkBuffers() ) );
+            eReportedPressure = eState;
+
+            #if ( ipconfigBUFFER_PRESSURE_DRIVER_HOOK == 1 )
+                {
+                    vNetworkInterfaceBufferPressure( eState );
+                }
+            #endif
+        }
+    }
+    /*-----------------------------------------------------------*/
+
+#endif /* ipconfigUSE_BUFFER_PRESSURE */
+
+#if ( ipconfigBUFFER_HEADROOM != 0 )
+
+/* The number of bytes in front of a frame in its default position.  The first
+ * bytes of the storage hold a pointer to the descriptor. */
+    #define ipDEFAULT_HEADROOM    ( ( int32_t ) ( ipBUFFER_PADDING - sizeof( NetworkBufferDescriptor_t * ) ) )
+
+/**
+ * @brief Prepend bytes to the frame of a network buffer, e.g. a VLAN tag or a
+ *        tunnel header.  The frame must not be shared with a clone.  Note that
+ *        pxPacketBuffer_to_NetworkBuffer() can only find the descriptor of a
+ *        frame that is in its default position.
+ *
+ * @param[in] pxNetworkBuffer: The network buffer.
+ * @param[in] uxLength: The number of bytes to prepend.
+ *
+ * @return The new start of the frame, or NULL when the headroom is too small.
+ */
+    uint8_t * pucNetworkBufferPush( NetworkBufferDescriptor_t * const pxNetworkBuffer,
+                                    size_t uxLength )
+    {
+        uint8_t * pucReturn = NULL;
+
+        #if ( ipconfigUSE_NETWORK_BUFFER_CLONES == 1 )
+            if( xIsNetworkBufferShared( pxNetworkBuffer ) != pdFALSE )
+            {
+                /* The headroom is shared as well. */
+            }
+            else
+        #endif
+        if( uxLength <= uxNetworkBufferHeadroom( pxNetworkBuffer ) )
+        {
+            pxNetworkBuffer->pucEthernetBuffer = &( pxNetworkBuffer->pucEthernetBuffer[ -( ( int32_t ) uxLength ) ] );
+            pxNetworkBuffer->xDataLength += uxLength;
+            pxNetworkBuffer->lFrameOffset -= ( int32_t ) uxLength;
+            pucReturn = pxNetworkBuffer->pucEthernetBuffer;
+        }
+        else
+        {
+            /* Not enough headroom. */
+        }
+
+        return pucReturn;
+    }
+    /*-----------------------------------------------------------*/
+
+/**
+ * @brief Remove bytes from the start of the frame of a network buffer, e.g. to
+ *        strip an encapsulation header of a received frame.
+ *
+ * @param[in] pxNetworkBuffer: The network buffer.
+ * @param[in] uxLength: The number of bytes to remove.
+ *
+ * @return The new start of the frame, or NULL when the frame is too short.
+ */
+    uint8_t * pucNetworkBufferPull( NetworkBufferDescriptor_t * const pxNetworkBuffer,
+                                    size_t uxLength )
+    {
+        uint8_t * pucReturn = NULL;
+
+        if( uxLength <= pxNetworkBuffer->xDataLength )
+        {
+            pxNetworkBuffer->pucEthernetBuffer = &( pxNetworkBuffer->pucEthernetBuffer[ uxLength ] );
+            pxNetworkBuffer->xDataLength -= uxLength;
+            pxNetworkBuffer->lFrameOffset += ( int32_t ) uxLength;
+            pucReturn = pxNetworkBuffer->pucEthernetBuffer;
+        }
+
+        return pucReturn;
+    }
+    /*-----------------------------------------------------------*/
+
+/**
+ * @brief Append bytes to the end of the frame of a network buffer, e.g. a
+ *        trailer or a checksum.  The frame must not be shared with a clone.
+ *
+ * @param[in] pxNetworkBuffer: The network buffer.
+ * @param[in] uxLength: The number of bytes to append.
+ *
+ * @return A pointer to the appended bytes, or NULL when the tailroom is too small.
+ */
+    uint8_t * pucNetworkBufferPut( NetworkBufferDescriptor_t * const pxNetworkBuffer,
+                                   size_t uxLength )
+    {
+        uint8_t * pucReturn = NULL;
+
+        #if ( ipconfigUSE_NETWORK_BUFFER_CLONES == 1 )
+            if( xIsNetworkBufferShared( pxNetworkBuffer ) != pdFALSE )
+            {
+                /* The tailroom is shared as well. */
+            }
+            else
+        #endif
+        if( uxLength <= uxNetworkBufferTailroom( pxNetworkBuffer ) )
+        {
+            pucReturn = &( pxNetworkBuffer->pucEthernetBuffer[ pxNetworkBuffer->xDataLength ] );
+            pxNetworkBuffer->xDataLength += uxLength;
+        }
+        else
+        {
+            /* Not enough tailroom. */
+        }
+
+        return pucReturn;
+    }
+    /*-----------------------------------------------------------*/
+
+/**
+ * @brief Move the start of the frame so that exactly uxHeadroom bytes are in
+ *        front of it.  The contents are not moved, so this should be called
+ *        before the buffer is filled.  A driver can use it to receive an
+ *        encapsulated frame in such a way that, once the encapsulation is
+ *        pulled, the Ethernet frame is in its default position.
+ *
+ * @param[in] pxNetworkBuffer: The network buffer.
+ * @param[in] uxHeadroom: The number of bytes wanted in front of the frame.
+ *
+ * @return pdPASS when the frame was moved, pdFAIL when the buffer is too small.
+ */
+    BaseType_t xNetworkBufferReserve( NetworkBufferDescriptor_t * const pxNetworkBuffer,
+                                      size_t uxHeadroom )
+    {
+        BaseType_t xReturn = pdFAIL;
+        int32_t lNewOffset = ( int32_t ) uxHeadroom - ipDEFAULT_HEADROOM;
+
+        if( ( lNewOffset + ( int32_t ) pxNetworkBuffer->xDataLength ) <= ( int32_t ) uxGetNetworkBufferCapacity( pxNetworkBuffer ) )
+        {
+            pxNetworkBuffer->pucEthernetBuffer = &( pxNetworkBuffer->pucEthernetBuffer[ lNewOffset - pxNetworkBuffer->lFrameOffset ] );
+            pxNetworkBuffer->lFrameOffset = lNewOffset;
+            xReturn = pdPASS;
+        }
+
+        return xReturn;
+    }
+    /*-----------------------------------------------------------*/
+
+/**
+ * @brief Get the number of bytes in front of the frame of a network buffer.
+ *
+ * @param[in] pxNetworkBuffer: The network buffer.
+ *
+ * @return The headroom in bytes.
+ */
+    size_t uxNetworkBufferHeadroom( const NetworkBufferDescriptor_t * pxNetworkBuffer )
+    {
+        return ( size_t ) ( ipDEFAULT_HEADROOM + pxNetworkBuffer->lFrameOffset );
+    }
+    /*-----------------------------------------------------------*/
+
+/**
+ * @brief Get the number of bytes behind the frame of a network buffer.
+ *
+ * @param[in] pxNetworkBuffer: The network buffer.
+ *
+ * @return The tailroom in bytes.
+ */
+    size_t uxNetworkBufferTailroom( const NetworkBufferDescriptor_t * pxNetworkBuffer )
+    {
+        int32_t lTailroom = ( int32_t ) uxGetNetworkBufferCapacity( pxNetworkBuffer ) -
+                            pxNetworkBuffer->lFrameOffset -
+                            ( int32_t ) pxNetworkBuffer->xDataLength;
+
+        if( lTailroom < 0 )
+        {
+            lTailroom = 0;
+        }
+
+        return ( size_t ) lTailroom;
+    }
+    /*-----------------------------------------------------------*/
+
+/**
+ * @brief Move the frame of a network buffer back to its default position.
+ *        The buffer allocators call this when a buffer is handed out.
+ *
+ * @param[in] pxNetworkBuffer: The network buffer.
+ */
+    void vNetworkBufferResetFrame( NetworkBufferDescriptor_t * const pxNetworkBuffer )
+    {
+        pxNetworkBuffer->pucEthernetBuffer = &( pxNetworkBuffer->pucEthernetBuffer[ -( pxNetworkBuffer->lFrameOffset ) ] );
+        pxNetworkBuffer->lFrameOffset = 0;
+    }
+    /*-----------------------------------------------------------*/
+
+#endif /* ipconfigBUFFER_HEADROOM */
+
 /**
  * @brief Get the network buffer descriptor from the packet buffer.
  *
@@ -1293,6 +1907,13 @@ BaseType_t FreeRTOS_IPInit( const uint8_t ucIPAddress[ ipIP_ADDRESS_LENGTH_BYTES
             /* Prepare the sockets interface. */
             vNetworkSocketsInit();
 
+            #if ( ipconfigUSE_STATIC_POOLS == 1 )
+                {
+                    /* Report the memory that the static pools occupy. */
+                    FreeRTOS_PrintPoolUsage();
+                }
+            #endif
+
             /* Create the task that processes Ethernet and stack events. */
             #if ( configSUPPORT_STATIC_ALLOCATION == 1 )
                 {
@@ -1413,6 +2034,9 @@ void FreeRTOS_SetAddressConfiguration( const uint32_t * pulIPAddress,
     {
         xNetworkAddressing.ulDNSServerAddress = *pulDNSServerAddress;
     }
+
+    /* The route to a host may have changed. */
+    vARPIncrementGeneration();
 }
 /*-----------------------------------------------------------*/
 
@@ -1754,6 +2378,9 @@ void vIPNetworkUpCalls( void )
 {
     xNetworkUp = pdTRUE;
 
+    /* The addressing may have changed, cached MAC-addresses must be checked. */
+    vARPIncrementGeneration();
+
     #if ( ipconfigUSE_NETWORK_EVENT_HOOK == 1 )
         {
             vApplicationIPNetworkEventHook( eNetworkUp );
@@ -3349,6 +3976,7 @@ uint32_t FreeRTOS_GetIPAddress( void )
 void FreeRTOS_SetIPAddress( uint32_t ulIPAddress )
 {
     *ipLOCAL_IP_ADDRESS_POINTER = ulIPAddress;
+    vARPIncrementGeneration();
 }
 /*-----------------------------------------------------------*/
 
@@ -3395,6 +4023,7 @@ void FreeRTOS_UpdateMACAddress( const uint8_t ucMACAddress[ ipMAC_ADDRESS_LENGTH
 {
     /* Copy the MAC address at the start of the default packet header fragment. */
     ( void ) memcpy( ipLOCAL_MAC_ADDRESS, ucMACAddress, ( size_t ) ipMAC_ADDRESS_LENGTH_BYTES );
+    vARPIncrementGeneration();
 }
 /*-----------------------------------------------------------*/
 
@@ -3417,6 +4046,7 @@ const uint8_t * FreeRTOS_GetMACAddress( void )
 void FreeRTOS_SetNetmask( uint32_t ulNetmask )
 {
     xNetworkAddressing.ulNetMask = ulNetmask;
+    vARPIncrementGeneration();
 }
 /*-----------------------------------------------------------*/
 
@@ -3428,6 +4058,7 @@ void FreeRTOS_SetNetmask( uint32_t ulNetmask )
 void FreeRTOS_SetGatewayAddress( uint32_t ulGatewayAddress )
 {
     xNetworkAddressing.ulGatewayAddress = ulGatewayAddress;
+    vARPIncrementGeneration();
 }
 /*-----------------------------------------------------------*/
 
@@ -3484,6 +4115,25 @@ void vIPSetARPResolutionTimerEnableState( BaseType_t xEnableState )
 #endif /* ipconfigUSE_DHCP */
 /*-----------------------------------------------------------*/
 
+#if ( ipconfigUSE_ARP_DEADLINE_AGING == 1 )
+
+/**
+ * @brief Reload the ARP timer, so that vARPAgeCache() is called when the
+ *        next ARP entry is due.
+ *
+ * @param[in] xTime: The number of clock ticks until the next call.
+ */
+    void vIPReloadARPTimer( TickType_t xTime )
+    {
+        /* While the network is down, the timer stays stopped. */
+        if( xARPTimer.bActive != pdFALSE_UNSIGNED )
+        {
+            prvIPTimerReload( &xARPTimer, xTime );
+        }
+    }
+#endif /* ipconfigUSE_ARP_DEADLINE_AGING */
+/*-----------------------------------------------------------*/
+
 #if ( ipconfigDNS_USE_CALLBACKS == 1 )
 
 /**
@@ -84,6 +84,107 @@
 /** @brief A block time of 0 simply means "don't block". */
 #define socketDONT_BLOCK                         ( ( TickType_t ) 0 )
 
+/** @brief The number of bytes used by the event group of a socket, for the memory statistics. */
+#if ( ipconfigSOCKET_USES_NOTIFY == 0 )
+    #define socketEVENT_GROUP_SIZE    sizeof( StaticEventGroup_t )
+#else
+    #define socketEVENT_GROUP_SIZE    0U
+#endif
+
+#if ( ipconfigSOCKET_USES_NOTIFY != 0 )
+
+/** @brief Wake up a task that is blocked on a socket, using the notification
+ *         index 'ipconfigSOCKET_NOTIFY_INDEX'. */
+    #define socketNOTIFY_GIVE( xTask )           xTaskNotifyGiveIndexed( ( xTask ), ipconfigSOCKET_NOTIFY_INDEX )
+    #define socketNOTIFY_TAKE( xTicksToWait )    ulTaskNotifyTakeIndexed( ipconfigSOCKET_NOTIFY_INDEX, pdTRUE, ( xTicksToWait ) )
+#endif /* ipconfigSOCKET_USES_NOTIFY */
+
+#if ( ipconfigUSE_SOCKET_POOL == 1 )
+    #if ( ( ipconfigSOCKET_USES_NOTIFY == 0 ) && ( configSUPPORT_STATIC_ALLOCATION != 1 ) )
+        #error ipconfigUSE_SOCKET_POOL requires either configSUPPORT_STATIC_ALLOCATION or ipconfigSOCKET_USES_NOTIFY
+    #endif
+
+/** @brief The number of size_t words needed for a stream buffer in the pool,
+ *         which can store at most ipconfigSOCKET_POOL_STREAM_SIZE bytes. */
+    #define socketPOOL_STREAM_WORDS    ( ( ( sizeof( StreamBuffer_t ) + ( size_t ) ipconfigSOCKET_POOL_STREAM_SIZE ) + ( sizeof( size_t ) - 1U ) ) / sizeof( size_t ) )
+#endif /* ipconfigUSE_SOCKET_POOL */
+
+#if ( ipconfigUSE_TCP_RX_CHAIN == 1 )
+    #if ( ipconfigUSE_TCP != 1 )
+        #error ipconfigUSE_TCP_RX_CHAIN requires ipconfigUSE_TCP
+    #endif
+
+    #if ( ipconfigTCP_RX_CHAIN_LENGTH < 3 )
+        #error ipconfigTCP_RX_CHAIN_LENGTH must be at least 3
+    #endif
+
+/** @brief The size of the network buffer that receives a copy of the headers
+ *         of an adopted frame: Ethernet, IP and TCP headers, including options. */
+    #define socketRX_CHAIN_HEADER_SIZE    ( ipSIZE_OF_ETH_HEADER + 60U + 60U )
+
+/** @brief A network buffer that is kept in the RX chain of a TCP socket. */
+    typedef struct xRX_CHAIN_LINK
+    {
+        NetworkBufferDescriptor_t * pxBuffer; /**< The network buffer that holds the data. */
+        uint8_t * pucData;                    /**< The first byte that has not been read yet. */
+        size_t uxLength;                      /**< The number of bytes at 'pucData'. */
+        size_t uxStart;                       /**< The position of 'pucData' in the stream, counted from its creation. */
+    } RxChainLink_t;
+
+/** @brief The RX stream of a TCP socket that keeps the received network buffers.
+ *         The stream buffer is only used for its markers, its array is empty. */
+    typedef struct xRX_CHAIN
+    {
+        StreamBuffer_t xStream;                              /**< Must be the first member, the socket refers to it as its rxStream. */
+        NetworkBufferDescriptor_t * pxSpare;                 /**< A small buffer that will take the headers of the next adopted frame. */
+        size_t uxConsumed;                                   /**< The position of the tail of the stream, counted from its creation. */
+        UBaseType_t uxCount;                                 /**< The number of links in use. */
+        RxChainLink_t xLinks[ ipconfigTCP_RX_CHAIN_LENGTH ]; /**< The links, sorted by their stream position. */
+    } RxChain_t;
+
+/** @brief The number of network buffers kept in the links of all RX chains.
+ *         Only changed while the scheduler is suspended. */
+    static UBaseType_t uxRxChainBuffers = 0U;
+#endif /* ipconfigUSE_TCP_RX_CHAIN */
+
+#if ( ipconfigUSE_TCP_ELASTIC_STREAMS == 1 )
+    #if ( ipconfigUSE_TCP != 1 )
+        #error ipconfigUSE_TCP_ELASTIC_STREAMS requires ipconfigUSE_TCP
+    #endif
+
+    #if ( ipconfigUSE_SOCKET_POOL == 1 )
+        #error ipconfigUSE_TCP_ELASTIC_STREAMS can not be combined with ipconfigUSE_SOCKET_POOL
+    #endif
+
+/** @brief An API function is going to access the streams of a TCP socket, the
+ *         IP-task may not move or release them until socketSTREAM_LEAVE(). */
+    #define socketSTREAM_ENTER( pxSocket )    prvTCPStreamEnter( pxSocket )
+    #define socketSTREAM_LEAVE( pxSocket )    prvTCPStreamLeave( pxSocket )
+
+/** @brief A pointer into a stream will be given to the user, the streams of
+ *         the socket will not be moved or released anymore. */
+    #define socketSTREAM_PIN( pxSocket )      prvTCPStreamPin( pxSocket )
+
+/** @brief The low-water limits, scaled down when the RX stream is still small. */
+    #define socketLITTLE_SPACE( pxSocket )    prvTCPLowWaterLimit( ( pxSocket ), ( pxSocket )->u.xTCP.uxLittleSpace, sock20_PERCENT )
+    #define socketENOUGH_SPACE( pxSocket )    prvTCPLowWaterLimit( ( pxSocket ), ( pxSocket )->u.xTCP.uxEnoughSpace, sock80_PERCENT )
+#else
+    #define socketSTREAM_ENTER( pxSocket )
+    #define socketSTREAM_LEAVE( pxSocket )
+    #define socketSTREAM_PIN( pxSocket )
+    #define socketLITTLE_SPACE( pxSocket )    ( ( pxSocket )->u.xTCP.uxLittleSpace )
+    #define socketENOUGH_SPACE( pxSocket )    ( ( pxSocket )->u.xTCP.uxEnoughSpace )
+#endif /* ipconfigUSE_TCP_ELASTIC_STREAMS */
+
+#if ( ipconfigTCP_WAKEUP_LOW_WATER == 1 )
+
+/** @brief Non-zero when a TCP socket holds back events until a low-water mark
+ *         is reached, or until ipconfigTCP_WAKEUP_LOW_WATER_MS has passed. */
+    #define socketHOLDS_EVENTS( pxSocket )    ( ( pxSocket )->u.xTCP.xHeldEventBits != 0U )
+#else
+    #define socketHOLDS_EVENTS( pxSocket )    ( pdFALSE )
+#endif /* ipconfigTCP_WAKEUP_LOW_WATER */
+
 /** @brief TCP timer period in milliseconds. */
 #if ( ( ipconfigUSE_TCP == 1 ) && !defined( ipTCP_TIMER_PERIOD_MS ) )
     #define ipTCP_TIMER_PERIOD_MS    ( 1000U )
@@ -125,6 +226,20 @@ static portINLINE ipDECL_CAST_PTR_FUNC_FOR_TYPE( NetworkBufferDescriptor_t )
 }
 /*-----------------------------------------------------------*/
 
+#if ( ( ipconfigUSE_TCP == 1 ) && ( ipconfigUSE_TCP_STATISTICS == 1 ) )
+
+/**
+ * @brief Utility function to cast pointer of a type to pointer of type TCPInfo_t.
+ *
+ * @return The casted pointer.
+ */
+    static portINLINE ipDECL_CAST_PTR_FUNC_FOR_TYPE( TCPInfo_t )
+    {
+        return ( TCPInfo_t * ) pvArgument;
+    }
+    /*-----------------------------------------------------------*/
+#endif /* ( ipconfigUSE_TCP == 1 ) && ( ipconfigUSE_TCP_STATISTICS == 1 ) */
+
 /**
  * @brief Utility function to cast pointer of a type to pointer of type StreamBuffer_t.
  *
@@ -136,6 +251,20 @@ static portINLINE ipDECL_CAST_PTR_FUNC_FOR_TYPE( StreamBuffer_t )
 }
 /*-----------------------------------------------------------*/
 
+#if ( ipconfigUSE_TCP_RX_CHAIN == 1 )
+
+/**
+ * @brief Utility function to cast pointer of a type to pointer of type RxChain_t.
+ *
+ * @return The casted pointer.
+ */
+    static portINLINE ipDECL_CAST_PTR_FUNC_FOR_TYPE( RxChain_t )
+    {
+        return ( RxChain_t * ) pvArgument;
+    }
+    /*-----------------------------------------------------------*/
+#endif /* ipconfigUSE_TCP_RX_CHAIN */
+
 /*
  * Allocate the next port number from the private allocation range.
  * TCP and UDP each have their own series of port numbers
@@ -169,6 +298,14 @@ static BaseType_t prvValidSocket( const FreeRTOS_Socket_t * pxSocket,
                                             const void * pvOptionValue );
 #endif /* ipconfigUSE_TCP == 1 */
 
+/*
+ * Block until one of the events in 'xBitsToWaitFor' has been set for the socket,
+ * or until the time-out expires.  The events found are cleared and returned.
+ */
+static EventBits_t prvSocketWaitEventBits( FreeRTOS_Socket_t * pxSocket,
+                                           EventBits_t xBitsToWaitFor,
+                                           TickType_t xTicksToWait );
+
 /*
  * Before creating a socket, check the validity of the parameters used
  * and find the size of the socket space, which is different for UDP and TCP
@@ -187,8 +324,88 @@ static uint8_t ucASCIIToHex( char cChar );
  */
     static StreamBuffer_t * prvTCPCreateStream( FreeRTOS_Socket_t * pxSocket,
                                                 BaseType_t xIsInputStream );
+
+/*
+ * Allocate and initialise a stream that can store at least 'uxCapacity' bytes.
+ */
+    static StreamBuffer_t * prvTCPAllocStream( FreeRTOS_Socket_t * pxSocket,
+                                               BaseType_t xIsInputStream,
+                                               size_t uxCapacity );
+
+/*
+ * Read from the RX stream, or get a pointer to its first contiguous bytes.
+ * These also work when the data is kept in an RX chain.
+ */
+    static size_t prvTCPRxGet( FreeRTOS_Socket_t * pxSocket,
+                               uint8_t * pucData,
+                               size_t uxMaxCount,
+                               BaseType_t xPeek );
+
+    static size_t prvTCPRxGetPtr( FreeRTOS_Socket_t * pxSocket,
+                                  uint8_t ** ppucData );
 #endif /* ipconfigUSE_TCP == 1 */
 
+#if ( ipconfigUSE_TCP_RX_CHAIN == 1 )
+
+/*
+ * Manage the network buffers that are kept in the RX chain of a TCP socket.
+ */
+    static void prvRxChainUnlink( RxChain_t * pxChain,
+                                  UBaseType_t uxIndex );
+
+    static void prvRxChainClear( RxChain_t * pxChain );
+
+    static void prvRxChainCompact( const FreeRTOS_Socket_t * pxSocket,
+                                   RxChain_t * pxChain,
+                                   BaseType_t xForce );
+
+    static BaseType_t prvRxChainCrowded( void );
+
+    static size_t prvRxChainRead( RxChain_t * pxChain,
+                                  uint8_t * pucData,
+                                  size_t uxCount );
+
+    static void prvRxChainConsume( RxChain_t * pxChain,
+                                   size_t uxCount );
+#endif /* ipconfigUSE_TCP_RX_CHAIN */
+
+#if ( ipconfigUSE_TCP_ELASTIC_STREAMS == 1 )
+
+/*
+ * Keep track of the API calls that access the streams of a TCP socket, so
+ * that the IP-task knows when it may replace or release them.
+ */
+    static void prvTCPStreamEnter( const FreeRTOS_Socket_t * pxSocket );
+
+    static void prvTCPStreamLeave( const FreeRTOS_Socket_t * pxSocket );
+
+    static void prvTCPStreamPin( const FreeRTOS_Socket_t * pxSocket );
+
+/*
+ * The number of bytes that can be stored in a stream.
+ */
+    static size_t prvTCPStreamCapacity( const StreamBuffer_t * pxStream );
+
+/*
+ * Called from FreeRTOS_send() when txStream is full: ask the IP-task to let it
+ * grow.
+ */
+    static void prvTCPStreamRequestTxGrowth( FreeRTOS_Socket_t * pxSocket );
+
+/*
+ * Limit a low-water setting to a percentage of the current RX stream.
+ */
+    static size_t prvTCPLowWaterLimit( const FreeRTOS_Socket_t * pxSocket,
+                                       size_t uxSpace,
+                                       size_t uxPercent );
+
+/*
+ * Called from xTCPTimerCheck(): release the streams that are empty and idle.
+ */
+    static void prvTCPStreamCheckIdle( FreeRTOS_Socket_t * pxSocket,
+                                       TickType_t xNow );
+#endif /* ipconfigUSE_TCP_ELASTIC_STREAMS */
+
 #if ( ipconfigUSE_TCP == 1 )
 
 /*
@@ -217,6 +434,18 @@ static uint8_t ucASCIIToHex( char cChar );
                                           struct freertos_sockaddr const * pxAddress );
 #endif /* ipconfigUSE_TCP */
 
+#if ( ipconfigUSE_UDP_CONNECT == 1 )
+    #if ( ipconfigUSE_TCP == 0 )
+        #error ipconfigUSE_UDP_CONNECT requires ipconfigUSE_TCP, which provides FreeRTOS_connect()
+    #endif
+
+/*
+ * Called from FreeRTOS_connect(): set or clear the peer of a UDP socket.
+ */
+    static BaseType_t prvUDPConnect( FreeRTOS_Socket_t * pxSocket,
+                                     struct freertos_sockaddr const * pxAddress );
+#endif /* ipconfigUSE_UDP_CONNECT */
+
 #if ( ipconfigUSE_TCP == 1 )
 
 /*
@@ -226,12 +455,33 @@ static uint8_t ucASCIIToHex( char cChar );
     static BaseType_t bMayConnect( FreeRTOS_Socket_t const * pxSocket );
 #endif /* ipconfigUSE_TCP */
 
+#if ( ( ipconfigUSE_TCP == 1 ) && ( ipconfigTCP_WAKEUP_LOW_WATER == 1 ) )
+
+/*
+ * Called from xTCPTimerCheck(): hold back receive and send events as long as
+ * the low-water marks of the socket have not been reached.
+ */
+    static TickType_t prvTCPHoldLowWaterEvents( FreeRTOS_Socket_t * pxSocket,
+                                                TickType_t xNow );
+#endif /* ( ipconfigUSE_TCP == 1 ) && ( ipconfigTCP_WAKEUP_LOW_WATER == 1 ) */
+
 #if ( ipconfigSUPPORT_SELECT_FUNCTION == 1 )
 
 /* Executed by the IP-task, it will check all sockets belonging to a set */
     static void prvFindSelectedSocket( SocketSelect_t * pxSocketSet );
 
 #endif /* ipconfigSUPPORT_SELECT_FUNCTION == 1 */
+
+#if ( ipconfigUSE_STATIC_POOLS == 1 )
+
+/* Print a single line of the pool report, returns the size of the pool in bytes. */
+    static size_t prvPrintPool( const char * pcName,
+                                UBaseType_t uxCount,
+                                size_t uxObjectSize,
+                                UBaseType_t uxInUse,
+                                UBaseType_t uxPeak );
+
+#endif /* ipconfigUSE_STATIC_POOLS == 1 */
 /*-----------------------------------------------------------*/
 
 /** @brief The list that contains mappings between sockets and port numbers.
@@ -250,8 +500,152 @@ List_t xBoundUDPSocketsList;
 
 #endif /* ipconfigUSE_TCP == 1 */
 
+#if ( ipconfigUSE_SOCKET_POOL == 1 )
+
+/** @brief The statically allocated socket objects. */
+    static FreeRTOS_Socket_t xSocketPoolObjects[ ipconfigSOCKET_POOL_SIZE ];
+
+/** @brief The pool from which FreeRTOS_socket() takes its sockets. */
+    static SocketPool_t xSocketPool =
+    {
+        ( uint8_t * ) xSocketPoolObjects,
+        sizeof( xSocketPoolObjects[ 0 ] ),
+        ( UBaseType_t ) ipconfigSOCKET_POOL_SIZE,
+        0U,
+        NULL,
+        0U,
+        0U,
+        "sockets"
+    };
+
+    #if ( ipconfigSOCKET_USES_NOTIFY == 0 )
+
+/** @brief The event groups of the sockets in the pool, the socket
+ *         xSocketPoolObjects[ x ] uses xSocketPoolEventGroups[ x ]. */
+        static StaticEventGroup_t xSocketPoolEventGroups[ ipconfigSOCKET_POOL_SIZE ];
+    #endif
+
+    #if ( ipconfigUSE_TCP == 1 )
+
+/** @brief The statically allocated stream buffers, stored as size_t words
+ *         to get the alignment of a StreamBuffer_t. */
+        static size_t uxStreamPoolObjects[ ipconfigSOCKET_POOL_STREAM_COUNT ][ socketPOOL_STREAM_WORDS ];
+
+/** @brief The pool from which prvTCPCreateStream() takes its stream buffers. */
+        static SocketPool_t xStreamPool =
+        {
+            ( uint8_t * ) uxStreamPoolObjects,
+            sizeof( uxStreamPoolObjects[ 0 ] ),
+            ( UBaseType_t ) ipconfigSOCKET_POOL_STREAM_COUNT,
+            0U,
+            NULL,
+            0U,
+            0U,
+            "streams"
+        };
+    #endif /* ipconfigUSE_TCP == 1 */
+#endif /* ipconfigUSE_SOCKET_POOL */
+
+#if ( ( ipconfigUSE_STATIC_POOLS == 1 ) && ( ipconfigSUPPORT_SELECT_FUNCTION == 1 ) )
+
+/** @brief The statically allocated socket sets. */
+    static SocketSelect_t xSocketSetPoolObjects[ ipconfigSOCKET_SET_POOL_SIZE ];
+
+/** @brief The event groups of the socket sets, the set xSocketSetPoolObjects[ x ]
+ *         uses xSocketSetPoolEventGroups[ x ]. */
+    static StaticEventGroup_t xSocketSetPoolEventGroups[ ipconfigSOCKET_SET_POOL_SIZE ];
+
+/** @brief The pool from which FreeRTOS_CreateSocketSet() takes its sets. */
+    static SocketPool_t xSocketSetPool =
+    {
+        ( uint8_t * ) xSocketSetPoolObjects,
+        sizeof( xSocketSetPoolObjects[ 0 ] ),
+        ( UBaseType_t ) ipconfigSOCKET_SET_POOL_SIZE,
+        0U,
+        NULL,
+        0U,
+        0U,
+        "socket sets"
+    };
+#endif /* ( ipconfigUSE_STATIC_POOLS == 1 ) && ( ipconfigSUPPORT_SELECT_FUNCTION == 1 ) */
+
 /*-----------------------------------------------------------*/
 
+#if ( ipconfigUSE_SOCKET_POOL == 1 )
+
+/**
+ * @brief Take an object from a static pool.  Objects that were returned
+ *        to the pool are re-used first, after that the objects that have
+ *        never been used are handed out in order.  No initialisation of the
+ *        pool is needed.
+ *
+ * @param[in] pxPool: The pool to take an object from.
+ *
+ * @return The object, or NULL when the pool is exhausted.
+ */
+    void * pvSocketPoolTake( SocketPool_t * pxPool )
+    {
+        void * pvObject = NULL;
+
+        taskENTER_CRITICAL();
+        {
+            if( pxPool->pvFreeList != NULL )
+            {
+                /* The first bytes of a free object hold the link to the next
+                 * free object. */
+                pvObject = pxPool->pvFreeList;
+                ( void ) memcpy( ( void * ) &( pxPool->pvFreeList ), pvObject, sizeof( pxPool->pvFreeList ) );
+            }
+            else if( pxPool->uxNextUnused < pxPool->uxObjectCount )
+            {
+                pvObject = ( void * ) &( pxPool->pucObjects[ pxPool->uxNextUnused * pxPool->uxObjectSize ] );
+                pxPool->uxNextUnused++;
+            }
+            else
+            {
+                /* The pool is exhausted. */
+            }
+
+            if( pvObject != NULL )
+            {
+                pxPool->uxInUse++;
+
+                if( pxPool->uxPeak < pxPool->uxInUse )
+                {
+                    pxPool->uxPeak = pxPool->uxInUse;
+                }
+            }
+        }
+        taskEXIT_CRITICAL();
+
+        return pvObject;
+    }
+    /*-----------------------------------------------------------*/
+
+/**
+ * @brief Return an object to the static pool from which it was taken.
+ *
+ * @param[in] pxPool: The pool that owns the object.
+ * @param[in] pvObject: The object being returned.
+ */
+    void vSocketPoolGive( SocketPool_t * pxPool,
+                          void * pvObject )
+    {
+        configASSERT( ( ( uint8_t * ) pvObject >= pxPool->pucObjects ) &&
+                      ( ( uint8_t * ) pvObject < &( pxPool->pucObjects[ pxPool->uxObjectCount * pxPool->uxObjectSize ] ) ) );
+
+        taskENTER_CRITICAL();
+        {
+            ( void ) memcpy( pvObject, ( const void * ) &( pxPool->pvFreeList ), sizeof( pxPool->pvFreeList ) );
+            pxPool->pvFreeList = pvObject;
+            pxPool->uxInUse--;
+        }
+        taskEXIT_CRITICAL();
+    }
+    /*-----------------------------------------------------------*/
+
+#endif /* ipconfigUSE_SOCKET_POOL */
+
 /**
  * @brief Check whether the socket is valid or not.
  *
@@ -402,9 +796,12 @@ Socket_t FreeRTOS_socket( BaseType_t xDomain,
 
 /* Note that this value will be over-written by the call to prvDetermineSocketSize. */
     size_t uxSocketSize = 1;
-    EventGroupHandle_t xEventGroup;
     Socket_t xReturn;
 
+    #if ( ipconfigSOCKET_USES_NOTIFY == 0 )
+        EventGroupHandle_t xEventGroup;
+    #endif
+
     if( prvDetermineSocketSize( xDomain, xType, xProtocol, &uxSocketSize ) == pdFAIL )
     {
         xReturn = FREERTOS_INVALID_SOCKET;
@@ -414,8 +811,18 @@ Socket_t FreeRTOS_socket( BaseType_t xDomain,
         /* Allocate the structure that will hold the socket information. The
         * size depends on the type of socket: UDP sockets need less space. A
         * define 'pvPortMallocSocket' will used to allocate the necessary space.
-        * By default it points to the FreeRTOS function 'pvPortMalloc()'. */
-        pxSocket = ipCAST_PTR_TO_TYPE_PTR( FreeRTOS_Socket_t, pvPortMallocSocket( uxSocketSize ) );
+        * By default it points to the FreeRTOS function 'pvPortMalloc()'.
+        * When ipconfigUSE_SOCKET_POOL is defined, the socket is taken from a
+        * static pool instead. */
+        #if ( ipconfigUSE_SOCKET_POOL == 1 )
+            {
+                pxSocket = ipCAST_PTR_TO_TYPE_PTR( FreeRTOS_Socket_t, pvSocketPoolTake( &( xSocketPool ) ) );
+            }
+        #else
+            {
+                pxSocket = ipCAST_PTR_TO_TYPE_PTR( FreeRTOS_Socket_t, pvPortMallocSocket( uxSocketSize ) );
+            }
+        #endif /* ipconfigUSE_SOCKET_POOL */
 
         if( pxSocket == NULL )
         {
@@ -424,30 +831,47 @@ Socket_t FreeRTOS_socket( BaseType_t xDomain,
         }
         else
         {
-            xEventGroup = xEventGroupCreate();
+            /* When ipconfigSOCKET_USES_NOTIFY is defined, the owner of the
+             * socket will be woken up with a task notification, and no event
+             * group is needed. */
+            #if ( ipconfigSOCKET_USES_NOTIFY == 0 )
+                #if ( ipconfigUSE_SOCKET_POOL == 1 )
+                    xEventGroup = xEventGroupCreateStatic( &( xSocketPoolEventGroups[ pxSocket - xSocketPoolObjects ] ) );
+                #else
+                    xEventGroup = xEventGroupCreate();
+                #endif
 
-            if( xEventGroup == NULL )
-            {
-                vPortFreeSocket( pxSocket );
-                xReturn = FREERTOS_INVALID_SOCKET;
-                iptraceFAILED_TO_CREATE_EVENT_GROUP();
-            }
-            else
+                if( xEventGroup == NULL )
+                {
+                    #if ( ipconfigUSE_SOCKET_POOL == 1 )
+                        vSocketPoolGive( &( xSocketPool ), pxSocket );
+                    #else
+                        vPortFreeSocket( pxSocket );
+                    #endif
+                    xReturn = FREERTOS_INVALID_SOCKET;
+                    iptraceFAILED_TO_CREATE_EVENT_GROUP();
+                }
+                else
+            #endif /* ipconfigSOCKET_USES_NOTIFY */
             {
                 if( xProtocol == FREERTOS_IPPROTO_UDP )
                 {
-                    iptraceMEM_STATS_CREATE( tcpSOCKET_UDP, pxSocket, uxSocketSize + sizeof( StaticEventGroup_t ) );
+                    iptraceMEM_STATS_CREATE( tcpSOCKET_UDP, pxSocket, uxSocketSize + socketEVENT_GROUP_SIZE );
                 }
                 else
                 {
                     /* Lint wants at least a comment, in case the macro is empty. */
-                    iptraceMEM_STATS_CREATE( tcpSOCKET_TCP, pxSocket, uxSocketSize + sizeof( StaticEventGroup_t ) );
+                    iptraceMEM_STATS_CREATE( tcpSOCKET_TCP, pxSocket, uxSocketSize + socketEVENT_GROUP_SIZE );
                 }
 
                 /* Clear the entire space to avoid nulling individual entries. */
                 ( void ) memset( pxSocket, 0, uxSocketSize );
 
-                pxSocket->xEventGroup = xEventGroup;
+                #if ( ipconfigSOCKET_USES_NOTIFY == 0 )
+                    {
+                        pxSocket->xEventGroup = xEventGroup;
+                    }
+                #endif /* ipconfigSOCKET_USES_NOTIFY */
 
                 /* Initialise the socket's members.  The semaphore will be created
                  * if the socket is bound to an address, for now the pointer to the
@@ -522,16 +946,40 @@ Socket_t FreeRTOS_socket( BaseType_t xDomain,
     {
         SocketSelect_t * pxSocketSet;
 
-        pxSocketSet = ipCAST_PTR_TO_TYPE_PTR( SocketSelect_t, pvPortMalloc( sizeof( *pxSocketSet ) ) );
+        #if ( ipconfigUSE_STATIC_POOLS == 1 )
+            {
+                pxSocketSet = ipCAST_PTR_TO_TYPE_PTR( SocketSelect_t, pvSocketPoolTake( &( xSocketSetPool ) ) );
+            }
+        #else
+            {
+                pxSocketSet = ipCAST_PTR_TO_TYPE_PTR( SocketSelect_t, pvPortMalloc( sizeof( *pxSocketSet ) ) );
+            }
+        #endif
 
         if( pxSocketSet != NULL )
         {
             ( void ) memset( pxSocketSet, 0, sizeof( *pxSocketSet ) );
-            pxSocketSet->xSelectGroup = xEventGroupCreate();
+            #if ( ipconfigUSE_STATIC_POOLS == 1 )
+                {
+                    pxSocketSet->xSelectGroup = xEventGroupCreateStatic( &( xSocketSetPoolEventGroups[ pxSocketSet - xSocketSetPoolObjects ] ) );
+                }
+            #else
+                {
+                    pxSocketSet->xSelectGroup = xEventGroupCreate();
+                }
+            #endif
 
             if( pxSocketSet->xSelectGroup == NULL )
             {
-                vPortFree( pxSocketSet );
+                #if ( ipconfigUSE_STATIC_POOLS == 1 )
+                    {
+                        vSocketSetRelease( pxSocketSet );
+                    }
+                #else
+                    {
+                        vPortFree( pxSocketSet );
+                    }
+                #endif
                 pxSocketSet = NULL;
             }
             else
@@ -547,6 +995,22 @@ Socket_t FreeRTOS_socket( BaseType_t xDomain,
 #endif /* ipconfigSUPPORT_SELECT_FUNCTION == 1 */
 /*-----------------------------------------------------------*/
 
+#if ( ( ipconfigUSE_STATIC_POOLS == 1 ) && ( ipconfigSUPPORT_SELECT_FUNCTION == 1 ) )
+
+/**
+ * @brief Return a socket set to the static pool.  The IP-task calls this
+ *        after it has deleted the event group of the set.
+ *
+ * @param[in] pxSocketSet: The socket set being released.
+ */
+    void vSocketSetRelease( SocketSelect_t * pxSocketSet )
+    {
+        vSocketPoolGive( &( xSocketSetPool ), ( void * ) pxSocketSet );
+    }
+
+#endif /* ( ipconfigUSE_STATIC_POOLS == 1 ) && ( ipconfigSUPPORT_SELECT_FUNCTION == 1 ) */
+/*-----------------------------------------------------------*/
+
 #if ( ipconfigSUPPORT_SELECT_FUNCTION == 1 )
 
 /**
@@ -846,7 +1310,7 @@ int32_t FreeRTOS_recvfrom( Socket_t xSocket,
     BaseType_t lPacketCount;
     NetworkBufferDescriptor_t * pxNetworkBuffer;
     const void * pvCopySource;
-    FreeRTOS_Socket_t const * pxSocket = xSocket;
+    FreeRTOS_Socket_t * pxSocket = xSocket;
     TickType_t xRemainingTime = ( TickType_t ) 0; /* Obsolete assignment, but some compilers output a warning if its not done. */
     BaseType_t xTimed = pdFALSE;
     TimeOut_t xTimeOut;
@@ -879,8 +1343,7 @@ int32_t FreeRTOS_recvfrom( Socket_t xSocket,
                     #if ( ipconfigSUPPORT_SIGNALS != 0 )
                         {
                             /* Just check for the interrupt flag. */
-                            xEventBits = xEventGroupWaitBits( pxSocket->xEventGroup, ( EventBits_t ) eSOCKET_INTR,
-                                                              pdTRUE /*xClearOnExit*/, pdFALSE /*xWaitAllBits*/, socketDONT_BLOCK );
+                            xEventBits = prvSocketWaitEventBits( pxSocket, ( EventBits_t ) eSOCKET_INTR, socketDONT_BLOCK );
                         }
                     #endif /* ipconfigSUPPORT_SIGNALS */
                     break;
@@ -899,10 +1362,9 @@ int32_t FreeRTOS_recvfrom( Socket_t xSocket,
             }
 
             /* Wait for arrival of data.  While waiting, the IP-task may set the
-             * 'eSOCKET_RECEIVE' bit in 'xEventGroup', if it receives data for this
+             * 'eSOCKET_RECEIVE' event, if it receives data for this
              * socket, thus unblocking this API call. */
-            xEventBits = xEventGroupWaitBits( pxSocket->xEventGroup, ( ( EventBits_t ) eSOCKET_RECEIVE ) | ( ( EventBits_t ) eSOCKET_INTR ),
-                                              pdTRUE /*xClearOnExit*/, pdFALSE /*xWaitAllBits*/, xRemainingTime );
+            xEventBits = prvSocketWaitEventBits( pxSocket, ( ( EventBits_t ) eSOCKET_RECEIVE ) | ( ( EventBits_t ) eSOCKET_INTR ), xRemainingTime );
 
             #if ( ipconfigSUPPORT_SIGNALS != 0 )
                 {
@@ -911,7 +1373,7 @@ int32_t FreeRTOS_recvfrom( Socket_t xSocket,
                         if( ( xEventBits & ( EventBits_t ) eSOCKET_RECEIVE ) != 0U )
                         {
                             /* Shouldn't have cleared the eSOCKET_RECEIVE flag. */
-                            ( void ) xEventGroupSetBits( pxSocket->xEventGroup, ( EventBits_t ) eSOCKET_RECEIVE );
+                            vSocketSetEventBits( pxSocket, ( EventBits_t ) eSOCKET_RECEIVE );
                         }
 
                         break;
@@ -1024,6 +1486,8 @@ int32_t FreeRTOS_recvfrom( Socket_t xSocket,
  * @param[in] xFlags: Flags used to communicate preferences to the function.
  *                    Possibly FREERTOS_MSG_DONTWAIT and/or FREERTOS_ZERO_COPY.
  * @param[in] pxDestinationAddress: The address to which the data is to be sent.
+ *                  It may be NULL for a socket that was connected with
+ *                  FreeRTOS_connect().
  * @param[in] xDestinationAddressLength: This parameter is present to adhere to the
  *                  Berkeley sockets standard. Else, it is not used.
  *
@@ -1043,10 +1507,14 @@ int32_t FreeRTOS_sendto( Socket_t xSocket,
     TimeOut_t xTimeOut;
     TickType_t xTicksToWait;
     int32_t lReturn = 0;
-    FreeRTOS_Socket_t const * pxSocket;
+    FreeRTOS_Socket_t * pxSocket;
     const size_t uxMaxPayloadLength = ipMAX_UDP_PAYLOAD_LENGTH;
     const size_t uxPayloadOffset = ipUDP_PAYLOAD_OFFSET_IPv4;
+    const struct freertos_sockaddr * pxDestination = pxDestinationAddress;
 
+    #if ( ipconfigUSE_UDP_CONNECT == 1 )
+        struct freertos_sockaddr xRemoteAddress;
+    #endif
 
     pxSocket = ( FreeRTOS_Socket_t * ) xSocket;
 
@@ -1056,7 +1524,26 @@ int32_t FreeRTOS_sendto( Socket_t xSocket,
     ( void ) xDestinationAddressLength;
     configASSERT( pvBuffer != NULL );
 
-    if( uxTotalDataLength <= ( size_t ) uxMaxPayloadLength )
+    #if ( ipconfigUSE_UDP_CONNECT == 1 )
+        {
+            /* A connected socket may be used without a destination address. */
+            if( ( pxDestination == NULL ) &&
+                ( pxSocket->ucProtocol == ( uint8_t ) FREERTOS_IPPROTO_UDP ) &&
+                ( pxSocket->u.xUDP.ulRemoteIP != 0UL ) )
+            {
+                xRemoteAddress.sin_addr = pxSocket->u.xUDP.ulRemoteIP;
+                xRemoteAddress.sin_port = pxSocket->u.xUDP.usRemotePort;
+                pxDestination = &( xRemoteAddress );
+            }
+        }
+    #endif /* ipconfigUSE_UDP_CONNECT */
+
+    if( pxDestination == NULL )
+    {
+        /* There is no destination address, and the socket is not connected. */
+        lReturn = -pdFREERTOS_ERRNO_ENOTCONN;
+    }
+    else if( uxTotalDataLength <= ( size_t ) uxMaxPayloadLength )
     {
         /* If the socket is not already bound to an address, bind it now.
          * Passing NULL as the address parameter tells FreeRTOS_bind() to select
@@ -1117,14 +1604,31 @@ int32_t FreeRTOS_sendto( Socket_t xSocket,
             {
                 /* xDataLength is the size of the total packet, including the Ethernet header. */
                 pxNetworkBuffer->xDataLength = uxTotalDataLength + sizeof( UDPPacket_t );
-                pxNetworkBuffer->usPort = pxDestinationAddress->sin_port;
+                pxNetworkBuffer->usPort = pxDestination->sin_port;
                 pxNetworkBuffer->usBoundPort = ( uint16_t ) socketGET_SOCKET_PORT( pxSocket );
-                pxNetworkBuffer->ulIPAddress = pxDestinationAddress->sin_addr;
+                pxNetworkBuffer->ulIPAddress = pxDestination->sin_addr;
 
                 /* The socket options are passed to the IP layer in the
                  * space that will eventually get used by the Ethernet header. */
                 pxNetworkBuffer->pucEthernetBuffer[ ipSOCKET_OPTIONS_OFFSET ] = pxSocket->ucSocketOptions;
 
+                #if ( ipconfigUSE_UDP_CONNECT == 1 )
+                    {
+                        /* When sending to the peer of a connected socket, the
+                         * headers can normally be completed from its template.
+                         * The IP-task then only needs to pass the packet to the
+                         * network interface. */
+                        if( ( pxSocket->ucProtocol == ( uint8_t ) FREERTOS_IPPROTO_UDP ) &&
+                            ( pxSocket->u.xUDP.ulRemoteIP != 0UL ) &&
+                            ( pxDestination->sin_addr == pxSocket->u.xUDP.ulRemoteIP ) &&
+                            ( pxDestination->sin_port == pxSocket->u.xUDP.usRemotePort ) &&
+                            ( xUDPConnectedFillPacket( pxSocket, pxNetworkBuffer, uxTotalDataLength ) != pdFALSE ) )
+                        {
+                            xStackTxEvent.eEventType = eNetworkTxEvent;
+                        }
+                    }
+                #endif /* ipconfigUSE_UDP_CONNECT */
+
                 /* Tell the networking task that the packet needs sending. */
                 xStackTxEvent.pvData = pxNetworkBuffer;
 
@@ -1251,7 +1755,7 @@ BaseType_t FreeRTOS_bind( Socket_t xSocket,
         {
             /* The IP-task will set the 'eSOCKET_BOUND' bit when it has done its
              * job. */
-            ( void ) xEventGroupWaitBits( pxSocket->xEventGroup, ( EventBits_t ) eSOCKET_BOUND, pdTRUE /*xClearOnExit*/, pdFALSE /*xWaitAllBits*/, portMAX_DELAY );
+            ( void ) prvSocketWaitEventBits( pxSocket, ( EventBits_t ) eSOCKET_BOUND, portMAX_DELAY );
 
             if( !socketSOCKET_IS_BOUND( pxSocket ) )
             {
@@ -1520,14 +2024,29 @@ void * vSocketClose( FreeRTOS_Socket_t * pxSocket )
                 /* Free the input and output streams */
                 if( pxSocket->u.xTCP.rxStream != NULL )
                 {
+                    #if ( ipconfigUSE_TCP_RX_CHAIN == 1 )
+                        {
+                            /* Return the network buffers that were kept. */
+                            prvRxChainClear( ipCAST_PTR_TO_TYPE_PTR( RxChain_t, pxSocket->u.xTCP.rxStream ) );
+                        }
+                    #endif
+
                     iptraceMEM_STATS_DELETE( pxSocket->u.xTCP.rxStream );
-                    vPortFreeLarge( pxSocket->u.xTCP.rxStream );
+                    #if ( ipconfigUSE_SOCKET_POOL == 1 )
+                        vSocketPoolGive( &( xStreamPool ), pxSocket->u.xTCP.rxStream );
+                    #else
+                        vPortFreeLarge( pxSocket->u.xTCP.rxStream );
+                    #endif
                 }
 
                 if( pxSocket->u.xTCP.txStream != NULL )
                 {
                     iptraceMEM_STATS_DELETE( pxSocket->u.xTCP.txStream );
-                    vPortFreeLarge( pxSocket->u.xTCP.txStream );
+                    #if ( ipconfigUSE_SOCKET_POOL == 1 )
+                        vSocketPoolGive( &( xStreamPool ), pxSocket->u.xTCP.txStream );
+                    #else
+                        vPortFreeLarge( pxSocket->u.xTCP.txStream );
+                    #endif
                 }
 
                 /* In case this is a child socket, make sure the child-count of the
@@ -1571,10 +2090,14 @@ void * vSocketClose( FreeRTOS_Socket_t * pxSocket )
         }
     }
 
-    if( pxSocket->xEventGroup != NULL )
-    {
-        vEventGroupDelete( pxSocket->xEventGroup );
-    }
+    #if ( ipconfigSOCKET_USES_NOTIFY == 0 )
+        {
+            if( pxSocket->xEventGroup != NULL )
+            {
+                vEventGroupDelete( pxSocket->xEventGroup );
+            }
+        }
+    #endif /* ipconfigSOCKET_USES_NOTIFY */
 
     #if ( ipconfigUSE_TCP == 1 ) && ( ipconfigHAS_DEBUG_PRINTF != 0 )
         {
@@ -1592,7 +2115,15 @@ void * vSocketClose( FreeRTOS_Socket_t * pxSocket )
 
     /* And finally, after all resources have been freed, free the socket space */
     iptraceMEM_STATS_DELETE( pxSocket );
-    vPortFreeSocket( pxSocket );
+    #if ( ipconfigUSE_SOCKET_POOL == 1 )
+        {
+            vSocketPoolGive( &( xSocketPool ), pxSocket );
+        }
+    #else
+        {
+            vPortFreeSocket( pxSocket );
+        }
+    #endif
 
     return NULL;
 } /* Tested */
@@ -1704,14 +2235,32 @@ void * vSocketClose( FreeRTOS_Socket_t * pxSocket )
             {
                 /* Round up to nearest MSS size */
                 ulNewValue = FreeRTOS_round_up( ulNewValue, ( uint32_t ) pxSocket->u.xTCP.usMSS );
-                pxSocket->u.xTCP.uxTxStreamSize = ulNewValue;
             }
-            else
+
+            #if ( ipconfigUSE_SOCKET_POOL == 1 )
+                if( ulNewValue > ( uint32_t ) ipconfigSOCKET_POOL_STREAM_SIZE )
+                {
+                    /* The stream would not fit in an object of the stream pool. */
+                    FreeRTOS_debug_printf( ( "Set SO_%sBUF: %lu exceeds the pool size %lu\n",
+                                             ( lOptionName == FREERTOS_SO_SNDBUF ) ? "SND" : "RCV",
+                                             ulNewValue,
+                                             ( uint32_t ) ipconfigSOCKET_POOL_STREAM_SIZE ) );
+                    xReturn = -pdFREERTOS_ERRNO_EINVAL;
+                }
+                else
+            #endif /* ipconfigUSE_SOCKET_POOL */
             {
-                pxSocket->u.xTCP.uxRxStreamSize = ulNewValue;
-            }
+                if( lOptionName == FREERTOS_SO_SNDBUF )
+                {
+                    pxSocket->u.xTCP.uxTxStreamSize = ulNewValue;
+                }
+                else
+                {
+                    pxSocket->u.xTCP.uxRxStreamSize = ulNewValue;
+                }
 
-            xReturn = 0;
+                xReturn = 0;
+            }
         }
 
         return xReturn;
@@ -1941,6 +2490,36 @@ BaseType_t FreeRTOS_setsockopt( Socket_t xSocket,
                    }
                    break;
 
+                    #if ( ipconfigTCP_WAKEUP_LOW_WATER == 1 )
+                        case FREERTOS_SO_RCVLOWAT: /* Only wake up a reader when at least this many bytes can be read. */
+                        case FREERTOS_SO_SNDLOWAT: /* Only wake up a writer when at least this many bytes can be written. */
+                           {
+                               size_t uxLowat = *( ( const size_t * ) pvOptionValue );
+
+                               if( pxSocket->ucProtocol != ( uint8_t ) FREERTOS_IPPROTO_TCP )
+                               {
+                                   break; /* will return -pdFREERTOS_ERRNO_EINVAL */
+                               }
+
+                               /* Like in BSD, a value of zero is treated as 1 byte. */
+                               if( uxLowat == 0U )
+                               {
+                                   uxLowat = 1U;
+                               }
+
+                               if( lOptionName == FREERTOS_SO_RCVLOWAT )
+                               {
+                                   pxSocket->u.xTCP.uxRcvLowat = uxLowat;
+                               }
+                               else
+                               {
+                                   pxSocket->u.xTCP.uxSndLowat = uxLowat;
+                               }
+                           }
+                            xReturn = 0;
+                            break;
+                    #endif /* ipconfigTCP_WAKEUP_LOW_WATER */
+
                 case FREERTOS_SO_SNDBUF: /* Set the size of the send buffer, in units of MSS (TCP only) */
                 case FREERTOS_SO_RCVBUF: /* Set the size of the receive buffer, in units of MSS (TCP only) */
                     xReturn = prvSockopt_so_buffer( pxSocket, lOptionName, pvOptionValue );
@@ -2102,18 +2681,145 @@ BaseType_t FreeRTOS_setsockopt( Socket_t xSocket,
 
 /*-----------------------------------------------------------*/
 
+#if ( ( ipconfigUSE_TCP == 1 ) && ( ipconfigUSE_TCP_STATISTICS == 1 ) )
+
 /**
- * @brief Find an available port number per https://tools.ietf.org/html/rfc6056.
+ * @brief Fill in a TCPInfo_t with the statistics and the window properties
+ *        of a TCP connection.
  *
- * @param[in] xProtocol: FREERTOS_IPPROTO_TCP/FREERTOS_IPPROTO_UDP.
- *
- * @return If an available protocol port is found then that port number is returned.
- *         Or else, 0 is returned.
+ * @param[in] pxSocket: The TCP socket.
+ * @param[out] pxInfo: The structure to be filled in.
  */
-static uint16_t prvGetPrivatePortNumber( BaseType_t xProtocol )
-{
-    const uint16_t usEphemeralPortCount =
-        socketAUTO_PORT_ALLOCATION_MAX_NUMBER - ( socketAUTO_PORT_ALLOCATION_START_NUMBER - 1U );
+    static void prvTCPGetInfo( const FreeRTOS_Socket_t * pxSocket,
+                               TCPInfo_t * pxInfo )
+    {
+        const TCPWindow_t * pxWindow = &( pxSocket->u.xTCP.xTCPWindow );
+        TickType_t xZeroWindowTime;
+
+        ( void ) memset( pxInfo, 0, sizeof( *pxInfo ) );
+
+        /* The IP-task updates the counters, make sure it does not run while
+         * they are being copied. */
+        vTaskSuspendAll();
+        {
+            pxInfo->ucTCPState = pxSocket->u.xTCP.ucTCPState;
+            pxInfo->usMSS = pxSocket->u.xTCP.usMSS;
+            pxInfo->ulSRTT = ( uint32_t ) pxWindow->lSRTT;
+            /* A segment is sent again when it is not acknowledged within 2 * SRTT. */
+            pxInfo->ulRTO = 2U * ( uint32_t ) pxWindow->lSRTT;
+            pxInfo->ulRetransmits = pxWindow->ulRetransmitCount;
+            pxInfo->ulFastRetransmits = pxWindow->ulFastRetransmitCount;
+            pxInfo->ulDupAcks = pxWindow->ulDupAckCount;
+            pxInfo->ulBytesSent = pxSocket->u.xTCP.ulBytesSent;
+            pxInfo->ulBytesReceived = pxSocket->u.xTCP.ulBytesReceived;
+            pxInfo->ulRxWindowLength = pxWindow->xSize.ulRxWindowLength;
+            pxInfo->ulTxWindowLength = pxWindow->xSize.ulTxWindowLength;
+            pxInfo->ulPeerWindow = pxSocket->u.xTCP.ulWindowSize;
+
+            #if ( ipconfigUSE_TCP_WIN == 1 )
+                {
+                    pxInfo->ulRxSegments = ( uint32_t ) listCURRENT_LIST_LENGTH( &( pxWindow->xRxSegments ) );
+                    pxInfo->ulTxSegments = ( uint32_t ) listCURRENT_LIST_LENGTH( &( pxWindow->xTxSegments ) );
+                }
+            #else
+                {
+                    /* Tiny TCP only has a single transmission segment. */
+                    pxInfo->ulTxSegments = ( pxWindow->xTxSegment.lDataLength != 0 ) ? 1U : 0U;
+                }
+            #endif /* ipconfigUSE_TCP_WIN */
+
+            xZeroWindowTime = pxSocket->u.xTCP.xZeroWindowTime;
+
+            if( pxSocket->u.xTCP.xZeroWindow != pdFALSE )
+            {
+                xZeroWindowTime += xTaskGetTickCount() - pxSocket->u.xTCP.xZeroWindowStart;
+            }
+
+            if( pxSocket->u.xTCP.rxStream != NULL )
+            {
+                pxInfo->uxRxDataLength = uxStreamBufferGetSize( pxSocket->u.xTCP.rxStream );
+            }
+
+            if( pxSocket->u.xTCP.txStream != NULL )
+            {
+                pxInfo->uxTxDataLength = uxStreamBufferGetSize( pxSocket->u.xTCP.txStream );
+            }
+        }
+        ( void ) xTaskResumeAll();
+
+        pxInfo->ulZeroWindowTime = ( uint32_t ) ( xZeroWindowTime * portTICK_PERIOD_MS );
+    }
+    /*-----------------------------------------------------------*/
+
+/**
+ * @brief Get an option of a socket.  The only option supported at this
+ *        moment is FREERTOS_SO_TCP_INFO, the statistics of a TCP connection.
+ *
+ * @param[in] xSocket: The socket for which the option is requested.
+ * @param[in] lLevel: Not used. Parameter is used to maintain the Berkeley sockets
+ *                    standard.
+ * @param[in] lOptionName: The name of the option.
+ * @param[out] pvOptionValue: The buffer in which the value will be stored.
+ * @param[in,out] puxOptionLength: The size of the buffer.  When successful,
+ *                                 the size of the value is written to it.
+ *
+ * @return 0 when the value was stored, otherwise a negative errno value:
+ *         -pdFREERTOS_ERRNO_EINVAL for a bad socket or a buffer that is too
+ *         small, -pdFREERTOS_ERRNO_ENOPROTOOPT for an unknown option.
+ */
+    BaseType_t FreeRTOS_getsockopt( ConstSocket_t xSocket,
+                                    int32_t lLevel,
+                                    int32_t lOptionName,
+                                    void * pvOptionValue,
+                                    size_t * puxOptionLength )
+    {
+        const FreeRTOS_Socket_t * pxSocket = ( const FreeRTOS_Socket_t * ) xSocket;
+        BaseType_t xReturn;
+
+        /* The level is not used in this implementation. */
+        ( void ) lLevel;
+
+        if( ( pvOptionValue == NULL ) || ( puxOptionLength == NULL ) )
+        {
+            xReturn = -pdFREERTOS_ERRNO_EINVAL;
+        }
+        else if( lOptionName != FREERTOS_SO_TCP_INFO )
+        {
+            xReturn = -pdFREERTOS_ERRNO_ENOPROTOOPT;
+        }
+        else if( prvValidSocket( pxSocket, FREERTOS_IPPROTO_TCP, pdFALSE ) == pdFALSE )
+        {
+            xReturn = -pdFREERTOS_ERRNO_EINVAL;
+        }
+        else if( *puxOptionLength < sizeof( TCPInfo_t ) )
+        {
+            xReturn = -pdFREERTOS_ERRNO_EINVAL;
+        }
+        else
+        {
+            prvTCPGetInfo( pxSocket, ipCAST_PTR_TO_TYPE_PTR( TCPInfo_t, pvOptionValue ) );
+            *puxOptionLength = sizeof( TCPInfo_t );
+            xReturn = 0;
+        }
+
+        return xReturn;
+    }
+
+#endif /* ( ipconfigUSE_TCP == 1 ) && ( ipconfigUSE_TCP_STATISTICS == 1 ) */
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Find an available port number per https://tools.ietf.org/html/rfc6056.
+ *
+ * @param[in] xProtocol: FREERTOS_IPPROTO_TCP/FREERTOS_IPPROTO_UDP.
+ *
+ * @return If an available protocol port is found then that port number is returned.
+ *         Or else, 0 is returned.
+ */
+static uint16_t prvGetPrivatePortNumber( BaseType_t xProtocol )
+{
+    const uint16_t usEphemeralPortCount =
+        socketAUTO_PORT_ALLOCATION_MAX_NUMBER - ( socketAUTO_PORT_ALLOCATION_START_NUMBER - 1U );
     uint16_t usIterations = usEphemeralPortCount;
     uint32_t ulRandomSeed = 0;
     uint16_t usResult = 0;
@@ -2789,7 +3495,152 @@ size_t FreeRTOS_GetLocalAddress( ConstSocket_t xSocket,
 /*-----------------------------------------------------------*/
 
 /**
- * @brief Wake up the user of the given socket through event-groups.
+ * @brief Set events for the owner of a socket.  The events are either set in
+ *        the socket's event group, or stored in the socket after which the
+ *        waiting task will get a notification.
+ *
+ * @param[in] pxSocket: The socket that has new events.
+ * @param[in] xBits: The events to be set.
+ */
+void vSocketSetEventBits( FreeRTOS_Socket_t * pxSocket,
+                          EventBits_t xBits )
+{
+    #if ( ipconfigSOCKET_USES_NOTIFY == 0 )
+        {
+            if( pxSocket->xEventGroup != NULL )
+            {
+                ( void ) xEventGroupSetBits( pxSocket->xEventGroup, xBits );
+            }
+        }
+    #else
+        {
+            TaskHandle_t xTasksToNotify[ ipSOCKET_NOTIFY_WAITERS ];
+            UBaseType_t uxIndex;
+
+            taskENTER_CRITICAL();
+            {
+                for( uxIndex = 0U; uxIndex < ipSOCKET_NOTIFY_WAITERS; uxIndex++ )
+                {
+                    pxSocket->xPendingEventBits[ uxIndex ] |= xBits;
+
+                    /* Only wake up a task that is interested in these events. */
+                    if( ( pxSocket->xWaitingBits[ uxIndex ] & xBits ) != 0U )
+                    {
+                        xTasksToNotify[ uxIndex ] = pxSocket->xWaitingTask[ uxIndex ];
+                    }
+                    else
+                    {
+                        xTasksToNotify[ uxIndex ] = NULL;
+                    }
+                }
+            }
+            taskEXIT_CRITICAL();
+
+            for( uxIndex = 0U; uxIndex < ipSOCKET_NOTIFY_WAITERS; uxIndex++ )
+            {
+                if( xTasksToNotify[ uxIndex ] != NULL )
+                {
+                    ( void ) socketNOTIFY_GIVE( xTasksToNotify[ uxIndex ] );
+                }
+            }
+        }
+    #endif /* ipconfigSOCKET_USES_NOTIFY */
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Block until one of the requested events has been set for the socket.
+ *        Just like xEventGroupWaitBits() with 'xClearOnExit' set, the events
+ *        that were found are cleared, but only for the place that the calling
+ *        task waits on: a sender and a receiver both see an event.
+ *
+ * @param[in] pxSocket: The socket to wait on.
+ * @param[in] xBitsToWaitFor: The events to wait for.
+ * @param[in] xTicksToWait: The maximum time to wait, in clock-ticks.
+ *
+ * @return The events that were set, or zero in case of a time-out.
+ */
+static EventBits_t prvSocketWaitEventBits( FreeRTOS_Socket_t * pxSocket,
+                                           EventBits_t xBitsToWaitFor,
+                                           TickType_t xTicksToWait )
+{
+    EventBits_t xResult;
+
+    #if ( ipconfigSOCKET_USES_NOTIFY == 0 )
+        {
+            xResult = xEventGroupWaitBits( pxSocket->xEventGroup, xBitsToWaitFor, pdTRUE /*xClearOnExit*/, pdFALSE /*xWaitAllBits*/, xTicksToWait );
+        }
+    #else
+        {
+            TimeOut_t xTimeOut;
+            TickType_t xRemainingTime = xTicksToWait;
+            UBaseType_t uxWaiter = ipSOCKET_NOTIFY_RECEIVER;
+
+            /* One task may be sending while another task is receiving from the
+             * same socket, each of them gets its own place to wait. */
+            if( ( xBitsToWaitFor & ( EventBits_t ) eSOCKET_SEND ) != 0U )
+            {
+                uxWaiter = ipSOCKET_NOTIFY_SENDER;
+            }
+
+            vTaskSetTimeOutState( &xTimeOut );
+
+            for( ; ; )
+            {
+                taskENTER_CRITICAL();
+                {
+                    xResult = pxSocket->xPendingEventBits[ uxWaiter ] & xBitsToWaitFor;
+                    pxSocket->xPendingEventBits[ uxWaiter ] &= ~xResult;
+
+                    if( xResult == 0U )
+                    {
+                        /* Register as the waiting task before blocking, so that
+                         * the IP-task knows whom to notify. */
+                        pxSocket->xWaitingTask[ uxWaiter ] = xTaskGetCurrentTaskHandle();
+                        pxSocket->xWaitingBits[ uxWaiter ] = xBitsToWaitFor;
+                    }
+                    else
+                    {
+                        pxSocket->xWaitingTask[ uxWaiter ] = NULL;
+                        pxSocket->xWaitingBits[ uxWaiter ] = 0U;
+                    }
+                }
+                taskEXIT_CRITICAL();
+
+                if( xResult != 0U )
+                {
+                    break;
+                }
+
+                if( xTaskCheckForTimeOut( &xTimeOut, &xRemainingTime ) != pdFALSE )
+                {
+                    break;
+                }
+
+                /* A notification may also be left-over from an earlier call,
+                 * in which case the events will be checked once more. */
+                ( void ) socketNOTIFY_TAKE( xRemainingTime );
+            }
+
+            if( xResult == 0U )
+            {
+                taskENTER_CRITICAL();
+                {
+                    pxSocket->xWaitingTask[ uxWaiter ] = NULL;
+                    pxSocket->xWaitingBits[ uxWaiter ] = 0U;
+                }
+                taskEXIT_CRITICAL();
+            }
+        }
+    #endif /* ipconfigSOCKET_USES_NOTIFY */
+
+    return xResult;
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Wake up the user of the given socket through event-groups or task
+ *        notifications.
  *
  * @param[in] pxSocket: The socket whose user is to be woken up.
  */
@@ -2832,9 +3683,10 @@ void vSocketWakeUpUser( FreeRTOS_Socket_t * pxSocket )
         }
     #endif /* ipconfigSUPPORT_SELECT_FUNCTION */
 
-    if( ( pxSocket->xEventGroup != NULL ) && ( pxSocket->xEventBits != 0U ) )
+    if( pxSocket->xEventBits != 0U )
     {
-        ( void ) xEventGroupSetBits( pxSocket->xEventGroup, pxSocket->xEventBits );
+        iptraceSOCKET_WAKE_UP_USER( pxSocket, pxSocket->xEventBits );
+        vSocketSetEventBits( pxSocket, pxSocket->xEventBits );
     }
 
     pxSocket->xEventBits = 0UL;
@@ -3003,10 +3855,62 @@ void vSocketWakeUpUser( FreeRTOS_Socket_t * pxSocket )
 #endif /* ipconfigUSE_TCP */
 /*-----------------------------------------------------------*/
 
+#if ( ipconfigUSE_UDP_CONNECT == 1 )
+
+/**
+ * @brief Set the peer of a UDP socket.  The socket will be bound to a port
+ *        if it isn't yet.  Connecting to the address 0 dissolves the
+ *        association.
+ *
+ * @param[in] pxSocket: The UDP socket.
+ * @param[in] pxAddress: The address of the peer.
+ *
+ * @return 0 when successful, else a negative error code.
+ */
+    static BaseType_t prvUDPConnect( FreeRTOS_Socket_t * pxSocket,
+                                     struct freertos_sockaddr const * pxAddress )
+    {
+        BaseType_t xResult = 0;
+
+        if( pxAddress == NULL )
+        {
+            xResult = -pdFREERTOS_ERRNO_EINVAL;
+        }
+        else if( !socketSOCKET_IS_BOUND( pxSocket ) )
+        {
+            /* The local port number is part of the header template. */
+            xResult = FreeRTOS_bind( pxSocket, NULL, 0U );
+        }
+        else
+        {
+            /* The socket is bound already. */
+        }
+
+        if( xResult == 0 )
+        {
+            /* The IP-task reads the peer address when filtering incoming
+             * datagrams. */
+            taskENTER_CRITICAL();
+            {
+                pxSocket->u.xUDP.ulRemoteIP = pxAddress->sin_addr;
+                pxSocket->u.xUDP.usRemotePort = pxAddress->sin_port;
+                pxSocket->u.xUDP.xTemplateValid = pdFALSE;
+            }
+            taskEXIT_CRITICAL();
+        }
+
+        return xResult;
+    }
+
+#endif /* ipconfigUSE_UDP_CONNECT */
+/*-----------------------------------------------------------*/
+
 #if ( ipconfigUSE_TCP == 1 )
 
 /**
- * @brief Connect to a remote port.
+ * @brief Connect to a remote port.  When ipconfigUSE_UDP_CONNECT is defined,
+ *        a UDP socket may also be connected: it will then only exchange
+ *        datagrams with the given peer.
  *
  * @param[in] xClientSocket: The socket initiating the connection.
  * @param[in] pxAddress: The address of the remote socket.
@@ -3029,58 +3933,68 @@ void vSocketWakeUpUser( FreeRTOS_Socket_t * pxSocket )
 
         ( void ) xAddressLength;
 
-        xResult = prvTCPConnectStart( pxSocket, pxAddress );
-
-        if( xResult == 0 )
+        #if ( ipconfigUSE_UDP_CONNECT == 1 )
+            if( prvValidSocket( pxSocket, FREERTOS_IPPROTO_UDP, pdFALSE ) != pdFALSE )
+            {
+                /* A UDP socket gets connected immediately. */
+                xResult = prvUDPConnect( pxSocket, pxAddress );
+            }
+            else
+        #endif /* ipconfigUSE_UDP_CONNECT */
         {
-            /* And wait for the result */
-            for( ; ; )
+            xResult = prvTCPConnectStart( pxSocket, pxAddress );
+
+            if( xResult == 0 )
             {
-                if( xTimed == pdFALSE )
+                /* And wait for the result */
+                for( ; ; )
                 {
-                    /* Only in the first round, check for non-blocking */
-                    xRemainingTime = pxSocket->xReceiveBlockTime;
-
-                    if( xRemainingTime == ( TickType_t ) 0 )
+                    if( xTimed == pdFALSE )
                     {
-                        /* Not yet connected, correct state, non-blocking. */
-                        xResult = -pdFREERTOS_ERRNO_EWOULDBLOCK;
-                        break;
-                    }
+                        /* Only in the first round, check for non-blocking */
+                        xRemainingTime = pxSocket->xReceiveBlockTime;
 
-                    /* Don't get here a second time. */
-                    xTimed = pdTRUE;
+                        if( xRemainingTime == ( TickType_t ) 0 )
+                        {
+                            /* Not yet connected, correct state, non-blocking. */
+                            xResult = -pdFREERTOS_ERRNO_EWOULDBLOCK;
+                            break;
+                        }
 
-                    /* Fetch the current time */
-                    vTaskSetTimeOutState( &xTimeOut );
-                }
+                        /* Don't get here a second time. */
+                        xTimed = pdTRUE;
 
-                /* Did it get connected while sleeping ? */
-                xResult = FreeRTOS_issocketconnected( pxSocket );
+                        /* Fetch the current time */
+                        vTaskSetTimeOutState( &xTimeOut );
+                    }
 
-                /* Returns positive when connected, negative means an error */
-                if( xResult < 0 )
-                {
-                    /* Return the error */
-                    break;
-                }
+                    /* Did it get connected while sleeping ? */
+                    xResult = FreeRTOS_issocketconnected( pxSocket );
 
-                if( xResult > 0 )
-                {
-                    /* Socket now connected, return a zero */
-                    xResult = 0;
-                    break;
-                }
+                    /* Returns positive when connected, negative means an error */
+                    if( xResult < 0 )
+                    {
+                        /* Return the error */
+                        break;
+                    }
 
-                /* Is it allowed to sleep more? */
-                if( xTaskCheckForTimeOut( &xTimeOut, &xRemainingTime ) != pdFALSE )
-                {
-                    xResult = -pdFREERTOS_ERRNO_ETIMEDOUT;
-                    break;
-                }
+                    if( xResult > 0 )
+                    {
+                        /* Socket now connected, return a zero */
+                        xResult = 0;
+                        break;
+                    }
 
-                /* Go sleeping until we get any down-stream event */
-                ( void ) xEventGroupWaitBits( pxSocket->xEventGroup, ( EventBits_t ) eSOCKET_CONNECT, pdTRUE /*xClearOnExit*/, pdFALSE /*xWaitAllBits*/, xRemainingTime );
+                    /* Is it allowed to sleep more? */
+                    if( xTaskCheckForTimeOut( &xTimeOut, &xRemainingTime ) != pdFALSE )
+                    {
+                        xResult = -pdFREERTOS_ERRNO_ETIMEDOUT;
+                        break;
+                    }
+
+                    /* Go sleeping until we get any down-stream event */
+                    ( void ) prvSocketWaitEventBits( pxSocket, ( EventBits_t ) eSOCKET_CONNECT, xRemainingTime );
+                }
             }
         }
 
@@ -3220,7 +4134,7 @@ void vSocketWakeUpUser( FreeRTOS_Socket_t * pxSocket )
                 }
 
                 /* Go sleeping until we get any down-stream event */
-                ( void ) xEventGroupWaitBits( pxSocket->xEventGroup, ( EventBits_t ) eSOCKET_ACCEPT, pdTRUE /*xClearOnExit*/, pdFALSE /*xWaitAllBits*/, xRemainingTime );
+                ( void ) prvSocketWaitEventBits( pxSocket, ( EventBits_t ) eSOCKET_ACCEPT, xRemainingTime );
             }
         }
 
@@ -3272,6 +4186,8 @@ void vSocketWakeUpUser( FreeRTOS_Socket_t * pxSocket )
         }
         else
         {
+            socketSTREAM_ENTER( pxSocket );
+
             if( pxSocket->u.xTCP.rxStream != NULL )
             {
                 xByteCount = ( BaseType_t ) uxStreamBufferGetSize( pxSocket->u.xTCP.rxStream );
@@ -3331,8 +4247,7 @@ void vSocketWakeUpUser( FreeRTOS_Socket_t * pxSocket )
                         #if ( ipconfigSUPPORT_SIGNALS != 0 )
                             {
                                 /* Just check for the interrupt flag. */
-                                xEventBits = xEventGroupWaitBits( pxSocket->xEventGroup, ( EventBits_t ) eSOCKET_INTR,
-                                                                  pdTRUE /*xClearOnExit*/, pdFALSE /*xWaitAllBits*/, socketDONT_BLOCK );
+                                xEventBits = prvSocketWaitEventBits( pxSocket, ( EventBits_t ) eSOCKET_INTR, socketDONT_BLOCK );
                             }
                         #endif /* ipconfigSUPPORT_SIGNALS */
                         break;
@@ -3357,9 +4272,11 @@ void vSocketWakeUpUser( FreeRTOS_Socket_t * pxSocket )
                 }
 
                 /* Block until there is a down-stream event. */
-                xEventBits = xEventGroupWaitBits( pxSocket->xEventGroup,
-                                                  ( EventBits_t ) eSOCKET_RECEIVE | ( EventBits_t ) eSOCKET_CLOSED | ( EventBits_t ) eSOCKET_INTR,
-                                                  pdTRUE /*xClearOnExit*/, pdFALSE /*xWaitAllBits*/, xRemainingTime );
+                socketSTREAM_LEAVE( pxSocket );
+                xEventBits = prvSocketWaitEventBits( pxSocket,
+                                                     ( EventBits_t ) eSOCKET_RECEIVE | ( EventBits_t ) eSOCKET_CLOSED | ( EventBits_t ) eSOCKET_INTR,
+                                                     xRemainingTime );
+                socketSTREAM_ENTER( pxSocket );
                 #if ( ipconfigSUPPORT_SIGNALS != 0 )
                     {
                         if( ( xEventBits & ( EventBits_t ) eSOCKET_INTR ) != 0U )
@@ -3390,7 +4307,7 @@ void vSocketWakeUpUser( FreeRTOS_Socket_t * pxSocket )
                     {
                         /* Shouldn't have cleared other flags. */
                         xEventBits &= ~( ( EventBits_t ) eSOCKET_INTR );
-                        ( void ) xEventGroupSetBits( pxSocket->xEventGroup, xEventBits );
+                        vSocketSetEventBits( pxSocket, xEventBits );
                     }
 
                     xByteCount = -pdFREERTOS_ERRNO_EINTR;
@@ -3405,11 +4322,10 @@ void vSocketWakeUpUser( FreeRTOS_Socket_t * pxSocket )
                     BaseType_t xIsPeek = ( ( ( uint32_t ) xFlags & ( uint32_t ) FREERTOS_MSG_PEEK ) != 0U ) ? 1L : 0L;
 
                     xByteCount = ( BaseType_t )
-                                 uxStreamBufferGet( pxSocket->u.xTCP.rxStream,
-                                                    0UL,
-                                                    ipPOINTER_CAST( uint8_t *, pvBuffer ),
-                                                    ( size_t ) uxBufferLength,
-                                                    xIsPeek );
+                                 prvTCPRxGet( pxSocket,
+                                              ipPOINTER_CAST( uint8_t *, pvBuffer ),
+                                              ( size_t ) uxBufferLength,
+                                              xIsPeek );
 
                     if( pxSocket->u.xTCP.bits.bLowWater != pdFALSE_UNSIGNED )
                     {
@@ -3417,7 +4333,7 @@ void vSocketWakeUpUser( FreeRTOS_Socket_t * pxSocket )
                          * can be cleared */
                         size_t uxFrontSpace = uxStreamBufferFrontSpace( pxSocket->u.xTCP.rxStream );
 
-                        if( uxFrontSpace >= pxSocket->u.xTCP.uxEnoughSpace )
+                        if( uxFrontSpace >= socketENOUGH_SPACE( pxSocket ) )
                         {
                             pxSocket->u.xTCP.bits.bLowWater = pdFALSE;
                             pxSocket->u.xTCP.bits.bWinChange = pdTRUE;
@@ -3429,13 +4345,16 @@ void vSocketWakeUpUser( FreeRTOS_Socket_t * pxSocket )
                 else
                 {
                     /* Zero-copy reception of data: pvBuffer is a pointer to a pointer. */
-                    xByteCount = ( BaseType_t ) uxStreamBufferGetPtr( pxSocket->u.xTCP.rxStream, ipPOINTER_CAST( uint8_t * *, pvBuffer ) );
+                    socketSTREAM_PIN( pxSocket );
+                    xByteCount = ( BaseType_t ) prvTCPRxGetPtr( pxSocket, ipPOINTER_CAST( uint8_t * *, pvBuffer ) );
                 }
             }
             else
             {
                 /* Nothing. */
             }
+
+            socketSTREAM_LEAVE( pxSocket );
         } /* prvValidSocket() */
 
         return xByteCount;
@@ -3488,20 +4407,23 @@ void vSocketWakeUpUser( FreeRTOS_Socket_t * pxSocket )
             /* send() is being called to send zero bytes */
             xResult = 0;
         }
-        else if( pxSocket->u.xTCP.txStream == NULL )
+        else
         {
-            /* Create the outgoing stream only when it is needed */
-            ( void ) prvTCPCreateStream( pxSocket, pdFALSE );
+            /* FreeRTOS_send() will leave when it is done with txStream. */
+            socketSTREAM_ENTER( pxSocket );
 
             if( pxSocket->u.xTCP.txStream == NULL )
             {
-                xResult = -pdFREERTOS_ERRNO_ENOMEM;
+                /* Create the outgoing stream only when it is needed */
+                ( void ) prvTCPCreateStream( pxSocket, pdFALSE );
+
+                if( pxSocket->u.xTCP.txStream == NULL )
+                {
+                    socketSTREAM_LEAVE( pxSocket );
+                    xResult = -pdFREERTOS_ERRNO_ENOMEM;
+                }
             }
         }
-        else
-        {
-            /* Nothing. */
-        }
 
         return xResult;
     }
@@ -3533,12 +4455,14 @@ void vSocketWakeUpUser( FreeRTOS_Socket_t * pxSocket )
          * member pointers. */
         if( prvValidSocket( pxSocket, FREERTOS_IPPROTO_TCP, pdFALSE ) == pdTRUE )
         {
+            socketSTREAM_PIN( pxSocket );
             pxBuffer = pxSocket->u.xTCP.txStream;
 
             if( pxBuffer != NULL )
             {
                 size_t uxSpace = uxStreamBufferGetSpace( pxBuffer );
-                size_t uxRemain = pxBuffer->LENGTH - pxBuffer->uxHead;
+                size_t uxHead = uxStreamBufferIndex( pxBuffer, pxBuffer->uxHead );
+                size_t uxRemain = pxBuffer->LENGTH - uxHead;
 
                 if( uxRemain <= uxSpace )
                 {
@@ -3549,7 +4473,7 @@ void vSocketWakeUpUser( FreeRTOS_Socket_t * pxSocket )
                     *pxLength = uxSpace;
                 }
 
-                pucReturn = &( pxBuffer->ucArray[ pxBuffer->uxHead ] );
+                pucReturn = &( pxBuffer->ucArray[ uxHead ] );
             }
         }
 
@@ -3561,22 +4485,147 @@ void vSocketWakeUpUser( FreeRTOS_Socket_t * pxSocket )
 #if ( ipconfigUSE_TCP == 1 )
 
 /**
- * @brief Send data using a TCP socket. It is not necessary to have the socket
- *        connected already. Outgoing data will be stored and delivered as soon as
- *        the socket gets connected.
+ * @brief Get the data in the circular receive buffer as two spans, so that
+ *        it can be parsed in place.  The data stays in the buffer until it
+ *        is removed with FreeRTOS_recv( xSocket, NULL, uxCount, 0 ).
  *
- * @param[in] xSocket: The socket owning the connection.
- * @param[in] pvBuffer: The buffer containing the data. The value of this pointer
- *                      may be NULL in case zero-copy transmissions are used.
- *                      It is used in combination with 'FreeRTOS_get_tx_head()'.
- * @param[in] uxDataLength: The length of the data to be added.
- * @param[in] xFlags: This parameter is not used. (zero or FREERTOS_MSG_DONTWAIT).
+ * @param[in] xSocket: The socket owning the buffer.
+ * @param[out] pxSpans: An array of two spans, the second one is used when
+ *                      the data wraps around.
  *
- * @return The number of bytes actually sent. Zero when nothing could be sent
- *         or a negative error code in case an error occurred.
+ * @return The total number of bytes in the spans, or -pdFREERTOS_ERRNO_EINVAL
+ *         when the socket is not a valid TCP socket.
  */
-    BaseType_t FreeRTOS_send( Socket_t xSocket,
-                              const void * pvBuffer,
+    BaseType_t FreeRTOS_get_rx_spans( ConstSocket_t xSocket,
+                                      StreamSpan_t * pxSpans )
+    {
+        const FreeRTOS_Socket_t * pxSocket = ( const FreeRTOS_Socket_t * ) xSocket;
+        BaseType_t xReturn;
+
+        if( prvValidSocket( pxSocket, FREERTOS_IPPROTO_TCP, pdFALSE ) == pdFALSE )
+        {
+            xReturn = -pdFREERTOS_ERRNO_EINVAL;
+        }
+        else
+        {
+            /* A pointer into the stream will be given to the user. */
+            socketSTREAM_PIN( pxSocket );
+
+            if( pxSocket->u.xTCP.rxStream == NULL )
+            {
+                ( void ) memset( pxSpans, 0, 2U * sizeof( *pxSpans ) );
+                xReturn = 0;
+            }
+            else
+            {
+                #if ( ipconfigUSE_TCP_RX_CHAIN == 1 )
+                    {
+                        /* The data is kept in network buffers, the first two of
+                         * them are returned. */
+                        RxChain_t * pxChain = ipCAST_PTR_TO_TYPE_PTR( RxChain_t, pxSocket->u.xTCP.rxStream );
+                        size_t uxSize, uxLength;
+                        UBaseType_t uxIndex;
+
+                        ( void ) memset( pxSpans, 0, 2U * sizeof( *pxSpans ) );
+
+                        vTaskSuspendAll();
+                        {
+                            uxSize = uxStreamBufferGetSize( &( pxChain->xStream ) );
+                            xReturn = 0;
+
+                            for( uxIndex = 0U; uxIndex < 2U; uxIndex++ )
+                            {
+                                if( ( uxIndex < pxChain->uxCount ) &&
+                                    ( ( pxChain->xLinks[ uxIndex ].uxStart - pxChain->uxConsumed ) == ( size_t ) xReturn ) &&
+                                    ( ( size_t ) xReturn < uxSize ) )
+                                {
+                                    uxLength = FreeRTOS_min_uint32( pxChain->xLinks[ uxIndex ].uxLength, uxSize - ( size_t ) xReturn );
+                                    pxSpans[ uxIndex ].pucData = pxChain->xLinks[ uxIndex ].pucData;
+                                    pxSpans[ uxIndex ].uxLength = uxLength;
+                                    xReturn += ( BaseType_t ) uxLength;
+                                }
+                            }
+                        }
+                        ( void ) xTaskResumeAll();
+                    }
+                #else
+                    {
+                        xReturn = ( BaseType_t ) uxStreamBufferPeekData( pxSocket->u.xTCP.rxStream, 0U, pxSpans );
+                    }
+                #endif /* ipconfigUSE_TCP_RX_CHAIN */
+            }
+        }
+
+        return xReturn;
+    }
+#endif /* ipconfigUSE_TCP */
+/*-----------------------------------------------------------*/
+
+#if ( ipconfigUSE_TCP == 1 )
+
+/**
+ * @brief Get the free space of the circular transmit buffer as two spans, so
+ *        that data can be written in place.  The data is sent after calling
+ *        FreeRTOS_send( xSocket, NULL, uxCount, 0 ).
+ *
+ * @param[in] xSocket: The socket owning the buffer.
+ * @param[out] pxSpans: An array of two spans, the second one is used when
+ *                      the space wraps around.
+ *
+ * @return The total number of bytes in the spans, or -pdFREERTOS_ERRNO_EINVAL
+ *         when the socket is not a valid TCP socket.
+ */
+    BaseType_t FreeRTOS_get_tx_spans( ConstSocket_t xSocket,
+                                      StreamSpan_t * pxSpans )
+    {
+        const FreeRTOS_Socket_t * pxSocket = ( const FreeRTOS_Socket_t * ) xSocket;
+        BaseType_t xReturn;
+
+        if( prvValidSocket( pxSocket, FREERTOS_IPPROTO_TCP, pdFALSE ) == pdFALSE )
+        {
+            xReturn = -pdFREERTOS_ERRNO_EINVAL;
+        }
+        else
+        {
+            /* A pointer into the stream will be given to the user. */
+            socketSTREAM_PIN( pxSocket );
+
+            if( pxSocket->u.xTCP.txStream == NULL )
+            {
+                /* The stream is created by the first call to FreeRTOS_send(). */
+                ( void ) memset( pxSpans, 0, 2U * sizeof( *pxSpans ) );
+                xReturn = 0;
+            }
+            else
+            {
+                xReturn = ( BaseType_t ) uxStreamBufferPeekSpace( pxSocket->u.xTCP.txStream, 0U, pxSpans );
+            }
+        }
+
+        return xReturn;
+    }
+#endif /* ipconfigUSE_TCP */
+/*-----------------------------------------------------------*/
+
+#if ( ipconfigUSE_TCP == 1 )
+
+/**
+ * @brief Send data using a TCP socket. It is not necessary to have the socket
+ *        connected already. Outgoing data will be stored and delivered as soon as
+ *        the socket gets connected.
+ *
+ * @param[in] xSocket: The socket owning the connection.
+ * @param[in] pvBuffer: The buffer containing the data. The value of this pointer
+ *                      may be NULL in case zero-copy transmissions are used.
+ *                      It is used in combination with 'FreeRTOS_get_tx_head()'.
+ * @param[in] uxDataLength: The length of the data to be added.
+ * @param[in] xFlags: This parameter is not used. (zero or FREERTOS_MSG_DONTWAIT).
+ *
+ * @return The number of bytes actually sent. Zero when nothing could be sent
+ *         or a negative error code in case an error occurred.
+ */
+    BaseType_t FreeRTOS_send( Socket_t xSocket,
+                              const void * pvBuffer,
                               size_t uxDataLength,
                               BaseType_t xFlags )
     {
@@ -3589,6 +4638,10 @@ void vSocketWakeUpUser( FreeRTOS_Socket_t * pxSocket )
         BaseType_t xCloseAfterSend;
         const uint8_t * pucSource = ipPOINTER_CAST( const uint8_t *, pvBuffer );
 
+        #if ( ipconfigUSE_TCP_ELASTIC_STREAMS == 1 )
+            BaseType_t xGrowTxStream = pdFALSE;
+        #endif
+
         /* Prevent compiler warnings about unused parameters.  The parameter
          * may be used in future versions. */
         ( void ) xFlags;
@@ -3676,6 +4729,18 @@ void vSocketWakeUpUser( FreeRTOS_Socket_t * pxSocket )
                     pucSource = &( pucSource[ xByteCount ] );
                 }
 
+                #if ( ipconfigUSE_TCP_ELASTIC_STREAMS == 1 )
+                    {
+                        /* txStream is full.  Whether or not this call blocks,
+                         * the IP-task will be asked to let it grow, as soon as
+                         * this task stops using it. */
+                        if( prvTCPStreamCapacity( pxSocket->u.xTCP.txStream ) < pxSocket->u.xTCP.uxTxStreamSize )
+                        {
+                            xGrowTxStream = pdTRUE;
+                        }
+                    }
+                #endif
+
                 /* Not all bytes have been sent. In case the socket is marked as
                  * blocking sleep for a while. */
                 if( xTimed == pdFALSE )
@@ -3722,12 +4787,47 @@ void vSocketWakeUpUser( FreeRTOS_Socket_t * pxSocket )
                 }
 
                 /* Go sleeping until down-stream events are received. */
-                ( void ) xEventGroupWaitBits( pxSocket->xEventGroup, ( EventBits_t ) eSOCKET_SEND | ( EventBits_t ) eSOCKET_CLOSED,
-                                              pdTRUE /*xClearOnExit*/, pdFALSE /*xWaitAllBits*/, xRemainingTime );
+                socketSTREAM_LEAVE( pxSocket );
+
+                #if ( ipconfigUSE_TCP_ELASTIC_STREAMS == 1 )
+                    {
+                        if( xGrowTxStream != pdFALSE )
+                        {
+                            xGrowTxStream = pdFALSE;
+                            prvTCPStreamRequestTxGrowth( pxSocket );
+                        }
+                    }
+                #endif
+                ( void ) prvSocketWaitEventBits( pxSocket, ( EventBits_t ) eSOCKET_SEND | ( EventBits_t ) eSOCKET_CLOSED, xRemainingTime );
+                socketSTREAM_ENTER( pxSocket );
+
+                #if ( ipconfigUSE_TCP_ELASTIC_STREAMS == 1 )
+                    {
+                        /* The stream may have been released in the mean time. */
+                        if( ( pxSocket->u.xTCP.txStream == NULL ) &&
+                            ( prvTCPCreateStream( pxSocket, pdFALSE ) == NULL ) )
+                        {
+                            break;
+                        }
+                    }
+                #endif
 
                 xByteCount = ( BaseType_t ) uxStreamBufferGetSpace( pxSocket->u.xTCP.txStream );
             }
 
+            socketSTREAM_LEAVE( pxSocket );
+
+            #if ( ipconfigUSE_TCP_ELASTIC_STREAMS == 1 )
+                {
+                    /* A non-blocking call, a call from a call-back or a call
+                     * that timed out: let txStream grow before the next call. */
+                    if( xGrowTxStream != pdFALSE )
+                    {
+                        prvTCPStreamRequestTxGrowth( pxSocket );
+                    }
+                }
+            #endif
+
             /* How much was actually sent? */
             xByteCount = ( ( BaseType_t ) uxDataLength ) - xBytesLeft;
 
@@ -3799,9 +4899,17 @@ void vSocketWakeUpUser( FreeRTOS_Socket_t * pxSocket )
              * reused as it might have had a previous connection. */
             if( pxSocket->u.xTCP.bits.bReuseSocket != pdFALSE_UNSIGNED )
             {
+                socketSTREAM_ENTER( pxSocket );
+
                 if( pxSocket->u.xTCP.rxStream != NULL )
                 {
                     vStreamBufferClear( pxSocket->u.xTCP.rxStream );
+
+                    #if ( ipconfigUSE_TCP_RX_CHAIN == 1 )
+                        {
+                            prvRxChainClear( ipCAST_PTR_TO_TYPE_PTR( RxChain_t, pxSocket->u.xTCP.rxStream ) );
+                        }
+                    #endif
                 }
 
                 if( pxSocket->u.xTCP.txStream != NULL )
@@ -3809,6 +4917,8 @@ void vSocketWakeUpUser( FreeRTOS_Socket_t * pxSocket )
                     vStreamBufferClear( pxSocket->u.xTCP.txStream );
                 }
 
+                socketSTREAM_LEAVE( pxSocket );
+
                 ( void ) memset( pxSocket->u.xTCP.xPacket.u.ucLastPacket, 0, sizeof( pxSocket->u.xTCP.xPacket.u.ucLastPacket ) );
                 ( void ) memset( &pxSocket->u.xTCP.xTCPWindow, 0, sizeof( pxSocket->u.xTCP.xTCPWindow ) );
                 ( void ) memset( &pxSocket->u.xTCP.bits, 0, sizeof( pxSocket->u.xTCP.bits ) );
@@ -3877,6 +4987,92 @@ void vSocketWakeUpUser( FreeRTOS_Socket_t * pxSocket )
 #endif /* ipconfigUSE_TCP */
 /*-----------------------------------------------------------*/
 
+#if ( ( ipconfigUSE_TCP == 1 ) && ( ipconfigTCP_WAKEUP_LOW_WATER == 1 ) )
+
+/**
+ * @brief Check the receive and send events of a TCP socket against its
+ *        low-water marks.  eSOCKET_RECEIVE is held back as long as fewer than
+ *        'uxRcvLowat' bytes can be read, eSOCKET_SEND as long as less than
+ *        'uxSndLowat' bytes of space are available.  Held events are released
+ *        when the mark is reached, when any other event occurs, when the
+ *        connection leaves the established state, or after
+ *        ipconfigTCP_WAKEUP_LOW_WATER_MS.
+ *
+ * @param[in] pxSocket: The TCP socket to be checked.
+ * @param[in] xNow: The current time in ticks.
+ *
+ * @return The number of ticks after which the held events must be delivered,
+ *         or zero when no events are held back.
+ */
+    static TickType_t prvTCPHoldLowWaterEvents( FreeRTOS_Socket_t * pxSocket,
+                                                TickType_t xNow )
+    {
+        EventBits_t xReceiveBits = ( EventBits_t ) eSOCKET_RECEIVE;
+        EventBits_t xSendBits = ( EventBits_t ) eSOCKET_SEND;
+        const TickType_t xMaxHoldTime = ipMS_TO_MIN_TICKS( ipconfigTCP_WAKEUP_LOW_WATER_MS );
+        IPTCPSocket_t * pxTCP = &( pxSocket->u.xTCP );
+        EventBits_t xBits = pxSocket->xEventBits | pxTCP->xHeldEventBits;
+        EventBits_t xHeld = 0U;
+        TickType_t xRemaining = 0U;
+
+        #if ( ipconfigSUPPORT_SELECT_FUNCTION == 1 )
+            {
+                /* The select() bits are held back along with the regular bits. */
+                xReceiveBits |= ( ( EventBits_t ) eSELECT_READ ) << SOCKET_EVENT_BIT_COUNT;
+                xSendBits |= ( ( EventBits_t ) eSELECT_WRITE ) << SOCKET_EVENT_BIT_COUNT;
+            }
+        #endif /* ipconfigSUPPORT_SELECT_FUNCTION */
+
+        if( pxTCP->xHeldEventBits == 0U )
+        {
+            /* Nothing was held yet, start counting from now. */
+            pxTCP->xHeldSince = xNow;
+        }
+
+        /* Only hold back events in the established state, and only when no
+         * other event is pending. */
+        if( ( pxTCP->ucTCPState == ( uint8_t ) eESTABLISHED ) &&
+            ( ( xBits & ~( xReceiveBits | xSendBits ) ) == 0U ) &&
+            ( ( xNow - pxTCP->xHeldSince ) < xMaxHoldTime ) )
+        {
+            if( ( ( xBits & ( EventBits_t ) eSOCKET_RECEIVE ) != 0U ) &&
+                ( pxTCP->uxRcvLowat > 1U ) &&
+                ( pxTCP->rxStream != NULL ) &&
+                ( pxTCP->bits.bLowWater == pdFALSE_UNSIGNED ) &&
+                ( uxStreamBufferGetSize( pxTCP->rxStream ) < pxTCP->uxRcvLowat ) )
+            {
+                xHeld |= xBits & xReceiveBits;
+            }
+
+            if( ( ( xBits & ( EventBits_t ) eSOCKET_SEND ) != 0U ) &&
+                ( pxTCP->uxSndLowat > 1U ) &&
+                ( pxTCP->txStream != NULL ) &&
+                ( uxStreamBufferGetSize( pxTCP->txStream ) != 0U ) &&
+                ( uxStreamBufferGetSpace( pxTCP->txStream ) < pxTCP->uxSndLowat ) )
+            {
+                xHeld |= xBits & xSendBits;
+            }
+        }
+
+        if( xHeld != 0U )
+        {
+            if( ( pxSocket->xEventBits & xHeld ) != 0U )
+            {
+                iptraceTCP_WAKE_UP_HELD( pxSocket, pxSocket->xEventBits & xHeld );
+            }
+
+            xRemaining = xMaxHoldTime - ( xNow - pxTCP->xHeldSince );
+        }
+
+        pxTCP->xHeldEventBits = xHeld;
+        pxSocket->xEventBits = xBits & ~xHeld;
+
+        return xRemaining;
+    }
+
+#endif /* ( ipconfigUSE_TCP == 1 ) && ( ipconfigTCP_WAKEUP_LOW_WATER == 1 ) */
+/*-----------------------------------------------------------*/
+
 #if ( ipconfigUSE_TCP == 1 )
 
 /**
@@ -3913,13 +5109,25 @@ void vSocketWakeUpUser( FreeRTOS_Socket_t * pxSocket )
             pxSocket = ipCAST_PTR_TO_TYPE_PTR( FreeRTOS_Socket_t, listGET_LIST_ITEM_OWNER( pxIterator ) );
             pxIterator = ( ListItem_t * ) listGET_NEXT( pxIterator );
 
-            /* Sockets with 'timeout == 0' do not need any regular attention. */
-            if( pxSocket->u.xTCP.usTimeout == 0U )
+            #if ( ipconfigUSE_TCP_ELASTIC_STREAMS == 1 )
+                {
+                    /* Also idle sockets may give back their empty streams. */
+                    prvTCPStreamCheckIdle( pxSocket, xNow );
+                }
+            #endif
+
+            /* Sockets with 'timeout == 0' do not need any regular attention,
+             * unless they hold back events that must be delivered in time. */
+            if( ( pxSocket->u.xTCP.usTimeout == 0U ) && ( socketHOLDS_EVENTS( pxSocket ) == pdFALSE ) )
             {
                 continue;
             }
 
-            if( xDelta < ( TickType_t ) pxSocket->u.xTCP.usTimeout )
+            if( pxSocket->u.xTCP.usTimeout == 0U )
+            {
+                /* Only the held events need attention. */
+            }
+            else if( xDelta < ( TickType_t ) pxSocket->u.xTCP.usTimeout )
             {
                 pxSocket->u.xTCP.usTimeout = ( uint16_t ) ( ( ( TickType_t ) pxSocket->u.xTCP.usTimeout ) - xDelta );
             }
@@ -3939,6 +5147,19 @@ void vSocketWakeUpUser( FreeRTOS_Socket_t * pxSocket )
                 }
             }
 
+            #if ( ipconfigTCP_WAKEUP_LOW_WATER == 1 )
+                {
+                    /* Hold back receive and send events as long as the
+                     * low-water marks have not been reached. */
+                    TickType_t xHoldTime = prvTCPHoldLowWaterEvents( pxSocket, xNow );
+
+                    if( ( xHoldTime != 0U ) && ( xShortest > xHoldTime ) )
+                    {
+                        xShortest = xHoldTime;
+                    }
+                }
+            #endif /* ipconfigTCP_WAKEUP_LOW_WATER */
+
             /* In xEventBits the driver may indicate that the socket has
              * important events for the user.  These are only done just before the
              * IP-task goes to sleep. */
@@ -4049,6 +5270,8 @@ void vSocketWakeUpUser( FreeRTOS_Socket_t * pxSocket )
  * @param[in] xSocket: The socket whose Rx stream is to be returned.
  *
  * @return The Rx stream of the socket if all checks pass, else NULL.
+ *         When ipconfigUSE_TCP_RX_CHAIN is enabled, the data is not kept in a
+ *         circular buffer and NULL is returned, use FreeRTOS_get_rx_spans().
  */
     const struct xSTREAM_BUFFER * FreeRTOS_get_rx_buf( ConstSocket_t xSocket )
     {
@@ -4058,10 +5281,17 @@ void vSocketWakeUpUser( FreeRTOS_Socket_t * pxSocket )
 
         /* Confirm that this is a TCP socket before dereferencing structure
          * member pointers. */
-        if( prvValidSocket( pxSocket, FREERTOS_IPPROTO_TCP, pdFALSE ) == pdTRUE )
-        {
-            pxReturn = pxSocket->u.xTCP.rxStream;
-        }
+        #if ( ipconfigUSE_TCP_RX_CHAIN == 0 )
+            if( prvValidSocket( pxSocket, FREERTOS_IPPROTO_TCP, pdFALSE ) == pdTRUE )
+            {
+                socketSTREAM_PIN( pxSocket );
+                pxReturn = pxSocket->u.xTCP.rxStream;
+            }
+        #else
+            {
+                ( void ) pxSocket;
+            }
+        #endif
 
         return pxReturn;
     }
@@ -4084,7 +5314,6 @@ void vSocketWakeUpUser( FreeRTOS_Socket_t * pxSocket )
     {
         StreamBuffer_t * pxBuffer;
         size_t uxLength;
-        size_t uxSize;
 
         /* Now that a stream is created, the maximum size is fixed before
          * creation, it could still be changed with setsockopt(). */
@@ -4107,199 +5336,1298 @@ void vSocketWakeUpUser( FreeRTOS_Socket_t * pxSocket )
             uxLength = pxSocket->u.xTCP.uxTxStreamSize;
         }
 
-        /* Add an extra 4 (or 8) bytes. */
-        uxLength += sizeof( size_t );
+        #if ( ipconfigUSE_TCP_ELASTIC_STREAMS == 1 )
+            {
+                /* Start small, the stream will grow when needed. */
+                uxLength = uxTCPStreamInitialSize( pxSocket, xIsInputStream );
+            }
+        #endif
+
+        pxBuffer = prvTCPAllocStream( pxSocket, xIsInputStream, uxLength );
+
+        if( pxBuffer == NULL )
+        {
+            FreeRTOS_debug_printf( ( "prvTCPCreateStream: malloc failed\n" ) );
+            pxSocket->u.xTCP.bits.bMallocError = pdTRUE;
+            vTCPStateChange( pxSocket, eCLOSE_WAIT );
+        }
+        else
+        {
+            #if ( ipconfigUSE_TCP_ELASTIC_STREAMS == 1 )
+                {
+                    pxSocket->u.xTCP.xStreamActiveTime = xTaskGetTickCount();
+                }
+            #endif
+
+            if( xIsInputStream != 0 )
+            {
+                pxSocket->u.xTCP.rxStream = pxBuffer;
+            }
+            else
+            {
+                pxSocket->u.xTCP.txStream = pxBuffer;
+            }
+        }
+
+        return pxBuffer;
+    }
+    /*-----------------------------------------------------------*/
+
+/**
+ * @brief Allocate a stream buffer for the given socket, without attaching it.
+ *
+ * @param[in] pxSocket: the socket to create the stream for.
+ * @param[in] xIsInputStream: Is this input stream? pdTRUE/pdFALSE?
+ * @param[in] uxCapacity: The minimum number of bytes that the stream must be
+ *                        able to store.
+ *
+ * @return The stream buffer, or NULL when the allocation failed.
+ */
+    static StreamBuffer_t * prvTCPAllocStream( FreeRTOS_Socket_t * pxSocket,
+                                               BaseType_t xIsInputStream,
+                                               size_t uxCapacity )
+    {
+        StreamBuffer_t * pxBuffer;
+        size_t uxLength = uxCapacity;
+        size_t uxSize;
+
+        #if ( ipconfigUSE_POW2_STREAM_BUFFERS == 1 )
+            size_t uxPow2Length;
+        #endif
+
+        #if ( ipconfigUSE_POW2_STREAM_BUFFERS == 1 )
+            {
+                /* Find the smallest power of two that can hold uxLength bytes.
+                 * Such a stream does not need a spare byte.  It must be longer
+                 * than a segment, so that a distance of zero never stands for
+                 * a segment that covers the whole stream. */
+                uxPow2Length = 1U;
+
+                while( uxPow2Length < uxLength )
+                {
+                    uxPow2Length <<= 1;
+                }
+
+                if( ( uxPow2Length <= ( size_t ) pxSocket->u.xTCP.usMSS ) ||
+                    ( ( uxPow2Length - uxLength ) > ( ( uxLength * ( size_t ) ipconfigPOW2_STREAM_MAX_GROWTH ) / 100U ) ) )
+                {
+                    uxPow2Length = 0U;
+                }
+
+                #if ( ipconfigUSE_SOCKET_POOL == 1 )
+                    if( uxPow2Length > ( size_t ) ipconfigSOCKET_POOL_STREAM_SIZE )
+                    {
+                        uxPow2Length = 0U;
+                    }
+                #endif
+            }
+        #endif /* ipconfigUSE_POW2_STREAM_BUFFERS */
+
+        #if ( ipconfigUSE_POW2_STREAM_BUFFERS == 1 )
+            if( uxPow2Length != 0U )
+            {
+                uxLength = uxPow2Length;
+            }
+            else
+        #endif
+        {
+            /* Add an extra 4 (or 8) bytes. */
+            uxLength += sizeof( size_t );
 
-        /* And make the length a multiple of sizeof( size_t ). */
-        uxLength &= ~( sizeof( size_t ) - 1U );
+            /* And make the length a multiple of sizeof( size_t ). */
+            uxLength &= ~( sizeof( size_t ) - 1U );
+        }
 
         uxSize = ( sizeof( *pxBuffer ) + uxLength ) - sizeof( pxBuffer->ucArray );
 
-        pxBuffer = ipCAST_PTR_TO_TYPE_PTR( StreamBuffer_t, pvPortMallocLarge( uxSize ) );
+        #if ( ipconfigUSE_TCP_RX_CHAIN == 1 )
+            if( xIsInputStream != pdFALSE )
+            {
+                /* The data will be kept in network buffers, only the markers
+                 * and the links are needed. */
+                uxSize = sizeof( RxChain_t );
+            }
+        #endif
+
+        #if ( ipconfigUSE_SOCKET_POOL == 1 )
+            {
+                /* Stream buffers that don't fit in a pool object can not be
+                 * created, this is handled like a failing malloc. */
+                if( uxSize <= xStreamPool.uxObjectSize )
+                {
+                    pxBuffer = ipCAST_PTR_TO_TYPE_PTR( StreamBuffer_t, pvSocketPoolTake( &( xStreamPool ) ) );
+                }
+                else
+                {
+                    pxBuffer = NULL;
+                }
+            }
+        #else
+            {
+                pxBuffer = ipCAST_PTR_TO_TYPE_PTR( StreamBuffer_t, pvPortMallocLarge( uxSize ) );
+            }
+        #endif /* ipconfigUSE_SOCKET_POOL */
+
+        if( pxBuffer != NULL )
+        {
+            /* Clear the markers of the stream */
+            ( void ) memset( pxBuffer, 0, sizeof( *pxBuffer ) - sizeof( pxBuffer->ucArray ) );
+
+            #if ( ipconfigUSE_TCP_RX_CHAIN == 1 )
+                if( xIsInputStream != pdFALSE )
+                {
+                    ( void ) memset( pxBuffer, 0, sizeof( RxChain_t ) );
+                }
+            #endif
+
+            vStreamBufferInit( pxBuffer, uxLength );
+
+            if( xTCPWindowLoggingLevel != 0 )
+            {
+                FreeRTOS_debug_printf( ( "prvTCPCreateStream: %cxStream created %u bytes (total %u)\n", ( xIsInputStream != 0 ) ? 'R' : 'T', uxLength, uxSize ) );
+            }
+
+            if( xIsInputStream != 0 )
+            {
+                iptraceMEM_STATS_CREATE( tcpRX_STREAM_BUFFER, pxBuffer, uxSize );
+            }
+            else
+            {
+                iptraceMEM_STATS_CREATE( tcpTX_STREAM_BUFFER, pxBuffer, uxSize );
+            }
+        }
+
+        return pxBuffer;
+    }
+
+
+#endif /* ipconfigUSE_TCP */
+/*-----------------------------------------------------------*/
+
+#if ( ipconfigUSE_TCP_ELASTIC_STREAMS == 1 )
+
+/**
+ * @brief An API function starts using the streams of a TCP socket.  As long as
+ *        it is busy, the IP-task will not move or release the streams.
+ *
+ * @param[in] pxSocket: The socket whose streams will be used.
+ */
+    static void prvTCPStreamEnter( const FreeRTOS_Socket_t * pxSocket )
+    {
+        /* Only the bookkeeping fields of the socket are changed. */
+        FreeRTOS_Socket_t * pxUser = ( FreeRTOS_Socket_t * ) pxSocket;
+        TickType_t xNow = xTaskGetTickCount();
+
+        taskENTER_CRITICAL();
+        {
+            pxUser->u.xTCP.uxStreamUsers++;
+            pxUser->u.xTCP.xStreamActiveTime = xNow;
+        }
+        taskEXIT_CRITICAL();
+    }
+    /*-----------------------------------------------------------*/
+
+/**
+ * @brief An API function has stopped using the streams of a TCP socket.
+ *
+ * @param[in] pxSocket: The socket whose streams were used.
+ */
+    static void prvTCPStreamLeave( const FreeRTOS_Socket_t * pxSocket )
+    {
+        /* Only the bookkeeping fields of the socket are changed. */
+        FreeRTOS_Socket_t * pxUser = ( FreeRTOS_Socket_t * ) pxSocket;
+        TickType_t xNow = xTaskGetTickCount();
+
+        taskENTER_CRITICAL();
+        {
+            configASSERT( pxUser->u.xTCP.uxStreamUsers > 0U );
+            pxUser->u.xTCP.uxStreamUsers--;
+            pxUser->u.xTCP.xStreamActiveTime = xNow;
+        }
+        taskEXIT_CRITICAL();
+    }
+    /*-----------------------------------------------------------*/
+
+/**
+ * @brief The user will get a pointer into one of the streams of a TCP socket.
+ *        From now on, its streams will keep their size and location.
+ *
+ * @param[in] pxSocket: The socket whose streams will be accessed directly.
+ */
+    static void prvTCPStreamPin( const FreeRTOS_Socket_t * pxSocket )
+    {
+        /* Only the bookkeeping fields of the socket are changed. */
+        FreeRTOS_Socket_t * pxUser = ( FreeRTOS_Socket_t * ) pxSocket;
+
+        taskENTER_CRITICAL();
+        {
+            pxUser->u.xTCP.xStreamPinned = pdTRUE;
+        }
+        taskEXIT_CRITICAL();
+    }
+    /*-----------------------------------------------------------*/
+
+/**
+ * @brief Get the number of bytes that a stream can store.
+ *
+ * @param[in] pxStream: The stream buffer.
+ *
+ * @return The capacity of the stream.
+ */
+    static size_t prvTCPStreamCapacity( const StreamBuffer_t * pxStream )
+    {
+        size_t uxCapacity = pxStream->LENGTH - 1U;
+
+        #if ( ipconfigUSE_POW2_STREAM_BUFFERS == 1 )
+            if( pxStream->uxMask != 0U )
+            {
+                /* A power-of-two stream has no spare position. */
+                uxCapacity = pxStream->LENGTH;
+            }
+        #endif
+
+        return uxCapacity;
+    }
+    /*-----------------------------------------------------------*/
+
+/**
+ * @brief FreeRTOS_send() found txStream full while it can still grow.  Ask the
+ *        IP-task to let it grow, see xTCPSocketCheck().  Must be called after
+ *        socketSTREAM_LEAVE(), otherwise the IP-task may not move the stream.
+ *
+ * @param[in] pxSocket: The socket whose txStream is full.
+ */
+    static void prvTCPStreamRequestTxGrowth( FreeRTOS_Socket_t * pxSocket )
+    {
+        pxSocket->u.xTCP.xTxStreamFull = pdTRUE;
+        pxSocket->u.xTCP.usTimeout = 1U;
+
+        if( xIsCallingFromIPTask() == pdFALSE )
+        {
+            /* From a call-back, the IP-task will see the request as soon as
+             * the call-back returns. */
+            ( void ) xSendEventToIPTask( eTCPTimerEvent );
+        }
+    }
+    /*-----------------------------------------------------------*/
+
+/**
+ * @brief Limit a low-water setting to a percentage of the actual size of the
+ *        RX stream, so that the limits can be reached while it is small.
+ *
+ * @param[in] pxSocket: The socket that owns the RX stream.
+ * @param[in] uxSpace: The value of uxLittleSpace or uxEnoughSpace.
+ * @param[in] uxPercent: The default percentage of this limit.
+ *
+ * @return The limit that applies to the current RX stream.
+ */
+    static size_t prvTCPLowWaterLimit( const FreeRTOS_Socket_t * pxSocket,
+                                       size_t uxSpace,
+                                       size_t uxPercent )
+    {
+        const StreamBuffer_t * pxStream = pxSocket->u.xTCP.rxStream;
+        size_t uxLimit = uxSpace;
+        size_t uxScaled;
+
+        if( pxStream != NULL )
+        {
+            uxScaled = ( uxPercent * prvTCPStreamCapacity( pxStream ) ) / sock100_PERCENT;
+
+            if( uxLimit > uxScaled )
+            {
+                uxLimit = uxScaled;
+            }
+        }
+
+        return uxLimit;
+    }
+    /*-----------------------------------------------------------*/
+
+/**
+ * @brief Get the capacity with which a new stream of a TCP socket is created.
+ *
+ * @param[in] pxSocket: The socket that will own the stream.
+ * @param[in] xIsInputStream: pdTRUE for the RX stream, pdFALSE for the TX stream.
+ *
+ * @return The initial capacity of the stream.
+ */
+    size_t uxTCPStreamInitialSize( const FreeRTOS_Socket_t * pxSocket,
+                                   BaseType_t xIsInputStream )
+    {
+        size_t uxSize;
+        BaseType_t xElastic = pdTRUE;
+
+        if( xIsInputStream != pdFALSE )
+        {
+            uxSize = pxSocket->u.xTCP.uxRxStreamSize;
+
+            #if ( ipconfigUSE_TCP_RX_CHAIN == 1 )
+                {
+                    /* An RX chain does not store the data itself. */
+                    xElastic = pdFALSE;
+                }
+            #endif
+        }
+        else
+        {
+            uxSize = pxSocket->u.xTCP.uxTxStreamSize;
+        }
+
+        /* A pinned stream can not grow, give it its full size. */
+        if( ( xElastic != pdFALSE ) &&
+            ( pxSocket->u.xTCP.xStreamPinned == pdFALSE ) &&
+            ( uxSize > ( size_t ) ipconfigTCP_STREAM_INITIAL_SIZE ) )
+        {
+            uxSize = ( size_t ) ipconfigTCP_STREAM_INITIAL_SIZE;
+        }
+
+        return uxSize;
+    }
+    /*-----------------------------------------------------------*/
+
+/**
+ * @brief Called by the IP-task: replace a stream of a TCP socket with a bigger
+ *        one.  The data, including out-of-order data and the data of
+ *        outstanding segments, is moved to the new stream.  Nothing happens
+ *        while an API call is using the streams, or after they were pinned.
+ *
+ * @param[in] pxSocket: The socket that owns the stream.
+ * @param[in] xIsInputStream: pdTRUE for the RX stream, pdFALSE for the TX stream.
+ * @param[in] uxNeeded: The number of bytes that must fit after the head of
+ *                      the stream, or zero to just double its capacity.
+ *
+ * @return pdTRUE when the stream has been replaced.
+ */
+    BaseType_t xTCPStreamGrow( FreeRTOS_Socket_t * pxSocket,
+                               BaseType_t xIsInputStream,
+                               size_t uxNeeded )
+    {
+        StreamBuffer_t * pxOld;
+        StreamBuffer_t * pxNew = NULL;
+        StreamBuffer_t * pxUnused;
+        size_t uxMaxCapacity;
+        size_t uxOldCapacity = 0U;
+        size_t uxNewCapacity = 0U;
+        size_t uxTail;
+        size_t uxFirst;
+        size_t uxSize;
+        size_t uxFrontDistance;
+        BaseType_t xReturn = pdFALSE;
+
+        if( xIsInputStream != pdFALSE )
+        {
+            pxOld = pxSocket->u.xTCP.rxStream;
+            uxMaxCapacity = pxSocket->u.xTCP.uxRxStreamSize;
+
+            #if ( ipconfigUSE_TCP_RX_CHAIN == 1 )
+                {
+                    /* The RX chain keeps its data in network buffers. */
+                    pxOld = NULL;
+                }
+            #endif
+        }
+        else
+        {
+            pxOld = pxSocket->u.xTCP.txStream;
+            uxMaxCapacity = pxSocket->u.xTCP.uxTxStreamSize;
+        }
+
+        if( ( pxOld != NULL ) &&
+            ( pxSocket->u.xTCP.xStreamPinned == pdFALSE ) &&
+            ( pxSocket->u.xTCP.uxStreamUsers == 0U ) )
+        {
+            uxOldCapacity = prvTCPStreamCapacity( pxOld );
+
+            if( uxOldCapacity < uxMaxCapacity )
+            {
+                uxNewCapacity = 2U * uxOldCapacity;
+
+                while( uxNewCapacity < ( uxStreamBufferGetSize( pxOld ) + uxNeeded ) )
+                {
+                    uxNewCapacity *= 2U;
+                }
+
+                if( uxNewCapacity > uxMaxCapacity )
+                {
+                    uxNewCapacity = uxMaxCapacity;
+                }
+
+                pxNew = prvTCPAllocStream( pxSocket, xIsInputStream, uxNewCapacity );
+            }
+        }
+
+        if( pxNew != NULL )
+        {
+            pxUnused = pxNew;
+
+            /* A higher priority task may have called an API in the mean time,
+             * check again while no other task can run. */
+            vTaskSuspendAll();
+            {
+                if( ( pxSocket->u.xTCP.xStreamPinned == pdFALSE ) &&
+                    ( pxSocket->u.xTCP.uxStreamUsers == 0U ) )
+                {
+                    /* Copy the complete circular array, starting at the tail,
+                     * so that the markers keep their distance to the tail. */
+                    uxTail = uxStreamBufferIndex( pxOld, pxOld->uxTail );
+                    uxFirst = pxOld->LENGTH - uxTail;
+                    ( void ) memcpy( pxNew->ucArray, &( pxOld->ucArray[ uxTail ] ), uxFirst );
+                    ( void ) memcpy( &( pxNew->ucArray[ uxFirst ] ), pxOld->ucArray, uxTail );
+
+                    uxSize = uxStreamBufferGetSize( pxOld );
+                    uxFrontDistance = uxStreamBufferGetSpace( pxOld ) - uxStreamBufferFrontSpace( pxOld );
+
+                    pxNew->uxMid = uxSize - uxStreamBufferMidSpace( pxOld );
+                    pxNew->uxHead = uxSize;
+                    pxNew->uxFront = uxSize + uxFrontDistance;
+
+                    if( xIsInputStream != pdFALSE )
+                    {
+                        pxSocket->u.xTCP.rxStream = pxNew;
+                    }
+                    else
+                    {
+                        /* The segments refer to positions in the TX stream. */
+                        vTCPWindowTxRebase( &( pxSocket->u.xTCP.xTCPWindow ), ( int32_t ) uxTail, ( int32_t ) pxOld->LENGTH );
+                        pxSocket->u.xTCP.txStream = pxNew;
+                    }
+
+                    pxUnused = pxOld;
+                    xReturn = pdTRUE;
+                }
+            }
+            ( void ) xTaskResumeAll();
+
+            iptraceMEM_STATS_DELETE( pxUnused );
+            vPortFreeLarge( pxUnused );
+        }
+
+        if( xReturn != pdFALSE )
+        {
+            iptraceTCP_STREAM_GROWN( pxSocket, xIsInputStream, uxOldCapacity, uxNewCapacity );
+
+            if( xIsInputStream == pdFALSE )
+            {
+                /* Let FreeRTOS_send() know that there is more space. */
+                pxSocket->xEventBits |= ( EventBits_t ) eSOCKET_SEND;
+
+                #if ipconfigSUPPORT_SELECT_FUNCTION == 1
+                    {
+                        if( ( pxSocket->xSelectBits & ( EventBits_t ) eSELECT_WRITE ) != 0U )
+                        {
+                            pxSocket->xEventBits |= ( ( EventBits_t ) eSELECT_WRITE ) << SOCKET_EVENT_BIT_COUNT;
+                        }
+                    }
+                #endif
+            }
+        }
+
+        return xReturn;
+    }
+    /*-----------------------------------------------------------*/
+
+/**
+ * @brief Called from xTCPTimerCheck(): release the streams of a TCP socket
+ *        when they are empty and have not been used for ipconfigTCP_STREAM_IDLE_MS.
+ *        A released stream will be created again when it is needed.
+ *
+ * @param[in] pxSocket: The socket to check.
+ * @param[in] xNow: The current time in ticks.
+ */
+    static void prvTCPStreamCheckIdle( FreeRTOS_Socket_t * pxSocket,
+                                       TickType_t xNow )
+    {
+        StreamBuffer_t * pxRxStream = NULL;
+        StreamBuffer_t * pxTxStream = NULL;
+        const StreamBuffer_t * pxStream;
+
+        if( ( ipconfigTCP_STREAM_IDLE_MS > 0U ) &&
+            ( ( pxSocket->u.xTCP.rxStream != NULL ) || ( pxSocket->u.xTCP.txStream != NULL ) ) &&
+            ( ( xNow - pxSocket->u.xTCP.xStreamActiveTime ) >= pdMS_TO_TICKS( ipconfigTCP_STREAM_IDLE_MS ) ) )
+        {
+            vTaskSuspendAll();
+            {
+                if( ( pxSocket->u.xTCP.xStreamPinned == pdFALSE ) &&
+                    ( pxSocket->u.xTCP.uxStreamUsers == 0U ) )
+                {
+                    pxStream = pxSocket->u.xTCP.rxStream;
+
+                    /* Data that came in out-of-order is kept as well. */
+                    if( ( pxStream != NULL ) &&
+                        ( uxStreamBufferGetSize( pxStream ) == 0U ) &&
+                        ( pxStream->uxFront == pxStream->uxHead ) )
+                    {
+                        pxRxStream = pxSocket->u.xTCP.rxStream;
+                        pxSocket->u.xTCP.rxStream = NULL;
+                    }
+
+                    pxStream = pxSocket->u.xTCP.txStream;
+
+                    /* All data must be sent and acknowledged. */
+                    if( ( pxStream != NULL ) &&
+                        ( pxStream->uxTail == pxStream->uxHead ) &&
+                        ( pxStream->uxMid == pxStream->uxHead ) )
+                    {
+                        pxTxStream = pxSocket->u.xTCP.txStream;
+                        pxSocket->u.xTCP.txStream = NULL;
+                    }
+                }
+            }
+            ( void ) xTaskResumeAll();
+
+            if( pxRxStream != NULL )
+            {
+                #if ( ipconfigUSE_TCP_RX_CHAIN == 1 )
+                    {
+                        prvRxChainClear( ipCAST_PTR_TO_TYPE_PTR( RxChain_t, pxRxStream ) );
+                    }
+                #endif
+
+                iptraceTCP_STREAM_RELEASED( pxSocket, pdTRUE, prvTCPStreamCapacity( pxRxStream ) );
+                iptraceMEM_STATS_DELETE( pxRxStream );
+                vPortFreeLarge( pxRxStream );
+            }
+
+            if( pxTxStream != NULL )
+            {
+                iptraceTCP_STREAM_RELEASED( pxSocket, pdFALSE, prvTCPStreamCapacity( pxTxStream ) );
+                iptraceMEM_STATS_DELETE( pxTxStream );
+                vPortFreeLarge( pxTxStream );
+            }
+
+            /* Don't check this socket again before the next period. */
+            pxSocket->u.xTCP.xStreamActiveTime = xNow;
+        }
+    }
+
+#endif /* ipconfigUSE_TCP_ELASTIC_STREAMS */
+/*-----------------------------------------------------------*/
+
+#if ( ipconfigUSE_TCP == 1 )
+
+/**
+ * @brief Add data to the RxStream. When uxOffset > 0, data has come in out-of-order
+ *        and will be put in front of the head so it can not be popped by the user.
+ *
+ * @param[in] pxSocket: The socket to whose RxStream data is to be added.
+ * @param[in] uxOffset: Offset of the packet.
+ * @param[in] pcData: The data to be added to the RxStream.
+ * @param[in] ulByteCount: Number of bytes in the data.
+ *
+ * @return The number of bytes actually added to the RxStream. Or else, a negative
+ *         error code is returned.
+ */
+    int32_t lTCPAddRxdata( FreeRTOS_Socket_t * pxSocket,
+                           size_t uxOffset,
+                           const uint8_t * pcData,
+                           uint32_t ulByteCount )
+    {
+        StreamBuffer_t * pxStream = pxSocket->u.xTCP.rxStream;
+        int32_t xResult = 0;
+
+        #if ( ipconfigUSE_CALLBACKS == 1 )
+            BaseType_t bHasHandler = ipconfigIS_VALID_PROG_ADDRESS( pxSocket->u.xTCP.pxHandleReceive ) ? pdTRUE : pdFALSE;
+            const uint8_t * pucBuffer = NULL;
+        #endif /* ipconfigUSE_CALLBACKS */
+
+        /* int32_t uxStreamBufferAdd( pxBuffer, uxOffset, pucData, aCount )
+         * if( pucData != NULL ) copy data the the buffer
+         * if( pucData == NULL ) no copying, just advance rxHead
+         * if( uxOffset != 0 ) Just store data which has come out-of-order
+         * if( uxOffset == 0 ) Also advance rxHead */
+        if( pxStream == NULL )
+        {
+            pxStream = prvTCPCreateStream( pxSocket, pdTRUE );
+
+            if( pxStream == NULL )
+            {
+                xResult = -1;
+            }
+        }
+
+        if( xResult >= 0 )
+        {
+            #if ( ipconfigUSE_CALLBACKS == 1 )
+                {
+                    if( ( bHasHandler != pdFALSE ) && ( uxStreamBufferGetSize( pxStream ) == 0U ) && ( uxOffset == 0UL ) && ( pcData != NULL ) )
+                    {
+                        /* Data can be passed directly to the user */
+                        pucBuffer = pcData;
+
+                        pcData = NULL;
+                    }
+                }
+            #endif /* ipconfigUSE_CALLBACKS */
+
+            xResult = ( int32_t ) uxStreamBufferAdd( pxStream, uxOffset, pcData, ( size_t ) ulByteCount );
+
+            #if ( ipconfigHAS_DEBUG_PRINTF != 0 )
+                {
+                    if( xResult != ( int32_t ) ulByteCount )
+                    {
+                        FreeRTOS_debug_printf( ( "lTCPAddRxdata: at %u: %d/%u bytes (tail %u head %u space %u front %u)\n",
+                                                 ( unsigned int ) uxOffset,
+                                                 ( int ) xResult,
+                                                 ( unsigned int ) ulByteCount,
+                                                 ( unsigned int ) pxStream->uxTail,
+                                                 ( unsigned int ) pxStream->uxHead,
+                                                 ( unsigned int ) uxStreamBufferFrontSpace( pxStream ),
+                                                 ( unsigned int ) pxStream->uxFront ) );
+                    }
+                }
+            #endif /* ipconfigHAS_DEBUG_PRINTF */
+
+            if( uxOffset == 0U )
+            {
+                /* Data is being added to rxStream at the head (offs = 0) */
+                #if ( ipconfigUSE_CALLBACKS == 1 )
+                    if( bHasHandler != pdFALSE )
+                    {
+                        /* The socket owner has installed an OnReceive handler. Pass the
+                         * Rx data, without copying from the rxStream, to the user. */
+                        for( ; ; )
+                        {
+                            uint8_t * ucReadPtr = NULL;
+                            uint32_t ulCount;
+
+                            if( pucBuffer != NULL )
+                            {
+                                ucReadPtr = ipPOINTER_CAST( uint8_t *, pucBuffer );
+                                ulCount = ulByteCount;
+                                pucBuffer = NULL;
+                            }
+                            else
+                            {
+                                ulCount = ( uint32_t ) prvTCPRxGetPtr( pxSocket, &( ucReadPtr ) );
+                            }
+
+                            if( ulCount == 0UL )
+                            {
+                                break;
+                            }
+
+                            ( void ) pxSocket->u.xTCP.pxHandleReceive( pxSocket, ucReadPtr, ( size_t ) ulCount );
+                            ( void ) prvTCPRxGet( pxSocket, NULL, ( size_t ) ulCount, pdFALSE );
+                        }
+                    }
+                    else
+                #endif /* ipconfigUSE_CALLBACKS */
+                {
+                    /* See if running out of space. */
+                    if( pxSocket->u.xTCP.bits.bLowWater == pdFALSE_UNSIGNED )
+                    {
+                        size_t uxFrontSpace = uxStreamBufferFrontSpace( pxSocket->u.xTCP.rxStream );
+
+                        #if ( ipconfigUSE_TCP_ELASTIC_STREAMS == 1 )
+                            {
+                                /* Rather than asking the peer to slow down, see
+                                 * if the stream can grow. */
+                                if( ( uxFrontSpace <= socketLITTLE_SPACE( pxSocket ) ) &&
+                                    ( xTCPStreamGrow( pxSocket, pdTRUE, 0U ) != pdFALSE ) )
+                                {
+                                    uxFrontSpace = uxStreamBufferFrontSpace( pxSocket->u.xTCP.rxStream );
+                                }
+                            }
+                        #endif
+
+                        if( uxFrontSpace <= socketLITTLE_SPACE( pxSocket ) )
+                        {
+                            pxSocket->u.xTCP.bits.bLowWater = pdTRUE;
+                            pxSocket->u.xTCP.bits.bWinChange = pdTRUE;
+
+                            /* bLowWater was reached, send the changed window size. */
+                            pxSocket->u.xTCP.usTimeout = 1U;
+                            ( void ) xSendEventToIPTask( eTCPTimerEvent );
+                        }
+                    }
+
+                    /* New incoming data is available, wake up the user.   User's
+                     * semaphores will be set just before the IP-task goes asleep. */
+                    pxSocket->xEventBits |= ( EventBits_t ) eSOCKET_RECEIVE;
+
+                    #if ipconfigSUPPORT_SELECT_FUNCTION == 1
+                        {
+                            if( ( pxSocket->xSelectBits & ( EventBits_t ) eSELECT_READ ) != 0U )
+                            {
+                                pxSocket->xEventBits |= ( ( ( EventBits_t ) eSELECT_READ ) << SOCKET_EVENT_BIT_COUNT );
+                            }
+                        }
+                    #endif
+                }
+            }
+        }
+
+        return xResult;
+    }
+
+
+#endif /* ipconfigUSE_TCP */
+/*-----------------------------------------------------------*/
+
+#if ( ipconfigUSE_TCP == 1 )
+
+/**
+ * @brief Read data from the RX stream of a TCP socket, or just remove it.
+ *
+ * @param[in] pxSocket: The socket that owns the RX stream.
+ * @param[out] pucData: The buffer to copy the data to, or NULL to remove the
+ *                      data without copying it.
+ * @param[in] uxMaxCount: The maximum number of bytes to read.
+ * @param[in] xPeek: When pdTRUE, the data will stay in the stream.
+ *
+ * @return The number of bytes read or removed.
+ */
+    static size_t prvTCPRxGet( FreeRTOS_Socket_t * pxSocket,
+                               uint8_t * pucData,
+                               size_t uxMaxCount,
+                               BaseType_t xPeek )
+    {
+        size_t uxCount;
+
+        #if ( ipconfigUSE_TCP_RX_CHAIN == 1 )
+            {
+                RxChain_t * pxChain = ipCAST_PTR_TO_TYPE_PTR( RxChain_t, pxSocket->u.xTCP.rxStream );
+
+                /* The IP-task may add or merge links in the mean time. */
+                vTaskSuspendAll();
+                {
+                    uxCount = FreeRTOS_min_uint32( uxStreamBufferGetSize( &( pxChain->xStream ) ), uxMaxCount );
+
+                    if( pucData != NULL )
+                    {
+                        uxCount = prvRxChainRead( pxChain, pucData, uxCount );
+                    }
+
+                    if( xPeek == pdFALSE )
+                    {
+                        prvRxChainConsume( pxChain, uxCount );
+                    }
+                }
+                ( void ) xTaskResumeAll();
+            }
+        #else
+            {
+                uxCount = uxStreamBufferGet( pxSocket->u.xTCP.rxStream, 0U, pucData, uxMaxCount, xPeek );
+            }
+        #endif /* ipconfigUSE_TCP_RX_CHAIN */
+
+        return uxCount;
+    }
+    /*-----------------------------------------------------------*/
+
+/**
+ * @brief Get a pointer to the first bytes in the RX stream of a TCP socket.
+ *        The data stays in the stream until it is removed with prvTCPRxGet().
+ *
+ * @param[in] pxSocket: The socket that owns the RX stream.
+ * @param[out] ppucData: Will point to the data.
+ *
+ * @return The number of contiguous bytes at '*ppucData'.
+ */
+    static size_t prvTCPRxGetPtr( FreeRTOS_Socket_t * pxSocket,
+                                  uint8_t ** ppucData )
+    {
+        size_t uxCount;
+
+        #if ( ipconfigUSE_TCP_RX_CHAIN == 1 )
+            {
+                RxChain_t * pxChain = ipCAST_PTR_TO_TYPE_PTR( RxChain_t, pxSocket->u.xTCP.rxStream );
+
+                *ppucData = NULL;
+                uxCount = 0U;
+
+                vTaskSuspendAll();
+                {
+                    /* The first link is never merged by prvRxChainCompact(), so
+                     * the pointer stays valid until the data is removed. */
+                    if( ( pxChain->uxCount > 0U ) && ( pxChain->xLinks[ 0 ].uxStart == pxChain->uxConsumed ) )
+                    {
+                        *ppucData = pxChain->xLinks[ 0 ].pucData;
+                        uxCount = FreeRTOS_min_uint32( pxChain->xLinks[ 0 ].uxLength, uxStreamBufferGetSize( &( pxChain->xStream ) ) );
+                    }
+                }
+                ( void ) xTaskResumeAll();
+            }
+        #else
+            {
+                uxCount = uxStreamBufferGetPtr( pxSocket->u.xTCP.rxStream, ppucData );
+            }
+        #endif /* ipconfigUSE_TCP_RX_CHAIN */
+
+        return uxCount;
+    }
+    /*-----------------------------------------------------------*/
+
+#endif /* ipconfigUSE_TCP */
+
+#if ( ipconfigUSE_TCP_RX_CHAIN == 1 )
+
+/**
+ * @brief Release the network buffer of a link and remove the link from the chain.
+ *        Must be called with the scheduler suspended.
+ *
+ * @param[in] pxChain: The RX chain.
+ * @param[in] uxIndex: The index of the link to be removed.
+ */
+    static void prvRxChainUnlink( RxChain_t * pxChain,
+                                  UBaseType_t uxIndex )
+    {
+        UBaseType_t uxLink;
+
+        vReleaseNetworkBufferAndDescriptor( pxChain->xLinks[ uxIndex ].pxBuffer );
+        pxChain->uxCount--;
+        uxRxChainBuffers--;
+
+        for( uxLink = uxIndex; uxLink < pxChain->uxCount; uxLink++ )
+        {
+            pxChain->xLinks[ uxLink ] = pxChain->xLinks[ uxLink + 1U ];
+        }
+    }
+    /*-----------------------------------------------------------*/
+
+/**
+ * @brief Release all network buffers of an RX chain, after its markers were cleared.
+ *
+ * @param[in] pxChain: The RX chain.
+ */
+    static void prvRxChainClear( RxChain_t * pxChain )
+    {
+        vTaskSuspendAll();
+        {
+            while( pxChain->uxCount > 0U )
+            {
+                prvRxChainUnlink( pxChain, pxChain->uxCount - 1U );
+            }
+
+            if( pxChain->pxSpare != NULL )
+            {
+                vReleaseNetworkBufferAndDescriptor( pxChain->pxSpare );
+                pxChain->pxSpare = NULL;
+            }
+
+            pxChain->uxConsumed = 0U;
+        }
+        ( void ) xTaskResumeAll();
+    }
+    /*-----------------------------------------------------------*/
+
+/**
+ * @brief Merge adjacent links that are filled poorly, when the chain is full, or
+ *        when it holds less than ipconfigTCP_RX_CHAIN_MIN_FILL percent of the MSS
+ *        per link.  The first two links are left alone, because the user may be
+ *        reading them in place.
+ *
+ * @param[in] pxSocket: The socket that owns the RX chain.
+ * @param[in] pxChain: The RX chain.
+ * @param[in] xForce: pdTRUE to merge links whatever their fill, because the
+ *                    RX chains keep too many network buffers.
+ */
+    static void prvRxChainCompact( const FreeRTOS_Socket_t * pxSocket,
+                                   RxChain_t * pxChain,
+                                   BaseType_t xForce )
+    {
+        size_t uxMSS = ( size_t ) pxSocket->u.xTCP.usMSS;
+        size_t uxHeld = 0U;
+        size_t uxTotal, uxCopied;
+        UBaseType_t uxBefore, uxFirst, uxLast, uxLink;
+        NetworkBufferDescriptor_t * pxBuffer;
+
+        vTaskSuspendAll();
+        {
+            uxBefore = pxChain->uxCount;
+
+            for( uxLink = 0U; uxLink < uxBefore; uxLink++ )
+            {
+                uxHeld += pxChain->xLinks[ uxLink ].uxLength;
+            }
+
+            if( ( uxBefore > 2U ) &&
+                ( ( xForce != pdFALSE ) ||
+                  ( uxBefore >= ( UBaseType_t ) ipconfigTCP_RX_CHAIN_LENGTH ) ||
+                  ( ( uxHeld * 100U ) < ( ( size_t ) ipconfigTCP_RX_CHAIN_MIN_FILL * ( size_t ) uxBefore * uxMSS ) ) ) )
+            {
+                for( uxFirst = 2U; uxFirst < pxChain->uxCount; uxFirst++ )
+                {
+                    /* Find the longest run of adjacent links that fits in one MSS. */
+                    uxTotal = pxChain->xLinks[ uxFirst ].uxLength;
+                    uxLast = uxFirst;
+
+                    while( ( ( uxLast + 1U ) < pxChain->uxCount ) &&
+                           ( pxChain->xLinks[ uxLast + 1U ].uxStart == ( pxChain->xLinks[ uxLast ].uxStart + pxChain->xLinks[ uxLast ].uxLength ) ) &&
+                           ( ( uxTotal + pxChain->xLinks[ uxLast + 1U ].uxLength ) <= uxMSS ) )
+                    {
+                        uxLast++;
+                        uxTotal += pxChain->xLinks[ uxLast ].uxLength;
+                    }
+
+                    pxBuffer = NULL;
+
+                    if( uxLast > uxFirst )
+                    {
+                        pxBuffer = pxGetNetworkBufferWithDescriptor( uxTotal, 0U );
+                    }
+
+                    if( pxBuffer != NULL )
+                    {
+                        uxCopied = 0U;
+
+                        for( uxLink = uxFirst; uxLink <= uxLast; uxLink++ )
+                        {
+                            ( void ) memcpy( &( pxBuffer->pucEthernetBuffer[ uxCopied ] ), pxChain->xLinks[ uxLink ].pucData, pxChain->xLinks[ uxLink ].uxLength );
+                            uxCopied += pxChain->xLinks[ uxLink ].uxLength;
+                        }
+
+                        /* The first link of the run takes the new buffer, the others
+                         * are removed. */
+                        vReleaseNetworkBufferAndDescriptor( pxChain->xLinks[ uxFirst ].pxBuffer );
+                        pxChain->xLinks[ uxFirst ].pxBuffer = pxBuffer;
+                        pxChain->xLinks[ uxFirst ].pucData = pxBuffer->pucEthernetBuffer;
+                        pxChain->xLinks[ uxFirst ].uxLength = uxTotal;
+
+                        for( uxLink = uxLast; uxLink > uxFirst; uxLink-- )
+                        {
+                            prvRxChainUnlink( pxChain, uxLink );
+                        }
+                    }
+                }
+
+                if( pxChain->uxCount != uxBefore )
+                {
+                    iptraceTCP_RX_CHAIN_COMPACTED( pxSocket, uxBefore, pxChain->uxCount );
+                }
+            }
+        }
+        ( void ) xTaskResumeAll();
+    }
+    /*-----------------------------------------------------------*/
+
+/**
+ * @brief Check if the RX chains of all sockets together keep too many network
+ *        buffers: more than ipconfigTCP_RX_CHAIN_MAX_BUFFERS, or so many that
+ *        the pool is under pressure.  The driver needs buffers to receive.
+ *
+ * @return pdTRUE when no more frames should be kept by reference.
+ */
+    static BaseType_t prvRxChainCrowded( void )
+    {
+        BaseType_t xReturn = pdFALSE;
+
+        if( uxRxChainBuffers >= ( UBaseType_t ) ipconfigTCP_RX_CHAIN_MAX_BUFFERS )
+        {
+            xReturn = pdTRUE;
+        }
+
+        #if ( ipconfigUSE_BUFFER_PRESSURE == 1 )
+            {
+                if( eGetNetworkBufferPressure() != eBufferPressureNone )
+                {
+                    xReturn = pdTRUE;
+                }
+            }
+        #endif
+
+        return xReturn;
+    }
+    /*-----------------------------------------------------------*/
+
+/**
+ * @brief Copy data from the start of an RX chain, without removing it.
+ *        Must be called with the scheduler suspended.
+ *
+ * @param[in] pxChain: The RX chain.
+ * @param[out] pucData: The buffer to copy the data to.
+ * @param[in] uxCount: The number of bytes to copy, at most the size of the stream.
+ *
+ * @return The number of bytes copied.
+ */
+    static size_t prvRxChainRead( RxChain_t * pxChain,
+                                  uint8_t * pucData,
+                                  size_t uxCount )
+    {
+        size_t uxDone = 0U;
+        size_t uxSkip, uxLength;
+        UBaseType_t uxLink;
+
+        /* The data in front of the head is contiguous, every byte of it is
+         * found in one of the first links. */
+        for( uxLink = 0U;
+             ( uxLink < pxChain->uxCount ) && ( uxDone < uxCount ) && ( ( pxChain->xLinks[ uxLink ].uxStart - pxChain->uxConsumed ) <= uxDone );
+             uxLink++ )
+        {
+            uxSkip = uxDone - ( pxChain->xLinks[ uxLink ].uxStart - pxChain->uxConsumed );
+            uxLength = FreeRTOS_min_uint32( pxChain->xLinks[ uxLink ].uxLength - uxSkip, uxCount - uxDone );
+
+            ( void ) memcpy( &( pucData[ uxDone ] ), &( pxChain->xLinks[ uxLink ].pucData[ uxSkip ] ), uxLength );
+            uxDone += uxLength;
+        }
+
+        return uxDone;
+    }
+    /*-----------------------------------------------------------*/
+
+/**
+ * @brief Remove data from the start of an RX chain.  Links that have been read
+ *        completely are released.  Must be called with the scheduler suspended.
+ *
+ * @param[in] pxChain: The RX chain.
+ * @param[in] uxCount: The number of bytes to remove, at most the size of the stream.
+ */
+    static void prvRxChainConsume( RxChain_t * pxChain,
+                                   size_t uxCount )
+    {
+        size_t uxEnd, uxSkip;
+        BaseType_t xDone = pdFALSE;
+
+        ( void ) uxStreamBufferGet( &( pxChain->xStream ), 0U, NULL, uxCount, pdFALSE );
+
+        while( ( xDone == pdFALSE ) && ( pxChain->uxCount > 0U ) )
+        {
+            uxEnd = ( pxChain->xLinks[ 0 ].uxStart - pxChain->uxConsumed ) + pxChain->xLinks[ 0 ].uxLength;
+
+            if( uxEnd <= uxCount )
+            {
+                prvRxChainUnlink( pxChain, 0U );
+            }
+            else
+            {
+                uxSkip = pxChain->uxConsumed + uxCount - pxChain->xLinks[ 0 ].uxStart;
+
+                if( uxSkip < pxChain->xLinks[ 0 ].uxLength )
+                {
+                    /* This link has been read partially. */
+                    pxChain->xLinks[ 0 ].pucData = &( pxChain->xLinks[ 0 ].pucData[ uxSkip ] );
+                    pxChain->xLinks[ 0 ].uxLength -= uxSkip;
+                    pxChain->xLinks[ 0 ].uxStart += uxSkip;
+                }
+
+                xDone = pdTRUE;
+            }
+        }
+
+        pxChain->uxConsumed += uxCount;
+    }
+    /*-----------------------------------------------------------*/
+
+/**
+ * @brief Make sure that the RX chain of a socket can take one more network
+ *        buffer: create the stream, merge links if needed, and get a buffer
+ *        for the headers of the reply.  Called by the IP-task before it accepts
+ *        a segment.
+ *
+ * @param[in] pxSocket: The socket that receives the data.
+ * @param[in] xInOrder: pdTRUE when the segment follows the data that was
+ *                      received in-order.  The last link is reserved for such
+ *                      a segment, so that out-of-order data can not fill the
+ *                      chain while the missing bytes are refused.
+ *
+ * When the RX chains of all sockets keep too many network buffers, a socket
+ * that keeps a frame already refuses new data until its user has read some,
+ * so that a few slow readers can not drain the pool.
+ *
+ * @return pdTRUE when the segment can be stored, otherwise pdFALSE.
+ */
+    BaseType_t xTCPRxChainPrepare( FreeRTOS_Socket_t * pxSocket,
+                                   BaseType_t xInOrder )
+    {
+        RxChain_t * pxChain;
+        UBaseType_t uxLimit = ( UBaseType_t ) ipconfigTCP_RX_CHAIN_LENGTH;
+        BaseType_t xReturn = pdFALSE;
+        BaseType_t xCrowded = prvRxChainCrowded();
 
-        if( pxBuffer == NULL )
+        if( pxSocket->u.xTCP.rxStream == NULL )
         {
-            FreeRTOS_debug_printf( ( "prvTCPCreateStream: malloc failed\n" ) );
-            pxSocket->u.xTCP.bits.bMallocError = pdTRUE;
-            vTCPStateChange( pxSocket, eCLOSE_WAIT );
+            ( void ) prvTCPCreateStream( pxSocket, pdTRUE );
         }
-        else
+
+        if( pxSocket->u.xTCP.rxStream != NULL )
         {
-            /* Clear the markers of the stream */
-            ( void ) memset( pxBuffer, 0, sizeof( *pxBuffer ) - sizeof( pxBuffer->ucArray ) );
-            pxBuffer->LENGTH = ( size_t ) uxLength;
+            pxChain = ipCAST_PTR_TO_TYPE_PTR( RxChain_t, pxSocket->u.xTCP.rxStream );
 
-            if( xTCPWindowLoggingLevel != 0 )
-            {
-                FreeRTOS_debug_printf( ( "prvTCPCreateStream: %cxStream created %u bytes (total %u)\n", ( xIsInputStream != 0 ) ? 'R' : 'T', uxLength, uxSize ) );
-            }
+            prvRxChainCompact( pxSocket, pxChain, xCrowded );
 
-            if( xIsInputStream != 0 )
+            if( ( xCrowded != pdFALSE ) && ( pxChain->uxCount > 0U ) )
             {
-                iptraceMEM_STATS_CREATE( tcpRX_STREAM_BUFFER, pxBuffer, uxSize );
-                pxSocket->u.xTCP.rxStream = pxBuffer;
+                /* Every socket may keep one frame, so that it makes progress.
+                 * The spare buffer is not needed until more data is accepted. */
+                uxLimit = 0U;
+
+                if( pxChain->pxSpare != NULL )
+                {
+                    vReleaseNetworkBufferAndDescriptor( pxChain->pxSpare );
+                    pxChain->pxSpare = NULL;
+                }
             }
             else
             {
-                iptraceMEM_STATS_CREATE( tcpTX_STREAM_BUFFER, pxBuffer, uxSize );
-                pxSocket->u.xTCP.txStream = pxBuffer;
+                if( xInOrder == pdFALSE )
+                {
+                    uxLimit--;
+                }
+
+                if( pxChain->pxSpare == NULL )
+                {
+                    pxChain->pxSpare = pxGetNetworkBufferWithDescriptor( socketRX_CHAIN_HEADER_SIZE, 0U );
+                }
+            }
+
+            if( ( pxChain->pxSpare != NULL ) && ( pxChain->uxCount < uxLimit ) )
+            {
+                xReturn = pdTRUE;
             }
         }
 
-        return pxBuffer;
+        return xReturn;
     }
-
-
-#endif /* ipconfigUSE_TCP */
-/*-----------------------------------------------------------*/
-
-#if ( ipconfigUSE_TCP == 1 )
+    /*-----------------------------------------------------------*/
 
 /**
- * @brief Add data to the RxStream. When uxOffset > 0, data has come in out-of-order
- *        and will be put in front of the head so it can not be popped by the user.
+ * @brief Store received data by keeping the network buffer that holds it.
+ *        Bytes that are already present in the chain are not stored twice.
+ *        The caller continues with a network buffer that holds a copy of the
+ *        headers, which can be used to send a reply.
  *
- * @param[in] pxSocket: The socket to whose RxStream data is to be added.
- * @param[in] uxOffset: Offset of the packet.
- * @param[in] pcData: The data to be added to the RxStream.
- * @param[in] ulByteCount: Number of bytes in the data.
+ * @param[in] pxSocket: The socket that receives the data.
+ * @param[in] uxOffset: The offset of the data from the head of the stream.
+ * @param[in,out] ppxNetworkBuffer: The network buffer that holds the data.  It
+ *                                  is replaced when the socket keeps it.
+ * @param[in] pucData: The first byte of the TCP payload.
+ * @param[in] ulByteCount: The number of bytes in the payload.
  *
- * @return The number of bytes actually added to the RxStream. Or else, a negative
- *         error code is returned.
+ * @return The number of bytes added to the RX stream, or a negative value.
  */
-    int32_t lTCPAddRxdata( FreeRTOS_Socket_t * pxSocket,
-                           size_t uxOffset,
-                           const uint8_t * pcData,
-                           uint32_t ulByteCount )
+    int32_t lTCPAddRxFrame( FreeRTOS_Socket_t * pxSocket,
+                            size_t uxOffset,
+                            NetworkBufferDescriptor_t ** ppxNetworkBuffer,
+                            const uint8_t * pucData,
+                            uint32_t ulByteCount )
     {
-        StreamBuffer_t * pxStream = pxSocket->u.xTCP.rxStream;
-        int32_t xResult = 0;
-
-        #if ( ipconfigUSE_CALLBACKS == 1 )
-            BaseType_t bHasHandler = ipconfigIS_VALID_PROG_ADDRESS( pxSocket->u.xTCP.pxHandleReceive ) ? pdTRUE : pdFALSE;
-            const uint8_t * pucBuffer = NULL;
-        #endif /* ipconfigUSE_CALLBACKS */
+        RxChain_t * pxChain = ipCAST_PTR_TO_TYPE_PTR( RxChain_t, pxSocket->u.xTCP.rxStream );
+        NetworkBufferDescriptor_t * pxFrame = *ppxNetworkBuffer;
+        NetworkBufferDescriptor_t * pxSpare;
+        RxChainLink_t * pxLink;
+        size_t uxFirst, uxFrom, uxTo, uxLinkFrom, uxLinkTo, uxHeaderLength;
+        UBaseType_t uxLink;
+        BaseType_t xAdopt = pdTRUE;
+        const uint8_t * pucCopyData = NULL;
 
-        /* int32_t uxStreamBufferAdd( pxBuffer, uxOffset, pucData, aCount )
-         * if( pucData != NULL ) copy data the the buffer
-         * if( pucData == NULL ) no copying, just advance rxHead
-         * if( uxOffset != 0 ) Just store data which has come out-of-order
-         * if( uxOffset == 0 ) Also advance rxHead */
-        if( pxStream == NULL )
-        {
-            pxStream = prvTCPCreateStream( pxSocket, pdTRUE );
+        configASSERT( pxChain != NULL );
 
-            if( pxStream == NULL )
+        #if ( ipconfigUSE_CALLBACKS == 1 )
             {
-                xResult = -1;
+                if( ipconfigIS_VALID_PROG_ADDRESS( pxSocket->u.xTCP.pxHandleReceive ) &&
+                    ( uxStreamBufferGetSize( &( pxChain->xStream ) ) == 0U ) &&
+                    ( uxOffset == 0U ) )
+                {
+                    /* lTCPAddRxdata() passes the data straight to the handler,
+                     * the frame does not have to be kept. */
+                    xAdopt = pdFALSE;
+                    pucCopyData = pucData;
+                }
             }
-        }
+        #endif /* ipconfigUSE_CALLBACKS */
 
-        if( xResult >= 0 )
+        if( xAdopt != pdFALSE )
         {
-            #if ( ipconfigUSE_CALLBACKS == 1 )
+            vTaskSuspendAll();
+            {
+                /* Positions relative to the tail of the stream. */
+                uxFirst = uxStreamBufferGetSize( &( pxChain->xStream ) ) + uxOffset;
+                uxFrom = uxFirst;
+                uxTo = uxFirst + ( size_t ) ulByteCount;
+                uxLink = 0U;
+
+                /* Remove the bytes that are present already. */
+                while( ( uxFrom < uxTo ) && ( uxLink < pxChain->uxCount ) )
                 {
-                    if( ( bHasHandler != pdFALSE ) && ( uxStreamBufferGetSize( pxStream ) == 0U ) && ( uxOffset == 0UL ) && ( pcData != NULL ) )
-                    {
-                        /* Data can be passed directly to the user */
-                        pucBuffer = pcData;
+                    pxLink = &( pxChain->xLinks[ uxLink ] );
+                    uxLinkFrom = pxLink->uxStart - pxChain->uxConsumed;
+                    uxLinkTo = uxLinkFrom + pxLink->uxLength;
 
-                        pcData = NULL;
+                    if( ( uxLinkTo <= uxFrom ) || ( uxLinkFrom >= uxTo ) )
+                    {
+                        /* No overlap. */
+                        uxLink++;
                     }
-                }
-            #endif /* ipconfigUSE_CALLBACKS */
-
-            xResult = ( int32_t ) uxStreamBufferAdd( pxStream, uxOffset, pcData, ( size_t ) ulByteCount );
-
-            #if ( ipconfigHAS_DEBUG_PRINTF != 0 )
-                {
-                    if( xResult != ( int32_t ) ulByteCount )
+                    else if( ( uxLinkFrom >= uxFrom ) && ( uxLinkTo <= uxTo ) )
                     {
-                        FreeRTOS_debug_printf( ( "lTCPAddRxdata: at %u: %d/%u bytes (tail %u head %u space %u front %u)\n",
-                                                 ( unsigned int ) uxOffset,
-                                                 ( int ) xResult,
-                                                 ( unsigned int ) ulByteCount,
-                                                 ( unsigned int ) pxStream->uxTail,
-                                                 ( unsigned int ) pxStream->uxHead,
-                                                 ( unsigned int ) uxStreamBufferFrontSpace( pxStream ),
-                                                 ( unsigned int ) pxStream->uxFront ) );
+                        /* The new frame is a superset of this link. */
+                        prvRxChainUnlink( pxChain, uxLink );
                     }
-                }
-            #endif /* ipconfigHAS_DEBUG_PRINTF */
-
-            if( uxOffset == 0U )
-            {
-                /* Data is being added to rxStream at the head (offs = 0) */
-                #if ( ipconfigUSE_CALLBACKS == 1 )
-                    if( bHasHandler != pdFALSE )
+                    else if( uxLinkFrom <= uxFrom )
                     {
-                        /* The socket owner has installed an OnReceive handler. Pass the
-                         * Rx data, without copying from the rxStream, to the user. */
-                        for( ; ; )
-                        {
-                            uint8_t * ucReadPtr = NULL;
-                            uint32_t ulCount;
-
-                            if( pucBuffer != NULL )
-                            {
-                                ucReadPtr = ipPOINTER_CAST( uint8_t *, pucBuffer );
-                                ulCount = ulByteCount;
-                                pucBuffer = NULL;
-                            }
-                            else
-                            {
-                                ulCount = ( uint32_t ) uxStreamBufferGetPtr( pxStream, &( ucReadPtr ) );
-                            }
-
-                            if( ulCount == 0UL )
-                            {
-                                break;
-                            }
-
-                            ( void ) pxSocket->u.xTCP.pxHandleReceive( pxSocket, ucReadPtr, ( size_t ) ulCount );
-                            ( void ) uxStreamBufferGet( pxStream, 0UL, NULL, ( size_t ) ulCount, pdFALSE );
-                        }
+                        uxFrom = uxLinkTo;
+                        uxLink++;
                     }
                     else
-                #endif /* ipconfigUSE_CALLBACKS */
-                {
-                    /* See if running out of space. */
-                    if( pxSocket->u.xTCP.bits.bLowWater == pdFALSE_UNSIGNED )
                     {
-                        size_t uxFrontSpace = uxStreamBufferFrontSpace( pxSocket->u.xTCP.rxStream );
+                        uxTo = uxLinkFrom;
+                        uxLink++;
+                    }
+                }
 
-                        if( uxFrontSpace <= pxSocket->u.xTCP.uxLittleSpace )
-                        {
-                            pxSocket->u.xTCP.bits.bLowWater = pdTRUE;
-                            pxSocket->u.xTCP.bits.bWinChange = pdTRUE;
+                if( uxFrom < uxTo )
+                {
+                    pxSpare = pxChain->pxSpare;
+                    uxHeaderLength = ( size_t ) ( pucData - pxFrame->pucEthernetBuffer );
+                    configASSERT( uxHeaderLength <= socketRX_CHAIN_HEADER_SIZE );
 
-                            /* bLowWater was reached, send the changed window size. */
-                            pxSocket->u.xTCP.usTimeout = 1U;
-                            ( void ) xSendEventToIPTask( eTCPTimerEvent );
-                        }
+                    /* The headers are needed to send a reply. */
+                    ( void ) memcpy( pxSpare->pucEthernetBuffer, pxFrame->pucEthernetBuffer, uxHeaderLength );
+                    pxSpare->xDataLength = socketRX_CHAIN_HEADER_SIZE;
+                    pxSpare->ulIPAddress = pxFrame->ulIPAddress;
+                    pxSpare->usPort = pxFrame->usPort;
+                    pxSpare->usBoundPort = pxFrame->usBoundPort;
+
+                    /* Find the place of the new link, the chain is sorted. */
+                    uxLink = pxChain->uxCount;
+
+                    while( ( uxLink > 0U ) && ( ( pxChain->xLinks[ uxLink - 1U ].uxStart - pxChain->uxConsumed ) > uxFrom ) )
+                    {
+                        pxChain->xLinks[ uxLink ] = pxChain->xLinks[ uxLink - 1U ];
+                        uxLink--;
                     }
 
-                    /* New incoming data is available, wake up the user.   User's
-                     * semaphores will be set just before the IP-task goes asleep. */
-                    pxSocket->xEventBits |= ( EventBits_t ) eSOCKET_RECEIVE;
+                    pxChain->xLinks[ uxLink ].pxBuffer = pxFrame;
+                    pxChain->xLinks[ uxLink ].pucData = ipPOINTER_CAST( uint8_t *, &( pucData[ uxFrom - uxFirst ] ) );
+                    pxChain->xLinks[ uxLink ].uxLength = uxTo - uxFrom;
+                    pxChain->xLinks[ uxLink ].uxStart = pxChain->uxConsumed + uxFrom;
+                    pxChain->uxCount++;
+                    pxChain->pxSpare = NULL;
+                    uxRxChainBuffers++;
 
-                    #if ipconfigSUPPORT_SELECT_FUNCTION == 1
-                        {
-                            if( ( pxSocket->xSelectBits & ( EventBits_t ) eSELECT_READ ) != 0U )
-                            {
-                                pxSocket->xEventBits |= ( ( ( EventBits_t ) eSELECT_READ ) << SOCKET_EVENT_BIT_COUNT );
-                            }
-                        }
-                    #endif
+                    *ppxNetworkBuffer = pxSpare;
                 }
             }
+            ( void ) xTaskResumeAll();
         }
 
-        return xResult;
+        /* Advance the markers and wake up the user. */
+        return lTCPAddRxdata( pxSocket, uxOffset, pucCopyData, ulByteCount );
     }
+    /*-----------------------------------------------------------*/
+
+/**
+ * @brief Get the number of bytes that the free links of an RX chain can take,
+ *        assuming that the peer sends segments of one MSS.
+ *
+ * @param[in] pxSocket: The socket that owns the RX chain.
+ *
+ * @return The number of bytes.
+ */
+    size_t uxTCPRxChainCapacity( const FreeRTOS_Socket_t * pxSocket )
+    {
+        UBaseType_t uxFree = ( UBaseType_t ) ipconfigTCP_RX_CHAIN_LENGTH;
 
+        if( pxSocket->u.xTCP.rxStream != NULL )
+        {
+            uxFree -= ipCAST_PTR_TO_TYPE_PTR( RxChain_t, pxSocket->u.xTCP.rxStream )->uxCount;
+        }
 
-#endif /* ipconfigUSE_TCP */
+        return ( size_t ) uxFree * ( size_t ) pxSocket->u.xTCP.usMSS;
+    }
+    /*-----------------------------------------------------------*/
+
+#endif /* ipconfigUSE_TCP_RX_CHAIN */
 /*-----------------------------------------------------------*/
 
 #if ( ipconfigUSE_TCP == 1 )
@@ -4375,13 +6703,24 @@ void vSocketWakeUpUser( FreeRTOS_Socket_t * pxSocket )
                 xResult = 0;
             }
         }
-        else if( pxSocket->u.xTCP.txStream == NULL )
-        {
-            xResult = ( BaseType_t ) pxSocket->u.xTCP.uxTxStreamSize;
-        }
         else
         {
-            xResult = ( BaseType_t ) uxStreamBufferGetSpace( pxSocket->u.xTCP.txStream );
+            socketSTREAM_ENTER( pxSocket );
+
+            if( pxSocket->u.xTCP.txStream == NULL )
+            {
+                #if ( ipconfigUSE_TCP_ELASTIC_STREAMS == 1 )
+                    xResult = ( BaseType_t ) uxTCPStreamInitialSize( pxSocket, pdFALSE );
+                #else
+                    xResult = ( BaseType_t ) pxSocket->u.xTCP.uxTxStreamSize;
+                #endif
+            }
+            else
+            {
+                xResult = ( BaseType_t ) uxStreamBufferGetSpace( pxSocket->u.xTCP.txStream );
+            }
+
+            socketSTREAM_LEAVE( pxSocket );
         }
 
         return xResult;
@@ -4412,14 +6751,22 @@ void vSocketWakeUpUser( FreeRTOS_Socket_t * pxSocket )
         }
         else
         {
+            socketSTREAM_ENTER( pxSocket );
+
             if( pxSocket->u.xTCP.txStream != NULL )
             {
                 xReturn = ( BaseType_t ) uxStreamBufferGetSpace( pxSocket->u.xTCP.txStream );
             }
             else
             {
-                xReturn = ( BaseType_t ) pxSocket->u.xTCP.uxTxStreamSize;
+                #if ( ipconfigUSE_TCP_ELASTIC_STREAMS == 1 )
+                    xReturn = ( BaseType_t ) uxTCPStreamInitialSize( pxSocket, pdFALSE );
+                #else
+                    xReturn = ( BaseType_t ) pxSocket->u.xTCP.uxTxStreamSize;
+                #endif
             }
+
+            socketSTREAM_LEAVE( pxSocket );
         }
 
         return xReturn;
@@ -4450,6 +6797,8 @@ void vSocketWakeUpUser( FreeRTOS_Socket_t * pxSocket )
         }
         else
         {
+            socketSTREAM_ENTER( pxSocket );
+
             if( pxSocket->u.xTCP.txStream != NULL )
             {
                 xReturn = ( BaseType_t ) uxStreamBufferGetSize( pxSocket->u.xTCP.txStream );
@@ -4458,6 +6807,8 @@ void vSocketWakeUpUser( FreeRTOS_Socket_t * pxSocket )
             {
                 xReturn = 0;
             }
+
+            socketSTREAM_LEAVE( pxSocket );
         }
 
         return xReturn;
@@ -4589,13 +6940,20 @@ void vSocketWakeUpUser( FreeRTOS_Socket_t * pxSocket )
         {
             xReturn = -pdFREERTOS_ERRNO_EINVAL;
         }
-        else if( pxSocket->u.xTCP.rxStream != NULL )
-        {
-            xReturn = ( BaseType_t ) uxStreamBufferGetSize( pxSocket->u.xTCP.rxStream );
-        }
         else
         {
-            xReturn = 0;
+            socketSTREAM_ENTER( pxSocket );
+
+            if( pxSocket->u.xTCP.rxStream != NULL )
+            {
+                xReturn = ( BaseType_t ) uxStreamBufferGetSize( pxSocket->u.xTCP.rxStream );
+            }
+            else
+            {
+                xReturn = 0;
+            }
+
+            socketSTREAM_LEAVE( pxSocket );
         }
 
         return xReturn;
@@ -4763,6 +7121,105 @@ BaseType_t xSocketValid( Socket_t xSocket )
 #endif /* ( ( ipconfigHAS_PRINTF != 0 ) && ( ipconfigUSE_TCP == 1 ) ) */
 /*-----------------------------------------------------------*/
 
+#if ( ipconfigUSE_STATIC_POOLS == 1 )
+
+/**
+ * @brief Print a single line of the pool report.
+ *
+ * @param[in] pcName: The name of the pool.
+ * @param[in] uxCount: The number of objects in the pool.
+ * @param[in] uxObjectSize: The number of bytes needed per object.
+ * @param[in] uxInUse: The number of objects that are in use now.
+ * @param[in] uxPeak: The highest number of objects that were in use.
+ *
+ * @return The size of the pool in bytes.
+ */
+    static size_t prvPrintPool( const char * pcName,
+                                UBaseType_t uxCount,
+                                size_t uxObjectSize,
+                                UBaseType_t uxInUse,
+                                UBaseType_t uxPeak )
+    {
+        size_t uxBytes = ( size_t ) uxCount * uxObjectSize;
+
+        FreeRTOS_printf( ( "Pool %-14s: %3lu x %5lu = %7lu bytes, %3lu in use, peak %3lu\n",
+                           pcName,
+                           ( unsigned long ) uxCount,
+                           ( unsigned long ) uxObjectSize,
+                           ( unsigned long ) uxBytes,
+                           ( unsigned long ) uxInUse,
+                           ( unsigned long ) uxPeak ) );
+
+        /* In case FreeRTOS_printf() is not defined. */
+        ( void ) pcName;
+        ( void ) uxInUse;
+        ( void ) uxPeak;
+
+        return uxBytes;
+    }
+    /*-----------------------------------------------------------*/
+
+/**
+ * @brief Print the size and the use of each of the static pools from which
+ *        the stack takes its sockets, socket sets, streams, TCP segments and
+ *        DNS call-backs.  FreeRTOS_IPInit() calls it once, it may be called
+ *        again at any time to see the peak use.
+ */
+    void FreeRTOS_PrintPoolUsage( void )
+    {
+        size_t uxTotal = 0U;
+        size_t uxSocketSize = xSocketPool.uxObjectSize;
+
+        #if ( ipconfigSOCKET_USES_NOTIFY == 0 )
+            {
+                uxSocketSize += sizeof( StaticEventGroup_t );
+            }
+        #endif
+
+        uxTotal += prvPrintPool( xSocketPool.pcName, xSocketPool.uxObjectCount, uxSocketSize,
+                                 xSocketPool.uxInUse, xSocketPool.uxPeak );
+
+        #if ( ipconfigUSE_TCP == 1 )
+            {
+                uxTotal += prvPrintPool( xStreamPool.pcName, xStreamPool.uxObjectCount, xStreamPool.uxObjectSize,
+                                         xStreamPool.uxInUse, xStreamPool.uxPeak );
+            }
+        #endif
+
+        #if ( ipconfigSUPPORT_SELECT_FUNCTION == 1 )
+            {
+                uxTotal += prvPrintPool( xSocketSetPool.pcName, xSocketSetPool.uxObjectCount,
+                                         xSocketSetPool.uxObjectSize + sizeof( StaticEventGroup_t ),
+                                         xSocketSetPool.uxInUse, xSocketSetPool.uxPeak );
+            }
+        #endif
+
+        #if ( ( ipconfigUSE_TCP == 1 ) && ( ipconfigUSE_TCP_WIN == 1 ) )
+            {
+                UBaseType_t uxInUse, uxPeak;
+
+                vTCPWindowSegmentUsage( &( uxInUse ), &( uxPeak ) );
+                uxTotal += prvPrintPool( "TCP segments", ( UBaseType_t ) ipconfigTCP_WIN_SEG_COUNT, sizeof( TCPSegment_t ),
+                                         uxInUse, uxPeak );
+            }
+        #endif
+
+        #if ( ( ipconfigUSE_DNS != 0 ) && ( ipconfigDNS_USE_CALLBACKS != 0 ) )
+            {
+                uxTotal += prvPrintPool( xDNSCallbackPool.pcName, xDNSCallbackPool.uxObjectCount, xDNSCallbackPool.uxObjectSize,
+                                         xDNSCallbackPool.uxInUse, xDNSCallbackPool.uxPeak );
+            }
+        #endif
+
+        FreeRTOS_printf( ( "Pools: %lu bytes in total\n", ( unsigned long ) uxTotal ) );
+
+        /* In case FreeRTOS_printf() is not defined. */
+        ( void ) uxTotal;
+    }
+    /*-----------------------------------------------------------*/
+
+#endif /* ipconfigUSE_STATIC_POOLS == 1 */
+
 #if ( ipconfigSUPPORT_SELECT_FUNCTION == 1 )
 
 /**
@@ -4977,15 +7434,17 @@ BaseType_t xSocketValid( Socket_t xSocket )
             }
             else
         #endif /* ipconfigSUPPORT_SELECT_FUNCTION */
-        if( pxSocket->xEventGroup != NULL )
+        #if ( ipconfigSOCKET_USES_NOTIFY == 0 )
+            if( pxSocket->xEventGroup == NULL )
+            {
+                xReturn = -pdFREERTOS_ERRNO_EINVAL;
+            }
+            else
+        #endif /* ipconfigSOCKET_USES_NOTIFY */
         {
-            ( void ) xEventGroupSetBits( pxSocket->xEventGroup, ( EventBits_t ) eSOCKET_INTR );
+            vSocketSetEventBits( pxSocket, ( EventBits_t ) eSOCKET_INTR );
             xReturn = 0;
         }
-        else
-        {
-            xReturn = -pdFREERTOS_ERRNO_EINVAL;
-        }
 
         return xReturn;
     }
@@ -5012,7 +7471,9 @@ BaseType_t xSocketValid( Socket_t xSocket )
 
         configASSERT( pxSocket != NULL );
         configASSERT( pxSocket->ucProtocol == ( uint8_t ) FREERTOS_IPPROTO_TCP );
-        configASSERT( pxSocket->xEventGroup != NULL );
+        #if ( ipconfigSOCKET_USES_NOTIFY == 0 )
+            configASSERT( pxSocket->xEventGroup != NULL );
+        #endif
 
         xEvent.eEventType = eSocketSignalEvent;
         xEvent.pvData = pxSocket;
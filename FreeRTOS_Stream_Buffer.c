@@ -42,6 +42,82 @@
 #include "FreeRTOS_Sockets.h"
 #include "FreeRTOS_IP_Private.h"
 
+/*
+ * Advance a marker by uxCount positions.
+ */
+static size_t prvStreamBufferIncrement( const StreamBuffer_t * pxBuffer,
+                                        size_t uxPosition,
+                                        size_t uxCount );
+
+/*
+ * Describe uxCount bytes starting at a marker as two spans.
+ */
+static void prvStreamBufferSpans( StreamBuffer_t * pxBuffer,
+                                  size_t uxPosition,
+                                  size_t uxCount,
+                                  StreamSpan_t pxSpans[ 2 ] );
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Advance a marker by uxCount positions. A marker of a power-of-two
+ *        buffer is a free-running counter, other markers wrap at LENGTH.
+ * @param[in] pxBuffer: The circular stream buffer.
+ * @param[in] uxPosition: The current value of the marker.
+ * @param[in] uxCount: The number of positions to advance, at most LENGTH.
+ * @return The new value of the marker.
+ */
+static size_t prvStreamBufferIncrement( const StreamBuffer_t * pxBuffer,
+                                        size_t uxPosition,
+                                        size_t uxCount )
+{
+    size_t uxNewPosition = uxPosition + uxCount;
+
+    #if ( ipconfigUSE_POW2_STREAM_BUFFERS == 1 )
+        if( pxBuffer->uxMask != 0U )
+        {
+            /* The counter will be masked when the array is accessed. */
+        }
+        else
+    #endif
+    {
+        if( uxNewPosition >= pxBuffer->LENGTH )
+        {
+            uxNewPosition -= pxBuffer->LENGTH;
+        }
+    }
+
+    return uxNewPosition;
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Translate a marker to an index in ucArray[].
+ * @param[in] pxBuffer: The circular stream buffer.
+ * @param[in] uxPosition: The marker, e.g. uxHead or uxMid.
+ * @return The index of the marker in ucArray[].
+ */
+size_t uxStreamBufferIndex( const StreamBuffer_t * pxBuffer,
+                            size_t uxPosition )
+{
+    size_t uxIndex = uxPosition;
+
+    #if ( ipconfigUSE_POW2_STREAM_BUFFERS == 1 )
+        {
+            if( pxBuffer->uxMask != 0U )
+            {
+                uxIndex &= pxBuffer->uxMask;
+            }
+        }
+    #else
+        {
+            ( void ) pxBuffer;
+        }
+    #endif
+
+    return uxIndex;
+}
+/*-----------------------------------------------------------*/
 
 /**
  * @brief Get the space between lower and upper value provided to the function.
@@ -49,7 +125,8 @@
  * @param[in] uxLower: The lower value.
  * @param[in] uxUpper: The upper value.
  * @return The space between uxLower and uxUpper, which equals to the distance
- *         minus 1.
+ *         minus 1.  A power-of-two buffer has no spare position, its space
+ *         equals LENGTH minus the distance from uxUpper to uxLower.
  */
 size_t uxStreamBufferSpace( const StreamBuffer_t * pxBuffer,
                             const size_t uxLower,
@@ -57,11 +134,20 @@ size_t uxStreamBufferSpace( const StreamBuffer_t * pxBuffer,
 {
     size_t uxCount;
 
-    uxCount = pxBuffer->LENGTH + uxUpper - uxLower - 1U;
-
-    if( uxCount >= pxBuffer->LENGTH )
+    #if ( ipconfigUSE_POW2_STREAM_BUFFERS == 1 )
+        if( pxBuffer->uxMask != 0U )
+        {
+            uxCount = pxBuffer->LENGTH - ( uxLower - uxUpper );
+        }
+        else
+    #endif
     {
-        uxCount -= pxBuffer->LENGTH;
+        uxCount = pxBuffer->LENGTH + uxUpper - uxLower - 1U;
+
+        if( uxCount >= pxBuffer->LENGTH )
+        {
+            uxCount -= pxBuffer->LENGTH;
+        }
     }
 
     return uxCount;
@@ -72,7 +158,9 @@ size_t uxStreamBufferSpace( const StreamBuffer_t * pxBuffer,
  * @param[in] pxBuffer: The circular stream buffer.
  * @param[in] uxLower: The lower value.
  * @param[in] uxUpper: The upper value.
- * @return The distance between uxLower and uxUpper.
+ * @return The distance between uxLower and uxUpper.  In a power-of-two buffer
+ *         the values may be counters as well as indices, the distance is taken
+ *         modulo LENGTH.
  */
 size_t uxStreamBufferDistance( const StreamBuffer_t * pxBuffer,
                                const size_t uxLower,
@@ -80,11 +168,20 @@ size_t uxStreamBufferDistance( const StreamBuffer_t * pxBuffer,
 {
     size_t uxCount;
 
-    uxCount = pxBuffer->LENGTH + uxUpper - uxLower;
-
-    if( uxCount >= pxBuffer->LENGTH )
+    #if ( ipconfigUSE_POW2_STREAM_BUFFERS == 1 )
+        if( pxBuffer->uxMask != 0U )
+        {
+            uxCount = ( uxUpper - uxLower ) & pxBuffer->uxMask;
+        }
+        else
+    #endif
     {
-        uxCount -= pxBuffer->LENGTH;
+        uxCount = pxBuffer->LENGTH + uxUpper - uxLower;
+
+        if( uxCount >= pxBuffer->LENGTH )
+        {
+            uxCount -= pxBuffer->LENGTH;
+        }
     }
 
     return uxCount;
@@ -132,8 +229,21 @@ size_t uxStreamBufferGetSize( const StreamBuffer_t * pxBuffer )
 {
     size_t uxHead = pxBuffer->uxHead;
     size_t uxTail = pxBuffer->uxTail;
+    size_t uxCount;
+
+    #if ( ipconfigUSE_POW2_STREAM_BUFFERS == 1 )
+        if( pxBuffer->uxMask != 0U )
+        {
+            /* The counters tell a full buffer from an empty one. */
+            uxCount = uxHead - uxTail;
+        }
+        else
+    #endif
+    {
+        uxCount = uxStreamBufferDistance( pxBuffer, uxTail, uxHead );
+    }
 
-    return uxStreamBufferDistance( pxBuffer, uxTail, uxHead );
+    return uxCount;
 }
 /*-----------------------------------------------------------*/
 
@@ -147,8 +257,49 @@ size_t uxStreamBufferMidSpace( const StreamBuffer_t * pxBuffer )
 {
     size_t uxHead = pxBuffer->uxHead;
     size_t uxMid = pxBuffer->uxMid;
+    size_t uxCount;
+
+    #if ( ipconfigUSE_POW2_STREAM_BUFFERS == 1 )
+        if( pxBuffer->uxMask != 0U )
+        {
+            uxCount = uxHead - uxMid;
+        }
+        else
+    #endif
+    {
+        uxCount = uxStreamBufferDistance( pxBuffer, uxMid, uxHead );
+    }
+
+    return uxCount;
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Set the length of a new stream buffer and make it empty.  When
+ *        ipconfigUSE_POW2_STREAM_BUFFERS is defined as 1 and uxLength is a
+ *        power of two, the buffer will use masks and free-running counters.
+ * @param[in] pxBuffer: The circular stream buffer.
+ * @param[in] uxLength: The size of ucArray[].
+ */
+void vStreamBufferInit( StreamBuffer_t * pxBuffer,
+                        size_t uxLength )
+{
+    pxBuffer->LENGTH = uxLength;
 
-    return uxStreamBufferDistance( pxBuffer, uxMid, uxHead );
+    #if ( ipconfigUSE_POW2_STREAM_BUFFERS == 1 )
+        {
+            if( ( uxLength > 1U ) && ( ( uxLength & ( uxLength - 1U ) ) == 0U ) )
+            {
+                pxBuffer->uxMask = uxLength - 1U;
+            }
+            else
+            {
+                pxBuffer->uxMask = 0U;
+            }
+        }
+    #endif
+
+    vStreamBufferClear( pxBuffer );
 }
 /*-----------------------------------------------------------*/
 
@@ -185,14 +336,7 @@ void vStreamBufferMoveMid( StreamBuffer_t * pxBuffer,
         uxMoveCount = uxSize;
     }
 
-    uxMid += uxMoveCount;
-
-    if( uxMid >= pxBuffer->LENGTH )
-    {
-        uxMid -= pxBuffer->LENGTH;
-    }
-
-    pxBuffer->uxMid = uxMid;
+    pxBuffer->uxMid = prvStreamBufferIncrement( pxBuffer, uxMid, uxMoveCount );
 }
 /*-----------------------------------------------------------*/
 
@@ -212,27 +356,44 @@ BaseType_t xStreamBufferLessThenEqual( const StreamBuffer_t * pxBuffer,
     BaseType_t xReturn;
     size_t uxTail = pxBuffer->uxTail;
 
-    /* Returns true if ( uxLeft < uxRight ) */
-    if( ( ( ( uxLeft < uxTail ) ? 1U : 0U ) ^ ( ( uxRight < uxTail ) ? 1U : 0U ) ) != 0U )
-    {
-        if( uxRight < uxTail )
+    #if ( ipconfigUSE_POW2_STREAM_BUFFERS == 1 )
+        if( pxBuffer->uxMask != 0U )
         {
-            xReturn = pdTRUE;
+            /* Compare the distances from the tail, the counters may wrap. */
+            if( ( uxLeft - uxTail ) <= ( uxRight - uxTail ) )
+            {
+                xReturn = pdTRUE;
+            }
+            else
+            {
+                xReturn = pdFALSE;
+            }
         }
         else
-        {
-            xReturn = pdFALSE;
-        }
-    }
-    else
+    #endif
     {
-        if( uxLeft <= uxRight )
+        /* Returns true if ( uxLeft < uxRight ) */
+        if( ( ( ( uxLeft < uxTail ) ? 1U : 0U ) ^ ( ( uxRight < uxTail ) ? 1U : 0U ) ) != 0U )
         {
-            xReturn = pdTRUE;
+            if( uxRight < uxTail )
+            {
+                xReturn = pdTRUE;
+            }
+            else
+            {
+                xReturn = pdFALSE;
+            }
         }
         else
         {
-            xReturn = pdFALSE;
+            if( uxLeft <= uxRight )
+            {
+                xReturn = pdTRUE;
+            }
+            else
+            {
+                xReturn = pdFALSE;
+            }
         }
     }
 
@@ -254,7 +415,7 @@ BaseType_t xStreamBufferLessThenEqual( const StreamBuffer_t * pxBuffer,
 size_t uxStreamBufferGetPtr( StreamBuffer_t * pxBuffer,
                              uint8_t ** ppucData )
 {
-    size_t uxNextTail = pxBuffer->uxTail;
+    size_t uxNextTail = uxStreamBufferIndex( pxBuffer, pxBuffer->uxTail );
     size_t uxSize = uxStreamBufferGetSize( pxBuffer );
 
     *ppucData = pxBuffer->ucArray + uxNextTail;
@@ -280,7 +441,7 @@ size_t uxStreamBufferAdd( StreamBuffer_t * pxBuffer,
                           const uint8_t * pucData,
                           size_t uxByteCount )
 {
-    size_t uxSpace, uxNextHead, uxFirst;
+    size_t uxSpace, uxNextHead, uxFirst, uxIndex;
     size_t uxCount = uxByteCount;
 
     uxSpace = uxStreamBufferGetSpace( pxBuffer );
@@ -306,12 +467,7 @@ size_t uxStreamBufferAdd( StreamBuffer_t * pxBuffer,
         if( uxOffset != 0U )
         {
             /* ( uxOffset > 0 ) means: write in front if the uxHead marker */
-            uxNextHead += uxOffset;
-
-            if( uxNextHead >= pxBuffer->LENGTH )
-            {
-                uxNextHead -= pxBuffer->LENGTH;
-            }
+            uxNextHead = prvStreamBufferIncrement( pxBuffer, uxNextHead, uxOffset );
         }
 
         if( pucData != NULL )
@@ -319,10 +475,11 @@ size_t uxStreamBufferAdd( StreamBuffer_t * pxBuffer,
             /* Calculate the number of bytes that can be added in the first
             * write - which may be less than the total number of bytes that need
             * to be added if the buffer will wrap back to the beginning. */
-            uxFirst = FreeRTOS_min_uint32( pxBuffer->LENGTH - uxNextHead, uxCount );
+            uxIndex = uxStreamBufferIndex( pxBuffer, uxNextHead );
+            uxFirst = FreeRTOS_min_uint32( pxBuffer->LENGTH - uxIndex, uxCount );
 
             /* Write as many bytes as can be written in the first write. */
-            ( void ) memcpy( &( pxBuffer->ucArray[ uxNextHead ] ), pucData, uxFirst );
+            ( void ) memcpy( &( pxBuffer->ucArray[ uxIndex ] ), pucData, uxFirst );
 
             /* If the number of bytes written was less than the number that
              * could be written in the first write... */
@@ -337,12 +494,7 @@ size_t uxStreamBufferAdd( StreamBuffer_t * pxBuffer,
         if( uxOffset == 0U )
         {
             /* ( uxOffset == 0 ) means: write at uxHead position */
-            uxNextHead += uxCount;
-
-            if( uxNextHead >= pxBuffer->LENGTH )
-            {
-                uxNextHead -= pxBuffer->LENGTH;
-            }
+            uxNextHead = prvStreamBufferIncrement( pxBuffer, uxNextHead, uxCount );
 
             pxBuffer->uxHead = uxNextHead;
         }
@@ -376,7 +528,7 @@ size_t uxStreamBufferGet( StreamBuffer_t * pxBuffer,
                           size_t uxMaxCount,
                           BaseType_t xPeek )
 {
-    size_t uxSize, uxCount, uxFirst, uxNextTail;
+    size_t uxSize, uxCount, uxFirst, uxNextTail, uxIndex;
 
     /* How much data is available? */
     uxSize = uxStreamBufferGetSize( pxBuffer );
@@ -399,12 +551,7 @@ size_t uxStreamBufferGet( StreamBuffer_t * pxBuffer,
 
         if( uxOffset != 0U )
         {
-            uxNextTail += uxOffset;
-
-            if( uxNextTail >= pxBuffer->LENGTH )
-            {
-                uxNextTail -= pxBuffer->LENGTH;
-            }
+            uxNextTail = prvStreamBufferIncrement( pxBuffer, uxNextTail, uxOffset );
         }
 
         if( pucData != NULL )
@@ -412,11 +559,12 @@ size_t uxStreamBufferGet( StreamBuffer_t * pxBuffer,
             /* Calculate the number of bytes that can be read - which may be
              * less than the number wanted if the data wraps around to the start of
              * the buffer. */
-            uxFirst = FreeRTOS_min_uint32( pxBuffer->LENGTH - uxNextTail, uxCount );
+            uxIndex = uxStreamBufferIndex( pxBuffer, uxNextTail );
+            uxFirst = FreeRTOS_min_uint32( pxBuffer->LENGTH - uxIndex, uxCount );
 
             /* Obtain the number of bytes it is possible to obtain in the first
              * read. */
-            ( void ) memcpy( pucData, &( pxBuffer->ucArray[ uxNextTail ] ), uxFirst );
+            ( void ) memcpy( pucData, &( pxBuffer->ucArray[ uxIndex ] ), uxFirst );
 
             /* If the total number of wanted bytes is greater than the number
              * that could be read in the first read... */
@@ -431,16 +579,141 @@ size_t uxStreamBufferGet( StreamBuffer_t * pxBuffer,
         {
             /* Move the tail pointer to effectively remove the data read from
              * the buffer. */
-            uxNextTail += uxCount;
+            pxBuffer->uxTail = prvStreamBufferIncrement( pxBuffer, uxNextTail, uxCount );
+        }
+    }
 
-            if( uxNextTail >= pxBuffer->LENGTH )
-            {
-                uxNextTail -= pxBuffer->LENGTH;
-            }
+    return uxCount;
+}
+/*-----------------------------------------------------------*/
 
-            pxBuffer->uxTail = uxNextTail;
-        }
+/**
+ * @brief Describe uxCount bytes starting at a marker as two spans.
+ *
+ * @param[in] pxBuffer: The circular stream buffer.
+ * @param[in] uxPosition: The marker where the first span starts.
+ * @param[in] uxCount: The total number of bytes, at most LENGTH.
+ * @param[out] pxSpans: The two spans, the second one is empty when the
+ *                      bytes do not wrap.
+ */
+static void prvStreamBufferSpans( StreamBuffer_t * pxBuffer,
+                                  size_t uxPosition,
+                                  size_t uxCount,
+                                  StreamSpan_t pxSpans[ 2 ] )
+{
+    size_t uxIndex = uxStreamBufferIndex( pxBuffer, uxPosition );
+    size_t uxFirst = FreeRTOS_min_uint32( pxBuffer->LENGTH - uxIndex, uxCount );
+
+    pxSpans[ 0 ].pucData = NULL;
+    pxSpans[ 0 ].uxLength = uxFirst;
+    pxSpans[ 1 ].pucData = NULL;
+    pxSpans[ 1 ].uxLength = uxCount - uxFirst;
+
+    if( uxFirst != 0U )
+    {
+        pxSpans[ 0 ].pucData = &( pxBuffer->ucArray[ uxIndex ] );
+    }
+
+    if( pxSpans[ 1 ].uxLength != 0U )
+    {
+        pxSpans[ 1 ].pucData = pxBuffer->ucArray;
+    }
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Get direct access to the data in a stream buffer, without copying it.
+ *
+ * @param[in] pxBuffer: The circular stream buffer.
+ * @param[in] uxOffset: The number of bytes after uxTail where the spans start.
+ * @param[out] pxSpans: Two spans that will describe the data.  The second span
+ *                      is only used when the data wraps around.
+ *
+ * @return The total number of bytes in the two spans.
+ */
+size_t uxStreamBufferPeekData( StreamBuffer_t * pxBuffer,
+                               size_t uxOffset,
+                               StreamSpan_t pxSpans[ 2 ] )
+{
+    size_t uxCount = uxStreamBufferGetSize( pxBuffer );
+    size_t uxPosition = pxBuffer->uxTail;
+
+    if( uxCount > uxOffset )
+    {
+        uxCount -= uxOffset;
+        uxPosition = prvStreamBufferIncrement( pxBuffer, uxPosition, uxOffset );
+    }
+    else
+    {
+        uxCount = 0U;
+    }
+
+    prvStreamBufferSpans( pxBuffer, uxPosition, uxCount, pxSpans );
+
+    return uxCount;
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Get direct access to the free space of a stream buffer, so that data
+ *        can be written into it without copying.
+ *
+ * @param[in] pxBuffer: The circular stream buffer.
+ * @param[in] uxOffset: The number of bytes after uxHead where the spans start.
+ * @param[out] pxSpans: Two spans that will describe the free space.  The
+ *                      second span is only used when the space wraps around.
+ *
+ * @return The total number of bytes in the two spans.
+ */
+size_t uxStreamBufferPeekSpace( StreamBuffer_t * pxBuffer,
+                                size_t uxOffset,
+                                StreamSpan_t pxSpans[ 2 ] )
+{
+    size_t uxCount = uxStreamBufferGetSpace( pxBuffer );
+    size_t uxPosition = pxBuffer->uxHead;
+
+    if( uxCount > uxOffset )
+    {
+        uxCount -= uxOffset;
+        uxPosition = prvStreamBufferIncrement( pxBuffer, uxPosition, uxOffset );
+    }
+    else
+    {
+        uxCount = 0U;
     }
 
+    prvStreamBufferSpans( pxBuffer, uxPosition, uxCount, pxSpans );
+
     return uxCount;
 }
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Remove data that was read with uxStreamBufferPeekData().
+ *
+ * @param[in] pxBuffer: The circular stream buffer.
+ * @param[in] uxCount: The number of bytes to remove.
+ *
+ * @return The number of bytes removed, at most the number of bytes stored.
+ */
+size_t uxStreamBufferConsume( StreamBuffer_t * pxBuffer,
+                              size_t uxCount )
+{
+    return uxStreamBufferGet( pxBuffer, 0U, NULL, uxCount, pdFALSE );
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Add data that was written with uxStreamBufferPeekSpace().
+ *
+ * @param[in] pxBuffer: The circular stream buffer.
+ * @param[in] uxCount: The number of bytes to add.
+ *
+ * @return The number of bytes added, at most the free space.
+ */
+size_t uxStreamBufferCommit( StreamBuffer_t * pxBuffer,
+                             size_t uxCount )
+{
+    return uxStreamBufferAdd( pxBuffer, 0U, NULL, uxCount );
+}
+/*-----------------------------------------------------------*/
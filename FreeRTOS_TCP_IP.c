@@ -185,6 +185,23 @@
  */
     static void prvTCPCreateWindow( FreeRTOS_Socket_t * pxSocket );
 
+    #if ( ipconfigUSE_TCP_NEXT_HOP_CACHE == 1 )
+
+/*
+ * Store the MAC address of the next hop, and the ARP generation in which it
+ * was found.
+ */
+        static void prvTCPSetNextHop( FreeRTOS_Socket_t * pxSocket,
+                                      const MACAddress_t * pxMACAddress,
+                                      uint32_t ulGeneration );
+
+/*
+ * Look up the MAC address of the next hop again, after the ARP generation has
+ * changed.
+ */
+        static void prvTCPRefreshNextHop( FreeRTOS_Socket_t * pxSocket );
+    #endif
+
 /*
  * Let ARP look-up the MAC-address of the peer and initialise the first SYN
  * packet.
@@ -279,7 +296,7 @@
  */
     static BaseType_t prvStoreRxData( FreeRTOS_Socket_t * pxSocket,
                                       const uint8_t * pucRecvData,
-                                      NetworkBufferDescriptor_t * pxNetworkBuffer,
+                                      NetworkBufferDescriptor_t ** ppxNetworkBuffer,
                                       uint32_t ulReceiveLength );
 
 /*
@@ -549,6 +566,17 @@
         BaseType_t xResult = 0;
         BaseType_t xReady = pdFALSE;
 
+        #if ( ipconfigUSE_TCP_ELASTIC_STREAMS == 1 )
+            {
+                if( pxSocket->u.xTCP.xTxStreamFull != pdFALSE )
+                {
+                    /* FreeRTOS_send() is waiting for space in the TX stream. */
+                    pxSocket->u.xTCP.xTxStreamFull = pdFALSE;
+                    ( void ) xTCPStreamGrow( pxSocket, pdFALSE, 0U );
+                }
+            }
+        #endif
+
         if( ( pxSocket->u.xTCP.ucTCPState >= ( uint8_t ) eESTABLISHED ) && ( pxSocket->u.xTCP.txStream != NULL ) )
         {
             /* The API FreeRTOS_send() might have added data to the TX stream.  Add
@@ -741,8 +769,20 @@
         int32_t lResult = 0;
         UBaseType_t uxOptionsLength = 0U;
         int32_t xSendLength;
+        UBaseType_t uxMaxCount = ( UBaseType_t ) SEND_REPEATED_COUNT;
 
-        for( uxIndex = 0U; uxIndex < ( UBaseType_t ) SEND_REPEATED_COUNT; uxIndex++ )
+        #if ( ipconfigUSE_BUFFER_PRESSURE == 1 )
+            {
+                /* Network buffers are scarce: send one message now, the rest
+                 * will follow with the next TCP timer event. */
+                if( eGetNetworkBufferPressure() != eBufferPressureNone )
+                {
+                    uxMaxCount = 1U;
+                }
+            }
+        #endif
+
+        for( uxIndex = 0U; uxIndex < uxMaxCount; uxIndex++ )
         {
             /* prvTCPPrepareSend() might allocate a network buffer if there is data
              * to be sent. */
@@ -765,6 +805,15 @@
             lResult += xSendLength;
         }
 
+        #if ( ipconfigUSE_BUFFER_PRESSURE == 1 )
+            {
+                if( ( uxIndex == uxMaxCount ) && ( uxMaxCount < ( UBaseType_t ) SEND_REPEATED_COUNT ) )
+                {
+                    iptraceTCP_SEND_DEFERRED( pxSocket );
+                }
+            }
+        #endif
+
         /* Return the total number of bytes sent. */
         return lResult;
     }
@@ -795,6 +844,9 @@
         const TCPWindow_t * pxTCPWindow;
         NetworkBufferDescriptor_t * pxNetworkBuffer = pxDescriptor;
         NetworkBufferDescriptor_t xTempBuffer;
+        #if ( ipconfigZERO_COPY_TX_DRIVER != 0 )
+            NetworkBufferDescriptor_t * pxNewBuffer = NULL;
+        #endif
         /* memcpy() helper variables for MISRA Rule 21.15 compliance*/
         const void * pvCopySource;
         void * pvCopyDest;
@@ -820,7 +872,21 @@
             {
                 if( xDoRelease == pdFALSE )
                 {
-                    pxNetworkBuffer = pxDuplicateNetworkBufferWithDescriptor( pxNetworkBuffer, ( size_t ) pxNetworkBuffer->xDataLength );
+                    #if ( ipconfigUSE_NETWORK_BUFFER_CLONES == 1 )
+                        if( pxNetworkBuffer != &xTempBuffer )
+                        {
+                            /* The caller releases its buffer right after this call,
+                             * so the driver may share the frame in stead of copying it. */
+                            pxNewBuffer = pxCloneNetworkBufferWithDescriptor( pxNetworkBuffer );
+                        }
+
+                        if( pxNewBuffer == NULL )
+                    #endif
+                    {
+                        pxNewBuffer = pxDuplicateNetworkBufferWithDescriptor( pxNetworkBuffer, ( size_t ) pxNetworkBuffer->xDataLength );
+                    }
+
+                    pxNetworkBuffer = pxNewBuffer;
 
                     if( pxNetworkBuffer != NULL )
                     {
@@ -860,9 +926,21 @@
                 {
                     /* No RX stream has been created, the full stream size is
                      * available. */
-                    ulFrontSpace = ( uint32_t ) pxSocket->u.xTCP.uxRxStreamSize;
+                    #if ( ipconfigUSE_TCP_ELASTIC_STREAMS == 1 )
+                        ulFrontSpace = ( uint32_t ) uxTCPStreamInitialSize( pxSocket, pdTRUE );
+                    #else
+                        ulFrontSpace = ( uint32_t ) pxSocket->u.xTCP.uxRxStreamSize;
+                    #endif
                 }
 
+                #if ( ipconfigUSE_TCP_RX_CHAIN == 1 )
+                    {
+                        /* Received data is stored by network buffer, do not
+                         * advertise more than the free links can take. */
+                        ulFrontSpace = FreeRTOS_min_uint32( ulFrontSpace, ( uint32_t ) uxTCPRxChainCapacity( pxSocket ) );
+                    }
+                #endif
+
                 /* Take the minimum of the RX buffer space and the RX window size. */
                 ulSpace = FreeRTOS_min_uint32( pxTCPWindow->xSize.ulRxWindowLength, ulFrontSpace );
 
@@ -883,6 +961,17 @@
                     ulSpace = pxSocket->u.xTCP.usMSS;
                 }
 
+                #if ( ipconfigUSE_BUFFER_PRESSURE == 1 )
+                    {
+                        /* Network buffers are scarce: ask the peer to keep fewer
+                         * segments in flight. */
+                        if( eGetNetworkBufferPressure() != eBufferPressureNone )
+                        {
+                            ulSpace = FreeRTOS_min_uint32( ulSpace, ( ( uint32_t ) pxSocket->u.xTCP.usMSS ) * ( uint32_t ) ipconfigBUFFER_PRESSURE_TCP_WINDOW );
+                        }
+                    }
+                #endif
+
                 /* Avoid overflow of the 16-bit win field. */
                 #if ( ipconfigUSE_TCP_WIN != 0 )
                     {
@@ -974,8 +1063,7 @@
             vFlip_16( pxTCPPacket->xTCPHeader.usSourcePort, pxTCPPacket->xTCPHeader.usDestinationPort );
 
             /* Just an increasing number. */
-            pxIPHeader->usIdentification = FreeRTOS_htons( usPacketIdentifier );
-            usPacketIdentifier++;
+            pxIPHeader->usIdentification = FreeRTOS_htons( usGetNextPacketIdentifier() );
 
             /* The stack doesn't support fragments, so the fragment offset field must always be zero.
              * The header was never memset to zero, so set both the fragment offset and fragmentation flags in one go.
@@ -1007,6 +1095,24 @@
                 }
             #endif
 
+            #if ( ipconfigUSE_TCP_NEXT_HOP_CACHE == 1 )
+                if( pxSocket != NULL )
+                {
+                    if( pxSocket->u.xTCP.ulARPGeneration != ulARPGetGeneration() )
+                    {
+                        prvTCPRefreshNextHop( pxSocket );
+                    }
+
+                    if( pxSocket->u.xTCP.xNextHopValid != pdFALSE )
+                    {
+                        /* The source address will be copied to the destination. */
+                        ( void ) memcpy( ( void * ) ( &( pxEthernetHeader->xSourceAddress ) ),
+                                         ( const void * ) ( &( pxSocket->u.xTCP.xNextHopMAC ) ),
+                                         sizeof( pxEthernetHeader->xSourceAddress ) );
+                    }
+                }
+            #endif /* ipconfigUSE_TCP_NEXT_HOP_CACHE */
+
             /* Fill in the destination MAC addresses. */
             ( void ) memcpy( ( void * ) ( &( pxEthernetHeader->xDestinationAddress ) ),
                              ( const void * ) ( &( pxEthernetHeader->xSourceAddress ) ),
@@ -1058,6 +1164,49 @@
     }
     /*-----------------------------------------------------------*/
 
+    #if ( ipconfigUSE_TCP_NEXT_HOP_CACHE == 1 )
+
+/**
+ * @brief Store the MAC address of the next hop of a socket.
+ *
+ * @param[in] pxSocket: The socket.
+ * @param[in] pxMACAddress: The MAC address of the peer, or of the gateway.
+ * @param[in] ulGeneration: The ARP generation in which the address was found.
+ */
+        static void prvTCPSetNextHop( FreeRTOS_Socket_t * pxSocket,
+                                      const MACAddress_t * pxMACAddress,
+                                      uint32_t ulGeneration )
+        {
+            ( void ) memcpy( ( void * ) ( pxSocket->u.xTCP.xNextHopMAC.ucBytes ),
+                             ( const void * ) ( pxMACAddress->ucBytes ),
+                             sizeof( pxSocket->u.xTCP.xNextHopMAC.ucBytes ) );
+            pxSocket->u.xTCP.ulARPGeneration = ulGeneration;
+            pxSocket->u.xTCP.xNextHopValid = pdTRUE;
+        }
+        /*-----------------------------------------------------------*/
+
+/**
+ * @brief An entry in the ARP cache has been replaced or removed.  Look up the
+ *        MAC address of the next hop again.  When it is not found, the address
+ *        that was used so far will still be used, and the look-up will be
+ *        repeated for the next packet.
+ *
+ * @param[in] pxSocket: The socket.
+ */
+        static void prvTCPRefreshNextHop( FreeRTOS_Socket_t * pxSocket )
+        {
+            uint32_t ulIPAddress = FreeRTOS_htonl( pxSocket->u.xTCP.ulRemoteIP );
+            uint32_t ulGeneration = ulARPGetGeneration();
+            MACAddress_t xMACAddress;
+
+            if( eARPGetCacheEntry( &( ulIPAddress ), &( xMACAddress ) ) == eARPCacheHit )
+            {
+                prvTCPSetNextHop( pxSocket, &( xMACAddress ), ulGeneration );
+            }
+        }
+        /*-----------------------------------------------------------*/
+    #endif /* ipconfigUSE_TCP_NEXT_HOP_CACHE */
+
 /**
  * @brief Create the TCP window for the given socket.
  *
@@ -1114,6 +1263,10 @@
         BaseType_t xReturn = pdTRUE;
         uint32_t ulInitialSequenceNumber = 0;
 
+        #if ( ipconfigUSE_TCP_NEXT_HOP_CACHE == 1 )
+            uint32_t ulGeneration;
+        #endif
+
         #if ( ipconfigHAS_PRINTF != 0 )
             {
                 /* Only necessary for nicer logging. */
@@ -1123,12 +1276,20 @@
 
         ulRemoteIP = FreeRTOS_htonl( pxSocket->u.xTCP.ulRemoteIP );
 
+        #if ( ipconfigUSE_TCP_NEXT_HOP_CACHE == 1 )
+            /* Read the generation before the look-up, as in prvTCPRefreshNextHop(). */
+            ulGeneration = ulARPGetGeneration();
+        #endif
+
         /* Determine the ARP cache status for the requested IP address. */
         eReturned = eARPGetCacheEntry( &( ulRemoteIP ), &( xEthAddress ) );
 
         switch( eReturned )
         {
             case eARPCacheHit:    /* An ARP table lookup found a valid entry. */
+                #if ( ipconfigUSE_TCP_NEXT_HOP_CACHE == 1 )
+                    prvTCPSetNextHop( pxSocket, &( xEthAddress ), ulGeneration );
+                #endif
                 break;            /* We can now prepare the SYN packet. */
 
             case eARPCacheMiss:   /* An ARP table lookup did not find a valid entry. */
@@ -1149,7 +1310,15 @@
                                          xEthAddress.ucBytes[ 5 ] ) );
 
                 /* And issue a (new) ARP request */
-                FreeRTOS_OutputARPRequest( ulRemoteIP );
+                #if ( ipconfigUSE_ARP_REQUEST_LIMIT == 1 )
+                    {
+                        vARPResolveAddress( ulRemoteIP );
+                    }
+                #else
+                    {
+                        FreeRTOS_OutputARPRequest( ulRemoteIP );
+                    }
+                #endif
                 xReturn = pdFALSE;
                 break;
         }
@@ -2086,6 +2255,12 @@
                         }
                     #endif
 
+                    #if ( ipconfigUSE_TCP_STATISTICS == 1 )
+                        {
+                            pxSocket->u.xTCP.ulBytesSent += ulDataGot;
+                        }
+                    #endif
+
                     /* If the owner of the socket requests a closure, add the FIN
                      * flag to the last packet. */
                     if( pxSocket->u.xTCP.bits.bCloseRequested != pdFALSE_UNSIGNED )
@@ -2307,10 +2482,11 @@
              *
              * Hand over the new data to the sliding window handler.  It will be
              * split-up in chunks of 1460 bytes each (or less, depending on
-             * ipconfigTCP_MSS). */
+             * ipconfigTCP_MSS).  The window works with indices, not with the
+             * counters of a power-of-two stream. */
             lCount = lTCPWindowTxAdd( &pxSocket->u.xTCP.xTCPWindow,
                                       ( uint32_t ) lLength,
-                                      ( int32_t ) pxSocket->u.xTCP.txStream->uxMid,
+                                      ( int32_t ) uxStreamBufferIndex( pxSocket->u.xTCP.txStream, pxSocket->u.xTCP.txStream->uxMid ),
                                       ( int32_t ) pxSocket->u.xTCP.txStream->LENGTH );
 
             /* Move the rxMid pointer forward up to rxHead. */
@@ -2517,19 +2693,21 @@
  *
  * @param[in] pxSocket: The socket owning the connection.
  * @param[in] pucRecvData: Pointer to received data.
- * @param[in] pxNetworkBuffer: The network buffer descriptor.
+ * @param[in,out] ppxNetworkBuffer: The network buffer descriptor.  When the
+ *                socket keeps the buffer in its RX chain, it is replaced with
+ *                a buffer that holds a copy of the headers.
  * @param[in] ulReceiveLength: The length of the received data.
  *
  * @return 0 on success, -1 on failure of storing data.
  */
     static BaseType_t prvStoreRxData( FreeRTOS_Socket_t * pxSocket,
                                       const uint8_t * pucRecvData,
-                                      NetworkBufferDescriptor_t * pxNetworkBuffer,
+                                      NetworkBufferDescriptor_t ** ppxNetworkBuffer,
                                       uint32_t ulReceiveLength )
     {
         /* Map the ethernet buffer onto the ProtocolHeader_t struct for easy access to the fields. */
         const ProtocolHeaders_t * pxProtocolHeaders = ipCAST_CONST_PTR_TO_CONST_TYPE_PTR( ProtocolHeaders_t,
-                                                                                          &( pxNetworkBuffer->pucEthernetBuffer[ ipSIZE_OF_ETH_HEADER + xIPHeaderSize( pxNetworkBuffer ) ] ) );
+                                                                                          &( ( *ppxNetworkBuffer )->pucEthernetBuffer[ ipSIZE_OF_ETH_HEADER + xIPHeaderSize( *ppxNetworkBuffer ) ] ) );
         const TCPHeader_t * pxTCPHeader = &pxProtocolHeaders->xTCPHeader;
         TCPWindow_t * pxTCPWindow = &pxSocket->u.xTCP.xTCPWindow;
         uint32_t ulSequenceNumber, ulSpace;
@@ -2547,15 +2725,46 @@
              * ack (SACK) option to confirm it.  In that case, lTCPAddRxdata() will be
              * called later to store an out-of-order packet (in case lOffset is
              * negative). */
+            #if ( ipconfigUSE_TCP_ELASTIC_STREAMS == 1 )
+                {
+                    /* The number of bytes needed after the head of the stream. */
+                    uint32_t ulNeeded = ( ulSequenceNumber + ulReceiveLength ) - pxTCPWindow->rx.ulCurrentSequenceNumber;
+
+                    if( ( pxSocket->u.xTCP.rxStream != NULL ) &&
+                        ( ( int32_t ) ulNeeded > 0 ) &&
+                        ( uxStreamBufferGetSpace( pxSocket->u.xTCP.rxStream ) < ( size_t ) ulNeeded ) )
+                    {
+                        ( void ) xTCPStreamGrow( pxSocket, pdTRUE, ( size_t ) ulNeeded );
+                    }
+                }
+            #endif /* ipconfigUSE_TCP_ELASTIC_STREAMS */
+
             if( pxSocket->u.xTCP.rxStream != NULL )
             {
                 ulSpace = ( uint32_t ) uxStreamBufferGetSpace( pxSocket->u.xTCP.rxStream );
             }
             else
             {
-                ulSpace = ( uint32_t ) pxSocket->u.xTCP.uxRxStreamSize;
+                #if ( ipconfigUSE_TCP_ELASTIC_STREAMS == 1 )
+                    ulSpace = ( uint32_t ) uxTCPStreamInitialSize( pxSocket, pdTRUE );
+                #else
+                    ulSpace = ( uint32_t ) pxSocket->u.xTCP.uxRxStreamSize;
+                #endif
             }
 
+            #if ( ipconfigUSE_TCP_RX_CHAIN == 1 )
+                {
+                    BaseType_t xInOrder = ( ( int32_t ) ( ulSequenceNumber - pxTCPWindow->rx.ulCurrentSequenceNumber ) <= 0 ) ? pdTRUE : pdFALSE;
+
+                    /* When the segment can not be kept, it is refused as if the
+                     * window were full.  The peer will send it again. */
+                    if( xTCPRxChainPrepare( pxSocket, xInOrder ) == pdFALSE )
+                    {
+                        ulSpace = 0U;
+                    }
+                }
+            #endif /* ipconfigUSE_TCP_RX_CHAIN */
+
             lOffset = lTCPWindowRxCheck( pxTCPWindow, ulSequenceNumber, ulReceiveLength, ulSpace );
 
             if( lOffset >= 0 )
@@ -2564,7 +2773,24 @@
                  * if the head marker in rxStream may be advanced, only if lOffset == 0.
                  * In case the low-water mark is reached, bLowWater will be set
                  * "low-water" here stands for "little space". */
-                lStored = lTCPAddRxdata( pxSocket, ( uint32_t ) lOffset, pucRecvData, ulReceiveLength );
+                #if ( ipconfigUSE_TCP_RX_CHAIN == 1 )
+                    {
+                        lStored = lTCPAddRxFrame( pxSocket, ( uint32_t ) lOffset, ppxNetworkBuffer, pucRecvData, ulReceiveLength );
+                    }
+                #else
+                    {
+                        lStored = lTCPAddRxdata( pxSocket, ( uint32_t ) lOffset, pucRecvData, ulReceiveLength );
+                    }
+                #endif
+
+                #if ( ipconfigUSE_TCP_STATISTICS == 1 )
+                    {
+                        if( lStored > 0 )
+                        {
+                            pxSocket->u.xTCP.ulBytesReceived += ( uint32_t ) lStored;
+                        }
+                    }
+                #endif
 
                 if( lStored != ( int32_t ) ulReceiveLength )
                 {
@@ -2573,7 +2799,7 @@
                     /* Received data could not be stored.  The socket's flag
                      * bMallocError has been set.  The socket now has the status
                      * eCLOSE_WAIT and a RST packet will be sent back. */
-                    ( void ) prvTCPSendReset( pxNetworkBuffer );
+                    ( void ) prvTCPSendReset( *ppxNetworkBuffer );
                     xResult = -1;
                 }
             }
@@ -3212,12 +3438,22 @@
         }
 
         /* Storing data may result in a fatal error if malloc() fails. */
-        if( prvStoreRxData( pxSocket, pucRecvData, *ppxNetworkBuffer, ulReceiveLength ) < 0 )
+        if( prvStoreRxData( pxSocket, pucRecvData, ppxNetworkBuffer, ulReceiveLength ) < 0 )
         {
             xSendLength = -1;
         }
         else
         {
+            #if ( ipconfigUSE_TCP_RX_CHAIN == 1 )
+                {
+                    /* The socket may have kept the network buffer, the reply
+                     * will be made in a copy of the headers. */
+                    pxProtocolHeaders = ipCAST_PTR_TO_TYPE_PTR( ProtocolHeaders_t,
+                                                                &( ( *ppxNetworkBuffer )->pucEthernetBuffer[ ipSIZE_OF_ETH_HEADER + xIPHeaderSize( *ppxNetworkBuffer ) ] ) );
+                    pxTCPHeader = &( pxProtocolHeaders->xTCPHeader );
+                }
+            #endif /* ipconfigUSE_TCP_RX_CHAIN */
+
             uxOptionsLength = prvSetOptions( pxSocket, *ppxNetworkBuffer );
 
             if( ( pxSocket->u.xTCP.ucTCPState == ( uint8_t ) eSYN_RECEIVED ) && ( ( ucTCPFlags & ( uint8_t ) tcpTCP_FLAG_CTRL ) == ( uint8_t ) tcpTCP_FLAG_SYN ) )
@@ -3658,6 +3894,26 @@
                     }
                 #endif /* ipconfigUSE_TCP_WIN */
 
+                #if ( ipconfigUSE_TCP_STATISTICS == 1 )
+                    {
+                        /* Measure how long the peer advertises a zero window. */
+                        if( ( pxSocket->u.xTCP.ulWindowSize == 0U ) && ( pxSocket->u.xTCP.xZeroWindow == pdFALSE ) )
+                        {
+                            pxSocket->u.xTCP.xZeroWindow = pdTRUE;
+                            pxSocket->u.xTCP.xZeroWindowStart = xTaskGetTickCount();
+                        }
+                        else if( ( pxSocket->u.xTCP.ulWindowSize != 0U ) && ( pxSocket->u.xTCP.xZeroWindow != pdFALSE ) )
+                        {
+                            pxSocket->u.xTCP.xZeroWindow = pdFALSE;
+                            pxSocket->u.xTCP.xZeroWindowTime += xTaskGetTickCount() - pxSocket->u.xTCP.xZeroWindowStart;
+                        }
+                        else
+                        {
+                            /* The state of the window has not changed. */
+                        }
+                    }
+                #endif /* ipconfigUSE_TCP_STATISTICS */
+
                 /* In prvTCPHandleState() the incoming messages will be handled
                  * depending on the current state of the connection. */
                 if( prvTCPHandleState( pxSocket, &pxNetworkBuffer ) > 0 )
@@ -3804,6 +4060,13 @@
             ( void ) memcpy( ( void * ) pxReturn->u.xTCP.xPacket.u.ucLastPacket,
                              ( const void * ) pxNetworkBuffer->pucEthernetBuffer,
                              sizeof( pxReturn->u.xTCP.xPacket.u.ucLastPacket ) );
+
+            #if ( ipconfigUSE_TCP_NEXT_HOP_CACHE == 1 )
+                {
+                    /* The SYN came from the next hop, no ARP look-up is needed. */
+                    prvTCPSetNextHop( pxReturn, &( pxTCPPacket->xEthernetHeader.xSourceAddress ), ulARPGetGeneration() );
+                }
+            #endif
         }
 
         return pxReturn;
@@ -3836,6 +4099,13 @@
         pxNewSocket->u.xTCP.uxRxWinSize = pxSocket->u.xTCP.uxRxWinSize;
         pxNewSocket->u.xTCP.uxTxWinSize = pxSocket->u.xTCP.uxTxWinSize;
 
+        #if ( ipconfigTCP_WAKEUP_LOW_WATER == 1 )
+            {
+                pxNewSocket->u.xTCP.uxRcvLowat = pxSocket->u.xTCP.uxRcvLowat;
+                pxNewSocket->u.xTCP.uxSndLowat = pxSocket->u.xTCP.uxSndLowat;
+            }
+        #endif /* ipconfigTCP_WAKEUP_LOW_WATER */
+
         #if ( ipconfigSOCKET_HAS_USER_SEMAPHORE == 1 )
             {
                 pxNewSocket->pxUserSemaphore = pxSocket->pxUserSemaphore;
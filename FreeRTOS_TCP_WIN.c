@@ -225,6 +225,16 @@
         static TCPSegment_t * xTCPSegments = NULL;
     #endif /* ipconfigUSE_TCP_WIN == 1 */
 
+    #if ( ( ipconfigUSE_TCP_WIN == 1 ) && ( ipconfigUSE_STATIC_POOLS == 1 ) )
+        /**< The statically allocated storage of the TCP segment pool. */
+        static TCPSegment_t xTCPSegmentStorage[ ipconfigTCP_WIN_SEG_COUNT ];
+    #endif
+
+    #if ( ( ipconfigUSE_TCP_WIN == 1 ) && ( ( ipconfigHAS_DEBUG_PRINTF != 0 ) || ( ipconfigUSE_STATIC_POOLS == 1 ) ) )
+        /**< The lowest number of free segments seen in 'xSegmentList'. */
+        static UBaseType_t uxSegmentLowestFree = ipconfigTCP_WIN_SEG_COUNT;
+    #endif
+
 /**< List of free TCP segments. */
     #if ( ipconfigUSE_TCP_WIN == 1 )
         _static List_t xSegmentList;
@@ -442,7 +452,15 @@
             /* Allocate space for 'xTCPSegments' and store them in 'xSegmentList'. */
 
             vListInitialise( &xSegmentList );
-            xTCPSegments = ipCAST_PTR_TO_TYPE_PTR( TCPSegment_t, pvPortMallocLarge( ( size_t ) ipconfigTCP_WIN_SEG_COUNT * sizeof( xTCPSegments[ 0 ] ) ) );
+            #if ( ipconfigUSE_STATIC_POOLS == 1 )
+                {
+                    xTCPSegments = xTCPSegmentStorage;
+                }
+            #else
+                {
+                    xTCPSegments = ipCAST_PTR_TO_TYPE_PTR( TCPSegment_t, pvPortMallocLarge( ( size_t ) ipconfigTCP_WIN_SEG_COUNT * sizeof( xTCPSegments[ 0 ] ) ) );
+                }
+            #endif
 
             if( xTCPSegments == NULL )
             {
@@ -576,17 +594,16 @@
                 pxSegment->lMaxLength = lCount;
                 pxSegment->lDataLength = lCount;
                 pxSegment->ulSequenceNumber = ulSequenceNumber;
-                #if ( ipconfigHAS_DEBUG_PRINTF != 0 )
+                #if ( ( ipconfigHAS_DEBUG_PRINTF != 0 ) || ( ipconfigUSE_STATIC_POOLS == 1 ) )
                     {
-                        static UBaseType_t xLowestLength = ipconfigTCP_WIN_SEG_COUNT;
                         UBaseType_t xLength = listCURRENT_LIST_LENGTH( &xSegmentList );
 
-                        if( xLowestLength > xLength )
+                        if( uxSegmentLowestFree > xLength )
                         {
-                            xLowestLength = xLength;
+                            uxSegmentLowestFree = xLength;
                         }
                     }
-                #endif /* ipconfigHAS_DEBUG_PRINTF */
+                #endif /* ( ipconfigHAS_DEBUG_PRINTF != 0 ) || ( ipconfigUSE_STATIC_POOLS == 1 ) */
             }
 
             return pxSegment;
@@ -908,7 +925,11 @@
              * function. */
             if( xTCPSegments != NULL )
             {
-                vPortFreeLarge( xTCPSegments );
+                #if ( ipconfigUSE_STATIC_POOLS == 0 )
+                    {
+                        vPortFreeLarge( xTCPSegments );
+                    }
+                #endif
                 xTCPSegments = NULL;
             }
         }
@@ -917,6 +938,32 @@
     #endif /* ipconfgiUSE_TCP_WIN == 1 */
 /*-----------------------------------------------------------*/
 
+    #if ( ( ipconfigUSE_TCP_WIN == 1 ) && ( ipconfigUSE_STATIC_POOLS == 1 ) )
+
+/**
+ * @brief Report the use of the pool of segment descriptors.
+ *
+ * @param[out] puxInUse: The number of segments that are currently in use.
+ * @param[out] puxPeak: The highest number of segments that were in use at the same time.
+ */
+        void vTCPWindowSegmentUsage( UBaseType_t * puxInUse,
+                                     UBaseType_t * puxPeak )
+        {
+            if( xTCPSegments != NULL )
+            {
+                *puxInUse = ( UBaseType_t ) ipconfigTCP_WIN_SEG_COUNT - ( UBaseType_t ) listCURRENT_LIST_LENGTH( &xSegmentList );
+            }
+            else
+            {
+                *puxInUse = 0U;
+            }
+
+            *puxPeak = ( UBaseType_t ) ipconfigTCP_WIN_SEG_COUNT - uxSegmentLowestFree;
+        }
+
+    #endif /* ( ipconfigUSE_TCP_WIN == 1 ) && ( ipconfigUSE_STATIC_POOLS == 1 ) */
+/*-----------------------------------------------------------*/
+
 /*=============================================================================
  *
  *                ######        #    #
@@ -1448,6 +1495,42 @@
 
     #if ( ipconfigUSE_TCP_WIN == 1 )
 
+/**
+ * @brief The data in the TX stream has been moved to a new stream, in which the
+ *        oldest byte is stored at position 0.  Translate the stream positions of
+ *        all outstanding segments.
+ *
+ * @param[in] pxWindow: The descriptor of the TCP sliding windows.
+ * @param[in] lTail: The position of the oldest byte in the old stream.
+ * @param[in] lMax: The size of the old stream.
+ */
+        void vTCPWindowTxRebase( TCPWindow_t * pxWindow,
+                                 int32_t lTail,
+                                 int32_t lMax )
+        {
+            const ListItem_t * pxEnd = listGET_END_MARKER( &pxWindow->xTxSegments );
+            const ListItem_t * pxIterator = listGET_NEXT( pxEnd );
+            TCPSegment_t * pxSegment;
+
+            while( pxIterator != pxEnd )
+            {
+                pxSegment = ipCAST_PTR_TO_TYPE_PTR( TCPSegment_t, listGET_LIST_ITEM_OWNER( pxIterator ) );
+                pxIterator = listGET_NEXT( pxIterator );
+
+                pxSegment->lStreamPos -= lTail;
+
+                if( pxSegment->lStreamPos < 0 )
+                {
+                    pxSegment->lStreamPos += lMax;
+                }
+            }
+        }
+
+    #endif /* ipconfigUSE_TCP_WIN == 1 */
+/*-----------------------------------------------------------*/
+
+    #if ( ipconfigUSE_TCP_WIN == 1 )
+
 /**
  * @brief Find out if the peer is able to receive more data.
  *
@@ -1754,6 +1837,17 @@
                  * retransmissions. */
                 ( pxSegment->u.bits.ucTransmitCount )++;
 
+                #if ( ipconfigUSE_TCP_STATISTICS == 1 )
+                    {
+                        /* A fast retransmission resets the count to zero, so
+                         * only the time-outs are counted here. */
+                        if( pxSegment->u.bits.ucTransmitCount > 1U )
+                        {
+                            pxWindow->ulRetransmitCount++;
+                        }
+                    }
+                #endif
+
                 /* If there have been several retransmissions (4), decrease the
                  * size of the transmission window to at most 2 times MSS. */
                 if( pxSegment->u.bits.ucTransmitCount == MAX_TRANSMIT_COUNT_USING_LARGE_WINDOW )
@@ -2002,6 +2096,12 @@
                         {
                             pxSegment->u.bits.ucTransmitCount = ( uint8_t ) pdFALSE;
 
+                            #if ( ipconfigUSE_TCP_STATISTICS == 1 )
+                                {
+                                    pxWindow->ulFastRetransmitCount++;
+                                }
+                            #endif
+
                             /* Not clearing 'ucDupAckCount' yet as more SACK's might come in
                              * which might lead to a second fast rexmit. */
                             if( ( xTCPWindowLoggingLevel >= 0 ) && ( ipconfigTCP_MAY_LOG_PORT( pxWindow->usOurPortNumber ) ) )
@@ -2087,6 +2187,17 @@
             ulAckCount = prvTCPWindowTxCheckAck( pxWindow, ulFirst, ulLast );
             ( void ) prvTCPWindowFastRetransmit( pxWindow, ulFirst );
 
+            #if ( ipconfigUSE_TCP_STATISTICS == 1 )
+                {
+                    /* Later data was confirmed while older data is still
+                     * outstanding: this is what a duplicate ACK reports. */
+                    if( xSequenceGreaterThan( ulFirst, ulCurrentSequenceNumber ) != pdFALSE )
+                    {
+                        pxWindow->ulDupAckCount++;
+                    }
+                }
+            #endif /* ipconfigUSE_TCP_STATISTICS */
+
             if( ( xTCPWindowLoggingLevel >= 1 ) && ( xSequenceGreaterThan( ulFirst, ulCurrentSequenceNumber ) != pdFALSE ) )
             {
                 FreeRTOS_debug_printf( ( "ulTCPWindowTxSack[%u,%u]: from %lu to %lu (ack = %lu)\n",
@@ -2271,6 +2382,16 @@
                 {
                     pxSegment->u.bits.bOutstanding = pdTRUE_UNSIGNED;
                     pxSegment->u.bits.ucTransmitCount++;
+
+                    #if ( ipconfigUSE_TCP_STATISTICS == 1 )
+                        {
+                            if( pxSegment->u.bits.ucTransmitCount > 1U )
+                            {
+                                pxWindow->ulRetransmitCount++;
+                            }
+                        }
+                    #endif
+
                     vTCPTimerSet( &pxSegment->xTransmitTimer );
                     pxWindow->ulOurSequenceNumber = pxSegment->ulSequenceNumber;
                     *plPosition = pxSegment->lStreamPos;
@@ -2314,6 +2435,37 @@
     #endif /* ipconfigUSE_TCP_WIN == 0 */
 /*-----------------------------------------------------------*/
 
+    #if ( ipconfigUSE_TCP_WIN == 0 )
+
+/**
+ * @brief The data in the TX stream has been moved to a new stream, in which the
+ *        oldest byte is stored at position 0.  Translate the stream position of
+ *        the outstanding segment.
+ *
+ * @param[in] pxWindow: The descriptor of the TCP sliding windows.
+ * @param[in] lTail: The position of the oldest byte in the old stream.
+ * @param[in] lMax: The size of the old stream.
+ */
+        void vTCPWindowTxRebase( TCPWindow_t * pxWindow,
+                                 int32_t lTail,
+                                 int32_t lMax )
+        {
+            TCPSegment_t * pxSegment = &( pxWindow->xTxSegment );
+
+            if( pxSegment->lDataLength > 0 )
+            {
+                pxSegment->lStreamPos -= lTail;
+
+                if( pxSegment->lStreamPos < 0 )
+                {
+                    pxSegment->lStreamPos += lMax;
+                }
+            }
+        }
+
+    #endif /* ipconfigUSE_TCP_WIN == 0 */
+/*-----------------------------------------------------------*/
+
     #if ( ipconfigUSE_TCP_WIN == 0 )
 
         static BaseType_t prvTCPWindowTxHasSpace( TCPWindow_t const * pxWindow,
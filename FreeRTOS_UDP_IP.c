@@ -287,6 +287,175 @@ void vProcessGeneratedUDPPacket( NetworkBufferDescriptor_t * const pxNetworkBuff
 }
 /*-----------------------------------------------------------*/
 
+#if ( ipconfigUSE_UDP_CONNECT == 1 )
+
+/**
+ * @brief Build the header template of a connected UDP socket.  The MAC address
+ *        of the peer, or of the gateway, is looked up in the ARP cache.  The
+ *        template is only valid when the lookup was successful.
+ *
+ * @param[in] pxSocket: The connected UDP socket.
+ */
+    static void prvUDPBuildTemplate( FreeRTOS_Socket_t * pxSocket )
+    {
+        IPUDPSocket_t * pxUDP = &( pxSocket->u.xUDP );
+        UDPPacket_t * pxTemplate = &( pxUDP->xHeaderTemplate );
+        uint32_t ulIPAddress = pxUDP->ulRemoteIP;
+        uint32_t ulGeneration;
+        eARPLookupResult_t eResult;
+        uint16_t usChecksum;
+        /* memcpy() helper variables for MISRA Rule 21.15 compliance*/
+        const void * pvCopySource;
+        void * pvCopyDest;
+
+        /* The ARP cache belongs to the IP-task, make sure that it does not
+         * change while it is being read. */
+        vTaskSuspendAll();
+        {
+            ulGeneration = ulARPGetGeneration();
+            eResult = eARPGetCacheEntry( &( ulIPAddress ), &( pxTemplate->xEthernetHeader.xDestinationAddress ) );
+        }
+        ( void ) xTaskResumeAll();
+
+        pxUDP->xTemplateValid = pdFALSE;
+
+        if( eResult == eARPCacheHit )
+        {
+            /* Copy the constant parts, starting at the Ethernet source address,
+             * just like vProcessGeneratedUDPPacket() does. */
+            pvCopySource = xDefaultPartUDPPacketHeader.ucBytes;
+            pvCopyDest = &( pxTemplate->xEthernetHeader.xSourceAddress );
+            ( void ) memcpy( pvCopyDest, pvCopySource, sizeof( xDefaultPartUDPPacketHeader ) );
+
+            pxTemplate->xIPHeader.usLength = 0U;
+            pxTemplate->xIPHeader.usIdentification = 0U;
+            pxTemplate->xIPHeader.usHeaderChecksum = 0U;
+            pxTemplate->xIPHeader.ulDestinationIPAddress = pxUDP->ulRemoteIP;
+
+            #if ( ipconfigFORCE_IP_DONT_FRAGMENT != 0 )
+                pxTemplate->xIPHeader.usFragmentOffset = ipFRAGMENT_FLAGS_DONT_FRAGMENT;
+            #else
+                pxTemplate->xIPHeader.usFragmentOffset = 0U;
+            #endif
+
+            #if ( ipconfigUSE_LLMNR == 1 )
+                {
+                    if( pxUDP->ulRemoteIP == ipLLMNR_IP_ADDR )
+                    {
+                        pxTemplate->xIPHeader.ucTimeToLive = 0x01;
+                    }
+                }
+            #endif
+
+            pxTemplate->xUDPHeader.usSourcePort = FreeRTOS_htons( pxSocket->usLocalPort );
+            pxTemplate->xUDPHeader.usDestinationPort = pxUDP->usRemotePort;
+            pxTemplate->xUDPHeader.usLength = 0U;
+            pxTemplate->xUDPHeader.usChecksum = 0U;
+
+            /* The sum of the IP header without the length and identification. */
+            pxUDP->usIPChecksumPartial = usGenerateChecksum( 0U, ( const uint8_t * ) &( pxTemplate->xIPHeader.ucVersionHeaderLength ), ipSIZE_OF_IPv4_HEADER );
+
+            /* The sum of the protocol and the addresses in the pseudo header,
+             * and of the two port numbers. */
+            usChecksum = usGenerateChecksum( ( uint16_t ) ipPROTOCOL_UDP, ( const uint8_t * ) &( pxTemplate->xIPHeader.ulSourceIPAddress ), 2U * ipSIZE_OF_IPv4_ADDRESS );
+            pxUDP->usUDPChecksumPartial = usGenerateChecksum( usChecksum, ( const uint8_t * ) &( pxTemplate->xUDPHeader.usSourcePort ), 2U * sizeof( uint16_t ) );
+
+            pxUDP->ulARPGeneration = ulGeneration;
+            pxUDP->xTemplateValid = pdTRUE;
+        }
+    }
+    /*-----------------------------------------------------------*/
+
+/**
+ * @brief Complete an outgoing packet of a connected UDP socket by copying the
+ *        header template and patching the length, identification and checksum
+ *        fields.  This is normally called from FreeRTOS_sendto(), by the task
+ *        that sends the packet.
+ *
+ * @param[in] pxSocket: The connected UDP socket.
+ * @param[in] pxNetworkBuffer: The packet, its payload has been filled in.
+ * @param[in] uxPayloadLength: The number of bytes in the UDP payload.
+ *
+ * @return pdTRUE when the packet is complete and may be passed to the network
+ *         interface, pdFALSE when it must be handled by vProcessGeneratedUDPPacket().
+ */
+    BaseType_t xUDPConnectedFillPacket( FreeRTOS_Socket_t * pxSocket,
+                                        NetworkBufferDescriptor_t * pxNetworkBuffer,
+                                        size_t uxPayloadLength )
+    {
+        IPUDPSocket_t * pxUDP = &( pxSocket->u.xUDP );
+        UDPPacket_t * pxUDPPacket;
+        BaseType_t xReturn = pdFALSE;
+        uint16_t usLength;
+
+        #if ( ipconfigDRIVER_INCLUDED_TX_IP_CHECKSUM == 0 )
+            uint16_t usChecksum;
+        #endif
+
+        if( ( pxUDP->xTemplateValid == pdFALSE ) || ( pxUDP->ulARPGeneration != ulARPGetGeneration() ) )
+        {
+            prvUDPBuildTemplate( pxSocket );
+        }
+
+        if( pxUDP->xTemplateValid != pdFALSE )
+        {
+            pxUDPPacket = ipCAST_PTR_TO_TYPE_PTR( UDPPacket_t, pxNetworkBuffer->pucEthernetBuffer );
+            ( void ) memcpy( ( void * ) pxUDPPacket, ( const void * ) &( pxUDP->xHeaderTemplate ), sizeof( *pxUDPPacket ) );
+
+            usLength = ( uint16_t ) ( uxPayloadLength + sizeof( UDPHeader_t ) );
+            pxUDPPacket->xUDPHeader.usLength = FreeRTOS_htons( usLength );
+            pxUDPPacket->xIPHeader.usLength = FreeRTOS_htons( ( uint16_t ) ( usLength + ipSIZE_OF_IPv4_HEADER ) );
+
+            pxUDPPacket->xIPHeader.usIdentification = FreeRTOS_htons( usGetNextPacketIdentifier() );
+
+            #if ( ipconfigDRIVER_INCLUDED_TX_IP_CHECKSUM == 0 )
+                {
+                    /* The length and identification fields are adjacent, add
+                     * them to the sum of the rest of the header. */
+                    usChecksum = usGenerateChecksum( pxUDP->usIPChecksumPartial, ( const uint8_t * ) &( pxUDPPacket->xIPHeader.usLength ), 2U * sizeof( uint16_t ) );
+                    pxUDPPacket->xIPHeader.usHeaderChecksum = ~FreeRTOS_htons( usChecksum );
+
+                    if( ( pxSocket->ucSocketOptions & ( uint8_t ) FREERTOS_SO_UDPCKSUM_OUT ) != 0U )
+                    {
+                        /* Add the length of the pseudo header, followed by the
+                         * UDP length, the (zero) checksum and the payload. */
+                        usChecksum = usGenerateChecksum( pxUDP->usUDPChecksumPartial, ( const uint8_t * ) &( pxUDPPacket->xUDPHeader.usLength ), sizeof( uint16_t ) );
+                        usChecksum = usGenerateChecksum( usChecksum, ( const uint8_t * ) &( pxUDPPacket->xUDPHeader.usLength ), ( 2U * sizeof( uint16_t ) ) + uxPayloadLength );
+                        usChecksum = ( uint16_t ) ~usChecksum;
+
+                        if( usChecksum == 0U )
+                        {
+                            /* A calculated checksum of 0x0000 is transmitted as 0xffff. */
+                            usChecksum = ( uint16_t ) 0xffffU;
+                        }
+
+                        pxUDPPacket->xUDPHeader.usChecksum = FreeRTOS_htons( usChecksum );
+                    }
+                }
+            #endif /* ipconfigDRIVER_INCLUDED_TX_IP_CHECKSUM == 0 */
+
+            #if defined( ipconfigETHERNET_MINIMUM_PACKET_BYTES )
+                {
+                    if( pxNetworkBuffer->xDataLength < ( size_t ) ipconfigETHERNET_MINIMUM_PACKET_BYTES )
+                    {
+                        ( void ) memset( &( pxNetworkBuffer->pucEthernetBuffer[ pxNetworkBuffer->xDataLength ] ),
+                                         0,
+                                         ( size_t ) ipconfigETHERNET_MINIMUM_PACKET_BYTES - pxNetworkBuffer->xDataLength );
+                        pxNetworkBuffer->xDataLength = ( size_t ) ipconfigETHERNET_MINIMUM_PACKET_BYTES;
+                    }
+                }
+            #endif /* if defined( ipconfigETHERNET_MINIMUM_PACKET_BYTES ) */
+
+            iptraceSENDING_UDP_PACKET( pxNetworkBuffer->ulIPAddress );
+            xReturn = pdTRUE;
+        }
+
+        return xReturn;
+    }
+
+#endif /* ipconfigUSE_UDP_CONNECT */
+/*-----------------------------------------------------------*/
+
 /**
  * @brief Process the received UDP packet.
  *
@@ -317,6 +486,20 @@ BaseType_t xProcessReceivedUDPPacket( NetworkBufferDescriptor_t * pxNetworkBuffe
 
     do
     {
+        #if ( ipconfigUSE_UDP_CONNECT == 1 )
+            {
+                /* A connected socket only accepts datagrams from its peer. */
+                if( ( pxSocket != NULL ) &&
+                    ( pxSocket->u.xUDP.ulRemoteIP != 0UL ) &&
+                    ( ( pxNetworkBuffer->ulIPAddress != pxSocket->u.xUDP.ulRemoteIP ) ||
+                      ( pxNetworkBuffer->usPort != pxSocket->u.xUDP.usRemotePort ) ) )
+                {
+                    xReturn = pdFAIL;
+                    break;
+                }
+            }
+        #endif /* ipconfigUSE_UDP_CONNECT */
+
         if( pxSocket != NULL )
         {
             if( xCheckRequiresARPResolution( pxNetworkBuffer ) == pdTRUE )
@@ -338,6 +521,18 @@ BaseType_t xProcessReceivedUDPPacket( NetworkBufferDescriptor_t * pxNetworkBuffe
                 vARPRefreshCacheEntry( &( pxUDPPacket->xEthernetHeader.xSourceAddress ), pxUDPPacket->xIPHeader.ulSourceIPAddress );
             }
 
+            #if ( ipconfigUSE_DNS == 1 ) && ( ipconfigDNS_USE_RESOLVER == 1 )
+                {
+                    if( xIsDNSResolverSocket( pxSocket ) != pdFALSE )
+                    {
+                        /* The replies to the shared DNS socket are not queued,
+                         * they are parsed here and passed to the call-backs. */
+                        xReturn = ( BaseType_t ) ulDNSHandlePacket( pxNetworkBuffer );
+                        break;
+                    }
+                }
+            #endif
+
             #if ( ipconfigUSE_CALLBACKS == 1 )
                 {
                     /* Did the owner of this socket register a reception handler ? */
@@ -379,7 +574,21 @@ BaseType_t xProcessReceivedUDPPacket( NetworkBufferDescriptor_t * pxNetworkBuffe
                 }
             #endif /* if ( ipconfigUDP_MAX_RX_PACKETS > 0U ) */
 
-            #if ( ipconfigUSE_CALLBACKS == 1 ) || ( ipconfigUDP_MAX_RX_PACKETS > 0U )
+            #if ( ipconfigUSE_BUFFER_PRESSURE == 1 )
+                {
+                    /* Network buffers are scarce: a socket that has not read its
+                     * previous packet yet does not get another one. */
+                    if( ( xReturn == pdPASS ) &&
+                        ( listCURRENT_LIST_LENGTH( &( pxSocket->u.xUDP.xWaitingPacketsList ) ) != 0U ) &&
+                        ( eGetNetworkBufferPressure() != eBufferPressureNone ) )
+                    {
+                        iptraceUDP_DROPPED_UNDER_PRESSURE( pxSocket );
+                        xReturn = pdFAIL; /* we did not consume or release the buffer */
+                    }
+                }
+            #endif /* if ( ipconfigUSE_BUFFER_PRESSURE == 1 ) */
+
+            #if ( ipconfigUSE_CALLBACKS == 1 ) || ( ipconfigUDP_MAX_RX_PACKETS > 0U ) || ( ipconfigUSE_BUFFER_PRESSURE == 1 )
                 if( xReturn == pdPASS ) /*lint !e774: Boolean within 'if' always evaluates to True, depending on configuration. [MISRA 2012 Rule 14.3, required. */
             #else
                 /* xReturn is still pdPASS. */
@@ -398,10 +607,7 @@ BaseType_t xProcessReceivedUDPPacket( NetworkBufferDescriptor_t * pxNetworkBuffe
                 ( void ) xTaskResumeAll();
 
                 /* Set the socket's receive event */
-                if( pxSocket->xEventGroup != NULL )
-                {
-                    ( void ) xEventGroupSetBits( pxSocket->xEventGroup, ( EventBits_t ) eSOCKET_RECEIVE );
-                }
+                vSocketSetEventBits( pxSocket, ( EventBits_t ) eSOCKET_RECEIVE );
 
                 #if ( ipconfigSUPPORT_SELECT_FUNCTION == 1 )
                     {
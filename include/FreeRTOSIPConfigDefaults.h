@@ -657,4 +657,511 @@
     #define ipconfigPROCESS_CUSTOM_ETHERNET_FRAMES    0
 #endif
 
+/* When set to 1, the socket options FREERTOS_SO_RCVLOWAT and
+ * FREERTOS_SO_SNDLOWAT become available for TCP sockets.  The owner of a
+ * socket will only be woken up for eSOCKET_RECEIVE when at least 'RCVLOWAT'
+ * bytes can be read, and for eSOCKET_SEND when at least 'SNDLOWAT' bytes of
+ * space are available in the TX stream.  This reduces the number of wake-ups
+ * of tasks that stream large amounts of data. */
+#ifndef ipconfigTCP_WAKEUP_LOW_WATER
+    #define ipconfigTCP_WAKEUP_LOW_WATER    0
+#endif
+
+/* A receive or send event that was held back because a low-water mark was
+ * not reached, will be delivered anyway after this number of milliseconds.
+ * It makes sure that the last few bytes of a transfer are not delayed for
+ * ever. */
+#ifndef ipconfigTCP_WAKEUP_LOW_WATER_MS
+    #define ipconfigTCP_WAKEUP_LOW_WATER_MS    20U
+#endif
+
+/* When set to 1, sockets do not own an event group.  Instead, a task that
+ * blocks in a socket API records itself in the socket, and the IP-task wakes
+ * it up with a task notification.  This saves the RAM of an event group per
+ * socket and makes waking up the owner of a socket cheaper.  The notification
+ * index 'ipconfigSOCKET_NOTIFY_INDEX' is used, so the kernel must be
+ * configured with a configTASK_NOTIFICATION_ARRAY_ENTRIES of at least 2. */
+#ifndef ipconfigSOCKET_USES_NOTIFY
+    #define ipconfigSOCKET_USES_NOTIFY    0
+#endif
+
+/* The task notification index used by sockets when ipconfigSOCKET_USES_NOTIFY
+ * is defined.  By default the last available index is used.  Index 0 can not
+ * be used: it belongs to the application and the kernel's stream buffers. */
+#ifndef ipconfigSOCKET_NOTIFY_INDEX
+    #if defined( configTASK_NOTIFICATION_ARRAY_ENTRIES )
+        #define ipconfigSOCKET_NOTIFY_INDEX    ( configTASK_NOTIFICATION_ARRAY_ENTRIES - 1 )
+    #else
+        #define ipconfigSOCKET_NOTIFY_INDEX    0
+    #endif
+#endif
+
+#if ( ipconfigSOCKET_USES_NOTIFY != 0 )
+    #if !defined( configTASK_NOTIFICATION_ARRAY_ENTRIES ) || ( configTASK_NOTIFICATION_ARRAY_ENTRIES < 2 )
+        #error ipconfigSOCKET_USES_NOTIFY requires configTASK_NOTIFICATION_ARRAY_ENTRIES of at least 2
+    #elif ( ipconfigSOCKET_NOTIFY_INDEX < 1 ) || ( ipconfigSOCKET_NOTIFY_INDEX >= configTASK_NOTIFICATION_ARRAY_ENTRIES )
+        #error ipconfigSOCKET_NOTIFY_INDEX must be between 1 and configTASK_NOTIFICATION_ARRAY_ENTRIES - 1
+    #endif
+#endif
+
+/* When set to 1, sockets, their event groups and the TCP stream buffers are
+ * not allocated from the heap, but taken from statically allocated pools in
+ * FreeRTOS_Sockets.c.  Closing a socket returns the objects to their pool, so
+ * that sockets can be created and closed in O(1), without fragmenting the
+ * heap.  When a pool is exhausted, FreeRTOS_socket() returns
+ * FREERTOS_INVALID_SOCKET, or the TCP connection is closed with bMallocError
+ * set, exactly as when the heap is exhausted. */
+#ifndef ipconfigUSE_SOCKET_POOL
+    #define ipconfigUSE_SOCKET_POOL    0
+#endif
+
+/* The number of sockets (UDP and TCP together) in the socket pool, including
+ * the child sockets that are created by a listening socket. */
+#ifndef ipconfigSOCKET_POOL_SIZE
+    #define ipconfigSOCKET_POOL_SIZE    8
+#endif
+
+/* The number of stream buffers in the pool.  A TCP socket uses up to two
+ * stream buffers: one for reception and one for transmission. */
+#ifndef ipconfigSOCKET_POOL_STREAM_COUNT
+    #define ipconfigSOCKET_POOL_STREAM_COUNT    ( 2 * ipconfigSOCKET_POOL_SIZE )
+#endif
+
+/* The maximum size in bytes of a stream buffer taken from the pool.
+ * FREERTOS_SO_RCVBUF and FREERTOS_SO_SNDBUF can not be set to a larger value.
+ * By default it is the largest of the default stream sizes, where the size of
+ * the transmission stream is rounded up to a multiple of the MSS. */
+#ifndef ipconfigSOCKET_POOL_STREAM_SIZE
+    #define ipconfigSOCKET_POOL_STREAM_SIZE                                                                                          \
+    ( ( ipconfigTCP_RX_BUFFER_LENGTH > ( ( ( ipconfigTCP_TX_BUFFER_LENGTH + ipconfigTCP_MSS ) - 1U ) / ipconfigTCP_MSS ) * ipconfigTCP_MSS ) ? \
+      ipconfigTCP_RX_BUFFER_LENGTH : ( ( ( ( ipconfigTCP_TX_BUFFER_LENGTH + ipconfigTCP_MSS ) - 1U ) / ipconfigTCP_MSS ) * ipconfigTCP_MSS ) )
+#endif
+
+/* When set to 1, every TCP socket keeps a few counters, such as the number of
+ * retransmissions, the number of bytes sent and received and the time spent
+ * while the peer advertised a zero window.  Together with the properties of
+ * the TCP window, they can be read with FreeRTOS_getsockopt() and the option
+ * FREERTOS_SO_TCP_INFO, which fills in a TCPInfo_t. */
+#ifndef ipconfigUSE_TCP_STATISTICS
+    #define ipconfigUSE_TCP_STATISTICS    0
+#endif
+
+/* When set to 1, FreeRTOS_connect() can also be used on a UDP socket.  The
+ * socket will then only receive datagrams from its peer, and FreeRTOS_sendto()
+ * may be called with a NULL address.  A connected socket caches the MAC
+ * address of its peer and keeps a prebuilt Ethernet/IP/UDP header, so that
+ * most packets can be completed by the sending task, without an ARP lookup
+ * in the IP-task.  The cache is refreshed when the ARP generation changes.
+ * FreeRTOS_connect() is only available when ipconfigUSE_TCP is set. */
+#ifndef ipconfigUSE_UDP_CONNECT
+    #define ipconfigUSE_UDP_CONNECT    0
+#endif
+
+/* The following settings are only used by BufferAllocation_2.c, which hands
+ * out network buffers from a few classes of a fixed size.  A request is served
+ * by the smallest class that is large enough, so an ACK or an ARP packet does
+ * not occupy a full-size buffer.  The class of the largest buffers holds a
+ * complete Ethernet frame (ipTOTAL_ETHERNET_FRAME_SIZE).  Its number of
+ * buffers is what remains of ipconfigNUM_NETWORK_BUFFER_DESCRIPTORS after the
+ * small and the jumbo buffers have been subtracted. */
+
+/* The size in bytes of the small network buffers, not counting
+ * ipBUFFER_PADDING.  Must be at least 64. */
+#ifndef ipconfigBUFFER_CLASS_SMALL_SIZE
+    #define ipconfigBUFFER_CLASS_SMALL_SIZE    128U
+#endif
+
+/* The number of small network buffers, taken from
+ * ipconfigNUM_NETWORK_BUFFER_DESCRIPTORS.  Every small buffer replaces a
+ * full-size one: it saves about ipTOTAL_ETHERNET_FRAME_SIZE minus
+ * ipconfigBUFFER_CLASS_SMALL_SIZE bytes of RAM, but one full frame less can be
+ * received or queued at a time.  The default of 0 keeps the full-size buffers
+ * of existing configurations. */
+#ifndef ipconfigBUFFER_CLASS_SMALL_COUNT
+    #define ipconfigBUFFER_CLASS_SMALL_COUNT    0
+#endif
+
+/* When ipconfigNETWORK_MTU is larger than 1500, the MTU class holds standard
+ * Ethernet frames, and the jumbo class holds frames of the full MTU.  The
+ * number of jumbo buffers must then be at least 1. */
+#ifndef ipconfigBUFFER_CLASS_JUMBO_COUNT
+    #define ipconfigBUFFER_CLASS_JUMBO_COUNT    0
+#endif
+
+/* When set to 1, BufferAllocation_1.c keeps the free network buffers on a
+ * lock-free stack, which is updated with the compare-and-swap operations of
+ * the kernel's atomic.h.  Obtaining and releasing a buffer then no longer
+ * takes a semaphore or enters a critical section.  A few tasks, such as the
+ * IP-task and the RX task of the network driver, may also register a private
+ * cache of buffers with xNetworkBufferCacheRegister().  Not supported by
+ * BufferAllocation_2.c. */
+#ifndef ipconfigBUFFER_ALLOC_LOCK_FREE
+    #define ipconfigBUFFER_ALLOC_LOCK_FREE    0
+#endif
+
+/* The maximum number of tasks that can register a cache of network buffers.
+ * The IP-task registers one itself. */
+#ifndef ipconfigBUFFER_CACHE_TASKS
+    #define ipconfigBUFFER_CACHE_TASKS    2
+#endif
+
+/* The number of network buffers that each cache can hold.  A cache that runs
+ * empty is refilled with half of this number, a full cache returns half of
+ * its buffers to the shared free list.  Buffers in a cache can not be used by
+ * other tasks. */
+#ifndef ipconfigBUFFER_CACHE_SIZE
+    #define ipconfigBUFFER_CACHE_SIZE    4
+#endif
+
+/* When set to 1, pxCloneNetworkBufferWithDescriptor() can be used to give a
+ * network buffer a second owner without copying the Ethernet frame.  A clone
+ * is a separate descriptor with its own length and addresses, but it shares
+ * the frame with the original.  The frame returns to the pool when the last
+ * of them is released.  The clone descriptors come from a small static pool
+ * in FreeRTOS_IP.c. */
+#ifndef ipconfigUSE_NETWORK_BUFFER_CLONES
+    #define ipconfigUSE_NETWORK_BUFFER_CLONES    0
+#endif
+
+/* The number of clone descriptors that can exist at the same time. */
+#ifndef ipconfigNUM_NETWORK_BUFFER_CLONES
+    #define ipconfigNUM_NETWORK_BUFFER_CLONES    8
+#endif
+
+/* The number of bytes reserved in front of each network buffer, in which
+ * drivers and encapsulation layers can prepend headers (VLAN tags, tunnel
+ * headers) with pucNetworkBufferPush(), without copying the frame.  The
+ * value is rounded up to a multiple of 8 and added to ipBUFFER_PADDING.
+ * When 0, the push/pull/put/reserve API is not available. */
+#ifndef ipconfigBUFFER_HEADROOM
+    #define ipconfigBUFFER_HEADROOM    0
+#endif
+
+/* When set to 1, the stack watches the number of free network buffers and
+ * reports the pressure on the pool: eBufferPressureNone, eBufferPressureHigh
+ * or eBufferPressureCritical, see eGetNetworkBufferPressure().  Under
+ * pressure, TCP advertises a smaller window and sends fewer segments in a row,
+ * and UDP sockets that have a packet waiting do not get another one.  The
+ * buffers held in the per-task caches of ipconfigBUFFER_ALLOC_LOCK_FREE are
+ * counted as free. */
+#ifndef ipconfigUSE_BUFFER_PRESSURE
+    #define ipconfigUSE_BUFFER_PRESSURE    0
+#endif
+
+/* The pressure becomes high when the number of free network buffers drops to
+ * ipconfigBUFFER_LOW_WATERMARK, and critical when it drops to
+ * ipconfigBUFFER_CRITICAL_WATERMARK.  It is over once the number of free
+ * buffers has risen to ipconfigBUFFER_HIGH_WATERMARK again. */
+#ifndef ipconfigBUFFER_LOW_WATERMARK
+    #define ipconfigBUFFER_LOW_WATERMARK    ( ipconfigNUM_NETWORK_BUFFER_DESCRIPTORS / 4 )
+#endif
+
+#ifndef ipconfigBUFFER_CRITICAL_WATERMARK
+    #define ipconfigBUFFER_CRITICAL_WATERMARK    ( ipconfigNUM_NETWORK_BUFFER_DESCRIPTORS / 8 )
+#endif
+
+#ifndef ipconfigBUFFER_HIGH_WATERMARK
+    #define ipconfigBUFFER_HIGH_WATERMARK    ( ipconfigNUM_NETWORK_BUFFER_DESCRIPTORS / 2 )
+#endif
+
+/* Under pressure, the TCP window advertised to peers is limited to this
+ * number of segments (MSS). */
+#ifndef ipconfigBUFFER_PRESSURE_TCP_WINDOW
+    #define ipconfigBUFFER_PRESSURE_TCP_WINDOW    2
+#endif
+
+/* When set to 1, the network interface is told about every change of the
+ * buffer pressure through vNetworkInterfaceBufferPressure(), so it can drop
+ * frames early or pause reception.  The driver must implement that function.
+ * Requires ipconfigUSE_BUFFER_PRESSURE. */
+#ifndef ipconfigBUFFER_PRESSURE_DRIVER_HOOK
+    #define ipconfigBUFFER_PRESSURE_DRIVER_HOOK    0
+#endif
+
+/* When set to 1, a TCP stream whose size is a power of two wraps its indices
+ * with a mask and uses free-running counters, so it can store all of its
+ * bytes.  prvTCPCreateStream() chooses such a stream when the requested size
+ * allows it. */
+#ifndef ipconfigUSE_POW2_STREAM_BUFFERS
+    #define ipconfigUSE_POW2_STREAM_BUFFERS    0
+#endif
+
+/* The percentage by which a TCP stream may grow in order to get a size which
+ * is a power of two.  With zero, only sizes that are already a power of two
+ * are used. */
+#ifndef ipconfigPOW2_STREAM_MAX_GROWTH
+    #define ipconfigPOW2_STREAM_MAX_GROWTH    0
+#endif
+
+/* When set to 1, a TCP socket keeps the network buffers in which data was
+ * received, instead of copying the data into its RX stream.  FreeRTOS_recv()
+ * copies the data straight from the frames to the user. */
+#ifndef ipconfigUSE_TCP_RX_CHAIN
+    #define ipconfigUSE_TCP_RX_CHAIN    0
+#endif
+
+/* The maximum number of network buffers that a single TCP socket may keep in
+ * its RX chain.  When all are in use, new data is refused until the user has
+ * read some, or until small buffers could be merged. */
+#ifndef ipconfigTCP_RX_CHAIN_LENGTH
+    #define ipconfigTCP_RX_CHAIN_LENGTH    8
+#endif
+
+/* The RX chain is compacted when the buffers it keeps are filled, on average,
+ * for less than this percentage of the MSS.  Adjacent small buffers are then
+ * copied into a single buffer. */
+#ifndef ipconfigTCP_RX_CHAIN_MIN_FILL
+    #define ipconfigTCP_RX_CHAIN_MIN_FILL    50
+#endif
+
+/* The maximum number of network buffers that the RX chains of all TCP sockets
+ * together may keep.  Beyond it, or when ipconfigUSE_BUFFER_PRESSURE reports
+ * pressure, a socket that keeps a buffer already refuses new data until its
+ * user has read some, so that slow readers leave buffers for the driver. */
+#ifndef ipconfigTCP_RX_CHAIN_MAX_BUFFERS
+    #define ipconfigTCP_RX_CHAIN_MAX_BUFFERS    ( ipconfigNUM_NETWORK_BUFFER_DESCRIPTORS / 2 )
+#endif
+
+/* When set to 1, the RX and TX streams of a TCP socket are created with at
+ * most ipconfigTCP_STREAM_INITIAL_SIZE bytes.  They grow, up to the sizes set
+ * with FREERTOS_SO_RCVBUF and FREERTOS_SO_SNDBUF, when the data does not fit.
+ * Streams that are empty and idle are released. */
+#ifndef ipconfigUSE_TCP_ELASTIC_STREAMS
+    #define ipconfigUSE_TCP_ELASTIC_STREAMS    0
+#endif
+
+/* The initial capacity of an elastic stream, in bytes. */
+#ifndef ipconfigTCP_STREAM_INITIAL_SIZE
+    #define ipconfigTCP_STREAM_INITIAL_SIZE    ( 2U * ipconfigTCP_MSS )
+#endif
+
+/* An elastic stream that has been empty and untouched for this number of
+ * milliseconds is released.  It will be created again when needed.  Use 0 to
+ * keep the streams until the socket is closed. */
+#ifndef ipconfigTCP_STREAM_IDLE_MS
+    #define ipconfigTCP_STREAM_IDLE_MS    10000U
+#endif
+
+/* When set to 1, the stack does not call pvPortMalloc() for its sockets,
+ * socket sets, TCP streams, TCP segments and DNS call-backs: all are taken from
+ * static pools of a fixed size, in constant time.  The sizes of the pools are
+ * set with ipconfigSOCKET_POOL_SIZE, ipconfigSOCKET_POOL_STREAM_COUNT,
+ * ipconfigSOCKET_SET_POOL_SIZE, ipconfigTCP_WIN_SEG_COUNT and
+ * ipconfigDNS_CALLBACK_POOL_SIZE.  FreeRTOS_PrintPoolUsage() reports how well
+ * the pools are used.  Requires ipconfigUSE_SOCKET_POOL and
+ * configSUPPORT_STATIC_ALLOCATION. */
+#ifndef ipconfigUSE_STATIC_POOLS
+    #define ipconfigUSE_STATIC_POOLS    0
+#endif
+
+#if ( ipconfigUSE_STATIC_POOLS == 1 )
+    #if ( ipconfigUSE_SOCKET_POOL != 1 )
+        #error ipconfigUSE_STATIC_POOLS requires ipconfigUSE_SOCKET_POOL
+    #endif
+
+    #if !defined( configSUPPORT_STATIC_ALLOCATION ) || ( configSUPPORT_STATIC_ALLOCATION != 1 )
+        #error ipconfigUSE_STATIC_POOLS requires configSUPPORT_STATIC_ALLOCATION
+    #endif
+#endif /* ipconfigUSE_STATIC_POOLS */
+
+/* The number of socket sets that can exist at the same time when
+ * ipconfigUSE_STATIC_POOLS is 1. */
+#ifndef ipconfigSOCKET_SET_POOL_SIZE
+    #define ipconfigSOCKET_SET_POOL_SIZE    2
+#endif
+
+/* The number of asynchronous DNS look-ups that can be pending at the same time
+ * when ipconfigUSE_STATIC_POOLS is 1. */
+#ifndef ipconfigDNS_CALLBACK_POOL_SIZE
+    #define ipconfigDNS_CALLBACK_POOL_SIZE    4
+#endif
+
+/* The longest host name, including the terminating zero, that can be stored
+ * in a pooled DNS call-back.  Longer names are refused.  The default allows
+ * the longest name permitted by RFC 1035. */
+#ifndef ipconfigDNS_CALLBACK_NAME_LENGTH
+    #define ipconfigDNS_CALLBACK_NAME_LENGTH    254U
+#endif
+
+/* When set to 1, the ARP cache is indexed by a hash table keyed on the IP
+ * address, so that a look-up or a refresh does not have to scan all
+ * ipconfigARP_CACHE_ENTRIES rows.  When the cache is full, the row that was
+ * least recently used is replaced. */
+#ifndef ipconfigUSE_ARP_HASH
+    #define ipconfigUSE_ARP_HASH    0
+#endif
+
+/* The number of slots in each ARP hash index.  It must be larger than
+ * ipconfigARP_CACHE_ENTRIES; twice the number of entries keeps the probe
+ * sequences short.  Every slot takes 2 bytes. */
+#ifndef ipconfigARP_HASH_SIZE
+    #define ipconfigARP_HASH_SIZE    ( 2 * ipconfigARP_CACHE_ENTRIES )
+#endif
+
+/* When set to 1, together with ipconfigUSE_ARP_HASH, a second hash index
+ * keyed on the MAC address is kept.  It speeds up eARPGetCacheEntryByMac(),
+ * ulARPRemoveCacheEntryByMac(), and the refresh of an entry whose IP address
+ * or MAC address has changed. */
+#ifndef ipconfigARP_HASH_MAC_INDEX
+    #define ipconfigARP_HASH_MAC_INDEX    0
+#endif
+
+/* When set to 1, vARPAgeCache() no longer visits every entry of the ARP cache
+ * on every ARP timer event.  The entries are kept in a heap ordered by the
+ * time at which they need attention, and the ARP timer is set to wake up the
+ * IP-task when the first one is due.  The refresh probes are spread over the
+ * ARP timer period, depending on the IP address of the entry. */
+#ifndef ipconfigUSE_ARP_DEADLINE_AGING
+    #define ipconfigUSE_ARP_DEADLINE_AGING    0
+#endif
+
+/* When set to 1, the ARP requests for an address that is not resolved yet
+ * are sent by vARPResolveAddress(), which keeps one outstanding request per
+ * address.  A retry is sent only after ipconfigARP_REQUEST_INTERVAL_MS, and
+ * that interval doubles with every retry.  After ipconfigMAX_ARP_RETRANSMISSIONS
+ * requests without a reply, the address is considered unreachable, and no
+ * more requests are sent until its ARP entry has aged out. */
+#ifndef ipconfigUSE_ARP_REQUEST_LIMIT
+    #define ipconfigUSE_ARP_REQUEST_LIMIT    0
+#endif
+
+/* The time between the first and the second ARP request for an address,
+ * when ipconfigUSE_ARP_REQUEST_LIMIT is 1. */
+#ifndef ipconfigARP_REQUEST_INTERVAL_MS
+    #define ipconfigARP_REQUEST_INTERVAL_MS    ( 250U )
+#endif
+
+/* When set to 1, every TCP socket keeps the MAC address of its next hop,
+ * i.e. the peer or the gateway towards it, together with the ARP generation
+ * at the time it was looked up.  Outgoing TCP packets use that address.  It
+ * is only looked up again in the ARP cache after the generation has changed,
+ * see ulARPGetGeneration(). */
+#ifndef ipconfigUSE_TCP_NEXT_HOP_CACHE
+    #define ipconfigUSE_TCP_NEXT_HOP_CACHE    0
+#endif
+
+/* When set to 1, the DNS look-ups share one UDP socket, which is created at
+ * the first look-up and never closed.  The replies are handled by the IP-task.
+ * A look-up of a name that is being resolved already does not send a new
+ * question, it waits for the same answer.  Unanswered questions are sent
+ * again by the DNS timer.  Both FreeRTOS_gethostbyname() and
+ * FreeRTOS_gethostbyname_a() use the resolver.  Requires
+ * ipconfigDNS_USE_CALLBACKS. */
+#ifndef ipconfigDNS_USE_RESOLVER
+    #define ipconfigDNS_USE_RESOLVER    0
+#endif
+
+/* The number of different names that the resolver can look up at the same
+ * time.  When all entries are in use, a look-up gets a socket of its own. */
+#ifndef ipconfigDNS_RESOLVER_REQUESTS
+    #define ipconfigDNS_RESOLVER_REQUESTS    8
+#endif
+
+/* When set to 1, the DNS cache is indexed by a hash table keyed on the host
+ * name, and names are compared without regard to case.  The entries are kept
+ * in the order of their use.  When a new name must be stored, an expired
+ * entry among the least recently used ones is replaced first, otherwise the
+ * one whose TTL ends first.  Requires ipconfigUSE_DNS_CACHE. */
+#ifndef ipconfigUSE_DNS_CACHE_HASH
+    #define ipconfigUSE_DNS_CACHE_HASH    0
+#endif
+
+/* The number of slots in the DNS hash index.  It must be larger than
+ * ipconfigDNS_CACHE_ENTRIES.  Every slot takes 2 bytes. */
+#ifndef ipconfigDNS_CACHE_HASH_SIZE
+    #define ipconfigDNS_CACHE_HASH_SIZE    ( 2 * ipconfigDNS_CACHE_ENTRIES )
+#endif
+
+/* The longest time, in seconds, that a negative answer is kept in the DNS
+ * cache.  A negative answer says that a name does not exist, or that it has
+ * no IPv4 address.  As described in RFC 2308, it is only cached when the
+ * reply carries an SOA record, and for no longer than the TTL and the
+ * MINIMUM field of that record.  While it is cached, look-ups of the name
+ * fail at once.  Zero disables negative caching. */
+#ifndef ipconfigDNS_CACHE_NEGATIVE_TTL_MAX
+    #define ipconfigDNS_CACHE_NEGATIVE_TTL_MAX    0U
+#endif
+
+/* When set to 1, names in the DNS cache that are looked up often are
+ * refreshed in the background shortly before their TTL expires.  Callers keep
+ * getting the cached answer while the refresh is in progress.  Requires
+ * ipconfigUSE_DNS_CACHE and ipconfigDNS_USE_RESOLVER. */
+#ifndef ipconfigDNS_USE_PREFETCH
+    #define ipconfigDNS_USE_PREFETCH    0
+#endif
+
+/* The number of look-ups of a cached name, during the lifetime of its
+ * answer, after which the name is refreshed before it expires. */
+#ifndef ipconfigDNS_PREFETCH_MIN_LOOKUPS
+    #define ipconfigDNS_PREFETCH_MIN_LOOKUPS    3U
+#endif
+
+/* A popular name is refreshed when less than this percentage of its TTL is
+ * left. */
+#ifndef ipconfigDNS_PREFETCH_PERCENT
+    #define ipconfigDNS_PREFETCH_PERCENT    10U
+#endif
+
+/* The number of DNS servers that the DNS client can use.  When larger than 1,
+ * it uses the server of FreeRTOS_SetAddressConfiguration(), the servers in
+ * DHCP option 6, and the servers of FreeRTOS_SetDNSServers().  The servers are
+ * ranked by their measured round-trip time and by the questions that they
+ * did not answer.  Every server takes about 24 bytes. */
+#ifndef ipconfigDNS_MAX_SERVERS
+    #define ipconfigDNS_MAX_SERVERS    1
+#endif
+
+/* When ipconfigDNS_MAX_SERVERS is larger than 1: the number of servers to
+ * which a DNS question is sent at the same time.  The first answer is used.
+ * With 1, a question goes to the best ranked server, and a retransmission to
+ * the next one.  A larger number lowers the latency of a slow or failing
+ * server, at the cost of more traffic, and it keeps the ranking up to date.
+ * When the answer of a slower server is dropped, because the socket was closed
+ * after the first answer, it counts as an answer that took the whole receive
+ * time-out, not as a failure.  A server that is down still drops in the
+ * ranking that way. */
+#ifndef ipconfigDNS_PARALLEL_QUERIES
+    #define ipconfigDNS_PARALLEL_QUERIES    1
+#endif
+
+/* Set to 1 to parse DNS replies with xDNSParseReply(): a single pass over the
+ * message that checks every compression pointer, follows CNAME chains, and
+ * only accepts the A records of the name that was asked for.  When 0, the
+ * original parser is used, which accepts any A record in the answer section. */
+#ifndef ipconfigDNS_USE_FAST_PARSER
+    #define ipconfigDNS_USE_FAST_PARSER    0
+#endif
+
+/* When ipconfigDNS_USE_FAST_PARSER is 1: the maximum number of addresses that
+ * xDNSParseReply() collects from one reply.  Each one takes 8 bytes of stack
+ * while a reply is parsed.  At most ipconfigDNS_CACHE_ADDRESSES_PER_ENTRY of
+ * them are stored in the DNS cache. */
+#ifndef ipconfigDNS_PARSER_MAX_ADDRESSES
+    #define ipconfigDNS_PARSER_MAX_ADDRESSES    8
+#endif
+
+/* Set to 1 to let the DHCP client reuse its last lease after the network went
+ * down: it immediately asks for the same address with a DHCP request (the
+ * INIT-REBOOT state of RFC 2131), instead of waiting and starting with a
+ * discover.  When the server does not answer, it falls back to a discover.
+ * The lease is kept in RAM, see also ipconfigUSE_DHCP_LEASE_HOOK. */
+#ifndef ipconfigDHCP_FAST_RECONNECT
+    #define ipconfigDHCP_FAST_RECONNECT    0
+#endif
+
+/* When ipconfigDHCP_FAST_RECONNECT is 1: set to 1 to let the application
+ * persist the lease, so that it can be reused after a reboot as well.  The
+ * application must then provide vApplicationDHCPStoreLease() and
+ * xApplicationDHCPRestoreLease(), see FreeRTOS_DHCP.h. */
+#ifndef ipconfigUSE_DHCP_LEASE_HOOK
+    #define ipconfigUSE_DHCP_LEASE_HOOK    0
+#endif
+
+/* Set to 1 to add the Rapid Commit option (RFC 4039) to a DHCP discover.  A
+ * server that supports it answers with an acknowledgement right away, which
+ * saves the offer and the request.  Other servers ignore the option. */
+#ifndef ipconfigDHCP_USE_RAPID_COMMIT
+    #define ipconfigDHCP_USE_RAPID_COMMIT    0
+#endif
+
 #endif /* FREERTOS_DEFAULT_IP_CONFIG_H */
@@ -107,6 +107,43 @@
 
     #endif
 
+/*
+ * The ARP generation is incremented each time an entry in the ARP cache is
+ * replaced or removed, and when the addressing of the interface changes.
+ * Users that cache a MAC address can compare the generation to see if the
+ * cached value may still be used.
+ */
+    uint32_t ulARPGetGeneration( void );
+
+    void vARPIncrementGeneration( void );
+
+    #if ( ipconfigUSE_ARP_REQUEST_LIMIT == 1 )
+
+/**
+ * Counters of the ARP requests for addresses that are not resolved yet.
+ */
+        typedef struct xARP_REQUEST_STATS
+        {
+            uint32_t ulRequestsSent;      /**< The number of ARP requests sent. */
+            uint32_t ulRequestsCoalesced; /**< Requests not sent because a request for the same address was outstanding. */
+            uint32_t ulNegativeHits;      /**< Requests not sent because the address was found to be unreachable. */
+            uint32_t ulUnreachable;       /**< The number of addresses that did not answer any request. */
+        } ARPRequestStats_t;
+
+/*
+ * Make sure that an ARP request for ulIPAddress is outstanding.  A pending
+ * entry is created in the ARP cache when needed, and a request is only sent
+ * when the back-off time of the previous one has passed.  Must be called from
+ * the IP-task.
+ */
+        void vARPResolveAddress( uint32_t ulIPAddress );
+
+/*
+ * Copy the ARP request counters to pxStats.
+ */
+        void vARPGetRequestStats( ARPRequestStats_t * pxStats );
+    #endif /* ipconfigUSE_ARP_REQUEST_LIMIT */
+
 /*
  * Reduce the age count in each entry within the ARP cache.  An entry is no
  * longer considered valid and is deleted if its age reaches zero.
@@ -62,6 +62,13 @@
         #define dhcpINITIAL_DHCP_TX_PERIOD    ( pdMS_TO_TICKS( 5000U ) )
     #endif
 
+    #ifndef dhcpINIT_REBOOT_TX_PERIOD
+
+/** @brief The time to wait for an answer to a request for the address of the
+ * last lease.  The request is repeated once, after twice this time. */
+        #define dhcpINIT_REBOOT_TX_PERIOD    ( pdMS_TO_TICKS( 500U ) )
+    #endif
+
 /* Codes of interest found in the DHCP options field. */
     #define dhcpIPv4_ZERO_PAD_OPTION_CODE              ( 0U )  /**< Used to pad other options to make them aligned. See RFC 2132. */
     #define dhcpIPv4_SUBNET_MASK_OPTION_CODE           ( 1U )  /**< Subnet mask. See RFC 2132. */
@@ -74,6 +81,7 @@
     #define dhcpIPv4_SERVER_IP_ADDRESS_OPTION_CODE     ( 54U ) /**< Server Identifier. See RFC 2132. */
     #define dhcpIPv4_PARAMETER_REQUEST_OPTION_CODE     ( 55U ) /**< Parameter Request list. See RFC 2132. */
     #define dhcpIPv4_CLIENT_IDENTIFIER_OPTION_CODE     ( 61U ) /**<  Client Identifier. See RFC 2132. */
+    #define dhcpIPv4_RAPID_COMMIT_OPTION_CODE          ( 80U ) /**< Rapid Commit. See RFC 4039. */
 
 /* The four DHCP message types of interest. */
     #define dhcpMESSAGE_TYPE_DISCOVER                  ( 1 ) /**< DHCP discover message. */
@@ -188,6 +196,21 @@
         eNotUsingLeasedAddress     /**< DHCP failed, and a default IP address is being used. */
     } eDHCPState_t;
 
+    #if ( ipconfigDHCP_FAST_RECONNECT == 1 )
+
+/** @brief A lease that was acknowledged by a DHCP server.  All addresses are
+ * in network byte order. */
+        typedef struct xDHCP_LEASE
+        {
+            uint32_t ulIPAddress;         /**< The leased IP address. */
+            uint32_t ulNetMask;           /**< The netmask. */
+            uint32_t ulGatewayAddress;    /**< The gateway. */
+            uint32_t ulDNSServerAddress;  /**< The first DNS server. */
+            uint32_t ulDHCPServerAddress; /**< The DHCP server that acknowledged the lease. */
+            uint32_t ulLeaseSeconds;      /**< The length of the lease in seconds, counted from the acknowledgement. */
+        } DHCPLease_t;
+    #endif /* ipconfigDHCP_FAST_RECONNECT == 1 */
+
 /** @brief Hold information in between steps in the DHCP state machine. */
     struct xDHCP_DATA
     {
@@ -200,6 +223,15 @@
         TickType_t xDHCPTxPeriod;      /**< The maximum time that the client will wait for a reply. */
         BaseType_t xUseBroadcast;      /**< Try both without and with the broadcast flag */
         eDHCPState_t eDHCPState;       /**< Maintains the DHCP state machine state. */
+        #if ( ipconfigDHCP_FAST_RECONNECT == 1 )
+            DHCPLease_t xLease;        /**< The last lease that was acknowledged. */
+            TickType_t xLeaseStart;    /**< The time at which xLease was acknowledged or restored. */
+            BaseType_t xLeaseValid;    /**< pdTRUE when xLease may be asked for again. */
+            BaseType_t xInitReboot;    /**< pdTRUE while waiting for the answer to a request for xLease. */
+        #endif
+        #if ( ipconfigDHCP_USE_RAPID_COMMIT == 1 )
+            BaseType_t xRapidCommit;   /**< pdTRUE when the expected offer was an acknowledgement with the Rapid Commit option. */
+        #endif
     };
 
     typedef struct xDHCP_DATA DHCPData_t;
@@ -240,6 +272,23 @@
                                                     uint32_t ulIPAddress );
     #endif /* ( ipconfigUSE_DHCP_HOOK != 0 ) */
 
+    #if ( ipconfigDHCP_FAST_RECONNECT == 1 ) && ( ipconfigUSE_DHCP_LEASE_HOOK != 0 )
+
+/* Provided by the application if ipconfigUSE_DHCP_LEASE_HOOK is set to 1.
+ * Called from the IP-task each time a lease is acknowledged, also when it is
+ * renewed, so that it can be persisted.  pxLease is NULL when the server
+ * refused the lease, which must then be forgotten. */
+        void vApplicationDHCPStoreLease( const DHCPLease_t * pxLease );
+
+/* Provided by the application if ipconfigUSE_DHCP_LEASE_HOOK is set to 1.
+ * Called from the IP-task when the DHCP client starts without a valid lease
+ * in RAM, for instance after a reboot.  Fill in pxLease and return pdTRUE to
+ * ask for the address of that lease.  The application knows the time of day:
+ * it should return pdFALSE when the lease has expired, and it may lower
+ * ulLeaseSeconds to the time that is left. */
+        BaseType_t xApplicationDHCPRestoreLease( DHCPLease_t * pxLease );
+    #endif /* ( ipconfigDHCP_FAST_RECONNECT == 1 ) && ( ipconfigUSE_DHCP_LEASE_HOOK != 0 ) */
+
     #ifdef __cplusplus
         } /* extern "C" */
     #endif
@@ -42,12 +42,14 @@
         #define dnsOUTGOING_FLAGS       0x0001U  /**< Little endian representation of standard query. */
         #define dnsRX_FLAGS_MASK        0x0f80U  /**< Little endian:  The bits of interest in the flags field of incoming DNS messages. */
         #define dnsEXPECTED_RX_FLAGS    0x0080U  /**< Little Endian: Should be a response, without any errors. */
+        #define dnsNXDOMAIN_RX_FLAGS    0x0380U  /**< Little Endian: A response saying that the name does not exist. */
     #else
         #define dnsDNS_PORT             0x0035U  /**< Big endian: Port used for DNS. */
         #define dnsONE_QUESTION         0x0001U  /**< Big endian representation of a DNS question.*/
         #define dnsOUTGOING_FLAGS       0x0100U  /**< Big endian representation of standard query. */
         #define dnsRX_FLAGS_MASK        0x800fU  /**< Big endian: The bits of interest in the flags field of incoming DNS messages. */
         #define dnsEXPECTED_RX_FLAGS    0x8000U  /**< Big endian: Should be a response, without any errors. */
+        #define dnsNXDOMAIN_RX_FLAGS    0x8003U  /**< Big endian: A response saying that the name does not exist. */
 
     #endif /* ipconfigBYTE_ORDER */
 
@@ -70,6 +72,8 @@
 
 /* Host types. */
     #define dnsTYPE_A_HOST            0x01U /**< DNS type A host. */
+    #define dnsTYPE_CNAME             0x05U /**< DNS type canonical name. */
+    #define dnsTYPE_SOA               0x06U /**< DNS type start of authority. */
     #define dnsCLASS_IN               0x01U /**< DNS class IN (Internet). */
 
 /* Maximum hostname length as defined in RFC 1035 section 3.1. */
@@ -153,6 +157,10 @@
                 uint8_t ucNumIPAddresses;
                 uint8_t ucCurrentIPAddress;
             #endif
+            #if ( ipconfigDNS_USE_PREFETCH == 1 )
+                uint8_t ucLookUps;    /* The number of look-ups since the answer was stored. */
+                uint8_t ucRefreshing; /* Non-zero when a refresh has been sent. */
+            #endif
         } DNSCacheRow_t;
     #endif /* if ( ipconfigUSE_DNS_CACHE == 1 ) */
 
@@ -262,6 +270,19 @@
 /* Remove all entries from the DNS cache. */
         void FreeRTOS_dnsclear( void );
 
+/** @brief The counters of the DNS cache, see vDNSGetCacheStats(). */
+        typedef struct xDNS_CACHE_STATS
+        {
+            uint32_t ulHits;         /**< Look-ups that found an address. */
+            uint32_t ulNegativeHits; /**< Look-ups that found a cached negative answer. */
+            uint32_t ulMisses;       /**< Look-ups that found nothing, or an entry that had expired. */
+            uint32_t ulEvictions;    /**< Entries replaced before their TTL had expired. */
+            uint32_t ulPrefetches;   /**< Popular entries refreshed before their TTL expired. */
+        } DNSCacheStats_t;
+
+/* Get a copy of the counters of the DNS cache. */
+        void vDNSGetCacheStats( DNSCacheStats_t * pxStats );
+
     #endif /* ipconfigUSE_DNS_CACHE != 0 */
 
     #if ( ipconfigDNS_USE_CALLBACKS != 0 )
@@ -295,8 +316,102 @@
             char pcName[ 1 ];              /**< 1 character name. */
         } DNSCallback_t;
 
+/** @brief The counters of the DNS client, see vDNSGetResolverStats(). */
+        typedef struct xDNS_RESOLVER_STATS
+        {
+            uint32_t ulQueriesSent;      /**< The number of DNS questions sent, retransmissions included. */
+            uint32_t ulQueriesCollapsed; /**< The number of look-ups that waited for a question already in flight. */
+            uint32_t ulRetransmissions;  /**< The number of questions sent again by the resolver. */
+            uint32_t ulSocketsCreated;   /**< The number of sockets created by the DNS client. */
+        } DNSResolverStats_t;
+
+/*
+ * Get a copy of the counters of the DNS client.
+ */
+        void vDNSGetResolverStats( DNSResolverStats_t * pxStats );
+
     #endif /* if ( ipconfigDNS_USE_CALLBACKS != 0 ) */
 
+    #if ( ipconfigDNS_USE_RESOLVER == 1 )
+
+/*
+ * Returns pdTRUE if xSocket is the socket shared by the DNS resolver.  The
+ * replies to that socket are handled by the IP-task.
+ */
+        BaseType_t xIsDNSResolverSocket( Socket_t xSocket );
+    #endif /* ipconfigDNS_USE_RESOLVER */
+
+    #if ( ipconfigDNS_MAX_SERVERS > 1 )
+
+/** @brief The state of a DNS server, see FreeRTOS_GetDNSServers(). */
+        typedef struct xDNS_SERVER_INFO
+        {
+            uint32_t ulIPAddress; /**< The address of the server, in network byte order. */
+            uint32_t ulRTT;       /**< The smoothed round-trip time in ms, zero when not measured yet. */
+            uint32_t ulFailures;  /**< The number of questions not answered in time since the last answer. */
+            uint32_t ulAnswers;   /**< The number of answers received. */
+        } DNSServerInfo_t;
+
+/*
+ * Set the list of statically configured DNS servers, in network byte order.
+ * They are used along with the server of FreeRTOS_SetAddressConfiguration()
+ * and the servers offered by DHCP.  A count of zero removes them.
+ */
+        void FreeRTOS_SetDNSServers( const uint32_t * pulAddresses,
+                                     UBaseType_t uxCount );
+
+/*
+ * Copy the state of at most uxMaxCount DNS servers to pxServers, the best
+ * ranked one first.  Returns the number of servers copied.
+ */
+        UBaseType_t FreeRTOS_GetDNSServers( DNSServerInfo_t * pxServers,
+                                            UBaseType_t uxMaxCount );
+
+/*
+ * Called by the DHCP client with the contents of option 6: uxCount addresses
+ * in network byte order, not necessarily aligned.
+ */
+        void vDNSSetDHCPServers( const uint8_t * pucAddresses,
+                                 UBaseType_t uxCount );
+    #endif /* ipconfigDNS_MAX_SERVERS > 1 */
+
+    #if ( ipconfigDNS_USE_FAST_PARSER == 1 )
+        #ifdef ipconfigDNS_CACHE_NAME_LENGTH
+            #define dnsREPLY_NAME_LENGTH    ipconfigDNS_CACHE_NAME_LENGTH
+        #else
+            #define dnsREPLY_NAME_LENGTH    254U
+        #endif
+
+/** @brief An IPv4 address found in a DNS reply. */
+        typedef struct xDNS_REPLY_ADDRESS
+        {
+            uint32_t ulIPAddress; /**< The address, in network byte order. */
+            uint32_t ulTTL;       /**< The TTL in seconds: the lowest TTL of the record and the aliases that led to it. */
+        } DNSReplyAddress_t;
+
+/** @brief The contents of a DNS reply, see xDNSParseReply(). */
+        typedef struct xDNS_REPLY_INFO
+        {
+            char pcName[ dnsREPLY_NAME_LENGTH ];                              /**< The name in the first question. */
+            DNSReplyAddress_t xAddresses[ ipconfigDNS_PARSER_MAX_ADDRESSES ]; /**< The addresses of that name. */
+            UBaseType_t uxAddressCount;                                       /**< The number of entries in xAddresses. */
+            UBaseType_t uxAliasCount;                                         /**< The number of CNAME records followed. */
+            size_t uxQuestionsEnd;                                            /**< The offset of the answer section. */
+            size_t uxAuthorityOffset;                                         /**< The offset of the authority section. */
+            uint16_t usQuestionType;                                          /**< The type of the last question, in host order. */
+            uint16_t usQuestionClass;                                         /**< The class of the last question, in host order. */
+        } DNSReplyInfo_t;
+
+/*
+ * Parse a DNS reply in a single pass, without changing it.  The A records of
+ * the name in the first question are collected, following the CNAME chain
+ * that starts at that name.  Returns pdFAIL when the message is malformed.
+ */
+        BaseType_t xDNSParseReply( const uint8_t * pucBuffer,
+                                   size_t uxLength,
+                                   DNSReplyInfo_t * pxInfo );
+    #endif /* ipconfigDNS_USE_FAST_PARSER == 1 */
+
 /*
  * Lookup a IPv4 node in a blocking-way.
  * It returns a 32-bit IP-address, 0 when not found.
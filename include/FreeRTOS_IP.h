@@ -105,12 +105,18 @@
  *  << IP-header >>     // word-aligned
  *  uint8_t ucVersionHeaderLength;
  *  etc
+ *
+ * When ipconfigBUFFER_HEADROOM is defined, that number of bytes, rounded up to
+ * a multiple of 8, is inserted between the pointer and the filler.  Headers
+ * can be prepended in that space with pucNetworkBufferPush().
  */
 
+    #define ipBUFFER_HEADROOM    ( ( ( ipconfigBUFFER_HEADROOM ) + 7U ) & ~7U )
+
     #if ( ipconfigBUFFER_PADDING != 0 )
         #define ipBUFFER_PADDING    ipconfigBUFFER_PADDING
     #else
-        #define ipBUFFER_PADDING    ( 8U + ipconfigPACKET_FILLER_SIZE )
+        #define ipBUFFER_PADDING    ( 8U + ipBUFFER_HEADROOM + ipconfigPACKET_FILLER_SIZE )
     #endif
 
 /* The offset of ucTCPFlags within the TCP header. */
@@ -132,8 +138,28 @@
         #if ( ipconfigUSE_LINKED_RX_MESSAGES != 0 )
             struct xNETWORK_BUFFER * pxNextBuffer; /**< Possible optimisation for expert users - requires network driver support. */
         #endif
+        #if ( ipconfigUSE_NETWORK_BUFFER_CLONES == 1 )
+            struct xNETWORK_BUFFER * pxParent;     /**< For a clone: the buffer that owns the Ethernet frame, otherwise NULL. */
+            UBaseType_t uxReferenceCount;          /**< The number of references to the frame minus one, only used in the owner. */
+        #endif
+        #if ( ipconfigBUFFER_HEADROOM != 0 )
+            int32_t lFrameOffset;                  /**< The distance of pucEthernetBuffer from its default position, see pucNetworkBufferPush(). */
+        #endif
     } NetworkBufferDescriptor_t;
 
+    #if ( ipconfigUSE_BUFFER_PRESSURE == 1 )
+
+/**
+ * The pressure on the pool of network buffers, see eGetNetworkBufferPressure().
+ */
+        typedef enum
+        {
+            eBufferPressureNone = 0, /**< Enough network buffers are free. */
+            eBufferPressureHigh,     /**< The free buffers dropped to ipconfigBUFFER_LOW_WATERMARK. */
+            eBufferPressureCritical  /**< The free buffers dropped to ipconfigBUFFER_CRITICAL_WATERMARK. */
+        } eBufferPressure_t;
+    #endif
+
     #include "pack_struct_start.h"
 
 /**
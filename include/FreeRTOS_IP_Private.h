@@ -601,6 +601,11 @@
         {
             uint32_t ulRemoteIP;   /**< IP address of remote machine */
             uint16_t usRemotePort; /**< Port on remote machine */
+            #if ( ipconfigUSE_TCP_NEXT_HOP_CACHE == 1 )
+                MACAddress_t xNextHopMAC;  /**< The MAC address of the peer, or of the gateway towards it */
+                uint32_t ulARPGeneration;  /**< The ARP generation at the time xNextHopMAC was found */
+                BaseType_t xNextHopValid;  /**< pdTRUE when xNextHopMAC holds a MAC address */
+            #endif
             struct
             {
                 /* Most compilers do like bit-flags */
@@ -651,10 +656,29 @@
             #endif /* ipconfigTCP_HANG_PROTECTION */
             size_t uxLittleSpace;                         /**< The value deemed as low amount of space. */
             size_t uxEnoughSpace;                         /**< The value deemed as enough space. */
+            #if ( ipconfigTCP_WAKEUP_LOW_WATER == 1 )
+                size_t uxRcvLowat;                        /**< Wake up the reader when at least this many bytes can be read. */
+                size_t uxSndLowat;                        /**< Wake up the writer when at least this much space is available. */
+                EventBits_t xHeldEventBits;               /**< Events which are held back until a low-water mark is reached. */
+                TickType_t xHeldSince;                    /**< The time at which the first event was held back. */
+            #endif /* ipconfigTCP_WAKEUP_LOW_WATER */
+            #if ( ipconfigUSE_TCP_STATISTICS == 1 )
+                uint32_t ulBytesSent;                     /**< Payload bytes passed to the network, including retransmissions. */
+                uint32_t ulBytesReceived;                 /**< Payload bytes received and stored in the rxStream. */
+                TickType_t xZeroWindowTime;               /**< Ticks spent in earlier periods of a zero window advertised by the peer. */
+                TickType_t xZeroWindowStart;              /**< The time at which the current zero window period started. */
+                BaseType_t xZeroWindow;                   /**< pdTRUE while the peer advertises a zero window. */
+            #endif /* ipconfigUSE_TCP_STATISTICS */
             size_t uxRxStreamSize;                        /**< The Receive stream size */
             size_t uxTxStreamSize;                        /**< The transmit stream size */
             StreamBuffer_t * rxStream;                    /**< The pointer to the receive stream buffer. */
             StreamBuffer_t * txStream;                    /**< The pointer to the transmit stream buffer. */
+            #if ( ipconfigUSE_TCP_ELASTIC_STREAMS == 1 )
+                UBaseType_t uxStreamUsers;                /**< The number of API calls that are using the streams, they may not be moved. */
+                BaseType_t xStreamPinned;                 /**< A pointer into a stream was given to the user, the streams may not be moved anymore. */
+                BaseType_t xTxStreamFull;                 /**< FreeRTOS_send() is waiting for space in txStream. */
+                TickType_t xStreamActiveTime;             /**< The last time the streams were used. */
+            #endif /* ipconfigUSE_TCP_ELASTIC_STREAMS */
             #if ( ipconfigUSE_TCP_WIN == 1 )
                 NetworkBufferDescriptor_t * pxAckMessage; /**< The pointer to the ACK message */
             #endif /* ipconfigUSE_TCP_WIN */
@@ -697,6 +721,15 @@
                                               */
             FOnUDPSent_t pxHandleSent;       /**< Function pointer to handle the events after a successful send. */
         #endif /* ipconfigUSE_CALLBACKS */
+        #if ( ipconfigUSE_UDP_CONNECT == 1 )
+            uint32_t ulRemoteIP;           /**< The peer of a connected socket, in network byte order, or zero when not connected */
+            uint16_t usRemotePort;         /**< The port number of the peer, in network byte order */
+            uint16_t usIPChecksumPartial;  /**< Checksum of the IP header template, without length and identification */
+            uint16_t usUDPChecksumPartial; /**< Checksum of the addresses, the protocol and the ports in the pseudo header */
+            BaseType_t xTemplateValid;     /**< pdTRUE when xHeaderTemplate holds the resolved headers */
+            uint32_t ulARPGeneration;      /**< The ARP generation at the time the template was made */
+            UDPPacket_t xHeaderTemplate;   /**< Prebuilt Ethernet, IP and UDP headers towards the peer */
+        #endif /* ipconfigUSE_UDP_CONNECT */
     } IPUDPSocket_t;
 
 /* Formally typedef'd as eSocketEvent_t. */
@@ -713,13 +746,27 @@
     };
 
 
+/* When ipconfigSOCKET_USES_NOTIFY is defined, a socket can remember two waiting
+ * tasks: one that is sending, and one that is receiving or waiting for any
+ * other event.  Each of them consumes its own copy of the events, so that an
+ * event like eSOCKET_CLOSED wakes up both of them, as an event group does. */
+    #define ipSOCKET_NOTIFY_WAITERS     2U
+    #define ipSOCKET_NOTIFY_RECEIVER    0U
+    #define ipSOCKET_NOTIFY_SENDER      1U
+
 /**
  * Structure to hold information for a socket.
  */
     typedef struct xSOCKET
     {
         EventBits_t xEventBits;                /**< The eventbits to keep track of events. */
-        EventGroupHandle_t xEventGroup;        /**< The event group for this socket. */
+        #if ( ipconfigSOCKET_USES_NOTIFY == 0 )
+            EventGroupHandle_t xEventGroup;    /**< The event group for this socket. */
+        #else
+            TaskHandle_t xWaitingTask[ ipSOCKET_NOTIFY_WAITERS ]; /**< The tasks blocked on this socket, they will be notified. */
+            EventBits_t xWaitingBits[ ipSOCKET_NOTIFY_WAITERS ];  /**< The events that each of the waiting tasks is interested in. */
+            EventBits_t xPendingEventBits[ ipSOCKET_NOTIFY_WAITERS ]; /**< Events that have not yet been consumed, per waiting place. */
+        #endif /* ipconfigSOCKET_USES_NOTIFY */
 
         ListItem_t xBoundSocketListItem;       /**< Used to reference the socket from a bound sockets list. */
         TickType_t xReceiveBlockTime;          /**< if recv[to] is called while no data is available, wait this amount of time. Unit in clock-ticks */
@@ -826,11 +873,104 @@
                            const uint8_t * pcData,
                            uint32_t ulByteCount );
 
+    #if ( ipconfigUSE_TCP_RX_CHAIN == 1 )
+
+/*
+ * Make sure that the RX chain of a socket can take one more network buffer.
+ * Returns pdFALSE when it can not, the data must then be refused.
+ */
+        BaseType_t xTCPRxChainPrepare( FreeRTOS_Socket_t * pxSocket,
+                                       BaseType_t xInOrder );
+
+/*
+ * Like lTCPAddRxdata(), but the socket keeps the network buffer that holds the
+ * data.  '*ppxNetworkBuffer' is then replaced with a buffer that only holds a
+ * copy of the headers, to be used for the reply.
+ */
+        int32_t lTCPAddRxFrame( FreeRTOS_Socket_t * pxSocket,
+                                size_t uxOffset,
+                                NetworkBufferDescriptor_t ** ppxNetworkBuffer,
+                                const uint8_t * pucData,
+                                uint32_t ulByteCount );
+
+/*
+ * The number of bytes that the free links of the RX chain can receive.
+ */
+        size_t uxTCPRxChainCapacity( const FreeRTOS_Socket_t * pxSocket );
+    #endif /* ipconfigUSE_TCP_RX_CHAIN */
+
+    #if ( ipconfigUSE_TCP_ELASTIC_STREAMS == 1 )
+
+/*
+ * The capacity with which a new RX or TX stream will be created.
+ */
+        size_t uxTCPStreamInitialSize( const FreeRTOS_Socket_t * pxSocket,
+                                       BaseType_t xIsInputStream );
+
+/*
+ * Called by the IP-task: replace a stream with a bigger one, so that at least
+ * 'uxNeeded' bytes of space are available.  Returns pdTRUE when it was grown.
+ */
+        BaseType_t xTCPStreamGrow( FreeRTOS_Socket_t * pxSocket,
+                                   BaseType_t xIsInputStream,
+                                   size_t uxNeeded );
+    #endif /* ipconfigUSE_TCP_ELASTIC_STREAMS */
+
 /*
  * Currently called for any important event.
  */
     void vSocketWakeUpUser( FreeRTOS_Socket_t * pxSocket );
 
+/*
+ * Set events for the owner of a socket, either in its event group or by
+ * notifying the task that is waiting on it.
+ */
+    void vSocketSetEventBits( FreeRTOS_Socket_t * pxSocket,
+                              EventBits_t xBits );
+
+    #if ( ipconfigUSE_SOCKET_POOL == 1 )
+
+/** @brief A pool of statically allocated objects of equal size. */
+        typedef struct xSOCKET_POOL
+        {
+            uint8_t * pucObjects;      /**< The storage of the objects. */
+            size_t uxObjectSize;       /**< The size of each object in bytes. */
+            UBaseType_t uxObjectCount; /**< The number of objects in the storage. */
+            UBaseType_t uxNextUnused;  /**< Objects from this index onward have never been used. */
+            void * pvFreeList;         /**< Objects that were returned to the pool, linked through their first bytes. */
+            UBaseType_t uxInUse;       /**< The number of objects that are taken. */
+            UBaseType_t uxPeak;        /**< The highest value of uxInUse. */
+            const char * pcName;       /**< The name of the pool, used in FreeRTOS_PrintPoolUsage(). */
+        } SocketPool_t;
+
+/*
+ * Take an object from a static pool, or return one to it.  Both take constant
+ * time.  pvSocketPoolTake() returns NULL when the pool is exhausted.
+ */
+        void * pvSocketPoolTake( SocketPool_t * pxPool );
+
+        void vSocketPoolGive( SocketPool_t * pxPool,
+                              void * pvObject );
+
+        #if ( ( ipconfigUSE_STATIC_POOLS == 1 ) && ( ipconfigUSE_DNS != 0 ) && ( ipconfigDNS_USE_CALLBACKS != 0 ) )
+            /* Defined in FreeRTOS_DNS.c. */
+            extern SocketPool_t xDNSCallbackPool;
+        #endif
+    #endif /* ipconfigUSE_SOCKET_POOL */
+
+    #if ( ipconfigUSE_UDP_CONNECT == 1 )
+
+/*
+ * Complete the headers of an outgoing packet of a connected UDP socket from
+ * its header template.  Returns pdTRUE when the packet is ready to be handed
+ * to the network interface, pdFALSE when it must go through
+ * vProcessGeneratedUDPPacket() because the MAC address of the peer is not known.
+ */
+        BaseType_t xUDPConnectedFillPacket( FreeRTOS_Socket_t * pxSocket,
+                                            NetworkBufferDescriptor_t * pxNetworkBuffer,
+                                            size_t uxPayloadLength );
+    #endif /* ipconfigUSE_UDP_CONNECT */
+
 /*
  * Some helping function, their meaning should be clear.
  * Going by MISRA rules, these utility functions should not be defined
@@ -894,6 +1034,10 @@
 /* Returns pdTRUE is this function is called from the IP-task */
     BaseType_t xIsCallingFromIPTask( void );
 
+/* Returns the identification for the next outgoing IP packet, may be called
+ * from any task. */
+    uint16_t usGetNextPacketIdentifier( void );
+
     #if ( ipconfigSUPPORT_SELECT_FUNCTION == 1 )
 
 /** @brief Structure for event groups of the Socket Select functions */
@@ -909,6 +1053,11 @@
 
         extern void vSocketSelect( SocketSelect_t * pxSocketSet );
 
+        #if ( ipconfigUSE_STATIC_POOLS == 1 )
+            /* Return a socket set, whose event group has been deleted, to its pool. */
+            extern void vSocketSetRelease( SocketSelect_t * pxSocketSet );
+        #endif
+
 /** @brief Define the data that must be passed for a 'eSocketSelectEvent'. */
         typedef struct xSocketSelectMessage
         {
@@ -921,8 +1070,21 @@
 
     #endif /* ipconfigSUPPORT_SELECT_FUNCTION */
 
+/** @brief Defines how often the ARP timer callback function is executed.  The time is
+ * shorter in the Windows simulator as simulated time is not real time. */
+    #ifndef ipARP_TIMER_PERIOD_MS
+        #ifdef _WINDOWS_
+            #define ipARP_TIMER_PERIOD_MS    ( 500U ) /* For windows simulator builds. */
+        #else
+            #define ipARP_TIMER_PERIOD_MS    ( 10000U )
+        #endif
+    #endif
+
     void vIPSetDHCPTimerEnableState( BaseType_t xEnableState );
     void vIPReloadDHCPTimer( uint32_t ulLeaseTime );
+    #if ( ipconfigUSE_ARP_DEADLINE_AGING == 1 )
+        void vIPReloadARPTimer( TickType_t xTime );
+    #endif
     #if ( ipconfigDNS_USE_CALLBACKS != 0 )
         void vIPReloadDNSTimer( uint32_t ulCheckTime );
         void vIPSetDnsTimerEnableState( BaseType_t xEnableState );
@@ -138,6 +138,15 @@
 
     #define FREERTOS_SO_SET_LOW_HIGH_WATER            ( 18 )
 
+    #if ( ipconfigTCP_WAKEUP_LOW_WATER == 1 )
+        #define FREERTOS_SO_RCVLOWAT                  ( 19 ) /* Only wake up a reader when at least this many bytes can be read, parameter is a pointer to size_t (TCP only) */
+        #define FREERTOS_SO_SNDLOWAT                  ( 20 ) /* Only wake up a writer when at least this many bytes can be written, parameter is a pointer to size_t (TCP only) */
+    #endif
+
+    #if ( ipconfigUSE_TCP_STATISTICS == 1 )
+        #define FREERTOS_SO_TCP_INFO                  ( 21 ) /* Used with FreeRTOS_getsockopt(): get the statistics of a connection, parameter is a pointer to TCPInfo_t (TCP only) */
+    #endif
+
     #define FREERTOS_NOT_LAST_IN_FRAGMENTED_PACKET    ( 0x80 ) /* For internal use only, but also part of an 8-bit bitwise value. */
     #define FREERTOS_FRAGMENTED_PACKET                ( 0x40 ) /* For internal use only, but also part of an 8-bit bitwise value. */
 
@@ -176,6 +185,30 @@
         size_t uxEnoughSpace; /**< Send a GO when buffer space grows above X bytes */
     } LowHighWater_t;
 
+/**
+ * Structure filled in by FreeRTOS_getsockopt() for the 'FREERTOS_SO_TCP_INFO' option
+ */
+    typedef struct xTCP_INFO
+    {
+        uint8_t ucTCPState;             /**< The connection state, see eIPTCPState_t */
+        uint16_t usMSS;                 /**< Current Maximum Segment Size */
+        uint32_t ulSRTT;                /**< Smoothed round-trip time in ms */
+        uint32_t ulRTO;                 /**< Time-out in ms before a segment is sent for the first time again */
+        uint32_t ulRetransmits;         /**< Segments sent again because their time-out expired */
+        uint32_t ulFastRetransmits;     /**< Segments sent again after duplicate ACK's */
+        uint32_t ulDupAcks;             /**< Duplicate (selective) ACK's received */
+        uint32_t ulBytesSent;           /**< Payload bytes sent, including retransmissions */
+        uint32_t ulBytesReceived;       /**< Payload bytes received */
+        uint32_t ulRxWindowLength;      /**< Size of our reception window in bytes */
+        uint32_t ulTxWindowLength;      /**< Size of our transmission window in bytes */
+        uint32_t ulPeerWindow;          /**< Window size advertised by the peer in bytes */
+        uint32_t ulRxSegments;          /**< Reception segments in use by the connection */
+        uint32_t ulTxSegments;          /**< Transmission segments in use by the connection */
+        uint32_t ulZeroWindowTime;      /**< Time in ms during which the peer advertised a zero window */
+        size_t uxRxDataLength;          /**< Bytes in the rxStream waiting to be read */
+        size_t uxTxDataLength;          /**< Bytes in the txStream waiting to be sent or acknowledged */
+    } TCPInfo_t;
+
 /* For compatibility with the expected Berkeley sockets naming. */
     #define socklen_t    uint32_t
 
@@ -348,6 +381,22 @@
         uint8_t * FreeRTOS_get_tx_head( ConstSocket_t xSocket,
                                         BaseType_t * pxLength );
 
+/*
+ * For advanced applications only:
+ * Get the received data, or the free space of the transmit buffer, as two
+ * spans, so that it can be accessed in place even when it wraps around.
+ * Received data is removed with FreeRTOS_recv( xSocket, NULL, uxCount, 0 ),
+ * written data is sent with FreeRTOS_send( xSocket, NULL, uxCount, 0 ).
+ * Both return the total number of bytes, or a negative error code.
+ */
+        struct xSTREAM_SPAN;
+
+        BaseType_t FreeRTOS_get_rx_spans( ConstSocket_t xSocket,
+                                          struct xSTREAM_SPAN * pxSpans );
+
+        BaseType_t FreeRTOS_get_tx_spans( ConstSocket_t xSocket,
+                                          struct xSTREAM_SPAN * pxSpans );
+
     #endif /* ipconfigUSE_TCP */
 
     #if ( ipconfigUSE_CALLBACKS != 0 )
@@ -435,6 +484,13 @@
                                     int32_t lOptionName,
                                     const void * pvOptionValue,
                                     size_t uxOptionLength );
+    #if ( ( ipconfigUSE_TCP == 1 ) && ( ipconfigUSE_TCP_STATISTICS == 1 ) )
+        BaseType_t FreeRTOS_getsockopt( ConstSocket_t xSocket,
+                                        int32_t lLevel,
+                                        int32_t lOptionName,
+                                        void * pvOptionValue,
+                                        size_t * puxOptionLength );
+    #endif
     BaseType_t FreeRTOS_closesocket( Socket_t xSocket );
 
 /* The following function header should be placed in FreeRTOS_DNS.h.
@@ -482,6 +538,11 @@
 
     void FreeRTOS_netstat( void );
 
+    #if ( ipconfigUSE_STATIC_POOLS == 1 )
+/* Print the size and the use of the static pools of the stack. */
+        void FreeRTOS_PrintPoolUsage( void );
+    #endif
+
     #if ipconfigSUPPORT_SELECT_FUNCTION == 1
 
 /* For FD_SET and FD_CLR, a combination of the following bits can be used: */
@@ -30,6 +30,10 @@
  *  An implementation of a circular buffer without a length field
  *  If LENGTH defines the size of the buffer, a maximum of (LENGTH-1) bytes can be stored
  *  In order to add or read data from the buffer, memcpy() will be called at most 2 times
+ *
+ *  When ipconfigUSE_POW2_STREAM_BUFFERS is defined as 1 and LENGTH is a power of two,
+ *  the markers are free-running counters which are masked when the array is accessed.
+ *  Such a buffer can store LENGTH bytes.
  */
 
 #ifndef FREERTOS_STREAM_BUFFER_H
@@ -50,12 +54,33 @@
         volatile size_t uxHead;              /**< next position store a new item */
         volatile size_t uxFront;             /**< iterator within the free space */
         size_t LENGTH;                       /**< const value: number of reserved elements */
+        #if ( ipconfigUSE_POW2_STREAM_BUFFERS == 1 )
+            size_t uxMask;                   /**< LENGTH - 1 when LENGTH is a power of two, otherwise zero. */
+        #endif
         uint8_t ucArray[ sizeof( size_t ) ]; /**< array big enough to store any pointer address */
     } StreamBuffer_t;
 
+/**
+ * A contiguous part of the data or of the free space of a stream buffer.
+ * Because the buffer is circular, at most two spans are needed.
+ */
+    typedef struct xSTREAM_SPAN
+    {
+        uint8_t * pucData; /**< The start of the span, NULL when the span is empty. */
+        size_t uxLength;   /**< The number of bytes in the span. */
+    } StreamSpan_t;
+
+    void vStreamBufferInit( StreamBuffer_t * pxBuffer,
+                            size_t uxLength );
+/*-----------------------------------------------------------*/
+
     void vStreamBufferClear( StreamBuffer_t * pxBuffer );
 /*-----------------------------------------------------------*/
 
+    size_t uxStreamBufferIndex( const StreamBuffer_t * pxBuffer,
+                                size_t uxPosition );
+/*-----------------------------------------------------------*/
+
     size_t uxStreamBufferSpace( const StreamBuffer_t * pxBuffer,
                                 const size_t uxLower,
                                 const size_t uxUpper );
@@ -89,6 +114,38 @@
 
     size_t uxStreamBufferGetPtr( StreamBuffer_t * pxBuffer,
                                  uint8_t ** ppucData );
+/*-----------------------------------------------------------*/
+
+/*
+ * Get the data that can be read, starting uxOffset bytes after uxTail, as
+ * two spans: the part up to the end of the array and the part that wrapped
+ * to its beginning.  Nothing is removed, call uxStreamBufferConsume() once
+ * the data has been used.  Returns the total number of bytes.
+ */
+    size_t uxStreamBufferPeekData( StreamBuffer_t * pxBuffer,
+                                   size_t uxOffset,
+                                   StreamSpan_t pxSpans[ 2 ] );
+
+/*
+ * Get the free space in which data can be written, starting uxOffset bytes
+ * after uxHead, as two spans.  The data becomes visible to the reader after
+ * uxStreamBufferCommit().  Returns the total number of bytes.
+ */
+    size_t uxStreamBufferPeekSpace( StreamBuffer_t * pxBuffer,
+                                    size_t uxOffset,
+                                    StreamSpan_t pxSpans[ 2 ] );
+
+/*
+ * Remove uxCount bytes that were read through uxStreamBufferPeekData().
+ */
+    size_t uxStreamBufferConsume( StreamBuffer_t * pxBuffer,
+                                  size_t uxCount );
+
+/*
+ * Add uxCount bytes that were written through uxStreamBufferPeekSpace().
+ */
+    size_t uxStreamBufferCommit( StreamBuffer_t * pxBuffer,
+                                 size_t uxCount );
 
 /*
  * Add bytes to a stream buffer.
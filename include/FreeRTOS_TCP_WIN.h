@@ -128,6 +128,11 @@
         uint32_t ulNextTxSequenceNumber;                                       /**< The sequence number given to the next byte to be added for transmission */
         int32_t lSRTT;                                                         /**< Smoothed Round Trip Time, it may increment quickly and it decrements slower */
         uint8_t ucOptionLength;                                                /**< Number of valid bytes in ulOptionsData[] */
+        #if ( ipconfigUSE_TCP_STATISTICS == 1 )
+            uint32_t ulRetransmitCount;                                        /**< Segments sent again because their time-out expired */
+            uint32_t ulFastRetransmitCount;                                    /**< Segments sent again after duplicate (selective) ACK's */
+            uint32_t ulDupAckCount;                                            /**< ACK's that confirmed later data while older data was still outstanding */
+        #endif
         #if ( ipconfigUSE_TCP_WIN == 1 )
             List_t xPriorityQueue;                                             /**< Priority queue: segments which must be sent immediately */
             List_t xTxQueue;                                                   /**< Transmit queue: segments queued for transmission */
@@ -175,6 +180,12 @@
 /* Clean up allocated segments. Should only be called when FreeRTOS+TCP will no longer be used. */
     void vTCPSegmentCleanup( void );
 
+    #if ( ( ipconfigUSE_TCP_WIN == 1 ) && ( ipconfigUSE_STATIC_POOLS == 1 ) )
+/* Report how many segment descriptors are in use now, and at most. */
+        void vTCPWindowSegmentUsage( UBaseType_t * puxInUse,
+                                     UBaseType_t * puxPeak );
+    #endif
+
 /*=============================================================================
  *
  * Rx functions
@@ -214,6 +225,12 @@
  * it will return pdTRUE */
     BaseType_t xTCPWindowTxDone( const TCPWindow_t * pxWindow );
 
+/* The data in txStream was moved: the byte at 'lTail' is now at position 0.
+ * 'lMax' is the size of the old stream. */
+    void vTCPWindowTxRebase( TCPWindow_t * pxWindow,
+                             int32_t lTail,
+                             int32_t lMax );
+
 /* Fetches data to be sent.
  * plPosition will point to a location with the circular data buffer: txStream */
     uint32_t ulTCPWindowTxGet( TCPWindow_t * pxWindow,
@@ -112,6 +112,19 @@
     #define iptraceARP_TABLE_ENTRY_CREATED( ulIPAddress, ucMACAddress )
 #endif
 
+/* An ARP request was not sent because a request for the same address is
+ * still outstanding, or because the address did not answer before.  Only
+ * used when ipconfigUSE_ARP_REQUEST_LIMIT is 1. */
+#ifndef iptraceARP_REQUEST_SUPPRESSED
+    #define iptraceARP_REQUEST_SUPPRESSED( ulIPAddress )
+#endif
+
+/* None of the ARP requests for an address was answered, the address is now
+ * considered to be unreachable. */
+#ifndef iptraceARP_DESTINATION_UNREACHABLE
+    #define iptraceARP_DESTINATION_UNREACHABLE( ulIPAddress )
+#endif
+
 #ifndef iptraceSENDING_UDP_PACKET
     #define iptraceSENDING_UDP_PACKET( ulIPAddress )
 #endif
@@ -232,6 +245,42 @@
     #define iptraceSENDTO_DATA_TOO_LONG()
 #endif
 
+#ifndef iptraceSOCKET_WAKE_UP_USER
+    #define iptraceSOCKET_WAKE_UP_USER( pxSocket, xEventBits )
+#endif
+
+#ifndef iptraceTCP_WAKE_UP_HELD
+    #define iptraceTCP_WAKE_UP_HELD( pxSocket, xEventBits )
+#endif
+
+#ifndef iptraceBUFFER_PRESSURE_CHANGED
+    #define iptraceBUFFER_PRESSURE_CHANGED( eOldState, eNewState )
+#endif
+
+#ifndef iptraceUDP_DROPPED_UNDER_PRESSURE
+    #define iptraceUDP_DROPPED_UNDER_PRESSURE( pxSocket )
+#endif
+
+#ifndef iptraceTCP_SEND_DEFERRED
+    #define iptraceTCP_SEND_DEFERRED( pxSocket )
+#endif
+
+#ifndef iptraceETHERNET_RX_DROPPED_UNDER_PRESSURE
+    #define iptraceETHERNET_RX_DROPPED_UNDER_PRESSURE()
+#endif
+
+#ifndef iptraceTCP_RX_CHAIN_COMPACTED
+    #define iptraceTCP_RX_CHAIN_COMPACTED( pxSocket, uxLinksBefore, uxLinksAfter )
+#endif
+
+#ifndef iptraceTCP_STREAM_GROWN
+    #define iptraceTCP_STREAM_GROWN( pxSocket, xIsInputStream, uxOldLength, uxNewLength )
+#endif
+
+#ifndef iptraceTCP_STREAM_RELEASED
+    #define iptraceTCP_STREAM_RELEASED( pxSocket, xIsInputStream, uxLength )
+#endif
+
 #ifndef ipconfigUSE_TCP_MEM_STATS
     #define ipconfigUSE_TCP_MEM_STATS    0
 #endif
@@ -54,11 +54,94 @@
     NetworkBufferDescriptor_t * pxDuplicateNetworkBufferWithDescriptor( const NetworkBufferDescriptor_t * const pxNetworkBuffer,
                                                                         size_t uxNewLength );
 
+    #if ( ipconfigUSE_NETWORK_BUFFER_CLONES == 1 )
+/* Create a second descriptor that shares the Ethernet frame of a network buffer. */
+        NetworkBufferDescriptor_t * pxCloneNetworkBufferWithDescriptor( NetworkBufferDescriptor_t * const pxNetworkBuffer );
+
+/* Returns pdTRUE when the Ethernet frame of a network buffer has more than one owner. */
+        BaseType_t xIsNetworkBufferShared( const NetworkBufferDescriptor_t * pxNetworkBuffer );
+
+/* Get the current number of free clone descriptors. */
+        UBaseType_t uxGetNumberOfFreeNetworkBufferClones( void );
+
+/* Used by the buffer allocators: drop a reference to a network buffer.  Returns
+ * pdTRUE when the descriptor must be returned to the pool. */
+        BaseType_t xNetworkBufferDropReference( NetworkBufferDescriptor_t * const pxNetworkBuffer );
+        BaseType_t xNetworkBufferDropReferenceFromISR( NetworkBufferDescriptor_t * const pxNetworkBuffer,
+                                                       BaseType_t * pxHigherPriorityTaskWoken );
+    #endif
+
+    #if ( ipconfigBUFFER_HEADROOM != 0 )
+/* Prepend uxLength bytes to the frame, using the headroom in front of it. */
+        uint8_t * pucNetworkBufferPush( NetworkBufferDescriptor_t * const pxNetworkBuffer,
+                                        size_t uxLength );
+
+/* Remove uxLength bytes from the start of the frame. */
+        uint8_t * pucNetworkBufferPull( NetworkBufferDescriptor_t * const pxNetworkBuffer,
+                                        size_t uxLength );
+
+/* Append uxLength bytes to the frame, using the tailroom behind it. */
+        uint8_t * pucNetworkBufferPut( NetworkBufferDescriptor_t * const pxNetworkBuffer,
+                                       size_t uxLength );
+
+/* Move the start of the frame so that exactly uxHeadroom bytes are in front of it. */
+        BaseType_t xNetworkBufferReserve( NetworkBufferDescriptor_t * const pxNetworkBuffer,
+                                          size_t uxHeadroom );
+
+/* The number of bytes in front of and behind the frame. */
+        size_t uxNetworkBufferHeadroom( const NetworkBufferDescriptor_t * pxNetworkBuffer );
+        size_t uxNetworkBufferTailroom( const NetworkBufferDescriptor_t * pxNetworkBuffer );
+
+/* Move the frame back to its default position, used by the buffer allocators. */
+        void vNetworkBufferResetFrame( NetworkBufferDescriptor_t * const pxNetworkBuffer );
+
+/* Implemented by the buffer allocator: the number of bytes that a buffer can
+ * hold when the frame is in its default position. */
+        size_t uxGetNetworkBufferCapacity( const NetworkBufferDescriptor_t * pxNetworkBuffer );
+    #endif
+
+    #if ( ipconfigUSE_BUFFER_PRESSURE == 1 )
+/* Get the current pressure on the pool of network buffers. */
+        eBufferPressure_t eGetNetworkBufferPressure( void );
+    #endif
+
 /* Increase the size of a Network Buffer.
- * In case BufferAllocation_2.c is used, the new space must be allocated. */
+ * In case BufferAllocation_2.c is used, a buffer of a larger class may be
+ * returned, and the original buffer is released.  When NULL is returned,
+ * the original buffer is still owned by the caller. */
     NetworkBufferDescriptor_t * pxResizeNetworkBufferWithDescriptor( NetworkBufferDescriptor_t * pxNetworkBuffer,
                                                                      size_t xNewSizeBytes );
 
+/* The size classes of BufferAllocation_2.c. */
+    #define ipBUFFER_CLASS_SMALL    0
+    #define ipBUFFER_CLASS_MTU      1
+    #define ipBUFFER_CLASS_JUMBO    2
+    #define ipBUFFER_CLASS_COUNT    3
+
+/* Statistics about a single size class of BufferAllocation_2.c. */
+    typedef struct xNETWORK_BUFFER_CLASS_STATS
+    {
+        size_t uxBufferSize;       /**< The capacity of each buffer in this class, in bytes. */
+        UBaseType_t uxTotal;       /**< The number of buffers in this class. */
+        UBaseType_t uxFree;        /**< The number of buffers that are currently free. */
+        UBaseType_t uxMinimumFree; /**< The lowest number of free buffers since booting. */
+        uint32_t ulAllocations;    /**< The number of buffers handed out. */
+        uint32_t ulFallbacks;      /**< The number of buffers handed out because a smaller class was exhausted. */
+        uint32_t ulFailures;       /**< The number of requests that could not be served by this class. */
+    } NetworkBufferClassStats_t;
+
+/* The definition of the below function is only available if BufferAllocation_2.c has been linked into the source. */
+    BaseType_t xGetNetworkBufferClassStats( BaseType_t xClass,
+                                            NetworkBufferClassStats_t * pxStats );
+
+    #if ( ipconfigBUFFER_ALLOC_LOCK_FREE == 1 )
+/* Give the calling task a private cache of network buffers. */
+        BaseType_t xNetworkBufferCacheRegister( void );
+
+/* Return the cached buffers of the calling task and release its cache. */
+        void vNetworkBufferCacheUnregister( void );
+    #endif
+
     #if ipconfigTCP_IP_SANITY
 
 /*
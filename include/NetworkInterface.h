@@ -41,6 +41,14 @@
 /* The following function is defined only when BufferAllocation_1.c is linked in the project. */
     BaseType_t xGetPhyLinkStatus( void );
 
+    #if ( ipconfigUSE_BUFFER_PRESSURE == 1 ) && ( ipconfigBUFFER_PRESSURE_DRIVER_HOOK == 1 )
+
+/* Called by the IP-task when the pressure on the pool of network buffers
+ * changes.  The driver may drop received frames early, or pause reception,
+ * until the pressure is over. */
+        void vNetworkInterfaceBufferPressure( eBufferPressure_t eState );
+    #endif
+
     #ifdef __cplusplus
         } /* extern "C" */
     #endif
@@ -40,6 +40,10 @@
 #include "queue.h"
 #include "semphr.h"
 
+#if ( ipconfigBUFFER_ALLOC_LOCK_FREE == 1 )
+    #include "atomic.h"
+#endif
+
 /* FreeRTOS+TCP includes. */
 #include "FreeRTOS_IP.h"
 #include "FreeRTOS_IP_Private.h"
@@ -50,6 +54,14 @@
  * be at least this number of buffers available. */
 #define baINTERRUPT_BUFFER_GET_THRESHOLD    ( 3 )
 
+/* The initial count of xNetworkBufferSemaphore.  In the lock-free version the
+ * semaphore does not count the free buffers. */
+#if ( ipconfigBUFFER_ALLOC_LOCK_FREE == 1 )
+    #define baINITIAL_SEMAPHORE_COUNT    ( 0 )
+#else
+    #define baINITIAL_SEMAPHORE_COUNT    ipconfigNUM_NETWORK_BUFFER_DESCRIPTORS
+#endif
+
 /* A list of free (available) NetworkBufferDescriptor_t structures. */
 static List_t xFreeBuffersList;
 
@@ -68,9 +80,84 @@ static NetworkBufferDescriptor_t xNetworkBuffers[ ipconfigNUM_NETWORK_BUFFER_DES
  * packet. No resizing will be done. */
 const BaseType_t xBufferAllocFixedSize = pdTRUE;
 
-/* The semaphore used to obtain network buffers. */
+/* The semaphore used to obtain network buffers.  When
+ * ipconfigBUFFER_ALLOC_LOCK_FREE is set, it is only used to wake up tasks
+ * that are waiting for a buffer. */
 static SemaphoreHandle_t xNetworkBufferSemaphore = NULL;
 
+#if ( ipconfigBUFFER_ALLOC_LOCK_FREE == 1 )
+
+    #if ( ipconfigNUM_NETWORK_BUFFER_DESCRIPTORS > 0xFFFE )
+        #error The lock-free free list can hold at most 65534 network buffers
+    #endif
+
+/* The free descriptors form a stack, which is linked through usNextFree[].
+ * The top of the stack is a single 32-bit word: the low 16 bits hold the
+ * index of the top descriptor plus one, or zero when the stack is empty.
+ * The high 16 bits hold a tag that is incremented at every change, so that
+ * a compare-and-swap can not succeed on a stale top (the ABA problem). */
+    #define baSTACK_INDEX_MASK    0x0000FFFFUL
+    #define baSTACK_TAG_ONE       0x00010000UL
+
+    static uint32_t volatile ulFreeStackTop = 0U;
+
+/* For each descriptor: the index plus one of the next free descriptor. */
+    static uint16_t usNextFree[ ipconfigNUM_NETWORK_BUFFER_DESCRIPTORS ];
+
+/* The number of descriptors on the free stack. */
+    static uint32_t volatile ulFreeStackCount = 0U;
+
+/* Non-zero for every descriptor that is free, either on the stack or in a
+ * cache.  Used to detect double releases. */
+    static uint8_t volatile ucIsFree[ ipconfigNUM_NETWORK_BUFFER_DESCRIPTORS ];
+
+/* The number of tasks that are blocked on xNetworkBufferSemaphore, waiting
+ * for a buffer to be released. */
+    static uint32_t volatile ulWaitingTasks = 0U;
+
+/** @brief A small cache of free network buffers that belongs to a single task. */
+    typedef struct xBUFFER_CACHE
+    {
+        TaskHandle_t xOwner;                                                /**< The task that owns the cache, or NULL. */
+        UBaseType_t uxCount;                                                /**< The number of buffers in the cache. */
+        NetworkBufferDescriptor_t * pxBuffers[ ipconfigBUFFER_CACHE_SIZE ]; /**< The cached buffers. */
+    } BufferCache_t;
+
+/* The per-task caches.  Only the owning task touches a cache, except for
+ * the owner field, which is set once. */
+    static BufferCache_t xBufferCaches[ ipconfigBUFFER_CACHE_TASKS ];
+
+/*
+ * Push a chain of descriptors on the free stack.  The chain must already be
+ * linked through usNextFree[], from pxFirst to pxLast.
+ */
+    static void prvFreeStackPush( NetworkBufferDescriptor_t * pxFirst,
+                                  NetworkBufferDescriptor_t * pxLast,
+                                  uint32_t ulCount );
+
+/*
+ * Pop a descriptor from the free stack, or return NULL when it is empty.
+ */
+    static NetworkBufferDescriptor_t * prvFreeStackPop( void );
+
+/*
+ * Return the cache of the calling task, or NULL when it has none.
+ */
+    static BufferCache_t * prvGetBufferCache( void );
+
+/*
+ * Move the buffers of a cache, from index uxKeep upwards, to the free stack.
+ */
+    static void prvBufferCacheSpill( BufferCache_t * pxCache,
+                                     UBaseType_t uxKeep );
+
+/*
+ * Update the statistics after a descriptor was taken.
+ */
+    static void prvUpdateMinimumFree( void );
+
+#endif /* ipconfigBUFFER_ALLOC_LOCK_FREE */
+
 #if ( ipconfigTCP_IP_SANITY != 0 )
     static char cIsLow = pdFALSE;
     UBaseType_t bIsValidNetworkDescriptor( const NetworkBufferDescriptor_t * pxDesc );
@@ -117,8 +204,13 @@ static void prvShowWarnings( void );
 
     BaseType_t prvIsFreeBuffer( const NetworkBufferDescriptor_t * pxDescr )
     {
-        return ( bIsValidNetworkDescriptor( pxDescr ) != 0 ) &&
-               ( listIS_CONTAINED_WITHIN( &xFreeBuffersList, &( pxDescr->xBufferListItem ) ) != 0 );
+        #if ( ipconfigBUFFER_ALLOC_LOCK_FREE == 1 )
+            return ( bIsValidNetworkDescriptor( pxDescr ) != 0 ) &&
+                   ( ucIsFree[ pxDescr - xNetworkBuffers ] != 0U );
+        #else
+            return ( bIsValidNetworkDescriptor( pxDescr ) != 0 ) &&
+                   ( listIS_CONTAINED_WITHIN( &xFreeBuffersList, &( pxDescr->xBufferListItem ) ) != 0 );
+        #endif
     }
     /*-----------------------------------------------------------*/
 
@@ -181,12 +273,12 @@ BaseType_t xNetworkBuffersInitialise( void )
                 static StaticSemaphore_t xNetworkBufferSemaphoreBuffer;
                 xNetworkBufferSemaphore = xSemaphoreCreateCountingStatic(
                     ( UBaseType_t ) ipconfigNUM_NETWORK_BUFFER_DESCRIPTORS,
-                    ( UBaseType_t ) ipconfigNUM_NETWORK_BUFFER_DESCRIPTORS,
+                    ( UBaseType_t ) baINITIAL_SEMAPHORE_COUNT,
                     &xNetworkBufferSemaphoreBuffer );
             }
         #else
             {
-                xNetworkBufferSemaphore = xSemaphoreCreateCounting( ( UBaseType_t ) ipconfigNUM_NETWORK_BUFFER_DESCRIPTORS, ( UBaseType_t ) ipconfigNUM_NETWORK_BUFFER_DESCRIPTORS );
+                xNetworkBufferSemaphore = xSemaphoreCreateCounting( ( UBaseType_t ) ipconfigNUM_NETWORK_BUFFER_DESCRIPTORS, ( UBaseType_t ) baINITIAL_SEMAPHORE_COUNT );
             }
         #endif /* configSUPPORT_STATIC_ALLOCATION */
 
@@ -208,7 +300,16 @@ BaseType_t xNetworkBuffersInitialise( void )
                 listSET_LIST_ITEM_OWNER( &( xNetworkBuffers[ x ].xBufferListItem ), &xNetworkBuffers[ x ] );
 
                 /* Currently, all buffers are available for use. */
-                vListInsert( &xFreeBuffersList, &( xNetworkBuffers[ x ].xBufferListItem ) );
+                #if ( ipconfigBUFFER_ALLOC_LOCK_FREE == 1 )
+                    {
+                        ucIsFree[ x ] = 1U;
+                        prvFreeStackPush( &( xNetworkBuffers[ x ] ), &( xNetworkBuffers[ x ] ), 1U );
+                    }
+                #else
+                    {
+                        vListInsert( &xFreeBuffersList, &( xNetworkBuffers[ x ].xBufferListItem ) );
+                    }
+                #endif
             }
 
             uxMinimumFreeNetworkBuffers = ( UBaseType_t ) ipconfigNUM_NETWORK_BUFFER_DESCRIPTORS;
@@ -228,65 +329,300 @@ BaseType_t xNetworkBuffersInitialise( void )
 }
 /*-----------------------------------------------------------*/
 
-NetworkBufferDescriptor_t * pxGetNetworkBufferWithDescriptor( size_t xRequestedSizeBytes,
-                                                              TickType_t xBlockTimeTicks )
-{
-    NetworkBufferDescriptor_t * pxReturn = NULL;
-    BaseType_t xInvalid = pdFALSE;
-    UBaseType_t uxCount;
+#if ( ipconfigBUFFER_ALLOC_LOCK_FREE == 1 )
 
-    /* The current implementation only has a single size memory block, so
-     * the requested size parameter is not used (yet). */
-    ( void ) xRequestedSizeBytes;
+/**
+ * @brief Push a chain of free descriptors on the free stack with a single
+ *        compare-and-swap.
+ *
+ * @param[in] pxFirst: The first descriptor of the chain, it will be the new top.
+ * @param[in] pxLast: The last descriptor of the chain.
+ * @param[in] ulCount: The number of descriptors in the chain.
+ */
+    static void prvFreeStackPush( NetworkBufferDescriptor_t * pxFirst,
+                                  NetworkBufferDescriptor_t * pxLast,
+                                  uint32_t ulCount )
+    {
+        uint32_t ulOldTop;
+        uint32_t ulNewTop;
+        uint32_t ulLast = ( uint32_t ) ( pxLast - xNetworkBuffers );
+
+        do
+        {
+            ulOldTop = ulFreeStackTop;
+            usNextFree[ ulLast ] = ( uint16_t ) ( ulOldTop & baSTACK_INDEX_MASK );
+            ulNewTop = ( ( ulOldTop & ~baSTACK_INDEX_MASK ) + baSTACK_TAG_ONE ) |
+                       ( ( uint32_t ) ( pxFirst - xNetworkBuffers ) + 1U );
+        } while( Atomic_CompareAndSwap_u32( &ulFreeStackTop, ulNewTop, ulOldTop ) != ATOMIC_COMPARE_AND_SWAP_SUCCESS );
 
-    if( xNetworkBufferSemaphore != NULL )
+        ( void ) Atomic_Add_u32( &ulFreeStackCount, ulCount );
+    }
+    /*-----------------------------------------------------------*/
+
+/**
+ * @brief Pop a descriptor from the free stack.
+ *
+ * @return The descriptor, or NULL when the stack is empty.
+ */
+    static NetworkBufferDescriptor_t * prvFreeStackPop( void )
     {
-        /* If there is a semaphore available, there is a network buffer
-         * available. */
-        if( xSemaphoreTake( xNetworkBufferSemaphore, xBlockTimeTicks ) == pdPASS )
+        NetworkBufferDescriptor_t * pxReturn = NULL;
+        uint32_t ulOldTop;
+        uint32_t ulNewTop;
+        uint32_t ulIndex;
+
+        for( ; ; )
         {
-            /* Protect the structure as it is accessed from tasks and
-             * interrupts. */
-            ipconfigBUFFER_ALLOC_LOCK();
+            ulOldTop = ulFreeStackTop;
+            ulIndex = ulOldTop & baSTACK_INDEX_MASK;
+
+            if( ulIndex == 0U )
             {
-                pxReturn = ( NetworkBufferDescriptor_t * ) listGET_OWNER_OF_HEAD_ENTRY( &xFreeBuffersList );
+                /* The stack is empty. */
+                break;
+            }
+
+            /* usNextFree[] may be changed by another task while it is read,
+             * but then the tag has changed and the swap will fail. */
+            ulNewTop = ( ( ulOldTop & ~baSTACK_INDEX_MASK ) + baSTACK_TAG_ONE ) |
+                       ( uint32_t ) usNextFree[ ulIndex - 1U ];
+
+            if( Atomic_CompareAndSwap_u32( &ulFreeStackTop, ulNewTop, ulOldTop ) == ATOMIC_COMPARE_AND_SWAP_SUCCESS )
+            {
+                ( void ) Atomic_Decrement_u32( &ulFreeStackCount );
+                pxReturn = &( xNetworkBuffers[ ulIndex - 1U ] );
+                break;
+            }
+        }
+
+        return pxReturn;
+    }
+    /*-----------------------------------------------------------*/
+
+/**
+ * @brief Find the buffer cache of the calling task.
+ *
+ * @return The cache, or NULL when the task has not registered one.
+ */
+    static BufferCache_t * prvGetBufferCache( void )
+    {
+        BufferCache_t * pxReturn = NULL;
+        TaskHandle_t xCurrentTask;
+        BaseType_t xIndex;
 
-                if( ( bIsValidNetworkDescriptor( pxReturn ) != pdFALSE_UNSIGNED ) &&
-                    listIS_CONTAINED_WITHIN( &xFreeBuffersList, &( pxReturn->xBufferListItem ) ) )
+        xCurrentTask = xTaskGetCurrentTaskHandle();
+
+        for( xIndex = 0; xIndex < ( BaseType_t ) ipconfigBUFFER_CACHE_TASKS; xIndex++ )
+        {
+            if( ( xBufferCaches[ xIndex ].xOwner != NULL ) &&
+                ( xBufferCaches[ xIndex ].xOwner == xCurrentTask ) )
+            {
+                pxReturn = &( xBufferCaches[ xIndex ] );
+                break;
+            }
+        }
+
+        return pxReturn;
+    }
+    /*-----------------------------------------------------------*/
+
+/**
+ * @brief Move the buffers of a cache, from index uxKeep upwards, to the shared
+ *        free list at once, and wake up the tasks that wait for a buffer.
+ *
+ * @param[in] pxCache: The cache of the calling task.
+ * @param[in] uxKeep: The number of buffers that stay in the cache.
+ */
+    static void prvBufferCacheSpill( BufferCache_t * pxCache,
+                                     UBaseType_t uxKeep )
+    {
+        UBaseType_t uxIndex;
+
+        if( pxCache->uxCount > uxKeep )
+        {
+            /* Link the buffers into a chain. */
+            for( uxIndex = uxKeep; uxIndex < ( pxCache->uxCount - 1U ); uxIndex++ )
+            {
+                usNextFree[ pxCache->pxBuffers[ uxIndex ] - xNetworkBuffers ] =
+                    ( uint16_t ) ( ( pxCache->pxBuffers[ uxIndex + 1U ] - xNetworkBuffers ) + 1 );
+            }
+
+            prvFreeStackPush( pxCache->pxBuffers[ uxKeep ],
+                              pxCache->pxBuffers[ pxCache->uxCount - 1U ],
+                              ( uint32_t ) ( pxCache->uxCount - uxKeep ) );
+
+            /* One wake-up for every buffer, as long as tasks are waiting. */
+            for( uxIndex = uxKeep; ( uxIndex < pxCache->uxCount ) && ( ulWaitingTasks != 0U ); uxIndex++ )
+            {
+                ( void ) xSemaphoreGive( xNetworkBufferSemaphore );
+            }
+
+            pxCache->uxCount = uxKeep;
+        }
+    }
+    /*-----------------------------------------------------------*/
+
+/**
+ * @brief Latch the lowest number of free network buffers since booting.
+ */
+    static void prvUpdateMinimumFree( void )
+    {
+        UBaseType_t uxCount = uxGetNumberOfFreeNetworkBuffers();
+
+        /* For stats only, a race with another task is harmless. */
+        if( uxMinimumFreeNetworkBuffers > uxCount )
+        {
+            uxMinimumFreeNetworkBuffers = uxCount;
+        }
+    }
+    /*-----------------------------------------------------------*/
+
+/**
+ * @brief Give the calling task a private cache of network buffers.  Buffers
+ *        obtained and released by this task are taken from and returned to
+ *        the cache, without any locking.  The cache is refilled from, and
+ *        spilled to, the shared free list in batches.
+ *
+ * @return pdPASS when the task has a cache, pdFAIL when all caches are in use.
+ */
+    BaseType_t xNetworkBufferCacheRegister( void )
+    {
+        BaseType_t xReturn = pdFAIL;
+        TaskHandle_t xCurrentTask = xTaskGetCurrentTaskHandle();
+        BaseType_t xIndex;
+
+        if( prvGetBufferCache() != NULL )
+        {
+            xReturn = pdPASS;
+        }
+        else
+        {
+            taskENTER_CRITICAL();
+            {
+                for( xIndex = 0; xIndex < ( BaseType_t ) ipconfigBUFFER_CACHE_TASKS; xIndex++ )
+                {
+                    if( xBufferCaches[ xIndex ].xOwner == NULL )
+                    {
+                        xBufferCaches[ xIndex ].uxCount = 0U;
+                        xBufferCaches[ xIndex ].xOwner = xCurrentTask;
+                        xReturn = pdPASS;
+                        break;
+                    }
+                }
+            }
+            taskEXIT_CRITICAL();
+        }
+
+        return xReturn;
+    }
+    /*-----------------------------------------------------------*/
+
+/**
+ * @brief Return all buffers in the cache of the calling task to the shared
+ *        free list, and release the cache.  Must be called before a task that
+ *        registered a cache is deleted.
+ */
+    void vNetworkBufferCacheUnregister( void )
+    {
+        BufferCache_t * pxCache = prvGetBufferCache();
+
+        if( pxCache != NULL )
+        {
+            prvBufferCacheSpill( pxCache, 0U );
+            pxCache->xOwner = NULL;
+        }
+    }
+    /*-----------------------------------------------------------*/
+
+    NetworkBufferDescriptor_t * pxGetNetworkBufferWithDescriptor( size_t xRequestedSizeBytes,
+                                                                  TickType_t xBlockTimeTicks )
+    {
+        NetworkBufferDescriptor_t * pxReturn = NULL;
+        BufferCache_t * pxCache;
+        TimeOut_t xTimeOut;
+        TickType_t xRemainingTime = xBlockTimeTicks;
+
+        if( xNetworkBufferSemaphore != NULL )
+        {
+            pxCache = prvGetBufferCache();
+
+            if( ( pxCache != NULL ) && ( ulWaitingTasks != 0U ) )
+            {
+                /* Other tasks are waiting for a buffer: keep one buffer, and
+                 * give the rest of the cache back to the shared free list. */
+                if( pxCache->uxCount > 0U )
                 {
-                    ( void ) uxListRemove( &( pxReturn->xBufferListItem ) );
+                    pxCache->uxCount--;
+                    pxReturn = pxCache->pxBuffers[ pxCache->uxCount ];
+                    prvBufferCacheSpill( pxCache, 0U );
                 }
                 else
                 {
-                    xInvalid = pdTRUE;
+                    pxReturn = prvFreeStackPop();
                 }
             }
-            ipconfigBUFFER_ALLOC_UNLOCK();
-
-            if( xInvalid == pdTRUE )
+            else if( pxCache != NULL )
             {
-                /* _RB_ Can printf() be called from an interrupt?  (comment
-                 * above says this can be called from an interrupt too) */
-
-                /* _HT_ The function shall not be called from an ISR. Comment
-                 * was indeed misleading. Hopefully clear now?
-                 * So the printf()is OK here. */
-                FreeRTOS_debug_printf( ( "pxGetNetworkBufferWithDescriptor: INVALID BUFFER: %p (valid %lu)\n",
-                                         pxReturn, bIsValidNetworkDescriptor( pxReturn ) ) );
-                pxReturn = NULL;
+                if( pxCache->uxCount == 0U )
+                {
+                    /* Refill half of the cache from the shared free list. */
+                    while( pxCache->uxCount < ( ( ( UBaseType_t ) ipconfigBUFFER_CACHE_SIZE + 1U ) / 2U ) )
+                    {
+                        pxReturn = prvFreeStackPop();
+
+                        if( pxReturn == NULL )
+                        {
+                            break;
+                        }
+
+                        pxCache->pxBuffers[ pxCache->uxCount ] = pxReturn;
+                        pxCache->uxCount++;
+                    }
+                }
+
+                if( pxCache->uxCount > 0U )
+                {
+                    pxCache->uxCount--;
+                    pxReturn = pxCache->pxBuffers[ pxCache->uxCount ];
+                }
+                else
+                {
+                    pxReturn = NULL;
+                }
             }
             else
             {
-                /* Reading UBaseType_t, no critical section needed. */
-                uxCount = listCURRENT_LIST_LENGTH( &xFreeBuffersList );
+                pxReturn = prvFreeStackPop();
+            }
 
-                /* For stats, latch the lowest number of network buffers since
-                 * booting. */
-                if( uxMinimumFreeNetworkBuffers > uxCount )
+            if( ( pxReturn == NULL ) && ( xBlockTimeTicks != ( TickType_t ) 0U ) )
+            {
+                /* Announce that this task is waiting before trying again, so
+                 * that a buffer released in between is not missed. */
+                vTaskSetTimeOutState( &xTimeOut );
+                ( void ) Atomic_Increment_u32( &ulWaitingTasks );
+
+                for( ; ; )
                 {
-                    uxMinimumFreeNetworkBuffers = uxCount;
+                    pxReturn = prvFreeStackPop();
+
+                    if( ( pxReturn != NULL ) ||
+                        ( xTaskCheckForTimeOut( &xTimeOut, &xRemainingTime ) != pdFALSE ) )
+                    {
+                        break;
+                    }
+
+                    ( void ) xSemaphoreTake( xNetworkBufferSemaphore, xRemainingTime );
                 }
 
+                ( void ) Atomic_Decrement_u32( &ulWaitingTasks );
+            }
+
+            if( pxReturn != NULL )
+            {
+                ucIsFree[ pxReturn - xNetworkBuffers ] = 0U;
+                prvUpdateMinimumFree();
+
                 pxReturn->xDataLength = xRequestedSizeBytes;
 
                 #if ( ipconfigTCP_IP_SANITY != 0 )
@@ -301,117 +637,391 @@ NetworkBufferDescriptor_t * pxGetNetworkBufferWithDescriptor( size_t xRequestedS
                         pxReturn->pxNextBuffer = NULL;
                     }
                 #endif /* ipconfigUSE_LINKED_RX_MESSAGES */
+
+                #if ( ipconfigBUFFER_HEADROOM != 0 )
+                    {
+                        /* Undo any push or pull of the previous owner. */
+                        vNetworkBufferResetFrame( pxReturn );
+                    }
+                #endif /* ipconfigBUFFER_HEADROOM */
+
+                iptraceNETWORK_BUFFER_OBTAINED( pxReturn );
+            }
+            else
+            {
+                /* lint wants to see at least a comment. */
+                iptraceFAILED_TO_OBTAIN_NETWORK_BUFFER();
             }
+        }
 
-            iptraceNETWORK_BUFFER_OBTAINED( pxReturn );
+        return pxReturn;
+    }
+    /*-----------------------------------------------------------*/
+
+    NetworkBufferDescriptor_t * pxNetworkBufferGetFromISR( size_t xRequestedSizeBytes )
+    {
+        NetworkBufferDescriptor_t * pxReturn = NULL;
+
+        /* Only take a buffer if there are at least baINTERRUPT_BUFFER_GET_THRESHOLD
+         * buffers remaining on the free list.  The caches of the tasks are not
+         * used from an interrupt. */
+        if( ulFreeStackCount > ( uint32_t ) baINTERRUPT_BUFFER_GET_THRESHOLD )
+        {
+            pxReturn = prvFreeStackPop();
+        }
+
+        if( pxReturn != NULL )
+        {
+            ucIsFree[ pxReturn - xNetworkBuffers ] = 0U;
+            pxReturn->xDataLength = xRequestedSizeBytes;
+
+            #if ( ipconfigBUFFER_HEADROOM != 0 )
+                {
+                    vNetworkBufferResetFrame( pxReturn );
+                }
+            #endif /* ipconfigBUFFER_HEADROOM */
+
+            iptraceNETWORK_BUFFER_OBTAINED_FROM_ISR( pxReturn );
         }
         else
         {
-            /* lint wants to see at least a comment. */
-            iptraceFAILED_TO_OBTAIN_NETWORK_BUFFER();
+            iptraceFAILED_TO_OBTAIN_NETWORK_BUFFER_FROM_ISR();
         }
-    }
 
-    return pxReturn;
-}
-/*-----------------------------------------------------------*/
+        return pxReturn;
+    }
+    /*-----------------------------------------------------------*/
 
-NetworkBufferDescriptor_t * pxNetworkBufferGetFromISR( size_t xRequestedSizeBytes )
-{
-    NetworkBufferDescriptor_t * pxReturn = NULL;
-
-    /* The current implementation only has a single size memory block, so
-     * the requested size parameter is not used (yet). */
-    ( void ) xRequestedSizeBytes;
-
-    /* If there is a semaphore available then there is a buffer available, but,
-     * as this is called from an interrupt, only take a buffer if there are at
-     * least baINTERRUPT_BUFFER_GET_THRESHOLD buffers remaining.  This prevents,
-     * to a certain degree at least, a rapidly executing interrupt exhausting
-     * buffer and in so doing preventing tasks from continuing. */
-    if( uxQueueMessagesWaitingFromISR( ( QueueHandle_t ) xNetworkBufferSemaphore ) > ( UBaseType_t ) baINTERRUPT_BUFFER_GET_THRESHOLD )
+    BaseType_t vNetworkBufferReleaseFromISR( NetworkBufferDescriptor_t * const pxNetworkBuffer )
     {
-        if( xSemaphoreTakeFromISR( xNetworkBufferSemaphore, NULL ) == pdPASS )
+        BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+
+        #if ( ipconfigUSE_NETWORK_BUFFER_CLONES == 1 )
+            /* Only the last reference returns the buffer to the pool. */
+            if( xNetworkBufferDropReferenceFromISR( pxNetworkBuffer, &xHigherPriorityTaskWoken ) != pdFALSE )
+        #endif
         {
-            /* Protect the structure as it is accessed from tasks and interrupts. */
-            ipconfigBUFFER_ALLOC_LOCK_FROM_ISR();
+            ucIsFree[ pxNetworkBuffer - xNetworkBuffers ] = 1U;
+            prvFreeStackPush( pxNetworkBuffer, pxNetworkBuffer, 1U );
+
+            if( ulWaitingTasks != 0U )
             {
-                pxReturn = ( NetworkBufferDescriptor_t * ) listGET_OWNER_OF_HEAD_ENTRY( &xFreeBuffersList );
-                uxListRemove( &( pxReturn->xBufferListItem ) );
+                ( void ) xSemaphoreGiveFromISR( xNetworkBufferSemaphore, &xHigherPriorityTaskWoken );
             }
-            ipconfigBUFFER_ALLOC_UNLOCK_FROM_ISR();
 
-            iptraceNETWORK_BUFFER_OBTAINED_FROM_ISR( pxReturn );
+            iptraceNETWORK_BUFFER_RELEASED( pxNetworkBuffer );
         }
+
+        return xHigherPriorityTaskWoken;
     }
+    /*-----------------------------------------------------------*/
 
-    if( pxReturn == NULL )
+    void vReleaseNetworkBufferAndDescriptor( NetworkBufferDescriptor_t * const pxNetworkBuffer )
     {
-        iptraceFAILED_TO_OBTAIN_NETWORK_BUFFER_FROM_ISR();
-    }
+        BufferCache_t * pxCache;
 
-    return pxReturn;
-}
-/*-----------------------------------------------------------*/
+        #if ( ipconfigUSE_NETWORK_BUFFER_CLONES == 1 )
+            if( xNetworkBufferDropReference( pxNetworkBuffer ) == pdFALSE )
+            {
+                /* The frame is still in use by another owner, or a clone was
+                 * released. */
+            }
+            else
+        #endif
+        if( bIsValidNetworkDescriptor( pxNetworkBuffer ) == pdFALSE_UNSIGNED )
+        {
+            FreeRTOS_debug_printf( ( "vReleaseNetworkBufferAndDescriptor: Invalid buffer %p\n", pxNetworkBuffer ) );
+        }
+        else if( ucIsFree[ pxNetworkBuffer - xNetworkBuffers ] != 0U )
+        {
+            FreeRTOS_debug_printf( ( "vReleaseNetworkBufferAndDescriptor: %p ALREADY RELEASED (now %lu)\n",
+                                     pxNetworkBuffer, uxGetNumberOfFreeNetworkBuffers() ) );
+        }
+        else
+        {
+            ucIsFree[ pxNetworkBuffer - xNetworkBuffers ] = 1U;
+            pxCache = prvGetBufferCache();
 
-BaseType_t vNetworkBufferReleaseFromISR( NetworkBufferDescriptor_t * const pxNetworkBuffer )
-{
-    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+            if( ( pxCache != NULL ) && ( ulWaitingTasks == 0U ) )
+            {
+                if( pxCache->uxCount == ( UBaseType_t ) ipconfigBUFFER_CACHE_SIZE )
+                {
+                    /* The cache is full: spill the upper half to the shared
+                     * free list at once. */
+                    prvBufferCacheSpill( pxCache, ( UBaseType_t ) ipconfigBUFFER_CACHE_SIZE / 2U );
+                }
 
-    /* Ensure the buffer is returned to the list of free buffers before the
-     * counting semaphore is 'given' to say a buffer is available. */
-    ipconfigBUFFER_ALLOC_LOCK_FROM_ISR();
-    {
-        vListInsertEnd( &xFreeBuffersList, &( pxNetworkBuffer->xBufferListItem ) );
-    }
-    ipconfigBUFFER_ALLOC_UNLOCK_FROM_ISR();
+                pxCache->pxBuffers[ pxCache->uxCount ] = pxNetworkBuffer;
+                pxCache->uxCount++;
+            }
+            else
+            {
+                if( pxCache != NULL )
+                {
+                    /* Tasks are waiting for a buffer: the buffers parked in
+                     * this cache are given back as well. */
+                    prvBufferCacheSpill( pxCache, 0U );
+                }
 
-    ( void ) xSemaphoreGiveFromISR( xNetworkBufferSemaphore, &xHigherPriorityTaskWoken );
-    iptraceNETWORK_BUFFER_RELEASED( pxNetworkBuffer );
+                /* Tasks are waiting for a buffer, or the calling task has no
+                 * cache: return the buffer to the shared free list. */
+                prvFreeStackPush( pxNetworkBuffer, pxNetworkBuffer, 1U );
 
-    return xHigherPriorityTaskWoken;
-}
-/*-----------------------------------------------------------*/
+                if( ulWaitingTasks != 0U )
+                {
+                    ( void ) xSemaphoreGive( xNetworkBufferSemaphore );
+                }
+            }
 
-void vReleaseNetworkBufferAndDescriptor( NetworkBufferDescriptor_t * const pxNetworkBuffer )
-{
-    BaseType_t xListItemAlreadyInFreeList;
+            #if ( ipconfigTCP_IP_SANITY != 0 )
+                {
+                    prvShowWarnings();
+                }
+            #endif /* ipconfigTCP_IP_SANITY */
+
+            iptraceNETWORK_BUFFER_RELEASED( pxNetworkBuffer );
+        }
+    }
+    /*-----------------------------------------------------------*/
 
-    if( bIsValidNetworkDescriptor( pxNetworkBuffer ) == pdFALSE_UNSIGNED )
+    UBaseType_t uxGetNumberOfFreeNetworkBuffers( void )
     {
-        FreeRTOS_debug_printf( ( "vReleaseNetworkBufferAndDescriptor: Invalid buffer %p\n", pxNetworkBuffer ) );
+        UBaseType_t uxCount = ( UBaseType_t ) ulFreeStackCount;
+        BaseType_t xIndex;
+
+        /* The buffers in the caches are free as well, although they can only
+         * be used by their owners. */
+        for( xIndex = 0; xIndex < ( BaseType_t ) ipconfigBUFFER_CACHE_TASKS; xIndex++ )
+        {
+            uxCount += xBufferCaches[ xIndex ].uxCount;
+        }
+
+        return uxCount;
     }
-    else
+    /*-----------------------------------------------------------*/
+
+#else /* ipconfigBUFFER_ALLOC_LOCK_FREE */
+
+    NetworkBufferDescriptor_t * pxGetNetworkBufferWithDescriptor( size_t xRequestedSizeBytes,
+                                                                  TickType_t xBlockTimeTicks )
     {
-        /* Ensure the buffer is returned to the list of free buffers before the
-         * counting semaphore is 'given' to say a buffer is available. */
-        ipconfigBUFFER_ALLOC_LOCK();
+        NetworkBufferDescriptor_t * pxReturn = NULL;
+        BaseType_t xInvalid = pdFALSE;
+        UBaseType_t uxCount;
+
+        /* The current implementation only has a single size memory block, so
+         * the requested size parameter is not used (yet). */
+        ( void ) xRequestedSizeBytes;
+
+        if( xNetworkBufferSemaphore != NULL )
         {
+            /* If there is a semaphore available, there is a network buffer
+             * available. */
+            if( xSemaphoreTake( xNetworkBufferSemaphore, xBlockTimeTicks ) == pdPASS )
+            {
+                /* Protect the structure as it is accessed from tasks and
+                 * interrupts. */
+                ipconfigBUFFER_ALLOC_LOCK();
+                {
+                    pxReturn = ( NetworkBufferDescriptor_t * ) listGET_OWNER_OF_HEAD_ENTRY( &xFreeBuffersList );
+
+                    if( ( bIsValidNetworkDescriptor( pxReturn ) != pdFALSE_UNSIGNED ) &&
+                        listIS_CONTAINED_WITHIN( &xFreeBuffersList, &( pxReturn->xBufferListItem ) ) )
+                    {
+                        ( void ) uxListRemove( &( pxReturn->xBufferListItem ) );
+                    }
+                    else
+                    {
+                        xInvalid = pdTRUE;
+                    }
+                }
+                ipconfigBUFFER_ALLOC_UNLOCK();
+
+                if( xInvalid == pdTRUE )
+                {
+                    /* _RB_ Can printf() be called from an interrupt?  (comment
+                     * above says this can be called from an interrupt too) */
+
+                    /* _HT_ The function shall not be called from an ISR. Comment
+                     * was indeed misleading. Hopefully clear now?
+                     * So the printf()is OK here. */
+                    FreeRTOS_debug_printf( ( "pxGetNetworkBufferWithDescriptor: INVALID BUFFER: %p (valid %lu)\n",
+                                             pxReturn, bIsValidNetworkDescriptor( pxReturn ) ) );
+                    pxReturn = NULL;
+                }
+                else
+                {
+                    /* Reading UBaseType_t, no critical section needed. */
+                    uxCount = listCURRENT_LIST_LENGTH( &xFreeBuffersList );
+
+                    /* For stats, latch the lowest number of network buffers since
+                     * booting. */
+                    if( uxMinimumFreeNetworkBuffers > uxCount )
+                    {
+                        uxMinimumFreeNetworkBuffers = uxCount;
+                    }
+
+                    pxReturn->xDataLength = xRequestedSizeBytes;
+
+                    #if ( ipconfigTCP_IP_SANITY != 0 )
+                        {
+                            prvShowWarnings();
+                        }
+                    #endif /* ipconfigTCP_IP_SANITY */
+
+                    #if ( ipconfigUSE_LINKED_RX_MESSAGES != 0 )
+                        {
+                            /* make sure the buffer is not linked */
+                            pxReturn->pxNextBuffer = NULL;
+                        }
+                    #endif /* ipconfigUSE_LINKED_RX_MESSAGES */
+
+                    #if ( ipconfigBUFFER_HEADROOM != 0 )
+                        {
+                            /* Undo any push or pull of the previous owner. */
+                            vNetworkBufferResetFrame( pxReturn );
+                        }
+                    #endif /* ipconfigBUFFER_HEADROOM */
+                }
+
+                iptraceNETWORK_BUFFER_OBTAINED( pxReturn );
+            }
+            else
             {
-                xListItemAlreadyInFreeList = listIS_CONTAINED_WITHIN( &xFreeBuffersList, &( pxNetworkBuffer->xBufferListItem ) );
+                /* lint wants to see at least a comment. */
+                iptraceFAILED_TO_OBTAIN_NETWORK_BUFFER();
+            }
+        }
+
+        return pxReturn;
+    }
+    /*-----------------------------------------------------------*/
 
-                if( xListItemAlreadyInFreeList == pdFALSE )
+    NetworkBufferDescriptor_t * pxNetworkBufferGetFromISR( size_t xRequestedSizeBytes )
+    {
+        NetworkBufferDescriptor_t * pxReturn = NULL;
+
+        /* The current implementation only has a single size memory block, so
+         * the requested size parameter is not used (yet). */
+        ( void ) xRequestedSizeBytes;
+
+        /* If there is a semaphore available then there is a buffer available, but,
+         * as this is called from an interrupt, only take a buffer if there are at
+         * least baINTERRUPT_BUFFER_GET_THRESHOLD buffers remaining.  This prevents,
+         * to a certain degree at least, a rapidly executing interrupt exhausting
+         * buffer and in so doing preventing tasks from continuing. */
+        if( uxQueueMessagesWaitingFromISR( ( QueueHandle_t ) xNetworkBufferSemaphore ) > ( UBaseType_t ) baINTERRUPT_BUFFER_GET_THRESHOLD )
+        {
+            if( xSemaphoreTakeFromISR( xNetworkBufferSemaphore, NULL ) == pdPASS )
+            {
+                /* Protect the structure as it is accessed from tasks and interrupts. */
+                ipconfigBUFFER_ALLOC_LOCK_FROM_ISR();
                 {
-                    vListInsertEnd( &xFreeBuffersList, &( pxNetworkBuffer->xBufferListItem ) );
+                    pxReturn = ( NetworkBufferDescriptor_t * ) listGET_OWNER_OF_HEAD_ENTRY( &xFreeBuffersList );
+                    uxListRemove( &( pxReturn->xBufferListItem ) );
                 }
+                ipconfigBUFFER_ALLOC_UNLOCK_FROM_ISR();
+
+                #if ( ipconfigBUFFER_HEADROOM != 0 )
+                    {
+                        vNetworkBufferResetFrame( pxReturn );
+                    }
+                #endif /* ipconfigBUFFER_HEADROOM */
+
+                iptraceNETWORK_BUFFER_OBTAINED_FROM_ISR( pxReturn );
             }
         }
-        ipconfigBUFFER_ALLOC_UNLOCK();
 
-        if( xListItemAlreadyInFreeList )
+        if( pxReturn == NULL )
         {
-            FreeRTOS_debug_printf( ( "vReleaseNetworkBufferAndDescriptor: %p ALREADY RELEASED (now %lu)\n",
-                                     pxNetworkBuffer, uxGetNumberOfFreeNetworkBuffers() ) );
+            iptraceFAILED_TO_OBTAIN_NETWORK_BUFFER_FROM_ISR();
+        }
+
+        return pxReturn;
+    }
+    /*-----------------------------------------------------------*/
+
+    BaseType_t vNetworkBufferReleaseFromISR( NetworkBufferDescriptor_t * const pxNetworkBuffer )
+    {
+        BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+
+        #if ( ipconfigUSE_NETWORK_BUFFER_CLONES == 1 )
+            /* Only the last reference returns the buffer to the pool. */
+            if( xNetworkBufferDropReferenceFromISR( pxNetworkBuffer, &xHigherPriorityTaskWoken ) != pdFALSE )
+        #endif
+        {
+            /* Ensure the buffer is returned to the list of free buffers before the
+             * counting semaphore is 'given' to say a buffer is available. */
+            ipconfigBUFFER_ALLOC_LOCK_FROM_ISR();
+            {
+                vListInsertEnd( &xFreeBuffersList, &( pxNetworkBuffer->xBufferListItem ) );
+            }
+            ipconfigBUFFER_ALLOC_UNLOCK_FROM_ISR();
+
+            ( void ) xSemaphoreGiveFromISR( xNetworkBufferSemaphore, &xHigherPriorityTaskWoken );
+            iptraceNETWORK_BUFFER_RELEASED( pxNetworkBuffer );
+        }
+
+        return xHigherPriorityTaskWoken;
+    }
+    /*-----------------------------------------------------------*/
+
+    void vReleaseNetworkBufferAndDescriptor( NetworkBufferDescriptor_t * const pxNetworkBuffer )
+    {
+        BaseType_t xListItemAlreadyInFreeList;
+
+        #if ( ipconfigUSE_NETWORK_BUFFER_CLONES == 1 )
+            if( xNetworkBufferDropReference( pxNetworkBuffer ) == pdFALSE )
+            {
+                /* The frame is still in use by another owner, or a clone was
+                 * released. */
+            }
+            else
+        #endif
+        if( bIsValidNetworkDescriptor( pxNetworkBuffer ) == pdFALSE_UNSIGNED )
+        {
+            FreeRTOS_debug_printf( ( "vReleaseNetworkBufferAndDescriptor: Invalid buffer %p\n", pxNetworkBuffer ) );
         }
         else
         {
-            ( void ) xSemaphoreGive( xNetworkBufferSemaphore );
-            prvShowWarnings();
+            /* Ensure the buffer is returned to the list of free buffers before the
+             * counting semaphore is 'given' to say a buffer is available. */
+            ipconfigBUFFER_ALLOC_LOCK();
+            {
+                {
+                    xListItemAlreadyInFreeList = listIS_CONTAINED_WITHIN( &xFreeBuffersList, &( pxNetworkBuffer->xBufferListItem ) );
+
+                    if( xListItemAlreadyInFreeList == pdFALSE )
+                    {
+                        vListInsertEnd( &xFreeBuffersList, &( pxNetworkBuffer->xBufferListItem ) );
+                    }
+                }
+            }
+            ipconfigBUFFER_ALLOC_UNLOCK();
+
+            if( xListItemAlreadyInFreeList )
+            {
+                FreeRTOS_debug_printf( ( "vReleaseNetworkBufferAndDescriptor: %p ALREADY RELEASED (now %lu)\n",
+                                         pxNetworkBuffer, uxGetNumberOfFreeNetworkBuffers() ) );
+            }
+            else
+            {
+                ( void ) xSemaphoreGive( xNetworkBufferSemaphore );
+                prvShowWarnings();
+            }
+
+            iptraceNETWORK_BUFFER_RELEASED( pxNetworkBuffer );
         }
+    }
+    /*-----------------------------------------------------------*/
 
-        iptraceNETWORK_BUFFER_RELEASED( pxNetworkBuffer );
+    UBaseType_t uxGetNumberOfFreeNetworkBuffers( void )
+    {
+        return listCURRENT_LIST_LENGTH( &xFreeBuffersList );
     }
-}
+    /*-----------------------------------------------------------*/
+
+#endif /* ipconfigBUFFER_ALLOC_LOCK_FREE */
 /*-----------------------------------------------------------*/
 
 UBaseType_t uxGetMinimumFreeNetworkBuffers( void )
@@ -420,11 +1030,6 @@ UBaseType_t uxGetMinimumFreeNetworkBuffers( void )
 }
 /*-----------------------------------------------------------*/
 
-UBaseType_t uxGetNumberOfFreeNetworkBuffers( void )
-{
-    return listCURRENT_LIST_LENGTH( &xFreeBuffersList );
-}
-
 NetworkBufferDescriptor_t * pxResizeNetworkBufferWithDescriptor( NetworkBufferDescriptor_t * pxNetworkBuffer,
                                                                  size_t xNewSizeBytes )
 {
@@ -434,5 +1039,18 @@ NetworkBufferDescriptor_t * pxResizeNetworkBufferWithDescriptor( NetworkBufferDe
     pxNetworkBuffer->xDataLength = xNewSizeBytes;
     return pxNetworkBuffer;
 }
+/*-----------------------------------------------------------*/
+
+#if ( ipconfigBUFFER_HEADROOM != 0 )
+
+    size_t uxGetNetworkBufferCapacity( const NetworkBufferDescriptor_t * pxNetworkBuffer )
+    {
+        /* The network interface allocates buffers of a fixed size. */
+        ( void ) pxNetworkBuffer;
+
+        return ( size_t ) ipTOTAL_ETHERNET_FRAME_SIZE;
+    }
+
+#endif /* ipconfigBUFFER_HEADROOM */
 
 /*#endif */ /* ipconfigINCLUDE_TEST_CODE */
@@ -0,0 +1,826 @@
+/*
+ * FreeRTOS+TCP V2.3.4
+ * Copyright (C) 2021 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/******************************************************************************
+*
+* See the following web page for essential buffer allocation scheme usage and
+* configuration details:
+* http://www.FreeRTOS.org/FreeRTOS-Plus/FreeRTOS_Plus_TCP/Embedded_Ethernet_Buffer_Management.html
+*
+******************************************************************************/
+
+/* Standard includes. */
+#include <stdint.h>
+#include <string.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "semphr.h"
+
+/* FreeRTOS+TCP includes. */
+#include "FreeRTOS_IP.h"
+#include "FreeRTOS_IP_Private.h"
+#include "NetworkInterface.h"
+#include "NetworkBufferManagement.h"
+
+/* This allocator divides the network buffers in up to three classes: small
+ * buffers, buffers that hold a standard Ethernet frame (MTU) and, when
+ * ipconfigNETWORK_MTU is larger than 1500, jumbo buffers.  All buffers are
+ * statically allocated, and every class has its own list of free buffers and
+ * its own counting semaphore.  A request is served from the smallest class
+ * that is large enough, or from a larger class when that one is exhausted. */
+
+/* For an Ethernet interrupt to be able to obtain a network buffer there must
+ * be at least this number of buffers available in its class. */
+#define baINTERRUPT_BUFFER_GET_THRESHOLD    ( 3 )
+
+/* The smallest network buffer that will be handed out.  ARP packets and padded
+ * short frames are written into buffers of at least this size. */
+#if defined( ipconfigETHERNET_MINIMUM_PACKET_BYTES )
+    #define baMINIMAL_BUFFER_SIZE    ( ( ( size_t ) ipconfigETHERNET_MINIMUM_PACKET_BYTES > sizeof( ARPPacket_t ) ) ? ( size_t ) ipconfigETHERNET_MINIMUM_PACKET_BYTES : sizeof( ARPPacket_t ) )
+#else
+    #define baMINIMAL_BUFFER_SIZE    sizeof( ARPPacket_t )
+#endif
+
+/* The sizes of the three classes. */
+#if ( ipconfigNETWORK_MTU > 1500 )
+    #define baMTU_CLASS_SIZE    ( 1500U + ipSIZE_OF_ETH_HEADER + ipSIZE_OF_ETH_CRC_BYTES + ipSIZE_OF_ETH_OPTIONAL_802_1Q_TAG_BYTES )
+#else
+    #define baMTU_CLASS_SIZE    ipTOTAL_ETHERNET_FRAME_SIZE
+#endif
+#define baJUMBO_CLASS_SIZE      ipTOTAL_ETHERNET_FRAME_SIZE
+
+/* The number of buffers in each class. */
+#define baSMALL_CLASS_COUNT     ( ipconfigBUFFER_CLASS_SMALL_COUNT )
+#define baJUMBO_CLASS_COUNT     ( ipconfigBUFFER_CLASS_JUMBO_COUNT )
+#define baMTU_CLASS_COUNT       ( ipconfigNUM_NETWORK_BUFFER_DESCRIPTORS - ( baSMALL_CLASS_COUNT + baJUMBO_CLASS_COUNT ) )
+
+#if ( ipconfigBUFFER_ALLOC_LOCK_FREE != 0 )
+    #error ipconfigBUFFER_ALLOC_LOCK_FREE is only supported by BufferAllocation_1.c
+#endif
+
+#if ( ipconfigBUFFER_CLASS_SMALL_SIZE < 64 )
+    #error ipconfigBUFFER_CLASS_SMALL_SIZE must be at least 64
+#endif
+
+#if ( ( ipconfigBUFFER_CLASS_SMALL_COUNT + ipconfigBUFFER_CLASS_JUMBO_COUNT ) >= ipconfigNUM_NETWORK_BUFFER_DESCRIPTORS )
+    #error At least one network buffer must be left for the MTU class
+#endif
+
+#if ( ipconfigNETWORK_MTU > 1500 ) && ( ipconfigBUFFER_CLASS_JUMBO_COUNT == 0 )
+    #error ipconfigBUFFER_CLASS_JUMBO_COUNT must be at least 1 when ipconfigNETWORK_MTU is larger than 1500
+#endif
+
+#if ( ipconfigNETWORK_MTU <= 1500 ) && ( ipconfigBUFFER_CLASS_JUMBO_COUNT != 0 )
+    #error Jumbo buffers are only used when ipconfigNETWORK_MTU is larger than 1500
+#endif
+
+/* Each buffer is preceded by ipBUFFER_PADDING bytes, which hold a pointer to
+ * its descriptor.  The slots are rounded up to a multiple of 8 bytes so that
+ * every buffer has the same alignment. */
+#define baSLOT_SIZE( xSize )    ( ( ( ( size_t ) ( xSize ) + ipBUFFER_PADDING ) + 7U ) & ~( ( size_t ) 7U ) )
+
+#define baSTORAGE_BYTES                                                       \
+    ( ( ( size_t ) baSMALL_CLASS_COUNT * baSLOT_SIZE( ipconfigBUFFER_CLASS_SMALL_SIZE ) ) + \
+      ( ( size_t ) baMTU_CLASS_COUNT * baSLOT_SIZE( baMTU_CLASS_SIZE ) ) +                  \
+      ( ( size_t ) baJUMBO_CLASS_COUNT * baSLOT_SIZE( baJUMBO_CLASS_SIZE ) ) )
+
+/** @brief The administration of a single size class. */
+typedef struct xBUFFER_CLASS
+{
+    List_t xFreeBuffersList;      /**< The free descriptors of this class. */
+    SemaphoreHandle_t xSemaphore; /**< Counts the number of free descriptors. */
+    size_t uxBufferSize;          /**< The capacity of each buffer, not counting ipBUFFER_PADDING. */
+    UBaseType_t uxCount;          /**< The number of buffers in this class, may be zero. */
+    UBaseType_t uxMinimumFree;    /**< The lowest number of free buffers since booting. */
+    uint32_t ulAllocations;       /**< The number of buffers handed out. */
+    uint32_t ulFallbacks;         /**< The number of buffers handed out for a smaller request. */
+    uint32_t ulFailures;          /**< The number of requests that could not be served. */
+} BufferClass_t;
+
+/* The three size classes, ordered from small to large. */
+static BufferClass_t xBufferClasses[ ipBUFFER_CLASS_COUNT ];
+
+/* Some statistics about the use of buffers. */
+static UBaseType_t uxMinimumFreeNetworkBuffers = 0U;
+
+/* Declares the pool of NetworkBufferDescriptor_t structures that are available
+ * to the system.  The descriptors of the small class come first, followed by
+ * those of the MTU and the jumbo class.  Each descriptor is bound to a fixed
+ * slot in uxBufferStorage[]. */
+static NetworkBufferDescriptor_t xNetworkBuffers[ ipconfigNUM_NETWORK_BUFFER_DESCRIPTORS ];
+
+/* The RAM of all network buffers.  uintptr_t is used to get a proper alignment
+ * for the descriptor pointers in the padding area. */
+static uintptr_t uxBufferStorage[ ( baSTORAGE_BYTES + sizeof( uintptr_t ) - 1U ) / sizeof( uintptr_t ) ];
+
+/* This constant is defined as false to let FreeRTOS_TCP_IP.c know that the
+ * network buffers have a variable size, and may have to be resized. */
+const BaseType_t xBufferAllocFixedSize = pdFALSE;
+
+/* Set to pdTRUE once xNetworkBuffersInitialise() has succeeded. */
+static BaseType_t xBuffersInitialised = pdFALSE;
+
+#if ( ipconfigTCP_IP_SANITY != 0 )
+    UBaseType_t bIsValidNetworkDescriptor( const NetworkBufferDescriptor_t * pxDesc );
+#else
+    static UBaseType_t bIsValidNetworkDescriptor( const NetworkBufferDescriptor_t * pxDesc );
+#endif /* ipconfigTCP_IP_SANITY */
+
+/*
+ * Return the class to which a descriptor belongs.
+ */
+static BufferClass_t * prvGetBufferClass( const NetworkBufferDescriptor_t * pxDesc );
+
+/*
+ * Return the index of the smallest non-empty class that can hold a buffer of
+ * the given size, or -1 when the size is too large.
+ */
+static BaseType_t prvGetClassIndex( size_t uxRequestedSizeBytes );
+
+/*
+ * Take a descriptor from the free list of a class.  The semaphore of the
+ * class must have been taken already.
+ */
+static NetworkBufferDescriptor_t * prvTakeFromClass( BufferClass_t * pxClass );
+
+/* The user can define their own ipconfigBUFFER_ALLOC_LOCK() and
+ * ipconfigBUFFER_ALLOC_UNLOCK() macros, especially for use form an ISR.  If these
+ * are not defined then default them to call the normal enter/exit critical
+ * section macros. */
+#if !defined( ipconfigBUFFER_ALLOC_LOCK )
+
+    #define ipconfigBUFFER_ALLOC_INIT()    do {} while( ipFALSE_BOOL )
+    #define ipconfigBUFFER_ALLOC_LOCK_FROM_ISR()                                            \
+    UBaseType_t uxSavedInterruptStatus = ( UBaseType_t ) portSET_INTERRUPT_MASK_FROM_ISR(); \
+    {
+    #define ipconfigBUFFER_ALLOC_UNLOCK_FROM_ISR()               \
+    portCLEAR_INTERRUPT_MASK_FROM_ISR( uxSavedInterruptStatus ); \
+    }
+
+    #define ipconfigBUFFER_ALLOC_LOCK()      taskENTER_CRITICAL()
+    #define ipconfigBUFFER_ALLOC_UNLOCK()    taskEXIT_CRITICAL()
+
+#endif /* ipconfigBUFFER_ALLOC_LOCK */
+
+/*-----------------------------------------------------------*/
+
+#if ( ipconfigTCP_IP_SANITY != 0 )
+
+    BaseType_t prvIsFreeBuffer( const NetworkBufferDescriptor_t * pxDescr )
+    {
+        return ( bIsValidNetworkDescriptor( pxDescr ) != 0 ) &&
+               ( listIS_CONTAINED_WITHIN( &( prvGetBufferClass( pxDescr )->xFreeBuffersList ), &( pxDescr->xBufferListItem ) ) != 0 );
+    }
+    /*-----------------------------------------------------------*/
+
+    UBaseType_t bIsValidNetworkDescriptor( const NetworkBufferDescriptor_t * pxDesc )
+    {
+        uint32_t offset = ( uint32_t ) ( ( ( const char * ) pxDesc ) - ( ( const char * ) xNetworkBuffers ) );
+
+        if( ( offset >= sizeof( xNetworkBuffers ) ) ||
+            ( ( offset % sizeof( xNetworkBuffers[ 0 ] ) ) != 0 ) )
+        {
+            return pdFALSE;
+        }
+
+        return ( UBaseType_t ) ( pxDesc - xNetworkBuffers ) + 1;
+    }
+    /*-----------------------------------------------------------*/
+
+#else /* if ( ipconfigTCP_IP_SANITY != 0 ) */
+    static UBaseType_t bIsValidNetworkDescriptor( const NetworkBufferDescriptor_t * pxDesc )
+    {
+        ( void ) pxDesc;
+        return ( UBaseType_t ) pdTRUE;
+    }
+    /*-----------------------------------------------------------*/
+
+#endif /* ipconfigTCP_IP_SANITY */
+
+/**
+ * @brief Return the class to which a descriptor belongs.  The descriptors of
+ *        each class occupy a contiguous range of xNetworkBuffers[].
+ *
+ * @param[in] pxDesc: The network buffer descriptor.
+ *
+ * @return The size class of the descriptor.
+ */
+static BufferClass_t * prvGetBufferClass( const NetworkBufferDescriptor_t * pxDesc )
+{
+    BaseType_t xIndex = ipBUFFER_CLASS_SMALL;
+    UBaseType_t uxPosition;
+    UBaseType_t uxLimit = xBufferClasses[ ipBUFFER_CLASS_SMALL ].uxCount;
+
+    #if ( ipconfigUSE_NETWORK_BUFFER_CLONES == 1 )
+        {
+            /* A clone has the size of the buffer whose frame it shares. */
+            if( pxDesc->pxParent != NULL )
+            {
+                pxDesc = pxDesc->pxParent;
+            }
+        }
+    #endif
+
+    uxPosition = ( UBaseType_t ) ( pxDesc - xNetworkBuffers );
+
+    while( ( xIndex < ( ipBUFFER_CLASS_COUNT - 1 ) ) && ( uxPosition >= uxLimit ) )
+    {
+        xIndex++;
+        uxLimit += xBufferClasses[ xIndex ].uxCount;
+    }
+
+    return &( xBufferClasses[ xIndex ] );
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Find the smallest non-empty class that can hold the requested size.
+ *
+ * @param[in] uxRequestedSizeBytes: The number of bytes requested.
+ *
+ * @return The index of the class, or -1 when no class is large enough.
+ */
+static BaseType_t prvGetClassIndex( size_t uxRequestedSizeBytes )
+{
+    BaseType_t xIndex;
+    BaseType_t xReturn = -1;
+
+    for( xIndex = 0; xIndex < ipBUFFER_CLASS_COUNT; xIndex++ )
+    {
+        if( ( xBufferClasses[ xIndex ].uxCount > 0U ) &&
+            ( xBufferClasses[ xIndex ].uxBufferSize >= uxRequestedSizeBytes ) )
+        {
+            xReturn = xIndex;
+            break;
+        }
+    }
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Take a descriptor from the free list of a class, after its semaphore
+ *        has been obtained.
+ *
+ * @param[in] pxClass: The size class.
+ *
+ * @return The descriptor, or NULL when the free list turns out to be corrupted.
+ */
+static NetworkBufferDescriptor_t * prvTakeFromClass( BufferClass_t * pxClass )
+{
+    NetworkBufferDescriptor_t * pxReturn;
+    BaseType_t xInvalid = pdFALSE;
+    UBaseType_t uxCount;
+
+    /* Protect the structure as it is accessed from tasks and
+     * interrupts. */
+    ipconfigBUFFER_ALLOC_LOCK();
+    {
+        pxReturn = ( NetworkBufferDescriptor_t * ) listGET_OWNER_OF_HEAD_ENTRY( &( pxClass->xFreeBuffersList ) );
+
+        if( ( bIsValidNetworkDescriptor( pxReturn ) != pdFALSE_UNSIGNED ) &&
+            listIS_CONTAINED_WITHIN( &( pxClass->xFreeBuffersList ), &( pxReturn->xBufferListItem ) ) )
+        {
+            ( void ) uxListRemove( &( pxReturn->xBufferListItem ) );
+            pxClass->ulAllocations++;
+        }
+        else
+        {
+            xInvalid = pdTRUE;
+        }
+    }
+    ipconfigBUFFER_ALLOC_UNLOCK();
+
+    if( xInvalid == pdTRUE )
+    {
+        FreeRTOS_debug_printf( ( "pxGetNetworkBufferWithDescriptor: INVALID BUFFER: %p (valid %lu)\n",
+                                 pxReturn, bIsValidNetworkDescriptor( pxReturn ) ) );
+        pxReturn = NULL;
+    }
+    else
+    {
+        /* Reading UBaseType_t, no critical section needed. */
+        uxCount = listCURRENT_LIST_LENGTH( &( pxClass->xFreeBuffersList ) );
+
+        /* For stats, latch the lowest number of network buffers since
+         * booting. */
+        if( pxClass->uxMinimumFree > uxCount )
+        {
+            pxClass->uxMinimumFree = uxCount;
+        }
+
+        uxCount = uxGetNumberOfFreeNetworkBuffers();
+
+        if( uxMinimumFreeNetworkBuffers > uxCount )
+        {
+            uxMinimumFreeNetworkBuffers = uxCount;
+        }
+
+        #if ( ipconfigUSE_LINKED_RX_MESSAGES != 0 )
+            {
+                /* make sure the buffer is not linked */
+                pxReturn->pxNextBuffer = NULL;
+            }
+        #endif /* ipconfigUSE_LINKED_RX_MESSAGES */
+
+        #if ( ipconfigBUFFER_HEADROOM != 0 )
+            {
+                /* Undo any push or pull of the previous owner. */
+                vNetworkBufferResetFrame( pxReturn );
+            }
+        #endif /* ipconfigBUFFER_HEADROOM */
+    }
+
+    return pxReturn;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xNetworkBuffersInitialise( void )
+{
+    BaseType_t xReturn = pdPASS;
+    BaseType_t xIndex;
+    BufferClass_t * pxClass;
+    NetworkBufferDescriptor_t * pxDescriptor;
+    uint8_t * pucSlot;
+    size_t uxSlotSize;
+    UBaseType_t uxBuffer;
+
+    /* Only initialise the buffers and their associated kernel objects if they
+     * have not been initialised before. */
+    if( xBuffersInitialised == pdFALSE )
+    {
+        /* In case alternative locking is used, the mutexes can be initialised
+         * here */
+        ipconfigBUFFER_ALLOC_INIT();
+
+        xBufferClasses[ ipBUFFER_CLASS_SMALL ].uxBufferSize = ( size_t ) ipconfigBUFFER_CLASS_SMALL_SIZE;
+        xBufferClasses[ ipBUFFER_CLASS_SMALL ].uxCount = ( UBaseType_t ) baSMALL_CLASS_COUNT;
+        xBufferClasses[ ipBUFFER_CLASS_MTU ].uxBufferSize = ( size_t ) baMTU_CLASS_SIZE;
+        xBufferClasses[ ipBUFFER_CLASS_MTU ].uxCount = ( UBaseType_t ) baMTU_CLASS_COUNT;
+        xBufferClasses[ ipBUFFER_CLASS_JUMBO ].uxBufferSize = ( size_t ) baJUMBO_CLASS_SIZE;
+        xBufferClasses[ ipBUFFER_CLASS_JUMBO ].uxCount = ( UBaseType_t ) baJUMBO_CLASS_COUNT;
+
+        pxDescriptor = xNetworkBuffers;
+        pucSlot = ( uint8_t * ) uxBufferStorage;
+
+        for( xIndex = 0; xIndex < ipBUFFER_CLASS_COUNT; xIndex++ )
+        {
+            pxClass = &( xBufferClasses[ xIndex ] );
+            pxClass->uxMinimumFree = pxClass->uxCount;
+            vListInitialise( &( pxClass->xFreeBuffersList ) );
+
+            /* An unused class does not need a semaphore. */
+            if( pxClass->uxCount > 0U )
+            {
+                #if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+                    {
+                        static StaticSemaphore_t xNetworkBufferSemaphoreBuffers[ ipBUFFER_CLASS_COUNT ];
+                        pxClass->xSemaphore = xSemaphoreCreateCountingStatic( pxClass->uxCount,
+                                                                              pxClass->uxCount,
+                                                                              &( xNetworkBufferSemaphoreBuffers[ xIndex ] ) );
+                    }
+                #else
+                    {
+                        pxClass->xSemaphore = xSemaphoreCreateCounting( pxClass->uxCount, pxClass->uxCount );
+                    }
+                #endif /* configSUPPORT_STATIC_ALLOCATION */
+
+                configASSERT( pxClass->xSemaphore != NULL );
+
+                if( pxClass->xSemaphore == NULL )
+                {
+                    xReturn = pdFAIL;
+                    break;
+                }
+
+                uxSlotSize = baSLOT_SIZE( pxClass->uxBufferSize );
+
+                for( uxBuffer = 0U; uxBuffer < pxClass->uxCount; uxBuffer++ )
+                {
+                    /* Bind the descriptor to its slot, and store a pointer to the
+                     * descriptor in the padding area in front of the buffer. */
+                    *( ( NetworkBufferDescriptor_t ** ) pucSlot ) = pxDescriptor;
+                    pxDescriptor->pucEthernetBuffer = &( pucSlot[ ipBUFFER_PADDING ] );
+
+                    /* Initialise and set the owner of the buffer list items. */
+                    vListInitialiseItem( &( pxDescriptor->xBufferListItem ) );
+                    listSET_LIST_ITEM_OWNER( &( pxDescriptor->xBufferListItem ), pxDescriptor );
+
+                    /* Currently, all buffers are available for use. */
+                    vListInsert( &( pxClass->xFreeBuffersList ), &( pxDescriptor->xBufferListItem ) );
+
+                    pxDescriptor++;
+                    pucSlot = &( pucSlot[ uxSlotSize ] );
+                }
+            }
+        }
+
+        if( xReturn == pdPASS )
+        {
+            uxMinimumFreeNetworkBuffers = ( UBaseType_t ) ipconfigNUM_NETWORK_BUFFER_DESCRIPTORS;
+            xBuffersInitialised = pdTRUE;
+        }
+    }
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+NetworkBufferDescriptor_t * pxGetNetworkBufferWithDescriptor( size_t xRequestedSizeBytes,
+                                                              TickType_t xBlockTimeTicks )
+{
+    NetworkBufferDescriptor_t * pxReturn = NULL;
+    BufferClass_t * pxClass;
+    BaseType_t xFirst;
+    BaseType_t xIndex;
+    size_t uxSize = xRequestedSizeBytes;
+
+    if( uxSize < baMINIMAL_BUFFER_SIZE )
+    {
+        uxSize = baMINIMAL_BUFFER_SIZE;
+    }
+
+    xFirst = prvGetClassIndex( uxSize );
+
+    if( ( xBuffersInitialised != pdFALSE ) && ( xFirst >= 0 ) )
+    {
+        /* First try all classes that are large enough, without blocking.  A
+         * buffer of a larger class is better than no buffer at all. */
+        for( xIndex = xFirst; xIndex < ipBUFFER_CLASS_COUNT; xIndex++ )
+        {
+            pxClass = &( xBufferClasses[ xIndex ] );
+
+            if( ( pxClass->uxCount > 0U ) && ( xSemaphoreTake( pxClass->xSemaphore, 0U ) == pdPASS ) )
+            {
+                pxReturn = prvTakeFromClass( pxClass );
+
+                if( ( pxReturn != NULL ) && ( xIndex != xFirst ) )
+                {
+                    pxClass->ulFallbacks++;
+                }
+
+                break;
+            }
+        }
+
+        /* All classes are exhausted, wait for a buffer of the preferred class. */
+        if( ( xIndex == ipBUFFER_CLASS_COUNT ) && ( xBlockTimeTicks != ( TickType_t ) 0U ) )
+        {
+            pxClass = &( xBufferClasses[ xFirst ] );
+
+            if( xSemaphoreTake( pxClass->xSemaphore, xBlockTimeTicks ) == pdPASS )
+            {
+                pxReturn = prvTakeFromClass( pxClass );
+            }
+        }
+
+        if( pxReturn == NULL )
+        {
+            xBufferClasses[ xFirst ].ulFailures++;
+        }
+    }
+
+    if( pxReturn != NULL )
+    {
+        pxReturn->xDataLength = xRequestedSizeBytes;
+        iptraceNETWORK_BUFFER_OBTAINED( pxReturn );
+    }
+    else
+    {
+        /* lint wants to see at least a comment. */
+        iptraceFAILED_TO_OBTAIN_NETWORK_BUFFER();
+    }
+
+    return pxReturn;
+}
+/*-----------------------------------------------------------*/
+
+NetworkBufferDescriptor_t * pxNetworkBufferGetFromISR( size_t xRequestedSizeBytes )
+{
+    NetworkBufferDescriptor_t * pxReturn = NULL;
+    BufferClass_t * pxClass;
+    BaseType_t xIndex;
+    size_t uxSize = xRequestedSizeBytes;
+
+    if( uxSize < baMINIMAL_BUFFER_SIZE )
+    {
+        uxSize = baMINIMAL_BUFFER_SIZE;
+    }
+
+    xIndex = prvGetClassIndex( uxSize );
+
+    if( ( xBuffersInitialised != pdFALSE ) && ( xIndex >= 0 ) )
+    {
+        pxClass = &( xBufferClasses[ xIndex ] );
+
+        /* If there is a semaphore available then there is a buffer available, but,
+         * as this is called from an interrupt, only take a buffer if there are at
+         * least baINTERRUPT_BUFFER_GET_THRESHOLD buffers remaining in the class.
+         * This prevents, to a certain degree at least, a rapidly executing
+         * interrupt exhausting buffer and in so doing preventing tasks from
+         * continuing. */
+        if( uxQueueMessagesWaitingFromISR( ( QueueHandle_t ) pxClass->xSemaphore ) > ( UBaseType_t ) baINTERRUPT_BUFFER_GET_THRESHOLD )
+        {
+            if( xSemaphoreTakeFromISR( pxClass->xSemaphore, NULL ) == pdPASS )
+            {
+                /* Protect the structure as it is accessed from tasks and interrupts. */
+                ipconfigBUFFER_ALLOC_LOCK_FROM_ISR();
+                {
+                    pxReturn = ( NetworkBufferDescriptor_t * ) listGET_OWNER_OF_HEAD_ENTRY( &( pxClass->xFreeBuffersList ) );
+                    ( void ) uxListRemove( &( pxReturn->xBufferListItem ) );
+                    pxClass->ulAllocations++;
+                }
+                ipconfigBUFFER_ALLOC_UNLOCK_FROM_ISR();
+
+                pxReturn->xDataLength = xRequestedSizeBytes;
+
+                #if ( ipconfigBUFFER_HEADROOM != 0 )
+                    {
+                        vNetworkBufferResetFrame( pxReturn );
+                    }
+                #endif /* ipconfigBUFFER_HEADROOM */
+
+                iptraceNETWORK_BUFFER_OBTAINED_FROM_ISR( pxReturn );
+            }
+        }
+    }
+
+    if( pxReturn == NULL )
+    {
+        iptraceFAILED_TO_OBTAIN_NETWORK_BUFFER_FROM_ISR();
+    }
+
+    return pxReturn;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t vNetworkBufferReleaseFromISR( NetworkBufferDescriptor_t * const pxNetworkBuffer )
+{
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+    BufferClass_t * pxClass;
+
+    #if ( ipconfigUSE_NETWORK_BUFFER_CLONES == 1 )
+        /* Only the last reference returns the buffer to its pool. */
+        if( xNetworkBufferDropReferenceFromISR( pxNetworkBuffer, &xHigherPriorityTaskWoken ) != pdFALSE )
+    #endif
+    {
+        pxClass = prvGetBufferClass( pxNetworkBuffer );
+
+        /* Ensure the buffer is returned to the list of free buffers before the
+         * counting semaphore is 'given' to say a buffer is available. */
+        ipconfigBUFFER_ALLOC_LOCK_FROM_ISR();
+        {
+            vListInsertEnd( &( pxClass->xFreeBuffersList ), &( pxNetworkBuffer->xBufferListItem ) );
+        }
+        ipconfigBUFFER_ALLOC_UNLOCK_FROM_ISR();
+
+        ( void ) xSemaphoreGiveFromISR( pxClass->xSemaphore, &xHigherPriorityTaskWoken );
+        iptraceNETWORK_BUFFER_RELEASED( pxNetworkBuffer );
+    }
+
+    return xHigherPriorityTaskWoken;
+}
+/*-----------------------------------------------------------*/
+
+void vReleaseNetworkBufferAndDescriptor( NetworkBufferDescriptor_t * const pxNetworkBuffer )
+{
+    BaseType_t xListItemAlreadyInFreeList;
+    BufferClass_t * pxClass;
+
+    #if ( ipconfigUSE_NETWORK_BUFFER_CLONES == 1 )
+        if( xNetworkBufferDropReference( pxNetworkBuffer ) == pdFALSE )
+        {
+            /* The frame is still in use by another owner, or a clone was
+             * released. */
+        }
+        else
+    #endif
+    if( bIsValidNetworkDescriptor( pxNetworkBuffer ) == pdFALSE_UNSIGNED )
+    {
+        FreeRTOS_debug_printf( ( "vReleaseNetworkBufferAndDescriptor: Invalid buffer %p\n", pxNetworkBuffer ) );
+    }
+    else
+    {
+        pxClass = prvGetBufferClass( pxNetworkBuffer );
+
+        /* Ensure the buffer is returned to the list of free buffers before the
+         * counting semaphore is 'given' to say a buffer is available. */
+        ipconfigBUFFER_ALLOC_LOCK();
+        {
+            xListItemAlreadyInFreeList = listIS_CONTAINED_WITHIN( &( pxClass->xFreeBuffersList ), &( pxNetworkBuffer->xBufferListItem ) );
+
+            if( xListItemAlreadyInFreeList == pdFALSE )
+            {
+                vListInsertEnd( &( pxClass->xFreeBuffersList ), &( pxNetworkBuffer->xBufferListItem ) );
+            }
+        }
+        ipconfigBUFFER_ALLOC_UNLOCK();
+
+        if( xListItemAlreadyInFreeList )
+        {
+            FreeRTOS_debug_printf( ( "vReleaseNetworkBufferAndDescriptor: %p ALREADY RELEASED (now %lu)\n",
+                                     pxNetworkBuffer, uxGetNumberOfFreeNetworkBuffers() ) );
+        }
+        else
+        {
+            ( void ) xSemaphoreGive( pxClass->xSemaphore );
+        }
+
+        iptraceNETWORK_BUFFER_RELEASED( pxNetworkBuffer );
+    }
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Obtain a network buffer without using its descriptor.  The buffer is
+ *        taken from the same pools as pxGetNetworkBufferWithDescriptor() uses.
+ *
+ * @param[in,out] pxRequestedSizeBytes: The number of bytes needed.  It will be
+ *                set to the capacity of the buffer returned.
+ *
+ * @return A pointer to the buffer, or NULL when no buffer was available.
+ */
+uint8_t * pucGetNetworkBuffer( size_t * pxRequestedSizeBytes )
+{
+    NetworkBufferDescriptor_t * pxDescriptor;
+    uint8_t * pucReturn = NULL;
+
+    pxDescriptor = pxGetNetworkBufferWithDescriptor( *pxRequestedSizeBytes, 0U );
+
+    if( pxDescriptor != NULL )
+    {
+        *pxRequestedSizeBytes = prvGetBufferClass( pxDescriptor )->uxBufferSize;
+        pucReturn = pxDescriptor->pucEthernetBuffer;
+    }
+
+    return pucReturn;
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Release a buffer that was obtained with pucGetNetworkBuffer().
+ *
+ * @param[in] pucEthernetBuffer: The buffer to be released.
+ */
+void vReleaseNetworkBuffer( uint8_t * pucEthernetBuffer )
+{
+    NetworkBufferDescriptor_t * pxDescriptor;
+
+    if( pucEthernetBuffer != NULL )
+    {
+        /* The padding area in front of the buffer points to its descriptor. */
+        pxDescriptor = *( ( NetworkBufferDescriptor_t ** ) ( pucEthernetBuffer - ipBUFFER_PADDING ) );
+        vReleaseNetworkBufferAndDescriptor( pxDescriptor );
+    }
+}
+/*-----------------------------------------------------------*/
+
+UBaseType_t uxGetMinimumFreeNetworkBuffers( void )
+{
+    return uxMinimumFreeNetworkBuffers;
+}
+/*-----------------------------------------------------------*/
+
+UBaseType_t uxGetNumberOfFreeNetworkBuffers( void )
+{
+    BaseType_t xIndex;
+    UBaseType_t uxCount = 0U;
+
+    for( xIndex = 0; xIndex < ipBUFFER_CLASS_COUNT; xIndex++ )
+    {
+        uxCount += listCURRENT_LIST_LENGTH( &( xBufferClasses[ xIndex ].xFreeBuffersList ) );
+    }
+
+    return uxCount;
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Get the statistics of one of the size classes.
+ *
+ * @param[in] xClass: ipBUFFER_CLASS_SMALL, ipBUFFER_CLASS_MTU or ipBUFFER_CLASS_JUMBO.
+ * @param[out] pxStats: The statistics will be written here.
+ *
+ * @return pdPASS when the class exists, otherwise pdFAIL.
+ */
+BaseType_t xGetNetworkBufferClassStats( BaseType_t xClass,
+                                        NetworkBufferClassStats_t * pxStats )
+{
+    const BufferClass_t * pxClass;
+    BaseType_t xReturn = pdFAIL;
+
+    if( ( xClass >= 0 ) && ( xClass < ipBUFFER_CLASS_COUNT ) && ( pxStats != NULL ) )
+    {
+        pxClass = &( xBufferClasses[ xClass ] );
+
+        ipconfigBUFFER_ALLOC_LOCK();
+        {
+            pxStats->uxBufferSize = pxClass->uxBufferSize;
+            pxStats->uxTotal = pxClass->uxCount;
+            pxStats->uxFree = listCURRENT_LIST_LENGTH( &( pxClass->xFreeBuffersList ) );
+            pxStats->uxMinimumFree = pxClass->uxMinimumFree;
+            pxStats->ulAllocations = pxClass->ulAllocations;
+            pxStats->ulFallbacks = pxClass->ulFallbacks;
+            pxStats->ulFailures = pxClass->ulFailures;
+        }
+        ipconfigBUFFER_ALLOC_UNLOCK();
+
+        xReturn = pdPASS;
+    }
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+#if ( ipconfigBUFFER_HEADROOM != 0 )
+
+/**
+ * @brief Get the capacity of a network buffer, which depends on its class.
+ *
+ * @param[in] pxNetworkBuffer: The network buffer.
+ *
+ * @return The number of bytes the buffer can hold in its default position.
+ */
+    size_t uxGetNetworkBufferCapacity( const NetworkBufferDescriptor_t * pxNetworkBuffer )
+    {
+        return prvGetBufferClass( pxNetworkBuffer )->uxBufferSize;
+    }
+    /*-----------------------------------------------------------*/
+
+#endif /* ipconfigBUFFER_HEADROOM */
+
+/**
+ * @brief Change the length of a network buffer.  When the new length does not
+ *        fit in the buffer, a buffer of a larger class is obtained, the data is
+ *        copied and the original buffer is released.
+ *
+ * @param[in] pxNetworkBuffer: The network buffer.
+ * @param[in] xNewSizeBytes: The new length in bytes.
+ *
+ * @return The buffer that holds the data, or NULL when no larger buffer was
+ *         available.  In that case the original buffer is not released.
+ */
+NetworkBufferDescriptor_t * pxResizeNetworkBufferWithDescriptor( NetworkBufferDescriptor_t * pxNetworkBuffer,
+                                                                 size_t xNewSizeBytes )
+{
+    NetworkBufferDescriptor_t * pxReturn;
+    size_t uxCopyLength;
+
+    if( xNewSizeBytes <= prvGetBufferClass( pxNetworkBuffer )->uxBufferSize )
+    {
+        /* The buffer is big enough already. */
+        pxNetworkBuffer->xDataLength = xNewSizeBytes;
+        pxReturn = pxNetworkBuffer;
+    }
+    else
+    {
+        pxReturn = pxGetNetworkBufferWithDescriptor( xNewSizeBytes, 0U );
+
+        if( pxReturn != NULL )
+        {
+            uxCopyLength = pxNetworkBuffer->xDataLength;
+
+            if( uxCopyLength > xNewSizeBytes )
+            {
+                uxCopyLength = xNewSizeBytes;
+            }
+
+            /* Copy the original packet information. */
+            pxReturn->ulIPAddress = pxNetworkBuffer->ulIPAddress;
+            pxReturn->usPort = pxNetworkBuffer->usPort;
+            pxReturn->usBoundPort = pxNetworkBuffer->usBoundPort;
+            ( void ) memcpy( pxReturn->pucEthernetBuffer, pxNetworkBuffer->pucEthernetBuffer, uxCopyLength );
+
+            vReleaseNetworkBufferAndDescriptor( pxNetworkBuffer );
+        }
+    }
+
+    return pxReturn;
+}
+/*-----------------------------------------------------------*/
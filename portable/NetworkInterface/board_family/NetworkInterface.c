@@ -51,6 +51,11 @@
 TaskHandle_t xLanderUARTTaskHandle = NULL;
 UARTtransferStatus xLanderUARTTransferStatus = done_uart;
 
+#if ( ipconfigUSE_BUFFER_PRESSURE == 1 ) && ( ipconfigBUFFER_PRESSURE_DRIVER_HOOK == 1 )
+    /* The pressure on the network buffers, as reported by the IP-task. */
+    static volatile eBufferPressure_t eRxBufferPressure = eBufferPressureNone;
+#endif
+
 
 /* 1536 bytes is more than needed, 1524 would be enough.
  * But 1536 is a multiple of 32, which gives a great alignment for cached memories. */
@@ -172,6 +177,13 @@ void vNetworkInterfaceAllocateRAMToBuffers( NetworkBufferDescriptor_t pxNetworkB
     }
 }
 
+#if ( ipconfigUSE_BUFFER_PRESSURE == 1 ) && ( ipconfigBUFFER_PRESSURE_DRIVER_HOOK == 1 )
+    void vNetworkInterfaceBufferPressure( eBufferPressure_t eState )
+    {
+        eRxBufferPressure = eState;
+    }
+#endif
+
 static void prvLanderUARTHandlerTask( void * pvParameters )
 {
     int retValInt = 0;
@@ -205,6 +217,16 @@ static void prvLanderUARTHandlerTask( void * pvParameters )
         decodeBuffer[xBytesReceived++] = readData;
 
 
+        #if ( ipconfigUSE_BUFFER_PRESSURE == 1 ) && ( ipconfigBUFFER_PRESSURE_DRIVER_HOOK == 1 )
+            if( ( readData == SLIP_END ) && ( eRxBufferPressure == eBufferPressureCritical ) )
+            {
+                /* Hardly any network buffers are left: drop the frame now
+                 * instead of after it has been decoded and processed. */
+                xBytesReceived = 0;
+                iptraceETHERNET_RX_DROPPED_UNDER_PRESSURE();
+            }
+            else
+        #endif
         // Check for end of packet or wait for the end
         if(readData == SLIP_END && xBytesReceived>1)
         {
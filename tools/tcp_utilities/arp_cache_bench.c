@@ -0,0 +1,198 @@
+/*
+ * FreeRTOS+TCP V2.3.4
+ * Copyright (C) 2021 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/*
+ * arp_cache_bench.c
+ * Measure how many look-ups and refreshes the ARP cache can do per tick, with
+ * a given number of peers.  See arp_cache_bench.md.
+ */
+
+/* Standard includes. */
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* FreeRTOS+TCP includes. */
+#include "FreeRTOS_IP.h"
+#include "FreeRTOS_Sockets.h"
+#include "FreeRTOS_IP_Private.h"
+#include "FreeRTOS_ARP.h"
+
+#include "arp_cache_bench.h"
+
+static uint32_t prvPeerAddress( UBaseType_t uxPeer );
+static void prvPeerMAC( UBaseType_t uxPeer,
+                        MACAddress_t * pxMACAddress );
+static TickType_t prvStartOfTick( void );
+/*-----------------------------------------------------------*/
+
+static uint32_t prvPeerAddress( UBaseType_t uxPeer )
+{
+    uint32_t ulNetwork = *ipLOCAL_IP_ADDRESS_POINTER & xNetworkAddressing.ulNetMask;
+    uint32_t ulHost = FreeRTOS_htonl( ( uint32_t ) uxPeer + 1U ) & ~xNetworkAddressing.ulNetMask;
+    uint32_t ulAddress = ulNetwork | ulHost;
+
+    /* Do not use the address of this device. */
+    if( ulAddress == *ipLOCAL_IP_ADDRESS_POINTER )
+    {
+        ulAddress = ulNetwork | ( FreeRTOS_htonl( ( uint32_t ) ipconfigARP_CACHE_ENTRIES + 1U ) & ~xNetworkAddressing.ulNetMask );
+    }
+
+    return ulAddress;
+}
+/*-----------------------------------------------------------*/
+
+static void prvPeerMAC( UBaseType_t uxPeer,
+                        MACAddress_t * pxMACAddress )
+{
+    /* A locally administered address. */
+    pxMACAddress->ucBytes[ 0 ] = 0x02U;
+    pxMACAddress->ucBytes[ 1 ] = 0x00U;
+    pxMACAddress->ucBytes[ 2 ] = 0x5EU;
+    pxMACAddress->ucBytes[ 3 ] = ( uint8_t ) ( uxPeer >> 16 );
+    pxMACAddress->ucBytes[ 4 ] = ( uint8_t ) ( uxPeer >> 8 );
+    pxMACAddress->ucBytes[ 5 ] = ( uint8_t ) uxPeer;
+}
+/*-----------------------------------------------------------*/
+
+static TickType_t prvStartOfTick( void )
+{
+    TickType_t xStartTime = xTaskGetTickCount();
+
+    while( xTaskGetTickCount() == xStartTime )
+    {
+    }
+
+    return xTaskGetTickCount();
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xRunARPCacheBenchmark( UBaseType_t uxPeers,
+                                  TickType_t xDuration,
+                                  ARPBenchResults_t * pxResults )
+{
+    ARPBenchResults_t xResults;
+    MACAddress_t xMACAddress, xFound;
+    uint32_t ulAddress;
+    UBaseType_t uxPeer = 0U;
+    BaseType_t xErrors = 0;
+    BaseType_t xReturn = pdFAIL;
+    TickType_t xStartTime;
+
+    if( ( uxPeers == 0U ) || ( uxPeers > ( UBaseType_t ) ipconfigARP_CACHE_ENTRIES ) )
+    {
+        FreeRTOS_printf( ( "ARP benchmark: use 1 to %u peers\n", ( unsigned ) ipconfigARP_CACHE_ENTRIES ) );
+    }
+    else if( *ipLOCAL_IP_ADDRESS_POINTER == 0UL )
+    {
+        FreeRTOS_printf( ( "ARP benchmark: the network is not up\n" ) );
+    }
+    else
+    {
+        #if ( ipconfigUSE_ARP_HASH != 1 )
+            {
+                FreeRTOS_printf( ( "ARP benchmark: ipconfigUSE_ARP_HASH is not enabled\n" ) );
+            }
+        #endif
+
+        FreeRTOS_ClearARP();
+
+        for( uxPeer = 0U; uxPeer < uxPeers; uxPeer++ )
+        {
+            prvPeerMAC( uxPeer, &( xMACAddress ) );
+            vARPRefreshCacheEntry( &( xMACAddress ), prvPeerAddress( uxPeer ) );
+        }
+
+        xResults.uxPeers = uxPeers;
+        xResults.xDuration = xDuration;
+        xResults.ulLookups = 0U;
+        xResults.ulRefreshes = 0U;
+
+        /* The look-ups of the transmit path, the peers are visited in turn. */
+        uxPeer = 0U;
+        xStartTime = prvStartOfTick();
+
+        while( ( xTaskGetTickCount() - xStartTime ) < xDuration )
+        {
+            ulAddress = prvPeerAddress( uxPeer );
+
+            if( eARPGetCacheEntry( &( ulAddress ), &( xFound ) ) != eARPCacheHit )
+            {
+                xErrors++;
+            }
+            else if( xFound.ucBytes[ 5 ] != ( uint8_t ) uxPeer )
+            {
+                xErrors++;
+            }
+            else
+            {
+                /* The entry was found. */
+            }
+
+            xResults.ulLookups++;
+            uxPeer = ( ( uxPeer + 1U ) < uxPeers ) ? ( uxPeer + 1U ) : 0U;
+        }
+
+        /* The refreshes of the receive path. */
+        uxPeer = 0U;
+        xStartTime = prvStartOfTick();
+
+        while( ( xTaskGetTickCount() - xStartTime ) < xDuration )
+        {
+            prvPeerMAC( uxPeer, &( xMACAddress ) );
+            vARPRefreshCacheEntry( &( xMACAddress ), prvPeerAddress( uxPeer ) );
+
+            xResults.ulRefreshes++;
+            uxPeer = ( ( uxPeer + 1U ) < uxPeers ) ? ( uxPeer + 1U ) : 0U;
+        }
+
+        FreeRTOS_ClearARP();
+
+        FreeRTOS_printf( ( "ARP benchmark: %u peers in %u entries, ticks %u\n",
+                           ( unsigned ) uxPeers, ( unsigned ) ipconfigARP_CACHE_ENTRIES, ( unsigned ) xDuration ) );
+        FreeRTOS_printf( ( "ARP benchmark: %lu look-ups %lu refreshes\n",
+                           ( unsigned long ) xResults.ulLookups, ( unsigned long ) xResults.ulRefreshes ) );
+
+        if( xErrors == 0 )
+        {
+            xReturn = pdPASS;
+        }
+        else
+        {
+            FreeRTOS_printf( ( "ARP benchmark: %d look-ups failed\n", ( int ) xErrors ) );
+        }
+
+        if( pxResults != NULL )
+        {
+            *pxResults = xResults;
+        }
+    }
+
+    return xReturn;
+}
@@ -0,0 +1,291 @@
+/*
+ * FreeRTOS+TCP V2.3.4
+ * Copyright (C) 2021 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/*
+ * buffer_alloc_bench.c
+ * Measure the throughput of the network buffer allocator under contention.
+ * Producer tasks obtain network buffers and pass them to consumer tasks
+ * through a queue, the consumers release them.  See buffer_alloc_bench.md.
+ */
+
+/* Standard includes. */
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "semphr.h"
+
+/* FreeRTOS+TCP includes. */
+#include "FreeRTOS_IP.h"
+#include "FreeRTOS_IP_Private.h"
+#include "NetworkBufferManagement.h"
+
+#include "buffer_alloc_bench.h"
+
+/* The size of the buffers requested, like a short TCP segment. */
+#define benchBUFFER_SIZE    ( sizeof( TCPPacket_t ) + 64U )
+
+/* Set to pdTRUE to make the tasks stop. */
+static volatile BaseType_t xBenchStop;
+
+/* The queue through which the buffers are passed. */
+static QueueHandle_t xBenchQueue;
+
+/* Given by every task when it has stopped. */
+static SemaphoreHandle_t xBenchDone;
+
+/* Counters of each task, so that no locking is needed. */
+static uint32_t ulBenchObtained[ benchMAX_TASKS ];
+static uint32_t ulBenchReleased[ benchMAX_TASKS ];
+static uint32_t ulBenchFailures[ benchMAX_TASKS ];
+
+static void prvProducerTask( void * pvParameters );
+static void prvConsumerTask( void * pvParameters );
+/*-----------------------------------------------------------*/
+
+static void prvProducerTask( void * pvParameters )
+{
+    UBaseType_t uxIndex = ( UBaseType_t ) pvParameters;
+    NetworkBufferDescriptor_t * pxBuffer;
+
+    #if ( ipconfigBUFFER_ALLOC_LOCK_FREE == 1 )
+        {
+            if( uxIndex == 0U )
+            {
+                ( void ) xNetworkBufferCacheRegister();
+            }
+        }
+    #endif
+
+    while( xBenchStop == pdFALSE )
+    {
+        pxBuffer = pxGetNetworkBufferWithDescriptor( benchBUFFER_SIZE, 0U );
+
+        if( pxBuffer == NULL )
+        {
+            ulBenchFailures[ uxIndex ]++;
+            taskYIELD();
+        }
+        else
+        {
+            ulBenchObtained[ uxIndex ]++;
+            pxBuffer->pucEthernetBuffer[ 0 ] = ( uint8_t ) uxIndex;
+
+            if( xQueueSendToBack( xBenchQueue, &pxBuffer, 0U ) != pdPASS )
+            {
+                /* The consumers can not keep up. */
+                vReleaseNetworkBufferAndDescriptor( pxBuffer );
+                ulBenchReleased[ uxIndex ]++;
+            }
+        }
+    }
+
+    #if ( ipconfigBUFFER_ALLOC_LOCK_FREE == 1 )
+        {
+            if( uxIndex == 0U )
+            {
+                vNetworkBufferCacheUnregister();
+            }
+        }
+    #endif
+
+    ( void ) xSemaphoreGive( xBenchDone );
+    vTaskDelete( NULL );
+}
+/*-----------------------------------------------------------*/
+
+static void prvConsumerTask( void * pvParameters )
+{
+    UBaseType_t uxIndex = ( UBaseType_t ) pvParameters;
+    NetworkBufferDescriptor_t * pxBuffer;
+
+    #if ( ipconfigBUFFER_ALLOC_LOCK_FREE == 1 )
+        {
+            if( uxIndex == ( benchMAX_TASKS / 2U ) )
+            {
+                ( void ) xNetworkBufferCacheRegister();
+            }
+        }
+    #endif
+
+    while( xBenchStop == pdFALSE )
+    {
+        if( xQueueReceive( xBenchQueue, &pxBuffer, 1U ) == pdPASS )
+        {
+            vReleaseNetworkBufferAndDescriptor( pxBuffer );
+            ulBenchReleased[ uxIndex ]++;
+        }
+    }
+
+    #if ( ipconfigBUFFER_ALLOC_LOCK_FREE == 1 )
+        {
+            if( uxIndex == ( benchMAX_TASKS / 2U ) )
+            {
+                vNetworkBufferCacheUnregister();
+            }
+        }
+    #endif
+
+    ( void ) xSemaphoreGive( xBenchDone );
+    vTaskDelete( NULL );
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xRunBufferAllocBenchmark( UBaseType_t uxProducers,
+                                     UBaseType_t uxConsumers,
+                                     TickType_t xDuration,
+                                     UBaseType_t uxPriority,
+                                     BenchResults_t * pxResults )
+{
+    BenchResults_t xResults;
+    UBaseType_t uxIndex;
+    UBaseType_t uxStarted = 0U;
+    NetworkBufferDescriptor_t * pxBuffer;
+    TickType_t xStartTime;
+    BaseType_t xReturn = pdFAIL;
+    char pcName[ 12 ];
+
+    /* The producers use the lower half of the counters, the consumers the
+     * upper half. */
+    if( ( uxProducers > 0U ) && ( uxProducers <= ( benchMAX_TASKS / 2U ) ) &&
+        ( uxConsumers > 0U ) && ( uxConsumers <= ( benchMAX_TASKS / 2U ) ) )
+    {
+        xBenchQueue = xQueueCreate( ( UBaseType_t ) ipconfigNUM_NETWORK_BUFFER_DESCRIPTORS, sizeof( NetworkBufferDescriptor_t * ) );
+        xBenchDone = xSemaphoreCreateCounting( benchMAX_TASKS, 0U );
+    }
+
+    if( ( xBenchQueue != NULL ) && ( xBenchDone != NULL ) )
+    {
+        ( void ) memset( ulBenchObtained, 0, sizeof( ulBenchObtained ) );
+        ( void ) memset( ulBenchReleased, 0, sizeof( ulBenchReleased ) );
+        ( void ) memset( ulBenchFailures, 0, sizeof( ulBenchFailures ) );
+        xBenchStop = pdFALSE;
+        xResults.uxMinimumFree = uxGetNumberOfFreeNetworkBuffers();
+        xStartTime = xTaskGetTickCount();
+
+        for( uxIndex = 0U; uxIndex < uxProducers; uxIndex++ )
+        {
+            ( void ) snprintf( pcName, sizeof( pcName ), "bprod%u", ( unsigned ) uxIndex );
+
+            if( xTaskCreate( prvProducerTask, pcName, benchSTACK_SIZE, ( void * ) uxIndex, uxPriority, NULL ) == pdPASS )
+            {
+                uxStarted++;
+            }
+        }
+
+        for( uxIndex = 0U; uxIndex < uxConsumers; uxIndex++ )
+        {
+            ( void ) snprintf( pcName, sizeof( pcName ), "bcons%u", ( unsigned ) uxIndex );
+
+            if( xTaskCreate( prvConsumerTask, pcName, benchSTACK_SIZE, ( void * ) ( uxIndex + ( benchMAX_TASKS / 2U ) ), uxPriority, NULL ) == pdPASS )
+            {
+                uxStarted++;
+            }
+        }
+
+        /* Sample the number of free buffers while the test runs. */
+        while( ( xTaskGetTickCount() - xStartTime ) < xDuration )
+        {
+            vTaskDelay( 1U );
+
+            if( xResults.uxMinimumFree > uxGetNumberOfFreeNetworkBuffers() )
+            {
+                xResults.uxMinimumFree = uxGetNumberOfFreeNetworkBuffers();
+            }
+        }
+
+        xBenchStop = pdTRUE;
+
+        for( uxIndex = 0U; uxIndex < uxStarted; uxIndex++ )
+        {
+            ( void ) xSemaphoreTake( xBenchDone, portMAX_DELAY );
+        }
+
+        xResults.xDuration = xTaskGetTickCount() - xStartTime;
+        xResults.ulObtained = 0U;
+        xResults.ulReleased = 0U;
+        xResults.ulFailures = 0U;
+
+        /* Release the buffers that are still in the queue. */
+        while( xQueueReceive( xBenchQueue, &pxBuffer, 0U ) == pdPASS )
+        {
+            vReleaseNetworkBufferAndDescriptor( pxBuffer );
+            xResults.ulReleased++;
+        }
+
+        for( uxIndex = 0U; uxIndex < benchMAX_TASKS; uxIndex++ )
+        {
+            xResults.ulObtained += ulBenchObtained[ uxIndex ];
+            xResults.ulReleased += ulBenchReleased[ uxIndex ];
+            xResults.ulFailures += ulBenchFailures[ uxIndex ];
+        }
+
+        FreeRTOS_printf( ( "Buffer benchmark: %u producers %u consumers %u ticks\n",
+                           ( unsigned ) uxProducers, ( unsigned ) uxConsumers, ( unsigned ) xResults.xDuration ) );
+        FreeRTOS_printf( ( "Buffer benchmark: obtained %lu released %lu failed %lu min free %u\n",
+                           ( unsigned long ) xResults.ulObtained, ( unsigned long ) xResults.ulReleased,
+                           ( unsigned long ) xResults.ulFailures, ( unsigned ) xResults.uxMinimumFree ) );
+
+        if( xResults.xDuration > 0U )
+        {
+            FreeRTOS_printf( ( "Buffer benchmark: %lu buffers per second\n",
+                               ( unsigned long ) ( ( ( uint64_t ) xResults.ulObtained * configTICK_RATE_HZ ) / xResults.xDuration ) ) );
+        }
+
+        /* All buffers must have been returned. */
+        if( xResults.ulObtained == xResults.ulReleased )
+        {
+            xReturn = pdPASS;
+        }
+        else
+        {
+            FreeRTOS_printf( ( "Buffer benchmark: buffers were lost\n" ) );
+        }
+
+        if( pxResults != NULL )
+        {
+            *pxResults = xResults;
+        }
+    }
+
+    if( xBenchQueue != NULL )
+    {
+        vQueueDelete( xBenchQueue );
+        xBenchQueue = NULL;
+    }
+
+    if( xBenchDone != NULL )
+    {
+        vSemaphoreDelete( xBenchDone );
+        xBenchDone = NULL;
+    }
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
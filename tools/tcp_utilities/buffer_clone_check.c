@@ -0,0 +1,283 @@
+/*
+ * FreeRTOS+TCP V2.3.4
+ * Copyright (C) 2021 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/*
+ * buffer_clone_check.c
+ * Check the reference counting of network buffer clones, as created by
+ * pxCloneNetworkBufferWithDescriptor().  See buffer_clone_check.md.
+ */
+
+/* Standard includes. */
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* FreeRTOS+TCP includes. */
+#include "FreeRTOS_IP.h"
+#include "FreeRTOS_IP_Private.h"
+#include "NetworkBufferManagement.h"
+
+#include "buffer_clone_check.h"
+
+#if ( ipconfigUSE_NETWORK_BUFFER_CLONES == 1 )
+
+/* The size of the network buffers used in the check. */
+    #define cloneCheckBUFFER_SIZE    100U
+
+/* Check a condition, and print the line number when it does not hold. */
+    #define cloneCheckASSERT( xCondition )    prvCheck( ( xCondition ) ? pdTRUE : pdFALSE, __LINE__ )
+
+/* Check the number of free buffers and clones against the expected numbers. */
+    #define cloneCheckCOUNTS( uxBuffersInUse, uxClonesInUse )                                  \
+    do {                                                                                       \
+        cloneCheckASSERT( uxGetNumberOfFreeNetworkBuffers() == ( uxFreeBuffers - ( uxBuffersInUse ) ) ); \
+        cloneCheckASSERT( uxGetNumberOfFreeNetworkBufferClones() == ( uxFreeClones - ( uxClonesInUse ) ) ); \
+    } while( ipFALSE_BOOL )
+
+    static void prvCheck( BaseType_t xResult,
+                          int iLine );
+
+/* The number of checks that failed. */
+    static UBaseType_t uxCheckFailures;
+/*-----------------------------------------------------------*/
+
+    static void prvCheck( BaseType_t xResult,
+                          int iLine )
+    {
+        /* iLine is not used when FreeRTOS_printf() is not defined. */
+        ( void ) iLine;
+
+        if( xResult == pdFALSE )
+        {
+            FreeRTOS_printf( ( "Clone check: failed at line %d\n", iLine ) );
+            uxCheckFailures++;
+        }
+    }
+/*-----------------------------------------------------------*/
+
+    BaseType_t xRunBufferCloneCheck( void )
+    {
+        NetworkBufferDescriptor_t * pxBuffer;
+        NetworkBufferDescriptor_t * pxClone1;
+        NetworkBufferDescriptor_t * pxClone2;
+        NetworkBufferDescriptor_t * pxClones[ ipconfigNUM_NETWORK_BUFFER_CLONES ];
+        UBaseType_t uxFreeBuffers = uxGetNumberOfFreeNetworkBuffers();
+        UBaseType_t uxFreeClones = uxGetNumberOfFreeNetworkBufferClones();
+        UBaseType_t uxCount;
+        BaseType_t xReturn = pdFAIL;
+
+        uxCheckFailures = 0U;
+
+        cloneCheckASSERT( uxFreeClones == ( UBaseType_t ) ipconfigNUM_NETWORK_BUFFER_CLONES );
+
+        /* 1. A clone and a clone of a clone, the parent is released first. */
+        pxBuffer = pxGetNetworkBufferWithDescriptor( cloneCheckBUFFER_SIZE, 0U );
+
+        if( pxBuffer == NULL )
+        {
+            FreeRTOS_printf( ( "Clone check: no network buffer available\n" ) );
+            uxCheckFailures++;
+        }
+        else
+        {
+            pxClone1 = pxCloneNetworkBufferWithDescriptor( pxBuffer );
+            pxClone2 = ( pxClone1 != NULL ) ? pxCloneNetworkBufferWithDescriptor( pxClone1 ) : NULL;
+            cloneCheckASSERT( ( pxClone1 != NULL ) && ( pxClone2 != NULL ) );
+
+            if( ( pxClone1 != NULL ) && ( pxClone2 != NULL ) )
+            {
+                cloneCheckASSERT( pxClone1->pucEthernetBuffer == pxBuffer->pucEthernetBuffer );
+                cloneCheckASSERT( pxClone1->xDataLength == pxBuffer->xDataLength );
+                cloneCheckASSERT( pxClone2->pxParent == pxBuffer );
+                cloneCheckASSERT( pxBuffer->uxReferenceCount == 2U );
+                cloneCheckASSERT( xIsNetworkBufferShared( pxBuffer ) == pdTRUE );
+                cloneCheckASSERT( xIsNetworkBufferShared( pxClone2 ) == pdTRUE );
+                cloneCheckCOUNTS( 1U, 2U );
+
+                /* The frame stays allocated as long as a clone uses it. */
+                vReleaseNetworkBufferAndDescriptor( pxBuffer );
+                cloneCheckCOUNTS( 1U, 2U );
+
+                vReleaseNetworkBufferAndDescriptor( pxClone1 );
+                cloneCheckCOUNTS( 1U, 1U );
+                cloneCheckASSERT( xIsNetworkBufferShared( pxClone2 ) == pdFALSE );
+
+                /* The last clone returns the frame to the pool. */
+                vReleaseNetworkBufferAndDescriptor( pxClone2 );
+                cloneCheckCOUNTS( 0U, 0U );
+
+                /* 2. A clone that is released twice must not release the
+                 * frame again.  With ipconfigTCP_IP_SANITY, a message
+                 * "ALREADY RELEASED" is logged. */
+                vReleaseNetworkBufferAndDescriptor( pxClone2 );
+                cloneCheckCOUNTS( 0U, 0U );
+            }
+        }
+
+        /* 3. The clone is released before the parent. */
+        pxBuffer = pxGetNetworkBufferWithDescriptor( cloneCheckBUFFER_SIZE, 0U );
+
+        if( pxBuffer != NULL )
+        {
+            pxClone1 = pxCloneNetworkBufferWithDescriptor( pxBuffer );
+            cloneCheckASSERT( pxClone1 != NULL );
+
+            if( pxClone1 != NULL )
+            {
+                vReleaseNetworkBufferAndDescriptor( pxClone1 );
+                cloneCheckCOUNTS( 1U, 0U );
+                cloneCheckASSERT( xIsNetworkBufferShared( pxBuffer ) == pdFALSE );
+            }
+
+            vReleaseNetworkBufferAndDescriptor( pxBuffer );
+            cloneCheckCOUNTS( 0U, 0U );
+        }
+
+        #if ( ipconfigZERO_COPY_TX_DRIVER != 0 )
+            {
+            /* 4. A driver finds the owner of a cloned frame and releases it in
+             * place of the clone.  The orphaned clone is reclaimed. */
+            pxBuffer = pxGetNetworkBufferWithDescriptor( cloneCheckBUFFER_SIZE, 0U );
+
+            if( pxBuffer != NULL )
+            {
+                pxClone1 = pxCloneNetworkBufferWithDescriptor( pxBuffer );
+                cloneCheckASSERT( pxClone1 != NULL );
+
+                if( pxClone1 != NULL )
+                {
+                    vReleaseNetworkBufferAndDescriptor( pxBuffer );
+                    cloneCheckCOUNTS( 1U, 1U );
+                    cloneCheckASSERT( pxPacketBuffer_to_NetworkBuffer( pxClone1->pucEthernetBuffer ) == pxBuffer );
+                    vReleaseNetworkBufferAndDescriptor( pxPacketBuffer_to_NetworkBuffer( pxClone1->pucEthernetBuffer ) );
+                    cloneCheckCOUNTS( 0U, 0U );
+                }
+                else
+                {
+                    vReleaseNetworkBufferAndDescriptor( pxBuffer );
+                }
+            }
+            }
+        #endif /* ipconfigZERO_COPY_TX_DRIVER */
+
+        /* 5. The same, released from an ISR context, in both orders. */
+        for( uxCount = 0U; uxCount < 2U; uxCount++ )
+        {
+            pxBuffer = pxGetNetworkBufferWithDescriptor( cloneCheckBUFFER_SIZE, 0U );
+
+            if( pxBuffer != NULL )
+            {
+                pxClone1 = pxCloneNetworkBufferWithDescriptor( pxBuffer );
+                cloneCheckASSERT( pxClone1 != NULL );
+
+                if( pxClone1 != NULL )
+                {
+                    portENTER_CRITICAL();
+                    {
+                        ( void ) vNetworkBufferReleaseFromISR( ( uxCount == 0U ) ? pxClone1 : pxBuffer );
+                    }
+                    portEXIT_CRITICAL();
+                    cloneCheckCOUNTS( 1U, ( uxCount == 0U ) ? 0U : 1U );
+
+                    portENTER_CRITICAL();
+                    {
+                        ( void ) vNetworkBufferReleaseFromISR( ( uxCount == 0U ) ? pxBuffer : pxClone1 );
+                    }
+                    portEXIT_CRITICAL();
+                    cloneCheckCOUNTS( 0U, 0U );
+                }
+                else
+                {
+                    vReleaseNetworkBufferAndDescriptor( pxBuffer );
+                }
+            }
+        }
+
+        /* 6. All clone descriptors in use: the next clone fails. */
+        pxBuffer = pxGetNetworkBufferWithDescriptor( cloneCheckBUFFER_SIZE, 0U );
+
+        if( pxBuffer != NULL )
+        {
+            for( uxCount = 0U; uxCount < ( UBaseType_t ) ipconfigNUM_NETWORK_BUFFER_CLONES; uxCount++ )
+            {
+                pxClones[ uxCount ] = pxCloneNetworkBufferWithDescriptor( pxBuffer );
+
+                if( pxClones[ uxCount ] == NULL )
+                {
+                    break;
+                }
+            }
+
+            cloneCheckASSERT( uxCount == ( UBaseType_t ) ipconfigNUM_NETWORK_BUFFER_CLONES );
+            cloneCheckASSERT( pxCloneNetworkBufferWithDescriptor( pxBuffer ) == NULL );
+            cloneCheckCOUNTS( 1U, uxCount );
+
+            while( uxCount > 0U )
+            {
+                uxCount--;
+                vReleaseNetworkBufferAndDescriptor( pxClones[ uxCount ] );
+            }
+
+            cloneCheckASSERT( pxBuffer->uxReferenceCount == 0U );
+            vReleaseNetworkBufferAndDescriptor( pxBuffer );
+            cloneCheckCOUNTS( 0U, 0U );
+
+            #if ( ipconfigTCP_IP_SANITY != 0 )
+                {
+                    /* 7. A buffer that was released can not be cloned. */
+                    cloneCheckASSERT( pxCloneNetworkBufferWithDescriptor( pxBuffer ) == NULL );
+                    cloneCheckCOUNTS( 0U, 0U );
+                }
+            #endif
+        }
+
+        if( uxCheckFailures == 0U )
+        {
+            FreeRTOS_printf( ( "Clone check: all checks passed\n" ) );
+            xReturn = pdPASS;
+        }
+        else
+        {
+            FreeRTOS_printf( ( "Clone check: %u checks failed\n", ( unsigned ) uxCheckFailures ) );
+        }
+
+        return xReturn;
+    }
+/*-----------------------------------------------------------*/
+
+#else /* ipconfigUSE_NETWORK_BUFFER_CLONES */
+
+    BaseType_t xRunBufferCloneCheck( void )
+    {
+        FreeRTOS_printf( ( "Clone check: ipconfigUSE_NETWORK_BUFFER_CLONES is not enabled\n" ) );
+
+        return pdFAIL;
+    }
+
+#endif /* ipconfigUSE_NETWORK_BUFFER_CLONES */
@@ -0,0 +1,475 @@
+/*
+ * FreeRTOS+TCP V2.3.4
+ * Copyright (C) 2021 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/*
+ * dhcp_reconnect_bench.c
+ * A stand-in DHCP server that can answer with Rapid Commit, and a benchmark
+ * that measures the time to the first packet after the network came back.
+ * See dhcp_reconnect_bench.md.
+ */
+
+/* Standard includes. */
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* FreeRTOS+TCP includes. */
+#include "FreeRTOS_IP.h"
+#include "FreeRTOS_IP_Private.h"
+#include "FreeRTOS_Sockets.h"
+#include "FreeRTOS_DHCP.h"
+
+#include "dhcp_reconnect_bench.h"
+
+#if ( ipconfigUSE_DHCP != 0 )
+
+/* The length of the leases given by the stand-in server, in seconds. */
+    #define standInLEASE_SECONDS      3600U
+
+/* The options of a reply: message type, server identifier, lease time,
+ * netmask, gateway, DNS server, Rapid Commit and the end byte. */
+    #define standInOPTIONS_LENGTH     ( 3U + 6U + 6U + 6U + 6U + 6U + 2U + 1U )
+
+/* The time that the benchmark waits for the echo of one datagram. */
+    #define benchECHO_TIMEOUT         ( pdMS_TO_TICKS( 10U ) )
+
+/* The socket of the stand-in server, and the lease that it hands out. */
+    static Socket_t xStandInSocket = FREERTOS_INVALID_SOCKET;
+    static uint32_t ulStandInLease;
+    static uint32_t ulStandInNetMask;
+
+/* The behaviour of the stand-in server, see vConfigureDHCPStandIn(). */
+    static volatile TickType_t xStandInDelay = 0U;
+    static volatile BaseType_t xStandInRapidCommit = pdFALSE;
+
+/* The DHCP messages are turned into answers in this buffer. */
+    static uint8_t ucStandInBuffer[ sizeof( DHCPMessage_IPv4_t ) + 312U ];
+
+/* The durations of the reconnects, in ticks. */
+    static TickType_t xNetworkUpTimes[ dhcpReconnectBenchMAX_RECONNECTS ];
+    static TickType_t xFirstPacketTimes[ dhcpReconnectBenchMAX_RECONNECTS ];
+
+    static uint8_t * prvStandInAddOption( uint8_t * pucOption,
+                                          uint8_t ucCode,
+                                          uint32_t ulValue );
+    static size_t prvStandInAnswer( uint8_t * pucBuffer,
+                                    size_t uxLength );
+    static void prvStandInTask( void * pvParameters );
+    static void prvInsertSorted( TickType_t * pxTimes,
+                                 UBaseType_t uxCount,
+                                 TickType_t xTime );
+/*-----------------------------------------------------------*/
+
+/* Write an option with a 4-byte value, and return the place of the next one. */
+    static uint8_t * prvStandInAddOption( uint8_t * pucOption,
+                                          uint8_t ucCode,
+                                          uint32_t ulValue )
+    {
+        pucOption[ 0 ] = ucCode;
+        pucOption[ 1 ] = ( uint8_t ) sizeof( ulValue );
+        ( void ) memcpy( &( pucOption[ 2 ] ), &( ulValue ), sizeof( ulValue ) );
+
+        return &( pucOption[ 2U + sizeof( ulValue ) ] );
+    }
+/*-----------------------------------------------------------*/
+
+/* Turn a discover or a request into an offer, an acknowledgement or a
+ * refusal, in place.  Returns the length of the answer, or zero when the
+ * message should not be answered. */
+    static size_t prvStandInAnswer( uint8_t * pucBuffer,
+                                    size_t uxLength )
+    {
+        DHCPMessage_IPv4_t * pxMessage = ( DHCPMessage_IPv4_t * ) pucBuffer;
+        uint32_t ulServerAddress = FreeRTOS_GetIPAddress();
+        uint32_t ulRequested = 0U;
+        uint32_t ulServerIdentifier = 0U;
+        BaseType_t xRapidCommit = pdFALSE;
+        uint8_t ucType = 0U;
+        uint8_t ucAnswer = 0U;
+        size_t uxIndex = sizeof( DHCPMessage_IPv4_t );
+        size_t uxReturn = 0U;
+        uint8_t * pucOption;
+
+        if( ( uxLength > sizeof( DHCPMessage_IPv4_t ) ) &&
+            ( pxMessage->ucOpcode == ( uint8_t ) dhcpREQUEST_OPCODE ) &&
+            ( pxMessage->ulDHCPCookie == ( uint32_t ) dhcpCOOKIE ) )
+        {
+            /* Collect the options of interest. */
+            while( ( uxIndex < uxLength ) && ( pucBuffer[ uxIndex ] != ( uint8_t ) dhcpOPTION_END_BYTE ) )
+            {
+                uint8_t ucCode = pucBuffer[ uxIndex ];
+                size_t uxOptionLength;
+
+                if( ucCode == ( uint8_t ) dhcpIPv4_ZERO_PAD_OPTION_CODE )
+                {
+                    uxIndex++;
+                    continue;
+                }
+
+                if( ( uxIndex + 2U ) > uxLength )
+                {
+                    break;
+                }
+
+                uxOptionLength = pucBuffer[ uxIndex + 1U ];
+
+                if( ( uxIndex + 2U + uxOptionLength ) > uxLength )
+                {
+                    break;
+                }
+
+                if( ( ucCode == ( uint8_t ) dhcpIPv4_MESSAGE_TYPE_OPTION_CODE ) && ( uxOptionLength == 1U ) )
+                {
+                    ucType = pucBuffer[ uxIndex + 2U ];
+                }
+                else if( ( ucCode == ( uint8_t ) dhcpIPv4_REQUEST_IP_ADDRESS_OPTION_CODE ) && ( uxOptionLength == 4U ) )
+                {
+                    ( void ) memcpy( &( ulRequested ), &( pucBuffer[ uxIndex + 2U ] ), sizeof( ulRequested ) );
+                }
+                else if( ( ucCode == ( uint8_t ) dhcpIPv4_SERVER_IP_ADDRESS_OPTION_CODE ) && ( uxOptionLength == 4U ) )
+                {
+                    ( void ) memcpy( &( ulServerIdentifier ), &( pucBuffer[ uxIndex + 2U ] ), sizeof( ulServerIdentifier ) );
+                }
+                else if( ucCode == ( uint8_t ) dhcpIPv4_RAPID_COMMIT_OPTION_CODE )
+                {
+                    xRapidCommit = pdTRUE;
+                }
+                else
+                {
+                    /* Not needed. */
+                }
+
+                uxIndex += 2U + uxOptionLength;
+            }
+
+            if( ucType == ( uint8_t ) dhcpMESSAGE_TYPE_DISCOVER )
+            {
+                if( ( xRapidCommit != pdFALSE ) && ( xStandInRapidCommit != pdFALSE ) )
+                {
+                    ucAnswer = ( uint8_t ) dhcpMESSAGE_TYPE_ACK;
+                }
+                else
+                {
+                    ucAnswer = ( uint8_t ) dhcpMESSAGE_TYPE_OFFER;
+                    xRapidCommit = pdFALSE;
+                }
+            }
+            else if( ( ucType == ( uint8_t ) dhcpMESSAGE_TYPE_REQUEST ) &&
+                     ( ( ulServerIdentifier == 0U ) || ( ulServerIdentifier == ulServerAddress ) ) )
+            {
+                /* A request without a server identifier is an INIT-REBOOT, or
+                 * a renewal.  A request that names another server is not for
+                 * this one. */
+                if( ( ulRequested == ulStandInLease ) || ( pxMessage->ulClientIPAddress_ciaddr == ulStandInLease ) )
+                {
+                    ucAnswer = ( uint8_t ) dhcpMESSAGE_TYPE_ACK;
+                }
+                else
+                {
+                    ucAnswer = ( uint8_t ) dhcpMESSAGE_TYPE_NACK;
+                }
+
+                xRapidCommit = pdFALSE;
+            }
+            else
+            {
+                /* Not answered. */
+            }
+        }
+
+        if( ( ucAnswer != 0U ) && ( ( sizeof( DHCPMessage_IPv4_t ) + standInOPTIONS_LENGTH ) <= sizeof( ucStandInBuffer ) ) )
+        {
+            /* The transaction ID, the flags and the client hardware address
+             * are kept. */
+            pxMessage->ucOpcode = ( uint8_t ) dhcpREPLY_OPCODE;
+            pxMessage->ucHops = 0U;
+            pxMessage->usElapsedTime = 0U;
+            pxMessage->ulClientIPAddress_ciaddr = 0U;
+            pxMessage->ulYourIPAddress_yiaddr = ( ucAnswer == ( uint8_t ) dhcpMESSAGE_TYPE_NACK ) ? 0U : ulStandInLease;
+            pxMessage->ulServerIPAddress_siaddr = 0U;
+
+            pucOption = &( pucBuffer[ sizeof( DHCPMessage_IPv4_t ) ] );
+            pucOption[ 0 ] = ( uint8_t ) dhcpIPv4_MESSAGE_TYPE_OPTION_CODE;
+            pucOption[ 1 ] = 1U;
+            pucOption[ 2 ] = ucAnswer;
+            pucOption = prvStandInAddOption( &( pucOption[ 3 ] ), ( uint8_t ) dhcpIPv4_SERVER_IP_ADDRESS_OPTION_CODE, ulServerAddress );
+
+            if( ucAnswer != ( uint8_t ) dhcpMESSAGE_TYPE_NACK )
+            {
+                pucOption = prvStandInAddOption( pucOption, ( uint8_t ) dhcpIPv4_LEASE_TIME_OPTION_CODE, FreeRTOS_htonl( standInLEASE_SECONDS ) );
+                pucOption = prvStandInAddOption( pucOption, ( uint8_t ) dhcpIPv4_SUBNET_MASK_OPTION_CODE, ulStandInNetMask );
+                pucOption = prvStandInAddOption( pucOption, ( uint8_t ) dhcpIPv4_GATEWAY_OPTION_CODE, ulServerAddress );
+                pucOption = prvStandInAddOption( pucOption, ( uint8_t ) dhcpIPv4_DNS_SERVER_OPTIONS_CODE, ulServerAddress );
+
+                if( xRapidCommit != pdFALSE )
+                {
+                    pucOption[ 0 ] = ( uint8_t ) dhcpIPv4_RAPID_COMMIT_OPTION_CODE;
+                    pucOption[ 1 ] = 0U;
+                    pucOption = &( pucOption[ 2 ] );
+                }
+            }
+
+            pucOption[ 0 ] = ( uint8_t ) dhcpOPTION_END_BYTE;
+            uxReturn = ( size_t ) ( &( pucOption[ 1 ] ) - pucBuffer );
+        }
+
+        return uxReturn;
+    }
+/*-----------------------------------------------------------*/
+
+    static void prvStandInTask( void * pvParameters )
+    {
+        struct freertos_sockaddr xClient;
+        socklen_t xClientLength = sizeof( xClient );
+        int32_t lReceived;
+        size_t uxLength;
+
+        ( void ) pvParameters;
+
+        for( ; ; )
+        {
+            lReceived = FreeRTOS_recvfrom( xStandInSocket, ucStandInBuffer, sizeof( ucStandInBuffer ), 0, &xClient, &xClientLength );
+
+            if( lReceived <= 0 )
+            {
+                continue;
+            }
+
+            if( xStandInDelay != 0U )
+            {
+                vTaskDelay( xStandInDelay );
+            }
+
+            if( ( size_t ) lReceived <= sizeof( DHCPMessage_IPv4_t ) )
+            {
+                /* Not a DHCP message: the benchmark waits for its echo. */
+                ( void ) FreeRTOS_sendto( xStandInSocket, ucStandInBuffer, ( size_t ) lReceived, 0, &xClient, sizeof( xClient ) );
+            }
+            else
+            {
+                uxLength = prvStandInAnswer( ucStandInBuffer, ( size_t ) lReceived );
+
+                if( uxLength != 0U )
+                {
+                    /* The client does not have an address yet. */
+                    xClient.sin_addr = ipBROADCAST_IP_ADDRESS;
+                    xClient.sin_port = FreeRTOS_htons( 68U );
+                    ( void ) FreeRTOS_sendto( xStandInSocket, ucStandInBuffer, uxLength, 0, &xClient, sizeof( xClient ) );
+                }
+            }
+        }
+    }
+/*-----------------------------------------------------------*/
+
+    BaseType_t xStartDHCPStandIn( uint32_t ulLeaseAddress,
+                                  uint32_t ulNetMask,
+                                  UBaseType_t uxPriority )
+    {
+        struct freertos_sockaddr xAddress;
+        BaseType_t xReturn = pdFAIL;
+
+        if( xStandInSocket == FREERTOS_INVALID_SOCKET )
+        {
+            ulStandInLease = ulLeaseAddress;
+            ulStandInNetMask = ulNetMask;
+            xStandInSocket = FreeRTOS_socket( FREERTOS_AF_INET, FREERTOS_SOCK_DGRAM, FREERTOS_IPPROTO_UDP );
+
+            if( xSocketValid( xStandInSocket ) == pdTRUE )
+            {
+                ( void ) memset( &( xAddress ), 0, sizeof( xAddress ) );
+                xAddress.sin_port = FreeRTOS_htons( 67U );
+
+                if( ( FreeRTOS_bind( xStandInSocket, &( xAddress ), sizeof( xAddress ) ) == 0 ) &&
+                    ( xTaskCreate( prvStandInTask, "DHCPStandIn", dhcpReconnectBenchSTACK_SIZE, NULL, uxPriority, NULL ) == pdPASS ) )
+                {
+                    xReturn = pdPASS;
+                }
+                else
+                {
+                    ( void ) FreeRTOS_closesocket( xStandInSocket );
+                    xStandInSocket = FREERTOS_INVALID_SOCKET;
+                }
+            }
+            else
+            {
+                xStandInSocket = FREERTOS_INVALID_SOCKET;
+            }
+        }
+
+        if( xReturn == pdFAIL )
+        {
+            FreeRTOS_printf( ( "DHCP stand-in: could not start\n" ) );
+        }
+
+        return xReturn;
+    }
+/*-----------------------------------------------------------*/
+
+    void vConfigureDHCPStandIn( TickType_t xDelay,
+                                BaseType_t xRapidCommit )
+    {
+        xStandInDelay = xDelay;
+        xStandInRapidCommit = xRapidCommit;
+    }
+/*-----------------------------------------------------------*/
+
+/* Insert xTime in the sorted array pxTimes, which holds uxCount times. */
+    static void prvInsertSorted( TickType_t * pxTimes,
+                                 UBaseType_t uxCount,
+                                 TickType_t xTime )
+    {
+        UBaseType_t uxIndex;
+
+        for( uxIndex = uxCount; ( uxIndex > 0U ) && ( pxTimes[ uxIndex - 1U ] > xTime ); uxIndex-- )
+        {
+            pxTimes[ uxIndex ] = pxTimes[ uxIndex - 1U ];
+        }
+
+        pxTimes[ uxIndex ] = xTime;
+    }
+/*-----------------------------------------------------------*/
+
+    BaseType_t xRunDHCPReconnectBenchmark( uint32_t ulStandInAddress,
+                                           UBaseType_t uxReconnects,
+                                           DHCPReconnectBenchResults_t * pxResults )
+    {
+        DHCPReconnectBenchResults_t xResults;
+        struct freertos_sockaddr xStandIn;
+        struct freertos_sockaddr xFrom;
+        socklen_t xFromLength = sizeof( xFrom );
+        TickType_t xTimeout = benchECHO_TIMEOUT;
+        TickType_t xStartTime, xNetworkUpTime;
+        Socket_t xSocket;
+        UBaseType_t uxIndex;
+        BaseType_t xEchoed;
+        uint8_t ucMessage[ 8 ] = { 'r', 'e', 'c', 'o', 'n', 'n', 'e', 'c' };
+        uint8_t ucReply[ sizeof( ucMessage ) ];
+        BaseType_t xReturn = pdFAIL;
+
+        if( ( uxReconnects == 0U ) || ( uxReconnects > dhcpReconnectBenchMAX_RECONNECTS ) )
+        {
+            FreeRTOS_printf( ( "DHCP reconnect benchmark: use 1 to %u reconnects\n", ( unsigned ) dhcpReconnectBenchMAX_RECONNECTS ) );
+        }
+        else if( FreeRTOS_IsNetworkUp() == pdFALSE )
+        {
+            FreeRTOS_printf( ( "DHCP reconnect benchmark: the network is not up\n" ) );
+        }
+        else
+        {
+            xSocket = FreeRTOS_socket( FREERTOS_AF_INET, FREERTOS_SOCK_DGRAM, FREERTOS_IPPROTO_UDP );
+
+            if( xSocketValid( xSocket ) == pdTRUE )
+            {
+                ( void ) FreeRTOS_setsockopt( xSocket, 0, FREERTOS_SO_RCVTIMEO, &( xTimeout ), sizeof( xTimeout ) );
+
+                ( void ) memset( &( xStandIn ), 0, sizeof( xStandIn ) );
+                xStandIn.sin_addr = ulStandInAddress;
+                xStandIn.sin_port = FreeRTOS_htons( 67U );
+
+                ( void ) memset( &( xResults ), 0, sizeof( xResults ) );
+                xResults.uxReconnects = uxReconnects;
+
+                for( uxIndex = 0U; uxIndex < uxReconnects; uxIndex++ )
+                {
+                    xStartTime = xTaskGetTickCount();
+                    FreeRTOS_NetworkDown();
+
+                    /* The IP-task normally runs at a higher priority, and has
+                     * handled the event already. */
+                    while( ( FreeRTOS_IsNetworkUp() != pdFALSE ) && ( ( xTaskGetTickCount() - xStartTime ) < dhcpReconnectBenchTIMEOUT ) )
+                    {
+                        vTaskDelay( 1U );
+                    }
+
+                    while( ( FreeRTOS_IsNetworkUp() == pdFALSE ) && ( ( xTaskGetTickCount() - xStartTime ) < dhcpReconnectBenchTIMEOUT ) )
+                    {
+                        vTaskDelay( 1U );
+                    }
+
+                    xNetworkUpTime = xTaskGetTickCount() - xStartTime;
+
+                    /* The ARP cache was cleared, the first datagram may have to
+                     * wait for an ARP reply, or get lost. */
+                    xEchoed = pdFALSE;
+
+                    while( ( xEchoed == pdFALSE ) && ( ( xTaskGetTickCount() - xStartTime ) < dhcpReconnectBenchTIMEOUT ) )
+                    {
+                        ( void ) FreeRTOS_sendto( xSocket, ucMessage, sizeof( ucMessage ), 0, &( xStandIn ), sizeof( xStandIn ) );
+
+                        if( FreeRTOS_recvfrom( xSocket, ucReply, sizeof( ucReply ), 0, &( xFrom ), &( xFromLength ) ) == ( int32_t ) sizeof( ucReply ) )
+                        {
+                            xEchoed = pdTRUE;
+                        }
+                    }
+
+                    if( xEchoed != pdFALSE )
+                    {
+                        xResults.uxConnected++;
+                    }
+
+                    /* A reconnect that timed out is counted with the time that
+                     * it took. */
+                    prvInsertSorted( xNetworkUpTimes, uxIndex, xNetworkUpTime );
+                    prvInsertSorted( xFirstPacketTimes, uxIndex, xTaskGetTickCount() - xStartTime );
+                }
+
+                ( void ) FreeRTOS_closesocket( xSocket );
+
+                xResults.xNetworkUpP50 = xNetworkUpTimes[ ( uxReconnects - 1U ) / 2U ];
+                xResults.xNetworkUpMax = xNetworkUpTimes[ uxReconnects - 1U ];
+                xResults.xFirstPacketP50 = xFirstPacketTimes[ ( uxReconnects - 1U ) / 2U ];
+                xResults.xFirstPacketMax = xFirstPacketTimes[ uxReconnects - 1U ];
+
+                FreeRTOS_printf( ( "DHCP reconnect benchmark: %u reconnects, %u connected\n",
+                                   ( unsigned ) xResults.uxReconnects, ( unsigned ) xResults.uxConnected ) );
+                FreeRTOS_printf( ( "DHCP reconnect benchmark: network up p50 %u max %u ticks\n",
+                                   ( unsigned ) xResults.xNetworkUpP50, ( unsigned ) xResults.xNetworkUpMax ) );
+                FreeRTOS_printf( ( "DHCP reconnect benchmark: first packet p50 %u max %u ticks\n",
+                                   ( unsigned ) xResults.xFirstPacketP50, ( unsigned ) xResults.xFirstPacketMax ) );
+
+                if( xResults.uxConnected == uxReconnects )
+                {
+                    xReturn = pdPASS;
+                }
+
+                if( pxResults != NULL )
+                {
+                    *pxResults = xResults;
+                }
+            }
+            else
+            {
+                FreeRTOS_printf( ( "DHCP reconnect benchmark: no socket\n" ) );
+            }
+        }
+
+        return xReturn;
+    }
+
+#endif /* ipconfigUSE_DHCP != 0 */
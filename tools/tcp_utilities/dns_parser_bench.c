@@ -0,0 +1,423 @@
+/*
+ * FreeRTOS+TCP V2.3.4
+ * Copyright (C) 2021 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/*
+ * dns_parser_bench.c
+ * A set of DNS replies, a benchmark that measures how fast the DNS client
+ * parses them, and a fuzz test that feeds it with damaged copies of them.
+ * See dns_parser_bench.md.
+ */
+
+/* Standard includes. */
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* FreeRTOS+TCP includes. */
+#include "FreeRTOS_IP.h"
+#include "FreeRTOS_IP_Private.h"
+#include "FreeRTOS_Sockets.h"
+#include "FreeRTOS_DNS.h"
+#include "NetworkBufferManagement.h"
+
+#include "dns_parser_bench.h"
+
+#if ( ipconfigUSE_DNS != 0 )
+
+/* The largest reply that is passed to the parser. */
+    #define parserMAX_REPLY_LENGTH    512U
+
+/* The offset of the flags in a DNS message, and the bit that marks a reply. */
+    #define parserFLAGS_OFFSET        2U
+    #define parserFLAG_RESPONSE       0x80U
+
+/* The maximum number of changes made to a reply by the fuzz test. */
+    #define parserFUZZ_MAX_CHANGES    4U
+
+/* All replies answer a question for the A record of "www.example.com". */
+
+    /* One A record, the owner name is a pointer to the question. */
+    static const uint8_t ucReplyOneAddress[] =
+    {
+        0x12, 0x34, 0x81, 0x80, 0x00, 0x01, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00,
+        0x03, 0x77, 0x77, 0x77, 0x07, 0x65, 0x78, 0x61, 0x6d, 0x70, 0x6c, 0x65,
+        0x03, 0x63, 0x6f, 0x6d, 0x00, 0x00, 0x01, 0x00, 0x01, 0xc0, 0x0c, 0x00,
+        0x01, 0x00, 0x01, 0x00, 0x00, 0x0e, 0x10, 0x00, 0x04, 0x5d, 0xb8, 0xd8,
+        0x22,
+    };
+
+    /* Four A records of the same name. */
+    static const uint8_t ucReplyFourAddresses[] =
+    {
+        0x12, 0x34, 0x81, 0x80, 0x00, 0x01, 0x00, 0x04, 0x00, 0x00, 0x00, 0x00,
+        0x04, 0x70, 0x6f, 0x6f, 0x6c, 0x03, 0x6e, 0x74, 0x70, 0x03, 0x6f, 0x72,
+        0x67, 0x00, 0x00, 0x01, 0x00, 0x01, 0xc0, 0x0c, 0x00, 0x01, 0x00, 0x01,
+        0x00, 0x00, 0x00, 0x82, 0x00, 0x04, 0xa2, 0x9f, 0xc8, 0x01, 0xc0, 0x0c,
+        0x00, 0x01, 0x00, 0x01, 0x00, 0x00, 0x00, 0x82, 0x00, 0x04, 0xa2, 0x9f,
+        0xc8, 0x7b, 0xc0, 0x0c, 0x00, 0x01, 0x00, 0x01, 0x00, 0x00, 0x00, 0x82,
+        0x00, 0x04, 0xc2, 0x3a, 0xcb, 0x14, 0xc0, 0x0c, 0x00, 0x01, 0x00, 0x01,
+        0x00, 0x00, 0x00, 0x82, 0x00, 0x04, 0x2d, 0x0f, 0xa8, 0xc6,
+    };
+
+    /* A CNAME record, followed by two A records of the canonical name. */
+    static const uint8_t ucReplyAlias[] =
+    {
+        0x12, 0x34, 0x81, 0x80, 0x00, 0x01, 0x00, 0x03, 0x00, 0x00, 0x00, 0x00,
+        0x03, 0x77, 0x77, 0x77, 0x07, 0x65, 0x78, 0x61, 0x6d, 0x70, 0x6c, 0x65,
+        0x03, 0x63, 0x6f, 0x6d, 0x00, 0x00, 0x01, 0x00, 0x01, 0xc0, 0x0c, 0x00,
+        0x05, 0x00, 0x01, 0x00, 0x00, 0x01, 0x2c, 0x00, 0x10, 0x06, 0x65, 0x64,
+        0x67, 0x65, 0x2d, 0x37, 0x03, 0x63, 0x64, 0x6e, 0x03, 0x6e, 0x65, 0x74,
+        0x00, 0xc0, 0x2d, 0x00, 0x01, 0x00, 0x01, 0x00, 0x00, 0x00, 0x3c, 0x00,
+        0x04, 0xcb, 0x00, 0x71, 0x07, 0xc0, 0x2d, 0x00, 0x01, 0x00, 0x01, 0x00,
+        0x00, 0x00, 0x3c, 0x00, 0x04, 0xcb, 0x00, 0x71, 0x08,
+    };
+
+    /* Two CNAME records in a chain, the second one is compressed. */
+    static const uint8_t ucReplyAliasChain[] =
+    {
+        0x12, 0x34, 0x81, 0x80, 0x00, 0x01, 0x00, 0x04, 0x00, 0x00, 0x00, 0x00,
+        0x03, 0x77, 0x77, 0x77, 0x07, 0x65, 0x78, 0x61, 0x6d, 0x70, 0x6c, 0x65,
+        0x03, 0x63, 0x6f, 0x6d, 0x00, 0x00, 0x01, 0x00, 0x01, 0xc0, 0x0c, 0x00,
+        0x05, 0x00, 0x01, 0x00, 0x00, 0x02, 0x58, 0x00, 0x0b, 0x01, 0x61, 0x03,
+        0x63, 0x64, 0x6e, 0x03, 0x6e, 0x65, 0x74, 0x00, 0xc0, 0x2d, 0x00, 0x05,
+        0x00, 0x01, 0x00, 0x00, 0x00, 0x78, 0x00, 0x04, 0x01, 0x62, 0xc0, 0x2f,
+        0xc0, 0x44, 0x00, 0x01, 0x00, 0x01, 0x00, 0x00, 0x01, 0x2c, 0x00, 0x04,
+        0xc6, 0x33, 0x64, 0x01, 0xc0, 0x44, 0x00, 0x01, 0x00, 0x01, 0x00, 0x00,
+        0x01, 0x2c, 0x00, 0x04, 0xc6, 0x33, 0x64, 0x02,
+    };
+
+    /* An A record of another name, an AAAA record and one A record of the name. */
+    static const uint8_t ucReplyMixed[] =
+    {
+        0x12, 0x34, 0x81, 0x80, 0x00, 0x01, 0x00, 0x03, 0x00, 0x00, 0x00, 0x00,
+        0x03, 0x77, 0x77, 0x77, 0x07, 0x65, 0x78, 0x61, 0x6d, 0x70, 0x6c, 0x65,
+        0x03, 0x63, 0x6f, 0x6d, 0x00, 0x00, 0x01, 0x00, 0x01, 0x07, 0x74, 0x72,
+        0x61, 0x63, 0x6b, 0x65, 0x72, 0x07, 0x65, 0x78, 0x61, 0x6d, 0x70, 0x6c,
+        0x65, 0x03, 0x6f, 0x72, 0x67, 0x00, 0x00, 0x01, 0x00, 0x01, 0x00, 0x00,
+        0x0e, 0x10, 0x00, 0x04, 0xc0, 0x00, 0x02, 0x42, 0xc0, 0x0c, 0x00, 0x1c,
+        0x00, 0x01, 0x00, 0x00, 0x01, 0x2c, 0x00, 0x10, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0xc0, 0x0c, 0x00, 0x01, 0x00, 0x01, 0x00, 0x00, 0x0e, 0x10, 0x00, 0x04,
+        0xc0, 0x00, 0x02, 0x01,
+    };
+
+    /* A negative answer with an SOA record in the authority section. */
+    static const uint8_t ucReplyNoSuchName[] =
+    {
+        0x12, 0x34, 0x81, 0x83, 0x00, 0x01, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00,
+        0x02, 0x6e, 0x78, 0x07, 0x65, 0x78, 0x61, 0x6d, 0x70, 0x6c, 0x65, 0x03,
+        0x63, 0x6f, 0x6d, 0x00, 0x00, 0x01, 0x00, 0x01, 0xc0, 0x0f, 0x00, 0x06,
+        0x00, 0x01, 0x00, 0x00, 0x03, 0x84, 0x00, 0x26, 0x02, 0x6e, 0x73, 0xc0,
+        0x0f, 0x0a, 0x68, 0x6f, 0x73, 0x74, 0x6d, 0x61, 0x73, 0x74, 0x65, 0x72,
+        0xc0, 0x0f, 0x00, 0x00, 0x07, 0xe5, 0x00, 0x00, 0x1c, 0x20, 0x00, 0x00,
+        0x0e, 0x10, 0x00, 0x12, 0x75, 0x00, 0x00, 0x00, 0x01, 0x2c,
+    };
+
+    /* Malformed: the owner name is a pointer to itself. */
+    static const uint8_t ucReplyLoop[] =
+    {
+        0x12, 0x34, 0x81, 0x80, 0x00, 0x01, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00,
+        0x03, 0x77, 0x77, 0x77, 0x07, 0x65, 0x78, 0x61, 0x6d, 0x70, 0x6c, 0x65,
+        0x03, 0x63, 0x6f, 0x6d, 0x00, 0x00, 0x01, 0x00, 0x01, 0xc0, 0x21, 0x00,
+        0x01, 0x00, 0x01, 0x00, 0x00, 0x0e, 0x10, 0x00, 0x04, 0xc0, 0x00, 0x02,
+        0x63,
+    };
+
+    /* Malformed: the last record is cut short. */
+    static const uint8_t ucReplyTruncated[] =
+    {
+        0x12, 0x34, 0x81, 0x80, 0x00, 0x01, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00,
+        0x03, 0x77, 0x77, 0x77, 0x07, 0x65, 0x78, 0x61, 0x6d, 0x70, 0x6c, 0x65,
+        0x03, 0x63, 0x6f, 0x6d, 0x00, 0x00, 0x01, 0x00, 0x01, 0xc0, 0x0c, 0x00,
+        0x01, 0x00, 0x01, 0x00, 0x00, 0x0e, 0x10, 0x00, 0x04, 0x5d,
+    };
+
+
+/* A reply of the set, and what the parser should make of it. */
+    typedef struct xDNS_PARSER_SAMPLE
+    {
+        const char * pcName;        /* The name printed in the results. */
+        const uint8_t * pucReply;   /* The reply. */
+        size_t uxLength;            /* The length of the reply. */
+        BaseType_t xValid;          /* pdTRUE when the reply is well-formed. */
+        UBaseType_t uxAddressCount; /* The number of addresses of "www.example.com". */
+    } DNSParserSample_t;
+
+    static const DNSParserSample_t xSamples[] =
+    {
+        { "one address",    ucReplyOneAddress,    sizeof( ucReplyOneAddress ),    pdTRUE,  1U },
+        { "four addresses", ucReplyFourAddresses, sizeof( ucReplyFourAddresses ), pdTRUE,  4U },
+        { "alias",          ucReplyAlias,         sizeof( ucReplyAlias ),         pdTRUE,  2U },
+        { "alias chain",    ucReplyAliasChain,    sizeof( ucReplyAliasChain ),    pdTRUE,  2U },
+        { "mixed records",  ucReplyMixed,         sizeof( ucReplyMixed ),         pdTRUE,  1U },
+        { "no such name",   ucReplyNoSuchName,    sizeof( ucReplyNoSuchName ),    pdTRUE,  0U },
+        { "pointer loop",   ucReplyLoop,          sizeof( ucReplyLoop ),          pdFALSE, 0U },
+        { "truncated",      ucReplyTruncated,     sizeof( ucReplyTruncated ),     pdFALSE, 0U },
+    };
+
+    #define parserSAMPLE_COUNT    ( sizeof( xSamples ) / sizeof( xSamples[ 0 ] ) )
+
+    #if ( ipconfigDNS_USE_FAST_PARSER == 1 )
+        /* Too large for the stack of most tasks. */
+        static DNSReplyInfo_t xReplyInfo;
+    #endif
+
+    static void prvLoadReply( NetworkBufferDescriptor_t * pxBuffer,
+                              const uint8_t * pucReply,
+                              size_t uxLength );
+    static uint32_t prvNextRandom( uint32_t * pulState );
+/*-----------------------------------------------------------*/
+
+/* Store a reply in a network buffer, behind an empty UDP packet header, the
+ * way ulDNSHandlePacket() expects it. */
+    static void prvLoadReply( NetworkBufferDescriptor_t * pxBuffer,
+                              const uint8_t * pucReply,
+                              size_t uxLength )
+    {
+        ( void ) memset( pxBuffer->pucEthernetBuffer, 0, sizeof( UDPPacket_t ) );
+        ( void ) memcpy( &( pxBuffer->pucEthernetBuffer[ sizeof( UDPPacket_t ) ] ), pucReply, uxLength );
+        pxBuffer->xDataLength = sizeof( UDPPacket_t ) + uxLength;
+    }
+/*-----------------------------------------------------------*/
+
+/* A xorshift generator: the fuzz test must be repeatable with the same seed. */
+    static uint32_t prvNextRandom( uint32_t * pulState )
+    {
+        uint32_t ulValue = *pulState;
+
+        ulValue ^= ulValue << 13;
+        ulValue ^= ulValue >> 17;
+        ulValue ^= ulValue << 5;
+        *pulState = ulValue;
+
+        return ulValue;
+    }
+/*-----------------------------------------------------------*/
+
+    BaseType_t xRunDNSParserBenchmark( TickType_t xDuration,
+                                       DNSParserBenchResults_t * pxResults )
+    {
+        NetworkBufferDescriptor_t * pxBuffer;
+        DNSParserBenchResults_t xResults;
+        BaseType_t xReturn = pdPASS;
+        UBaseType_t uxIndex;
+        TickType_t xStart;
+        uint32_t ulCount;
+
+        ( void ) memset( &( xResults ), 0, sizeof( xResults ) );
+        xResults.uxReplies = parserSAMPLE_COUNT;
+        xResults.xDuration = FreeRTOS_max_uint32( xDuration, 1U );
+
+        pxBuffer = pxGetNetworkBufferWithDescriptor( sizeof( UDPPacket_t ) + parserMAX_REPLY_LENGTH, 0U );
+
+        if( pxBuffer == NULL )
+        {
+            FreeRTOS_printf( ( "DNS parser benchmark: no network buffer\n" ) );
+            xReturn = pdFAIL;
+        }
+        else
+        {
+            for( uxIndex = 0U; uxIndex < parserSAMPLE_COUNT; uxIndex++ )
+            {
+                const DNSParserSample_t * pxSample = &( xSamples[ uxIndex ] );
+
+                /* The reply is copied every time, because the parser may
+                 * change it. */
+                ulCount = 0U;
+                xStart = xTaskGetTickCount();
+
+                do
+                {
+                    prvLoadReply( pxBuffer, pxSample->pucReply, pxSample->uxLength );
+                    ( void ) ulDNSHandlePacket( pxBuffer );
+                    ulCount++;
+                } while( ( xTaskGetTickCount() - xStart ) < xResults.xDuration );
+
+                xResults.ulParses += ulCount;
+                FreeRTOS_printf( ( "DNS parser benchmark: %-14s %lu replies/s\n",
+                                   pxSample->pcName,
+                                   ( unsigned long ) ( ( ( uint64_t ) ulCount * configTICK_RATE_HZ ) / xResults.xDuration ) ) );
+
+                #if ( ipconfigDNS_USE_FAST_PARSER == 1 )
+                    {
+                        BaseType_t xResult = xDNSParseReply( pxSample->pucReply, pxSample->uxLength, &( xReplyInfo ) );
+
+                        if( ( xResult != pxSample->xValid ) ||
+                            ( ( xResult == pdPASS ) && ( xReplyInfo.uxAddressCount != pxSample->uxAddressCount ) ) )
+                        {
+                            FreeRTOS_printf( ( "DNS parser benchmark: %s was not parsed as expected\n", pxSample->pcName ) );
+                            xReturn = pdFAIL;
+                        }
+
+                        /* xDNSParseReply() leaves the reply as it is. */
+                        ulCount = 0U;
+                        xStart = xTaskGetTickCount();
+
+                        do
+                        {
+                            ( void ) xDNSParseReply( pxSample->pucReply, pxSample->uxLength, &( xReplyInfo ) );
+                            ulCount++;
+                        } while( ( xTaskGetTickCount() - xStart ) < xResults.xDuration );
+
+                        xResults.ulDirectParses += ulCount;
+                        FreeRTOS_printf( ( "DNS parser benchmark: %-14s %lu replies/s without the cache\n",
+                                           pxSample->pcName,
+                                           ( unsigned long ) ( ( ( uint64_t ) ulCount * configTICK_RATE_HZ ) / xResults.xDuration ) ) );
+                    }
+                #endif /* ipconfigDNS_USE_FAST_PARSER == 1 */
+            }
+
+            vReleaseNetworkBufferAndDescriptor( pxBuffer );
+
+            FreeRTOS_printf( ( "DNS parser benchmark: %lu replies in %lu ticks\n",
+                               ( unsigned long ) xResults.ulParses,
+                               ( unsigned long ) ( xResults.xDuration * parserSAMPLE_COUNT ) ) );
+        }
+
+        if( pxResults != NULL )
+        {
+            *pxResults = xResults;
+        }
+
+        return xReturn;
+    }
+/*-----------------------------------------------------------*/
+
+    BaseType_t xRunDNSParserFuzz( UBaseType_t uxIterations,
+                                  uint32_t ulSeed )
+    {
+        NetworkBufferDescriptor_t * pxBuffer;
+        BaseType_t xReturn = pdPASS;
+        UBaseType_t uxIteration;
+        UBaseType_t uxChange;
+        uint32_t ulState = ( ulSeed != 0U ) ? ulSeed : 1U;
+
+        #if ( ipconfigDNS_USE_FAST_PARSER == 1 )
+            uint32_t ulAccepted = 0U;
+        #endif
+
+        pxBuffer = pxGetNetworkBufferWithDescriptor( sizeof( UDPPacket_t ) + parserMAX_REPLY_LENGTH, 0U );
+
+        if( pxBuffer == NULL )
+        {
+            FreeRTOS_printf( ( "DNS parser fuzz: no network buffer\n" ) );
+            xReturn = pdFAIL;
+        }
+        else
+        {
+            uint8_t * pucPayload = &( pxBuffer->pucEthernetBuffer[ sizeof( UDPPacket_t ) ] );
+
+            for( uxIteration = 0U; uxIteration < uxIterations; uxIteration++ )
+            {
+                const DNSParserSample_t * pxSample = &( xSamples[ prvNextRandom( &( ulState ) ) % parserSAMPLE_COUNT ] );
+                UBaseType_t uxChanges = 1U + ( prvNextRandom( &( ulState ) ) % parserFUZZ_MAX_CHANGES );
+                size_t uxLength = pxSample->uxLength;
+
+                prvLoadReply( pxBuffer, pxSample->pucReply, uxLength );
+
+                for( uxChange = 0U; ( uxChange < uxChanges ) && ( uxLength > 0U ); uxChange++ )
+                {
+                    uint32_t ulRandom = prvNextRandom( &( ulState ) );
+                    size_t uxOffset = ulRandom % uxLength;
+                    uint8_t ucValue = ( uint8_t ) ( ulRandom >> 24 );
+
+                    switch( ( ulRandom >> 16 ) % 4U )
+                    {
+                        case 0:
+                            /* Replace a byte. */
+                            pucPayload[ uxOffset ] = ucValue;
+                            break;
+
+                        case 1:
+                            /* Flip a bit. */
+                            pucPayload[ uxOffset ] ^= ( uint8_t ) ( 1U << ( ucValue % 8U ) );
+                            break;
+
+                        case 2:
+                            /* Write a compression pointer to a random place. */
+                            if( ( uxOffset + 1U ) < uxLength )
+                            {
+                                pucPayload[ uxOffset ] = ( uint8_t ) ( 0xC0U | ( ( ulRandom >> 8 ) & 0x01U ) );
+                                pucPayload[ uxOffset + 1U ] = ucValue;
+                            }
+
+                            break;
+
+                        default:
+                            /* Cut off the end. */
+                            uxLength = uxOffset;
+                            break;
+                    }
+                }
+
+                /* A message without the response flag could be taken for an
+                 * LLMNR question, which would be answered with this buffer. */
+                if( uxLength > parserFLAGS_OFFSET )
+                {
+                    pucPayload[ parserFLAGS_OFFSET ] |= ( uint8_t ) parserFLAG_RESPONSE;
+                }
+
+                #if ( ipconfigDNS_USE_FAST_PARSER == 1 )
+                    {
+                        if( xDNSParseReply( pucPayload, uxLength, &( xReplyInfo ) ) == pdPASS )
+                        {
+                            ulAccepted++;
+
+                            if( ( xReplyInfo.uxAddressCount > ipconfigDNS_PARSER_MAX_ADDRESSES ) ||
+                                ( xReplyInfo.uxQuestionsEnd > xReplyInfo.uxAuthorityOffset ) ||
+                                ( xReplyInfo.uxAuthorityOffset > uxLength ) ||
+                                ( strlen( xReplyInfo.pcName ) >= sizeof( xReplyInfo.pcName ) ) )
+                            {
+                                FreeRTOS_printf( ( "DNS parser fuzz: inconsistent result in iteration %lu\n",
+                                                   ( unsigned long ) uxIteration ) );
+                                xReturn = pdFAIL;
+                            }
+                        }
+                    }
+                #endif /* ipconfigDNS_USE_FAST_PARSER == 1 */
+
+                pxBuffer->xDataLength = sizeof( UDPPacket_t ) + uxLength;
+                ( void ) ulDNSHandlePacket( pxBuffer );
+            }
+
+            vReleaseNetworkBufferAndDescriptor( pxBuffer );
+
+            FreeRTOS_printf( ( "DNS parser fuzz: %lu messages\n", ( unsigned long ) uxIterations ) );
+
+            #if ( ipconfigDNS_USE_FAST_PARSER == 1 )
+                {
+                    FreeRTOS_printf( ( "DNS parser fuzz: %lu accepted by xDNSParseReply()\n", ( unsigned long ) ulAccepted ) );
+                }
+            #endif
+        }
+
+        return xReturn;
+    }
+
+#endif /* ipconfigUSE_DNS != 0 */
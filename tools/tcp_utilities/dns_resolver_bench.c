@@ -0,0 +1,253 @@
+/*
+ * FreeRTOS+TCP V2.3.4
+ * Copyright (C) 2021 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/*
+ * dns_resolver_bench.c
+ * Start a burst of asynchronous DNS look-ups and measure their latency, and
+ * the number of sockets and questions used.  See dns_resolver_bench.md.
+ */
+
+/* Standard includes. */
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* FreeRTOS+TCP includes. */
+#include "FreeRTOS_IP.h"
+#include "FreeRTOS_Sockets.h"
+#include "FreeRTOS_DNS.h"
+
+#include "dns_resolver_bench.h"
+
+#if ( ipconfigDNS_USE_CALLBACKS == 1 )
+
+/* The state of one look-up.  It is passed as the search ID, the call-back is
+ * called from the IP-task. */
+    typedef struct xDNS_BENCH_LOOKUP
+    {
+        TickType_t xStartTime;       /* The time at which the look-up was started. */
+        TickType_t xEndTime;         /* The time at which the look-up was finished. */
+        uint32_t ulIPAddress;        /* The address found, or zero. */
+        volatile BaseType_t xIsDone; /* Set when the look-up has finished. */
+    } DNSBenchLookup_t;
+
+    static DNSBenchLookup_t xLookups[ dnsBenchMAX_LOOKUPS ];
+
+    static void prvLookupDone( const char * pcName,
+                               void * pvSearchID,
+                               uint32_t ulIPAddress );
+    static UBaseType_t prvCountDone( UBaseType_t uxLookups );
+/*-----------------------------------------------------------*/
+
+    static void prvLookupDone( const char * pcName,
+                               void * pvSearchID,
+                               uint32_t ulIPAddress )
+    {
+        DNSBenchLookup_t * pxLookup = ( DNSBenchLookup_t * ) pvSearchID;
+
+        ( void ) pcName;
+
+        pxLookup->xEndTime = xTaskGetTickCount();
+        pxLookup->ulIPAddress = ulIPAddress;
+        pxLookup->xIsDone = pdTRUE;
+    }
+/*-----------------------------------------------------------*/
+
+    static UBaseType_t prvCountDone( UBaseType_t uxLookups )
+    {
+        UBaseType_t uxIndex;
+        UBaseType_t uxCount = 0U;
+
+        for( uxIndex = 0U; uxIndex < uxLookups; uxIndex++ )
+        {
+            if( xLookups[ uxIndex ].xIsDone != pdFALSE )
+            {
+                uxCount++;
+            }
+        }
+
+        return uxCount;
+    }
+/*-----------------------------------------------------------*/
+
+    BaseType_t xRunDNSResolverBenchmark( const char * const * ppcNames,
+                                         UBaseType_t uxNameCount,
+                                         UBaseType_t uxLookups,
+                                         TickType_t xTimeout,
+                                         DNSBenchResults_t * pxResults )
+    {
+        DNSBenchResults_t xResults;
+        DNSResolverStats_t xStatsBefore, xStatsAfter;
+        UBaseType_t uxIndex;
+        TickType_t xStartTime, xLatency, xTotalLatency = 0U;
+        uint32_t ulIPAddress;
+        BaseType_t xReturn = pdFAIL;
+
+        if( ( ppcNames == NULL ) || ( uxNameCount == 0U ) ||
+            ( uxLookups == 0U ) || ( uxLookups > dnsBenchMAX_LOOKUPS ) )
+        {
+            FreeRTOS_printf( ( "DNS benchmark: use 1 to %u look-ups and at least one name\n", ( unsigned ) dnsBenchMAX_LOOKUPS ) );
+        }
+        else if( FreeRTOS_IsNetworkUp() == pdFALSE )
+        {
+            FreeRTOS_printf( ( "DNS benchmark: the network is not up\n" ) );
+        }
+        else
+        {
+            #if ( ipconfigDNS_USE_RESOLVER != 1 )
+                {
+                    FreeRTOS_printf( ( "DNS benchmark: ipconfigDNS_USE_RESOLVER is not enabled\n" ) );
+                }
+            #endif
+
+            #if ( ipconfigUSE_DNS_CACHE == 1 )
+                {
+                    FreeRTOS_dnsclear();
+                }
+            #endif
+
+            ( void ) memset( xLookups, 0, sizeof( xLookups ) );
+            ( void ) memset( &( xResults ), 0, sizeof( xResults ) );
+            xResults.uxLookups = uxLookups;
+            xResults.xMinLatency = portMAX_DELAY;
+            vDNSGetResolverStats( &( xStatsBefore ) );
+
+            /* Start all look-ups at once. */
+            xStartTime = xTaskGetTickCount();
+
+            for( uxIndex = 0U; uxIndex < uxLookups; uxIndex++ )
+            {
+                DNSBenchLookup_t * pxLookup = &( xLookups[ uxIndex ] );
+
+                pxLookup->xStartTime = xTaskGetTickCount();
+                ulIPAddress = FreeRTOS_gethostbyname_a( ppcNames[ uxIndex % uxNameCount ],
+                                                        prvLookupDone,
+                                                        ( void * ) pxLookup,
+                                                        xTimeout * portTICK_PERIOD_MS );
+
+                if( ulIPAddress != 0UL )
+                {
+                    /* The name was known already, the call-back has been called. */
+                    pxLookup->xEndTime = pxLookup->xStartTime;
+                    pxLookup->ulIPAddress = ulIPAddress;
+                    pxLookup->xIsDone = pdTRUE;
+                }
+            }
+
+            /* The call-backs are called by the IP-task. */
+            while( ( prvCountDone( uxLookups ) < uxLookups ) &&
+                   ( ( xTaskGetTickCount() - xStartTime ) < xTimeout ) )
+            {
+                vTaskDelay( 1U );
+            }
+
+            for( uxIndex = 0U; uxIndex < uxLookups; uxIndex++ )
+            {
+                DNSBenchLookup_t * pxLookup = &( xLookups[ uxIndex ] );
+
+                if( pxLookup->xIsDone == pdFALSE )
+                {
+                    FreeRTOS_gethostbyname_cancel( ( void * ) pxLookup );
+                }
+                else if( pxLookup->ulIPAddress != 0UL )
+                {
+                    xLatency = pxLookup->xEndTime - pxLookup->xStartTime;
+                    xTotalLatency += xLatency;
+                    xResults.uxResolved++;
+
+                    if( xLatency < xResults.xMinLatency )
+                    {
+                        xResults.xMinLatency = xLatency;
+                    }
+
+                    if( xLatency > xResults.xMaxLatency )
+                    {
+                        xResults.xMaxLatency = xLatency;
+                    }
+
+                    if( ( pxLookup->xEndTime - xStartTime ) > xResults.xDuration )
+                    {
+                        xResults.xDuration = pxLookup->xEndTime - xStartTime;
+                    }
+                }
+                else
+                {
+                    /* The look-up timed out. */
+                }
+            }
+
+            vDNSGetResolverStats( &( xStatsAfter ) );
+            xResults.ulQueriesSent = xStatsAfter.ulQueriesSent - xStatsBefore.ulQueriesSent;
+            xResults.ulQueriesCollapsed = xStatsAfter.ulQueriesCollapsed - xStatsBefore.ulQueriesCollapsed;
+            xResults.ulSocketsCreated = xStatsAfter.ulSocketsCreated - xStatsBefore.ulSocketsCreated;
+
+            if( xResults.uxResolved != 0U )
+            {
+                xResults.xAverageLatency = xTotalLatency / ( TickType_t ) xResults.uxResolved;
+            }
+            else
+            {
+                xResults.xMinLatency = 0U;
+            }
+
+            #if ( ipconfigUSE_DNS_CACHE == 1 )
+                {
+                    FreeRTOS_dnsclear();
+                }
+            #endif
+
+            FreeRTOS_printf( ( "DNS benchmark: %u look-ups of %u names, %u resolved in %u ticks\n",
+                               ( unsigned ) uxLookups, ( unsigned ) uxNameCount,
+                               ( unsigned ) xResults.uxResolved, ( unsigned ) xResults.xDuration ) );
+            FreeRTOS_printf( ( "DNS benchmark: latency min %u avg %u max %u ticks\n",
+                               ( unsigned ) xResults.xMinLatency, ( unsigned ) xResults.xAverageLatency,
+                               ( unsigned ) xResults.xMaxLatency ) );
+            FreeRTOS_printf( ( "DNS benchmark: %lu questions %lu collapsed %lu sockets\n",
+                               ( unsigned long ) xResults.ulQueriesSent, ( unsigned long ) xResults.ulQueriesCollapsed,
+                               ( unsigned long ) xResults.ulSocketsCreated ) );
+
+            if( xResults.uxResolved == uxLookups )
+            {
+                xReturn = pdPASS;
+            }
+            else
+            {
+                FreeRTOS_printf( ( "DNS benchmark: %u look-ups failed\n", ( unsigned ) ( uxLookups - xResults.uxResolved ) ) );
+            }
+
+            if( pxResults != NULL )
+            {
+                *pxResults = xResults;
+            }
+        }
+
+        return xReturn;
+    }
+
+#endif /* ipconfigDNS_USE_CALLBACKS == 1 */
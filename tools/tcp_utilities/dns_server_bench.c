@@ -0,0 +1,340 @@
+/*
+ * FreeRTOS+TCP V2.3.4
+ * Copyright (C) 2021 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/*
+ * dns_server_bench.c
+ * A stand-in DNS server that injects a delay or drops questions, and a
+ * benchmark that measures the tail latency of DNS look-ups against the
+ * configured servers.  See dns_server_bench.md.
+ */
+
+/* Standard includes. */
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* FreeRTOS+TCP includes. */
+#include "FreeRTOS_IP.h"
+#include "FreeRTOS_Sockets.h"
+#include "FreeRTOS_DNS.h"
+
+#include "dns_server_bench.h"
+
+#if ( ipconfigUSE_DNS != 0 )
+
+/* The size of the DNS header. */
+    #define standInHEADER_LENGTH    12U
+
+/* The size of the answer record that is appended to the question. */
+    #define standInANSWER_LENGTH    16U
+
+/* The time to live of the answers, in seconds. */
+    #define standInTTL_SECONDS      60U
+
+/* The socket of the stand-in server, and the address that it hands out. */
+    static Socket_t xStandInSocket = FREERTOS_INVALID_SOCKET;
+    static uint32_t ulStandInAddress;
+
+/* The behaviour of the stand-in server, see vConfigureDNSStandIn(). */
+    static volatile TickType_t xStandInDelay = 0U;
+    static volatile UBaseType_t uxStandInDropPercent = 0U;
+
+/* The questions are turned into answers in this buffer. */
+    static uint8_t ucStandInBuffer[ 512 ];
+
+/* The latencies of the look-ups, in ticks. */
+    static TickType_t xLatencies[ dnsServerBenchMAX_LOOKUPS ];
+
+    static size_t prvStandInAnswer( uint8_t * pucBuffer,
+                                    size_t uxLength );
+    static void prvStandInTask( void * pvParameters );
+    static TickType_t prvPercentile( UBaseType_t uxCount,
+                                     UBaseType_t uxPercent );
+/*-----------------------------------------------------------*/
+
+/* Turn a question for one A record into an answer, in place.  Returns the
+ * length of the answer, or zero when the message is not such a question. */
+    static size_t prvStandInAnswer( uint8_t * pucBuffer,
+                                    size_t uxLength )
+    {
+        size_t uxIndex = standInHEADER_LENGTH;
+        size_t uxReturn = 0U;
+
+        if( ( uxLength > standInHEADER_LENGTH ) &&
+            ( ( pucBuffer[ 2 ] & 0x80U ) == 0U ) && /* Not a response. */
+            ( pucBuffer[ 4 ] == 0U ) && ( pucBuffer[ 5 ] == 1U ) )
+        {
+            /* Skip the name. */
+            while( ( uxIndex < uxLength ) && ( pucBuffer[ uxIndex ] != 0U ) )
+            {
+                uxIndex += ( size_t ) pucBuffer[ uxIndex ] + 1U;
+            }
+
+            /* The end byte, the type and the class. */
+            uxIndex += 5U;
+
+            if( ( uxIndex <= uxLength ) &&
+                ( ( uxIndex + standInANSWER_LENGTH ) <= sizeof( ucStandInBuffer ) ) &&
+                ( pucBuffer[ uxIndex - 4U ] == 0U ) && ( pucBuffer[ uxIndex - 3U ] == 1U ) ) /* Type A. */
+            {
+                uint8_t * pucAnswer = &( pucBuffer[ uxIndex ] );
+
+                pucBuffer[ 2 ] |= 0x80U; /* A response, keep the recursion desired bit. */
+                pucBuffer[ 3 ] = 0x80U;  /* Recursion available, no error. */
+                ( void ) memset( &( pucBuffer[ 6 ] ), 0, 6U );
+                pucBuffer[ 7 ] = 1U;     /* One answer. */
+
+                pucAnswer[ 0 ] = 0xC0U;  /* A pointer to the name in the question. */
+                pucAnswer[ 1 ] = ( uint8_t ) standInHEADER_LENGTH;
+                pucAnswer[ 2 ] = 0U;     /* Type A. */
+                pucAnswer[ 3 ] = 1U;
+                pucAnswer[ 4 ] = 0U;     /* Class IN. */
+                pucAnswer[ 5 ] = 1U;
+                pucAnswer[ 6 ] = 0U;
+                pucAnswer[ 7 ] = 0U;
+                pucAnswer[ 8 ] = 0U;
+                pucAnswer[ 9 ] = ( uint8_t ) standInTTL_SECONDS;
+                pucAnswer[ 10 ] = 0U;    /* The length of the address. */
+                pucAnswer[ 11 ] = 4U;
+                ( void ) memcpy( &( pucAnswer[ 12 ] ), &( ulStandInAddress ), sizeof( ulStandInAddress ) );
+
+                uxReturn = uxIndex + standInANSWER_LENGTH;
+            }
+        }
+
+        return uxReturn;
+    }
+/*-----------------------------------------------------------*/
+
+    static void prvStandInTask( void * pvParameters )
+    {
+        struct freertos_sockaddr xClient;
+        socklen_t xClientLength = sizeof( xClient );
+        int32_t lReceived;
+        size_t uxLength;
+        uint32_t ulRandom = 0U;
+
+        ( void ) pvParameters;
+
+        for( ; ; )
+        {
+            lReceived = FreeRTOS_recvfrom( xStandInSocket, ucStandInBuffer, sizeof( ucStandInBuffer ), 0, &xClient, &xClientLength );
+
+            if( lReceived <= 0 )
+            {
+                continue;
+            }
+
+            uxLength = prvStandInAnswer( ucStandInBuffer, ( size_t ) lReceived );
+
+            if( uxLength == 0U )
+            {
+                continue;
+            }
+
+            if( uxStandInDropPercent != 0U )
+            {
+                ( void ) xApplicationGetRandomNumber( &( ulRandom ) );
+
+                if( ( ulRandom % 100U ) < uxStandInDropPercent )
+                {
+                    continue;
+                }
+            }
+
+            if( xStandInDelay != 0U )
+            {
+                vTaskDelay( xStandInDelay );
+            }
+
+            ( void ) FreeRTOS_sendto( xStandInSocket, ucStandInBuffer, uxLength, 0, &xClient, sizeof( xClient ) );
+        }
+    }
+/*-----------------------------------------------------------*/
+
+    BaseType_t xStartDNSStandIn( uint32_t ulIPAddress,
+                                 UBaseType_t uxPriority )
+    {
+        struct freertos_sockaddr xAddress;
+        BaseType_t xReturn = pdFAIL;
+
+        if( xStandInSocket == FREERTOS_INVALID_SOCKET )
+        {
+            ulStandInAddress = ulIPAddress;
+            xStandInSocket = FreeRTOS_socket( FREERTOS_AF_INET, FREERTOS_SOCK_DGRAM, FREERTOS_IPPROTO_UDP );
+
+            if( xSocketValid( xStandInSocket ) == pdTRUE )
+            {
+                ( void ) memset( &( xAddress ), 0, sizeof( xAddress ) );
+                xAddress.sin_port = FreeRTOS_htons( 53U );
+
+                if( ( FreeRTOS_bind( xStandInSocket, &( xAddress ), sizeof( xAddress ) ) == 0 ) &&
+                    ( xTaskCreate( prvStandInTask, "DNSStandIn", dnsServerBenchSTACK_SIZE, NULL, uxPriority, NULL ) == pdPASS ) )
+                {
+                    xReturn = pdPASS;
+                }
+                else
+                {
+                    ( void ) FreeRTOS_closesocket( xStandInSocket );
+                    xStandInSocket = FREERTOS_INVALID_SOCKET;
+                }
+            }
+            else
+            {
+                xStandInSocket = FREERTOS_INVALID_SOCKET;
+            }
+        }
+
+        if( xReturn == pdFAIL )
+        {
+            FreeRTOS_printf( ( "DNS stand-in: could not start\n" ) );
+        }
+
+        return xReturn;
+    }
+/*-----------------------------------------------------------*/
+
+    void vConfigureDNSStandIn( TickType_t xDelay,
+                               UBaseType_t uxDropPercent )
+    {
+        xStandInDelay = xDelay;
+        uxStandInDropPercent = FreeRTOS_min_uint32( uxDropPercent, 100U );
+    }
+/*-----------------------------------------------------------*/
+
+/* The latency below which uxPercent percent of the sorted latencies are. */
+    static TickType_t prvPercentile( UBaseType_t uxCount,
+                                     UBaseType_t uxPercent )
+    {
+        UBaseType_t uxIndex = ( ( uxCount * uxPercent ) + 99U ) / 100U;
+
+        if( uxIndex > 0U )
+        {
+            uxIndex--;
+        }
+
+        return xLatencies[ uxIndex ];
+    }
+/*-----------------------------------------------------------*/
+
+    BaseType_t xRunDNSServerBenchmark( const char * const * ppcNames,
+                                       UBaseType_t uxNameCount,
+                                       UBaseType_t uxLookups,
+                                       DNSServerBenchResults_t * pxResults )
+    {
+        DNSServerBenchResults_t xResults;
+        UBaseType_t uxIndex, uxOther;
+        TickType_t xStartTime, xLatency;
+        BaseType_t xReturn = pdFAIL;
+
+        if( ( ppcNames == NULL ) || ( uxNameCount == 0U ) ||
+            ( uxLookups == 0U ) || ( uxLookups > dnsServerBenchMAX_LOOKUPS ) )
+        {
+            FreeRTOS_printf( ( "DNS server benchmark: use 1 to %u look-ups and at least one name\n", ( unsigned ) dnsServerBenchMAX_LOOKUPS ) );
+        }
+        else if( FreeRTOS_IsNetworkUp() == pdFALSE )
+        {
+            FreeRTOS_printf( ( "DNS server benchmark: the network is not up\n" ) );
+        }
+        else
+        {
+            ( void ) memset( &( xResults ), 0, sizeof( xResults ) );
+            xResults.uxLookups = uxLookups;
+
+            for( uxIndex = 0U; uxIndex < uxLookups; uxIndex++ )
+            {
+                #if ( ipconfigUSE_DNS_CACHE == 1 )
+                    {
+                        FreeRTOS_dnsclear();
+                    }
+                #endif
+
+                xStartTime = xTaskGetTickCount();
+
+                if( FreeRTOS_gethostbyname( ppcNames[ uxIndex % uxNameCount ] ) != 0UL )
+                {
+                    xResults.uxResolved++;
+                }
+
+                /* Failed look-ups are counted with the time that they took. */
+                xLatency = xTaskGetTickCount() - xStartTime;
+
+                /* Insertion sort, the number of look-ups is small. */
+                for( uxOther = uxIndex; ( uxOther > 0U ) && ( xLatencies[ uxOther - 1U ] > xLatency ); uxOther-- )
+                {
+                    xLatencies[ uxOther ] = xLatencies[ uxOther - 1U ];
+                }
+
+                xLatencies[ uxOther ] = xLatency;
+            }
+
+            xResults.xP50 = prvPercentile( uxLookups, 50U );
+            xResults.xP90 = prvPercentile( uxLookups, 90U );
+            xResults.xP99 = prvPercentile( uxLookups, 99U );
+            xResults.xMax = xLatencies[ uxLookups - 1U ];
+
+            FreeRTOS_printf( ( "DNS server benchmark: %u look-ups, %u resolved\n",
+                               ( unsigned ) uxLookups, ( unsigned ) xResults.uxResolved ) );
+            FreeRTOS_printf( ( "DNS server benchmark: latency p50 %u p90 %u p99 %u max %u ticks\n",
+                               ( unsigned ) xResults.xP50, ( unsigned ) xResults.xP90,
+                               ( unsigned ) xResults.xP99, ( unsigned ) xResults.xMax ) );
+
+            #if ( ipconfigDNS_MAX_SERVERS > 1 )
+                {
+                    DNSServerInfo_t xServers[ ipconfigDNS_MAX_SERVERS ];
+                    UBaseType_t uxCount = FreeRTOS_GetDNSServers( xServers, ipconfigDNS_MAX_SERVERS );
+                    char pcBuffer[ 16 ];
+
+                    for( uxIndex = 0U; uxIndex < uxCount; uxIndex++ )
+                    {
+                        ( void ) FreeRTOS_inet_ntoa( xServers[ uxIndex ].ulIPAddress, pcBuffer );
+                        FreeRTOS_printf( ( "DNS server benchmark: %u %-15s rtt %lu ms answers %lu failures %lu\n",
+                                           ( unsigned ) uxIndex, pcBuffer,
+                                           ( unsigned long ) xServers[ uxIndex ].ulRTT,
+                                           ( unsigned long ) xServers[ uxIndex ].ulAnswers,
+                                           ( unsigned long ) xServers[ uxIndex ].ulFailures ) );
+                    }
+                }
+            #endif /* ipconfigDNS_MAX_SERVERS > 1 */
+
+            if( xResults.uxResolved == uxLookups )
+            {
+                xReturn = pdPASS;
+            }
+
+            if( pxResults != NULL )
+            {
+                *pxResults = xResults;
+            }
+        }
+
+        return xReturn;
+    }
+
+#endif /* ipconfigUSE_DNS != 0 */
@@ -0,0 +1,53 @@
+/*
+ * FreeRTOS+TCP V2.3.4
+ * Copyright (C) 2021 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/*
+ *  arp_cache_bench.c
+ *  A benchmark that measures the rate of look-ups and refreshes in the ARP
+ *  cache, as done for every outgoing and every received packet.
+ */
+#ifndef ARP_CACHE_BENCH_H
+
+#define ARP_CACHE_BENCH_H
+
+typedef struct xARP_BENCH_RESULTS
+{
+    UBaseType_t uxPeers;  /* The number of entries that were stored in the cache. */
+    uint32_t ulLookups;   /* The number of look-ups done. */
+    uint32_t ulRefreshes; /* The number of refreshes done. */
+    TickType_t xDuration; /* The duration of each run in ticks. */
+} ARPBenchResults_t;
+
+/*
+ * Fill the ARP cache with uxPeers entries on the local network.  Look them up
+ * in turn for xDuration ticks, and then refresh them in turn for xDuration
+ * ticks.  The ARP cache is cleared afterwards.  The results are printed and
+ * stored in pxResults, which may be NULL.
+ */
+extern BaseType_t xRunARPCacheBenchmark( UBaseType_t uxPeers,
+                                         TickType_t xDuration,
+                                         ARPBenchResults_t * pxResults );
+
+#endif /* ARP_CACHE_BENCH_H */
@@ -0,0 +1,66 @@
+/*
+ * FreeRTOS+TCP V2.3.4
+ * Copyright (C) 2021 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/*
+ *  buffer_alloc_bench.c
+ *  A benchmark that measures the throughput of the network buffer allocator
+ *  while several tasks obtain and release buffers at the same time.
+ */
+#ifndef BUFFER_ALLOC_BENCH_H
+
+#define BUFFER_ALLOC_BENCH_H
+
+#ifndef benchMAX_TASKS
+    #define benchMAX_TASKS    8U
+#endif
+
+#ifndef benchSTACK_SIZE
+    #define benchSTACK_SIZE    ( configMINIMAL_STACK_SIZE * 2U )
+#endif
+
+typedef struct xBENCH_RESULTS
+{
+    uint32_t ulObtained;       /* The number of buffers obtained by the producers. */
+    uint32_t ulReleased;       /* The number of buffers released by the consumers and producers. */
+    uint32_t ulFailures;       /* The number of times that no buffer was available. */
+    UBaseType_t uxMinimumFree; /* The lowest number of free buffers during the run. */
+    TickType_t xDuration;      /* The duration of the run in ticks. */
+} BenchResults_t;
+
+/*
+ * Create uxProducers tasks that obtain network buffers and pass them through
+ * a queue, and uxConsumers tasks that receive and release them.  After
+ * xDuration ticks the tasks are stopped, and the results are printed and
+ * stored in pxResults, which may be NULL.  When ipconfigBUFFER_ALLOC_LOCK_FREE
+ * is set, the first producer and the first consumer register a buffer cache,
+ * like the IP-task and a driver RX task would do.  Must be called from a task.
+ */
+extern BaseType_t xRunBufferAllocBenchmark( UBaseType_t uxProducers,
+                                            UBaseType_t uxConsumers,
+                                            TickType_t xDuration,
+                                            UBaseType_t uxPriority,
+                                            BenchResults_t * pxResults );
+
+#endif /* BUFFER_ALLOC_BENCH_H */
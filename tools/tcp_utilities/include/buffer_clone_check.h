@@ -0,0 +1,45 @@
+/*
+ * FreeRTOS+TCP V2.3.4
+ * Copyright (C) 2021 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/*
+ *  buffer_clone_check.c
+ *  A self-check of the ownership tracking of cloned network buffers.
+ */
+#ifndef BUFFER_CLONE_CHECK_H
+
+#define BUFFER_CLONE_CHECK_H
+
+/*
+ * Obtain network buffers, clone them and release the parents and the clones
+ * in different orders: parent first, clone first, a clone twice, the parent
+ * in place of its clone, and from an ISR context.  After every step the
+ * number of free network buffers and free clone descriptors is compared with
+ * the expected number.  Every failure is printed.  Returns pdPASS when all
+ * checks succeeded.  Must be called from a task while the network is quiet,
+ * because the IP-task and the drivers use the same pool.
+ */
+extern BaseType_t xRunBufferCloneCheck( void );
+
+#endif /* BUFFER_CLONE_CHECK_H */
@@ -0,0 +1,88 @@
+/*
+ * FreeRTOS+TCP V2.3.4
+ * Copyright (C) 2021 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/*
+ *  dhcp_reconnect_bench.c
+ *  A stand-in DHCP server, and a benchmark that measures how long it takes
+ *  before the first packet can be exchanged after the network came back.
+ */
+#ifndef DHCP_RECONNECT_BENCH_H
+
+#define DHCP_RECONNECT_BENCH_H
+
+#ifndef dhcpReconnectBenchMAX_RECONNECTS
+    #define dhcpReconnectBenchMAX_RECONNECTS    50U
+#endif
+
+#ifndef dhcpReconnectBenchSTACK_SIZE
+    #define dhcpReconnectBenchSTACK_SIZE        ( configMINIMAL_STACK_SIZE * 2U )
+#endif
+
+#ifndef dhcpReconnectBenchTIMEOUT
+    #define dhcpReconnectBenchTIMEOUT           ( pdMS_TO_TICKS( 60000U ) )
+#endif
+
+typedef struct xDHCP_RECONNECT_BENCH_RESULTS
+{
+    UBaseType_t uxReconnects;   /* The number of times the network was taken down. */
+    UBaseType_t uxConnected;    /* The number of times the first packet was answered in time. */
+    TickType_t xNetworkUpP50;   /* Half of the reconnects had an IP address within this many ticks. */
+    TickType_t xNetworkUpMax;   /* The slowest time to get an IP address, in ticks. */
+    TickType_t xFirstPacketP50; /* Half of the reconnects exchanged the first packet within this many ticks. */
+    TickType_t xFirstPacketMax; /* The slowest time to exchange the first packet, in ticks. */
+} DHCPReconnectBenchResults_t;
+
+/*
+ * Start a task that acts as a DHCP server on UDP port 67.  It gives every
+ * client the address ulLeaseAddress (network byte order), with the netmask
+ * ulNetMask, and its own address as gateway and DNS server.  A request for
+ * another address is refused.  Datagrams that are not DHCP messages are
+ * echoed.  It is meant to run on a node of its own, with a static address.
+ * Returns pdFAIL when the task or its socket could not be created.
+ */
+extern BaseType_t xStartDHCPStandIn( uint32_t ulLeaseAddress,
+                                     uint32_t ulNetMask,
+                                     UBaseType_t uxPriority );
+
+/*
+ * Change the behaviour of the stand-in server: every answer is delayed by
+ * xDelay ticks, and with xRapidCommit set to pdTRUE, a discover with the
+ * Rapid Commit option is acknowledged right away.  May be called at any time.
+ */
+extern void vConfigureDHCPStandIn( TickType_t xDelay,
+                                   BaseType_t xRapidCommit );
+
+/*
+ * Take the network down with FreeRTOS_NetworkDown() uxReconnects times.  Each
+ * time, measure how long it takes before DHCP has brought the network up
+ * again, and before a first datagram sent to the stand-in server at
+ * ulStandInAddress (network byte order) is echoed.  The medians and the
+ * maximums are printed, and stored in pxResults, which may be NULL.
+ */
+extern BaseType_t xRunDHCPReconnectBenchmark( uint32_t ulStandInAddress,
+                                              UBaseType_t uxReconnects,
+                                              DHCPReconnectBenchResults_t * pxResults );
+
+#endif /* DHCP_RECONNECT_BENCH_H */
@@ -0,0 +1,64 @@
+/*
+ * FreeRTOS+TCP V2.3.4
+ * Copyright (C) 2021 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/*
+ *  dns_parser_bench.c
+ *  A set of DNS replies, a benchmark that measures how fast they are parsed,
+ *  and a fuzz test that feeds damaged copies of them to the parser.
+ */
+#ifndef DNS_PARSER_BENCH_H
+
+#define DNS_PARSER_BENCH_H
+
+typedef struct xDNS_PARSER_BENCH_RESULTS
+{
+    UBaseType_t uxReplies;   /* The number of different replies in the set. */
+    uint32_t ulParses;       /* The number of replies handled by ulDNSHandlePacket(). */
+    uint32_t ulDirectParses; /* The number of replies parsed by xDNSParseReply() alone. */
+    TickType_t xDuration;    /* The time spent on each reply, in ticks. */
+} DNSParserBenchResults_t;
+
+/*
+ * Pass each reply of the set to ulDNSHandlePacket() during xDuration ticks,
+ * and print the number of replies handled per second.  When
+ * ipconfigDNS_USE_FAST_PARSER is 1, xDNSParseReply() is timed on its own as
+ * well, and the addresses that it finds are checked.  The results are stored
+ * in pxResults, which may be NULL.  Returns pdFAIL when no network buffer was
+ * available, or when a reply was not parsed as expected.
+ */
+extern BaseType_t xRunDNSParserBenchmark( TickType_t xDuration,
+                                          DNSParserBenchResults_t * pxResults );
+
+/*
+ * Pass uxIterations randomly damaged copies of the replies to the parser.
+ * The same ulSeed gives the same messages.  When ipconfigDNS_USE_FAST_PARSER
+ * is 1, every reply accepted by xDNSParseReply() is checked for consistency.
+ * Returns pdFAIL when a check failed.  A crash or a hang is of course a
+ * failure as well.
+ */
+extern BaseType_t xRunDNSParserFuzz( UBaseType_t uxIterations,
+                                     uint32_t ulSeed );
+
+#endif /* DNS_PARSER_BENCH_H */
@@ -0,0 +1,65 @@
+/*
+ * FreeRTOS+TCP V2.3.4
+ * Copyright (C) 2021 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/*
+ *  dns_resolver_bench.c
+ *  A benchmark that starts a burst of asynchronous DNS look-ups, and measures
+ *  their latency and the number of sockets and questions they cost.
+ */
+#ifndef DNS_RESOLVER_BENCH_H
+
+#define DNS_RESOLVER_BENCH_H
+
+#ifndef dnsBenchMAX_LOOKUPS
+    #define dnsBenchMAX_LOOKUPS    100U
+#endif
+
+typedef struct xDNS_BENCH_RESULTS
+{
+    UBaseType_t uxLookups;       /* The number of look-ups started. */
+    UBaseType_t uxResolved;      /* The number of look-ups that returned an address. */
+    TickType_t xMinLatency;      /* The shortest time between the start and the answer of a look-up. */
+    TickType_t xMaxLatency;      /* The longest time between the start and the answer of a look-up. */
+    TickType_t xAverageLatency;  /* The average of the times of the resolved look-ups. */
+    TickType_t xDuration;        /* The time until the last look-up was finished. */
+    uint32_t ulQueriesSent;      /* The number of DNS questions sent. */
+    uint32_t ulQueriesCollapsed; /* The number of look-ups that waited for a question in flight. */
+    uint32_t ulSocketsCreated;   /* The number of sockets created by the DNS client. */
+} DNSBenchResults_t;
+
+/*
+ * Start uxLookups asynchronous look-ups at once, using the names in
+ * ppcNames[ 0 ] to ppcNames[ uxNameCount - 1 ] in turn.  Wait at most
+ * xTimeout ticks for all of them to finish.  The DNS cache is cleared
+ * before and after the measurement.  The results are printed and stored in
+ * pxResults, which may be NULL.
+ */
+extern BaseType_t xRunDNSResolverBenchmark( const char * const * ppcNames,
+                                            UBaseType_t uxNameCount,
+                                            UBaseType_t uxLookups,
+                                            TickType_t xTimeout,
+                                            DNSBenchResults_t * pxResults );
+
+#endif /* DNS_RESOLVER_BENCH_H */
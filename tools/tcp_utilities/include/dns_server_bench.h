@@ -0,0 +1,82 @@
+/*
+ * FreeRTOS+TCP V2.3.4
+ * Copyright (C) 2021 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/*
+ *  dns_server_bench.c
+ *  A stand-in DNS server that answers after an adjustable delay, and a
+ *  benchmark that measures the tail latency of DNS look-ups.
+ */
+#ifndef DNS_SERVER_BENCH_H
+
+#define DNS_SERVER_BENCH_H
+
+#ifndef dnsServerBenchMAX_LOOKUPS
+    #define dnsServerBenchMAX_LOOKUPS    200U
+#endif
+
+#ifndef dnsServerBenchSTACK_SIZE
+    #define dnsServerBenchSTACK_SIZE     ( configMINIMAL_STACK_SIZE * 2U )
+#endif
+
+typedef struct xDNS_SERVER_BENCH_RESULTS
+{
+    UBaseType_t uxLookups;  /* The number of look-ups done. */
+    UBaseType_t uxResolved; /* The number of look-ups that returned an address. */
+    TickType_t xP50;        /* Half of the look-ups took at most this many ticks. */
+    TickType_t xP90;        /* 90% of the look-ups took at most this many ticks. */
+    TickType_t xP99;        /* 99% of the look-ups took at most this many ticks. */
+    TickType_t xMax;        /* The slowest look-up, in ticks. */
+} DNSServerBenchResults_t;
+
+/*
+ * Start a task that answers every DNS question for an A record on UDP port 53
+ * with ulIPAddress (network byte order).  It is meant to run on a node of its
+ * own, which is then configured as one of the DNS servers of the node under
+ * test.  Returns pdFAIL when the task or its socket could not be created.
+ */
+extern BaseType_t xStartDNSStandIn( uint32_t ulIPAddress,
+                                    UBaseType_t uxPriority );
+
+/*
+ * Change the behaviour of the stand-in server: every answer is delayed by
+ * xDelay ticks, and uxDropPercent percent of the questions is not answered.
+ * May be called at any time.
+ */
+extern void vConfigureDNSStandIn( TickType_t xDelay,
+                                  UBaseType_t uxDropPercent );
+
+/*
+ * Look up uxLookups names one after the other with FreeRTOS_gethostbyname(),
+ * using the names in ppcNames[ 0 ] to ppcNames[ uxNameCount - 1 ] in turn.
+ * The DNS cache is cleared before every look-up.  The latency percentiles,
+ * and the ranking of the DNS servers, are printed.  The results are stored in
+ * pxResults, which may be NULL.
+ */
+extern BaseType_t xRunDNSServerBenchmark( const char * const * ppcNames,
+                                          UBaseType_t uxNameCount,
+                                          UBaseType_t uxLookups,
+                                          DNSServerBenchResults_t * pxResults );
+
+#endif /* DNS_SERVER_BENCH_H */
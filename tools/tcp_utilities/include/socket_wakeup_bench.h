@@ -0,0 +1,81 @@
+/*
+ * FreeRTOS+TCP V2.3.4
+ * Copyright (C) 2021 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/*
+ *  socket_wakeup_bench.c
+ *  A benchmark that measures how long it takes to wake up a task that is
+ *  blocked on a socket, with event groups or with task notifications.
+ */
+#ifndef SOCKET_WAKEUP_BENCH_H
+
+#define SOCKET_WAKEUP_BENCH_H
+
+/* A free running clock with a higher resolution than the tick count, for
+ * instance a cycle counter, may be supplied in FreeRTOSConfig.h. */
+#ifndef wakeupBenchGET_TIME
+    #define wakeupBenchGET_TIME()            ( ( uint32_t ) xTaskGetTickCount() )
+    #define wakeupBenchTIME_UNITS_PER_SEC    ( ( uint32_t ) configTICK_RATE_HZ )
+#endif
+
+#ifndef wakeupBenchPAYLOAD_SIZE
+    #define wakeupBenchPAYLOAD_SIZE    32U
+#endif
+
+typedef struct xWAKEUP_BENCH_RESULTS
+{
+    uint32_t ulIterations;      /* The number of iterations of each test. */
+    uint32_t ulBindAverageNs;   /* The average time of FreeRTOS_bind(), which waits for the IP-task, in ns. */
+    uint32_t ulEchoes;          /* The number of datagrams that were echoed. */
+    uint32_t ulEchoAverageNs;   /* The average round-trip time of a datagram, in ns. */
+    uint32_t ulSocketHeapBytes; /* The heap used by one bound UDP socket. */
+} WakeupBenchResults_t;
+
+/*
+ * Measure the cost of blocking on a socket in two ways.  First a UDP socket
+ * is created, bound and closed ulIterations times.  FreeRTOS_bind() hands the
+ * work to the IP-task and blocks until it is woken up with eSOCKET_BOUND, so
+ * this times a wake-up without any network traffic.  Then ulIterations
+ * datagrams are sent one by one to a UDP echo server at pxEchoServer, and the
+ * average round-trip time is measured.  pxEchoServer may be NULL to skip the
+ * second test.  The results are printed and stored in pxResults, which may be
+ * NULL.
+ */
+extern BaseType_t xRunSocketWakeupBenchmark( const struct freertos_sockaddr * pxEchoServer,
+                                             uint32_t ulIterations,
+                                             WakeupBenchResults_t * pxResults );
+
+/*
+ * Check that a closed connection wakes up a task that is blocked in
+ * FreeRTOS_send() and another task that is blocked in FreeRTOS_recv() on the
+ * same socket.  pxServer must accept the connection, not read anything, and
+ * close it after a while.  Both calls must return before xBlockTime, which is
+ * used as their send and receive time-outs.  The receiving task is created
+ * with priority uxPriority.  Returns pdPASS when they do.
+ */
+extern BaseType_t xRunSocketCloseWakeupCheck( struct freertos_sockaddr * pxServer,
+                                              TickType_t xBlockTime,
+                                              UBaseType_t uxPriority );
+
+#endif /* SOCKET_WAKEUP_BENCH_H */
@@ -0,0 +1,56 @@
+/*
+ * FreeRTOS+TCP V2.3.4
+ * Copyright (C) 2021 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/*
+ *  stream_buffer_bench.c
+ *  A benchmark that compares a power-of-two stream buffer with a stream
+ *  buffer of an arbitrary length, on the hot paths of TCP.
+ */
+#ifndef STREAM_BUFFER_BENCH_H
+
+#define STREAM_BUFFER_BENCH_H
+
+#ifndef streamBenchMAX_SEGMENT
+    #define streamBenchMAX_SEGMENT    ipconfigTCP_MSS
+#endif
+
+typedef struct xSTREAM_BENCH_RESULTS
+{
+    uint32_t ulGenericRounds; /* The number of rounds done with streams of an arbitrary length. */
+    uint32_t ulPow2Rounds;    /* The number of rounds done with power-of-two streams. */
+    TickType_t xDuration;     /* The duration of each run in ticks. */
+} StreamBenchResults_t;
+
+/*
+ * Run the stream operations of TCP for xDuration ticks on a pair of streams
+ * of uxLength + sizeof( size_t ) bytes, and then for xDuration ticks on a
+ * pair of streams of uxLength bytes.  uxLength must be a power of two.  The
+ * results are printed and stored in pxResults, which may be NULL.
+ */
+extern BaseType_t xRunStreamBufferBenchmark( size_t uxLength,
+                                             TickType_t xDuration,
+                                             StreamBenchResults_t * pxResults );
+
+#endif /* STREAM_BUFFER_BENCH_H */
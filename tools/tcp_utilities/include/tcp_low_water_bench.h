@@ -0,0 +1,65 @@
+/*
+ * FreeRTOS+TCP V2.3.4
+ * Copyright (C) 2021 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/*
+ *  tcp_low_water_bench.c
+ *  A benchmark that counts how often a task that reads a TCP stream is woken
+ *  up, with and without a receive low-water mark.
+ */
+#ifndef TCP_LOW_WATER_BENCH_H
+
+#define TCP_LOW_WATER_BENCH_H
+
+#ifndef lowWaterBenchCHUNK_SIZE
+    #define lowWaterBenchCHUNK_SIZE    100U
+#endif
+
+#ifndef lowWaterBenchSTACK_SIZE
+    #define lowWaterBenchSTACK_SIZE    ( configMINIMAL_STACK_SIZE * 2U )
+#endif
+
+typedef struct xLOW_WATER_BENCH_RESULTS
+{
+    size_t uxBytes;          /* The number of bytes that were received. */
+    uint32_t ulWakeUps;      /* The number of times that FreeRTOS_recv() returned data. */
+    TickType_t xDuration;    /* The time between the first and the last byte received, in ticks. */
+    TickType_t xTailLatency; /* The time between sending the last chunk and receiving it, in ticks. */
+} LowWaterBenchResults_t;
+
+/*
+ * Connect to an echo server at pxServer.  A helper task, running at priority
+ * uxPriority, sends uxTotalBytes in chunks of lowWaterBenchCHUNK_SIZE bytes,
+ * one chunk per clock tick.  The calling task reads the echo with blocking
+ * calls to FreeRTOS_recv() and counts the number of wake-ups.  When
+ * uxRcvLowat is larger than 1, it is set with FREERTOS_SO_RCVLOWAT.  The
+ * results are printed, and stored in pxResults, which may be NULL.
+ */
+extern BaseType_t xRunLowWaterBenchmark( struct freertos_sockaddr * pxServer,
+                                         size_t uxTotalBytes,
+                                         size_t uxRcvLowat,
+                                         UBaseType_t uxPriority,
+                                         LowWaterBenchResults_t * pxResults );
+
+#endif /* TCP_LOW_WATER_BENCH_H */
@@ -0,0 +1,65 @@
+/*
+ * FreeRTOS+TCP V2.3.4
+ * Copyright (C) 2021 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/*
+ *  tcp_stream_memory_bench.c
+ *  A benchmark that samples the memory used by the streams of a mix of idle
+ *  and active TCP connections over time.
+ */
+#ifndef TCP_STREAM_MEMORY_BENCH_H
+
+#define TCP_STREAM_MEMORY_BENCH_H
+
+#ifndef streamMemBenchMAX_CONNECTIONS
+    #define streamMemBenchMAX_CONNECTIONS    16U
+#endif
+
+#ifndef streamMemBenchBURST_SIZE
+    #define streamMemBenchBURST_SIZE    ( 4U * ipconfigTCP_MSS )
+#endif
+
+typedef struct xSTREAM_MEMORY_RESULTS
+{
+    size_t uxPeakStreamBytes;    /* The highest number of bytes in streams that was sampled. */
+    size_t uxAverageStreamBytes; /* The average of all samples. */
+    size_t uxPeakHeapUsed;       /* The highest heap usage since the start of the benchmark. */
+    uint32_t ulSamples;          /* The number of samples taken. */
+} StreamMemoryResults_t;
+
+/*
+ * Open uxConnections connections to an echo server at pxServer.  During each
+ * sample period, uxActive of them send a burst of data and read the echo,
+ * while the others stay idle.  The active group rotates every period.  After
+ * each period, the heap usage and the size of all streams are printed.  The
+ * results are stored in pxResults, which may be NULL.
+ */
+extern BaseType_t xRunStreamMemoryBenchmark( struct freertos_sockaddr * pxServer,
+                                             UBaseType_t uxConnections,
+                                             UBaseType_t uxActive,
+                                             TickType_t xDuration,
+                                             TickType_t xSamplePeriod,
+                                             StreamMemoryResults_t * pxResults );
+
+#endif /* TCP_STREAM_MEMORY_BENCH_H */
@@ -0,0 +1,319 @@
+/*
+ * FreeRTOS+TCP V2.3.4
+ * Copyright (C) 2021 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/*
+ * socket_wakeup_bench.c
+ * Measure the time needed to wake up a task that is blocked on a socket, to
+ * compare ipconfigSOCKET_USES_NOTIFY 0 (event groups) with 1 (task
+ * notifications).  See socket_wakeup_bench.md.
+ */
+
+/* Standard includes. */
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+
+/* FreeRTOS+TCP includes. */
+#include "FreeRTOS_IP.h"
+#include "FreeRTOS_Sockets.h"
+
+#include "socket_wakeup_bench.h"
+
+static uint32_t prvAverageNs( uint64_t ullTimeUnits,
+                              uint32_t ulCount );
+static BaseType_t prvBindTest( uint32_t ulIterations,
+                               WakeupBenchResults_t * pxResults );
+static BaseType_t prvEchoTest( const struct freertos_sockaddr * pxEchoServer,
+                               uint32_t ulIterations,
+                               WakeupBenchResults_t * pxResults );
+static void prvCloseCheckReceiver( void * pvParameters );
+
+/* The state shared with the receiving task of xRunSocketCloseWakeupCheck(). */
+typedef struct xCLOSE_CHECK_RECEIVER
+{
+    Socket_t xSocket;             /* The connected socket. */
+    SemaphoreHandle_t xDone;      /* Given when FreeRTOS_recv() has returned. */
+    TickType_t xElapsed;          /* The time spent in FreeRTOS_recv(). */
+    BaseType_t xResult;           /* The value returned by FreeRTOS_recv(). */
+} CloseCheckReceiver_t;
+
+/* The datagrams that are sent and echoed. */
+static uint8_t ucBenchData[ wakeupBenchPAYLOAD_SIZE ];
+static uint8_t ucBenchEcho[ wakeupBenchPAYLOAD_SIZE ];
+/*-----------------------------------------------------------*/
+
+static uint32_t prvAverageNs( uint64_t ullTimeUnits,
+                              uint32_t ulCount )
+{
+    uint64_t ullNs = ullTimeUnits * 1000000000U;
+
+    if( ulCount != 0U )
+    {
+        ullNs /= ( ( uint64_t ) ulCount ) * wakeupBenchTIME_UNITS_PER_SEC;
+    }
+
+    return ( uint32_t ) ullNs;
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvBindTest( uint32_t ulIterations,
+                               WakeupBenchResults_t * pxResults )
+{
+    struct freertos_sockaddr xAddress;
+    Socket_t xSocket;
+    uint32_t ulIndex;
+    uint32_t ulStart, ulTimed = 0U;
+    uint64_t ullTotal = 0U;
+    size_t uxFreeBefore;
+    BaseType_t xReturn = pdPASS;
+
+    ( void ) memset( &( xAddress ), 0, sizeof( xAddress ) );
+
+    for( ulIndex = 0U; ulIndex < ulIterations; ulIndex++ )
+    {
+        uxFreeBefore = xPortGetFreeHeapSize();
+        xSocket = FreeRTOS_socket( FREERTOS_AF_INET, FREERTOS_SOCK_DGRAM, FREERTOS_IPPROTO_UDP );
+
+        if( xSocket == FREERTOS_INVALID_SOCKET )
+        {
+            xReturn = pdFAIL;
+            break;
+        }
+
+        /* Port 0: let the IP-task choose a free port number. */
+        xAddress.sin_port = 0U;
+
+        /* Only the call to FreeRTOS_bind() is timed: it sends a message to the
+         * IP-task and blocks until the IP-task wakes it up. */
+        ulStart = wakeupBenchGET_TIME();
+
+        if( FreeRTOS_bind( xSocket, &( xAddress ), sizeof( xAddress ) ) != 0 )
+        {
+            xReturn = pdFAIL;
+        }
+
+        ullTotal += wakeupBenchGET_TIME() - ulStart;
+        ulTimed++;
+
+        if( ulIndex == 0U )
+        {
+            pxResults->ulSocketHeapBytes = ( uint32_t ) ( uxFreeBefore - xPortGetFreeHeapSize() );
+        }
+
+        ( void ) FreeRTOS_closesocket( xSocket );
+
+        if( xReturn != pdPASS )
+        {
+            break;
+        }
+    }
+
+    pxResults->ulBindAverageNs = prvAverageNs( ullTotal, ulTimed );
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvEchoTest( const struct freertos_sockaddr * pxEchoServer,
+                               uint32_t ulIterations,
+                               WakeupBenchResults_t * pxResults )
+{
+    struct freertos_sockaddr xFrom;
+    socklen_t xFromLength = sizeof( xFrom );
+    TickType_t xTimeout = pdMS_TO_TICKS( 100U );
+    Socket_t xSocket;
+    uint32_t ulIndex;
+    uint32_t ulStart;
+    uint64_t ullTotal = 0U;
+    int32_t lCount;
+    BaseType_t xReturn = pdFAIL;
+
+    xSocket = FreeRTOS_socket( FREERTOS_AF_INET, FREERTOS_SOCK_DGRAM, FREERTOS_IPPROTO_UDP );
+
+    if( xSocket != FREERTOS_INVALID_SOCKET )
+    {
+        ( void ) FreeRTOS_setsockopt( xSocket, 0, FREERTOS_SO_RCVTIMEO, &( xTimeout ), sizeof( xTimeout ) );
+
+        for( ulIndex = 0U; ulIndex < ulIterations; ulIndex++ )
+        {
+            ( void ) memset( ucBenchData, ( int ) ( ulIndex & 0xffU ), sizeof( ucBenchData ) );
+
+            ulStart = wakeupBenchGET_TIME();
+            ( void ) FreeRTOS_sendto( xSocket, ucBenchData, sizeof( ucBenchData ), 0, pxEchoServer, sizeof( *pxEchoServer ) );
+            lCount = FreeRTOS_recvfrom( xSocket, ucBenchEcho, sizeof( ucBenchEcho ), 0, &( xFrom ), &( xFromLength ) );
+
+            /* A lost datagram is not counted, it would only measure the
+             * time-out. */
+            if( ( lCount == ( int32_t ) sizeof( ucBenchEcho ) ) &&
+                ( memcmp( ucBenchData, ucBenchEcho, sizeof( ucBenchEcho ) ) == 0 ) )
+            {
+                ullTotal += wakeupBenchGET_TIME() - ulStart;
+                pxResults->ulEchoes++;
+            }
+        }
+
+        ( void ) FreeRTOS_closesocket( xSocket );
+
+        pxResults->ulEchoAverageNs = prvAverageNs( ullTotal, pxResults->ulEchoes );
+
+        if( pxResults->ulEchoes != 0U )
+        {
+            xReturn = pdPASS;
+        }
+    }
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xRunSocketWakeupBenchmark( const struct freertos_sockaddr * pxEchoServer,
+                                      uint32_t ulIterations,
+                                      WakeupBenchResults_t * pxResults )
+{
+    WakeupBenchResults_t xResults;
+    BaseType_t xReturn;
+
+    ( void ) memset( &( xResults ), 0, sizeof( xResults ) );
+    xResults.ulIterations = ulIterations;
+
+    FreeRTOS_printf( ( "Wake-up bench: %s, %lu iterations\n",
+                       ( ipconfigSOCKET_USES_NOTIFY != 0 ) ? "task notifications" : "event groups",
+                       ( unsigned long ) ulIterations ) );
+
+    xReturn = prvBindTest( ulIterations, &( xResults ) );
+
+    FreeRTOS_printf( ( "Wake-up bench: bind %lu ns, socket uses %lu bytes of heap\n",
+                       ( unsigned long ) xResults.ulBindAverageNs,
+                       ( unsigned long ) xResults.ulSocketHeapBytes ) );
+
+    if( ( xReturn == pdPASS ) && ( pxEchoServer != NULL ) )
+    {
+        xReturn = prvEchoTest( pxEchoServer, ulIterations, &( xResults ) );
+
+        FreeRTOS_printf( ( "Wake-up bench: echo %lu ns, %lu of %lu datagrams echoed\n",
+                           ( unsigned long ) xResults.ulEchoAverageNs,
+                           ( unsigned long ) xResults.ulEchoes,
+                           ( unsigned long ) ulIterations ) );
+    }
+
+    if( pxResults != NULL )
+    {
+        *pxResults = xResults;
+    }
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+static void prvCloseCheckReceiver( void * pvParameters )
+{
+    CloseCheckReceiver_t * pxReceiver = ( CloseCheckReceiver_t * ) pvParameters;
+    TickType_t xStart = xTaskGetTickCount();
+
+    /* The peer does not send anything: only the closure wakes up this task. */
+    pxReceiver->xResult = FreeRTOS_recv( pxReceiver->xSocket, ucBenchEcho, sizeof( ucBenchEcho ), 0 );
+    pxReceiver->xElapsed = xTaskGetTickCount() - xStart;
+
+    ( void ) xSemaphoreGive( pxReceiver->xDone );
+    vTaskDelete( NULL );
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xRunSocketCloseWakeupCheck( struct freertos_sockaddr * pxServer,
+                                       TickType_t xBlockTime,
+                                       UBaseType_t uxPriority )
+{
+    static CloseCheckReceiver_t xReceiver;
+    TickType_t xStart, xSendElapsed = 0U;
+    BaseType_t xSent = 0, xSendResult = 0;
+    BaseType_t xReturn = pdFAIL;
+
+    ( void ) memset( &( xReceiver ), 0, sizeof( xReceiver ) );
+    xReceiver.xDone = xSemaphoreCreateBinary();
+    xReceiver.xSocket = FreeRTOS_socket( FREERTOS_AF_INET, FREERTOS_SOCK_STREAM, FREERTOS_IPPROTO_TCP );
+
+    if( ( xReceiver.xDone != NULL ) && ( xReceiver.xSocket != FREERTOS_INVALID_SOCKET ) )
+    {
+        ( void ) FreeRTOS_setsockopt( xReceiver.xSocket, 0, FREERTOS_SO_RCVTIMEO, &( xBlockTime ), sizeof( xBlockTime ) );
+        ( void ) FreeRTOS_setsockopt( xReceiver.xSocket, 0, FREERTOS_SO_SNDTIMEO, &( xBlockTime ), sizeof( xBlockTime ) );
+
+        if( ( FreeRTOS_connect( xReceiver.xSocket, pxServer, sizeof( *pxServer ) ) == 0 ) &&
+            ( xTaskCreate( prvCloseCheckReceiver, "CloseRx", configMINIMAL_STACK_SIZE * 2U, &( xReceiver ),
+                           uxPriority, NULL ) == pdPASS ) )
+        {
+            /* The peer does not read: send until the stream is full and this
+             * task blocks, until the peer closes the connection.  Only the
+             * last call to FreeRTOS_send() is timed. */
+            do
+            {
+                xStart = xTaskGetTickCount();
+                xSendResult = FreeRTOS_send( xReceiver.xSocket, ucBenchData, sizeof( ucBenchData ), 0 );
+                xSendElapsed = xTaskGetTickCount() - xStart;
+
+                if( xSendResult > 0 )
+                {
+                    xSent += xSendResult;
+                }
+            } while( xSendResult > 0 );
+
+            /* FreeRTOS_recv() returns at the latest when its block time has
+             * expired, the socket can not be closed before that. */
+            ( void ) xSemaphoreTake( xReceiver.xDone, portMAX_DELAY );
+
+            /* Both calls must have been woken up by the closure, before their
+             * block time expired. */
+            if( ( xSendElapsed < xBlockTime ) && ( xReceiver.xResult < 0 ) && ( xReceiver.xElapsed < xBlockTime ) )
+            {
+                xReturn = pdPASS;
+            }
+        }
+    }
+
+    FreeRTOS_printf( ( "Close wake-up check: %s, sent %ld bytes, send %ld after %lu ms, recv %ld after %lu ms: %s\n",
+                       ( ipconfigSOCKET_USES_NOTIFY != 0 ) ? "task notifications" : "event groups",
+                       ( long ) xSent,
+                       ( long ) xSendResult,
+                       ( unsigned long ) ( xSendElapsed * portTICK_PERIOD_MS ),
+                       ( long ) xReceiver.xResult,
+                       ( unsigned long ) ( xReceiver.xElapsed * portTICK_PERIOD_MS ),
+                       ( xReturn == pdPASS ) ? "passed" : "FAILED" ) );
+
+    if( xReceiver.xSocket != FREERTOS_INVALID_SOCKET )
+    {
+        ( void ) FreeRTOS_closesocket( xReceiver.xSocket );
+    }
+
+    if( xReceiver.xDone != NULL )
+    {
+        vSemaphoreDelete( xReceiver.xDone );
+    }
+
+    return xReturn;
+}
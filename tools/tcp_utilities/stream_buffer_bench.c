@@ -0,0 +1,250 @@
+/*
+ * FreeRTOS+TCP V2.3.4
+ * Copyright (C) 2021 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/*
+ * stream_buffer_bench.c
+ * Compare the speed of a power-of-two stream buffer with the speed of a
+ * stream buffer of an arbitrary length.  The benchmark repeats the stream
+ * operations of the TCP transmit and receive paths.  See stream_buffer_bench.md.
+ */
+
+/* Standard includes. */
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* FreeRTOS+TCP includes. */
+#include "FreeRTOS_IP.h"
+#include "FreeRTOS_Sockets.h"
+#include "FreeRTOS_IP_Private.h"
+#include "FreeRTOS_Stream_Buffer.h"
+
+#include "stream_buffer_bench.h"
+
+static StreamBuffer_t * prvCreateStream( size_t uxLength );
+static BaseType_t prvRunRound( StreamBuffer_t * pxTxStream,
+                               StreamBuffer_t * pxRxStream,
+                               size_t uxSegment,
+                               uint8_t ucPattern );
+static uint32_t prvMeasure( StreamBuffer_t * pxTxStream,
+                            StreamBuffer_t * pxRxStream,
+                            size_t uxSegment,
+                            TickType_t xDuration,
+                            BaseType_t * pxErrors );
+
+/* The data that is sent and received, and a copy of it. */
+static uint8_t ucBenchData[ streamBenchMAX_SEGMENT ];
+static uint8_t ucBenchCopy[ 2U * streamBenchMAX_SEGMENT ];
+/*-----------------------------------------------------------*/
+
+static StreamBuffer_t * prvCreateStream( size_t uxLength )
+{
+    StreamBuffer_t * pxBuffer;
+    size_t uxSize = ( sizeof( *pxBuffer ) + uxLength ) - sizeof( pxBuffer->ucArray );
+
+    pxBuffer = ( StreamBuffer_t * ) pvPortMalloc( uxSize );
+
+    if( pxBuffer != NULL )
+    {
+        ( void ) memset( pxBuffer, 0, sizeof( *pxBuffer ) - sizeof( pxBuffer->ucArray ) );
+        vStreamBufferInit( pxBuffer, uxLength );
+    }
+
+    return pxBuffer;
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvRunRound( StreamBuffer_t * pxTxStream,
+                               StreamBuffer_t * pxRxStream,
+                               size_t uxSegment,
+                               uint8_t ucPattern )
+{
+    size_t uxPosition, uxOffset;
+    BaseType_t xErrors = 0;
+
+    ( void ) memset( ucBenchData, ( int ) ucPattern, uxSegment );
+
+    /* Transmission: FreeRTOS_send() adds the data to the stream,
+     * prvTCPAddTxData() passes it to the sliding window, prvTCPPrepareSend()
+     * peeks at the segment, and an ACK removes the oldest segment. */
+    ( void ) uxStreamBufferAdd( pxTxStream, 0U, ucBenchData, uxSegment );
+    uxPosition = uxStreamBufferIndex( pxTxStream, pxTxStream->uxMid );
+    vStreamBufferMoveMid( pxTxStream, uxStreamBufferMidSpace( pxTxStream ) );
+    uxOffset = uxStreamBufferDistance( pxTxStream, pxTxStream->uxTail, uxPosition );
+
+    if( uxStreamBufferGet( pxTxStream, uxOffset, ucBenchCopy, uxSegment, pdTRUE ) != uxSegment )
+    {
+        xErrors++;
+    }
+    else if( ucBenchCopy[ uxSegment - 1U ] != ucPattern )
+    {
+        xErrors++;
+    }
+    else
+    {
+        /* The data was peeked correctly. */
+    }
+
+    if( uxStreamBufferGetSize( pxTxStream ) >= ( 2U * uxSegment ) )
+    {
+        ( void ) uxStreamBufferGet( pxTxStream, 0U, NULL, uxSegment, pdFALSE );
+    }
+
+    /* Reception: a segment arrives out of order, followed by the missing
+     * segment.  The head is then moved over the data that was stored already,
+     * and the user reads both segments. */
+    ( void ) uxStreamBufferAdd( pxRxStream, uxSegment, ucBenchData, uxSegment );
+    ( void ) uxStreamBufferAdd( pxRxStream, 0U, ucBenchData, uxSegment );
+    ( void ) uxStreamBufferAdd( pxRxStream, 0U, NULL, uxSegment );
+    ( void ) uxStreamBufferFrontSpace( pxRxStream );
+
+    if( uxStreamBufferGet( pxRxStream, 0U, ucBenchCopy, 2U * uxSegment, pdFALSE ) != ( 2U * uxSegment ) )
+    {
+        xErrors++;
+    }
+    else if( ( ucBenchCopy[ 0 ] != ucPattern ) || ( ucBenchCopy[ ( 2U * uxSegment ) - 1U ] != ucPattern ) )
+    {
+        xErrors++;
+    }
+    else
+    {
+        /* The data was received correctly. */
+    }
+
+    return xErrors;
+}
+/*-----------------------------------------------------------*/
+
+static uint32_t prvMeasure( StreamBuffer_t * pxTxStream,
+                            StreamBuffer_t * pxRxStream,
+                            size_t uxSegment,
+                            TickType_t xDuration,
+                            BaseType_t * pxErrors )
+{
+    uint32_t ulRounds = 0U;
+    TickType_t xStartTime;
+
+    vStreamBufferClear( pxTxStream );
+    vStreamBufferClear( pxRxStream );
+
+    /* Start at the beginning of a tick. */
+    xStartTime = xTaskGetTickCount();
+
+    while( xTaskGetTickCount() == xStartTime )
+    {
+    }
+
+    xStartTime = xTaskGetTickCount();
+
+    while( ( xTaskGetTickCount() - xStartTime ) < xDuration )
+    {
+        *pxErrors += prvRunRound( pxTxStream, pxRxStream, uxSegment, ( uint8_t ) ulRounds );
+        ulRounds++;
+    }
+
+    return ulRounds;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xRunStreamBufferBenchmark( size_t uxLength,
+                                      TickType_t xDuration,
+                                      StreamBenchResults_t * pxResults )
+{
+    StreamBenchResults_t xResults;
+    StreamBuffer_t * pxStreams[ 4 ] = { NULL, NULL, NULL, NULL };
+    size_t uxSegment;
+    UBaseType_t uxIndex;
+    BaseType_t xErrors = 0;
+    BaseType_t xReturn = pdFAIL;
+
+    uxSegment = FreeRTOS_min_uint32( ( uint32_t ) ( uxLength / 4U ), streamBenchMAX_SEGMENT );
+
+    if( ( uxLength < 4U ) || ( ( uxLength & ( uxLength - 1U ) ) != 0U ) )
+    {
+        FreeRTOS_printf( ( "Stream benchmark: %u is not a power of two\n", ( unsigned ) uxLength ) );
+    }
+    else
+    {
+        /* The streams of arbitrary length get an extra word, like
+         * prvTCPCreateStream() does. */
+        pxStreams[ 0 ] = prvCreateStream( uxLength + sizeof( size_t ) );
+        pxStreams[ 1 ] = prvCreateStream( uxLength + sizeof( size_t ) );
+        pxStreams[ 2 ] = prvCreateStream( uxLength );
+        pxStreams[ 3 ] = prvCreateStream( uxLength );
+    }
+
+    if( ( pxStreams[ 0 ] != NULL ) && ( pxStreams[ 1 ] != NULL ) &&
+        ( pxStreams[ 2 ] != NULL ) && ( pxStreams[ 3 ] != NULL ) )
+    {
+        #if ( ipconfigUSE_POW2_STREAM_BUFFERS != 1 )
+            {
+                FreeRTOS_printf( ( "Stream benchmark: ipconfigUSE_POW2_STREAM_BUFFERS is not enabled\n" ) );
+            }
+        #endif
+
+        xResults.xDuration = xDuration;
+        xResults.ulGenericRounds = prvMeasure( pxStreams[ 0 ], pxStreams[ 1 ], uxSegment, xDuration, &( xErrors ) );
+        xResults.ulPow2Rounds = prvMeasure( pxStreams[ 2 ], pxStreams[ 3 ], uxSegment, xDuration, &( xErrors ) );
+
+        FreeRTOS_printf( ( "Stream benchmark: length %u segment %u ticks %u\n",
+                           ( unsigned ) uxLength, ( unsigned ) uxSegment, ( unsigned ) xDuration ) );
+        FreeRTOS_printf( ( "Stream benchmark: generic %lu rounds power-of-two %lu rounds\n",
+                           ( unsigned long ) xResults.ulGenericRounds, ( unsigned long ) xResults.ulPow2Rounds ) );
+
+        if( xResults.ulGenericRounds > 0U )
+        {
+            FreeRTOS_printf( ( "Stream benchmark: power-of-two at %lu%% of the generic time\n",
+                               ( unsigned long ) ( ( ( uint64_t ) xResults.ulGenericRounds * 100U ) / FreeRTOS_max_uint32( xResults.ulPow2Rounds, 1U ) ) ) );
+        }
+
+        if( xErrors == 0 )
+        {
+            xReturn = pdPASS;
+        }
+        else
+        {
+            FreeRTOS_printf( ( "Stream benchmark: %d errors in the data\n", ( int ) xErrors ) );
+        }
+
+        if( pxResults != NULL )
+        {
+            *pxResults = xResults;
+        }
+    }
+
+    for( uxIndex = 0U; uxIndex < 4U; uxIndex++ )
+    {
+        if( pxStreams[ uxIndex ] != NULL )
+        {
+            vPortFree( pxStreams[ uxIndex ] );
+        }
+    }
+
+    return xReturn;
+}
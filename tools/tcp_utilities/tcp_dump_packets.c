@@ -208,8 +208,7 @@
             uxSize = ( sizeof( *xPacketBuffer ) + uxLength ) - sizeof( xPacketBuffer->ucArray );
             xPacketBuffer = ( StreamBuffer_t * ) pvPortMalloc( uxSize );
             configASSERT( xPacketBuffer != NULL );
-            vStreamBufferClear( xPacketBuffer );
-            xPacketBuffer->LENGTH = uxLength;
+            vStreamBufferInit( xPacketBuffer, uxLength );
         }
 
         if( pvProcessHandle == NULL )
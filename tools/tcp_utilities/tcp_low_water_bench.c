@@ -0,0 +1,209 @@
+/*
+ * FreeRTOS+TCP V2.3.4
+ * Copyright (C) 2021 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/*
+ * tcp_low_water_bench.c
+ * Count the number of times that a task reading a TCP stream is woken up,
+ * to show the effect of FREERTOS_SO_RCVLOWAT.  See tcp_low_water_bench.md.
+ */
+
+/* Standard includes. */
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* FreeRTOS+TCP includes. */
+#include "FreeRTOS_IP.h"
+#include "FreeRTOS_Sockets.h"
+
+#include "tcp_low_water_bench.h"
+
+static void prvSenderTask( void * pvParameters );
+
+/* The socket that is shared between the sender and the reader. */
+static Socket_t xBenchSocket;
+
+/* The number of bytes that the sender task must send. */
+static size_t uxBenchToSend;
+
+/* Set by the sender task when it has sent the last chunk. */
+static volatile BaseType_t xBenchSenderDone;
+static volatile TickType_t xBenchLastSent;
+
+/* The data that is sent, and the buffer for the echo. */
+static uint8_t ucBenchData[ lowWaterBenchCHUNK_SIZE ];
+static uint8_t ucBenchEcho[ 4U * ipconfigTCP_MSS ];
+/*-----------------------------------------------------------*/
+
+static void prvSenderTask( void * pvParameters )
+{
+    size_t uxSent = 0U;
+    size_t uxLength;
+    BaseType_t xResult;
+
+    ( void ) pvParameters;
+
+    while( uxSent < uxBenchToSend )
+    {
+        uxLength = uxBenchToSend - uxSent;
+
+        if( uxLength > sizeof( ucBenchData ) )
+        {
+            uxLength = sizeof( ucBenchData );
+        }
+
+        xResult = FreeRTOS_send( xBenchSocket, ucBenchData, uxLength, 0 );
+
+        if( xResult <= 0 )
+        {
+            break;
+        }
+
+        uxSent += ( size_t ) xResult;
+
+        /* A trickle of small chunks, like a sensor or a logging stream. */
+        vTaskDelay( 1U );
+    }
+
+    xBenchLastSent = xTaskGetTickCount();
+    xBenchSenderDone = pdTRUE;
+    vTaskDelete( NULL );
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xRunLowWaterBenchmark( struct freertos_sockaddr * pxServer,
+                                  size_t uxTotalBytes,
+                                  size_t uxRcvLowat,
+                                  UBaseType_t uxPriority,
+                                  LowWaterBenchResults_t * pxResults )
+{
+    LowWaterBenchResults_t xResults;
+    TickType_t xTimeout = pdMS_TO_TICKS( 2000U );
+    TickType_t xFirstTime = 0U, xLastTime = 0U;
+    BaseType_t xCount;
+    BaseType_t xReturn = pdFAIL;
+
+    ( void ) memset( &( xResults ), 0, sizeof( xResults ) );
+    ( void ) memset( ucBenchData, 'L', sizeof( ucBenchData ) );
+
+    xBenchSocket = FreeRTOS_socket( FREERTOS_AF_INET, FREERTOS_SOCK_STREAM, FREERTOS_IPPROTO_TCP );
+
+    if( xBenchSocket == FREERTOS_INVALID_SOCKET )
+    {
+        FreeRTOS_printf( ( "Low-water bench: no socket\n" ) );
+    }
+    else
+    {
+        ( void ) FreeRTOS_setsockopt( xBenchSocket, 0, FREERTOS_SO_RCVTIMEO, &( xTimeout ), sizeof( xTimeout ) );
+        ( void ) FreeRTOS_setsockopt( xBenchSocket, 0, FREERTOS_SO_SNDTIMEO, &( xTimeout ), sizeof( xTimeout ) );
+
+        if( uxRcvLowat > 1U )
+        {
+            #if ( ipconfigTCP_WAKEUP_LOW_WATER == 1 )
+                {
+                    ( void ) FreeRTOS_setsockopt( xBenchSocket, 0, FREERTOS_SO_RCVLOWAT, &( uxRcvLowat ), sizeof( uxRcvLowat ) );
+                }
+            #else
+                {
+                    FreeRTOS_printf( ( "Low-water bench: ipconfigTCP_WAKEUP_LOW_WATER is not enabled\n" ) );
+                }
+            #endif
+        }
+
+        if( FreeRTOS_connect( xBenchSocket, pxServer, sizeof( *pxServer ) ) != 0 )
+        {
+            FreeRTOS_printf( ( "Low-water bench: connect failed\n" ) );
+        }
+        else
+        {
+            uxBenchToSend = uxTotalBytes;
+            xBenchSenderDone = pdFALSE;
+
+            if( xTaskCreate( prvSenderTask, "LowWaterTx", lowWaterBenchSTACK_SIZE, NULL, uxPriority, NULL ) == pdPASS )
+            {
+                /* Every return with data counts as a wake-up of this task. */
+                while( xResults.uxBytes < uxTotalBytes )
+                {
+                    xCount = FreeRTOS_recv( xBenchSocket, ucBenchEcho, sizeof( ucBenchEcho ), 0 );
+
+                    if( xCount <= 0 )
+                    {
+                        break;
+                    }
+
+                    xLastTime = xTaskGetTickCount();
+
+                    if( xResults.ulWakeUps == 0U )
+                    {
+                        xFirstTime = xLastTime;
+                    }
+
+                    xResults.ulWakeUps++;
+                    xResults.uxBytes += ( size_t ) xCount;
+                }
+
+                /* Do not close the socket while the sender is still using it. */
+                while( xBenchSenderDone == pdFALSE )
+                {
+                    vTaskDelay( 1U );
+                }
+
+                xResults.xDuration = xLastTime - xFirstTime;
+                xResults.xTailLatency = xLastTime - xBenchLastSent;
+
+                FreeRTOS_printf( ( "Low-water bench: RCVLOWAT %u: %u bytes in %lu wake-ups, %lu bytes per wake-up\n",
+                                   ( unsigned ) uxRcvLowat,
+                                   ( unsigned ) xResults.uxBytes,
+                                   ( unsigned long ) xResults.ulWakeUps,
+                                   ( unsigned long ) ( ( xResults.ulWakeUps != 0U ) ? ( xResults.uxBytes / xResults.ulWakeUps ) : 0U ) ) );
+                FreeRTOS_printf( ( "Low-water bench: %lu ms, the last chunk arrived after %lu ms\n",
+                                   ( unsigned long ) ( xResults.xDuration * portTICK_PERIOD_MS ),
+                                   ( unsigned long ) ( xResults.xTailLatency * portTICK_PERIOD_MS ) ) );
+
+                if( xResults.uxBytes == uxTotalBytes )
+                {
+                    xReturn = pdPASS;
+                }
+                else
+                {
+                    FreeRTOS_printf( ( "Low-water bench: %u bytes missing\n", ( unsigned ) ( uxTotalBytes - xResults.uxBytes ) ) );
+                }
+            }
+        }
+
+        ( void ) FreeRTOS_closesocket( xBenchSocket );
+    }
+
+    if( pxResults != NULL )
+    {
+        *pxResults = xResults;
+    }
+
+    return xReturn;
+}
@@ -309,6 +309,35 @@
                             xCurrentLine ) );
             uxStaticSize += uxBytes;
 
+            #if ( ipconfigUSE_ARP_HASH == 1 )
+                {
+                    /* The IP index, the optional MAC index, and the LRU links. */
+                    uxEntrySize = ( ipconfigARP_HASH_MAC_INDEX == 1 ) ? 2U * sizeof( uint16_t ) : sizeof( uint16_t );
+                    uxBytes = ( ipconfigARP_HASH_SIZE * uxEntrySize ) + ( ipconfigARP_CACHE_ENTRIES * 2U * sizeof( uint16_t ) );
+                    STATS_PRINTF( ( "TCPMemStat,ARP_HASH_SIZE,%u,%u,=B%d*C%d+%u\n",
+                                    ipconfigARP_HASH_SIZE,
+                                    uxEntrySize,
+                                    xCurrentLine,
+                                    xCurrentLine,
+                                    ipconfigARP_CACHE_ENTRIES * 2U * sizeof( uint16_t ) ) );
+                    uxStaticSize += uxBytes;
+                }
+            #endif
+
+            #if ( ipconfigUSE_ARP_DEADLINE_AGING == 1 )
+                {
+                    /* The heap, the heap positions, the deadlines and the event times. */
+                    uxEntrySize = ( 2U * sizeof( uint16_t ) ) + ( 2U * sizeof( uint32_t ) );
+                    uxBytes = ipconfigARP_CACHE_ENTRIES * uxEntrySize;
+                    STATS_PRINTF( ( "TCPMemStat,ARP_DEADLINE_AGING,%u,%u,=B%d*C%d\n",
+                                    ipconfigARP_CACHE_ENTRIES,
+                                    uxEntrySize,
+                                    xCurrentLine,
+                                    xCurrentLine ) );
+                    uxStaticSize += uxBytes;
+                }
+            #endif
+
             #if ( ipconfigUSE_DNS_CACHE == 1 )
                 {
                     uxEntrySize = 3u * sizeof( uint32_t ) + ( ( ipconfigDNS_CACHE_NAME_LENGTH + 3 ) & ~0x3u );
@@ -319,6 +348,49 @@
                                     xCurrentLine ) );
                 }
             #endif
+
+            #if ( ipconfigUSE_DNS_CACHE == 1 ) && ( ipconfigUSE_DNS_CACHE_HASH == 1 )
+                {
+                    /* The hash index, plus the hash and the LRU links of every entry. */
+                    uxEntrySize = sizeof( uint16_t );
+                    uxBytes = ( ipconfigDNS_CACHE_HASH_SIZE * uxEntrySize ) + ( ipconfigDNS_CACHE_ENTRIES * ( sizeof( uint32_t ) + ( 2U * sizeof( uint16_t ) ) ) );
+                    STATS_PRINTF( ( "TCPMemStat,DNS_CACHE_HASH_SIZE,%u,%u,=B%d*C%d+%u\n",
+                                    ipconfigDNS_CACHE_HASH_SIZE,
+                                    uxEntrySize,
+                                    xCurrentLine,
+                                    xCurrentLine,
+                                    ipconfigDNS_CACHE_ENTRIES * ( sizeof( uint32_t ) + ( 2U * sizeof( uint16_t ) ) ) ) );
+                    uxStaticSize += uxBytes;
+                }
+            #endif
+
+            #if ( ipconfigUSE_DNS != 0 ) && ( ipconfigDNS_USE_RESOLVER == 1 )
+                {
+                    /* The identifier, the attempts, the time-out and the name of a question in flight. */
+                    uxEntrySize = ( 3u * sizeof( uint32_t ) ) + sizeof( TimeOut_t ) + ( ( ipconfigDNS_CACHE_NAME_LENGTH + 3 ) & ~0x3u );
+                    uxBytes = ipconfigDNS_RESOLVER_REQUESTS * uxEntrySize;
+                    STATS_PRINTF( ( "TCPMemStat,DNS_RESOLVER_REQUESTS,%u,%u,=B%d*C%d\n",
+                                    ipconfigDNS_RESOLVER_REQUESTS,
+                                    uxEntrySize,
+                                    xCurrentLine,
+                                    xCurrentLine ) );
+                    uxStaticSize += uxBytes;
+                }
+            #endif
+
+            #if ( ipconfigUSE_DNS != 0 ) && ( ipconfigDNS_MAX_SERVERS > 1 )
+                {
+                    /* The address, the RTT, the answers, the send time and the state of a server. */
+                    uxEntrySize = ( 3u * sizeof( uint32_t ) ) + sizeof( TickType_t ) + sizeof( uint32_t );
+                    uxBytes = ipconfigDNS_MAX_SERVERS * uxEntrySize;
+                    STATS_PRINTF( ( "TCPMemStat,DNS_MAX_SERVERS,%u,%u,=B%d*C%d\n",
+                                    ipconfigDNS_MAX_SERVERS,
+                                    uxEntrySize,
+                                    xCurrentLine,
+                                    xCurrentLine ) );
+                    uxStaticSize += uxBytes;
+                }
+            #endif
         }
 
         /*
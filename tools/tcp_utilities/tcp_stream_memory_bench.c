@@ -0,0 +1,289 @@
+/*
+ * FreeRTOS+TCP V2.3.4
+ * Copyright (C) 2021 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/*
+ * tcp_stream_memory_bench.c
+ * Sample the memory that is used by the streams of a realistic mix of idle and
+ * active TCP connections over time.  It shows the effect of
+ * ipconfigUSE_TCP_ELASTIC_STREAMS.  See tcp_stream_memory_bench.md.
+ */
+
+/* Standard includes. */
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* FreeRTOS+TCP includes. */
+#include "FreeRTOS_IP.h"
+#include "FreeRTOS_Sockets.h"
+#include "FreeRTOS_IP_Private.h"
+#include "FreeRTOS_Stream_Buffer.h"
+
+#include "tcp_stream_memory_bench.h"
+
+static Socket_t prvConnect( struct freertos_sockaddr * pxServer );
+static BaseType_t prvExchange( Socket_t xSocket,
+                               uint8_t ucPattern );
+static size_t prvStreamBytes( const Socket_t * pxSockets,
+                              UBaseType_t uxCount,
+                              UBaseType_t * puxStreams );
+
+/* The data that is sent and echoed. */
+static uint8_t ucBenchData[ streamMemBenchBURST_SIZE ];
+static uint8_t ucBenchEcho[ streamMemBenchBURST_SIZE ];
+/*-----------------------------------------------------------*/
+
+static Socket_t prvConnect( struct freertos_sockaddr * pxServer )
+{
+    Socket_t xSocket;
+    TickType_t xTimeout = pdMS_TO_TICKS( 250U );
+
+    xSocket = FreeRTOS_socket( FREERTOS_AF_INET, FREERTOS_SOCK_STREAM, FREERTOS_IPPROTO_TCP );
+
+    if( xSocket == FREERTOS_INVALID_SOCKET )
+    {
+        xSocket = NULL;
+    }
+    else
+    {
+        ( void ) FreeRTOS_setsockopt( xSocket, 0, FREERTOS_SO_RCVTIMEO, &( xTimeout ), sizeof( xTimeout ) );
+        ( void ) FreeRTOS_setsockopt( xSocket, 0, FREERTOS_SO_SNDTIMEO, &( xTimeout ), sizeof( xTimeout ) );
+
+        if( FreeRTOS_connect( xSocket, pxServer, sizeof( *pxServer ) ) != 0 )
+        {
+            ( void ) FreeRTOS_closesocket( xSocket );
+            xSocket = NULL;
+        }
+    }
+
+    return xSocket;
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvExchange( Socket_t xSocket,
+                               uint8_t ucPattern )
+{
+    BaseType_t xSent, xReceived = 0, xCount;
+    BaseType_t xErrors = 0;
+
+    ( void ) memset( ucBenchData, ( int ) ucPattern, sizeof( ucBenchData ) );
+
+    xSent = FreeRTOS_send( xSocket, ucBenchData, sizeof( ucBenchData ), 0 );
+
+    /* Read the echo, the socket has a time-out for reception. */
+    while( xReceived < xSent )
+    {
+        xCount = FreeRTOS_recv( xSocket, ucBenchEcho, ( size_t ) ( xSent - xReceived ), 0 );
+
+        if( xCount <= 0 )
+        {
+            break;
+        }
+
+        if( ( ucBenchEcho[ 0 ] != ucPattern ) || ( ucBenchEcho[ xCount - 1 ] != ucPattern ) )
+        {
+            xErrors++;
+        }
+
+        xReceived += xCount;
+    }
+
+    if( ( xSent <= 0 ) || ( xReceived != xSent ) )
+    {
+        xErrors++;
+    }
+
+    return xErrors;
+}
+/*-----------------------------------------------------------*/
+
+static size_t prvStreamBytes( const Socket_t * pxSockets,
+                              UBaseType_t uxCount,
+                              UBaseType_t * puxStreams )
+{
+    const FreeRTOS_Socket_t * pxSocket;
+    size_t uxBytes = 0U;
+    UBaseType_t uxIndex;
+
+    *puxStreams = 0U;
+
+    /* The IP-task may create, grow or release streams in the mean time. */
+    vTaskSuspendAll();
+    {
+        for( uxIndex = 0U; uxIndex < uxCount; uxIndex++ )
+        {
+            pxSocket = ( const FreeRTOS_Socket_t * ) pxSockets[ uxIndex ];
+
+            if( pxSocket->u.xTCP.rxStream != NULL )
+            {
+                uxBytes += pxSocket->u.xTCP.rxStream->LENGTH;
+                ( *puxStreams )++;
+            }
+
+            if( pxSocket->u.xTCP.txStream != NULL )
+            {
+                uxBytes += pxSocket->u.xTCP.txStream->LENGTH;
+                ( *puxStreams )++;
+            }
+        }
+    }
+    ( void ) xTaskResumeAll();
+
+    return uxBytes;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xRunStreamMemoryBenchmark( struct freertos_sockaddr * pxServer,
+                                      UBaseType_t uxConnections,
+                                      UBaseType_t uxActive,
+                                      TickType_t xDuration,
+                                      TickType_t xSamplePeriod,
+                                      StreamMemoryResults_t * pxResults )
+{
+    StreamMemoryResults_t xResults;
+    Socket_t xSockets[ streamMemBenchMAX_CONNECTIONS ];
+    UBaseType_t uxCount = 0U;
+    UBaseType_t uxIndex, uxStreams;
+    UBaseType_t uxRound = 0U;
+    size_t uxFreeAtStart, uxFree, uxStreamBytes;
+    uint64_t ullStreamTotal = 0U;
+    TickType_t xStartTime, xPeriodStart, xElapsed;
+    BaseType_t xErrors = 0;
+    BaseType_t xReturn = pdFAIL;
+
+    ( void ) memset( &( xResults ), 0, sizeof( xResults ) );
+
+    if( ( uxConnections == 0U ) || ( uxConnections > streamMemBenchMAX_CONNECTIONS ) ||
+        ( uxActive > uxConnections ) || ( xSamplePeriod == 0U ) )
+    {
+        FreeRTOS_printf( ( "Stream memory: bad parameters\n" ) );
+    }
+    else
+    {
+        #if ( ipconfigUSE_TCP_ELASTIC_STREAMS != 1 )
+            {
+                FreeRTOS_printf( ( "Stream memory: ipconfigUSE_TCP_ELASTIC_STREAMS is not enabled\n" ) );
+            }
+        #endif
+
+        uxFreeAtStart = xPortGetFreeHeapSize();
+
+        for( uxCount = 0U; uxCount < uxConnections; uxCount++ )
+        {
+            xSockets[ uxCount ] = prvConnect( pxServer );
+
+            if( xSockets[ uxCount ] == NULL )
+            {
+                FreeRTOS_printf( ( "Stream memory: connection %u failed\n", ( unsigned ) uxCount ) );
+                break;
+            }
+        }
+
+        if( uxCount == uxConnections )
+        {
+            FreeRTOS_printf( ( "Stream memory: %u connections %u active burst %u period %u ticks\n",
+                               ( unsigned ) uxConnections, ( unsigned ) uxActive,
+                               ( unsigned ) streamMemBenchBURST_SIZE, ( unsigned ) xSamplePeriod ) );
+
+            xStartTime = xTaskGetTickCount();
+
+            while( ( xTaskGetTickCount() - xStartTime ) < xDuration )
+            {
+                xPeriodStart = xTaskGetTickCount();
+
+                /* Let a rotating group of connections exchange data. */
+                for( uxIndex = 0U; uxIndex < uxActive; uxIndex++ )
+                {
+                    xErrors += prvExchange( xSockets[ ( ( uxRound * uxActive ) + uxIndex ) % uxConnections ], ( uint8_t ) uxRound );
+                }
+
+                xElapsed = xTaskGetTickCount() - xPeriodStart;
+
+                if( xElapsed < xSamplePeriod )
+                {
+                    vTaskDelay( xSamplePeriod - xElapsed );
+                }
+
+                uxStreamBytes = prvStreamBytes( xSockets, uxCount, &( uxStreams ) );
+                uxFree = xPortGetFreeHeapSize();
+
+                if( ( uxFreeAtStart > uxFree ) && ( ( uxFreeAtStart - uxFree ) > xResults.uxPeakHeapUsed ) )
+                {
+                    xResults.uxPeakHeapUsed = uxFreeAtStart - uxFree;
+                }
+
+                if( uxStreamBytes > xResults.uxPeakStreamBytes )
+                {
+                    xResults.uxPeakStreamBytes = uxStreamBytes;
+                }
+
+                ullStreamTotal += uxStreamBytes;
+                xResults.ulSamples++;
+                uxRound++;
+
+                FreeRTOS_printf( ( "Stream memory: %lu ms heap %ld streams %u bytes %u\n",
+                                   ( unsigned long ) ( ( xTaskGetTickCount() - xStartTime ) * portTICK_PERIOD_MS ),
+                                   ( long ) uxFreeAtStart - ( long ) uxFree,
+                                   ( unsigned ) uxStreams,
+                                   ( unsigned ) uxStreamBytes ) );
+            }
+
+            if( xResults.ulSamples > 0U )
+            {
+                xResults.uxAverageStreamBytes = ( size_t ) ( ullStreamTotal / xResults.ulSamples );
+            }
+
+            FreeRTOS_printf( ( "Stream memory: peak %u average %u bytes in streams, peak heap %u\n",
+                               ( unsigned ) xResults.uxPeakStreamBytes,
+                               ( unsigned ) xResults.uxAverageStreamBytes,
+                               ( unsigned ) xResults.uxPeakHeapUsed ) );
+
+            if( xErrors == 0 )
+            {
+                xReturn = pdPASS;
+            }
+            else
+            {
+                FreeRTOS_printf( ( "Stream memory: %d exchanges failed\n", ( int ) xErrors ) );
+            }
+        }
+
+        for( uxIndex = 0U; uxIndex < uxCount; uxIndex++ )
+        {
+            ( void ) FreeRTOS_closesocket( xSockets[ uxIndex ] );
+        }
+
+        if( pxResults != NULL )
+        {
+            *pxResults = xResults;
+        }
+    }
+
+    return xReturn;
+}